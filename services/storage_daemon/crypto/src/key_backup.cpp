@@ -15,11 +15,16 @@
 
 #include "key_backup.h"
 
+#include <algorithm>
+#include <cstring>
+#include <ctime>
 #include <dirent.h>
 #include <fcntl.h>
 #include <thread>
+#include <unistd.h>
 
 #include "file_ex.h"
+#include "openssl_crypto.h"
 #include "utils/hi_audit.h"
 #include "storage_service_errno.h"
 #include "storage_service_log.h"
@@ -39,8 +44,107 @@ struct FileNode {
     std::string origFile;
     std::string backFile;
     bool isSame;
+    bool preferBack = false; // both copies look intact and the backup one is newer
 };
 
+namespace {
+constexpr size_t COMPARE_BUF_SIZE = 4096;
+constexpr int64_t NS_PER_SEC = 1000000000LL;
+// Timestamps are taken from a coarse clock; a stamp younger than this may miss a same-size rewrite.
+constexpr int64_t RACY_STAMP_NS = 100 * 1000 * 1000;
+constexpr size_t MAX_SYNCED_PAIRS = 1024;
+constexpr const char *COPY_TMP_SUFFIX = ".bak_tmp";
+
+int64_t ToNs(const struct timespec &ts)
+{
+    return static_cast<int64_t>(ts.tv_sec) * NS_PER_SEC + ts.tv_nsec;
+}
+
+KeyFileStamp MakeStamp(const struct stat &st)
+{
+    return { st.st_dev, st.st_ino, st.st_size, ToNs(st.st_mtim), ToNs(st.st_ctim) };
+}
+
+// A copy interrupted before its rename leaves this name behind; it is never a key file.
+bool IsCopyTmpName(const std::string &name)
+{
+    size_t suffixLen = strlen(COPY_TMP_SUFFIX);
+    return name.size() > suffixLen && name.compare(name.size() - suffixLen, suffixLen, COPY_TMP_SUFFIX) == 0;
+}
+
+ssize_t ReadFull(int fd, uint8_t *buf, size_t len)
+{
+    size_t done = 0;
+    while (done < len) {
+        ssize_t ret = TEMP_FAILURE_RETRY(read(fd, buf + done, len - done));
+        if (ret < 0) {
+            return -1;
+        }
+        if (ret == 0) {
+            break;
+        }
+        done += static_cast<size_t>(ret);
+    }
+    return static_cast<ssize_t>(done);
+}
+
+// 0 if both fds hold the same bytes, 1 if not, -1 on read error.
+int32_t CompareFdContent(int fdA, int fdB)
+{
+    uint8_t bufA[COMPARE_BUF_SIZE];
+    uint8_t bufB[COMPARE_BUF_SIZE];
+    while (true) {
+        ssize_t lenA = ReadFull(fdA, bufA, sizeof(bufA));
+        ssize_t lenB = ReadFull(fdB, bufB, sizeof(bufB));
+        if (lenA < 0 || lenB < 0) {
+            return -1;
+        }
+        if (lenA != lenB || memcmp(bufA, bufB, static_cast<size_t>(lenA)) != 0) {
+            return 1;
+        }
+        if (lenA == 0) {
+            return 0;
+        }
+    }
+}
+
+bool CopyFdContent(int inFd, int outFd, off_t size)
+{
+    off_t left = size;
+    while (left > 0) {
+        ssize_t ret = copy_file_range(inFd, nullptr, outFd, nullptr, static_cast<size_t>(left), 0);
+        if (ret < 0 && errno == EINTR) {
+            continue;
+        }
+        if (ret <= 0) {
+            break;
+        }
+        left -= ret;
+    }
+    if (left == 0) {
+        return true;
+    }
+    // copy_file_range is not available across every filesystem pair, finish with plain reads.
+    uint8_t buf[COMPARE_BUF_SIZE];
+    while (true) {
+        ssize_t len = ReadFull(inFd, buf, sizeof(buf));
+        if (len <= 0) {
+            return len == 0;
+        }
+        if (TEMP_FAILURE_RETRY(write(outFd, buf, static_cast<size_t>(len))) != len) {
+            return false;
+        }
+    }
+}
+
+void SplitPath(const std::string &path, std::string &dir, std::string &name)
+{
+    auto pos = path.rfind('/');
+    dir = (pos == std::string::npos) ? "." : (pos == 0 ? "/" : path.substr(0, pos));
+    name = (pos == std::string::npos) ? path : path.substr(pos + 1);
+}
+} // namespace
+
 void KeyBackup::CreateBackup(const std::string &from, const std::string &to, bool removeOld)
 {
     LOGD("[L4:KeyBackup] CreateBackup: >>> ENTER <<< from=%{public}s, to=%{public}s, removeOld=%{public}d",
@@ -83,7 +187,10 @@ int32_t KeyBackup::RemoveNode(const std::string &pathName)
     }
 
     if (!S_ISDIR(st.st_mode)) {
-        CleanFile(pathName);
+        // A file with other links is still live key material elsewhere (mix restore stages by hardlink).
+        if (st.st_nlink <= 1) {
+            CleanFile(pathName);
+        }
         int32_t ret = remove(pathName.c_str());
         LOGI("[L4:KeyBackup] RemoveNode: <<< EXIT %s <<< pathName=%{public}s",
              ret == 0 ? "SUCCESS" : "FAILED", pathName.c_str());
@@ -138,6 +245,8 @@ int32_t KeyBackup::TryRestoreKey(const std::shared_ptr<BaseKey> &baseKey, const
     std::string keyDir = baseKey->GetDir();
     std::string backupDir;
     GetBackupDir(keyDir, backupDir);
+    RemoveStaleCopies(keyDir + PATH_LATEST);
+    RemoveStaleCopies(backupDir + PATH_LATEST);
     if (baseKey->DoRestoreKey(auth, keyDir + PATH_LATEST) == E_OK) {
         if (needFixFiles) {
             std::thread fixFileThread([this, keyDir, backupDir]() {
@@ -249,14 +358,26 @@ void KeyBackup::ListAndCheckDir(std::string &origDir)
 int32_t KeyBackup::DoResotreKeyMix(std::shared_ptr<BaseKey> &baseKey, const UserAuth &auth, const std::string &keyDir,
     const std::string &backupDir)
 {
-    LOGI("[L4:KeyBackup] DoResotreKeyMix: >>> ENTER <<<");
+    if (baseKey == nullptr) {
+        LOGE("[L4:KeyBackup] DoResotreKeyMix: <<< EXIT FAILED <<< basekey is nullptr");
+        return E_ERR;
+    }
+    return RestoreKeyMix(keyDir, backupDir, [&baseKey, &auth](const std::string &keyPath) {
+        return baseKey->DoRestoreKey(auth, keyPath) == E_OK;
+    });
+}
+
+int32_t KeyBackup::RestoreKeyMix(const std::string &keyDir, const std::string &backupDir,
+    const std::function<bool(const std::string &)> &tryRestore)
+{
+    LOGI("[L4:KeyBackup] RestoreKeyMix: >>> ENTER <<<");
     std::string origKeyDir = keyDir + PATH_LATEST;
     std::string backupKeyDir = backupDir + PATH_LATEST;
     std::vector<struct FileNode> fileList;
     uint32_t diffNum = 0;
     int32_t ret = GetFileList(origKeyDir, backupKeyDir, fileList, diffNum);
     if (ret != 0 || diffNum <= 1) {
-        LOGE("[L4:KeyBackup] DoResotreKeyMix: <<< EXIT FAILED <<< get file list failed or diffNum too least,"
+        LOGE("[L4:KeyBackup] RestoreKeyMix: <<< EXIT FAILED <<< get file list failed or diffNum too least,"
              "ret=%{public}d, diffNum=%{public}d", ret, diffNum);
         return E_ERR;
     }
@@ -264,54 +385,56 @@ int32_t KeyBackup::DoResotreKeyMix(std::shared_ptr<BaseKey> &baseKey, const User
     std::string tempKeyDir;
     ret = CopySameFilesToTempDir(backupKeyDir, tempKeyDir, fileList);
     if (ret != 0) {
-        LOGE("[L4:KeyBackup] DoResotreKeyMix: <<< EXIT FAILED <<< CopySameFilesToTempDir failed");
+        LOGE("[L4:KeyBackup] RestoreKeyMix: <<< EXIT FAILED <<< CopySameFilesToTempDir failed");
+        return E_ERR;
+    }
+    ret = PickIntactFilesToTempDir(tempKeyDir, fileList);
+    if (ret != 0) {
+        HiAudit::GetInstance().WriteStart("KeyBackup::RestoreKeyMix RemoveNode one while");
+        RemoveNode(tempKeyDir);
+        HiAudit::GetInstance().WriteEnd("KeyBackup::RestoreKeyMix RemoveNode one while", E_ERR);
+        LOGE("[L4:KeyBackup] RestoreKeyMix: <<< EXIT FAILED <<< PickIntactFilesToTempDir failed");
         return E_ERR;
     }
 
+    // Only files whose both copies pass the format checks are left to combine.
     diffNum = fileList.size();
     uint32_t loopNum = GetLoopMaxNum(diffNum);
     if (loopNum == INVALID_LOOP_NUM) {
-        HiAudit::GetInstance().WriteStart("KeyBackup::DoResotreKeyMix RemoveNode one while");
+        HiAudit::GetInstance().WriteStart("KeyBackup::RestoreKeyMix RemoveNode two while");
         RemoveNode(tempKeyDir);
-        HiAudit::GetInstance().WriteEnd("KeyBackup::DoResotreKeyMix RemoveNode one while", E_ERR);
-        LOGE("[L4:KeyBackup] DoResotreKeyMix: <<< EXIT FAILED <<< loopNum is invalid");
+        HiAudit::GetInstance().WriteEnd("KeyBackup::RestoreKeyMix RemoveNode two while", E_ERR);
+        LOGE("[L4:KeyBackup] RestoreKeyMix: <<< EXIT FAILED <<< loopNum is invalid");
         return E_ERR;
     }
     for (uint32_t i = 0; i <= loopNum; i++) {
-        LOGI("[L4:KeyBackup] DoResotreKeyMix: try mix key files to decrypt i=%{public}u loopNum=%{public}u",
+        LOGI("[L4:KeyBackup] RestoreKeyMix: try mix key files to decrypt i=%{public}u loopNum=%{public}u",
              i, loopNum);
         ret = CopyMixFilesToTempDir(diffNum, i, tempKeyDir, fileList);
         if (ret != 0) {
-            LOGE("[L4:KeyBackup] DoResotreKeyMix: copy mix files to temp dir failed, i=%{public}u", i);
+            LOGE("[L4:KeyBackup] RestoreKeyMix: copy mix files to temp dir failed, i=%{public}u", i);
             continue;
         }
-        if (baseKey == nullptr) {
-            LOGE("[L4:KeyBackup] DoResotreKeyMix: <<< EXIT FAILED <<< basekey is nullptr");
-            HiAudit::GetInstance().WriteStart("KeyBackup::DoResotreKeyMix RemoveNode two while");
-            RemoveNode(tempKeyDir);
-            HiAudit::GetInstance().WriteEnd("KeyBackup::DoResotreKeyMix RemoveNode two while", E_ERR);
-            return E_ERR;
-        }
-        if (baseKey->DoRestoreKey(auth, tempKeyDir) == E_OK) {
-            LOGI("[L4:KeyBackup] DoResotreKeyMix: mix key files decrypt succ, fix orig and backup");
+        if (tryRestore(tempKeyDir)) {
+            LOGI("[L4:KeyBackup] RestoreKeyMix: mix key files decrypt succ, fix orig and backup");
             CheckAndFixFiles(tempKeyDir, origKeyDir);
             CheckAndFixFiles(tempKeyDir, backupKeyDir);
-            HiAudit::GetInstance().WriteStart("KeyBackup::DoResotreKeyMix RemoveNode three while");
+            HiAudit::GetInstance().WriteStart("KeyBackup::RestoreKeyMix RemoveNode three while");
             RemoveNode(tempKeyDir);
-            HiAudit::GetInstance().WriteEnd("KeyBackup::DoResotreKeyMix RemoveNode three while", E_OK);
-            LOGI("[L4:KeyBackup] DoResotreKeyMix: <<< EXIT SUCCESS <<<");
+            HiAudit::GetInstance().WriteEnd("KeyBackup::RestoreKeyMix RemoveNode three while", E_OK);
+            LOGI("[L4:KeyBackup] RestoreKeyMix: <<< EXIT SUCCESS <<< attempts=%{public}u", i + 1);
             return E_OK;
         }
     }
-    HiAudit::GetInstance().WriteStart("KeyBackup::DoResotreKeyMix RemoveNode four while");
+    HiAudit::GetInstance().WriteStart("KeyBackup::RestoreKeyMix RemoveNode four while");
     RemoveNode(tempKeyDir);
-    HiAudit::GetInstance().WriteEnd("KeyBackup::DoResotreKeyMix RemoveNode four while", E_ERR);
-    LOGE("[L4:KeyBackup] DoResotreKeyMix: <<< EXIT FAILED <<< all attempts failed");
+    HiAudit::GetInstance().WriteEnd("KeyBackup::RestoreKeyMix RemoveNode four while", E_ERR);
+    LOGE("[L4:KeyBackup] RestoreKeyMix: <<< EXIT FAILED <<< all attempts failed");
     return E_ERR;
 }
 
 int32_t KeyBackup::GetFileList(const std::string &origDir, const std::string &backDir,
-    std::vector<struct FileNode> &fileList, uint32_t diffNum)
+    std::vector<struct FileNode> &fileList, uint32_t &diffNum)
 {
     LOGI("[L4:KeyBackup] GetFileList: >>> ENTER <<< origDir=%{public}s, backDir=%{public}s",
          origDir.c_str(), backDir.c_str());
@@ -368,7 +491,7 @@ bool KeyBackup::IsRegFile(const std::string &filePath)
 void KeyBackup::AddOrigFileToList(const std::string &fileName, const std::string &origDir,
     std::vector<struct FileNode> &fileList)
 {
-    if (fileName.compare("..") == 0 || fileName.compare(".") == 0) {
+    if (fileName.compare("..") == 0 || fileName.compare(".") == 0 || IsCopyTmpName(fileName)) {
         return;
     }
 
@@ -388,7 +511,7 @@ void KeyBackup::AddOrigFileToList(const std::string &fileName, const std::string
 void KeyBackup::AddBackupFileToList(const std::string &fileName, const std::string &backDir,
     std::vector<struct FileNode> &fileList)
 {
-    if (fileName.compare("..") == 0 || fileName.compare(".") == 0) {
+    if (fileName.compare("..") == 0 || fileName.compare(".") == 0 || IsCopyTmpName(fileName)) {
         return;
     }
 
@@ -442,7 +565,7 @@ int32_t KeyBackup::CopySameFilesToTempDir(const std::string &backupDir, std::str
 
     for (auto iter = fileList.begin(); iter != fileList.end();) {
         if (iter->isSame || iter->backFile.empty()) {
-            ret = CheckAndCopyOneFile(iter->origFile, tempDir + "/" + iter->baseName);
+            ret = StageFile(iter->origFile, tempDir + "/" + iter->baseName);
             if (ret != 0) {
                 HiAudit::GetInstance().WriteStart("KeyBackup::CopySameFilesToTempDir RemoveNode one while");
                 RemoveNode(tempDir);
@@ -452,7 +575,7 @@ int32_t KeyBackup::CopySameFilesToTempDir(const std::string &backupDir, std::str
             }
             iter = fileList.erase(iter);
         } else if (iter->origFile.empty()) {
-            ret = CheckAndCopyOneFile(iter->backFile, tempDir + "/" + iter->baseName);
+            ret = StageFile(iter->backFile, tempDir + "/" + iter->baseName);
             if (ret != 0) {
                 HiAudit::GetInstance().WriteStart("KeyBackup::CopySameFilesToTempDir RemoveNode two while");
                 RemoveNode(tempDir);
@@ -505,17 +628,81 @@ uint32_t KeyBackup::GetLoopMaxNum(uint32_t diffNum)
 int32_t KeyBackup::CopyMixFilesToTempDir(uint32_t diffNum, uint32_t num, const std::string &tempDir,
     const std::vector<struct FileNode> &fileList)
 {
+    // Bit i set means the less preferred copy of file i, so num 0 is the newest copy of every file.
     for (uint32_t i = 0; i < diffNum; i++) {
-        std::string from;
-        if (num & (1UL << i)) {
-            from = fileList[i].backFile;
-        } else {
-            from = fileList[i].origFile;
-        }
+        bool useBack = ((num & (1UL << i)) != 0) != fileList[i].preferBack;
+        const std::string &from = useBack ? fileList[i].backFile : fileList[i].origFile;
         std::string to = tempDir + "/" + fileList[i].baseName;
-        if (CheckAndCopyOneFile(from, to) != 0) {
+        if (StageFile(from, to) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int32_t KeyBackup::PickIntactFilesToTempDir(const std::string &tempDir, std::vector<struct FileNode> &fileList)
+{
+    for (auto iter = fileList.begin(); iter != fileList.end();) {
+        bool origIntact = IsKeyFileIntact(iter->baseName, iter->origFile);
+        bool backIntact = IsKeyFileIntact(iter->baseName, iter->backFile);
+        LOGI("[L4:KeyBackup] PickIntactFilesToTempDir: fileName=%{public}s, origIntact=%{public}d,"
+             "backIntact=%{public}d", iter->baseName.c_str(), origIntact, backIntact);
+        if (!origIntact && !backIntact) {
+            LOGE("[L4:KeyBackup] PickIntactFilesToTempDir: both copies are broken, fileName=%{public}s",
+                 iter->baseName.c_str());
             return -1;
         }
+        if (origIntact != backIntact) {
+            if (StageFile(origIntact ? iter->origFile : iter->backFile, tempDir + "/" + iter->baseName) != 0) {
+                return -1;
+            }
+            iter = fileList.erase(iter);
+            continue;
+        }
+        struct stat origSt;
+        struct stat backSt;
+        if (stat(iter->origFile.c_str(), &origSt) == 0 && stat(iter->backFile.c_str(), &backSt) == 0) {
+            iter->preferBack = backSt.st_mtim.tv_sec > origSt.st_mtim.tv_sec ||
+                (backSt.st_mtim.tv_sec == origSt.st_mtim.tv_sec && backSt.st_mtim.tv_nsec > origSt.st_mtim.tv_nsec);
+        }
+        ++iter;
+    }
+    return 0;
+}
+
+bool KeyBackup::IsKeyFileIntact(const std::string &fileName, const std::string &filePath)
+{
+    std::string data;
+    if (!LoadStringFromFile(filePath, data) || data.empty()) {
+        return false;
+    }
+    // RemoveNode zero-fills files before unlinking them, an interrupted removal leaves such a copy behind.
+    if (std::all_of(data.begin(), data.end(), [](char c) { return c == '\0'; })) {
+        return false;
+    }
+    if (fileName == PATH_SECDISC + 1) {
+        return data.size() == CRYPTO_KEY_SECDISC_SIZE;
+    }
+    if (fileName == PATH_ENCRYPTED + 1) {
+        return data.size() > GCM_NONCE_BYTES + GCM_MAC_BYTES;
+    }
+    return true;
+}
+
+int32_t KeyBackup::StageFile(const std::string &from, const std::string &to)
+{
+    // The temp dir is only a decrypt candidate, so a link (or an unsynced copy) is enough.
+    if (unlink(to.c_str()) != 0 && errno != ENOENT) {
+        LOGE("[L4:KeyBackup] StageFile: unlink failed, to=%{public}s, errno=%{public}d", to.c_str(), errno);
+        return -1;
+    }
+    if (link(from.c_str(), to.c_str()) == 0) {
+        return 0;
+    }
+    std::string data;
+    if (!LoadStringFromFile(from, data) || !SaveStringToFile(to, data)) {
+        LOGE("[L4:KeyBackup] StageFile: copy failed, from=%{public}s", from.c_str());
+        return -1;
     }
     return 0;
 }
@@ -675,18 +862,29 @@ void KeyBackup::CheckAndCopyFiles(const std::string &from, const std::string &to
     }
 
     struct dirent *de = nullptr;
+    bool copied = false;
     while ((de = readdir(dir)) != nullptr) {
-        if (strcmp(de->d_name, "..") == 0 || strcmp(de->d_name, ".") == 0) {
+        if (strcmp(de->d_name, "..") == 0 || strcmp(de->d_name, ".") == 0 || IsCopyTmpName(de->d_name)) {
             continue;
         }
         std::string dfrom = from + "/" + de->d_name;
         std::string dto = to + "/" + de->d_name;
+        if (de->d_type == DT_REG) {
+            bool fileCopied = false;
+            CopyFileIfChanged(dfrom, dto, fileCopied);
+            copied = copied || fileCopied;
+            continue;
+        }
         CheckAndCopyFiles(dfrom, dto);
     }
 
     if (closedir(dir) < 0) {
         LOGE("[L4:KeyBackup] CheckAndCopyFiles: close dir failed, from=%{public}s", from.c_str());
     }
+    // One directory sync makes every rename of this batch durable.
+    if (copied) {
+        FsyncFile(to);
+    }
     LOGD("[L4:KeyBackup] CheckAndCopyFiles: <<< EXIT SUCCESS <<<");
 }
 
@@ -705,44 +903,129 @@ int32_t KeyBackup::HandleCopyDir(const std::string &from, const std::string &to)
     return 0;
 }
 
+void KeyBackup::RemoveStaleCopies(const std::string &dir)
+{
+    DIR *dirp = opendir(dir.c_str());
+    if (dirp == nullptr) {
+        return;
+    }
+    struct dirent *de = nullptr;
+    while ((de = readdir(dirp)) != nullptr) {
+        if (de->d_type != DT_REG || !IsCopyTmpName(de->d_name)) {
+            continue;
+        }
+        if (unlinkat(dirfd(dirp), de->d_name, 0) != 0 && errno != ENOENT) {
+            LOGE("[L4:KeyBackup] RemoveStaleCopies: unlink %{public}s failed, errno=%{public}d", de->d_name, errno);
+            continue;
+        }
+        LOGW("[L4:KeyBackup] RemoveStaleCopies: removed %{public}s/%{public}s", dir.c_str(), de->d_name);
+    }
+    closedir(dirp);
+}
+
 int32_t KeyBackup::CheckAndCopyOneFile(const std::string &srcFile, const std::string &dstFile)
 {
     LOGD("[L4:KeyBackup] CheckAndCopyOneFile: >>> ENTER <<< srcFile=%{public}s, dstFile=%{public}s",
          srcFile.c_str(), dstFile.c_str());
-    std::string srcData;
-    if (!LoadStringFromFile(srcFile, srcData)) {
-        LOGE("[L4:KeyBackup] CheckAndCopyOneFile: <<< EXIT FAILED <<< failed to read srcFile=%{public}s",
-             srcFile.c_str());
-        return -1;
+    bool copied = false;
+    int32_t ret = CopyFileIfChanged(srcFile, dstFile, copied);
+    if (ret == 0 && copied) {
+        std::string dstDir;
+        std::string dstName;
+        SplitPath(dstFile, dstDir, dstName);
+        FsyncFile(dstDir);
     }
+    return ret;
+}
 
-    std::string dstData;
-    if (!LoadStringFromFile(dstFile, dstData)) {
-        LOGE("[L4:KeyBackup] CheckAndCopyOneFile: failed to read dstFile=%{public}s", dstFile.c_str());
+int32_t KeyBackup::CopyFileIfChanged(const std::string &srcFile, const std::string &dstFile, bool &copied)
+{
+    copied = false;
+    UniqueFd srcFd(open(srcFile.c_str(), O_RDONLY | O_CLOEXEC));
+    struct stat srcSt;
+    if (srcFd < 0 || fstat(srcFd, &srcSt) != 0) {
+        LOGE("[L4:KeyBackup] CopyFileIfChanged: <<< EXIT FAILED <<< failed to read srcFile=%{public}s",
+             srcFile.c_str());
+        return -1;
     }
 
-    if (srcData.compare(dstData) == 0) {
-        LOGD("[L4:KeyBackup] CheckAndCopyOneFile: <<< EXIT SUCCESS <<< files are same");
+    struct stat dstSt;
+    if (stat(dstFile.c_str(), &dstSt) != 0) {
+        // A missing destination reads as empty, same as an empty source.
+        if (srcSt.st_size == 0) {
+            return 0;
+        }
+    } else if (IsSyncedPair(dstFile, srcSt, dstSt)) {
         return 0;
+    } else if (dstSt.st_size == srcSt.st_size) {
+        UniqueFd dstFd(open(dstFile.c_str(), O_RDONLY | O_CLOEXEC));
+        if (dstFd >= 0 && CompareFdContent(srcFd, dstFd) == 0) {
+            RememberSyncedPair(dstFile, srcSt, dstSt);
+            LOGD("[L4:KeyBackup] CopyFileIfChanged: <<< EXIT SUCCESS <<< files are same");
+            return 0;
+        }
+        if (lseek(srcFd, 0, SEEK_SET) < 0) {
+            return -1;
+        }
     }
 
-    if (!SaveStringToFile(dstFile, srcData)) {
-        LOGE("[L4:KeyBackup] CheckAndCopyOneFile: <<< EXIT FAILED <<< failed to write dstFile=%{public}s",
-             dstFile.c_str());
+    std::string dstDir;
+    std::string dstName;
+    SplitPath(dstFile, dstDir, dstName);
+    std::string tmpName = dstName + COPY_TMP_SUFFIX;
+    UniqueFd dirFd(open(dstDir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC));
+    UniqueFd tmpFd(dirFd < 0 ? -1 : openat(dirFd, tmpName.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+        DEFAULT_WRITE_FILE_PERM));
+    if (tmpFd < 0 || !CopyFdContent(srcFd, tmpFd, srcSt.st_size)) {
+        LOGE("[L4:KeyBackup] CopyFileIfChanged: <<< EXIT FAILED <<< failed to write dstFile=%{public}s, "
+             "errno=%{public}d", dstFile.c_str(), errno);
+        if (dirFd >= 0) {
+            (void)unlinkat(dirFd, tmpName.c_str(), 0);
+        }
         return -1;
     }
-
-    struct FileAttr attr;
-    if (GetAttr(srcFile, attr) == 0) {
-        SetAttr(dstFile, attr);
+    if (fchown(tmpFd, srcSt.st_uid, srcSt.st_gid) != 0 || fchmod(tmpFd, srcSt.st_mode) != 0) {
+        LOGE("[L4:KeyBackup] CopyFileIfChanged: set attr failed, dstFile=%{public}s", dstFile.c_str());
+    }
+    if (fdatasync(tmpFd) != 0 || renameat(dirFd, tmpName.c_str(), dirFd, dstName.c_str()) != 0) {
+        LOGE("[L4:KeyBackup] CopyFileIfChanged: <<< EXIT FAILED <<< failed to commit dstFile=%{public}s, "
+             "errno=%{public}d", dstFile.c_str(), errno);
+        (void)unlinkat(dirFd, tmpName.c_str(), 0);
+        return -1;
+    }
+    copied = true;
+    if (stat(dstFile.c_str(), &dstSt) == 0) {
+        RememberSyncedPair(dstFile, srcSt, dstSt);
     }
-    FsyncFile(dstFile);
-    LOGD("[L4:KeyBackup] CheckAndCopyOneFile: copy srcFile=%{public}s dstFile=%{public}s succ",
+    LOGD("[L4:KeyBackup] CopyFileIfChanged: copy srcFile=%{public}s dstFile=%{public}s succ",
          srcFile.c_str(), dstFile.c_str());
-    LOGD("[L4:KeyBackup] CheckAndCopyOneFile: <<< EXIT SUCCESS <<<");
     return 0;
 }
 
+bool KeyBackup::IsSyncedPair(const std::string &dstFile, const struct stat &srcSt, const struct stat &dstSt)
+{
+    std::lock_guard<std::mutex> lock(syncedPairsMutex_);
+    auto iter = syncedPairs_.find(dstFile);
+    return iter != syncedPairs_.end() && iter->second.first == MakeStamp(srcSt) &&
+        iter->second.second == MakeStamp(dstSt);
+}
+
+void KeyBackup::RememberSyncedPair(const std::string &dstFile, const struct stat &srcSt, const struct stat &dstSt)
+{
+    struct timespec now = {};
+    (void)clock_gettime(CLOCK_REALTIME, &now);
+    int64_t newest = std::max(ToNs(srcSt.st_ctim), ToNs(dstSt.st_ctim));
+    std::lock_guard<std::mutex> lock(syncedPairsMutex_);
+    if (ToNs(now) - newest < RACY_STAMP_NS) {
+        syncedPairs_.erase(dstFile);
+        return;
+    }
+    if (syncedPairs_.size() >= MAX_SYNCED_PAIRS) {
+        syncedPairs_.clear();
+    }
+    syncedPairs_[dstFile] = { MakeStamp(srcSt), MakeStamp(dstSt) };
+}
+
 bool KeyBackup::GetRealPath(const std::string &path, std::string &realPath)
 {
     char resolvedPath[PATH_MAX] = { 0 };
@@ -756,19 +1039,26 @@ bool KeyBackup::GetRealPath(const std::string &path, std::string &realPath)
 
 int32_t KeyBackup::CompareFile(const std::string &fileA, const std::string fileB)
 {
-    std::string dataA;
-    if (!LoadStringFromFile(fileA, dataA)) {
+    UniqueFd fdA(open(fileA.c_str(), O_RDONLY | O_CLOEXEC));
+    if (fdA < 0) {
         LOGE("[L4:KeyBackup] CompareFile: <<< EXIT FAILED <<< failed to read from fileA=%{public}s", fileA.c_str());
         return -1;
     }
 
-    std::string dataB;
-    if (!LoadStringFromFile(fileB, dataB)) {
+    UniqueFd fdB(open(fileB.c_str(), O_RDONLY | O_CLOEXEC));
+    if (fdB < 0) {
         LOGE("[L4:KeyBackup] CompareFile: <<< EXIT FAILED <<< failed to read from fileB=%{public}s", fileB.c_str());
         return -1;
     }
 
-    int ret = dataA.compare(dataB);
+    struct stat stA;
+    struct stat stB;
+    int32_t ret = 1;
+    if (fstat(fdA, &stA) != 0 || fstat(fdB, &stB) != 0) {
+        ret = -1;
+    } else if (stA.st_size == stB.st_size) {
+        ret = CompareFdContent(fdA, fdB);
+    }
     LOGI("[L4:KeyBackup] CompareFile: <<< EXIT %s <<<", ret == 0 ? "SUCCESS" : "FAILED");
     return ret;
 }
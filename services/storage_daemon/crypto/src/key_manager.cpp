@@ -30,6 +30,7 @@
 #include "storage_service_log.h"
 #include "user/mount_constant.h"
 #include "user/user_manager.h"
+#include "user_key_state.h"
 #include "utils/storage_radar.h"
 #include "utils/string_utils.h"
 #include "utils/hi_audit.h"
@@ -49,7 +50,6 @@ constexpr const char *SEC_DISCARD_DIR = "/latest/sec_discard";
 constexpr const char *NEED_UPDATE_DIR = "/latest/need_update";
 constexpr const char *SHIELD_DIR = "/latest/shield";
 constexpr const char *DESC_DIR = "/key_desc";
-constexpr const char *EL2_ENCRYPT_TMP_FILE = "/el2_tmp";
 constexpr uint32_t KEY_RECOVERY_USER_ID = 300;
 
 constexpr const char *SERVICE_STORAGE_DAEMON_DIR = "/data/service/el1/public/storage_daemon";
@@ -400,6 +400,9 @@ int KeyManager::GenerateAndInstallUserKey(uint32_t userId, const std::string &di
             ", ret=" + std::to_string(ret));
         return E_ELX_KEY_ACTIVE_ERROR;
     }
+    if (type == EL2_KEY) {
+        UserKeyStateTable::GetInstance().OnCeActivated(userId);
+    }
     (void)elKey->UpdateKey();
     if (type >= EL1_KEY && type < EL5_KEY) {
         SaveUserElKey(userId, type, elKey);
@@ -504,6 +507,9 @@ int KeyManager::RestoreUserKey(uint32_t userId, const std::string &dir, const Us
             ", ret=" + std::to_string(ret));
         return E_ELX_KEY_ACTIVE_ERROR;
     }
+    if (type == EL2_KEY) {
+        UserKeyStateTable::GetInstance().OnCeActivated(userId);
+    }
 
     SaveUserElKey(userId, type, elKey);
     LOGI("[L3:KeyManager] RestoreUserKey: <<< EXIT SUCCESS <<< [retval=0]");
@@ -1103,6 +1109,7 @@ int KeyManager::DeleteUserKeys(unsigned int user)
 
     std::lock_guard<std::mutex> lock(keyMutex_);
     int ret = DoDeleteUserKeys(user);
+    UserKeyStateTable::GetInstance().Release(user);
     LOGI("[L3:KeyManager] DeleteUserKeys: <<< EXIT SUCCESS <<< [retval=%{public}d]", ret);
 
     auto userTask = userLockScreenTask_.find(user);
@@ -1633,6 +1640,9 @@ int KeyManager::ActiveCeSceSeceUserKey(unsigned int user,
     }
     std::lock_guard<std::mutex> lock(keyMutex_);
     if (HasElkey(user, type) && HashElxActived(user, type)) {
+        if (type == EL2_KEY) {
+            UserKeyStateTable::GetInstance().OnCeActivated(user);
+        }
         return E_ACTIVE_REPEATED;
     }
     std::shared_ptr<DelayHandler> userDelayHandler;
@@ -1659,6 +1669,9 @@ int KeyManager::ActiveCeSceSeceUserKey(unsigned int user,
         return E_ELX_KEY_ACTIVE_ERROR;
     }
     SaveUserElKey(user, type, elKey);
+    if (type == EL2_KEY) {
+        UserKeyStateTable::GetInstance().OnCeActivated(user);
+    }
     userPinProtect[user] = !secret.empty();
     saveLockScreenStatus[user] = true;
     LOGI("[L3:KeyManager] ActiveCeSceSeceUserKey: <<< EXIT SUCCESS <<< [user=%{public}u,"
@@ -1720,6 +1733,9 @@ int KeyManager::ActiveElxUserKey4Nato(unsigned int user, KeyType type, const Key
             ", type=" + std::to_string(type) + ", ret=" + std::to_string(ret));
         return E_NATO_ACTIVE_EL4_KEY_ERROR;
     }
+    if (type == EL2_KEY) {
+        UserKeyStateTable::GetInstance().OnCeActivated(user);
+    }
     LOGW("[L3:KeyManager] ActiveElxUserKey4Nato: <<< EXIT SUCCESS <<< [userId=%{public}u, keyType=%{public}u]",
         user, type);
     return E_OK;
@@ -1940,6 +1956,7 @@ int KeyManager::UnlockUserScreen(uint32_t user, const std::vector<uint8_t> &toke
         return ret;
     }
     saveLockScreenStatus[user] = true;
+    UserKeyStateTable::GetInstance().OnScreenUnlocked(user);
     LOGD("[L3:KeyManager] UnlockUserScreen: <<< EXIT SUCCESS <<< [retval=0, saveLockScreenStatus=%{public}d]",
          saveLockScreenStatus[user]);
     return 0;
@@ -2324,8 +2341,14 @@ int KeyManager::InActiveUserKey(unsigned int user)
         if (ret != E_OK) {
             LOGE("[L3:KeyManager] InActiveUserKey: <<< EXIT FAILED <<< [failed to inactive el%{public}d key]", type);
             StorageRadar::ReportUserKeyResult("InactiveUserElKey", user, ret, "EL" + std::to_string(type), "");
+            if (type == EL2_KEY) {
+                UserKeyStateTable::GetInstance().Invalidate(user);
+            }
             return ret;
         }
+        if (type == EL2_KEY) {
+            UserKeyStateTable::GetInstance().OnCeInactivated(user);
+        }
     }
     auto userTask = userLockScreenTask_.find(user);
     if (userTask != userLockScreenTask_.end()) {
@@ -2425,6 +2448,7 @@ int KeyManager::LockUserScreen(uint32_t user)
     }
 
     saveLockScreenStatus[user] = false;
+    UserKeyStateTable::GetInstance().OnScreenLocked(user);
     LOGD("[L3:KeyManager] LockUserScreen: <<< EXIT SUCCESS <<< [retval=0, saveLockScreenStatus=%{public}d]",
         saveLockScreenStatus[user]);
     return 0;
@@ -2438,22 +2462,33 @@ int KeyManager::SetDirectoryElPolicy(unsigned int user, KeyType type, const std:
         LOGW("[L3:KeyManager] SetDirectoryElPolicy: fscrypt syspara not found or encryption not enabled");
         return 0;
     }
+    if (type != EL1_KEY && type != EL2_KEY && type != EL3_KEY && type != EL4_KEY && type != EL5_KEY) {
+        LOGE("[L3:KeyManager] SetDirectoryElPolicy: el flags not specified, no need to crypt");
+        return 0;
+    }
+    FscryptPolicyContext ctx = {};
+    int ret = LoadDirectoryElPolicy(user, type, ctx);
+    if (ret != E_OK) {
+        return ret;
+    }
+    // The context holds a copy of the key identifiers, the ioctls need nothing guarded by keyMutex_.
+    ret = ApplyDirectoryElPolicy(user, type, ctx, vec);
+    if (ret != E_OK) {
+        return ret;
+    }
+    LOGW("[L3:KeyManager] SetDirectoryElPolicy: <<< EXIT SUCCESS <<< [user %{public}u el policy set successfully]",
+        user);
+    return 0;
+}
+
+int KeyManager::LoadDirectoryElPolicy(unsigned int user, KeyType type, FscryptPolicyContext &ctx)
+{
     std::string keyPath;
     std::string eceSeceKeyPath;
     std::lock_guard<std::mutex> lock(keyMutex_);
-    if (type == EL1_KEY) {
-        int ret = getElxKeyPath(user, EL1_KEY, keyPath);
-        if (ret != E_OK) {
-            return ret;
-        }
-    } else if (type == EL2_KEY || type == EL3_KEY || type == EL4_KEY || type == EL5_KEY) {
-        int ret = getElxKeyPath(user, EL2_KEY, keyPath);
-        if (ret != E_OK) {
-            return ret;
-        }
-    } else {
-        LOGE("[L3:KeyManager] SetDirectoryElPolicy: el flags not specified, no need to crypt");
-        return 0;
+    int ret = getElxKeyPath(user, type == EL1_KEY ? EL1_KEY : EL2_KEY, keyPath);
+    if (ret != E_OK) {
+        return ret;
     }
     int32_t getElxKeyPathRet = getElxKeyPath(user, type, eceSeceKeyPath);
     if (getElxKeyPathRet != 0) {
@@ -2462,29 +2497,64 @@ int KeyManager::SetDirectoryElPolicy(unsigned int user, KeyType type, const std:
             std::to_string(type), "getElxKeyPath ret =" + std::to_string(getElxKeyPathRet));
         return -ENOENT;
     }
-    for (auto item : vec) {
-        int ret = LoadAndSetPolicy(keyPath.c_str(), item.path.c_str());
+    ret = LoadPolicyContext(keyPath.c_str(), &ctx);
+    if (ret != 0) {
+        LOGE("[L3:KeyManager] SetDirectoryElPolicy: failed to load el policy, ret=%{public}d", ret);
+        return E_LOAD_AND_SET_POLICY_ERR;
+    }
+    if (type == EL3_KEY || type == EL4_KEY) {
+        ret = LoadSdpPolicyContext(eceSeceKeyPath.c_str(), static_cast<int>(type), &ctx);
         if (ret != 0) {
-            LOGE("[L3:KeyManager] SetDirectoryElPolicy: failed to set directory el policy, ret=%{public}d,"
-                "path=%{public}s", ret, item.path.c_str());
-            return E_LOAD_AND_SET_POLICY_ERR;
+            LOGE("[L3:KeyManager] SetDirectoryElPolicy: failed to load ece/sece policy");
+            StorageRadar::ReportUpdateUserAuth("SetDirectoryElPolicy::LoadSdpPolicyContext", user,
+                E_LOAD_AND_SET_ECE_POLICY_ERR, "EL" + std::to_string(type), "LoadSdpPolicyContext ret ="
+                + std::to_string(ret) + " eceSeceKeyPath:" + eceSeceKeyPath);
+            return E_LOAD_AND_SET_ECE_POLICY_ERR;
         }
     }
-    if (type == EL3_KEY || type == EL4_KEY) {
-        for (auto item : vec) {
-            int32_t ret = LoadAndSetEceAndSecePolicy(eceSeceKeyPath.c_str(), item.path.c_str(), static_cast<int>(type));
-            if (ret != 0) {
-                LOGE("[L3:KeyManager] SetDirectoryElPolicy: failed to set directory ece/sece policy");
-                StorageRadar::ReportUpdateUserAuth("SetDirectoryElPolicy::LoadAndSetEceAndSecePolicy", user,
-                    E_LOAD_AND_SET_ECE_POLICY_ERR, "EL" + std::to_string(type), "LoadAndSetEceAndSecePolicy ret ="
-                    + std::to_string(ret) + " path:" + item.path +  "eceSeceKeyPath:"+ eceSeceKeyPath);
-                return E_LOAD_AND_SET_ECE_POLICY_ERR;
-            }
+    return E_OK;
+}
+
+int KeyManager::ApplyDirectoryElPolicy(unsigned int user, KeyType type, const FscryptPolicyContext &ctx,
+                                       const std::vector<FileList> &vec)
+{
+    // Open every directory first so a missing one fails the batch before any policy is set.
+    std::vector<int> dirFds;
+    dirFds.reserve(vec.size());
+    int ret = E_OK;
+    for (const auto &item : vec) {
+        int fd = OpenPolicyDir(item.path.c_str());
+        if (fd < 0) {
+            LOGE("[L3:KeyManager] SetDirectoryElPolicy: failed to open directory, ret=%{public}d,"
+                "path=%{public}s", fd, item.path.c_str());
+            ret = E_LOAD_AND_SET_POLICY_ERR;
+            break;
         }
+        dirFds.push_back(fd);
     }
-    LOGW("[L3:KeyManager] SetDirectoryElPolicy: <<< EXIT SUCCESS <<< [user %{public}u el policy set successfully]",
-        user);
-    return 0;
+    bool needSdp = (type == EL3_KEY || type == EL4_KEY);
+    for (size_t i = 0; ret == E_OK && i < dirFds.size(); i++) {
+        const std::string &path = vec[i].path;
+        int err = SetPolicyByFd(&ctx, dirFds[i], path.c_str());
+        if (err != 0) {
+            LOGE("[L3:KeyManager] SetDirectoryElPolicy: failed to set directory el policy, ret=%{public}d,"
+                "path=%{public}s", err, path.c_str());
+            ret = E_LOAD_AND_SET_POLICY_ERR;
+            break;
+        }
+        err = needSdp ? SetSdpPolicyByFd(&ctx, dirFds[i]) : 0;
+        if (err != 0) {
+            LOGE("[L3:KeyManager] SetDirectoryElPolicy: failed to set directory ece/sece policy");
+            StorageRadar::ReportUpdateUserAuth("SetDirectoryElPolicy::SetSdpPolicyByFd", user,
+                E_LOAD_AND_SET_ECE_POLICY_ERR, "EL" + std::to_string(type), "SetSdpPolicyByFd ret ="
+                + std::to_string(err) + " path:" + path);
+            ret = E_LOAD_AND_SET_ECE_POLICY_ERR;
+        }
+    }
+    for (int fd : dirFds) {
+        close(fd);
+    }
+    return ret;
 }
 
 int32_t KeyManager::SetDirEncryptionPolicy(uint32_t userId, const std::string &dirPath,
@@ -2758,40 +2828,21 @@ int KeyManager::GetFileEncryptStatus(uint32_t userId, bool &isEncrypted, bool ne
 {
     LOGD("[L3:KeyManager] GetFileEncryptStatus: >>> ENTER <<< [userId=%{public}u, needCheckDirMount=%{public}d]",
          userId, needCheckDirMount);
-    isEncrypted = true;
-    const char rootPath[] = "/data/app/el2/";
-    const char basePath[] = "/base";
-    size_t allPathSize = strlen(rootPath) + strlen(basePath) + 1 + USER_ID_SIZE_VALUE;
-    char *path = reinterpret_cast<char *>(malloc(sizeof(char) * (allPathSize)));
-    if (path == nullptr) {
-        LOGE("[L3:KeyManager] GetFileEncryptStatus: <<< EXIT FAILED <<< [failed to allocate path memory]");
-        return E_MEMORY_OPERATION_ERR;
-    }
-    int len = sprintf_s(path, allPathSize, "%s%u%s", rootPath, userId, basePath);
-    if (len <= 0 || (size_t)len >= allPathSize) {
-        free(path);
-        LOGE("[L3:KeyManager] GetFileEncryptStatus: <<< EXIT FAILED <<< [failed to get base path]");
-        return E_PARAMS_INVALID;
-    }
-    if (access(path, F_OK) != 0) {
-        free(path);
-        LOGE("[L3:KeyManager] GetFileEncryptStatus: cannot access el2 dir, user %{public}u el2 is encrypted", userId);
-        return E_OK;
+    int ret = UserKeyStateTable::GetInstance().GetCeEncrypted(userId, isEncrypted);
+    if (ret != E_OK) {
+        isEncrypted = true;
+        LOGE("[L3:KeyManager] GetFileEncryptStatus: <<< EXIT FAILED <<< [ret=%{public}d]", ret);
+        return ret;
     }
-    std::string el2Path(path);
-    if (!SaveStringToFile(el2Path + EL2_ENCRYPT_TMP_FILE, " ")) {
-        free(path);
-        LOGE("[L3:KeyManager] GetFileEncryptStatus: cannot save el2 file, user %{public}u el2 is encrypted", userId);
+    if (isEncrypted) {
+        LOGD("[L3:KeyManager] GetFileEncryptStatus: user %{public}u el2 is encrypted", userId);
         return E_OK;
     }
-    free(path);
-    int ret = remove((el2Path + EL2_ENCRYPT_TMP_FILE).c_str());
-    LOGD("[L3:KeyManager] GetFileEncryptStatus: remove ret=%{public}d", ret);
     if (needCheckDirMount && !MountManager::GetInstance().CheckMountFileByUser(userId)) {
+        isEncrypted = true;
         LOGI("[L3:KeyManager] GetFileEncryptStatus: virtual directory does not exist");
         return E_OK;
     }
-    isEncrypted = false;
     LOGD("[L3:KeyManager] GetFileEncryptStatus: <<< EXIT SUCCESS <<< [isEncrypted=false]");
     return E_OK;
 }
@@ -0,0 +1,292 @@
+/*
+ * Copyright (c) 2026 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "user_key_state.h"
+
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <unistd.h>
+
+#include "file_ex.h"
+#include "storage_service_errno.h"
+#include "storage_service_log.h"
+#include "utils/storage_radar.h"
+
+namespace OHOS {
+namespace StorageDaemon {
+namespace {
+const std::string EL2_ROOT = "/data/app/el2/";
+const std::string EL2_BASE = "/base";
+const std::string EL2_PROBE_FILE = "/el2_tmp";
+constexpr uint64_t CE_MASK = 0x3;
+constexpr uint64_t SCREEN_LOCKED_BIT = 1ULL << 2;
+constexpr uint64_t FROM_PROBE_BIT = 1ULL << 3;
+constexpr uint32_t GENERATION_SHIFT = 8;
+constexpr int64_t SLOT_FREE = -1;
+constexpr int64_t SLOT_RELEASED = -2;
+
+std::string El2BaseDir(uint32_t userId)
+{
+    return EL2_ROOT + std::to_string(userId) + EL2_BASE;
+}
+
+int64_t NowMs()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+UserKeyStatus Decode(uint64_t word)
+{
+    UserKeyStatus status;
+    status.ce = static_cast<CeKeyState>(word & CE_MASK);
+    status.screenLocked = (word & SCREEN_LOCKED_BIT) != 0;
+    status.fromProbe = (word & FROM_PROBE_BIT) != 0;
+    status.generation = word >> GENERATION_SHIFT;
+    return status;
+}
+
+uint64_t Encode(const UserKeyStatus &status)
+{
+    return static_cast<uint64_t>(status.ce) | (status.screenLocked ? SCREEN_LOCKED_BIT : 0) |
+        (status.fromProbe ? FROM_PROBE_BIT : 0) | (status.generation << GENERATION_SHIFT);
+}
+} // namespace
+
+UserKeyStateTable &UserKeyStateTable::GetInstance()
+{
+    static UserKeyStateTable instance(
+        [](uint32_t userId, bool &isEncrypted) { return ProbeByWrite(El2BaseDir(userId), isEncrypted); },
+        [](uint32_t userId) { return access(El2BaseDir(userId).c_str(), F_OK) == 0; });
+    return instance;
+}
+
+int32_t UserKeyStateTable::ProbeByWrite(const std::string &baseDir, bool &isEncrypted)
+{
+    isEncrypted = true;
+    if (access(baseDir.c_str(), F_OK) != 0) {
+        LOGE("[L3:UserKeyState] ProbeByWrite: cannot access %{public}s, el2 is encrypted", baseDir.c_str());
+        return E_OK;
+    }
+    std::string probeFile = baseDir + EL2_PROBE_FILE;
+    if (!SaveStringToFile(probeFile, " ")) {
+        LOGE("[L3:UserKeyState] ProbeByWrite: cannot save %{public}s, el2 is encrypted", probeFile.c_str());
+        return E_OK;
+    }
+    int ret = remove(probeFile.c_str());
+    LOGD("[L3:UserKeyState] ProbeByWrite: remove ret=%{public}d", ret);
+    isEncrypted = false;
+    return E_OK;
+}
+
+UserKeyStateTable::UserKeyStateTable(CeProbeFunc probe, std::function<bool(uint32_t userId)> exists,
+    int64_t selfCheckMs)
+    : probe_(std::move(probe)), exists_(std::move(exists)), selfCheckMs_(selfCheckMs)
+{
+}
+
+const UserKeyStateTable::Slot *UserKeyStateTable::Find(uint32_t userId) const
+{
+    for (const auto &slot : slots_) {
+        int64_t id = slot.userId.load(std::memory_order_acquire);
+        if (id == static_cast<int64_t>(userId)) {
+            return &slot;
+        }
+        if (id == SLOT_FREE) {
+            // Slots are taken in order, so the rest were never used; released ones are skipped.
+            return nullptr;
+        }
+    }
+    return nullptr;
+}
+
+UserKeyStateTable::Slot *UserKeyStateTable::FindOrAdd(uint32_t userId)
+{
+    auto found = const_cast<Slot *>(Find(userId));
+    if (found != nullptr) {
+        return found;
+    }
+    for (auto &slot : slots_) {
+        if (slot.userId.load(std::memory_order_relaxed) < 0) {
+            slot.word.store(0);
+            slot.nextCheckMs.store(NowMs() + selfCheckMs_, std::memory_order_relaxed);
+            slot.userId.store(userId);
+            return &slot;
+        }
+    }
+    LOGE("[L3:UserKeyState] FindOrAdd: table full, user %{public}u falls back to probing", userId);
+    return nullptr;
+}
+
+void UserKeyStateTable::Update(uint32_t userId, const std::function<void(UserKeyStatus &status)> &change)
+{
+    std::lock_guard<std::mutex> lock(addMutex_);
+    Slot *slot = FindOrAdd(userId);
+    if (slot == nullptr) {
+        return;
+    }
+    UserKeyStatus old = Decode(slot->word.load(std::memory_order_relaxed));
+    UserKeyStatus status = old;
+    change(status);
+    bool wasReady = old.ce == CeKeyState::UNLOCKED;
+    bool ready = status.ce == CeKeyState::UNLOCKED;
+    if (wasReady != ready) {
+        status.generation = old.generation + 1;
+    }
+    slot->word.store(Encode(status), std::memory_order_release);
+    if (!status.fromProbe) {
+        slot->nextCheckMs.store(NowMs() + selfCheckMs_, std::memory_order_relaxed);
+    }
+    LOGI("[L3:UserKeyState] Update: user %{public}u ce %{public}u -> %{public}u, screenLocked=%{public}d,"
+        " generation=%{public}" PRIu64, userId, static_cast<uint32_t>(old.ce), static_cast<uint32_t>(status.ce),
+        status.screenLocked, status.generation);
+}
+
+void UserKeyStateTable::OnCeActivated(uint32_t userId)
+{
+    Update(userId, [](UserKeyStatus &status) {
+        status.ce = CeKeyState::UNLOCKED;
+        status.screenLocked = false;
+        status.fromProbe = false;
+    });
+}
+
+void UserKeyStateTable::OnCeInactivated(uint32_t userId)
+{
+    Update(userId, [](UserKeyStatus &status) {
+        status.ce = CeKeyState::LOCKED;
+        status.fromProbe = false;
+    });
+}
+
+void UserKeyStateTable::OnScreenLocked(uint32_t userId)
+{
+    Update(userId, [](UserKeyStatus &status) { status.screenLocked = true; });
+}
+
+void UserKeyStateTable::OnScreenUnlocked(uint32_t userId)
+{
+    Update(userId, [](UserKeyStatus &status) { status.screenLocked = false; });
+}
+
+void UserKeyStateTable::Invalidate(uint32_t userId)
+{
+    if (Find(userId) == nullptr) {
+        return;
+    }
+    Update(userId, [](UserKeyStatus &status) {
+        status.ce = CeKeyState::UNKNOWN;
+        status.fromProbe = false;
+    });
+}
+
+void UserKeyStateTable::Release(uint32_t userId)
+{
+    std::lock_guard<std::mutex> lock(addMutex_);
+    auto slot = const_cast<Slot *>(Find(userId));
+    if (slot == nullptr) {
+        return;
+    }
+    // The id goes first: a reader that loaded the old id rechecks it after reading the word.
+    slot->userId.store(SLOT_RELEASED);
+    slot->word.store(0);
+    LOGI("[L3:UserKeyState] Release: user %{public}u", userId);
+}
+
+bool UserKeyStateTable::Load(const Slot &slot, uint32_t userId, UserKeyStatus &status)
+{
+    uint64_t word = slot.word.load();
+    if (slot.userId.load() != static_cast<int64_t>(userId)) {
+        status = UserKeyStatus();
+        return false;
+    }
+    status = Decode(word);
+    return true;
+}
+
+bool UserKeyStateTable::Get(uint32_t userId, UserKeyStatus &status) const
+{
+    const Slot *slot = Find(userId);
+    if (slot == nullptr) {
+        status = UserKeyStatus();
+        return false;
+    }
+    return Load(*slot, userId, status);
+}
+
+void UserKeyStateTable::ApplyProbe(uint32_t userId, bool isEncrypted, bool selfCheck)
+{
+    if (selfCheck) {
+        Update(userId, [isEncrypted](UserKeyStatus &status) {
+            status.ce = isEncrypted ? CeKeyState::LOCKED : CeKeyState::UNLOCKED;
+            status.fromProbe = false;
+        });
+        return;
+    }
+    // Only a decrypted storage is remembered; on an encrypted one the probe fails before creating a file.
+    if (!isEncrypted) {
+        Update(userId, [](UserKeyStatus &status) {
+            if (status.ce == CeKeyState::UNKNOWN) {
+                status.ce = CeKeyState::UNLOCKED;
+                status.fromProbe = true;
+            }
+        });
+    }
+}
+
+int32_t UserKeyStateTable::GetCeEncrypted(uint32_t userId, bool &isEncrypted)
+{
+    isEncrypted = true;
+    UserKeyStatus status;
+    Slot *slot = const_cast<Slot *>(Find(userId));
+    if (slot != nullptr && !Load(*slot, userId, status)) {
+        slot = nullptr;
+    }
+    if (status.ce == CeKeyState::UNKNOWN) {
+        int32_t ret = probe_(userId, isEncrypted);
+        if (ret == E_OK) {
+            ApplyProbe(userId, isEncrypted, false);
+        }
+        return ret;
+    }
+    if (status.fromProbe) {
+        if (!exists_(userId)) {
+            LOGI("[L3:UserKeyState] GetCeEncrypted: el2 dir of user %{public}u is gone", userId);
+            Invalidate(userId);
+            return E_OK;
+        }
+        isEncrypted = false;
+        return E_OK;
+    }
+    isEncrypted = status.ce == CeKeyState::LOCKED;
+    int64_t now = NowMs();
+    int64_t due = slot->nextCheckMs.load(std::memory_order_relaxed);
+    if (now < due || !slot->nextCheckMs.compare_exchange_strong(due, now + selfCheckMs_)) {
+        return E_OK;
+    }
+    bool probed = true;
+    if (probe_(userId, probed) == E_OK && probed != isEncrypted) {
+        LOGE("[L3:UserKeyState] GetCeEncrypted: self check of user %{public}u found encrypted=%{public}d, state"
+            " said %{public}d", userId, probed, isEncrypted);
+        StorageService::StorageRadar::ReportUserKeyResult("UserKeyStateTable::GetCeEncrypted", userId, E_ERR,
+            "EL2", "self check mismatch, probed=" + std::to_string(probed));
+        ApplyProbe(userId, probed, true);
+        isEncrypted = probed;
+    }
+    return E_OK;
+}
+} // namespace StorageDaemon
+} // namespace OHOS
@@ -14,16 +14,49 @@
  */
 #include "key_backup.h"
 
+#include <fcntl.h>
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include <map>
+#include <sys/syscall.h>
+#include <unistd.h>
 
 #include "directory_ex.h"
 #include "file_ex.h"
+#include "storage_service_errno.h"
 
 using namespace std;
 using namespace testing::ext;
 using namespace testing;
 
+namespace {
+uint32_t g_fsyncCount = 0;
+uint32_t g_readCount = 0;
+uint64_t g_readBytes = 0;
+}
+
+extern "C" int fsync(int fd)
+{
+    g_fsyncCount++;
+    return static_cast<int>(syscall(SYS_fsync, fd));
+}
+
+extern "C" int fdatasync(int fd)
+{
+    g_fsyncCount++;
+    return static_cast<int>(syscall(SYS_fdatasync, fd));
+}
+
+extern "C" ssize_t read(int fd, void *buf, size_t count)
+{
+    ssize_t ret = syscall(SYS_read, fd, buf, count);
+    g_readCount++;
+    if (ret > 0) {
+        g_readBytes += static_cast<uint64_t>(ret);
+    }
+    return ret;
+}
+
 namespace OHOS::StorageDaemon {
 constexpr static mode_t DEFAULT_WRITE_FILE_PERM = 0644;
 constexpr static uint32_t MAX_FILE_NUM = 5;
@@ -47,6 +80,7 @@ struct FileNode {
     std::string origFile;
     std::string backFile;
     bool isSame;
+    bool preferBack = false;
 };
 
 void KeyBackupTest::SetUpTestCase(void)
@@ -787,4 +821,210 @@ HWTEST_F(KeyBackupTest, KeyBackup_GetFileList_001, TestSize.Level1)
     unlink(f2.c_str());
     GTEST_LOG_(INFO) << "KeyBackup_GetFileList_001 end";
 }
+namespace {
+const string MIX_KEY_DIR = TEST_PATH + "/mix/100";
+const string MIX_BACKUP_DIR = TEST_PATH + "/mix_bak/100";
+const std::map<std::string, std::string> MIX_KEY_FILES = {
+    {"encrypted", std::string(80, 'e')},
+    {"sec_discard", std::string(CRYPTO_KEY_SECDISC_SIZE, 's')},
+    {"shield", std::string(64, 'h')},
+    {"need_update", "1"},
+};
+
+void PrepareMixKeyDirs()
+{
+    ForceRemoveDirectory(TEST_PATH + "/mix");
+    ForceRemoveDirectory(TEST_PATH + "/mix_bak");
+    ForceCreateDirectory(MIX_KEY_DIR + PATH_LATEST);
+    ForceCreateDirectory(MIX_BACKUP_DIR + PATH_LATEST);
+    for (const auto &[name, data] : MIX_KEY_FILES) {
+        SaveStringToFile(MIX_KEY_DIR + PATH_LATEST + "/" + name, data);
+        SaveStringToFile(MIX_BACKUP_DIR + PATH_LATEST + "/" + name, data);
+    }
+}
+
+void SetMtime(const std::string &path, time_t sec)
+{
+    struct timespec times[2] = {{sec, 0}, {sec, 0}};
+    utimensat(AT_FDCWD, path.c_str(), times, 0);
+}
+
+// Stands in for BaseKey::DoRestoreKey: succeeds only when every staged file holds the good content.
+bool TryRestoreFromGoodFiles(const std::string &keyPath, uint32_t &attempts)
+{
+    attempts++;
+    for (const auto &[name, data] : MIX_KEY_FILES) {
+        std::string staged;
+        if (!LoadStringFromFile(keyPath + "/" + name, staged) || staged != data) {
+            return false;
+        }
+    }
+    return true;
+}
+} // namespace
+
+/**
+ * @tc.name: KeyBackup_RestoreKeyMix_001
+ * @tc.desc: Verify broken copies are picked per file, without combination search or fsyncs on staging.
+ * @tc.type: FUNC
+ * @tc.require: IAHHWW
+ */
+HWTEST_F(KeyBackupTest, KeyBackup_RestoreKeyMix_001, TestSize.Level1)
+{
+    GTEST_LOG_(INFO) << "KeyBackup_RestoreKeyMix_001 Start";
+    PrepareMixKeyDirs();
+    std::string origLatest = MIX_KEY_DIR + PATH_LATEST;
+    std::string backLatest = MIX_BACKUP_DIR + PATH_LATEST;
+    // Zero-filled by an interrupted RemoveNode, torn and emptied writes, spread over both copies.
+    ASSERT_TRUE(SaveStringToFile(origLatest + "/encrypted", std::string(80, '\0')));
+    ASSERT_TRUE(SaveStringToFile(origLatest + "/sec_discard", std::string(100, 's')));
+    ASSERT_TRUE(SaveStringToFile(backLatest + "/shield", ""));
+    constexpr uint32_t corruptNum = 3;
+
+    uint32_t attempts = 0;
+    g_fsyncCount = 0;
+    auto ret = KeyBackup::GetInstance().RestoreKeyMix(MIX_KEY_DIR, MIX_BACKUP_DIR,
+        [&attempts](const std::string &keyPath) { return TryRestoreFromGoodFiles(keyPath, attempts); });
+    EXPECT_EQ(ret, E_OK);
+    EXPECT_EQ(attempts, 1U);
+    // Only the repaired files are synced, plus one directory sync for each of the two repaired dirs.
+    constexpr uint32_t repairedDirNum = 2;
+    EXPECT_EQ(g_fsyncCount, corruptNum + repairedDirNum);
+    EXPECT_TRUE(TryRestoreFromGoodFiles(origLatest, attempts));
+    EXPECT_TRUE(TryRestoreFromGoodFiles(backLatest, attempts));
+    EXPECT_NE(access((TEST_PATH + "/mix_bak/temp").c_str(), F_OK), 0);
+
+    ASSERT_TRUE(SaveStringToFile(origLatest + "/shield", std::string(64, '\0')));
+    ASSERT_TRUE(SaveStringToFile(backLatest + "/shield", ""));
+    ASSERT_TRUE(SaveStringToFile(backLatest + "/encrypted", std::string(80, 'x')));
+    EXPECT_NE(KeyBackup::GetInstance().RestoreKeyMix(MIX_KEY_DIR, MIX_BACKUP_DIR,
+        [&attempts](const std::string &keyPath) { return TryRestoreFromGoodFiles(keyPath, attempts); }), E_OK);
+    GTEST_LOG_(INFO) << "KeyBackup_RestoreKeyMix_001 end";
+}
+
+/**
+ * @tc.name: KeyBackup_RestoreKeyMix_002
+ * @tc.desc: Verify copies that both look intact are tried newest first.
+ * @tc.type: FUNC
+ * @tc.require: IAHHWW
+ */
+HWTEST_F(KeyBackupTest, KeyBackup_RestoreKeyMix_002, TestSize.Level1)
+{
+    GTEST_LOG_(INFO) << "KeyBackup_RestoreKeyMix_002 Start";
+    constexpr time_t older = 1000;
+    constexpr time_t newer = 2000;
+    std::string origLatest = MIX_KEY_DIR + PATH_LATEST;
+    std::string backLatest = MIX_BACKUP_DIR + PATH_LATEST;
+    for (bool goodIsNewer : {true, false}) {
+        PrepareMixKeyDirs();
+        ASSERT_TRUE(SaveStringToFile(origLatest + "/encrypted", ""));
+        ASSERT_TRUE(SaveStringToFile(origLatest + "/shield", std::string(64, 'H')));
+        SetMtime(origLatest + "/shield", goodIsNewer ? older : newer);
+        SetMtime(backLatest + "/shield", goodIsNewer ? newer : older);
+
+        uint32_t attempts = 0;
+        auto ret = KeyBackup::GetInstance().RestoreKeyMix(MIX_KEY_DIR, MIX_BACKUP_DIR,
+            [&attempts](const std::string &keyPath) { return TryRestoreFromGoodFiles(keyPath, attempts); });
+        EXPECT_EQ(ret, E_OK);
+        EXPECT_EQ(attempts, goodIsNewer ? 1U : 2U);
+    }
+    ForceRemoveDirectory(TEST_PATH + "/mix");
+    ForceRemoveDirectory(TEST_PATH + "/mix_bak");
+    GTEST_LOG_(INFO) << "KeyBackup_RestoreKeyMix_002 end";
+}
+/**
+ * @tc.name: KeyBackup_CheckAndCopyFiles_002
+ * @tc.desc: Verify an unchanged key dir is synced from metadata alone, and a changed file is still copied.
+ * @tc.type: FUNC
+ * @tc.require: IAHHWW
+ */
+HWTEST_F(KeyBackupTest, KeyBackup_CheckAndCopyFiles_002, TestSize.Level1)
+{
+    GTEST_LOG_(INFO) << "KeyBackup_CheckAndCopyFiles_002 Start";
+    PrepareMixKeyDirs();
+    std::string origLatest = MIX_KEY_DIR + PATH_LATEST;
+    std::string backLatest = MIX_BACKUP_DIR + PATH_LATEST;
+    ForceRemoveDirectory(backLatest);
+
+    g_fsyncCount = 0;
+    g_readBytes = 0;
+    KeyBackup::GetInstance().CheckAndCopyFiles(origLatest, backLatest);
+    // copy_file_range moves the data, one data sync per file and a single sync for the directory.
+    EXPECT_EQ(g_readBytes, 0U);
+    EXPECT_EQ(g_fsyncCount, MIX_KEY_FILES.size() + 1);
+    uint32_t attempts = 0;
+    EXPECT_TRUE(TryRestoreFromGoodFiles(backLatest, attempts));
+
+    // Let the stamps age past the racy window, then the first compare reads both sides once.
+    constexpr useconds_t racyWaitUs = 200 * 1000;
+    usleep(racyWaitUs);
+    uint64_t keyBytes = 0;
+    for (const auto &[name, data] : MIX_KEY_FILES) {
+        keyBytes += data.size();
+    }
+    g_fsyncCount = 0;
+    g_readBytes = 0;
+    KeyBackup::GetInstance().CheckAndCopyFiles(origLatest, backLatest);
+    EXPECT_EQ(g_readBytes, keyBytes * 2);
+    EXPECT_EQ(g_fsyncCount, 0U);
+
+    g_readCount = 0;
+    g_readBytes = 0;
+    KeyBackup::GetInstance().CheckAndCopyFiles(origLatest, backLatest);
+    GTEST_LOG_(INFO) << "unchanged key dir: read calls " << g_readCount << ", bytes " << g_readBytes
+                     << ", syncs " << g_fsyncCount;
+    EXPECT_EQ(g_readCount, 0U);
+    EXPECT_EQ(g_readBytes, 0U);
+    EXPECT_EQ(g_fsyncCount, 0U);
+
+    ASSERT_TRUE(SaveStringToFile(origLatest + "/shield", std::string(64, 'H')));
+    KeyBackup::GetInstance().CheckAndCopyFiles(origLatest, backLatest);
+    EXPECT_EQ(KeyBackup::GetInstance().CompareFile(origLatest + "/shield", backLatest + "/shield"), 0);
+    EXPECT_NE(access((backLatest + "/shield.bak_tmp").c_str(), F_OK), 0);
+    ForceRemoveDirectory(TEST_PATH + "/mix");
+    ForceRemoveDirectory(TEST_PATH + "/mix_bak");
+    GTEST_LOG_(INFO) << "KeyBackup_CheckAndCopyFiles_002 end";
+}
+
+/**
+ * @tc.name: KeyBackup_StaleCopy_001
+ * @tc.desc: Verify a temp file left by an interrupted copy is neither copied nor listed, and is removed on restore.
+ * @tc.type: FUNC
+ * @tc.require: IAHHWW
+ */
+HWTEST_F(KeyBackupTest, KeyBackup_StaleCopy_001, TestSize.Level1)
+{
+    GTEST_LOG_(INFO) << "KeyBackup_StaleCopy_001 Start";
+    PrepareMixKeyDirs();
+    std::string origLatest = MIX_KEY_DIR + PATH_LATEST;
+    std::string backLatest = MIX_BACKUP_DIR + PATH_LATEST;
+    ForceRemoveDirectory(backLatest);
+    std::string origStale = origLatest + "/shield.bak_tmp";
+    ASSERT_TRUE(SaveStringToFile(origStale, std::string(32, 'x')));
+
+    KeyBackup::GetInstance().CheckAndCopyFiles(origLatest, backLatest);
+    EXPECT_EQ(KeyBackup::GetInstance().CompareFile(origLatest + "/shield", backLatest + "/shield"), 0);
+    EXPECT_NE(access((backLatest + "/shield.bak_tmp").c_str(), F_OK), 0);
+
+    std::string backStale = backLatest + "/encrypted.bak_tmp";
+    ASSERT_TRUE(SaveStringToFile(backStale, std::string(16, 'y')));
+    std::vector<struct FileNode> fileList;
+    uint32_t diffNum = 0;
+    EXPECT_EQ(KeyBackup::GetInstance().GetFileList(origLatest, backLatest, fileList, diffNum), 0);
+    EXPECT_EQ(fileList.size(), MIX_KEY_FILES.size());
+    EXPECT_EQ(diffNum, 0U);
+    for (const auto &node : fileList) {
+        EXPECT_EQ(node.baseName.find(".bak_tmp"), std::string::npos);
+    }
+
+    KeyBackup::GetInstance().RemoveStaleCopies(origLatest);
+    KeyBackup::GetInstance().RemoveStaleCopies(backLatest);
+    EXPECT_NE(access(origStale.c_str(), F_OK), 0);
+    EXPECT_NE(access(backStale.c_str(), F_OK), 0);
+    EXPECT_EQ(access((origLatest + "/shield").c_str(), F_OK), 0);
+    EXPECT_EQ(access((backLatest + "/encrypted").c_str(), F_OK), 0);
+    ForceRemoveDirectory(TEST_PATH + "/mix");
+    ForceRemoveDirectory(TEST_PATH + "/mix_bak");
+    GTEST_LOG_(INFO) << "KeyBackup_StaleCopy_001 end";
+}
 }
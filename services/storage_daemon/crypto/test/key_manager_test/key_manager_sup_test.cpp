@@ -30,6 +30,7 @@
 #include "fscrypt_key_v2.h"
 #include "mount_manager_mock.h"
 #include "storage_service_errno.h"
+#include "user_key_state.h"
 #include "utils/file_utils.h"
 
 using namespace std;
@@ -125,6 +126,34 @@ HWTEST_F(KeyManagerSupTest, KeyManager_GetFileEncryptStatus_000, TestSize.Level1
     GTEST_LOG_(INFO) << "KeyManager_GetFileEncryptStatus_000 end";
 }
 
+/**
+ * @tc.name: KeyManager_GetFileEncryptStatus_001
+ * @tc.desc: Verify GetFileEncryptStatus follows the tracked key state without probing the el2 directory.
+ * @tc.type: FUNC
+ */
+HWTEST_F(KeyManagerSupTest, KeyManager_GetFileEncryptStatus_001, TestSize.Level1)
+{
+    GTEST_LOG_(INFO) << "KeyManager_GetFileEncryptStatus_001 Start";
+    unsigned int userId = 1001;
+    bool isEncrypted = false;
+    string basePath = "/data/app/el2/" + to_string(userId);
+    UserKeyStateTable::GetInstance().OnCeActivated(userId);
+    EXPECT_EQ(KeyManager::GetInstance().GetFileEncryptStatus(userId, isEncrypted), E_OK);
+    EXPECT_EQ(isEncrypted, false);
+
+    EXPECT_TRUE(OHOS::ForceCreateDirectory(basePath + "/base"));
+    UserKeyStateTable::GetInstance().OnCeInactivated(userId);
+    EXPECT_EQ(KeyManager::GetInstance().GetFileEncryptStatus(userId, isEncrypted), E_OK);
+    EXPECT_EQ(isEncrypted, true);
+
+    UserKeyStateTable::GetInstance().Invalidate(userId);
+    EXPECT_EQ(KeyManager::GetInstance().GetFileEncryptStatus(userId, isEncrypted), E_OK);
+    EXPECT_EQ(isEncrypted, false);
+    UserKeyStateTable::GetInstance().Release(userId);
+    EXPECT_TRUE(OHOS::ForceRemoveDirectory(basePath));
+    GTEST_LOG_(INFO) << "KeyManager_GetFileEncryptStatus_001 end";
+}
+
 /**
  * @tc.name: KeyManager_GenerateAppkey_001
  * @tc.desc: Verify the GenerateAppkey function.
@@ -42,6 +42,11 @@ using namespace testing;
 
 namespace {
 constexpr const char *UECE_PATH = "/dev/fbex_uece";
+
+int OpenFakePolicyDir(const char *)
+{
+    return open("/dev/null", O_RDONLY | O_CLOEXEC);
+}
 }
 
 namespace OHOS::StorageDaemon {
@@ -616,11 +621,15 @@ HWTEST_F(KeyManagerTest, KeyManager_SetDirectoryElPolicy, TestSize.Level1)
     KeyManager::GetInstance().SaveUserElKey(user, EL1_KEY, tmpKey);
     vec.push_back({1, "/test"});
     EXPECT_CALL(*fscryptControlMock_, KeyCtrlHasFscryptSyspara()).WillOnce(Return(true));
-    EXPECT_CALL(*fscryptControlMock_, LoadAndSetPolicy(_, _)).WillOnce(Return(-EINVAL));
+    EXPECT_CALL(*fscryptControlMock_, LoadPolicyContext(_, _)).WillOnce(Return(0));
+    EXPECT_CALL(*fscryptControlMock_, OpenPolicyDir(_)).WillOnce(Invoke(OpenFakePolicyDir));
+    EXPECT_CALL(*fscryptControlMock_, SetPolicyByFd(_, _, _)).WillOnce(Return(-EINVAL));
     EXPECT_EQ(KeyManager::GetInstance().SetDirectoryElPolicy(user, type, vec), E_LOAD_AND_SET_POLICY_ERR);
 
     EXPECT_CALL(*fscryptControlMock_, KeyCtrlHasFscryptSyspara()).WillOnce(Return(true));
-    EXPECT_CALL(*fscryptControlMock_, LoadAndSetPolicy(_, _)).WillOnce(Return(0));
+    EXPECT_CALL(*fscryptControlMock_, LoadPolicyContext(_, _)).WillOnce(Return(0));
+    EXPECT_CALL(*fscryptControlMock_, OpenPolicyDir(_)).WillOnce(Invoke(OpenFakePolicyDir));
+    EXPECT_CALL(*fscryptControlMock_, SetPolicyByFd(_, _, _)).WillOnce(Return(0));
     EXPECT_EQ(KeyManager::GetInstance().SetDirectoryElPolicy(user, type, vec), 0);
 
     int eL6Key = 6;
@@ -635,13 +644,16 @@ HWTEST_F(KeyManagerTest, KeyManager_SetDirectoryElPolicy, TestSize.Level1)
     KeyManager::GetInstance().SaveUserElKey(user, EL2_KEY, tmpKey);
     KeyManager::GetInstance().SaveUserElKey(user, EL3_KEY, tmpKey);
     EXPECT_CALL(*fscryptControlMock_, KeyCtrlHasFscryptSyspara()).WillOnce(Return(true));
-    EXPECT_CALL(*fscryptControlMock_, LoadAndSetPolicy(_, _)).WillOnce(Return(0));
-    EXPECT_CALL(*fscryptControlMock_, LoadAndSetEceAndSecePolicy(_, _, _)).WillOnce(Return(-EINVAL));
+    EXPECT_CALL(*fscryptControlMock_, LoadPolicyContext(_, _)).WillOnce(Return(0));
+    EXPECT_CALL(*fscryptControlMock_, LoadSdpPolicyContext(_, _, _)).WillOnce(Return(-EINVAL));
     EXPECT_EQ(KeyManager::GetInstance().SetDirectoryElPolicy(user, type, vec), E_LOAD_AND_SET_ECE_POLICY_ERR);
 
     EXPECT_CALL(*fscryptControlMock_, KeyCtrlHasFscryptSyspara()).WillOnce(Return(true));
-    EXPECT_CALL(*fscryptControlMock_, LoadAndSetPolicy(_, _)).WillOnce(Return(0));
-    EXPECT_CALL(*fscryptControlMock_, LoadAndSetEceAndSecePolicy(_, _, _)).WillOnce(Return(0));
+    EXPECT_CALL(*fscryptControlMock_, LoadPolicyContext(_, _)).WillOnce(Return(0));
+    EXPECT_CALL(*fscryptControlMock_, LoadSdpPolicyContext(_, _, _)).WillOnce(Return(0));
+    EXPECT_CALL(*fscryptControlMock_, OpenPolicyDir(_)).WillOnce(Invoke(OpenFakePolicyDir));
+    EXPECT_CALL(*fscryptControlMock_, SetPolicyByFd(_, _, _)).WillOnce(Return(0));
+    EXPECT_CALL(*fscryptControlMock_, SetSdpPolicyByFd(_, _)).WillOnce(Return(0));
     EXPECT_EQ(KeyManager::GetInstance().SetDirectoryElPolicy(user, type, vec), 0);
     GTEST_LOG_(INFO) << "KeyManager_SetDirectoryElPolicy end";
 }
@@ -1449,11 +1461,18 @@ HWTEST_F(KeyManagerTest, KeyManager_SetDirectoryElPolicy_001, TestSize.Level1)
 
     KeyManager::GetInstance().SaveUserElKey(user, EL1_KEY, elKey);
     EXPECT_CALL(*fscryptControlMock_, KeyCtrlHasFscryptSyspara()).WillOnce(Return(true));
-    EXPECT_CALL(*fscryptControlMock_, LoadAndSetPolicy(_, _)).WillOnce(Return(-1));
+    EXPECT_CALL(*fscryptControlMock_, LoadPolicyContext(_, _)).WillOnce(Return(-1));
     EXPECT_EQ(KeyManager::GetInstance().SetDirectoryElPolicy(user, EL1_KEY, vec), E_LOAD_AND_SET_POLICY_ERR);
 
     EXPECT_CALL(*fscryptControlMock_, KeyCtrlHasFscryptSyspara()).WillOnce(Return(true));
-    EXPECT_CALL(*fscryptControlMock_, LoadAndSetPolicy(_, _)).WillOnce(Return(0));
+    EXPECT_CALL(*fscryptControlMock_, LoadPolicyContext(_, _)).WillOnce(Return(0));
+    EXPECT_CALL(*fscryptControlMock_, OpenPolicyDir(_)).WillOnce(Return(-ENOENT));
+    EXPECT_EQ(KeyManager::GetInstance().SetDirectoryElPolicy(user, EL1_KEY, vec), E_LOAD_AND_SET_POLICY_ERR);
+
+    EXPECT_CALL(*fscryptControlMock_, KeyCtrlHasFscryptSyspara()).WillOnce(Return(true));
+    EXPECT_CALL(*fscryptControlMock_, LoadPolicyContext(_, _)).WillOnce(Return(0));
+    EXPECT_CALL(*fscryptControlMock_, OpenPolicyDir(_)).WillOnce(Invoke(OpenFakePolicyDir));
+    EXPECT_CALL(*fscryptControlMock_, SetPolicyByFd(_, _, _)).WillOnce(Return(0));
     EXPECT_EQ(KeyManager::GetInstance().SetDirectoryElPolicy(user, EL1_KEY, vec), 0);
     KeyManager::GetInstance().DeleteElKey(user, EL1_KEY);
     GTEST_LOG_(INFO) << "KeyManager_SetDirectoryElPolicy_001 end";
@@ -1478,7 +1497,9 @@ HWTEST_F(KeyManagerTest, KeyManager_SetDirectoryElPolicy_002, TestSize.Level1)
 
     KeyManager::GetInstance().SaveUserElKey(user, EL2_KEY, elKey);
     EXPECT_CALL(*fscryptControlMock_, KeyCtrlHasFscryptSyspara()).WillOnce(Return(true));
-    EXPECT_CALL(*fscryptControlMock_, LoadAndSetPolicy(_, _)).WillOnce(Return(0));
+    EXPECT_CALL(*fscryptControlMock_, LoadPolicyContext(_, _)).WillOnce(Return(0));
+    EXPECT_CALL(*fscryptControlMock_, OpenPolicyDir(_)).WillOnce(Invoke(OpenFakePolicyDir));
+    EXPECT_CALL(*fscryptControlMock_, SetPolicyByFd(_, _, _)).WillOnce(Return(0));
     EXPECT_EQ(KeyManager::GetInstance().SetDirectoryElPolicy(user, EL2_KEY, vec), 0);
     KeyManager::GetInstance().DeleteElKey(user, EL2_KEY);
     GTEST_LOG_(INFO) << "KeyManager_SetDirectoryElPolicy_002 end";
@@ -1504,13 +1525,19 @@ HWTEST_F(KeyManagerTest, KeyManager_SetDirectoryElPolicy_003, TestSize.Level1)
 
     KeyManager::GetInstance().SaveUserElKey(user, EL3_KEY, elKey);
     EXPECT_CALL(*fscryptControlMock_, KeyCtrlHasFscryptSyspara()).WillOnce(Return(true));
-    EXPECT_CALL(*fscryptControlMock_, LoadAndSetPolicy(_, _)).WillOnce(Return(0));
-    EXPECT_CALL(*fscryptControlMock_, LoadAndSetEceAndSecePolicy(_, _, _)).WillOnce(Return(-1));
+    EXPECT_CALL(*fscryptControlMock_, LoadPolicyContext(_, _)).WillOnce(Return(0));
+    EXPECT_CALL(*fscryptControlMock_, LoadSdpPolicyContext(_, _, _)).WillOnce(Return(0));
+    EXPECT_CALL(*fscryptControlMock_, OpenPolicyDir(_)).WillOnce(Invoke(OpenFakePolicyDir));
+    EXPECT_CALL(*fscryptControlMock_, SetPolicyByFd(_, _, _)).WillOnce(Return(0));
+    EXPECT_CALL(*fscryptControlMock_, SetSdpPolicyByFd(_, _)).WillOnce(Return(-1));
     EXPECT_EQ(KeyManager::GetInstance().SetDirectoryElPolicy(user, EL3_KEY, vec), E_LOAD_AND_SET_ECE_POLICY_ERR);
 
     EXPECT_CALL(*fscryptControlMock_, KeyCtrlHasFscryptSyspara()).WillOnce(Return(true));
-    EXPECT_CALL(*fscryptControlMock_, LoadAndSetPolicy(_, _)).WillOnce(Return(0));
-    EXPECT_CALL(*fscryptControlMock_, LoadAndSetEceAndSecePolicy(_, _, _)).WillOnce(Return(0));
+    EXPECT_CALL(*fscryptControlMock_, LoadPolicyContext(_, _)).WillOnce(Return(0));
+    EXPECT_CALL(*fscryptControlMock_, LoadSdpPolicyContext(_, _, _)).WillOnce(Return(0));
+    EXPECT_CALL(*fscryptControlMock_, OpenPolicyDir(_)).WillOnce(Invoke(OpenFakePolicyDir));
+    EXPECT_CALL(*fscryptControlMock_, SetPolicyByFd(_, _, _)).WillOnce(Return(0));
+    EXPECT_CALL(*fscryptControlMock_, SetSdpPolicyByFd(_, _)).WillOnce(Return(0));
     EXPECT_EQ(KeyManager::GetInstance().SetDirectoryElPolicy(user, EL3_KEY, vec), 0);
     KeyManager::GetInstance().DeleteElKey(user, EL2_KEY);
     KeyManager::GetInstance().DeleteElKey(user, EL3_KEY);
@@ -1534,14 +1561,19 @@ HWTEST_F(KeyManagerTest, KeyManager_SetDirectoryElPolicy_004, TestSize.Level1)
     KeyManager::GetInstance().SaveUserElKey(user, EL2_KEY, elKey);
     KeyManager::GetInstance().SaveUserElKey(user, EL4_KEY, elKey);
     EXPECT_CALL(*fscryptControlMock_, KeyCtrlHasFscryptSyspara()).WillOnce(Return(true));
-    EXPECT_CALL(*fscryptControlMock_, LoadAndSetPolicy(_, _)).WillOnce(Return(0));
-    EXPECT_CALL(*fscryptControlMock_, LoadAndSetEceAndSecePolicy(_, _, _)).WillOnce(Return(0));
+    EXPECT_CALL(*fscryptControlMock_, LoadPolicyContext(_, _)).WillOnce(Return(0));
+    EXPECT_CALL(*fscryptControlMock_, LoadSdpPolicyContext(_, _, _)).WillOnce(Return(0));
+    EXPECT_CALL(*fscryptControlMock_, OpenPolicyDir(_)).WillOnce(Invoke(OpenFakePolicyDir));
+    EXPECT_CALL(*fscryptControlMock_, SetPolicyByFd(_, _, _)).WillOnce(Return(0));
+    EXPECT_CALL(*fscryptControlMock_, SetSdpPolicyByFd(_, _)).WillOnce(Return(0));
     EXPECT_EQ(KeyManager::GetInstance().SetDirectoryElPolicy(user, EL4_KEY, vec), 0);
     KeyManager::GetInstance().DeleteElKey(user, EL4_KEY);
 
     KeyManager::GetInstance().SaveUserElKey(user, EL5_KEY, elKey);
     EXPECT_CALL(*fscryptControlMock_, KeyCtrlHasFscryptSyspara()).WillOnce(Return(true));
-    EXPECT_CALL(*fscryptControlMock_, LoadAndSetPolicy(_, _)).WillOnce(Return(0));
+    EXPECT_CALL(*fscryptControlMock_, LoadPolicyContext(_, _)).WillOnce(Return(0));
+    EXPECT_CALL(*fscryptControlMock_, OpenPolicyDir(_)).WillOnce(Invoke(OpenFakePolicyDir));
+    EXPECT_CALL(*fscryptControlMock_, SetPolicyByFd(_, _, _)).WillOnce(Return(0));
     EXPECT_EQ(KeyManager::GetInstance().SetDirectoryElPolicy(user, EL5_KEY, vec), 0);
     KeyManager::GetInstance().DeleteElKey(user, EL5_KEY);
 
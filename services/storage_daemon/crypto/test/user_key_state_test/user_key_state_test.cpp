@@ -0,0 +1,402 @@
+/*
+ * Copyright (c) 2026 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <set>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+#include "directory_ex.h"
+#include "storage_service_errno.h"
+#include "user_key_state.h"
+
+namespace OHOS {
+namespace StorageDaemon {
+using namespace testing::ext;
+
+namespace {
+const std::string TEST_ROOT = "/data/local/tmp/user_key_state_test";
+constexpr uint32_t USER_ID = 100;
+constexpr int READ_TIMES = 1000;
+
+std::string BaseDir(uint32_t userId)
+{
+    return TEST_ROOT + "/" + std::to_string(userId) + "/base";
+}
+
+// Stands in for the el2 storage: the probe sees it decrypted while the key is active.
+class FakeKeyOps {
+public:
+    CeProbeFunc Probe()
+    {
+        return [this](uint32_t userId, bool &isEncrypted) {
+            probes_++;
+            isEncrypted = active_.count(userId) == 0;
+            return E_OK;
+        };
+    }
+
+    std::function<bool(uint32_t userId)> Exists()
+    {
+        return [this](uint32_t userId) {
+            exists_++;
+            return active_.count(userId) != 0;
+        };
+    }
+
+    // What KeyManager does around the key operations.
+    void ActiveUserKey(UserKeyStateTable &table, uint32_t userId)
+    {
+        active_.insert(userId);
+        table.OnCeActivated(userId);
+    }
+
+    void InActiveUserKey(UserKeyStateTable &table, uint32_t userId)
+    {
+        active_.erase(userId);
+        table.OnCeInactivated(userId);
+    }
+
+    std::set<uint32_t> active_;
+    std::atomic<int> probes_ { 0 };
+    std::atomic<int> exists_ { 0 };
+};
+
+bool IsEncrypted(UserKeyStateTable &table, uint32_t userId)
+{
+    bool isEncrypted = false;
+    EXPECT_EQ(table.GetCeEncrypted(userId, isEncrypted), E_OK);
+    return isEncrypted;
+}
+} // namespace
+
+class UserKeyStateTest : public testing::Test {
+public:
+    void SetUp() override
+    {
+        (void)ForceRemoveDirectory(TEST_ROOT);
+        ASSERT_TRUE(ForceCreateDirectory(TEST_ROOT));
+    }
+
+    void TearDown() override
+    {
+        (void)ForceRemoveDirectory(TEST_ROOT);
+    }
+};
+
+/**
+ * @tc.name: UserKeyState_Transitions_001
+ * @tc.desc: Verify key operations drive the state and the generation, and reads do not probe.
+ * @tc.type: FUNC
+ */
+HWTEST_F(UserKeyStateTest, UserKeyState_Transitions_001, TestSize.Level1)
+{
+    GTEST_LOG_(INFO) << "UserKeyState_Transitions_001 start";
+    FakeKeyOps ops;
+    UserKeyStateTable table(ops.Probe(), ops.Exists());
+    UserKeyStatus status;
+    EXPECT_FALSE(table.Get(USER_ID, status));
+    EXPECT_EQ(status.ce, CeKeyState::UNKNOWN);
+
+    ops.ActiveUserKey(table, USER_ID);
+    ASSERT_TRUE(table.Get(USER_ID, status));
+    EXPECT_EQ(status.ce, CeKeyState::UNLOCKED);
+    EXPECT_FALSE(status.fromProbe);
+    EXPECT_EQ(status.generation, 1U);
+    for (int i = 0; i < READ_TIMES; i++) {
+        EXPECT_FALSE(IsEncrypted(table, USER_ID));
+    }
+
+    // Screen lock does not change whether CE storage is ready.
+    table.OnScreenLocked(USER_ID);
+    ASSERT_TRUE(table.Get(USER_ID, status));
+    EXPECT_TRUE(status.screenLocked);
+    EXPECT_EQ(status.generation, 1U);
+    EXPECT_FALSE(IsEncrypted(table, USER_ID));
+    table.OnScreenUnlocked(USER_ID);
+    ASSERT_TRUE(table.Get(USER_ID, status));
+    EXPECT_FALSE(status.screenLocked);
+
+    ops.InActiveUserKey(table, USER_ID);
+    ASSERT_TRUE(table.Get(USER_ID, status));
+    EXPECT_EQ(status.ce, CeKeyState::LOCKED);
+    EXPECT_EQ(status.generation, 2U);
+    EXPECT_TRUE(IsEncrypted(table, USER_ID));
+    ops.InActiveUserKey(table, USER_ID);
+    ASSERT_TRUE(table.Get(USER_ID, status));
+    EXPECT_EQ(status.generation, 2U);
+
+    ops.ActiveUserKey(table, USER_ID);
+    EXPECT_FALSE(IsEncrypted(table, USER_ID));
+    ASSERT_TRUE(table.Get(USER_ID, status));
+    EXPECT_EQ(status.generation, 3U);
+    EXPECT_EQ(ops.probes_, 0);
+    EXPECT_EQ(ops.exists_, 0);
+    GTEST_LOG_(INFO) << "UserKeyState_Transitions_001 end";
+}
+
+/**
+ * @tc.name: UserKeyState_Unknown_001
+ * @tc.desc: Verify a user without key operations is probed until found decrypted, then only checked for existence.
+ * @tc.type: FUNC
+ */
+HWTEST_F(UserKeyStateTest, UserKeyState_Unknown_001, TestSize.Level1)
+{
+    GTEST_LOG_(INFO) << "UserKeyState_Unknown_001 start";
+    FakeKeyOps ops;
+    UserKeyStateTable table(ops.Probe(), ops.Exists());
+    EXPECT_TRUE(IsEncrypted(table, USER_ID));
+    EXPECT_TRUE(IsEncrypted(table, USER_ID));
+    EXPECT_EQ(ops.probes_, 2);
+    UserKeyStatus status;
+    EXPECT_FALSE(table.Get(USER_ID, status));
+
+    // E.g. the daemon restarted while the user was unlocked.
+    ops.active_.insert(USER_ID);
+    EXPECT_FALSE(IsEncrypted(table, USER_ID));
+    EXPECT_EQ(ops.probes_, 3);
+    ASSERT_TRUE(table.Get(USER_ID, status));
+    EXPECT_EQ(status.ce, CeKeyState::UNLOCKED);
+    EXPECT_TRUE(status.fromProbe);
+    EXPECT_FALSE(IsEncrypted(table, USER_ID));
+    EXPECT_EQ(ops.probes_, 3);
+    EXPECT_EQ(ops.exists_, 1);
+
+    ops.active_.erase(USER_ID);
+    EXPECT_TRUE(IsEncrypted(table, USER_ID));
+    ASSERT_TRUE(table.Get(USER_ID, status));
+    EXPECT_EQ(status.ce, CeKeyState::UNKNOWN);
+
+    // A key operation takes over from the probe, and Invalidate hands it back.
+    ops.ActiveUserKey(table, USER_ID);
+    ASSERT_TRUE(table.Get(USER_ID, status));
+    EXPECT_FALSE(status.fromProbe);
+    table.Invalidate(USER_ID);
+    int probes = ops.probes_;
+    EXPECT_FALSE(IsEncrypted(table, USER_ID));
+    EXPECT_EQ(ops.probes_, probes + 1);
+    GTEST_LOG_(INFO) << "UserKeyState_Unknown_001 end";
+}
+
+/**
+ * @tc.name: UserKeyState_SelfCheck_001
+ * @tc.desc: Verify the state is probed once per self-check interval and the probe wins on a mismatch.
+ * @tc.type: FUNC
+ */
+HWTEST_F(UserKeyStateTest, UserKeyState_SelfCheck_001, TestSize.Level1)
+{
+    GTEST_LOG_(INFO) << "UserKeyState_SelfCheck_001 start";
+    FakeKeyOps ops;
+    UserKeyStateTable table(ops.Probe(), ops.Exists(), 0);
+    ops.ActiveUserKey(table, USER_ID);
+    EXPECT_FALSE(IsEncrypted(table, USER_ID));
+    EXPECT_EQ(ops.probes_, 1);
+
+    // The key went away without going through InActiveUserKey.
+    ops.active_.erase(USER_ID);
+    EXPECT_TRUE(IsEncrypted(table, USER_ID));
+    UserKeyStatus status;
+    ASSERT_TRUE(table.Get(USER_ID, status));
+    EXPECT_EQ(status.ce, CeKeyState::LOCKED);
+    EXPECT_EQ(status.generation, 2U);
+
+    FakeKeyOps slowOps;
+    UserKeyStateTable slowTable(slowOps.Probe(), slowOps.Exists(), KEY_STATE_SELF_CHECK_MS);
+    slowOps.ActiveUserKey(slowTable, USER_ID);
+    slowOps.active_.erase(USER_ID);
+    for (int i = 0; i < READ_TIMES; i++) {
+        EXPECT_FALSE(IsEncrypted(slowTable, USER_ID));
+    }
+    EXPECT_EQ(slowOps.probes_, 0);
+    GTEST_LOG_(INFO) << "UserKeyState_SelfCheck_001 end";
+}
+
+/**
+ * @tc.name: UserKeyState_Full_001
+ * @tc.desc: Verify users beyond the table size fall back to probing.
+ * @tc.type: FUNC
+ */
+HWTEST_F(UserKeyStateTest, UserKeyState_Full_001, TestSize.Level1)
+{
+    GTEST_LOG_(INFO) << "UserKeyState_Full_001 start";
+    FakeKeyOps ops;
+    UserKeyStateTable table(ops.Probe(), ops.Exists());
+    for (uint32_t i = 0; i < KEY_STATE_MAX_USERS; i++) {
+        ops.ActiveUserKey(table, USER_ID + i);
+    }
+    uint32_t extra = USER_ID + KEY_STATE_MAX_USERS;
+    ops.ActiveUserKey(table, extra);
+    UserKeyStatus status;
+    EXPECT_FALSE(table.Get(extra, status));
+    EXPECT_FALSE(IsEncrypted(table, extra));
+    EXPECT_EQ(ops.probes_, 1);
+    EXPECT_FALSE(IsEncrypted(table, USER_ID + KEY_STATE_MAX_USERS - 1));
+    EXPECT_EQ(ops.probes_, 1);
+    GTEST_LOG_(INFO) << "UserKeyState_Full_001 end";
+}
+
+/**
+ * @tc.name: UserKeyState_Release_001
+ * @tc.desc: Verify a released slot drops the user and is taken by the next user, so deleted users do not
+ *           fill the table.
+ * @tc.type: FUNC
+ */
+HWTEST_F(UserKeyStateTest, UserKeyState_Release_001, TestSize.Level1)
+{
+    GTEST_LOG_(INFO) << "UserKeyState_Release_001 start";
+    FakeKeyOps ops;
+    UserKeyStateTable table(ops.Probe(), ops.Exists());
+    for (uint32_t i = 0; i < KEY_STATE_MAX_USERS; i++) {
+        ops.ActiveUserKey(table, USER_ID + i);
+    }
+    uint32_t deleted = USER_ID + 1;
+    table.Release(deleted);
+    ops.active_.erase(deleted);
+    UserKeyStatus status;
+    EXPECT_FALSE(table.Get(deleted, status));
+    EXPECT_EQ(status.ce, CeKeyState::UNKNOWN);
+    table.Release(deleted);
+
+    uint32_t added = USER_ID + KEY_STATE_MAX_USERS;
+    ops.ActiveUserKey(table, added);
+    ASSERT_TRUE(table.Get(added, status));
+    EXPECT_EQ(status.ce, CeKeyState::UNLOCKED);
+    EXPECT_EQ(status.generation, 1U);
+    EXPECT_FALSE(table.Get(deleted, status));
+    // Users behind the released slot are still found.
+    EXPECT_FALSE(IsEncrypted(table, USER_ID + KEY_STATE_MAX_USERS - 1));
+    EXPECT_TRUE(IsEncrypted(table, deleted));
+    EXPECT_EQ(ops.probes_, 1);
+    GTEST_LOG_(INFO) << "UserKeyState_Release_001 end";
+}
+
+/**
+ * @tc.name: UserKeyState_Concurrent_001
+ * @tc.desc: Verify readers racing key operations see a consistent state and a generation that never goes back.
+ * @tc.type: FUNC
+ */
+HWTEST_F(UserKeyStateTest, UserKeyState_Concurrent_001, TestSize.Level1)
+{
+    GTEST_LOG_(INFO) << "UserKeyState_Concurrent_001 start";
+    UserKeyStateTable table([](uint32_t, bool &isEncrypted) {
+        isEncrypted = true;
+        return E_OK;
+    }, [](uint32_t) { return false; });
+    constexpr int flips = 2000;
+    std::atomic<bool> done { false };
+    std::atomic<int> errors { 0 };
+    std::thread reader([&table, &done, &errors]() {
+        uint64_t last = 0;
+        while (!done) {
+            UserKeyStatus status;
+            if (!table.Get(USER_ID, status)) {
+                continue;
+            }
+            bool consistent = (status.generation % 2 == 1) == (status.ce == CeKeyState::UNLOCKED);
+            if (status.generation < last || !consistent) {
+                errors++;
+            }
+            last = status.generation;
+        }
+    });
+    for (int i = 0; i < flips; i++) {
+        table.OnCeActivated(USER_ID);
+        table.OnScreenLocked(USER_ID);
+        table.OnCeInactivated(USER_ID);
+    }
+    done = true;
+    reader.join();
+    EXPECT_EQ(errors, 0);
+    UserKeyStatus status;
+    ASSERT_TRUE(table.Get(USER_ID, status));
+    EXPECT_EQ(status.generation, 2U * flips);
+    GTEST_LOG_(INFO) << "UserKeyState_Concurrent_001 end";
+}
+
+/**
+ * @tc.name: UserKeyState_ProbeByWrite_001
+ * @tc.desc: Verify the write probe, and that tracked reads leave the el2 directory untouched.
+ * @tc.type: FUNC
+ */
+HWTEST_F(UserKeyStateTest, UserKeyState_ProbeByWrite_001, TestSize.Level1)
+{
+    GTEST_LOG_(INFO) << "UserKeyState_ProbeByWrite_001 start";
+    bool isEncrypted = false;
+    EXPECT_EQ(UserKeyStateTable::ProbeByWrite(BaseDir(USER_ID), isEncrypted), E_OK);
+    EXPECT_TRUE(isEncrypted);
+    ASSERT_TRUE(ForceCreateDirectory(BaseDir(USER_ID)));
+    EXPECT_EQ(UserKeyStateTable::ProbeByWrite(BaseDir(USER_ID), isEncrypted), E_OK);
+    EXPECT_FALSE(isEncrypted);
+    EXPECT_NE(access((BaseDir(USER_ID) + "/el2_tmp").c_str(), F_OK), 0);
+
+    std::atomic<int> probes { 0 };
+    UserKeyStateTable table([&probes](uint32_t userId, bool &encrypted) {
+        probes++;
+        return UserKeyStateTable::ProbeByWrite(BaseDir(userId), encrypted);
+    }, [](uint32_t userId) { return access(BaseDir(userId).c_str(), F_OK) == 0; });
+    table.OnCeActivated(USER_ID);
+    sleep(1);
+    struct stat before = {};
+    ASSERT_EQ(stat(BaseDir(USER_ID).c_str(), &before), 0);
+    for (int i = 0; i < READ_TIMES; i++) {
+        EXPECT_FALSE(IsEncrypted(table, USER_ID));
+    }
+    struct stat after = {};
+    ASSERT_EQ(stat(BaseDir(USER_ID).c_str(), &after), 0);
+    EXPECT_EQ(before.st_mtim.tv_sec, after.st_mtim.tv_sec);
+    EXPECT_EQ(before.st_mtim.tv_nsec, after.st_mtim.tv_nsec);
+    EXPECT_EQ(probes, 0);
+    GTEST_LOG_(INFO) << "UserKeyState_ProbeByWrite_001 end";
+}
+
+/**
+ * @tc.name: UserKeyState_Perf_001
+ * @tc.desc: Compare status reads by the write probe with reads of the tracked state.
+ * @tc.type: PERF
+ */
+HWTEST_F(UserKeyStateTest, UserKeyState_Perf_001, TestSize.Level3)
+{
+    GTEST_LOG_(INFO) << "UserKeyState_Perf_001 start";
+    ASSERT_TRUE(ForceCreateDirectory(BaseDir(USER_ID)));
+    using Clock = std::chrono::steady_clock;
+    bool isEncrypted = true;
+
+    auto start = Clock::now();
+    for (int i = 0; i < READ_TIMES; i++) {
+        ASSERT_EQ(UserKeyStateTable::ProbeByWrite(BaseDir(USER_ID), isEncrypted), E_OK);
+    }
+    double probeUs = std::chrono::duration<double, std::micro>(Clock::now() - start).count() / READ_TIMES;
+
+    UserKeyStateTable table([](uint32_t userId, bool &encrypted) {
+        return UserKeyStateTable::ProbeByWrite(BaseDir(userId), encrypted);
+    }, [](uint32_t userId) { return access(BaseDir(userId).c_str(), F_OK) == 0; });
+    table.OnCeActivated(USER_ID);
+    start = Clock::now();
+    for (int i = 0; i < READ_TIMES; i++) {
+        ASSERT_EQ(table.GetCeEncrypted(USER_ID, isEncrypted), E_OK);
+    }
+    double tableUs = std::chrono::duration<double, std::micro>(Clock::now() - start).count() / READ_TIMES;
+    EXPECT_FALSE(isEncrypted);
+
+    GTEST_LOG_(INFO) << "per read: write probe " << probeUs << " us, tracked state " << tableUs << " us";
+    EXPECT_LT(tableUs, probeUs);
+    GTEST_LOG_(INFO) << "UserKeyState_Perf_001 end";
+}
+} // namespace StorageDaemon
+} // namespace OHOS
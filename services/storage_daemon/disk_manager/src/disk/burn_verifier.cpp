@@ -0,0 +1,462 @@
+/*
+ * Copyright (c) 2026 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "disk_manager/disk/burn_verifier.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+#include "disk_manager/disk/checksum_engine.h"
+#include "storage_service_errno.h"
+#include "storage_service_log.h"
+#include "utils/op_progress.h"
+
+namespace OHOS {
+namespace StorageDaemon {
+namespace {
+constexpr const char *MANIFEST_DIR = "/data/local/burn_manifest";
+constexpr const char *MANIFEST_MAGIC = "burn-manifest-v1";
+constexpr size_t IO_ALIGN = 4096;
+constexpr size_t STREAM_CHUNK = 256 * 1024;
+constexpr int32_t PERCENT_FULL = 100;
+constexpr double BYTES_PER_MB = 1024.0 * 1024.0;
+constexpr ChecksumAlgorithm EXTENT_DIGEST = ChecksumAlgorithm::XXH64;
+
+struct AlignedFree {
+    void operator()(uint8_t *p) const { free(p); }
+};
+using IoBuffer = std::unique_ptr<uint8_t, AlignedFree>;
+
+IoBuffer AllocIoBuffer(size_t size)
+{
+    void *buf = nullptr;
+    if (posix_memalign(&buf, IO_ALIGN, size) != 0) {
+        return nullptr;
+    }
+    return IoBuffer(static_cast<uint8_t *>(buf));
+}
+
+size_t AlignUp(size_t len)
+{
+    return (len + IO_ALIGN - 1) / IO_ALIGN * IO_ALIGN;
+}
+
+// Readers of the file only ever see a complete old or new version.
+bool WriteFileAtomic(const std::string &path, const std::string &content)
+{
+    std::string tmpPath = path + ".tmp";
+    int fd = open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, S_IRUSR | S_IWUSR);
+    if (fd < 0) {
+        return false;
+    }
+    bool ok = TEMP_FAILURE_RETRY(write(fd, content.data(), content.size())) ==
+        static_cast<ssize_t>(content.size());
+    (void)close(fd);
+    if (!ok || rename(tmpPath.c_str(), path.c_str()) != 0) {
+        (void)unlink(tmpPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+// Fill buf with want bytes from offset; O_DIRECT is dropped once if the device rejects the alignment.
+int32_t ReadExtent(int fd, off_t offset, size_t want, uint8_t *buf, size_t &got)
+{
+    size_t readLen = AlignUp(want);
+    got = 0;
+    while (got < want) {
+        ssize_t len = pread(fd, buf + got, readLen - got, offset + static_cast<off_t>(got));
+        if (len < 0 && errno == EINTR) {
+            continue;
+        }
+        if (len < 0 && errno == EINVAL && (fcntl(fd, F_GETFL) & O_DIRECT) != 0) {
+            LOGI("[L8:BurnVerifier] ReadExtent: O_DIRECT rejected, falling back to buffered reads");
+            (void)fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_DIRECT);
+            continue;
+        }
+        if (len < 0) {
+            return errno;
+        }
+        if (len == 0) {
+            break;
+        }
+        got += static_cast<size_t>(len);
+    }
+    return E_OK;
+}
+
+// One sequential pass over the image, every chunk goes to recorder.
+int32_t ReadImage(const std::string &imagePath, BurnManifestRecorder &recorder)
+{
+    int fd = open(imagePath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        LOGE("[L8:BurnVerifier] ReadImage: open image failed, errno=%{public}d", errno);
+        return E_ERR;
+    }
+    (void)posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    std::vector<uint8_t> buf(STREAM_CHUNK);
+    int32_t ret = E_OK;
+    while (ret == E_OK) {
+        ssize_t len = TEMP_FAILURE_RETRY(read(fd, buf.data(), buf.size()));
+        if (len <= 0) {
+            if (len < 0) {
+                LOGE("[L8:BurnVerifier] ReadImage: read image failed, errno=%{public}d", errno);
+                ret = E_ERR;
+            }
+            break;
+        }
+        recorder.Update(buf.data(), static_cast<size_t>(len));
+    }
+    (void)close(fd);
+    return ret;
+}
+
+class ProgressWriter {
+public:
+    explicit ProgressWriter(const std::string &path) : path_(path) {}
+
+    void Update(uint64_t done, uint64_t total)
+    {
+        OpProgressScope::ReportBytes(done, total);
+        int32_t percent = total == 0 ? PERCENT_FULL : static_cast<int32_t>(done * PERCENT_FULL / total);
+        if (path_.empty() || percent == last_) {
+            return;
+        }
+        last_ = percent;
+        if (!WriteFileAtomic(path_, std::to_string(percent) + "\n")) {
+            LOGE("[L8:BurnVerifier] ProgressWriter: write progress failed, errno=%{public}d", errno);
+        }
+    }
+
+private:
+    std::string path_;
+    int32_t last_ = -1;
+};
+
+// Two-slot pipeline: the reader thread fills one buffer while the caller hashes the other.
+class ExtentPipeline {
+public:
+    struct Slot {
+        IoBuffer buf;
+        size_t len = 0;
+        int32_t err = E_OK;
+        bool full = false;
+    };
+
+    ExtentPipeline(int fd, const BurnManifest &manifest) : fd_(fd), manifest_(manifest) {}
+
+    ~ExtentPipeline()
+    {
+        Stop();
+    }
+
+    bool Start()
+    {
+        size_t bufSize = AlignUp(manifest_.ExtentBytes());
+        for (auto &slot : slots_) {
+            slot.buf = AllocIoBuffer(bufSize);
+            if (slot.buf == nullptr) {
+                return false;
+            }
+        }
+        reader_ = std::thread([this] { ReadLoop(); });
+        return true;
+    }
+
+    Slot &Acquire(size_t idx)
+    {
+        Slot &slot = slots_[idx % SLOT_COUNT];
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [&slot] { return slot.full; });
+        return slot;
+    }
+
+    void Release(size_t idx)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            slots_[idx % SLOT_COUNT].full = false;
+        }
+        cv_.notify_all();
+    }
+
+    void Stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        if (reader_.joinable()) {
+            reader_.join();
+        }
+    }
+
+private:
+    static constexpr size_t SLOT_COUNT = 2;
+
+    void ReadLoop()
+    {
+        uint64_t extentBytes = manifest_.ExtentBytes();
+        off_t base = static_cast<off_t>(manifest_.startLba * manifest_.sectorSize);
+        for (size_t idx = 0; idx < manifest_.digests.size(); idx++) {
+            Slot &slot = slots_[idx % SLOT_COUNT];
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                cv_.wait(lock, [this, &slot] { return !slot.full || stop_; });
+                if (stop_) {
+                    return;
+                }
+            }
+            uint64_t start = idx * extentBytes;
+            size_t want = static_cast<size_t>(std::min<uint64_t>(extentBytes, manifest_.totalBytes - start));
+            slot.err = ReadExtent(fd_, base + static_cast<off_t>(start), want, slot.buf.get(), slot.len);
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                slot.full = true;
+            }
+            cv_.notify_all();
+        }
+    }
+
+    int fd_;
+    const BurnManifest &manifest_;
+    Slot slots_[SLOT_COUNT];
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stop_ = false;
+    std::thread reader_;
+};
+} // namespace
+
+BurnManifestRecorder::BurnManifestRecorder(uint64_t startLba)
+{
+    manifest_.startLba = startLba;
+    pending_.reserve(static_cast<size_t>(manifest_.ExtentBytes()));
+}
+
+void BurnManifestRecorder::Update(const uint8_t *data, size_t len)
+{
+    size_t extentBytes = static_cast<size_t>(manifest_.ExtentBytes());
+    while (len > 0) {
+        size_t take = std::min(len, extentBytes - pending_.size());
+        pending_.insert(pending_.end(), data, data + take);
+        data += take;
+        len -= take;
+        if (pending_.size() == extentBytes) {
+            manifest_.digests.push_back(ChecksumEngine::HashBuffer(pending_.data(), pending_.size(), EXTENT_DIGEST));
+            manifest_.totalBytes += pending_.size();
+            pending_.clear();
+        }
+    }
+}
+
+const BurnManifest &BurnManifestRecorder::Finish()
+{
+    if (!pending_.empty()) {
+        manifest_.digests.push_back(ChecksumEngine::HashBuffer(pending_.data(), pending_.size(), EXTENT_DIGEST));
+        manifest_.totalBytes += pending_.size();
+        pending_.clear();
+    }
+    return manifest_;
+}
+
+int32_t BurnVerifier::BuildManifest(const std::string &imagePath, uint64_t startLba, BurnManifest &manifest)
+{
+    LOGI("[L8:BurnVerifier] BuildManifest: >>> ENTER <<< startLba=%{public}llu",
+         static_cast<unsigned long long>(startLba));
+    BurnManifestRecorder recorder(startLba);
+    if (ReadImage(imagePath, recorder) != E_OK) {
+        LOGE("[L8:BurnVerifier] BuildManifest: <<< EXIT FAILED <<<");
+        return E_ERR;
+    }
+    manifest = recorder.Finish();
+    LOGI("[L8:BurnVerifier] BuildManifest: <<< EXIT SUCCESS <<< extents=%{public}zu, bytes=%{public}llu",
+         manifest.digests.size(), static_cast<unsigned long long>(manifest.totalBytes));
+    return E_OK;
+}
+
+int32_t BurnVerifier::SaveManifest(const BurnManifest &manifest, const std::string &manifestPath)
+{
+    std::ostringstream out;
+    out << MANIFEST_MAGIC << ' ' << manifest.sectorSize << ' ' << manifest.extentSectors << ' '
+        << manifest.startLba << ' ' << manifest.totalBytes << '\n';
+    for (const auto &digest : manifest.digests) {
+        out << digest << '\n';
+    }
+    if (!WriteFileAtomic(manifestPath, out.str())) {
+        LOGE("[L8:BurnVerifier] SaveManifest: write failed, errno=%{public}d", errno);
+        return E_ERR;
+    }
+    return E_OK;
+}
+
+int32_t BurnVerifier::LoadManifest(const std::string &manifestPath, BurnManifest &manifest)
+{
+    std::ifstream in(manifestPath);
+    if (!in.is_open()) {
+        LOGE("[L8:BurnVerifier] LoadManifest: open failed, errno=%{public}d", errno);
+        return E_NOT_SUPPORT;
+    }
+    std::string magic;
+    in >> magic >> manifest.sectorSize >> manifest.extentSectors >> manifest.startLba >> manifest.totalBytes;
+    if (in.fail() || magic != MANIFEST_MAGIC || manifest.sectorSize == 0 || manifest.extentSectors == 0) {
+        LOGE("[L8:BurnVerifier] LoadManifest: bad header");
+        return E_ERR;
+    }
+    manifest.digests.clear();
+    std::string digest;
+    while (in >> digest) {
+        manifest.digests.push_back(digest);
+    }
+    uint64_t extentBytes = manifest.ExtentBytes();
+    if (manifest.digests.size() != (manifest.totalBytes + extentBytes - 1) / extentBytes) {
+        LOGE("[L8:BurnVerifier] LoadManifest: extent count %{public}zu does not match size",
+             manifest.digests.size());
+        return E_ERR;
+    }
+    return E_OK;
+}
+
+int32_t BurnVerifier::Verify(const std::string &devPath, const BurnManifest &manifest,
+                             const std::string &progressPath, BurnVerifyResult &result)
+{
+    LOGI("[L8:BurnVerifier] Verify: >>> ENTER <<< devPath=%{public}s, extents=%{public}zu",
+         devPath.c_str(), manifest.digests.size());
+    auto start = std::chrono::steady_clock::now();
+    result = BurnVerifyResult();
+    int fd = open(devPath.c_str(), O_RDONLY | O_DIRECT | O_CLOEXEC);
+    if (fd < 0 && errno == EINVAL) {
+        fd = open(devPath.c_str(), O_RDONLY | O_CLOEXEC);
+    }
+    if (fd < 0) {
+        LOGE("[L8:BurnVerifier] Verify: <<< EXIT FAILED <<< open failed, errno=%{public}d", errno);
+        return E_ERR;
+    }
+    ProgressWriter progress(progressPath);
+    progress.Update(0, manifest.totalBytes);
+    ExtentPipeline pipeline(fd, manifest);
+    if (!pipeline.Start()) {
+        (void)close(fd);
+        LOGE("[L8:BurnVerifier] Verify: <<< EXIT FAILED <<< alloc buffers failed");
+        return E_ERR;
+    }
+
+    uint64_t extentBytes = manifest.ExtentBytes();
+    result.matched = true;
+    for (size_t idx = 0; idx < manifest.digests.size(); idx++) {
+        uint64_t offset = idx * extentBytes;
+        size_t want = static_cast<size_t>(std::min<uint64_t>(extentBytes, manifest.totalBytes - offset));
+        auto &slot = pipeline.Acquire(idx);
+        bool same = slot.err == E_OK && slot.len >= want &&
+            ChecksumEngine::HashBuffer(slot.buf.get(), want, EXTENT_DIGEST) == manifest.digests[idx];
+        if (!same) {
+            // Unreadable sectors count as a mismatch too; that is what the user needs to know.
+            result.matched = false;
+            result.badLbaStart = manifest.startLba + idx * manifest.extentSectors;
+            result.badLbaEnd = result.badLbaStart + (want + manifest.sectorSize - 1) / manifest.sectorSize - 1;
+            LOGE("[L8:BurnVerifier] Verify: mismatch in LBA %{public}llu-%{public}llu, readErr=%{public}d",
+                 static_cast<unsigned long long>(result.badLbaStart),
+                 static_cast<unsigned long long>(result.badLbaEnd), slot.err);
+            break;
+        }
+        pipeline.Release(idx);
+        result.bytesVerified += want;
+        progress.Update(result.bytesVerified, manifest.totalBytes);
+    }
+    pipeline.Stop();
+    (void)close(fd);
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    result.throughputMBps = seconds > 0 ? result.bytesVerified / BYTES_PER_MB / seconds : 0;
+    LOGI("[L8:BurnVerifier] Verify: <<< EXIT SUCCESS <<< matched=%{public}d, bytes=%{public}llu, "
+         "throughput=%{public}d MB/s", result.matched, static_cast<unsigned long long>(result.bytesVerified),
+         static_cast<int32_t>(result.throughputMBps));
+    return E_OK;
+}
+
+std::string BurnVerifier::GetManifestPath(const std::string &devPath)
+{
+    size_t pos = devPath.find_last_of('/');
+    std::string devName = pos == std::string::npos ? devPath : devPath.substr(pos + 1);
+    return std::string(MANIFEST_DIR) + "/" + devName + ".manifest";
+}
+
+int32_t BurnVerifier::FeedBurner(int fd, const uint8_t *data, size_t len, BurnManifestRecorder &recorder)
+{
+    recorder.Update(data, len);
+    for (size_t done = 0; done < len;) {
+        ssize_t n = TEMP_FAILURE_RETRY(write(fd, data + done, len - done));
+        if (n < 0) {
+            LOGE("[L8:BurnVerifier] FeedBurner: write failed, errno=%{public}d", errno);
+            return E_ERR;
+        }
+        done += static_cast<size_t>(n);
+    }
+    return E_OK;
+}
+
+int32_t BurnVerifier::RecordBurn(const std::string &devPath, const BurnManifest &manifest)
+{
+    DropManifest(devPath);
+    if (mkdir(MANIFEST_DIR, S_IRWXU) != 0 && errno != EEXIST) {
+        LOGE("[L8:BurnVerifier] RecordBurn: mkdir failed, errno=%{public}d", errno);
+        return E_ERR;
+    }
+    return SaveManifest(manifest, GetManifestPath(devPath));
+}
+
+int32_t BurnVerifier::RecordBurn(const std::string &devPath, const std::string &imagePath, uint64_t startLba)
+{
+    BurnManifest manifest;
+    int32_t ret = BuildManifest(imagePath, startLba, manifest);
+    if (ret != E_OK) {
+        // A stale manifest of an earlier burn must not be verified against this one.
+        DropManifest(devPath);
+        return ret;
+    }
+    return RecordBurn(devPath, manifest);
+}
+
+void BurnVerifier::DropManifest(const std::string &devPath)
+{
+    std::string manifestPath = GetManifestPath(devPath);
+    if (unlink(manifestPath.c_str()) != 0 && errno != ENOENT) {
+        LOGE("[L8:BurnVerifier] DropManifest: unlink failed, errno=%{public}d", errno);
+    }
+}
+
+uint64_t BurnVerifier::SessionStartLba(bool isDiskEmpty, const std::string &incBurnAddr)
+{
+    size_t comma = incBurnAddr.find(',');
+    if (isDiskEmpty || comma == std::string::npos) {
+        return 0;
+    }
+    return std::strtoull(incBurnAddr.c_str() + comma + 1, nullptr, 10);
+}
+} // namespace StorageDaemon
+} // namespace OHOS
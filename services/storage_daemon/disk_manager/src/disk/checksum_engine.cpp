@@ -0,0 +1,366 @@
+/*
+ * Copyright (c) 2026 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "disk_manager/disk/checksum_engine.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <memory>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+#include <openssl/evp.h>
+
+#include "storage_service_errno.h"
+#include "storage_service_log.h"
+
+namespace OHOS {
+namespace StorageDaemon {
+namespace {
+constexpr size_t READ_BUF_SIZE = 1024 * 1024;
+constexpr size_t READ_BUF_ALIGN = 4096;
+constexpr size_t MAX_HASH_WORKERS = 4;
+constexpr size_t MIN_FILES_PER_WORKER = 16;
+constexpr char HEX_DIGITS[] = "0123456789abcdef";
+
+std::string ToHex(const uint8_t *data, size_t len)
+{
+    std::string hex(len * 2, '0');
+    for (size_t i = 0; i < len; i++) {
+        hex[i * 2] = HEX_DIGITS[data[i] >> 4];
+        hex[i * 2 + 1] = HEX_DIGITS[data[i] & 0x0F];
+    }
+    return hex;
+}
+
+// Streaming XXH64 (seed 0), the reference algorithm without the SIMD variants.
+class Xxh64 {
+public:
+    void Update(const uint8_t *data, size_t len)
+    {
+        totalLen_ += len;
+        if (memLen_ + len < STRIPE) {
+            (void)memcpy(mem_ + memLen_, data, len);
+            memLen_ += len;
+            return;
+        }
+        if (memLen_ > 0) {
+            size_t fill = STRIPE - memLen_;
+            (void)memcpy(mem_ + memLen_, data, fill);
+            ConsumeStripe(mem_);
+            data += fill;
+            len -= fill;
+            memLen_ = 0;
+        }
+        for (; len >= STRIPE; data += STRIPE, len -= STRIPE) {
+            ConsumeStripe(data);
+        }
+        (void)memcpy(mem_, data, len);
+        memLen_ = len;
+    }
+
+    uint64_t Digest() const
+    {
+        uint64_t h;
+        if (totalLen_ >= STRIPE) {
+            h = Rotl(v_[0], 1) + Rotl(v_[1], 7) + Rotl(v_[2], 12) + Rotl(v_[3], 18);
+            for (uint64_t v : v_) {
+                h = (h ^ Round(0, v)) * PRIME1 + PRIME4;
+            }
+        } else {
+            h = PRIME5;
+        }
+        h += totalLen_;
+        const uint8_t *p = mem_;
+        size_t len = memLen_;
+        for (; len >= sizeof(uint64_t); p += sizeof(uint64_t), len -= sizeof(uint64_t)) {
+            h = Rotl(h ^ Round(0, Read64(p)), 27) * PRIME1 + PRIME4;
+        }
+        if (len >= sizeof(uint32_t)) {
+            h = Rotl(h ^ (Read32(p) * PRIME1), 23) * PRIME2 + PRIME3;
+            p += sizeof(uint32_t);
+            len -= sizeof(uint32_t);
+        }
+        for (; len > 0; p++, len--) {
+            h = Rotl(h ^ (*p * PRIME5), 11) * PRIME1;
+        }
+        h ^= h >> 33;
+        h *= PRIME2;
+        h ^= h >> 29;
+        h *= PRIME3;
+        h ^= h >> 32;
+        return h;
+    }
+
+private:
+    static constexpr uint64_t PRIME1 = 0x9E3779B185EBCA87ULL;
+    static constexpr uint64_t PRIME2 = 0xC2B2AE3D27D4EB4FULL;
+    static constexpr uint64_t PRIME3 = 0x165667B19E3779F9ULL;
+    static constexpr uint64_t PRIME4 = 0x85EBCA77C2B2AE63ULL;
+    static constexpr uint64_t PRIME5 = 0x27D4EB2F165667C5ULL;
+    static constexpr size_t STRIPE = 32;
+
+    static uint64_t Rotl(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+    static uint64_t Round(uint64_t acc, uint64_t input) { return Rotl(acc + input * PRIME2, 31) * PRIME1; }
+    static uint64_t Read64(const uint8_t *p)
+    {
+        uint64_t v;
+        (void)memcpy(&v, p, sizeof(v));
+        return v;
+    }
+    static uint64_t Read32(const uint8_t *p)
+    {
+        uint32_t v;
+        (void)memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    void ConsumeStripe(const uint8_t *p)
+    {
+        for (size_t i = 0; i < 4; i++) {
+            v_[i] = Round(v_[i], Read64(p + i * sizeof(uint64_t)));
+        }
+    }
+
+    uint64_t v_[4] = { PRIME1 + PRIME2, PRIME2, 0, 0 - PRIME1 };
+    uint8_t mem_[STRIPE] = {};
+    size_t memLen_ = 0;
+    uint64_t totalLen_ = 0;
+};
+
+struct AlignedFree {
+    void operator()(uint8_t *p) const { free(p); }
+};
+using ReadBuffer = std::unique_ptr<uint8_t, AlignedFree>;
+
+ReadBuffer AllocReadBuffer()
+{
+    void *buf = nullptr;
+    if (posix_memalign(&buf, READ_BUF_ALIGN, READ_BUF_SIZE) != 0) {
+        return nullptr;
+    }
+    return ReadBuffer(static_cast<uint8_t *>(buf));
+}
+
+template <typename Sink>
+bool ReadAll(int fd, uint8_t *buf, Sink &&sink)
+{
+    ssize_t len;
+    while ((len = TEMP_FAILURE_RETRY(read(fd, buf, READ_BUF_SIZE))) > 0) {
+        sink(buf, static_cast<size_t>(len));
+    }
+    return len == 0;
+}
+
+// Canonical (big-endian) hex form, as printed by xxhsum.
+std::string Xxh64Hex(const Xxh64 &state)
+{
+    uint64_t h = state.Digest();
+    uint8_t bytes[sizeof(h)];
+    for (size_t i = 0; i < sizeof(h); i++) {
+        bytes[i] = static_cast<uint8_t>(h >> ((sizeof(h) - 1 - i) * 8));
+    }
+    return ToHex(bytes, sizeof(bytes));
+}
+
+bool DigestFd(int fd, ChecksumAlgorithm algorithm, uint8_t *buf, std::string &digest)
+{
+    if (algorithm == ChecksumAlgorithm::XXH64) {
+        Xxh64 state;
+        if (!ReadAll(fd, buf, [&state](const uint8_t *data, size_t len) { state.Update(data, len); })) {
+            return false;
+        }
+        digest = Xxh64Hex(state);
+        return true;
+    }
+
+    std::unique_ptr<EVP_MD_CTX, decltype(&EVP_MD_CTX_free)> ctx(EVP_MD_CTX_new(), EVP_MD_CTX_free);
+    if (ctx == nullptr || EVP_DigestInit_ex(ctx.get(), EVP_md5(), nullptr) != 1) {
+        return false;
+    }
+    bool updateOk = true;
+    if (!ReadAll(fd, buf, [&ctx, &updateOk](const uint8_t *data, size_t len) {
+            updateOk = updateOk && EVP_DigestUpdate(ctx.get(), data, len) == 1;
+        }) || !updateOk) {
+        return false;
+    }
+    uint8_t md[EVP_MAX_MD_SIZE];
+    unsigned int mdLen = 0;
+    if (EVP_DigestFinal_ex(ctx.get(), md, &mdLen) != 1) {
+        return false;
+    }
+    digest = ToHex(md, mdLen);
+    return true;
+}
+
+bool HashAt(int dirFd, const std::string &relPath, ChecksumAlgorithm algorithm, uint8_t *buf, std::string &digest)
+{
+    int fd = openat(dirFd, relPath.c_str(), O_RDONLY | O_NOFOLLOW | O_CLOEXEC);
+    if (fd < 0) {
+        LOGE("[L8:ChecksumEngine] HashAt: open failed, errno=%{public}d", errno);
+        return false;
+    }
+    (void)posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    bool ok = DigestFd(fd, algorithm, buf, digest);
+    if (!ok) {
+        LOGE("[L8:ChecksumEngine] HashAt: read failed, errno=%{public}d", errno);
+    }
+    // Each file is read exactly once, keep it from pushing the rest of the page cache out.
+    (void)posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    (void)close(fd);
+    return ok;
+}
+
+bool IsRegularEntry(int dirFd, const struct dirent *entry, bool &isDir)
+{
+    unsigned char type = entry->d_type;
+    if (type == DT_UNKNOWN) {
+        struct stat st;
+        if (fstatat(dirFd, entry->d_name, &st, AT_SYMLINK_NOFOLLOW) != 0) {
+            return false;
+        }
+        type = S_ISDIR(st.st_mode) ? DT_DIR : (S_ISREG(st.st_mode) ? DT_REG : DT_UNKNOWN);
+    }
+    isDir = type == DT_DIR;
+    return type == DT_REG;
+}
+} // namespace
+
+int32_t ChecksumEngine::ListFiles(int rootFd, std::vector<std::string> &files)
+{
+    std::vector<std::string> pending = { "" };
+    while (!pending.empty()) {
+        std::string dirRel = std::move(pending.back());
+        pending.pop_back();
+        int fd = dirRel.empty() ? dup(rootFd) :
+            openat(rootFd, dirRel.c_str(), O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+        DIR *dir = fd < 0 ? nullptr : fdopendir(fd);
+        if (dir == nullptr) {
+            LOGE("[L8:ChecksumEngine] ListFiles: open dir failed, errno=%{public}d", errno);
+            if (fd >= 0) {
+                (void)close(fd);
+            }
+            return E_ERR;
+        }
+        std::string prefix = dirRel.empty() ? dirRel : dirRel + "/";
+        struct dirent *entry;
+        while ((entry = readdir(dir)) != nullptr) {
+            if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
+                continue;
+            }
+            bool isDir = false;
+            if (IsRegularEntry(dirfd(dir), entry, isDir)) {
+                files.push_back(prefix + entry->d_name);
+            } else if (isDir) {
+                pending.push_back(prefix + entry->d_name);
+            }
+        }
+        (void)closedir(dir);
+    }
+    return E_OK;
+}
+
+int32_t ChecksumEngine::HashFile(int dirFd, const std::string &relPath, ChecksumAlgorithm algorithm,
+                                 std::string &digest)
+{
+    ReadBuffer buf = AllocReadBuffer();
+    if (buf == nullptr) {
+        return E_ERR;
+    }
+    return HashAt(dirFd, relPath, algorithm, buf.get(), digest) ? E_OK : E_ERR;
+}
+
+std::string ChecksumEngine::HashBuffer(const uint8_t *data, size_t len, ChecksumAlgorithm algorithm)
+{
+    if (algorithm == ChecksumAlgorithm::XXH64) {
+        Xxh64 state;
+        state.Update(data, len);
+        return Xxh64Hex(state);
+    }
+    uint8_t md[EVP_MAX_MD_SIZE];
+    unsigned int mdLen = 0;
+    if (EVP_Digest(data, len, md, &mdLen, EVP_md5(), nullptr) != 1) {
+        return "";
+    }
+    return ToHex(md, mdLen);
+}
+
+int32_t ChecksumEngine::HashTree(const std::string &dirPath, ChecksumAlgorithm algorithm, ChecksumIndex &index)
+{
+    LOGI("[L8:ChecksumEngine] HashTree: >>> ENTER <<< dirPath=%{public}s, algorithm=%{public}d",
+         dirPath.c_str(), static_cast<int>(algorithm));
+    auto start = std::chrono::steady_clock::now();
+    int rootFd = open(dirPath.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (rootFd < 0) {
+        LOGE("[L8:ChecksumEngine] HashTree: <<< EXIT FAILED <<< open root failed, errno=%{public}d", errno);
+        return E_ERR;
+    }
+    std::vector<std::string> files;
+    if (ListFiles(rootFd, files) != E_OK) {
+        (void)close(rootFd);
+        LOGE("[L8:ChecksumEngine] HashTree: <<< EXIT FAILED <<< walk failed");
+        return E_ERR;
+    }
+
+    size_t workers = std::min<size_t>(files.size() / MIN_FILES_PER_WORKER,
+        std::min<size_t>(MAX_HASH_WORKERS, std::max(1U, std::thread::hardware_concurrency())));
+    workers = std::max<size_t>(workers, 1);
+    std::vector<std::string> digests(files.size());
+    std::atomic<size_t> next{0};
+    std::atomic<bool> failed{false};
+    auto work = [&files, &digests, &next, &failed, rootFd, algorithm]() {
+        ReadBuffer buf = AllocReadBuffer();
+        if (buf == nullptr) {
+            failed = true;
+            return;
+        }
+        for (size_t i = next++; i < files.size() && !failed; i = next++) {
+            if (!HashAt(rootFd, files[i], algorithm, buf.get(), digests[i])) {
+                failed = true;
+            }
+        }
+    };
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < workers; i++) {
+        threads.emplace_back(work);
+    }
+    work();
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    (void)close(rootFd);
+    if (failed) {
+        LOGE("[L8:ChecksumEngine] HashTree: <<< EXIT FAILED <<< hashing failed");
+        return E_ERR;
+    }
+
+    index.reserve(index.size() + files.size());
+    for (size_t i = 0; i < files.size(); i++) {
+        index[std::move(files[i])] = std::move(digests[i]);
+    }
+    auto cost = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    LOGI("[L8:ChecksumEngine] HashTree: <<< EXIT SUCCESS <<< files=%{public}zu, workers=%{public}zu, "
+         "cost=%{public}lld ms", digests.size(), workers, static_cast<long long>(cost.count()));
+    return E_OK;
+}
+} // namespace StorageDaemon
+} // namespace OHOS
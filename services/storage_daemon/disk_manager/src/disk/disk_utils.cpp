@@ -26,8 +26,10 @@
 #include <regex>
 #include <thread>
 #include <sstream>
+#include <string_view>
 
 #include "disk_manager/disk/disk_utils.h"
+#include "disk_manager/disk/burn_verifier.h"
 
 #include <fcntl.h>
 #include <sys/ioctl.h>
@@ -42,6 +44,7 @@
 #include "storage_service_log.h"
 #include "utils/disk_utils.h"
 #include "utils/file_utils.h"
+#include "utils/op_progress.h"
 #include "utils/storage_radar.h"
 #include "utils/string_utils.h"
 #include "utils/volume_op_diag.h"
@@ -55,6 +58,8 @@ constexpr const char *MTP_PATH_PREFIX = "/mnt/data/external/mtp";
 #define STORAGE_MANAGER_IOC_CHK_BUSY _IOR(0xAC, 77, int)
 
 constexpr const char *BLOCK_DEVICE_PREFIX = "/dev/block/";
+constexpr const char *VOL_OP_PROGRESS_PATH = "/data/local/vol_tmp/percent";
+constexpr int32_t E_VERIFY_BURN_DATA_FAILED = 13600030;
 constexpr const char *SGDISK_PATH = "/system/bin/sgdisk";
 constexpr const char *SGDISK_DUMP_CMD = "--ohos-dump";
 constexpr int32_t PATH_MAX_LEN = 4096;
@@ -585,6 +590,7 @@ int32_t DiskUtils::FormatPartition(const std::string &devPath, const std::string
     const VolumeOpDiagContext diagCtx = VolumeOpDiagCaptureContext();
     std::thread formatThread([devPath, fsType, volumeName, diagCtx, p = std::move(promise)]() mutable {
         VolumeOpDiagAttachContext(diagCtx);
+        OpProgressScope scope(OpProgressRegistry::GetOpId(devPath), OpPhase::FORMATTING);
         FormatPartitionThreadResult result;
         LOGI("[L3:DiskUtils] exec format partition");
         std::vector<std::string> cmd = DiskUtils::GetFormatCMD(fsType, devPath, volumeName);
@@ -1123,8 +1129,17 @@ int32_t DiskUtils::GetVolumeOpProcess(const std::string &volId, int32_t &progres
     LOGI("GetVolumeOpProcess: >>> ENTER <<< volId=%{public}s", volId.c_str());
     int32_t err = 0;
 
+    OpProgress progress;
+    if (OpProgressRegistry::GetInstance().Get(OpProgressRegistry::GetOpId(volId), progress)) {
+        progressPct = progress.percent;
+        LOGI("GetVolumeOpProcess:<<< EXIT SUCCESS <<< volId=%{public}s, phase=%{public}d, progressPct=%{public}d",
+            volId.c_str(), static_cast<int32_t>(progress.phase), progressPct);
+        return E_OK;
+    }
+    // No operation of this volume is running or just finished: fall back to the percent file written by
+    // external tools.
     std::string filePath;
-    if (!GetRealPath("/data/local/vol_tmp/percent", filePath)) {
+    if (!GetRealPath(VOL_OP_PROGRESS_PATH, filePath)) {
         LOGE("GetVolumeOpProcess:<<< EXIT FAILED <<< volId: %{public}s",
             volId.c_str());
         return E_PARAMS_INVALID;
@@ -1150,6 +1165,33 @@ int32_t DiskUtils::GetVolumeOpProcess(const std::string &volId, int32_t &progres
 int32_t DiskUtils::VerifyBurnData(const std::string &devPath, int32_t verifyType)
 {
     LOGI("VerifyBurnData:<<< ENTER <<< devPath=%{public}s, verifyType=%{public}d", devPath.c_str(), verifyType);
+    BurnManifest manifest;
+    int32_t err = BurnVerifier::LoadManifest(BurnVerifier::GetManifestPath(devPath), manifest);
+    if (err == E_NOT_SUPPORT) {
+        // Sessions growisofs builds itself leave no manifest, so there is nothing to check the disc against.
+        LOGE("VerifyBurnData:<<< EXIT FAILED <<< no burn manifest for devPath=%{public}s", devPath.c_str());
+        return err;
+    }
+    if (err != E_OK) {
+        LOGE("VerifyBurnData:<<< EXIT FAILED <<< no usable burn manifest for devPath=%{public}s", devPath.c_str());
+        return err;
+    }
+    BurnVerifyResult result;
+    {
+        OpProgressScope scope(OpProgressRegistry::GetOpId(devPath), OpPhase::VERIFYING);
+        err = BurnVerifier::Verify(devPath, manifest, VOL_OP_PROGRESS_PATH, result);
+    }
+    if (err != E_OK) {
+        LOGE("VerifyBurnData:<<< EXIT FAILED <<< verify failed, err=%{public}d", err);
+        return err;
+    }
+    if (!result.matched) {
+        LOGE("VerifyBurnData:<<< EXIT FAILED <<< data mismatch at LBA %{public}llu-%{public}llu",
+            static_cast<unsigned long long>(result.badLbaStart), static_cast<unsigned long long>(result.badLbaEnd));
+        return E_VERIFY_BURN_DATA_FAILED;
+    }
+    LOGI("VerifyBurnData:<<< EXIT SUCCESS <<< bytes=%{public}llu",
+        static_cast<unsigned long long>(result.bytesVerified));
     return E_OK;
 }
 
@@ -1501,16 +1543,19 @@ std::string DiskUtils::ParseFileName(const std::string& trimmedLine)
 int32_t DiskUtils::GenerateChecksums(const std::string& dirPath, const std::string& checksumFilePath)
 {
     LOGI("GenerateChecksums: generating MD5 for %{public}s", dirPath.c_str());
-    std::vector<std::string> cmd = {"find", dirPath, "-type", "f", "-exec", "md5sum", "{}", ";"};
-    std::vector<std::string> output;
-    int32_t err = ForkExec(cmd, &output);
-    if (err != E_OK) {
-        LOGE("GenerateChecksums: find/md5sum failed for %{public}s", dirPath.c_str());
+    ChecksumIndex index;
+    if (ChecksumEngine::HashTree(dirPath, ChecksumAlgorithm::MD5, index) != E_OK) {
+        LOGE("GenerateChecksums: hashing failed for %{public}s", dirPath.c_str());
         return E_ERR;
     }
+    // Same "<md5>  <path>" lines md5sum printed, so existing checksum files stay comparable.
+    std::string base = dirPath;
+    if (base.empty() || base.back() != '/') {
+        base += '/';
+    }
     std::string checksumContent;
-    for (const auto& s : output) {
-        checksumContent += s + "\n";
+    for (const auto& [relPath, digest] : index) {
+        checksumContent.append(digest).append("  ").append(base).append(relPath).append("\n");
     }
     std::string errMsg;
     if (!WriteFileSync(checksumFilePath.c_str(),
@@ -1522,31 +1567,27 @@ int32_t DiskUtils::GenerateChecksums(const std::string& dirPath, const std::stri
     return E_OK;
 }
 
-std::map<std::string, std::string> DiskUtils::ParseChecksumFile(
-    const std::string& checksumContent, const std::string& basePath)
+ChecksumIndex DiskUtils::ParseChecksumFile(const std::string& checksumContent, const std::string& basePath)
 {
-    std::map<std::string, std::string> checksumMap;
-    std::vector<std::string> lines = SplitString(checksumContent, '\n');
-    for (const auto& line : lines) {
-        if (line.empty()) {
-            continue;
-        }
+    ChecksumIndex checksumMap;
+    std::string_view rest = checksumContent;
+    checksumMap.reserve(std::count(rest.begin(), rest.end(), '\n') + 1);
+    while (!rest.empty()) {
+        size_t end = rest.find('\n');
+        std::string_view line = rest.substr(0, end);
+        rest.remove_prefix(end == std::string_view::npos ? rest.size() : end + 1);
         size_t pos = line.find("  ");
-        if (pos != std::string::npos) {
-            std::string md5 = line.substr(0, pos);
-            std::string filePath = line.substr(pos + 2);
-            std::string relativePath = GetRelativePath(filePath, basePath);
-            checksumMap[relativePath] = md5;
+        if (pos == std::string_view::npos) {
+            continue;
         }
+        std::string relativePath = GetRelativePath(std::string(line.substr(pos + 2)), basePath);
+        checksumMap[std::move(relativePath)] = std::string(line.substr(0, pos));
     }
     return checksumMap;
 }
 
-int32_t DiskUtils::CompareChecksums(
-    const std::map<std::string, std::string>& sourceMap,
-    const std::map<std::string, std::string>& discMap)
+int32_t DiskUtils::CompareChecksums(const ChecksumIndex& sourceMap, const ChecksumIndex& discMap)
 {
-    constexpr int32_t E_VERIFY_BURN_DATA_FAILED = 13600030;
     LOGI("CompareChecksums: comparing, sourceFiles=%{public}zu, discFiles=%{public}zu",
          sourceMap.size(), discMap.size());
     for (const auto& pair : sourceMap) {
@@ -0,0 +1,968 @@
+/*
+ * Copyright (c) 2026 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "disk_manager/disk/iso_image_builder.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cinttypes>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <set>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "storage_service_errno.h"
+#include "storage_service_log.h"
+#include "utils/op_progress.h"
+
+namespace OHOS {
+namespace StorageDaemon {
+namespace {
+constexpr uint32_t SECTOR_SIZE = 2048;
+constexpr uint32_t PVD_LBA = 16;
+constexpr uint32_t JOLIET_SVD_LBA = 17;
+constexpr uint32_t TERMINATOR_LBA = 18;
+constexpr uint32_t PATH_TABLE_LBA = 19;
+constexpr uint64_t MAX_FILE_SIZE = UINT32_MAX;
+constexpr size_t COPY_BUF_SIZE = 1024 * 1024;
+
+constexpr uint32_t DIR_RECORD_BASE_LEN = 33;
+constexpr uint32_t RECORD_TIME_LEN = 7;
+constexpr uint32_t MAX_DIR_RECORD_LEN = 255;
+constexpr uint32_t PATH_RECORD_BASE_LEN = 8;
+constexpr uint8_t DIR_FLAG_DIRECTORY = 0x02;
+constexpr size_t ISO_BASE_MAX = 8;
+constexpr size_t ISO_EXT_MAX = 3;
+constexpr size_t ISO_VOLUME_ID_MAX = 32;
+constexpr size_t JOLIET_NAME_MAX = 103;
+constexpr size_t JOLIET_VOLUME_ID_MAX = 16;
+constexpr int TM_YEAR_BASE = 1900;
+
+// Volume descriptor field offsets (ECMA-119 8.4).
+constexpr size_t VD_SYSTEM_ID = 8;
+constexpr size_t VD_VOLUME_ID = 40;
+constexpr size_t VD_ID_LEN = 32;
+constexpr size_t VD_SPACE_SIZE = 80;
+constexpr size_t VD_ESCAPES = 88;
+constexpr size_t VD_SET_SIZE = 120;
+constexpr size_t VD_SEQ_NUMBER = 124;
+constexpr size_t VD_BLOCK_SIZE = 128;
+constexpr size_t VD_PATH_TABLE_SIZE = 132;
+constexpr size_t VD_L_PATH_TABLE = 140;
+constexpr size_t VD_M_PATH_TABLE = 148;
+constexpr size_t VD_ROOT_RECORD = 156;
+constexpr size_t VD_SET_ID = 190;
+constexpr size_t VD_LONG_IDS_LEN = 4 * 128;
+constexpr size_t VD_FILE_IDS = 702;
+constexpr size_t VD_FILE_IDS_LEN = 3 * 37;
+constexpr size_t VD_CREATION_DATE = 813;
+constexpr size_t VD_DATE_LEN = 17;
+constexpr size_t VD_STRUCTURE_VERSION = 881;
+constexpr uint8_t VD_TYPE_PRIMARY = 1;
+constexpr uint8_t VD_TYPE_SUPPLEMENTARY = 2;
+constexpr uint8_t VD_TYPE_TERMINATOR = 255;
+
+// System Use Sharing Protocol and Rock Ridge (RRIP 1.09) entries.
+constexpr uint8_t SUSP_VERSION = 1;
+constexpr uint32_t SP_LEN = 7;
+constexpr uint32_t CE_LEN = 28;
+constexpr uint32_t PX_LEN = 36;
+constexpr uint32_t TF_LEN = 26;
+constexpr uint32_t NM_HEADER_LEN = 5;
+constexpr uint32_t NM_CHUNK_MAX = MAX_DIR_RECORD_LEN - NM_HEADER_LEN;
+constexpr uint8_t NM_FLAG_CONTINUE = 0x01;
+constexpr uint32_t SL_HEADER_LEN = 5;
+constexpr uint32_t SL_COMPONENT_HEADER_LEN = 2;
+constexpr uint8_t SL_FLAG_CONTINUE = 0x01;
+constexpr uint8_t SL_FLAG_CURRENT = 0x02;
+constexpr uint8_t SL_FLAG_PARENT = 0x04;
+constexpr uint8_t SL_FLAG_ROOT = 0x08;
+constexpr mode_t RR_READ_BITS = S_IRUSR | S_IRGRP | S_IROTH;
+constexpr mode_t RR_EXEC_BITS = S_IXUSR | S_IXGRP | S_IXOTH;
+constexpr uint8_t TF_FLAGS_MODIFY_ACCESS_ATTRIBUTES = 0x0E;
+constexpr const char *ER_ID = "RRIP_1991A";
+constexpr const char *ER_DESCRIPTOR = "THE ROCK RIDGE INTERCHANGE PROTOCOL PROVIDES SUPPORT FOR POSIX FILE SYSTEM SEMANTICS";
+constexpr const char *ER_SOURCE = "PLEASE CONTACT DISC PUBLISHER FOR SPECIFICATION SOURCE.  SEE PUBLISHER IDENTIFIER IN "
+    "PRIMARY VOLUME DESCRIPTOR FOR CONTACT INFORMATION.";
+constexpr uint32_t ER_HEADER_LEN = 8;
+
+uint32_t Sectors(uint64_t bytes)
+{
+    return static_cast<uint32_t>((bytes + SECTOR_SIZE - 1) / SECTOR_SIZE);
+}
+
+void PutLe16(uint8_t *p, uint16_t v)
+{
+    p[0] = static_cast<uint8_t>(v);
+    p[1] = static_cast<uint8_t>(v >> 8);
+}
+
+void PutBe16(uint8_t *p, uint16_t v)
+{
+    p[0] = static_cast<uint8_t>(v >> 8);
+    p[1] = static_cast<uint8_t>(v);
+}
+
+void PutLe32(uint8_t *p, uint32_t v)
+{
+    PutLe16(p, static_cast<uint16_t>(v));
+    PutLe16(p + sizeof(uint16_t), static_cast<uint16_t>(v >> 16));
+}
+
+void PutBe32(uint8_t *p, uint32_t v)
+{
+    PutBe16(p, static_cast<uint16_t>(v >> 16));
+    PutBe16(p + sizeof(uint16_t), static_cast<uint16_t>(v));
+}
+
+void PutBoth16(uint8_t *p, uint16_t v)
+{
+    PutLe16(p, v);
+    PutBe16(p + sizeof(uint16_t), v);
+}
+
+void PutBoth32(uint8_t *p, uint32_t v)
+{
+    PutLe32(p, v);
+    PutBe32(p + sizeof(uint32_t), v);
+}
+
+void AppendBoth32(std::vector<uint8_t> &out, uint32_t v)
+{
+    size_t pos = out.size();
+    out.resize(pos + 2 * sizeof(uint32_t));
+    PutBoth32(out.data() + pos, v);
+}
+
+// Directory record time (ECMA-119 9.1.5), always in UTC.
+void PutRecordTime(uint8_t *p, time_t t)
+{
+    struct tm tm {};
+    (void)gmtime_r(&t, &tm);
+    p[0] = static_cast<uint8_t>(tm.tm_year);
+    p[1] = static_cast<uint8_t>(tm.tm_mon + 1);
+    p[2] = static_cast<uint8_t>(tm.tm_mday);
+    p[3] = static_cast<uint8_t>(tm.tm_hour);
+    p[4] = static_cast<uint8_t>(tm.tm_min);
+    p[5] = static_cast<uint8_t>(tm.tm_sec);
+    p[6] = 0;
+}
+
+// Volume descriptor date (ECMA-119 8.4.26.1); t == 0 stands for "not specified".
+void PutVolumeTime(uint8_t *p, time_t t)
+{
+    char buf[VD_DATE_LEN + 1] = { 0 };
+    if (t == 0) {
+        (void)snprintf(buf, sizeof(buf), "%016d", 0);
+    } else {
+        struct tm tm {};
+        (void)gmtime_r(&t, &tm);
+        (void)snprintf(buf, sizeof(buf), "%04d%02d%02d%02d%02d%02d00", tm.tm_year + TM_YEAR_BASE, tm.tm_mon + 1,
+            tm.tm_mday, tm.tm_hour, tm.tm_min, tm.tm_sec);
+    }
+    std::copy(buf, buf + VD_DATE_LEN - 1, p);
+    p[VD_DATE_LEN - 1] = 0;
+}
+
+void PutPadded(uint8_t *p, size_t len, const std::string &s)
+{
+    std::fill(p, p + len, ' ');
+    std::copy(s.begin(), s.begin() + std::min(len, s.size()), p);
+}
+
+void PutPadded16(uint8_t *p, size_t len, const std::u16string &s)
+{
+    for (size_t i = 0; i + 1 < len; i += sizeof(char16_t)) {
+        PutBe16(p + i, i / sizeof(char16_t) < s.size() ? s[i / sizeof(char16_t)] : u' ');
+    }
+}
+
+std::string ToBe16Bytes(const std::u16string &s)
+{
+    std::string out(s.size() * sizeof(char16_t), '\0');
+    for (size_t i = 0; i < s.size(); i++) {
+        PutBe16(reinterpret_cast<uint8_t *>(&out[i * sizeof(char16_t)]), s[i]);
+    }
+    return out;
+}
+
+// Decodes UTF-8 into UTF-16; bytes that are not valid UTF-8 come out as '_'.
+std::u16string ToUtf16(const std::string &s)
+{
+    std::u16string out;
+    size_t i = 0;
+    while (i < s.size()) {
+        auto c = static_cast<unsigned char>(s[i]);
+        size_t n = c < 0x80 ? 1 : (c >> 5) == 0x06 ? 2 : (c >> 4) == 0x0E ? 3 : (c >> 3) == 0x1E ? 4 : 0;
+        uint32_t cp = n == 1 ? c : n == 2 ? (c & 0x1F) : n == 3 ? (c & 0x0F) : (c & 0x07);
+        bool valid = n != 0 && i + n <= s.size();
+        for (size_t k = 1; valid && k < n; k++) {
+            auto cc = static_cast<unsigned char>(s[i + k]);
+            valid = (cc & 0xC0) == 0x80;
+            cp = (cp << 6) | (cc & 0x3F);
+        }
+        if (!valid) {
+            out.push_back(u'_');
+            i++;
+            continue;
+        }
+        i += n;
+        if (cp >= 0x10000) {
+            cp -= 0x10000;
+            out.push_back(static_cast<char16_t>(0xD800 + (cp >> 10)));
+            out.push_back(static_cast<char16_t>(0xDC00 + (cp & 0x3FF)));
+        } else {
+            out.push_back(static_cast<char16_t>(cp));
+        }
+    }
+    return out;
+}
+
+// Maps a name onto d-characters (A-Z, 0-9, _).
+std::string ToDChars(const std::string &s, size_t maxLen)
+{
+    std::string out;
+    for (char c : s) {
+        if (out.size() == maxLen) {
+            break;
+        }
+        if ((c >= 'a' && c <= 'z')) {
+            out.push_back(static_cast<char>(c - 'a' + 'A'));
+        } else if ((c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9')) {
+            out.push_back(c);
+        } else {
+            out.push_back('_');
+        }
+    }
+    return out;
+}
+
+std::u16string ToJolietName(const std::string &name)
+{
+    std::u16string out = ToUtf16(name);
+    for (auto &c : out) {
+        if (c < u' ' || c == u'*' || c == u'/' || c == u':' || c == u';' || c == u'?' || c == u'\\') {
+            c = u'_';
+        }
+    }
+    if (out.size() > JOLIET_NAME_MAX) {
+        size_t len = JOLIET_NAME_MAX;
+        if (out[len - 1] >= 0xD800 && out[len - 1] < 0xDC00) {
+            len--;
+        }
+        out.resize(len);
+    }
+    return out;
+}
+
+uint32_t RecordLen(size_t idLen, size_t suLen)
+{
+    return static_cast<uint32_t>(DIR_RECORD_BASE_LEN + idLen + (idLen % 2 == 0 ? 1 : 0) + suLen);
+}
+
+// A directory record may not cross a sector boundary: returns where a record of len bytes goes.
+uint32_t PlaceRecord(uint32_t &offset, uint32_t len)
+{
+    if (offset % SECTOR_SIZE + len > SECTOR_SIZE) {
+        offset = Sectors(offset) * SECTOR_SIZE;
+    }
+    uint32_t pos = offset;
+    offset += len;
+    return pos;
+}
+
+void PutRecord(uint8_t *p, uint32_t lba, uint32_t size, time_t mtime, bool isDir, const std::string &id,
+               const std::vector<uint8_t> &su)
+{
+    uint32_t len = RecordLen(id.size(), su.size());
+    p[0] = static_cast<uint8_t>(len);
+    PutBoth32(p + 2, lba);                              // 2: extent location
+    PutBoth32(p + 10, size);                            // 10: data length
+    PutRecordTime(p + 18, mtime);                       // 18: recording date
+    p[25] = isDir ? DIR_FLAG_DIRECTORY : 0;             // 25: file flags
+    PutBoth16(p + 28, 1);                               // 28: volume sequence number
+    p[32] = static_cast<uint8_t>(id.size());            // 32: identifier length
+    std::copy(id.begin(), id.end(), p + DIR_RECORD_BASE_LEN);
+    std::copy(su.begin(), su.end(), p + len - su.size());
+}
+
+void AppendSuspHeader(std::vector<uint8_t> &su, char c1, char c2, uint32_t len)
+{
+    su.push_back(static_cast<uint8_t>(c1));
+    su.push_back(static_cast<uint8_t>(c2));
+    su.push_back(static_cast<uint8_t>(len));
+    su.push_back(SUSP_VERSION);
+}
+
+void AppendSp(std::vector<uint8_t> &su)
+{
+    AppendSuspHeader(su, 'S', 'P', SP_LEN);
+    su.push_back(0xBE);
+    su.push_back(0xEF);
+    su.push_back(0);
+}
+
+void AppendCe(std::vector<uint8_t> &su, uint32_t lba, uint32_t offset, uint32_t len)
+{
+    AppendSuspHeader(su, 'C', 'E', CE_LEN);
+    AppendBoth32(su, lba);
+    AppendBoth32(su, offset);
+    AppendBoth32(su, len);
+}
+
+// Attributes as "genisoimage -r" records them: owned by root, readable by all, executable by all if by anyone,
+// and no write, setuid, setgid or sticky bits.
+void AppendPx(std::vector<uint8_t> &su, const struct stat &st, uint32_t nlink)
+{
+    mode_t mode = (st.st_mode & S_IFMT) | RR_READ_BITS;
+    if (S_ISDIR(st.st_mode) || (st.st_mode & RR_EXEC_BITS) != 0) {
+        mode |= RR_EXEC_BITS;
+    }
+    AppendSuspHeader(su, 'P', 'X', PX_LEN);
+    AppendBoth32(su, mode);
+    AppendBoth32(su, nlink);
+    AppendBoth32(su, 0);
+    AppendBoth32(su, 0);
+}
+
+void AppendTf(std::vector<uint8_t> &su, const struct stat &st)
+{
+    AppendSuspHeader(su, 'T', 'F', TF_LEN);
+    su.push_back(TF_FLAGS_MODIFY_ACCESS_ATTRIBUTES);
+    for (time_t t : { st.st_mtime, st.st_atime, st.st_ctime }) {
+        size_t pos = su.size();
+        su.resize(pos + RECORD_TIME_LEN);
+        PutRecordTime(su.data() + pos, t);
+    }
+}
+
+// NM entries for name, split into chunks that each fit an entry.
+void AppendNm(std::vector<uint8_t> &su, const std::string &name)
+{
+    for (size_t pos = 0; pos < name.size(); pos += NM_CHUNK_MAX) {
+        size_t len = std::min<size_t>(NM_CHUNK_MAX, name.size() - pos);
+        AppendSuspHeader(su, 'N', 'M', NM_HEADER_LEN + len);
+        su.push_back(pos + len < name.size() ? NM_FLAG_CONTINUE : 0);
+        su.insert(su.end(), name.begin() + pos, name.begin() + pos + len);
+    }
+}
+
+// Splits a symlink target into SL component records (RRIP 4.1.3.1): flags, then the path element.
+std::vector<std::pair<uint8_t, std::string>> SlComponents(const std::string &target)
+{
+    std::vector<std::pair<uint8_t, std::string>> components;
+    size_t pos = 0;
+    if (!target.empty() && target[0] == '/') {
+        components.emplace_back(SL_FLAG_ROOT, "");
+        pos = 1;
+    }
+    while (pos < target.size()) {
+        size_t end = std::min(target.find('/', pos), target.size());
+        std::string element = target.substr(pos, end - pos);
+        pos = end + 1;
+        if (element == "." || element == "..") {
+            components.emplace_back(element == "." ? SL_FLAG_CURRENT : SL_FLAG_PARENT, "");
+        } else if (!element.empty()) {
+            components.emplace_back(0, element);
+        }
+    }
+    return components;
+}
+
+// SL entries for a symlink target. An element that does not fit the rest of an entry is split into records
+// flagged to continue, so an entry boundary falls inside an element and readers need not guess a '/' there.
+void AppendSl(std::vector<uint8_t> &su, const std::string &target)
+{
+    size_t header = 0;
+    uint32_t len = 0;
+    bool open = false;
+    for (const auto &[flags, element] : SlComponents(target)) {
+        size_t pos = 0;
+        do {
+            if (!open || len + SL_COMPONENT_HEADER_LEN + (element.empty() ? 0 : 1) > MAX_DIR_RECORD_LEN) {
+                if (open) {
+                    su[header + SL_HEADER_LEN - 1] = SL_FLAG_CONTINUE;
+                }
+                header = su.size();
+                AppendSuspHeader(su, 'S', 'L', SL_HEADER_LEN);
+                su.push_back(0);
+                len = SL_HEADER_LEN;
+                open = true;
+            }
+            size_t chunk = std::min<size_t>(element.size() - pos, MAX_DIR_RECORD_LEN - len - SL_COMPONENT_HEADER_LEN);
+            bool more = pos + chunk < element.size();
+            su.push_back(static_cast<uint8_t>(flags | (more ? SL_FLAG_CONTINUE : 0)));
+            su.push_back(static_cast<uint8_t>(chunk));
+            su.insert(su.end(), element.begin() + pos, element.begin() + pos + chunk);
+            pos += chunk;
+            len += SL_COMPONENT_HEADER_LEN + static_cast<uint32_t>(chunk);
+            su[header + 2] = static_cast<uint8_t>(len);     // 2: entry length
+        } while (pos < element.size());
+    }
+}
+
+void AppendEr(std::vector<uint8_t> &su)
+{
+    size_t idLen = strlen(ER_ID);
+    size_t desLen = strlen(ER_DESCRIPTOR);
+    size_t srcLen = strlen(ER_SOURCE);
+    AppendSuspHeader(su, 'E', 'R', ER_HEADER_LEN + idLen + desLen + srcLen);
+    su.push_back(static_cast<uint8_t>(idLen));
+    su.push_back(static_cast<uint8_t>(desLen));
+    su.push_back(static_cast<uint8_t>(srcLen));
+    su.push_back(1);
+    su.insert(su.end(), ER_ID, ER_ID + idLen);
+    su.insert(su.end(), ER_DESCRIPTOR, ER_DESCRIPTOR + desLen);
+    su.insert(su.end(), ER_SOURCE, ER_SOURCE + srcLen);
+}
+} // namespace
+
+struct IsoImageBuilder::Node {
+    std::string name;
+    std::string path;
+    bool isDir = false;
+    bool isLink = false;
+    std::string linkTarget;
+    struct stat st {};
+    Node *parent = nullptr;
+    std::vector<std::unique_ptr<Node>> children;    // sorted by primary identifier
+    std::vector<Node *> jolietOrder;                // children sorted by Joliet name
+    std::string isoName;
+    std::u16string jolietName;
+    uint32_t subdirs = 0;
+    uint32_t number = 0;        // path table index, directories only
+    uint32_t lba = 0;           // file extent, or primary directory extent
+    uint32_t size = 0;          // file bytes, or primary directory extent bytes
+    uint32_t jolietLba = 0;
+    uint32_t jolietSize = 0;
+    int32_t continuation = -1;  // continuation area holding the NM and SL entries, if they do not fit the record
+};
+
+struct IsoImageBuilder::Continuation {
+    std::vector<uint8_t> data;
+    uint32_t lba = 0;
+    uint32_t offset = 0;
+};
+
+IsoImageBuilder::IsoImageBuilder(const IsoImageOptions &options) : options_(options) {}
+
+IsoImageBuilder::~IsoImageBuilder() = default;
+
+int32_t IsoImageBuilder::Scan(const std::string &rootDir)
+{
+    LOGI("[L8:IsoImageBuilder] Scan: >>> ENTER <<< rootDir=%{public}s", rootDir.c_str());
+    root_ = std::make_unique<Node>();
+    dirs_.clear();
+    files_.clear();
+    continuations_.clear();
+    root_->path = rootDir;
+    root_->isDir = true;
+    if (stat(rootDir.c_str(), &root_->st) != 0 || !S_ISDIR(root_->st.st_mode)) {
+        LOGE("[L8:IsoImageBuilder] Scan: <<< EXIT FAILED <<< not a directory, errno=%{public}d", errno);
+        root_.reset();
+        return E_PARAMS_INVALID;
+    }
+    if (options_.createTime == 0) {
+        options_.createTime = time(nullptr);
+    }
+    // Breadth first with sorted siblings: dirs_ comes out in path table order.
+    dirs_.push_back(root_.get());
+    for (size_t i = 0; i < dirs_.size(); i++) {
+        dirs_[i]->number = static_cast<uint32_t>(i + 1);
+        int32_t err = ScanDir(*dirs_[i]);
+        if (err != E_OK) {
+            root_.reset();
+            return err;
+        }
+    }
+    Layout();
+    LOGI("[L8:IsoImageBuilder] Scan: <<< EXIT SUCCESS <<< dirs=%{public}zu, files=%{public}zu, "
+         "sectors=%{public}u", dirs_.size(), files_.size(), totalSectors_);
+    return E_OK;
+}
+
+int32_t IsoImageBuilder::ScanDir(Node &dir)
+{
+    DIR *dp = opendir(dir.path.c_str());
+    if (dp == nullptr) {
+        LOGE("[L8:IsoImageBuilder] ScanDir: opendir failed, errno=%{public}d", errno);
+        return E_ERR;
+    }
+    int32_t err = E_OK;
+    struct dirent *entry = nullptr;
+    while (err == E_OK && (entry = readdir(dp)) != nullptr) {
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
+            continue;
+        }
+        auto child = std::make_unique<Node>();
+        child->name = entry->d_name;
+        child->path = dir.path + "/" + child->name;
+        child->parent = &dir;
+        if (fstatat(dirfd(dp), entry->d_name, &child->st, AT_SYMLINK_NOFOLLOW) != 0) {
+            LOGE("[L8:IsoImageBuilder] ScanDir: stat failed, errno=%{public}d", errno);
+            err = E_ERR;
+        } else if (S_ISDIR(child->st.st_mode)) {
+            child->isDir = true;
+            dir.subdirs++;
+            dir.children.push_back(std::move(child));
+        } else if (S_ISLNK(child->st.st_mode)) {
+            err = ReadLink(dirfd(dp), *child);
+            if (err == E_OK) {
+                dir.children.push_back(std::move(child));
+            }
+        } else if (!S_ISREG(child->st.st_mode)) {
+            LOGI("[L8:IsoImageBuilder] ScanDir: skip special file, mode=%{public}o", child->st.st_mode);
+        } else if (static_cast<uint64_t>(child->st.st_size) > MAX_FILE_SIZE) {
+            LOGE("[L8:IsoImageBuilder] ScanDir: file of %{public}" PRId64 " bytes needs multi-extent",
+                 static_cast<int64_t>(child->st.st_size));
+            err = E_NOT_SUPPORT;
+        } else {
+            child->size = static_cast<uint32_t>(child->st.st_size);
+            dir.children.push_back(std::move(child));
+        }
+    }
+    (void)closedir(dp);
+    if (err != E_OK) {
+        return err;
+    }
+    AssignNames(dir);
+    for (auto &child : dir.children) {
+        if (child->isDir) {
+            dirs_.push_back(child.get());
+        } else if (!child->isLink) {
+            files_.push_back(child.get());
+        }
+    }
+    return E_OK;
+}
+
+// A symlink is recorded as an empty file carrying its target in SL entries, which have to fit one
+// continuation area together with the name.
+int32_t IsoImageBuilder::ReadLink(int dirFd, Node &link)
+{
+    std::vector<char> buf(PATH_MAX);
+    ssize_t len = readlinkat(dirFd, link.name.c_str(), buf.data(), buf.size());
+    if (len < 0 || static_cast<size_t>(len) >= buf.size()) {
+        LOGE("[L8:IsoImageBuilder] ReadLink: readlink failed, errno=%{public}d", errno);
+        return E_ERR;
+    }
+    link.isLink = true;
+    link.linkTarget.assign(buf.data(), static_cast<size_t>(len));
+    std::vector<uint8_t> tail;
+    AppendNameEntries(tail, link);
+    if (tail.size() > SECTOR_SIZE) {
+        LOGE("[L8:IsoImageBuilder] ReadLink: target of %{public}zd bytes does not fit a continuation area", len);
+        return E_NOT_SUPPORT;
+    }
+    return E_OK;
+}
+
+void IsoImageBuilder::AppendNameEntries(std::vector<uint8_t> &su, const Node &node)
+{
+    AppendNm(su, node.name);
+    if (node.isLink) {
+        AppendSl(su, node.linkTarget);
+    }
+}
+
+// Level 1 identifiers for the primary tree and Joliet names, each unique within dir, then sorts both orders.
+void IsoImageBuilder::AssignNames(Node &dir)
+{
+    struct IsoKey {
+        std::string base;
+        std::string ext;
+        Node *node;
+    };
+    std::vector<IsoKey> keys;
+    std::set<std::string> used;
+    std::set<std::u16string> usedJoliet;
+    for (auto &child : dir.children) {
+        size_t dot = child->isDir ? std::string::npos : child->name.rfind('.');
+        bool hasExt = dot != std::string::npos && dot > 0;
+        std::string base = ToDChars(hasExt ? child->name.substr(0, dot) : child->name, ISO_BASE_MAX);
+        std::string ext = hasExt ? ToDChars(child->name.substr(dot + 1), ISO_EXT_MAX) : "";
+        auto identifier = [&child](const std::string &b, const std::string &e) {
+            return child->isDir ? b : b + "." + e + ";1";
+        };
+        std::string candidate = base;
+        for (uint32_t n = 1; used.count(identifier(candidate, ext)) != 0; n++) {
+            std::string suffix = std::to_string(n);
+            candidate = base.substr(0, ISO_BASE_MAX - std::min(ISO_BASE_MAX, suffix.size())) + suffix;
+        }
+        child->isoName = identifier(candidate, ext);
+        used.insert(child->isoName);
+        keys.push_back({ candidate, ext, child.get() });
+
+        std::u16string joliet = ToJolietName(child->name);
+        std::u16string jolietCandidate = joliet;
+        for (uint32_t n = 1; usedJoliet.count(jolietCandidate) != 0; n++) {
+            std::string suffix = std::to_string(n);
+            jolietCandidate = joliet.substr(0, JOLIET_NAME_MAX - suffix.size()) + ToUtf16(suffix);
+        }
+        child->jolietName = jolietCandidate;
+        usedJoliet.insert(jolietCandidate);
+    }
+    // ECMA-119 9.3: by name, then by extension, each compared as if padded with spaces.
+    std::sort(keys.begin(), keys.end(), [](const IsoKey &a, const IsoKey &b) {
+        return a.base != b.base ? a.base < b.base : a.ext < b.ext;
+    });
+    std::vector<std::unique_ptr<Node>> sorted;
+    for (auto &key : keys) {
+        for (auto &child : dir.children) {
+            if (child.get() == key.node) {
+                sorted.push_back(std::move(child));
+                break;
+            }
+        }
+    }
+    dir.children = std::move(sorted);
+    for (auto &child : dir.children) {
+        dir.jolietOrder.push_back(child.get());
+    }
+    std::sort(dir.jolietOrder.begin(), dir.jolietOrder.end(),
+        [](const Node *a, const Node *b) { return a->jolietName < b->jolietName; });
+}
+
+uint32_t IsoImageBuilder::PrimaryDirSize(const Node &dir)
+{
+    uint32_t offset = 0;
+    uint32_t dotSu = PX_LEN + TF_LEN + (dir.parent == nullptr ? SP_LEN + CE_LEN : 0);
+    (void)PlaceRecord(offset, RecordLen(1, dotSu));
+    (void)PlaceRecord(offset, RecordLen(1, PX_LEN + TF_LEN));
+    for (auto &child : dir.children) {
+        std::vector<uint8_t> tail;
+        AppendNameEntries(tail, *child);
+        uint32_t len = RecordLen(child->isoName.size(), PX_LEN + TF_LEN + tail.size());
+        if (len > MAX_DIR_RECORD_LEN) {
+            Continuation continuation;
+            continuation.data = std::move(tail);
+            child->continuation = static_cast<int32_t>(continuations_.size());
+            continuations_.push_back(std::move(continuation));
+            len = RecordLen(child->isoName.size(), PX_LEN + TF_LEN + CE_LEN);
+        }
+        (void)PlaceRecord(offset, len);
+    }
+    return Sectors(offset) * SECTOR_SIZE;
+}
+
+uint32_t IsoImageBuilder::JolietDirSize(const Node &dir) const
+{
+    uint32_t offset = 0;
+    (void)PlaceRecord(offset, RecordLen(1, 0));
+    (void)PlaceRecord(offset, RecordLen(1, 0));
+    for (const Node *child : dir.jolietOrder) {
+        (void)PlaceRecord(offset, RecordLen(child->jolietName.size() * sizeof(char16_t), 0));
+    }
+    return Sectors(offset) * SECTOR_SIZE;
+}
+
+// Packs the continuation areas from first on into the sectors from lba on, as readers that stream the
+// image expect them right behind the directory that refers to them. None may cross a sector boundary.
+uint32_t IsoImageBuilder::PlaceContinuations(size_t first, uint32_t lba)
+{
+    if (first == continuations_.size()) {
+        return lba;
+    }
+    uint32_t offset = 0;
+    for (size_t i = first; i < continuations_.size(); i++) {
+        Continuation &continuation = continuations_[i];
+        if (offset + continuation.data.size() > SECTOR_SIZE) {
+            lba++;
+            offset = 0;
+        }
+        continuation.lba = lba;
+        continuation.offset = offset;
+        offset += static_cast<uint32_t>(continuation.data.size());
+    }
+    return lba + 1;
+}
+
+void IsoImageBuilder::Layout()
+{
+    pathTableSize_ = 0;
+    jolietPathTableSize_ = 0;
+    for (const Node *dir : dirs_) {
+        size_t idLen = dir->parent == nullptr ? 1 : dir->isoName.size();
+        size_t jolietLen = dir->parent == nullptr ? 1 : dir->jolietName.size() * sizeof(char16_t);
+        pathTableSize_ += PATH_RECORD_BASE_LEN + idLen + idLen % 2;
+        jolietPathTableSize_ += PATH_RECORD_BASE_LEN + jolietLen + jolietLen % 2;
+    }
+    pathTableLba_ = PATH_TABLE_LBA;
+    pathTableSectors_ = Sectors(pathTableSize_);
+    jolietPathTableSectors_ = Sectors(jolietPathTableSize_);
+    uint32_t lba = pathTableLba_ + 2 * pathTableSectors_ + 2 * jolietPathTableSectors_;
+
+    // Continuation 0 holds the ER entry; the root's "." record points at it.
+    Continuation er;
+    AppendEr(er.data);
+    continuations_.push_back(std::move(er));
+    for (Node *dir : dirs_) {
+        size_t first = dir->parent == nullptr ? 0 : continuations_.size();
+        dir->size = PrimaryDirSize(*dir);
+        dir->lba = lba;
+        lba = PlaceContinuations(first, lba + dir->size / SECTOR_SIZE);
+    }
+    for (Node *dir : dirs_) {
+        dir->jolietSize = JolietDirSize(*dir);
+        dir->jolietLba = lba;
+        lba += dir->jolietSize / SECTOR_SIZE;
+    }
+    metaSectors_ = lba;
+    for (Node *file : files_) {
+        file->lba = lba;
+        lba += Sectors(file->size);
+    }
+    totalSectors_ = lba;
+}
+
+uint64_t IsoImageBuilder::GetImageSize() const
+{
+    return static_cast<uint64_t>(totalSectors_) * SECTOR_SIZE;
+}
+
+void IsoImageBuilder::WriteVolumeDescriptors(std::vector<uint8_t> &meta) const
+{
+    for (bool joliet : { false, true }) {
+        uint8_t *p = meta.data() + static_cast<size_t>(joliet ? JOLIET_SVD_LBA : PVD_LBA) * SECTOR_SIZE;
+        p[0] = joliet ? VD_TYPE_SUPPLEMENTARY : VD_TYPE_PRIMARY;
+        std::copy_n("CD001", strlen("CD001"), p + 1);
+        p[6] = 1;
+        if (joliet) {
+            PutPadded16(p + VD_SYSTEM_ID, VD_ID_LEN, u"");
+            PutPadded16(p + VD_VOLUME_ID, VD_ID_LEN, ToUtf16(options_.volumeId).substr(0, JOLIET_VOLUME_ID_MAX));
+            std::copy_n("%/E", strlen("%/E"), p + VD_ESCAPES);     // UCS-2 level 3
+            PutPadded16(p + VD_SET_ID, VD_LONG_IDS_LEN, u"");
+            PutPadded16(p + VD_FILE_IDS, VD_FILE_IDS_LEN, u"");
+        } else {
+            PutPadded(p + VD_SYSTEM_ID, VD_ID_LEN, "");
+            PutPadded(p + VD_VOLUME_ID, VD_ID_LEN, ToDChars(options_.volumeId, ISO_VOLUME_ID_MAX));
+            PutPadded(p + VD_SET_ID, VD_LONG_IDS_LEN, "");
+            PutPadded(p + VD_FILE_IDS, VD_FILE_IDS_LEN, "");
+        }
+        PutBoth32(p + VD_SPACE_SIZE, totalSectors_);
+        PutBoth16(p + VD_SET_SIZE, 1);
+        PutBoth16(p + VD_SEQ_NUMBER, 1);
+        PutBoth16(p + VD_BLOCK_SIZE, SECTOR_SIZE);
+        uint32_t tableSectors = joliet ? jolietPathTableSectors_ : pathTableSectors_;
+        uint32_t lTable = pathTableLba_ + (joliet ? 2 * pathTableSectors_ : 0);
+        PutBoth32(p + VD_PATH_TABLE_SIZE, joliet ? jolietPathTableSize_ : pathTableSize_);
+        PutLe32(p + VD_L_PATH_TABLE, lTable);
+        PutBe32(p + VD_M_PATH_TABLE, lTable + tableSectors);
+        PutRecord(p + VD_ROOT_RECORD, joliet ? root_->jolietLba : root_->lba, joliet ? root_->jolietSize : root_->size,
+            root_->st.st_mtime, true, std::string(1, '\0'), {});
+        // Creation and modification dates; expiration and effective dates stay unspecified.
+        PutVolumeTime(p + VD_CREATION_DATE, options_.createTime);
+        PutVolumeTime(p + VD_CREATION_DATE + VD_DATE_LEN, options_.createTime);
+        PutVolumeTime(p + VD_CREATION_DATE + 2 * VD_DATE_LEN, 0);
+        PutVolumeTime(p + VD_CREATION_DATE + 3 * VD_DATE_LEN, 0);
+        p[VD_STRUCTURE_VERSION] = 1;
+    }
+    uint8_t *p = meta.data() + static_cast<size_t>(TERMINATOR_LBA) * SECTOR_SIZE;
+    p[0] = VD_TYPE_TERMINATOR;
+    std::copy_n("CD001", strlen("CD001"), p + 1);
+    p[6] = 1;
+}
+
+void IsoImageBuilder::WritePathTables(std::vector<uint8_t> &meta) const
+{
+    uint32_t lba = pathTableLba_;
+    for (bool joliet : { false, true }) {
+        for (bool bigEndian : { false, true }) {
+            uint8_t *p = meta.data() + static_cast<size_t>(lba) * SECTOR_SIZE;
+            for (const Node *dir : dirs_) {
+                std::string id = dir->parent == nullptr ? std::string(1, '\0') :
+                    (joliet ? ToBe16Bytes(dir->jolietName) : dir->isoName);
+                uint32_t extent = joliet ? dir->jolietLba : dir->lba;
+                uint16_t parent = static_cast<uint16_t>(dir->parent == nullptr ? 1 : dir->parent->number);
+                p[0] = static_cast<uint8_t>(id.size());
+                bigEndian ? PutBe32(p + 2, extent) : PutLe32(p + 2, extent);
+                bigEndian ? PutBe16(p + 6, parent) : PutLe16(p + 6, parent);
+                std::copy(id.begin(), id.end(), p + PATH_RECORD_BASE_LEN);
+                p += PATH_RECORD_BASE_LEN + id.size() + id.size() % 2;
+            }
+            lba += joliet ? jolietPathTableSectors_ : pathTableSectors_;
+        }
+    }
+}
+
+void IsoImageBuilder::WritePrimaryDir(std::vector<uint8_t> &meta, const Node &dir) const
+{
+    uint8_t *base = meta.data() + static_cast<size_t>(dir.lba) * SECTOR_SIZE;
+    uint32_t offset = 0;
+    std::vector<uint8_t> su;
+    if (dir.parent == nullptr) {
+        const Continuation &er = continuations_[0];
+        AppendSp(su);
+        AppendCe(su, er.lba, er.offset, static_cast<uint32_t>(er.data.size()));
+    }
+    AppendPx(su, dir.st, 2 + dir.subdirs);
+    AppendTf(su, dir.st);
+    std::string dot(1, '\0');
+    PutRecord(base + PlaceRecord(offset, RecordLen(1, su.size())), dir.lba, dir.size, dir.st.st_mtime, true, dot, su);
+
+    const Node &parent = dir.parent == nullptr ? dir : *dir.parent;
+    su.clear();
+    AppendPx(su, parent.st, 2 + parent.subdirs);
+    AppendTf(su, parent.st);
+    std::string dotdot(1, '\1');
+    PutRecord(base + PlaceRecord(offset, RecordLen(1, su.size())), parent.lba, parent.size, parent.st.st_mtime, true,
+        dotdot, su);
+
+    for (const auto &child : dir.children) {
+        su.clear();
+        AppendPx(su, child->st, child->isDir ? 2 + child->subdirs : 1);
+        AppendTf(su, child->st);
+        if (child->continuation < 0) {
+            AppendNameEntries(su, *child);
+        } else {
+            const Continuation &tail = continuations_[child->continuation];
+            AppendCe(su, tail.lba, tail.offset, static_cast<uint32_t>(tail.data.size()));
+        }
+        uint32_t pos = PlaceRecord(offset, RecordLen(child->isoName.size(), su.size()));
+        PutRecord(base + pos, child->lba, child->size, child->st.st_mtime, child->isDir, child->isoName, su);
+    }
+}
+
+void IsoImageBuilder::WriteJolietDir(std::vector<uint8_t> &meta, const Node &dir) const
+{
+    uint8_t *base = meta.data() + static_cast<size_t>(dir.jolietLba) * SECTOR_SIZE;
+    uint32_t offset = 0;
+    const Node &parent = dir.parent == nullptr ? dir : *dir.parent;
+    PutRecord(base + PlaceRecord(offset, RecordLen(1, 0)), dir.jolietLba, dir.jolietSize, dir.st.st_mtime, true,
+        std::string(1, '\0'), {});
+    PutRecord(base + PlaceRecord(offset, RecordLen(1, 0)), parent.jolietLba, parent.jolietSize, parent.st.st_mtime,
+        true, std::string(1, '\1'), {});
+    for (const Node *child : dir.jolietOrder) {
+        std::string id = ToBe16Bytes(child->jolietName);
+        uint32_t lba = child->isDir ? child->jolietLba : child->lba;
+        uint32_t size = child->isDir ? child->jolietSize : child->size;
+        PutRecord(base + PlaceRecord(offset, RecordLen(id.size(), 0)), lba, size, child->st.st_mtime, child->isDir,
+            id, {});
+    }
+}
+
+void IsoImageBuilder::BuildMetadata(std::vector<uint8_t> &meta) const
+{
+    meta.assign(static_cast<size_t>(metaSectors_) * SECTOR_SIZE, 0);
+    WriteVolumeDescriptors(meta);
+    WritePathTables(meta);
+    for (const Node *dir : dirs_) {
+        WritePrimaryDir(meta, *dir);
+        WriteJolietDir(meta, *dir);
+    }
+    for (const auto &continuation : continuations_) {
+        std::copy(continuation.data.begin(), continuation.data.end(),
+            meta.data() + static_cast<size_t>(continuation.lba) * SECTOR_SIZE + continuation.offset);
+    }
+}
+
+int32_t IsoImageBuilder::StreamFile(const Node &file, const IsoImageSink &sink, std::vector<uint8_t> &buf,
+                                    uint64_t &written)
+{
+    int fd = open(file.path.c_str(), O_RDONLY | O_CLOEXEC | O_NOFOLLOW);
+    if (fd < 0) {
+        LOGE("[L8:IsoImageBuilder] StreamFile: open failed, errno=%{public}d", errno);
+        return E_ERR;
+    }
+    struct stat st {};
+    if (fstat(fd, &st) != 0 || st.st_size != file.st.st_size) {
+        LOGE("[L8:IsoImageBuilder] StreamFile: file changed since scan");
+        (void)close(fd);
+        return E_ERR;
+    }
+    (void)posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    int32_t err = E_OK;
+    uint64_t remaining = file.size;
+    while (err == E_OK && remaining > 0) {
+        ssize_t n = read(fd, buf.data(), std::min<uint64_t>(remaining, buf.size()));
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            LOGE("[L8:IsoImageBuilder] StreamFile: read failed or file shrank, errno=%{public}d", errno);
+            err = E_ERR;
+            break;
+        }
+        err = sink(buf.data(), static_cast<size_t>(n));
+        remaining -= static_cast<uint64_t>(n);
+        written += static_cast<uint64_t>(n);
+        OpProgressScope::ReportBytes(written, GetImageSize());
+    }
+    (void)close(fd);
+    uint32_t pad = Sectors(file.size) * SECTOR_SIZE - file.size;
+    if (err == E_OK && pad > 0) {
+        static const uint8_t zeros[SECTOR_SIZE] = { 0 };
+        err = sink(zeros, pad);
+        written += pad;
+    }
+    return err;
+}
+
+int32_t IsoImageBuilder::Stream(const IsoImageSink &sink)
+{
+    if (root_ == nullptr) {
+        LOGE("[L8:IsoImageBuilder] Stream: <<< EXIT FAILED <<< nothing scanned");
+        return E_ERR;
+    }
+    LOGI("[L8:IsoImageBuilder] Stream: >>> ENTER <<< bytes=%{public}" PRIu64, GetImageSize());
+    uint64_t written = 0;
+    {
+        std::vector<uint8_t> meta;
+        BuildMetadata(meta);
+        int32_t err = sink(meta.data(), meta.size());
+        if (err != E_OK) {
+            LOGE("[L8:IsoImageBuilder] Stream: <<< EXIT FAILED <<< metadata not taken, err=%{public}d", err);
+            return err;
+        }
+        written = meta.size();
+    }
+    OpProgressScope::ReportBytes(written, GetImageSize());
+    std::vector<uint8_t> buf(COPY_BUF_SIZE);
+    for (const Node *file : files_) {
+        int32_t err = StreamFile(*file, sink, buf, written);
+        if (err != E_OK) {
+            LOGE("[L8:IsoImageBuilder] Stream: <<< EXIT FAILED <<< at byte %{public}" PRIu64 ", err=%{public}d",
+                 written, err);
+            return err;
+        }
+    }
+    LOGI("[L8:IsoImageBuilder] Stream: <<< EXIT SUCCESS <<<");
+    return E_OK;
+}
+
+int32_t IsoImageBuilder::WriteTo(int fd)
+{
+    return Stream([fd](const uint8_t *data, size_t len) -> int32_t {
+        while (len > 0) {
+            ssize_t n = write(fd, data, len);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                LOGE("[L8:IsoImageBuilder] WriteTo: write failed, errno=%{public}d", errno);
+                return E_ERR;
+            }
+            data += n;
+            len -= static_cast<size_t>(n);
+        }
+        return E_OK;
+    });
+}
+} // namespace StorageDaemon
+} // namespace OHOS
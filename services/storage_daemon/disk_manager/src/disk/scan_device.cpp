@@ -25,6 +25,7 @@
 #include <fnmatch.h>
 #include <fstream>
 #include <cerrno>
+#include <iterator>
 #include <cinttypes>
 #include <linux/fs.h>
 #include <linux/hdreg.h>
@@ -61,6 +62,8 @@ constexpr const char *REVNUM_NODE = "/device/rev";
 constexpr const char *MAJOR_KEY = "MAJOR=";
 constexpr const char *MINOR_KEY = "MINOR=";
 constexpr const char *SERIAL_NODE = "/device/serial";
+constexpr const char *DEVNUM_NODE = "/devnum";
+constexpr const char *BUSNUM_NODE = "/busnum";
 constexpr const char *ATA_PREFIX = "ata";
 constexpr const char *NVME_PORT_PATTERN = "nvme([0-9]+)";
 constexpr const char *NVME_PREFIX = "nvme";
@@ -94,6 +97,155 @@ bool MatchInternalDataDiskPattern(const std::string &realPath)
 }
 } // namespace
 
+namespace {
+constexpr size_t SYSFS_NODE_MAX_SIZE = 4096;
+constexpr int SYSFS_MAX_PARENT_DEPTH = 32;
+constexpr const char *PARENT_DIR = "..";
+constexpr const char *SNAPSHOT_NODES[] = { SIZE_NODE, REMOVABLE_NODE, VENDOR_NODE, MODEL_NODE, ROTATIONAL_NODE,
+    DEV_NODE, UEVENT_NODE, SERIAL_NODE, REVNUM_NODE };
+constexpr const char *INHERITED_NODES[] = { DEVNUM_NODE, BUSNUM_NODE };
+
+std::string TrimSpaces(const std::string &str)
+{
+    auto first = std::find_if(str.begin(), str.end(), [](unsigned char c) {
+        return !std::isspace(c);
+    });
+    auto last = std::find_if(str.rbegin(), str.rend(), [](unsigned char c) {
+        return !std::isspace(c);
+    });
+    if (first == str.end()) {
+        return "";
+    }
+    return std::string(first, last.base());
+}
+
+// Nodes are named like the *_NODE constants, with a leading '/', and opened relative to a directory fd.
+const char *RelativeNode(const std::string &node)
+{
+    return node.c_str() + (node.empty() || node[0] != '/' ? 0 : 1);
+}
+} // namespace
+
+bool SysfsDeviceSnapshot::Load(const std::string &sysBlockPath, const std::string &deviceName)
+{
+    arena_.clear();
+    nodes_.clear();
+    inherited_.clear();
+    std::string devicePath = sysBlockPath + SPLIT_STRING + deviceName;
+    char linkTarget[PATH_MAX] = {0};
+    ssize_t len = readlink(devicePath.c_str(), linkTarget, sizeof(linkTarget) - 1);
+    hasLink_ = len >= 0;
+    linkTarget_.assign(linkTarget, hasLink_ ? static_cast<size_t>(len) : 0);
+
+    int devFd = open(devicePath.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (devFd < 0) {
+        LOGE("[L2:ScanDevice] SysfsDeviceSnapshot: open %{public}s failed, errno=%{public}d", devicePath.c_str(),
+             errno);
+        return false;
+    }
+    arena_.reserve(SYSFS_NODE_MAX_SIZE);
+    for (const char *node : SNAPSHOT_NODES) {
+        Span span;
+        if (ReadAt(devFd, RelativeNode(node), span)) {
+            nodes_[node] = span;
+        }
+    }
+    WalkParents(devFd);
+    (void)close(devFd);
+    return true;
+}
+
+bool SysfsDeviceSnapshot::ReadAt(int dirFd, const std::string &name, Span &span)
+{
+    int fd = openat(dirFd, name.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    span.offset = arena_.size();
+    arena_.resize(span.offset + SYSFS_NODE_MAX_SIZE);
+    ssize_t len = TEMP_FAILURE_RETRY(pread(fd, &arena_[span.offset], SYSFS_NODE_MAX_SIZE, 0));
+    (void)close(fd);
+    span.len = len > 0 ? static_cast<size_t>(len) : 0;
+    arena_.resize(span.offset + span.len);
+    return len >= 0;
+}
+
+// Walks from the device directory up to the root with "..", taking the first copy of each inherited node.
+void SysfsDeviceSnapshot::WalkParents(int devFd)
+{
+    int curFd = dup(devFd);
+    struct stat cur;
+    if (curFd < 0 || fstat(curFd, &cur) != 0) {
+        if (curFd >= 0) {
+            (void)close(curFd);
+        }
+        return;
+    }
+    for (int depth = 0; depth < SYSFS_MAX_PARENT_DEPTH; depth++) {
+        for (const char *node : INHERITED_NODES) {
+            Span span;
+            if (inherited_.count(node) == 0 && ReadAt(curFd, RelativeNode(node), span) && span.len > 0 &&
+                arena_.compare(span.offset, span.len, "\n") != 0) {
+                inherited_[node] = span;
+            }
+        }
+        if (inherited_.size() == std::size(INHERITED_NODES)) {
+            break;
+        }
+        int parentFd = openat(curFd, PARENT_DIR, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        struct stat parent;
+        if (parentFd < 0 || fstat(parentFd, &parent) != 0 ||
+            (parent.st_dev == cur.st_dev && parent.st_ino == cur.st_ino)) {
+            if (parentFd >= 0) {
+                (void)close(parentFd);
+            }
+            break;
+        }
+        (void)close(curFd);
+        curFd = parentFd;
+        cur = parent;
+    }
+    (void)close(curFd);
+}
+
+bool SysfsDeviceSnapshot::ReadNode(const std::string &node, std::string &content) const
+{
+    auto it = nodes_.find(node);
+    if (it == nodes_.end() || it->second.len == 0) {
+        content = "";
+        return false;
+    }
+    std::string raw = arena_.substr(it->second.offset, it->second.len);
+    content = TrimSpaces(raw.substr(0, raw.find('\n')));
+    return true;
+}
+
+std::string SysfsDeviceSnapshot::ReadContent(const std::string &node) const
+{
+    auto it = nodes_.find(node);
+    if (it == nodes_.end()) {
+        return "";
+    }
+    std::string content = arena_.substr(it->second.offset, it->second.len);
+    if (!content.empty() && content.back() == '\n') {
+        content.pop_back();
+    }
+    return content;
+}
+
+std::string SysfsDeviceSnapshot::ReadInherited(const std::string &node) const
+{
+    auto it = inherited_.find(node);
+    if (it == inherited_.end()) {
+        return "";
+    }
+    std::string content = arena_.substr(it->second.offset, it->second.len);
+    if (!content.empty() && content.back() == '\n') {
+        content.pop_back();
+    }
+    return content;
+}
+
 ScanDevice::ScanDevice(const std::string &sysBlockPath, const std::string &devBlockPath)
     : sysBlockPath(sysBlockPath), devBlockPath(DEV_PATH)
 {
@@ -101,12 +253,23 @@ ScanDevice::ScanDevice(const std::string &sysBlockPath, const std::string &devBl
 
 using json = nlohmann::json;
 
+SysfsDeviceSnapshot ScanDevice::LoadSnapshot(const std::string &deviceName)
+{
+    SysfsDeviceSnapshot snapshot;
+    (void)snapshot.Load(sysBlockPath, deviceName);
+    return snapshot;
+}
+
 bool ScanDevice::ReadRemovableNode(const std::string &deviceName, bool &isRemovable)
 {
-    std::string removablePath = sysBlockPath + SPLIT_STRING + deviceName + REMOVABLE_NODE;
+    return ReadRemovableNode(LoadSnapshot(deviceName), isRemovable);
+}
+
+bool ScanDevice::ReadRemovableNode(const SysfsDeviceSnapshot &snapshot, bool &isRemovable)
+{
     std::string content;
-    if (ReadSysfsNode(removablePath, content)) {
-        LOGI("Read %{public}s success: %{public}s", removablePath.c_str(), content.c_str());
+    if (snapshot.ReadNode(REMOVABLE_NODE, content)) {
+        LOGI("Read removable success: %{public}s", content.c_str());
         if (content == ONE_STRING) {
             isRemovable = true;
             return true;
@@ -121,16 +284,19 @@ bool ScanDevice::ReadRemovableNode(const std::string &deviceName, bool &isRemova
 }
 
 bool ScanDevice::IsDataDisk(const std::string &deviceName, const bool isNeedCheckUfs, const bool isRemovable)
+{
+    return IsDataDisk(LoadSnapshot(deviceName), deviceName, isNeedCheckUfs, isRemovable);
+}
+
+bool ScanDevice::IsDataDisk(const SysfsDeviceSnapshot &snapshot, const std::string &deviceName,
+    const bool isNeedCheckUfs, const bool isRemovable)
 {
     if (!isNeedCheckUfs) {
         return !isRemovable && (deviceName.find(SD_STRING) == 0);
     }
     std::string devicePath = sysBlockPath + SPLIT_STRING + deviceName;
-    char linkTarget[PATH_MAX];
-    ssize_t len = readlink(devicePath.c_str(), linkTarget, sizeof(linkTarget) - 1);
-    if (len != -1) {
-        linkTarget[len] = '\0';
-        std::string targetPath(linkTarget);
+    if (snapshot.HasLink()) {
+        const std::string &targetPath = snapshot.LinkTarget();
         if (targetPath.find(UFS_STRING) == std::string::npos) {
             LOGI("%{public}s isn't ufs: %{public}s", devicePath.c_str(), targetPath.c_str());
             return true;
@@ -198,22 +364,23 @@ std::vector<BlockInfo> ScanDevice::GetDataDisks()
         if (isNvmeDevice && !IsValidNvmeDevice(deviceName)) {
             continue;
         }
+        SysfsDeviceSnapshot snapshot = LoadSnapshot(deviceName);
         bool isRemovable = false;
         bool isNeedCheckUfs = false;
-        if (!ReadRemovableNode(deviceName, isRemovable)) {
+        if (!ReadRemovableNode(snapshot, isRemovable)) {
             LOGE("Read removable node failed");
             isNeedCheckUfs = true;
         }
-        if (isSDevice && !IsDataDisk(deviceName, isNeedCheckUfs, isRemovable)) {
+        if (isSDevice && !IsDataDisk(snapshot, deviceName, isNeedCheckUfs, isRemovable)) {
             continue;
         }
-        if (!MatchInternalDataDiskPattern(GetRealPath(deviceName))) {
+        if (!MatchInternalDataDiskPattern(GetRealPath(snapshot, deviceName))) {
             LOGE("Ignore non-internal data disk: %{public}s", deviceName.c_str());
             continue;
         }
         BlockInfo blockInfo;
         blockInfo.removable = isRemovable;
-        if (GetBlockInfo(deviceName, isNvmeDevice, blockInfo) == 0) {
+        if (GetBlockInfo(snapshot, deviceName, isNvmeDevice, blockInfo) == 0) {
             dataDisks.push_back(blockInfo);
         }
     }
@@ -221,16 +388,13 @@ std::vector<BlockInfo> ScanDevice::GetDataDisks()
     return dataDisks;
 }
 
-std::string ScanDevice::GetRealPath(const std::string &deviceName)
+std::string ScanDevice::GetRealPath(const SysfsDeviceSnapshot &snapshot, const std::string &deviceName)
 {
     std::string modelPath = sysBlockPath + SPLIT_STRING + deviceName;
     LOGI("GetRealPath modelPath: %{public}s", modelPath.c_str());
-    char linkTarget[PATH_MAX] = {0};
-    ssize_t len = readlink(modelPath.c_str(), linkTarget, sizeof(linkTarget) - 1);
-    std::string linkTargetStr;
-    LOGI("linkTarget is %{public}s", linkTarget);
-    if (len > 0) {
-        linkTargetStr.assign(linkTarget, len);
+    std::string linkTargetStr = snapshot.LinkTarget();
+    LOGI("linkTarget is %{public}s", linkTargetStr.c_str());
+    if (!linkTargetStr.empty()) {
         if (linkTargetStr.rfind("/sys/", 0) == 0) {
             LOGI("GetRealPath linkTargetStr: %{public}s", linkTargetStr.c_str());
             return linkTargetStr;
@@ -241,9 +405,8 @@ std::string ScanDevice::GetRealPath(const std::string &deviceName)
             LOGI("GetRealPath linkTargetStr: %{public}s", linkTargetStr.c_str());
             return linkTargetStr;
         }
-    } else if (len == -1) {
+    } else if (!snapshot.HasLink()) {
         LOGE("readlink failed for: %s", modelPath.c_str());
-        linkTargetStr.clear();
     }
     return "";
 }
@@ -257,16 +420,17 @@ std::vector<BlockInfo> ScanDevice::GetExternalDisks(const std::string &devName,
     uint64_t size = -1;
     std::string devPath = std::string(DEV_PATH) + SPLIT_STRING + devName;
     std::string sizePath = devBlockPath + SPLIT_STRING + diskId;
-    std::string realPath = GetRealPath(devName);
+    SysfsDeviceSnapshot snapshot = LoadSnapshot(devName);
+    std::string realPath = GetRealPath(snapshot, devName);
     GetExternalDiskSize(sizePath, &size);
     info.sizeBytes = size;
-    info.vendor = GetVendor(devName);
-    info.model = GetModel(devName);
-    info.devnum = ReadFileInParentDirs(realPath, "devnum");
-    info.busnum = ReadFileInParentDirs(realPath, "busnum");
+    info.vendor = GetVendor(snapshot);
+    info.model = GetModel(snapshot);
+    info.devnum = snapshot.ReadInherited(DEVNUM_NODE);
+    info.busnum = snapshot.ReadInherited(BUSNUM_NODE);
     info.devNode = GetDevNode(devName);
     info.scsiBusNum = GetScsiBusNum(realPath);
-    info.fwVersion = GetFwVersion(devName);
+    info.fwVersion = GetFwVersion(snapshot);
     struct stat st;
     if (stat(devPath.c_str(), &st) == 0 && S_ISBLK(st.st_mode)) {
         dev_t dev = st.st_rdev;
@@ -514,17 +678,23 @@ bool ScanDevice::GetExternalDiskSize(const std::string &path, uint64_t *size)
 }
 
 int ScanDevice::GetBlockInfo(const std::string &deviceName, const bool isNvmeDevice, BlockInfo &blockInfo)
+{
+    return GetBlockInfo(LoadSnapshot(deviceName), deviceName, isNvmeDevice, blockInfo);
+}
+
+int ScanDevice::GetBlockInfo(const SysfsDeviceSnapshot &snapshot, const std::string &deviceName,
+    const bool isNvmeDevice, BlockInfo &blockInfo)
 {
     std::string devPath = std::string(DEV_PATH) + SPLIT_STRING + deviceName;
-    std::string realPath = GetRealPath(deviceName);
-    blockInfo.sizeBytes = GetDiskSize(deviceName);
-    blockInfo.vendor = GetVendor(deviceName);
-    blockInfo.model = GetModel(deviceName);
-    blockInfo.devnum = ReadFileInParentDirs(realPath, "devnum");
-    blockInfo.busnum = ReadFileInParentDirs(realPath, "busnum");
+    std::string realPath = GetRealPath(snapshot, deviceName);
+    blockInfo.sizeBytes = GetDiskSize(snapshot, deviceName);
+    blockInfo.vendor = GetVendor(snapshot);
+    blockInfo.model = GetModel(snapshot);
+    blockInfo.devnum = snapshot.ReadInherited(DEVNUM_NODE);
+    blockInfo.busnum = snapshot.ReadInherited(BUSNUM_NODE);
     blockInfo.devNode = GetDevNode(deviceName);
     blockInfo.scsiBusNum = GetScsiBusNum(realPath);
-    blockInfo.fwVersion = GetFwVersion(deviceName);
+    blockInfo.fwVersion = GetFwVersion(snapshot);
     struct stat st;
     if (stat(devPath.c_str(), &st) == 0 && S_ISBLK(st.st_mode)) {
         dev_t dev = st.st_rdev;
@@ -547,10 +717,10 @@ int ScanDevice::GetBlockInfo(const std::string &deviceName, const bool isNvmeDev
     }
     blockInfo.interfaceType = GetInterfaceType(deviceName);
     blockInfo.rpm = GetDiskRpm(deviceName, isNvmeDevice);
-    blockInfo.rotational = GetRotational(deviceName);
-    blockInfo.serialNumber = GetSerialNumber(deviceName, isNvmeDevice);
-    blockInfo.diskId = GetDiskId(deviceName, isNvmeDevice);
-    std::string pciePath = GetPciePath(deviceName);
+    blockInfo.rotational = GetRotational(snapshot);
+    blockInfo.serialNumber = GetSerialNumber(snapshot, deviceName, isNvmeDevice);
+    blockInfo.diskId = GetDiskId(snapshot, deviceName, isNvmeDevice);
+    std::string pciePath = GetPciePath(snapshot);
     blockInfo.devicePath = GetDevicePath(deviceName);
     blockInfo.port = GetPort(pciePath, isNvmeDevice);
     LOGE("[L2:ScanDevice] GetBlockInfo: info.devnum=%{public}s, info.busnum=%{public}s,"
@@ -560,22 +730,6 @@ int ScanDevice::GetBlockInfo(const std::string &deviceName, const bool isNvmeDev
     return 0;
 }
 
-namespace {
-std::string TrimSpaces(const std::string &str)
-{
-    auto first = std::find_if(str.begin(), str.end(), [](unsigned char c) {
-        return !std::isspace(c);
-    });
-    auto last = std::find_if(str.rbegin(), str.rend(), [](unsigned char c) {
-        return !std::isspace(c);
-    });
-    if (first == str.end()) {
-        return "";
-    }
-    return std::string(first, last.base());
-}
-} // namespace
-
 bool ScanDevice::ReadSysfsNode(const std::string &path, std::string &content)
 {
     char realPath[PATH_MAX] = {0};
@@ -625,9 +779,13 @@ bool ScanDevice::ParseStringToUlongLong(const std::string &str, unsigned long lo
 
 uint64_t ScanDevice::GetDiskSize(const std::string &deviceName)
 {
-    std::string sizePath = sysBlockPath + SPLIT_STRING + deviceName + SIZE_NODE;
+    return GetDiskSize(LoadSnapshot(deviceName), deviceName);
+}
+
+uint64_t ScanDevice::GetDiskSize(const SysfsDeviceSnapshot &snapshot, const std::string &deviceName)
+{
     std::string content;
-    if (!ReadSysfsNode(sizePath, content)) {
+    if (!snapshot.ReadNode(SIZE_NODE, content)) {
         LOGE("GetDiskSize failed: read node of disk size failed");
         return 0;
     }
@@ -652,9 +810,13 @@ uint64_t ScanDevice::GetDiskSize(const std::string &deviceName)
 
 std::string ScanDevice::GetVendor(const std::string &deviceName)
 {
-    std::string vendorPath = sysBlockPath + SPLIT_STRING + deviceName + VENDOR_NODE;
+    return GetVendor(LoadSnapshot(deviceName));
+}
+
+std::string ScanDevice::GetVendor(const SysfsDeviceSnapshot &snapshot)
+{
     std::string content;
-    if (ReadSysfsNode(vendorPath, content)) {
+    if (snapshot.ReadNode(VENDOR_NODE, content)) {
         LOGI("GetVendor success: %{public}s", content.c_str());
         return content;
     }
@@ -664,9 +826,13 @@ std::string ScanDevice::GetVendor(const std::string &deviceName)
 
 std::string ScanDevice::GetModel(const std::string &deviceName)
 {
-    std::string modelPath = sysBlockPath + SPLIT_STRING + deviceName + MODEL_NODE;
+    return GetModel(LoadSnapshot(deviceName));
+}
+
+std::string ScanDevice::GetModel(const SysfsDeviceSnapshot &snapshot)
+{
     std::string content;
-    if (ReadSysfsNode(modelPath, content)) {
+    if (snapshot.ReadNode(MODEL_NODE, content)) {
         LOGI("GetModel success: %{public}s", content.c_str());
         return content;
     }
@@ -712,9 +878,13 @@ uint32_t ScanDevice::GetDiskRpm(const std::string &deviceName, const bool isNvme
 
 int32_t ScanDevice::GetRotational(const std::string &deviceName)
 {
-    std::string rotationalPath = sysBlockPath + SPLIT_STRING + deviceName + ROTATIONAL_NODE;
+    return GetRotational(LoadSnapshot(deviceName));
+}
+
+int32_t ScanDevice::GetRotational(const SysfsDeviceSnapshot &snapshot)
+{
     std::string content;
-    if (ReadSysfsNode(rotationalPath, content)) {
+    if (snapshot.ReadNode(ROTATIONAL_NODE, content)) {
         LOGI("GetRotational content success: %{public}s", content.c_str());
         unsigned long long result = 0;
         if (ParseStringToUlongLong(content, result)) {
@@ -738,11 +908,10 @@ std::string ScanDevice::GetSataSerialNumber(int fd)
     return TrimSpaces(serial);
 }
 
-std::string ScanDevice::GetNvmeSerialNumber(const std::string &deviceName)
+std::string ScanDevice::GetNvmeSerialNumber(const SysfsDeviceSnapshot &snapshot, const std::string &deviceName)
 {
-    std::string serialPath = sysBlockPath + SPLIT_STRING + deviceName + SERIAL_NODE;
     std::string content;
-    if (ReadSysfsNode(serialPath, content)) {
+    if (snapshot.ReadNode(SERIAL_NODE, content)) {
         LOGI("GetNvmeSerialNumber success: %{public}s", content.c_str());
         return content;
     }
@@ -751,10 +920,16 @@ std::string ScanDevice::GetNvmeSerialNumber(const std::string &deviceName)
 }
 
 std::string ScanDevice::GetSerialNumber(const std::string &deviceName, const bool isNvmeDevice)
+{
+    return GetSerialNumber(LoadSnapshot(deviceName), deviceName, isNvmeDevice);
+}
+
+std::string ScanDevice::GetSerialNumber(const SysfsDeviceSnapshot &snapshot, const std::string &deviceName,
+    const bool isNvmeDevice)
 {
     std::string serial;
     if (isNvmeDevice) {
-        serial = GetNvmeSerialNumber(deviceName);
+        serial = GetNvmeSerialNumber(snapshot, deviceName);
     } else {
         std::string devicePath = devBlockPath + SPLIT_STRING + deviceName;
         int fd = open(devicePath.c_str(), O_RDONLY | O_NONBLOCK);
@@ -773,25 +948,20 @@ std::string ScanDevice::GetSerialNumber(const std::string &deviceName, const boo
     return serial;
 }
 
-std::string ScanDevice::GetPciePath(const std::string &deviceName)
+std::string ScanDevice::GetPciePath(const SysfsDeviceSnapshot &snapshot)
 {
-    std::string devicePath = sysBlockPath + SPLIT_STRING + deviceName;
-    char linkTarget[PATH_MAX];
-    ssize_t len = readlink(devicePath.c_str(), linkTarget, sizeof(linkTarget) - 1);
-    if (len > 0) {
-        linkTarget[len] = '\0';
-        LOGI("GetPciePath success: %{public}s", linkTarget);
-        return std::string(linkTarget);
+    if (!snapshot.LinkTarget().empty()) {
+        LOGI("GetPciePath success: %{public}s", snapshot.LinkTarget().c_str());
+        return snapshot.LinkTarget();
     }
     LOGE("GetPciePath failed");
     return "";
 }
 
-bool ScanDevice::ReadSataDeviceNumber(const std::string &deviceName, std::string &major, std::string &minor)
+bool ScanDevice::ReadSataDeviceNumber(const SysfsDeviceSnapshot &snapshot, std::string &major, std::string &minor)
 {
-    std::string devPath = sysBlockPath + SPLIT_STRING + deviceName + DEV_NODE;
     std::string content;
-    if (!ReadSysfsNode(devPath, content)) {
+    if (!snapshot.ReadNode(DEV_NODE, content)) {
         LOGE("ReadSataDeviceNumber failed: read dev node failed");
         return false;
     }
@@ -805,41 +975,41 @@ bool ScanDevice::ReadSataDeviceNumber(const std::string &deviceName, std::string
     return true;
 }
 
-bool ScanDevice::ReadNvmeDeviceNumber(const std::string &deviceName, std::string &major, std::string &minor)
+bool ScanDevice::ReadNvmeDeviceNumber(const SysfsDeviceSnapshot &snapshot, std::string &major, std::string &minor)
 {
-    std::string ueventPath = sysBlockPath + SPLIT_STRING + deviceName + UEVENT_NODE;
-    std::ifstream file(ueventPath);
-    if (!file.is_open()) {
-        LOGE("ReadNvmeDeviceNumber failed: open %{public}s failed", ueventPath.c_str());
-        return false;
-    }
+    std::stringstream uevent(snapshot.ReadContent(UEVENT_NODE));
     std::string line;
     major = "";
     minor = "";
-    while (std::getline(file, line)) {
+    while (std::getline(uevent, line)) {
         if (line.find(MAJOR_KEY) == 0) {
             major = line.substr(strlen(MAJOR_KEY));
         } else if (line.find(MINOR_KEY) == 0) {
             minor = line.substr(strlen(MINOR_KEY));
         }
     }
-    file.close();
     if (major.empty() || minor.empty()) {
-        LOGE("ReadNvmeDeviceNumber failed: MAJOR or MINOR not found in %{public}s", ueventPath.c_str());
+        LOGE("ReadNvmeDeviceNumber failed: MAJOR or MINOR not found in uevent");
         return false;
     }
     return true;
 }
 
 std::string ScanDevice::GetDiskId(const std::string &deviceName, const bool isNvmeDevice)
+{
+    return GetDiskId(LoadSnapshot(deviceName), deviceName, isNvmeDevice);
+}
+
+std::string ScanDevice::GetDiskId(const SysfsDeviceSnapshot &snapshot, const std::string &deviceName,
+    const bool isNvmeDevice)
 {
     std::string major;
     std::string minor;
     bool success = false;
     if (isNvmeDevice) {
-        success = ReadNvmeDeviceNumber(deviceName, major, minor);
+        success = ReadNvmeDeviceNumber(snapshot, major, minor);
     } else {
-        success = ReadSataDeviceNumber(deviceName, major, minor);
+        success = ReadSataDeviceNumber(snapshot, major, minor);
     }
     if (!success) {
         LOGE("GetDiskId failed: read device number failed for %{public}s", deviceName.c_str());
@@ -876,39 +1046,6 @@ std::string ScanDevice::GetPort(const std::string &pciePath, const bool isNvmeDe
     return "";
 }
 
-std::string ScanDevice::ReadFileContent(const std::string &path)
-{
-    LOGD("[L8:ScanDevice] ReadFileContent: >>> ENTER <<< path=%{public}s", path.c_str());
-    std::ifstream infile;
-    std::string result;
-    char realPath[PATH_MAX] = {0};
-    if (realpath(path.c_str(), realPath) == nullptr) {
-        LOGE("[L8:ScanDevice] ReadFileContent: <<< EXIT FAILED <<< realpath failed, errno: %{public}d.", errno);
-        return "";
-    }
-    infile.open(realPath);
-    if (!infile) {
-        LOGE("[L8:ScanDevice] ReadFileContent: <<< EXIT FAILED <<< Cannot open file, errno: %{public}d.", errno);
-        return "";
-    }
-    std::string line;
-    bool firstLine = true;
-    while (std::getline(infile, line)) {
-        if (!firstLine) {
-            result += "\n";
-        }
-        result += line;
-        firstLine = false;
-    }
-    infile.close();
-    if (result.empty()) {
-        LOGE("[L8:ScanDevice] ReadFileContent: <<< EXIT FAILED <<< file is empty");
-    } else {
-        LOGD("[L8:ScanDevice] ReadFileContent: <<< EXIT SUCCESS <<<");
-    }
-    return result;
-}
-
 std::string ScanDevice::GetDevnum(const std::string &deviceName)
 {
     std::string modelPath = sysBlockPath + SPLIT_STRING + deviceName;
@@ -973,10 +1110,9 @@ std::string ScanDevice::GetDevNode(const std::string &deviceName)
     return devNode;
 }
 
-std::string ScanDevice::GetFwVersion(const std::string &deviceName)
+std::string ScanDevice::GetFwVersion(const SysfsDeviceSnapshot &snapshot)
 {
-    std::string modelPath = sysBlockPath + SPLIT_STRING + deviceName + REVNUM_NODE;
-    std::string content = ReadFileContent(modelPath);
+    std::string content = snapshot.ReadContent(REVNUM_NODE);
     LOGI("GetFwVersion content: %{public}s", content.c_str());
     return content;
 }
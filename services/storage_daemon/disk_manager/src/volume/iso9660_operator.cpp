@@ -15,13 +15,20 @@
 
 #include "disk_manager/volume/iso9660_operator.h"
 #include "storage_service_log.h"
+#include "disk_manager/disk/burn_verifier.h"
+#include "disk_manager/disk/iso_image_builder.h"
 #include "utils/disk_utils.h"
 #include "disk_manager/disk/disk_utils.h"
 #include "utils/file_utils.h"
+#include "utils/op_progress.h"
 #include "utils/string_utils.h"
 
 #include <cerrno>
+#include <cstdlib>
+#include <fcntl.h>
 #include <sys/mount.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
 #include <map>
 #include <sstream>
 #include <vector>
@@ -31,7 +38,6 @@ namespace StorageDaemon {
 constexpr int UID_FILE_MANAGER = 1006;
 constexpr const char* MNT_EXTERNAL_FILE_CONTEXT = "context=u:object_r:mnt_external_file:s0";
 constexpr const char* IO_CHAR_SET = "utf8";
-constexpr const char* MID_PATH = "/data/local/burn_tmp/midFile.iso";
 constexpr const char* BURN_TMP_DIR = "/data/local/burn_tmp";
 constexpr const char* VERIFY_MOUNT_PATH = "/mnt/data/burn_verify_mount";
 constexpr int32_t E_VERIFY_BURN_DATA_FAILED = 13600030;
@@ -129,15 +135,27 @@ int32_t IsoOperator::CreateIsoImage(const std::string &devPath,
     if (res != E_OK) {
         LOGE("IsoOperator CreateIsoImage: CleanTempDirectory entry failed, non-critical, res=%{public}d", res);
     }
-    std::vector<std::string> output;
-    std::vector<std::string> cmd = {"genisoimage", "-V", "ISOIMAGE", "-J", "-r", "-D", "-joliet-long",
-                                    "-input-charset", "utf-8", "-output-charset", "utf-8", "-o", filePath, mountPath};
-
-    int32_t err = ForkExec(cmd, &output);
-    for (const auto& s : output) {
-        LOGI("IsoOperator CreateIsoImage:s=%{public}s", s.c_str());
+    // Built in process straight into filePath: no genisoimage child and no staging copy of the image.
+    OpProgressScope progressScope(OpProgressRegistry::GetOpId(devPath), OpPhase::BUILDING_IMAGE);
+    IsoImageBuilder builder;
+    int32_t err = builder.Scan(mountPath);
+    if (err != E_OK) {
+        LOGE("IsoOperator CreateIsoImage:<<< EXIT FAILED <<< scan failed for devPath: %{public}s", devPath.c_str());
+        return err;
+    }
+    int fd = open(filePath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+    if (fd < 0) {
+        LOGE("IsoOperator CreateIsoImage:<<< EXIT FAILED <<< open image failed, errno=%{public}d", errno);
+        return E_ERR;
     }
+    err = builder.WriteTo(fd);
+    if (fsync(fd) != 0 && err == E_OK) {
+        LOGE("IsoOperator CreateIsoImage: fsync failed, errno=%{public}d", errno);
+        err = E_ERR;
+    }
+    (void)close(fd);
     if (err != E_OK) {
+        (void)unlink(filePath.c_str());
         LOGE("IsoOperator CreateIsoImage:<<< EXIT FAILED <<< failed for devPath: %{public}s", devPath.c_str());
         return err;
     }
@@ -149,51 +167,63 @@ int32_t IsoOperator::CreateIsoImage(const std::string &devPath,
     return E_OK;
 }
 
-int32_t IsoOperator::PrepareIsoImage(const std::string &devPath,
-                                     const BurnOptions &burnOptions,
-                                     bool isDiskEmpty,
-                                     const std::string &incBurnAddr)
+// Streams the image builder lays out into fd, the stdin of the burner.
+static int32_t FeedBuiltImage(IsoImageBuilder &builder, int fd, BurnManifestRecorder &recorder)
 {
-    LOGI("PrepareIsoImage: >>> ENTER <<< devPath=%{public}s", devPath.c_str());
-    if (IsDir(BURN_TMP_DIR)) {
-        LOGI("PrepareIsoImage: burn_tmp directory exists, removing it");
-        RmDirRecurse(BURN_TMP_DIR);
-    }
-    int32_t err = MkDir(BURN_TMP_DIR, DEFAULT_DIR_PERMISSIONS);
-    if (err != 0) {
-        LOGE("PrepareIsoImage:<<< EXIT FAILED <<< Create burn_tmp directory failed for devPath: %{public}s",
-             devPath.c_str());
-        return E_ERR;
-    }
-    int32_t res = DiskUtils::CleanTempDirectory();
-    if (res != E_OK) {
-        LOGE("PrepareIsoImage: CleanTempDirectory failed, non-critical, res=%{public}d", res);
-    }
-    if (burnOptions.isIsoImage) {
-        LOGI("PrepareIsoImage: Using existing ISO image, skip generation");
-        return E_OK;
-    }
-    std::vector<std::string> cmd;
+    return builder.Stream([fd, &recorder](const uint8_t *data, size_t len) {
+        return BurnVerifier::FeedBurner(fd, data, len, recorder);
+    });
+}
+
+// Runs genisoimage with the session it builds on stdout and hands that on to fd, the stdin of the burner.
+static int32_t FeedSessionImage(const std::vector<std::string> &cmd, int fd, BurnManifestRecorder &recorder)
+{
+    int32_t feedErr = E_OK;
+    ChildRunOptions options;
+    options.outCap = 0;
+    options.onOutput = [fd, &recorder, &feedErr](const char *data, size_t len) {
+        if (feedErr == E_OK) {
+            feedErr = BurnVerifier::FeedBurner(fd, reinterpret_cast<const uint8_t *>(data), len, recorder);
+        }
+    };
+    ChildRunResult result;
+    int32_t err = RunChild(cmd, options, result);
+    if (err != E_OK || !WIFEXITED(result.status) || WEXITSTATUS(result.status) != 0) {
+        LOGE("FeedSessionImage: genisoimage failed, err=%{public}d, status=%{public}d, output=%{public}s", err,
+             result.status, result.err.c_str());
+        return err != E_OK ? err : E_ERR;
+    }
+    return feedErr;
+}
+
+// The size of the session genisoimage is going to build, in sectors, from its "-print-size" run.
+static int32_t GetSessionSectors(const std::vector<std::string> &sessionCmd, uint64_t &sectors)
+{
+    std::vector<std::string> cmd = sessionCmd;
+    cmd.insert(cmd.begin() + 1, { "-print-size", "-quiet" });
     std::vector<std::string> output;
-    if (isDiskEmpty) {
-        cmd = {"genisoimage", "-V", burnOptions.diskName, "-J", "-r", "-D", "-joliet-long",
-               "-input-charset", "utf-8", "-output-charset", "utf-8", "-o", MID_PATH, burnOptions.burnPath};
-    } else {
-        cmd = {"genisoimage", "-V", burnOptions.diskName, "-J", "-r", "-D", "-joliet-long",
-               "-input-charset", "utf-8", "-output-charset", "utf-8", "-C", incBurnAddr,
-               "-M", devPath, "-o", MID_PATH, burnOptions.burnPath};
-    }
-    err = ForkExec(cmd, &output);
+    int32_t err = ForkExec(cmd, &output);
     if (err != E_OK) {
         for (const auto& s : output) {
-            LOGI("IsoOperator PrepareIsoImage:s=%{public}s", s.c_str());
+            LOGI("IsoOperator GetSessionSectors:s=%{public}s", s.c_str());
         }
-        LOGE("PrepareIsoImage:<<< EXIT FAILED <<< genisoimage failed for devPath: %{public}s", devPath.c_str());
-        RmDirRecurse(BURN_TMP_DIR);
+        LOGE("GetSessionSectors: genisoimage -print-size failed, err=%{public}d", err);
         return err;
     }
-    LOGI("PrepareIsoImage:<<< EXIT SUCCESS <<< ISO image prepared");
-    return E_OK;
+    for (auto it = output.rbegin(); it != output.rend(); ++it) {
+        size_t end = it->find_last_of("0123456789");
+        if (end == std::string::npos) {
+            continue;
+        }
+        size_t begin = it->find_last_not_of("0123456789", end);
+        begin = begin == std::string::npos ? 0 : begin + 1;
+        sectors = std::strtoull(it->substr(begin, end + 1 - begin).c_str(), nullptr, 10);
+        if (sectors > 0) {
+            return E_OK;
+        }
+    }
+    LOGE("GetSessionSectors: no session size in genisoimage output");
+    return E_ERR;
 }
 
 int32_t IsoOperator::DoCDBurn(const std::string &devPath,
@@ -202,36 +232,72 @@ int32_t IsoOperator::DoCDBurn(const std::string &devPath,
                               const std::string &incBurnAddr)
 {
     LOGI("BurnDoCDBurn: >>> ENTER <<< devPath=%{public}s", devPath.c_str());
+    if (!burnOptions.burnPath.empty() && burnOptions.burnPath[0] == '-') {
+        LOGE("BurnDoCDBurn: burnPath starts with dash, possible argument injection");
+        return E_ERR;
+    }
     int32_t res = DiskUtils::CleanTempDirectory();
     if (res != E_OK) {
         LOGE("BurnDoCDBurn: CleanTempDirectory entry failed, non-critical, res=%{public}d", res);
     }
-    int32_t err = PrepareIsoImage(devPath, burnOptions, isDiskEmpty, incBurnAddr);
+    // An image file is burned as it is and digested afterwards. A directory goes to wodim through stdin,
+    // with the track size told up front: a blank disc gets the image built in process, an appendable one
+    // the session genisoimage writes to stdout, and the manifest digests are taken from the bytes wodim is fed.
+    IsoImageOptions imageOptions;
+    imageOptions.volumeId = burnOptions.diskName;
+    IsoImageBuilder builder(imageOptions);
+    uint64_t startLba = BurnVerifier::SessionStartLba(isDiskEmpty, incBurnAddr);
+    BurnManifestRecorder recorder(startLba);
+    std::vector<std::string> sessionCmd;
+    std::string trackSize;
+    ChildInputWriter writer;
+    int32_t err = E_OK;
+    if (!burnOptions.isIsoImage && isDiskEmpty) {
+        OpProgressScope progressScope(OpProgressRegistry::GetOpId(devPath), OpPhase::BUILDING_IMAGE);
+        err = builder.Scan(burnOptions.burnPath);
+        trackSize = "tsize=" + std::to_string(builder.GetImageSize());
+        writer = [&builder, &recorder](int fd) { return FeedBuiltImage(builder, fd, recorder); };
+    } else if (!burnOptions.isIsoImage) {
+        sessionCmd = {"genisoimage", "-V", burnOptions.diskName, "-J", "-r", "-D", "-joliet-long",
+                      "-input-charset", "utf-8", "-output-charset", "utf-8", "-C", incBurnAddr,
+                      "-M", devPath, burnOptions.burnPath};
+        uint64_t sectors = 0;
+        OpProgressScope progressScope(OpProgressRegistry::GetOpId(devPath), OpPhase::BUILDING_IMAGE);
+        err = GetSessionSectors(sessionCmd, sectors);
+        trackSize = "tsize=" + std::to_string(sectors) + "s";
+        writer = [&sessionCmd, &recorder](int fd) { return FeedSessionImage(sessionCmd, fd, recorder); };
+    }
     if (err != E_OK) {
-        LOGE("BurnDoCDBurn:<<< EXIT FAILED <<< PrepareIsoImage failed for devPath: %{public}s", devPath.c_str());
+        LOGE("BurnDoCDBurn:<<< EXIT FAILED <<< preparing the track failed for devPath: %{public}s", devPath.c_str());
         return err;
     }
     std::string speedOpt = "-speed=" + burnOptions.burnSpeed;
     std::vector<std::string> cmd;
     std::vector<std::string> output;
-    if (!burnOptions.isIsoImage) {
-        if (isDiskEmpty) {
-            cmd = {"wodim", "-v", "dev=" + devPath, "-multi", "-data", speedOpt, MID_PATH};
-        } else {
-            cmd = {"wodim", "-v", "dev=" + devPath, "-tao", "-multi", "-data", speedOpt, MID_PATH};
-        }
-    } else {
+    if (burnOptions.isIsoImage) {
         cmd = {"wodim", "-v", "dev=" + devPath, "-multi", "-data", speedOpt, burnOptions.burnPath};
+    } else if (isDiskEmpty) {
+        cmd = {"wodim", "-v", "dev=" + devPath, "-multi", "-data", speedOpt, trackSize, "-"};
+    } else {
+        cmd = {"wodim", "-v", "dev=" + devPath, "-tao", "-multi", "-data", speedOpt, trackSize, "-"};
     }
-    err = ForkExec(cmd, &output);
+    OpProgressScope progressScope(OpProgressRegistry::GetOpId(devPath), OpPhase::WRITING);
+    err = burnOptions.isIsoImage ? ForkExec(cmd, &output) : ForkExecWithInput(cmd, writer, &output);
     for (const auto& s : output) {
         LOGI("IsoOperator DoCDBurn:s=%{public}s", s.c_str());
     }
     if (err != E_OK) {
         LOGE("BurnDoCDBurn:<<< EXIT FAILED <<< wodim failed for devPath: %{public}s", devPath.c_str());
-        RmDirRecurse(BURN_TMP_DIR);
         return err;
     }
+    if (burnOptions.isIsoImage) {
+        res = BurnVerifier::RecordBurn(devPath, burnOptions.burnPath, startLba);
+    } else {
+        res = BurnVerifier::RecordBurn(devPath, recorder.Finish());
+    }
+    if (res != E_OK) {
+        LOGE("BurnDoCDBurn: RecordBurn failed, non-critical, res=%{public}d", res);
+    }
     res = DiskUtils::CleanTempDirectory();
     if (res != E_OK) {
         LOGE("BurnDoCDBurn: CleanTempDirectory exit failed, non-critical, res=%{public}d", res);
@@ -255,19 +321,37 @@ int32_t IsoOperator::DoDVDBurn(const std::string &devPath, const BurnOptions &bu
     std::string speedOpt = "-speed=" + burnOptions.burnSpeed;
     std::vector<std::string> cmd;
     std::vector<std::string> output;
-    if (!burnOptions.isIsoImage) {
-        if (isDiskEmpty) {
-            cmd = {"growisofs", speedOpt, "-Z", devPath,
-                   "-J", "-r", "-D", "-joliet-long", "-V", burnOptions.diskName, burnOptions.burnPath};
-        } else {
-            cmd = {"growisofs", speedOpt, "-M", devPath,
-                   "-J", "-r", "-D", "-joliet-long", "-V", burnOptions.diskName, burnOptions.burnPath};
+    // An image file is burned as it is and digested afterwards. One built in process goes in through stdin,
+    // so its digests are taken from the bytes written. Appending to a disc leaves building the session to
+    // growisofs, as it has to import the previous one, and leaves no manifest.
+    IsoImageOptions imageOptions;
+    imageOptions.volumeId = burnOptions.diskName;
+    IsoImageBuilder builder(imageOptions);
+    if (!burnOptions.isIsoImage && isDiskEmpty) {
+        OpProgressScope progressScope(OpProgressRegistry::GetOpId(devPath), OpPhase::BUILDING_IMAGE);
+        err = builder.Scan(burnOptions.burnPath);
+        if (err != E_OK) {
+            LOGE("BurnDoDVDBurn:<<< EXIT FAILED <<< scan failed for devPath: %{public}s", devPath.c_str());
+            return err;
         }
+    }
+    if (burnOptions.isIsoImage) {
+        cmd = {"growisofs", speedOpt, "-Z", devPath + "=" + burnOptions.burnPath};
+    } else if (isDiskEmpty) {
+        cmd = {"growisofs", speedOpt, "-Z", devPath + "=/dev/fd/0"};
+    } else {
+        cmd = {"growisofs", speedOpt, "-M", devPath,
+               "-J", "-r", "-D", "-joliet-long", "-V", burnOptions.diskName, burnOptions.burnPath};
+    }
+    BurnManifestRecorder recorder(0);
+    OpProgressScope progressScope(OpProgressRegistry::GetOpId(devPath), OpPhase::WRITING);
+    if (!burnOptions.isIsoImage && isDiskEmpty) {
+        err = ForkExecWithInput(cmd, [&builder, &recorder](int fd) {
+            return FeedBuiltImage(builder, fd, recorder);
+        }, &output);
     } else {
-        std::string isoBurnPath = devPath + "=" + burnOptions.burnPath;
-        cmd = {"growisofs", speedOpt, "-Z", isoBurnPath};
+        err = ForkExec(cmd, &output);
     }
-    err = ForkExec(cmd, &output);
     for (const auto& s : output) {
         LOGI("IsoOperator DoDVDBurn:s=%{public}s", s.c_str());
     }
@@ -275,6 +359,16 @@ int32_t IsoOperator::DoDVDBurn(const std::string &devPath, const BurnOptions &bu
         LOGE("BurnDoDVDBurn:<<< EXIT FAILED <<< failed for devPath: %{public}s", devPath.c_str());
         return err;
     }
+    if (burnOptions.isIsoImage || isDiskEmpty) {
+        res = burnOptions.isIsoImage ? BurnVerifier::RecordBurn(devPath, burnOptions.burnPath, 0) :
+            BurnVerifier::RecordBurn(devPath, recorder.Finish());
+        if (res != E_OK) {
+            LOGE("BurnDoDVDBurn: RecordBurn failed, non-critical, res=%{public}d", res);
+        }
+    } else {
+        // growisofs builds the session on the fly, there is no image to take extent digests from.
+        BurnVerifier::DropManifest(devPath);
+    }
     res = DiskUtils::CleanTempDirectory();
     if (res != E_OK) {
         LOGE("BurnDoDVDBurn: CleanTempDirectory exit failed, non-critical, res=%{public}d", res);
@@ -587,8 +681,8 @@ int32_t IsoOperator::GenerateAndCompareChecksums(const std::string& sourceDir,
         LOGE("DoVerifyBurnData: read disc checksum file failed");
         return E_ERR;
     }
-    std::map<std::string, std::string> sourceMap = DiskUtils::ParseChecksumFile(sourceChecksumContent, sourceDir);
-    std::map<std::string, std::string> discMap = DiskUtils::ParseChecksumFile(discChecksumContent, VERIFY_MOUNT_PATH);
+    ChecksumIndex sourceMap = DiskUtils::ParseChecksumFile(sourceChecksumContent, sourceDir);
+    ChecksumIndex discMap = DiskUtils::ParseChecksumFile(discChecksumContent, VERIFY_MOUNT_PATH);
     LOGI("LogChecksumMap: sourceMap contents:");
     for (const auto& pair : sourceMap) {
         LOGI("LogChecksumMap:   [%{public}s] = [%{public}s]",
@@ -622,15 +716,7 @@ int32_t IsoOperator::DoVerifyBurnData(const std::string &devPath, const BurnOpti
         RmDirRecurse(VERIFY_MOUNT_PATH);
         return err;
     }
-    std::string sourceDir;
-    err = PrepareSourceDirectory(burnOptions, sourceDir);
-    if (err != E_OK) {
-        Unmount(VERIFY_MOUNT_PATH, "iso9660", false);
-        RmDirRecurse(VERIFY_MOUNT_PATH);
-        return err;
-    }
-    std::string sourceChecksumPath = std::string(BURN_TMP_DIR) + "/source_checksums.txt";
-    std::string discChecksumPath = std::string(BURN_TMP_DIR) + "/disc_checksums.txt";
+    // The burn stages nothing, burn_tmp only holds what verifying extracts and the checksum lists.
     if (!IsDir(BURN_TMP_DIR)) {
         LOGI("DoVerifyBurnData: burn_tmp not dir, recreating");
         RmDirRecurse(BURN_TMP_DIR);
@@ -642,6 +728,15 @@ int32_t IsoOperator::DoVerifyBurnData(const std::string &devPath, const BurnOpti
             return E_ERR;
         }
     }
+    std::string sourceDir;
+    err = PrepareSourceDirectory(burnOptions, sourceDir);
+    if (err != E_OK) {
+        Unmount(VERIFY_MOUNT_PATH, "iso9660", false);
+        RmDirRecurse(VERIFY_MOUNT_PATH);
+        return err;
+    }
+    std::string sourceChecksumPath = std::string(BURN_TMP_DIR) + "/source_checksums.txt";
+    std::string discChecksumPath = std::string(BURN_TMP_DIR) + "/disc_checksums.txt";
     LOGI("DoVerifyBurnData: BURN_TMP_DIR=%{public}s, sourceChecksumPath=%{public}s",
          BURN_TMP_DIR, sourceChecksumPath.c_str());
     err = GenerateAndCompareChecksums(sourceDir, sourceChecksumPath, discChecksumPath);
@@ -15,9 +15,11 @@
 
 #include "disk_manager/volume/udf_operator.h"
 #include "storage_service_log.h"
+#include "disk_manager/disk/burn_verifier.h"
 #include "disk_manager/disk/disk_utils.h"
 #include "utils/disk_utils.h"
 #include "utils/file_utils.h"
+#include "utils/op_progress.h"
 #include "utils/string_utils.h"
 
 #include <cerrno>
@@ -133,6 +135,7 @@ int32_t UdfOperator::CreateIsoImage(const std::string& devPath,
     std::vector<std::string> output;
     std::vector<std::string> cmd = {"genisoimage", "-V", "ISOIMAGE", "-udf", "-J", "-r", "-D", "-joliet-long",
                                     "-input-charset", "utf-8", "-output-charset",  "utf-8", "-o", filePath, mountPath};
+    OpProgressScope progressScope(OpProgressRegistry::GetOpId(devPath), OpPhase::BUILDING_IMAGE);
     int32_t err = ForkExec(cmd, &output);
     for (const auto& s : output) {
         LOGI("UdfOperator CreateIsoImage:s=%{public}s", s.c_str());
@@ -183,6 +186,7 @@ int32_t UdfOperator::PrepareIsoImage(const std::string &devPath,
                "-input-charset", "utf-8", "-output-charset", "utf-8",
                "-C", incBurnAddr, "-M", devPath, "-o", MID_PATH, burnOptions.burnPath};
     }
+    OpProgressScope progressScope(OpProgressRegistry::GetOpId(devPath), OpPhase::BUILDING_IMAGE);
     err = ForkExec(cmd, &output);
     for (const auto& s : output) {
         LOGI("UdfOperator PrepareIsoImage:s=%{public}s", s.c_str());
@@ -224,6 +228,7 @@ int32_t UdfOperator::DoCDBurn(const std::string &devPath,
         cmd = {"wodim", "-v", "dev=" + devPath,
                "-multi", "-data", speedOpt, burnOptions.burnPath};
     }
+    OpProgressScope progressScope(OpProgressRegistry::GetOpId(devPath), OpPhase::WRITING);
     err = ForkExec(cmd, &output);
     for (const auto& s : output) {
         LOGI("UdfOperator DoCDBurn:s=%{public}s", s.c_str());
@@ -233,6 +238,11 @@ int32_t UdfOperator::DoCDBurn(const std::string &devPath,
         RmDirRecurse(BURN_TMP_DIR);
         return err;
     }
+    std::string imagePath = burnOptions.isIsoImage ? burnOptions.burnPath : MID_PATH;
+    res = BurnVerifier::RecordBurn(devPath, imagePath, BurnVerifier::SessionStartLba(isDiskEmpty, incBurnAddr));
+    if (res != E_OK) {
+        LOGE("DoCDBurn: RecordBurn failed, non-critical, res=%{public}d", res);
+    }
     res = DiskUtils::CleanTempDirectory();
     if (res != E_OK) {
         LOGE("DoCDBurn: CleanTempDirectory exit failed, non-critical, res=%{public}d", res);
@@ -265,6 +275,7 @@ int32_t UdfOperator::DoDVDBurn(const std::string &devPath, const BurnOptions &bu
         std::string isoBurnPath = devPath + "=" + burnOptions.burnPath;
         cmd = {"growisofs", speedOpt, "-allow-limited-size", "-Z", isoBurnPath};
     }
+    OpProgressScope progressScope(OpProgressRegistry::GetOpId(devPath), OpPhase::WRITING);
     err = ForkExec(cmd, &output);
     for (const auto& s : output) {
         LOGI("UdfOperator DoDVDBurn:s=%{public}s", s.c_str());
@@ -273,6 +284,15 @@ int32_t UdfOperator::DoDVDBurn(const std::string &devPath, const BurnOptions &bu
         LOGE("DoDVDBurn:<<< EXIT FAILED <<< failed for devPath: %{public}s", devPath.c_str());
         return err;
     }
+    if (burnOptions.isIsoImage) {
+        res = BurnVerifier::RecordBurn(devPath, burnOptions.burnPath, 0);
+        if (res != E_OK) {
+            LOGE("DoDVDBurn: RecordBurn failed, non-critical, res=%{public}d", res);
+        }
+    } else {
+        // growisofs builds the session on the fly, there is no image to take extent digests from.
+        BurnVerifier::DropManifest(devPath);
+    }
  
     res = DiskUtils::CleanTempDirectory();
     if (res != E_OK) {
@@ -495,8 +515,8 @@ int32_t UdfOperator::GenerateAndCompareChecksums(const std::string& sourceDir,
         LOGE("DoVerifyBurnData: read disc checksum file failed");
         return E_ERR;
     }
-    std::map<std::string, std::string> sourceMap = DiskUtils::ParseChecksumFile(sourceChecksumContent, sourceDir);
-    std::map<std::string, std::string> discMap = DiskUtils::ParseChecksumFile(discChecksumContent, VERIFY_MOUNT_PATH);
+    ChecksumIndex sourceMap = DiskUtils::ParseChecksumFile(sourceChecksumContent, sourceDir);
+    ChecksumIndex discMap = DiskUtils::ParseChecksumFile(discChecksumContent, VERIFY_MOUNT_PATH);
     LOGI("LogChecksumMap: sourceMap contents:");
     for (const auto& pair : sourceMap) {
         LOGI("LogChecksumMap:   [%{public}s] = [%{public}s]",
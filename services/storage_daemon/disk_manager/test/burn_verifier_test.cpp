@@ -0,0 +1,217 @@
+/*
+ * Copyright (c) 2026 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <fstream>
+#include <gtest/gtest.h>
+#include <sys/stat.h>
+
+#include "disk_manager/disk/burn_verifier.h"
+#include "storage_service_errno.h"
+#include "utils/file_utils.h"
+
+namespace OHOS {
+namespace StorageDaemon {
+using namespace testing::ext;
+
+namespace {
+const std::string TEST_ROOT = "/data/local/tmp/burn_verifier_test";
+const std::string IMAGE_PATH = TEST_ROOT + "/image.iso";
+const std::string DEVICE_PATH = TEST_ROOT + "/device.img";
+const std::string MANIFEST_PATH = TEST_ROOT + "/device.manifest";
+const std::string PROGRESS_PATH = TEST_ROOT + "/percent";
+constexpr uint64_t START_LBA = 37;
+constexpr size_t SECTOR_SIZE = 2048;
+constexpr size_t IMAGE_SIZE = 5 * 1024 * 1024 + 777;
+constexpr size_t PERF_IMAGE_SIZE = 64 * 1024 * 1024;
+constexpr size_t CORRUPT_OFFSET = 3 * 1024 * 1024 + 5;
+
+std::string MakeImage(size_t size)
+{
+    std::string data(size, '\0');
+    uint32_t seed = 2463534242U;
+    for (auto &c : data) {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        c = static_cast<char>(seed);
+    }
+    return data;
+}
+
+void WriteTestFile(const std::string &path, const std::string &content)
+{
+    std::ofstream file(path, std::ios::out | std::ios::trunc | std::ios::binary);
+    file << content;
+}
+
+// The "disc": padding up to the session start, the image, then trailing run-out sectors.
+void WriteDevice(const std::string &image)
+{
+    std::string padding(START_LBA * SECTOR_SIZE, 'p');
+    WriteTestFile(DEVICE_PATH, padding + image + std::string(SECTOR_SIZE * 2, '\0'));
+}
+} // namespace
+
+class BurnVerifierTest : public testing::Test {
+public:
+    void SetUp() override
+    {
+        RmDirRecurse(TEST_ROOT);
+        ASSERT_TRUE(MkDirRecurse(TEST_ROOT, S_IRWXU));
+    }
+    void TearDown() override
+    {
+        RmDirRecurse(TEST_ROOT);
+    }
+};
+
+/**
+ * @tc.name: BurnVerifier_Manifest_001
+ * @tc.desc: Verify a manifest survives a save/load round trip and bad manifests are rejected.
+ * @tc.type: FUNC
+ */
+HWTEST_F(BurnVerifierTest, BurnVerifier_Manifest_001, TestSize.Level1)
+{
+    GTEST_LOG_(INFO) << "BurnVerifier_Manifest_001 start";
+    WriteTestFile(IMAGE_PATH, MakeImage(IMAGE_SIZE));
+    BurnManifest built;
+    ASSERT_EQ(BurnVerifier::BuildManifest(IMAGE_PATH, START_LBA, built), E_OK);
+    EXPECT_EQ(built.totalBytes, IMAGE_SIZE);
+    EXPECT_EQ(built.digests.size(), (IMAGE_SIZE + built.ExtentBytes() - 1) / built.ExtentBytes());
+
+    ASSERT_EQ(BurnVerifier::SaveManifest(built, MANIFEST_PATH), E_OK);
+    BurnManifest loaded;
+    ASSERT_EQ(BurnVerifier::LoadManifest(MANIFEST_PATH, loaded), E_OK);
+    EXPECT_EQ(loaded.startLba, START_LBA);
+    EXPECT_EQ(loaded.totalBytes, built.totalBytes);
+    EXPECT_EQ(loaded.digests, built.digests);
+
+    BurnManifest missing;
+    EXPECT_EQ(BurnVerifier::LoadManifest(TEST_ROOT + "/none", missing), E_NOT_SUPPORT);
+    WriteTestFile(MANIFEST_PATH, "burn-manifest-v1 2048 512 0 4096\n");
+    EXPECT_EQ(BurnVerifier::LoadManifest(MANIFEST_PATH, missing), E_ERR);
+
+    EXPECT_EQ(BurnVerifier::SessionStartLba(true, "0,11702"), 0U);
+    EXPECT_EQ(BurnVerifier::SessionStartLba(false, "0,11702"), 11702U);
+    EXPECT_EQ(BurnVerifier::GetManifestPath("/dev/block/vol-11-0"),
+              "/data/local/burn_manifest/vol-11-0.manifest");
+    GTEST_LOG_(INFO) << "BurnVerifier_Manifest_001 end";
+}
+
+/**
+ * @tc.name: BurnVerifier_RecordBurn_001
+ * @tc.desc: Verify a burned image file is recorded as its manifest and a failed record leaves none behind.
+ * @tc.type: FUNC
+ */
+HWTEST_F(BurnVerifierTest, BurnVerifier_RecordBurn_001, TestSize.Level1)
+{
+    GTEST_LOG_(INFO) << "BurnVerifier_RecordBurn_001 start";
+    const std::string devPath = "/dev/block/burn_ut_record";
+    WriteTestFile(IMAGE_PATH, MakeImage(IMAGE_SIZE));
+    ASSERT_EQ(BurnVerifier::RecordBurn(devPath, IMAGE_PATH, START_LBA), E_OK);
+    BurnManifest recorded;
+    ASSERT_EQ(BurnVerifier::LoadManifest(BurnVerifier::GetManifestPath(devPath), recorded), E_OK);
+    BurnManifest built;
+    ASSERT_EQ(BurnVerifier::BuildManifest(IMAGE_PATH, START_LBA, built), E_OK);
+    EXPECT_EQ(recorded.startLba, START_LBA);
+    EXPECT_EQ(recorded.totalBytes, built.totalBytes);
+    EXPECT_EQ(recorded.digests, built.digests);
+
+    EXPECT_EQ(BurnVerifier::RecordBurn(devPath, TEST_ROOT + "/none", 0), E_ERR);
+    BurnManifest stale;
+    EXPECT_EQ(BurnVerifier::LoadManifest(BurnVerifier::GetManifestPath(devPath), stale), E_NOT_SUPPORT);
+    BurnVerifier::DropManifest(devPath);
+    GTEST_LOG_(INFO) << "BurnVerifier_RecordBurn_001 end";
+}
+
+/**
+ * @tc.name: BurnVerifier_Verify_001
+ * @tc.desc: Verify an intact medium matches and progress reaches 100.
+ * @tc.type: FUNC
+ */
+HWTEST_F(BurnVerifierTest, BurnVerifier_Verify_001, TestSize.Level1)
+{
+    GTEST_LOG_(INFO) << "BurnVerifier_Verify_001 start";
+    std::string image = MakeImage(IMAGE_SIZE);
+    WriteTestFile(IMAGE_PATH, image);
+    WriteDevice(image);
+    BurnManifest manifest;
+    ASSERT_EQ(BurnVerifier::BuildManifest(IMAGE_PATH, START_LBA, manifest), E_OK);
+
+    BurnVerifyResult result;
+    ASSERT_EQ(BurnVerifier::Verify(DEVICE_PATH, manifest, PROGRESS_PATH, result), E_OK);
+    EXPECT_TRUE(result.matched);
+    EXPECT_EQ(result.bytesVerified, IMAGE_SIZE);
+    EXPECT_EQ(ReadFileContent(PROGRESS_PATH), "100");
+    GTEST_LOG_(INFO) << "BurnVerifier_Verify_001 end";
+}
+
+/**
+ * @tc.name: BurnVerifier_Verify_002
+ * @tc.desc: Verify a flipped byte and a truncated medium report the first bad LBA range.
+ * @tc.type: FUNC
+ */
+HWTEST_F(BurnVerifierTest, BurnVerifier_Verify_002, TestSize.Level1)
+{
+    GTEST_LOG_(INFO) << "BurnVerifier_Verify_002 start";
+    std::string image = MakeImage(IMAGE_SIZE);
+    WriteTestFile(IMAGE_PATH, image);
+    BurnManifest manifest;
+    ASSERT_EQ(BurnVerifier::BuildManifest(IMAGE_PATH, START_LBA, manifest), E_OK);
+
+    std::string corrupt = image;
+    corrupt[CORRUPT_OFFSET] ^= 0x5a;
+    WriteDevice(corrupt);
+    BurnVerifyResult result;
+    ASSERT_EQ(BurnVerifier::Verify(DEVICE_PATH, manifest, PROGRESS_PATH, result), E_OK);
+    EXPECT_FALSE(result.matched);
+    uint64_t badExtent = CORRUPT_OFFSET / manifest.ExtentBytes();
+    EXPECT_EQ(result.badLbaStart, START_LBA + badExtent * manifest.extentSectors);
+    EXPECT_EQ(result.badLbaEnd, result.badLbaStart + manifest.extentSectors - 1);
+    EXPECT_EQ(result.bytesVerified, badExtent * manifest.ExtentBytes());
+
+    std::string padding(START_LBA * SECTOR_SIZE, 'p');
+    WriteTestFile(DEVICE_PATH, padding + image.substr(0, IMAGE_SIZE - SECTOR_SIZE));
+    ASSERT_EQ(BurnVerifier::Verify(DEVICE_PATH, manifest, PROGRESS_PATH, result), E_OK);
+    EXPECT_FALSE(result.matched);
+    uint64_t shortExtent = (IMAGE_SIZE - SECTOR_SIZE) / manifest.ExtentBytes();
+    EXPECT_EQ(result.badLbaStart, START_LBA + shortExtent * manifest.extentSectors);
+
+    EXPECT_EQ(BurnVerifier::Verify(TEST_ROOT + "/none", manifest, PROGRESS_PATH, result), E_ERR);
+    GTEST_LOG_(INFO) << "BurnVerifier_Verify_002 end";
+}
+
+/**
+ * @tc.name: BurnVerifier_Verify_Perf_001
+ * @tc.desc: Log verification throughput over a file-backed stand-in for the optical device.
+ * @tc.type: PERF
+ */
+HWTEST_F(BurnVerifierTest, BurnVerifier_Verify_Perf_001, TestSize.Level3)
+{
+    GTEST_LOG_(INFO) << "BurnVerifier_Verify_Perf_001 start";
+    std::string image = MakeImage(PERF_IMAGE_SIZE);
+    WriteTestFile(IMAGE_PATH, image);
+    WriteDevice(image);
+    BurnManifest manifest;
+    ASSERT_EQ(BurnVerifier::BuildManifest(IMAGE_PATH, START_LBA, manifest), E_OK);
+
+    BurnVerifyResult result;
+    ASSERT_EQ(BurnVerifier::Verify(DEVICE_PATH, manifest, PROGRESS_PATH, result), E_OK);
+    EXPECT_TRUE(result.matched);
+    GTEST_LOG_(INFO) << "verified " << result.bytesVerified << " bytes at " << result.throughputMBps << " MB/s";
+    GTEST_LOG_(INFO) << "BurnVerifier_Verify_Perf_001 end";
+}
+} // namespace StorageDaemon
+} // namespace OHOS
@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) 2026 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <chrono>
+#include <fcntl.h>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "disk_manager/disk/checksum_engine.h"
+#include "disk_manager/disk/disk_utils.h"
+#include "storage_service_errno.h"
+#include "utils/file_utils.h"
+
+namespace OHOS {
+namespace StorageDaemon {
+using namespace testing::ext;
+
+namespace {
+const std::string TEST_ROOT = "/data/local/tmp/checksum_engine_test";
+constexpr int32_t PERF_DIR_COUNT = 20;
+constexpr int32_t PERF_FILES_PER_DIR = 100;
+
+void WriteTestFile(const std::string &path, const std::string &content)
+{
+    std::ofstream file(path, std::ios::out | std::ios::trunc | std::ios::binary);
+    file << content;
+}
+} // namespace
+
+class ChecksumEngineTest : public testing::Test {
+public:
+    void SetUp() override
+    {
+        RmDirRecurse(TEST_ROOT);
+        ASSERT_TRUE(MkDirRecurse(TEST_ROOT + "/sub/deeper", S_IRWXU));
+    }
+    void TearDown() override
+    {
+        RmDirRecurse(TEST_ROOT);
+    }
+};
+
+/**
+ * @tc.name: ChecksumEngine_HashFile_001
+ * @tc.desc: Verify HashFile produces the reference MD5 and XXH64 digests.
+ * @tc.type: FUNC
+ */
+HWTEST_F(ChecksumEngineTest, ChecksumEngine_HashFile_001, TestSize.Level1)
+{
+    GTEST_LOG_(INFO) << "ChecksumEngine_HashFile_001 start";
+    WriteTestFile(TEST_ROOT + "/abc", "abc");
+    WriteTestFile(TEST_ROOT + "/empty", "");
+    int dirFd = open(TEST_ROOT.c_str(), O_RDONLY | O_DIRECTORY);
+    ASSERT_GE(dirFd, 0);
+    std::string digest;
+    EXPECT_EQ(ChecksumEngine::HashFile(dirFd, "abc", ChecksumAlgorithm::MD5, digest), E_OK);
+    EXPECT_EQ(digest, "900150983cd24fb0d6963f7d28e17f72");
+    EXPECT_EQ(ChecksumEngine::HashFile(dirFd, "abc", ChecksumAlgorithm::XXH64, digest), E_OK);
+    EXPECT_EQ(digest, "44bc2cf5ad770999");
+    EXPECT_EQ(ChecksumEngine::HashFile(dirFd, "empty", ChecksumAlgorithm::MD5, digest), E_OK);
+    EXPECT_EQ(digest, "d41d8cd98f00b204e9800998ecf8427e");
+    EXPECT_EQ(ChecksumEngine::HashFile(dirFd, "missing", ChecksumAlgorithm::MD5, digest), E_ERR);
+    close(dirFd);
+    GTEST_LOG_(INFO) << "ChecksumEngine_HashFile_001 end";
+}
+
+/**
+ * @tc.name: ChecksumEngine_HashTree_001
+ * @tc.desc: Verify HashTree indexes regular files by relative path and skips symlinks.
+ * @tc.type: FUNC
+ */
+HWTEST_F(ChecksumEngineTest, ChecksumEngine_HashTree_001, TestSize.Level1)
+{
+    GTEST_LOG_(INFO) << "ChecksumEngine_HashTree_001 start";
+    WriteTestFile(TEST_ROOT + "/top", "abc");
+    WriteTestFile(TEST_ROOT + "/sub/deeper/leaf", "abc");
+    ASSERT_EQ(symlink((TEST_ROOT + "/top").c_str(), (TEST_ROOT + "/sub/link").c_str()), 0);
+
+    ChecksumIndex index;
+    EXPECT_EQ(ChecksumEngine::HashTree(TEST_ROOT, ChecksumAlgorithm::MD5, index), E_OK);
+    EXPECT_EQ(index.size(), 2U);
+    EXPECT_EQ(index["top"], "900150983cd24fb0d6963f7d28e17f72");
+    EXPECT_EQ(index["sub/deeper/leaf"], "900150983cd24fb0d6963f7d28e17f72");
+
+    ChecksumIndex missing;
+    EXPECT_EQ(ChecksumEngine::HashTree(TEST_ROOT + "/nonexistent", ChecksumAlgorithm::MD5, missing), E_ERR);
+    GTEST_LOG_(INFO) << "ChecksumEngine_HashTree_001 end";
+}
+
+/**
+ * @tc.name: ChecksumEngine_GenerateChecksums_001
+ * @tc.desc: Verify the checksum file round-trips through ParseChecksumFile and CompareChecksums.
+ * @tc.type: FUNC
+ */
+HWTEST_F(ChecksumEngineTest, ChecksumEngine_GenerateChecksums_001, TestSize.Level1)
+{
+    GTEST_LOG_(INFO) << "ChecksumEngine_GenerateChecksums_001 start";
+    std::string dataDir = TEST_ROOT + "/sub";
+    WriteTestFile(dataDir + "/a.jpg", "picture");
+    WriteTestFile(dataDir + "/deeper/b.jpg", "another picture");
+    std::string checksumPath = TEST_ROOT + "/checksum.txt";
+    ASSERT_EQ(DiskUtils::GenerateChecksums(dataDir, checksumPath), E_OK);
+
+    ChecksumIndex parsed = DiskUtils::ParseChecksumFile(ReadFileContent(checksumPath), dataDir);
+    ChecksumIndex direct;
+    ASSERT_EQ(ChecksumEngine::HashTree(dataDir, ChecksumAlgorithm::MD5, direct), E_OK);
+    EXPECT_EQ(parsed, direct);
+    EXPECT_EQ(DiskUtils::CompareChecksums(parsed, direct), E_OK);
+
+    direct["deeper/b.jpg"] = "00000000000000000000000000000000";
+    EXPECT_NE(DiskUtils::CompareChecksums(parsed, direct), E_OK);
+    direct.erase("a.jpg");
+    EXPECT_NE(DiskUtils::CompareChecksums(parsed, direct), E_OK);
+    GTEST_LOG_(INFO) << "ChecksumEngine_GenerateChecksums_001 end";
+}
+
+/**
+ * @tc.name: ChecksumEngine_HashTree_Perf_001
+ * @tc.desc: Compare HashTree against the fork-per-file md5sum walk it replaces on a synthetic tree.
+ * @tc.type: PERF
+ */
+HWTEST_F(ChecksumEngineTest, ChecksumEngine_HashTree_Perf_001, TestSize.Level3)
+{
+    GTEST_LOG_(INFO) << "ChecksumEngine_HashTree_Perf_001 start";
+    for (int32_t dir = 0; dir < PERF_DIR_COUNT; dir++) {
+        std::string dirPath = TEST_ROOT + "/sub/deeper/d" + std::to_string(dir);
+        ASSERT_TRUE(MkDirRecurse(dirPath, S_IRWXU));
+        for (int32_t file = 0; file < PERF_FILES_PER_DIR; file++) {
+            WriteTestFile(dirPath + "/f" + std::to_string(file), std::string(file * 97 + dir, 'x'));
+        }
+    }
+    std::string treePath = TEST_ROOT + "/sub";
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::string> cmd = {"find", treePath, "-type", "f", "-exec", "md5sum", "{}", ";"};
+    std::vector<std::string> output;
+    int32_t forkRet = ForkExec(cmd, &output);
+    auto forkCost = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    ChecksumIndex md5Index;
+    ASSERT_EQ(ChecksumEngine::HashTree(treePath, ChecksumAlgorithm::MD5, md5Index), E_OK);
+    auto md5Cost = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    ChecksumIndex xxhIndex;
+    ASSERT_EQ(ChecksumEngine::HashTree(treePath, ChecksumAlgorithm::XXH64, xxhIndex), E_OK);
+    auto xxhCost = std::chrono::steady_clock::now() - start;
+
+    EXPECT_EQ(md5Index.size(), static_cast<size_t>(PERF_DIR_COUNT * PERF_FILES_PER_DIR));
+    EXPECT_EQ(xxhIndex.size(), md5Index.size());
+    if (forkRet == E_OK) {
+        std::string content;
+        for (const auto &line : output) {
+            content += line + "\n";
+        }
+        EXPECT_EQ(DiskUtils::ParseChecksumFile(content, treePath), md5Index);
+    }
+    using std::chrono::milliseconds;
+    GTEST_LOG_(INFO) << "files " << md5Index.size()
+                     << ", fork md5sum " << std::chrono::duration_cast<milliseconds>(forkCost).count()
+                     << " ms, engine md5 " << std::chrono::duration_cast<milliseconds>(md5Cost).count()
+                     << " ms, engine xxh64 " << std::chrono::duration_cast<milliseconds>(xxhCost).count() << " ms";
+    GTEST_LOG_(INFO) << "ChecksumEngine_HashTree_Perf_001 end";
+}
+} // namespace StorageDaemon
+} // namespace OHOS
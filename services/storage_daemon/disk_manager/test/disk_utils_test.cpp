@@ -1693,5 +1693,16 @@ HWTEST_F(ExtDiskUtilsTest, ValidateBurnOptions_InvalidBurnPath, TestSize.Level1)
     EXPECT_EQ(ret, E_PARAMS_INVALID);
 }
 
+/**
+ * @tc.name: VerifyBurnData_NoManifest
+ * @tc.desc: Verify VerifyBurnData reports E_NOT_SUPPORT instead of success when the burn left no manifest.
+ * @tc.type: FUNC
+ * @tc.require: AR000GK4HB
+ */
+HWTEST_F(ExtDiskUtilsTest, VerifyBurnData_NoManifest, TestSize.Level1)
+{
+    EXPECT_EQ(DiskUtils::VerifyBurnData("/dev/block/burn_ut_no_manifest", 0), E_NOT_SUPPORT);
+}
+
 } // namespace StorageDaemon
 } // namespace OHOS
@@ -13,8 +13,14 @@
  * limitations under the License.
  */
 
+#include <algorithm>
 #include <climits>
 #include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <iterator>
+#include <sys/stat.h>
+#include <unistd.h>
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
@@ -33,6 +39,37 @@ using namespace testing::ext;
 
 constexpr int32_t E_VERIFY_BURN_DATA_FAILED = 13600030;
 
+constexpr const char *ISO_UT_SRC = "/data/local/tmp/iso_operator_ut_src";
+constexpr const char *ISO_UT_IMAGE = "/data/local/tmp/iso_operator_ut.iso";
+constexpr off_t ISO_UT_SECTOR = 2048;
+
+void PrepareIsoSource()
+{
+    (void)mkdir(ISO_UT_SRC, S_IRWXU);
+    std::ofstream ofs(std::string(ISO_UT_SRC) + "/readme.txt");
+    ofs << "iso operator ut";
+}
+
+// rmdir is mocked in this suite, so the directory goes through unlinkat.
+void RemoveIsoSource()
+{
+    (void)unlink((std::string(ISO_UT_SRC) + "/readme.txt").c_str());
+    (void)unlinkat(AT_FDCWD, ISO_UT_SRC, AT_REMOVEDIR);
+}
+
+// Runs the writer the burner was started with and returns the bytes it fed.
+std::string FeedToFile(const ChildInputWriter &writer, int32_t &ret)
+{
+    const std::string fedPath = std::string(ISO_UT_IMAGE) + ".fed";
+    int fd = open(fedPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, S_IRUSR | S_IWUSR);
+    ret = writer(fd);
+    close(fd);
+    std::ifstream fed(fedPath, std::ios::binary);
+    std::string data((std::istreambuf_iterator<char>(fed)), std::istreambuf_iterator<char>());
+    (void)unlink(fedPath.c_str());
+    return data;
+}
+
 int g_realpathRet = 0;
 bool g_realpathOverride = false;
 const char *g_realpathPath = "/dev/block/sr0";
@@ -68,6 +105,7 @@ public:
     }
     void TearDown() override
     {
+        RemoveIsoSource();
         g_realpathOverride = false;
         IFileUtilMoc::fileUtilMoc = nullptr;
         fileUtilMoc_ = nullptr;
@@ -180,127 +218,129 @@ HWTEST_F(IsoOperatorTest, IsoOperator_ReadMetadata_LabelEmpty, TestSize.Level1)
     EXPECT_EQ(label, "CDROM");
 }
 
-HWTEST_F(IsoOperatorTest, IsoOperator_CreateIsoImage_ForkExecFailed, TestSize.Level1)
+HWTEST_F(IsoOperatorTest, IsoOperator_CreateIsoImage_ScanFailed, TestSize.Level1)
 {
     IsoOperator op;
     EXPECT_CALL(*diskUtilMoc_, CleanTempDirectory()).WillOnce(Return(E_OK));
-    EXPECT_CALL(*fileUtilMoc_, ForkExec(_, _, _)).WillOnce(Return(E_ERR));
-    EXPECT_EQ(op.CreateIsoImage("/dev/sr0", "/tmp/image.iso", "/mnt/cd"), E_ERR);
+    EXPECT_EQ(op.CreateIsoImage("/dev/sr0", ISO_UT_IMAGE, "/mnt/iso_operator_ut_none"), E_PARAMS_INVALID);
+    struct stat st {};
+    EXPECT_NE(stat(ISO_UT_IMAGE, &st), 0);
 }
 
-HWTEST_F(IsoOperatorTest, IsoOperator_CreateIsoImage_Success, TestSize.Level1)
+HWTEST_F(IsoOperatorTest, IsoOperator_CreateIsoImage_OpenFailed, TestSize.Level1)
 {
     IsoOperator op;
-    EXPECT_CALL(*diskUtilMoc_, CleanTempDirectory()).WillOnce(Return(E_OK)).WillOnce(Return(E_OK));
-    EXPECT_CALL(*fileUtilMoc_, ForkExec(_, _, _)).WillOnce(Return(E_OK));
-    EXPECT_EQ(op.CreateIsoImage("/dev/sr0", "/tmp/image.iso", "/mnt/cd"), E_OK);
+    PrepareIsoSource();
+    EXPECT_CALL(*diskUtilMoc_, CleanTempDirectory()).WillOnce(Return(E_OK));
+    EXPECT_EQ(op.CreateIsoImage("/dev/sr0", "/mnt/iso_operator_ut_none/image.iso", ISO_UT_SRC), E_ERR);
 }
 
-HWTEST_F(IsoOperatorTest, IsoOperator_CreateIsoImage_CleanTempFailed, TestSize.Level1)
+HWTEST_F(IsoOperatorTest, IsoOperator_CreateIsoImage_Success, TestSize.Level1)
 {
     IsoOperator op;
-    EXPECT_CALL(*diskUtilMoc_, CleanTempDirectory()).WillOnce(Return(E_ERR)).WillOnce(Return(E_OK));
-    EXPECT_CALL(*fileUtilMoc_, ForkExec(_, _, _)).WillOnce(Return(E_OK));
-    EXPECT_EQ(op.CreateIsoImage("/dev/sr0", "/tmp/image.iso", "/mnt/cd"), E_OK);
+    PrepareIsoSource();
+    EXPECT_CALL(*diskUtilMoc_, CleanTempDirectory()).WillOnce(Return(E_OK)).WillOnce(Return(E_OK));
+    EXPECT_CALL(*fileUtilMoc_, ForkExec(_, _, _)).Times(0);
+    EXPECT_EQ(op.CreateIsoImage("/dev/sr0", ISO_UT_IMAGE, ISO_UT_SRC), E_OK);
+    struct stat st {};
+    ASSERT_EQ(stat(ISO_UT_IMAGE, &st), 0);
+    EXPECT_GT(st.st_size, 0);
+    EXPECT_EQ(st.st_size % ISO_UT_SECTOR, 0);
+    (void)unlink(ISO_UT_IMAGE);
 }
 
-HWTEST_F(IsoOperatorTest, IsoOperator_PrepareIsoImage_MkDirFailed, TestSize.Level1)
+HWTEST_F(IsoOperatorTest, IsoOperator_CreateIsoImage_CleanTempFailed, TestSize.Level1)
 {
     IsoOperator op;
-    BurnOptions opts;
-    EXPECT_CALL(*fileUtilMoc_, IsDir(_)).WillOnce(Return(false));
-    EXPECT_CALL(*fileUtilMoc_, MkDir(_, _)).WillOnce(Return(E_ERR));
-    EXPECT_EQ(op.PrepareIsoImage("/dev/sr0", opts, true, ""), E_ERR);
+    PrepareIsoSource();
+    EXPECT_CALL(*diskUtilMoc_, CleanTempDirectory()).WillOnce(Return(E_ERR)).WillOnce(Return(E_OK));
+    EXPECT_EQ(op.CreateIsoImage("/dev/sr0", ISO_UT_IMAGE, ISO_UT_SRC), E_OK);
+    (void)unlink(ISO_UT_IMAGE);
 }
 
-HWTEST_F(IsoOperatorTest, IsoOperator_PrepareIsoImage_IsIsoImage, TestSize.Level1)
+HWTEST_F(IsoOperatorTest, IsoOperator_DoCDBurn_ScanFailed, TestSize.Level1)
 {
     IsoOperator op;
     BurnOptions opts;
-    opts.isIsoImage = true;
-    EXPECT_CALL(*fileUtilMoc_, IsDir(_)).WillOnce(Return(false));
-    EXPECT_CALL(*fileUtilMoc_, MkDir(_, _)).WillOnce(Return(E_OK));
+    opts.burnPath = "/mnt/iso_operator_ut_none";
     EXPECT_CALL(*diskUtilMoc_, CleanTempDirectory()).WillOnce(Return(E_OK));
-    EXPECT_EQ(op.PrepareIsoImage("/dev/sr0", opts, true, ""), E_OK);
+    EXPECT_CALL(*fileUtilMoc_, ForkExecWithInput(_, _, _)).Times(0);
+    EXPECT_EQ(op.DoCDBurn("/dev/sr0", opts, true, ""), E_PARAMS_INVALID);
 }
 
-HWTEST_F(IsoOperatorTest, IsoOperator_PrepareIsoImage_DiskEmptyGenSuccess, TestSize.Level1)
+HWTEST_F(IsoOperatorTest, IsoOperator_DoCDBurn_BurnPathDash, TestSize.Level1)
 {
     IsoOperator op;
     BurnOptions opts;
-    opts.burnPath = "/data/burn";
-    opts.diskName = "MYDISC";
-    EXPECT_CALL(*fileUtilMoc_, IsDir(_)).WillOnce(Return(false));
-    EXPECT_CALL(*fileUtilMoc_, MkDir(_, _)).WillOnce(Return(E_OK));
-    EXPECT_CALL(*diskUtilMoc_, CleanTempDirectory()).WillOnce(Return(E_OK));
-    EXPECT_CALL(*fileUtilMoc_, ForkExec(_, _, _)).WillOnce(Return(E_OK));
-    EXPECT_EQ(op.PrepareIsoImage("/dev/sr0", opts, true, ""), E_OK);
+    opts.burnPath = "-evil";
+    EXPECT_EQ(op.DoCDBurn("/dev/sr0", opts, false, "0,0"), E_ERR);
 }
 
-HWTEST_F(IsoOperatorTest, IsoOperator_PrepareIsoImage_DiskNotEmptyGenSuccess, TestSize.Level1)
+HWTEST_F(IsoOperatorTest, IsoOperator_DoCDBurn_NotIsoImageDiskEmpty, TestSize.Level1)
 {
     IsoOperator op;
     BurnOptions opts;
-    opts.burnPath = "/data/burn";
+    opts.burnPath = ISO_UT_SRC;
     opts.diskName = "MYDISC";
-    EXPECT_CALL(*fileUtilMoc_, IsDir(_)).WillOnce(Return(false));
-    EXPECT_CALL(*fileUtilMoc_, MkDir(_, _)).WillOnce(Return(E_OK));
-    EXPECT_CALL(*diskUtilMoc_, CleanTempDirectory()).WillOnce(Return(E_OK));
-    EXPECT_CALL(*fileUtilMoc_, ForkExec(_, _, _)).WillOnce(Return(E_OK));
-    EXPECT_EQ(op.PrepareIsoImage("/dev/sr0", opts, false, "0,0"), E_OK);
-}
-
-HWTEST_F(IsoOperatorTest, IsoOperator_PrepareIsoImage_GenFailed, TestSize.Level1)
-{
-    IsoOperator op;
-    BurnOptions opts;
-    opts.burnPath = "/data/burn";
-    EXPECT_CALL(*fileUtilMoc_, IsDir(_)).WillOnce(Return(false));
-    EXPECT_CALL(*fileUtilMoc_, MkDir(_, _)).WillOnce(Return(E_OK));
-    EXPECT_CALL(*diskUtilMoc_, CleanTempDirectory()).WillOnce(Return(E_OK));
-    EXPECT_CALL(*fileUtilMoc_, ForkExec(_, _, _)).WillOnce(Return(E_ERR));
-    EXPECT_CALL(*fileUtilMoc_, RmDirRecurse(_)).WillOnce(Return(true));
-    EXPECT_EQ(op.PrepareIsoImage("/dev/sr0", opts, true, ""), E_ERR);
-}
-
-HWTEST_F(IsoOperatorTest, IsoOperator_DoCDBurn_PrepareFailed, TestSize.Level1)
-{
-    IsoOperator op;
-    BurnOptions opts;
-    EXPECT_CALL(*diskUtilMoc_, CleanTempDirectory()).WillOnce(Return(E_OK));
-    EXPECT_CALL(*fileUtilMoc_, IsDir(_)).WillOnce(Return(false));
-    EXPECT_CALL(*fileUtilMoc_, MkDir(_, _)).WillOnce(Return(E_ERR));
-    EXPECT_EQ(op.DoCDBurn("/dev/sr0", opts, true, ""), E_ERR);
+    opts.burnSpeed = "1";
+    PrepareIsoSource();
+    std::vector<std::string> burnCmd;
+    std::string fed;
+    EXPECT_CALL(*diskUtilMoc_, CleanTempDirectory()).WillOnce(Return(E_OK)).WillOnce(Return(E_OK));
+    EXPECT_CALL(*fileUtilMoc_, ForkExec(_, _, _)).Times(0);
+    EXPECT_CALL(*fileUtilMoc_, ForkExecWithInput(_, _, _)).WillOnce(Invoke(
+        [&burnCmd, &fed](std::vector<std::string> &cmd, const ChildInputWriter &writer, std::vector<std::string> *) {
+            burnCmd = cmd;
+            int32_t ret = E_ERR;
+            fed = FeedToFile(writer, ret);
+            return ret;
+        }));
+    EXPECT_EQ(op.DoCDBurn("/dev/sr0", opts, true, ""), E_OK);
+    ASSERT_GE(burnCmd.size(), 2U);
+    EXPECT_EQ(burnCmd.back(), "-");
+    EXPECT_EQ(burnCmd[burnCmd.size() - 2], "tsize=" + std::to_string(fed.size()));
+    ASSERT_GT(fed.size(), static_cast<size_t>(17 * ISO_UT_SECTOR));
+    EXPECT_EQ(fed.substr(16 * ISO_UT_SECTOR + 1, 5), "CD001");
+    EXPECT_EQ(fed.substr(16 * ISO_UT_SECTOR + 40, 6), "MYDISC");
+    EXPECT_NE(fed.find("iso operator ut"), std::string::npos);
 }
 
-HWTEST_F(IsoOperatorTest, IsoOperator_DoCDBurn_NotIsoImageDiskEmpty, TestSize.Level1)
+HWTEST_F(IsoOperatorTest, IsoOperator_DoCDBurn_NotIsoImageDiskNotEmpty, TestSize.Level1)
 {
     IsoOperator op;
     BurnOptions opts;
     opts.burnPath = "/data/burn";
     opts.diskName = "MYDISC";
     opts.burnSpeed = "1";
-    EXPECT_CALL(*diskUtilMoc_, CleanTempDirectory())
-        .WillOnce(Return(E_OK)).WillOnce(Return(E_OK)).WillOnce(Return(E_OK));
-    EXPECT_CALL(*fileUtilMoc_, IsDir(_)).WillOnce(Return(false));
-    EXPECT_CALL(*fileUtilMoc_, MkDir(_, _)).WillOnce(Return(E_OK));
-    EXPECT_CALL(*fileUtilMoc_, ForkExec(_, _, _)).WillOnce(Return(E_OK)).WillOnce(Return(E_OK));
-    EXPECT_EQ(op.DoCDBurn("/dev/sr0", opts, true, ""), E_OK);
+    std::vector<std::string> sizeCmd;
+    std::vector<std::string> burnCmd;
+    std::vector<std::string> sizeOutput = { "genisoimage: warning", "1234" };
+    EXPECT_CALL(*diskUtilMoc_, CleanTempDirectory()).WillOnce(Return(E_OK)).WillOnce(Return(E_OK));
+    EXPECT_CALL(*fileUtilMoc_, ForkExec(_, _, _))
+        .WillOnce(DoAll(SaveArg<0>(&sizeCmd), SetArgPointee<1>(sizeOutput), Return(E_OK)));
+    EXPECT_CALL(*fileUtilMoc_, ForkExecWithInput(_, _, _)).WillOnce(DoAll(SaveArg<0>(&burnCmd), Return(E_OK)));
+    EXPECT_EQ(op.DoCDBurn("/dev/sr0", opts, false, "0,0"), E_OK);
+    ASSERT_GE(sizeCmd.size(), 3U);
+    EXPECT_EQ(sizeCmd[1], "-print-size");
+    EXPECT_EQ(std::count(sizeCmd.begin(), sizeCmd.end(), "-o"), 0);
+    EXPECT_EQ(std::count(burnCmd.begin(), burnCmd.end(), "-tao"), 1);
+    EXPECT_EQ(std::count(burnCmd.begin(), burnCmd.end(), "tsize=1234s"), 1);
 }
 
-HWTEST_F(IsoOperatorTest, IsoOperator_DoCDBurn_NotIsoImageDiskNotEmpty, TestSize.Level1)
+HWTEST_F(IsoOperatorTest, IsoOperator_DoCDBurn_PrintSizeFailed, TestSize.Level1)
 {
     IsoOperator op;
     BurnOptions opts;
     opts.burnPath = "/data/burn";
-    opts.diskName = "MYDISC";
     opts.burnSpeed = "1";
-    EXPECT_CALL(*diskUtilMoc_, CleanTempDirectory())
-        .WillOnce(Return(E_OK)).WillOnce(Return(E_OK)).WillOnce(Return(E_OK));
-    EXPECT_CALL(*fileUtilMoc_, IsDir(_)).WillOnce(Return(false));
-    EXPECT_CALL(*fileUtilMoc_, MkDir(_, _)).WillOnce(Return(E_OK));
-    EXPECT_CALL(*fileUtilMoc_, ForkExec(_, _, _)).WillOnce(Return(E_OK)).WillOnce(Return(E_OK));
-    EXPECT_EQ(op.DoCDBurn("/dev/sr0", opts, false, "0,0"), E_OK);
+    std::vector<std::string> sizeOutput = { "genisoimage: no size" };
+    EXPECT_CALL(*diskUtilMoc_, CleanTempDirectory()).WillOnce(Return(E_OK)).WillOnce(Return(E_OK));
+    EXPECT_CALL(*fileUtilMoc_, ForkExec(_, _, _))
+        .WillOnce(Return(E_ERR))
+        .WillOnce(DoAll(SetArgPointee<1>(sizeOutput), Return(E_OK)));
+    EXPECT_CALL(*fileUtilMoc_, ForkExecWithInput(_, _, _)).Times(0);
+    EXPECT_EQ(op.DoCDBurn("/dev/sr0", opts, false, "0,0"), E_ERR);
+    EXPECT_EQ(op.DoCDBurn("/dev/sr0", opts, false, "0,0"), E_ERR);
 }
 
 HWTEST_F(IsoOperatorTest, IsoOperator_DoCDBurn_IsIsoImage, TestSize.Level1)
@@ -310,12 +350,13 @@ HWTEST_F(IsoOperatorTest, IsoOperator_DoCDBurn_IsIsoImage, TestSize.Level1)
     opts.isIsoImage = true;
     opts.burnPath = "/data/image.iso";
     opts.burnSpeed = "1";
-    EXPECT_CALL(*diskUtilMoc_, CleanTempDirectory())
-        .WillOnce(Return(E_OK)).WillOnce(Return(E_OK)).WillOnce(Return(E_OK));
-    EXPECT_CALL(*fileUtilMoc_, IsDir(_)).WillOnce(Return(false));
-    EXPECT_CALL(*fileUtilMoc_, MkDir(_, _)).WillOnce(Return(E_OK));
-    EXPECT_CALL(*fileUtilMoc_, ForkExec(_, _, _)).WillOnce(Return(E_OK));
+    std::vector<std::string> burnCmd;
+    EXPECT_CALL(*diskUtilMoc_, CleanTempDirectory()).WillOnce(Return(E_OK)).WillOnce(Return(E_OK));
+    EXPECT_CALL(*fileUtilMoc_, ForkExec(_, _, _)).WillOnce(DoAll(SaveArg<0>(&burnCmd), Return(E_OK)));
+    EXPECT_CALL(*fileUtilMoc_, ForkExecWithInput(_, _, _)).Times(0);
     EXPECT_EQ(op.DoCDBurn("/dev/sr0", opts, true, ""), E_OK);
+    EXPECT_EQ(burnCmd, std::vector<std::string>({ "wodim", "-v", "dev=/dev/sr0", "-multi", "-data", "-speed=1",
+                                                  "/data/image.iso" }));
 }
 
 HWTEST_F(IsoOperatorTest, IsoOperator_DoCDBurn_WodimFailed, TestSize.Level1)
@@ -325,12 +366,9 @@ HWTEST_F(IsoOperatorTest, IsoOperator_DoCDBurn_WodimFailed, TestSize.Level1)
     opts.isIsoImage = true;
     opts.burnPath = "/data/image.iso";
     opts.burnSpeed = "1";
-    EXPECT_CALL(*diskUtilMoc_, CleanTempDirectory())
-        .WillOnce(Return(E_OK)).WillOnce(Return(E_OK));
-    EXPECT_CALL(*fileUtilMoc_, IsDir(_)).WillOnce(Return(false));
-    EXPECT_CALL(*fileUtilMoc_, MkDir(_, _)).WillOnce(Return(E_OK));
+    EXPECT_CALL(*diskUtilMoc_, CleanTempDirectory()).WillOnce(Return(E_OK));
     EXPECT_CALL(*fileUtilMoc_, ForkExec(_, _, _)).WillOnce(Return(E_ERR));
-    EXPECT_CALL(*fileUtilMoc_, RmDirRecurse(_)).WillOnce(Return(true));
+    EXPECT_CALL(*fileUtilMoc_, RmDirRecurse(_)).Times(0);
     EXPECT_EQ(op.DoCDBurn("/dev/sr0", opts, true, ""), E_ERR);
 }
 
@@ -347,13 +385,37 @@ HWTEST_F(IsoOperatorTest, IsoOperator_DoDVDBurn_NotIsoImageDiskEmpty, TestSize.L
 {
     IsoOperator op;
     BurnOptions opts;
-    opts.burnPath = "/data/burn";
+    opts.burnPath = ISO_UT_SRC;
     opts.diskName = "MYDISC";
     opts.burnSpeed = "1";
-    EXPECT_CALL(*diskUtilMoc_, CleanTempDirectory())
-        .WillOnce(Return(E_OK)).WillOnce(Return(E_OK));
-    EXPECT_CALL(*fileUtilMoc_, ForkExec(_, _, _)).WillOnce(Return(E_OK));
+    PrepareIsoSource();
+    std::vector<std::string> burnCmd;
+    std::string fed;
+    EXPECT_CALL(*diskUtilMoc_, CleanTempDirectory()).WillOnce(Return(E_OK)).WillOnce(Return(E_OK));
+    EXPECT_CALL(*fileUtilMoc_, ForkExec(_, _, _)).Times(0);
+    EXPECT_CALL(*fileUtilMoc_, ForkExecWithInput(_, _, _)).WillOnce(Invoke(
+        [&burnCmd, &fed](std::vector<std::string> &cmd, const ChildInputWriter &writer, std::vector<std::string> *) {
+            burnCmd = cmd;
+            int32_t ret = E_ERR;
+            fed = FeedToFile(writer, ret);
+            return ret;
+        }));
     EXPECT_EQ(op.DoDVDBurn("/dev/sr0", opts, true), E_OK);
+    EXPECT_EQ(burnCmd, std::vector<std::string>({ "growisofs", "-speed=1", "-Z", "/dev/sr0=/dev/fd/0" }));
+    ASSERT_GT(fed.size(), static_cast<size_t>(17 * ISO_UT_SECTOR));
+    EXPECT_EQ(fed.size() % ISO_UT_SECTOR, 0U);
+    EXPECT_EQ(fed.substr(16 * ISO_UT_SECTOR + 1, 5), "CD001");
+}
+
+HWTEST_F(IsoOperatorTest, IsoOperator_DoDVDBurn_ScanFailed, TestSize.Level1)
+{
+    IsoOperator op;
+    BurnOptions opts;
+    opts.burnPath = "/mnt/iso_operator_ut_none";
+    opts.burnSpeed = "1";
+    EXPECT_CALL(*diskUtilMoc_, CleanTempDirectory()).WillOnce(Return(E_OK));
+    EXPECT_CALL(*fileUtilMoc_, ForkExecWithInput(_, _, _)).Times(0);
+    EXPECT_EQ(op.DoDVDBurn("/dev/sr0", opts, true), E_PARAMS_INVALID);
 }
 
 HWTEST_F(IsoOperatorTest, IsoOperator_DoDVDBurn_NotIsoImageDiskNotEmpty, TestSize.Level1)
@@ -376,10 +438,13 @@ HWTEST_F(IsoOperatorTest, IsoOperator_DoDVDBurn_IsIsoImage, TestSize.Level1)
     opts.isIsoImage = true;
     opts.burnPath = "/data/image.iso";
     opts.burnSpeed = "1";
+    std::vector<std::string> burnCmd;
     EXPECT_CALL(*diskUtilMoc_, CleanTempDirectory())
         .WillOnce(Return(E_OK)).WillOnce(Return(E_OK));
-    EXPECT_CALL(*fileUtilMoc_, ForkExec(_, _, _)).WillOnce(Return(E_OK));
+    EXPECT_CALL(*fileUtilMoc_, ForkExec(_, _, _)).WillOnce(DoAll(SaveArg<0>(&burnCmd), Return(E_OK)));
+    EXPECT_CALL(*fileUtilMoc_, ForkExecWithInput(_, _, _)).Times(0);
     EXPECT_EQ(op.DoDVDBurn("/dev/sr0", opts, true), E_OK);
+    EXPECT_EQ(burnCmd, std::vector<std::string>({ "growisofs", "-speed=1", "-Z", "/dev/sr0=/data/image.iso" }));
 }
 
 HWTEST_F(IsoOperatorTest, IsoOperator_DoDVDBurn_ForkExecFailed, TestSize.Level1)
@@ -391,7 +456,7 @@ HWTEST_F(IsoOperatorTest, IsoOperator_DoDVDBurn_ForkExecFailed, TestSize.Level1)
     opts.burnSpeed = "1";
     EXPECT_CALL(*diskUtilMoc_, CleanTempDirectory()).WillOnce(Return(E_OK));
     EXPECT_CALL(*fileUtilMoc_, ForkExec(_, _, _)).WillOnce(Return(E_ERR));
-    EXPECT_EQ(op.DoDVDBurn("/dev/sr0", opts, true), E_ERR);
+    EXPECT_EQ(op.DoDVDBurn("/dev/sr0", opts, false), E_ERR);
 }
 
 HWTEST_F(IsoOperatorTest, IsoOperator_Burn_BlankCD_CDType_VerifyFalse, TestSize.Level1)
@@ -399,17 +464,16 @@ HWTEST_F(IsoOperatorTest, IsoOperator_Burn_BlankCD_CDType_VerifyFalse, TestSize.
     IsoOperator op;
     BurnOptions opts;
     opts.isVerifyBurn = false;
-    opts.burnPath = "/data/burn";
+    opts.burnPath = ISO_UT_SRC;
     opts.diskName = "MYDISC";
     opts.burnSpeed = "1";
+    PrepareIsoSource();
     bool blank = true;
     EXPECT_CALL(*diskUtilMoc_, IsCDBlank(_)).WillOnce(Return(blank));
     EXPECT_CALL(*diskUtilMoc_, GetCDType(_)).WillOnce(Return("CDROM"));
-    EXPECT_CALL(*diskUtilMoc_, CleanTempDirectory())
-        .WillOnce(Return(E_OK)).WillOnce(Return(E_OK)).WillOnce(Return(E_OK));
-    EXPECT_CALL(*fileUtilMoc_, IsDir(_)).WillOnce(Return(false));
-    EXPECT_CALL(*fileUtilMoc_, MkDir(_, _)).WillOnce(Return(E_OK));
-    EXPECT_CALL(*fileUtilMoc_, ForkExec(_, _, _)).WillOnce(Return(E_OK)).WillOnce(Return(E_OK));
+    EXPECT_CALL(*diskUtilMoc_, CleanTempDirectory()).WillOnce(Return(E_OK)).WillOnce(Return(E_OK));
+    EXPECT_CALL(*fileUtilMoc_, ForkExec(_, _, _)).Times(0);
+    EXPECT_CALL(*fileUtilMoc_, ForkExecWithInput(_, _, _)).WillOnce(Return(E_OK));
     EXPECT_CALL(*diskUtilMoc_, EjectCD(_)).WillOnce(Return(E_OK));
     EXPECT_EQ(op.Burn("/dev/sr0", opts), E_OK);
 }
@@ -430,14 +494,15 @@ HWTEST_F(IsoOperatorTest, IsoOperator_Burn_DVDType_Success, TestSize.Level1)
     IsoOperator op;
     BurnOptions opts;
     opts.isVerifyBurn = false;
-    opts.burnPath = "/data/burn";
+    opts.burnPath = ISO_UT_SRC;
     opts.diskName = "MYDISC";
     opts.burnSpeed = "1";
+    PrepareIsoSource();
     bool blank = true;
     EXPECT_CALL(*diskUtilMoc_, IsCDBlank(_)).WillOnce(Return(blank));
     EXPECT_CALL(*diskUtilMoc_, GetCDType(_)).WillOnce(Return("DVDROM"));
     EXPECT_CALL(*diskUtilMoc_, CleanTempDirectory()).WillOnce(Return(E_OK)).WillOnce(Return(E_OK));
-    EXPECT_CALL(*fileUtilMoc_, ForkExec(_, _, _)).WillOnce(Return(E_OK));
+    EXPECT_CALL(*fileUtilMoc_, ForkExecWithInput(_, _, _)).WillOnce(Return(E_OK));
     EXPECT_CALL(*diskUtilMoc_, EjectCD(_)).WillOnce(Return(E_OK));
     EXPECT_EQ(op.Burn("/dev/sr0", opts), E_OK);
 }
@@ -0,0 +1,538 @@
+/*
+ * Copyright (c) 2026 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <chrono>
+#include <climits>
+#include <dirent.h>
+#include <fcntl.h>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <map>
+#include <sstream>
+#include <sys/stat.h>
+#include <sys/statvfs.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "disk_manager/disk/iso_image_builder.h"
+#include "storage_service_errno.h"
+#include "utils/file_utils.h"
+
+namespace OHOS {
+namespace StorageDaemon {
+using namespace testing::ext;
+
+namespace {
+const std::string TEST_ROOT = "/data/local/tmp/iso_image_builder_test";
+const std::string SRC_DIR = TEST_ROOT + "/src";
+const std::string IMAGE_PATH = TEST_ROOT + "/image.iso";
+constexpr size_t SECTOR_SIZE = 2048;
+constexpr size_t PVD_OFFSET = 16 * SECTOR_SIZE;
+constexpr size_t SVD_OFFSET = 17 * SECTOR_SIZE;
+constexpr size_t TERMINATOR_OFFSET = 18 * SECTOR_SIZE;
+constexpr size_t ROOT_RECORD = 156;
+constexpr size_t JOLIET_NAME_MAX = 103;
+constexpr size_t PERF_FILE_COUNT = 128;
+constexpr size_t PERF_FILE_SIZE = 1024 * 1024;
+constexpr double MB = 1024.0 * 1024.0;
+constexpr int EXIT_NOT_FOUND = 127;
+const std::string DIR_MARK = "<dir>";
+const std::string LONG_LINK_TARGET = "../" + std::string(300, 't');
+
+using Listing = std::map<std::string, std::string>;
+
+void WriteTestFile(const std::string &path, const std::string &content)
+{
+    std::ofstream file(path, std::ios::out | std::ios::trunc | std::ios::binary);
+    file << content;
+}
+
+void MakeTree()
+{
+    (void)RmDirRecurse(TEST_ROOT);
+    ASSERT_EQ(mkdir(TEST_ROOT.c_str(), S_IRWXU), 0);
+    ASSERT_EQ(mkdir(SRC_DIR.c_str(), S_IRWXU), 0);
+    // Names that collide once reduced to 8.3 d-characters.
+    WriteTestFile(SRC_DIR + "/Readme.txt", "first");
+    WriteTestFile(SRC_DIR + "/README.TXT", "second");
+    WriteTestFile(SRC_DIR + "/readme.txt.bak", "third");
+    WriteTestFile(SRC_DIR + "/" + std::string(200, 'n') + ".dat", std::string(SECTOR_SIZE + 1, 'x'));
+    WriteTestFile(SRC_DIR + "/\xe6\x96\x87\xe6\xa1\xa3 report.txt", "unicode");
+    WriteTestFile(SRC_DIR + "/empty", "");
+    ASSERT_EQ(mkdir((SRC_DIR + "/empty dir").c_str(), S_IRWXU), 0);
+    std::string dir = SRC_DIR;
+    for (int level = 0; level < 10; level++) {
+        dir += "/level." + std::to_string(level);
+        ASSERT_EQ(mkdir(dir.c_str(), S_IRWXU), 0);
+        WriteTestFile(dir + "/file" + std::to_string(level), std::string(level * 1000 + 1, 'a' + level));
+    }
+    ASSERT_EQ(chmod((SRC_DIR + "/README.TXT").c_str(), S_ISUID | S_IRWXU | S_IXGRP), 0);
+    ASSERT_EQ(symlink("Readme.txt", (SRC_DIR + "/link").c_str()), 0);
+    ASSERT_EQ(symlink("/data/./local/tmp", (SRC_DIR + "/level.0/abs link").c_str()), 0);
+    ASSERT_EQ(symlink(LONG_LINK_TARGET.c_str(), (SRC_DIR + "/" + std::string(200, 'l')).c_str()), 0);
+}
+
+void ListSource(const std::string &dir, const std::string &prefix, Listing &listing)
+{
+    DIR *dp = opendir(dir.c_str());
+    ASSERT_NE(dp, nullptr);
+    struct dirent *entry = nullptr;
+    while ((entry = readdir(dp)) != nullptr) {
+        std::string name = entry->d_name;
+        if (name == "." || name == "..") {
+            continue;
+        }
+        std::string path = dir + "/" + name;
+        struct stat st {};
+        ASSERT_EQ(lstat(path.c_str(), &st), 0);
+        if (S_ISDIR(st.st_mode)) {
+            listing[prefix + name] = DIR_MARK;
+            ListSource(path, prefix + name + "/", listing);
+        } else if (S_ISREG(st.st_mode)) {
+            std::ifstream file(path, std::ios::binary);
+            listing[prefix + name] = std::string((std::istreambuf_iterator<char>(file)), {});
+        } else if (S_ISLNK(st.st_mode)) {
+            listing[prefix + name] = "";
+        }
+    }
+    (void)closedir(dp);
+}
+
+uint32_t Le32(const std::string &image, size_t pos)
+{
+    const auto *p = reinterpret_cast<const uint8_t *>(image.data() + pos);
+    return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+// The Rock Ridge name of a primary directory record, following CE continuations.
+std::string RockRidgeName(const std::string &image, size_t pos, size_t end)
+{
+    std::string name;
+    while (pos + 4 <= end) {
+        std::string sig = image.substr(pos, 2);
+        size_t len = static_cast<uint8_t>(image[pos + 2]);
+        if (len < 4 || sig == "ST") {
+            break;
+        }
+        if (sig == "NM") {
+            name += image.substr(pos + 5, len - 5);
+        } else if (sig == "CE") {
+            size_t area = Le32(image, pos + 4) * SECTOR_SIZE + Le32(image, pos + 12);
+            return name + RockRidgeName(image, area, area + Le32(image, pos + 20));
+        }
+        pos += len;
+    }
+    return name;
+}
+
+std::string Utf16BeToUtf8(const std::string &id)
+{
+    std::string out;
+    for (size_t i = 0; i + 1 < id.size(); i += 2) {
+        uint32_t c = (static_cast<uint8_t>(id[i]) << 8) | static_cast<uint8_t>(id[i + 1]);
+        if (c >= 0xD800 && c < 0xDC00 && i + 3 < id.size()) {
+            uint32_t low = (static_cast<uint8_t>(id[i + 2]) << 8) | static_cast<uint8_t>(id[i + 3]);
+            c = 0x10000 + ((c - 0xD800) << 10) + (low - 0xDC00);
+            i += 2;
+        }
+        if (c < 0x80) {
+            out += static_cast<char>(c);
+        } else if (c < 0x800) {
+            out += static_cast<char>(0xC0 | (c >> 6));
+            out += static_cast<char>(0x80 | (c & 0x3F));
+        } else if (c < 0x10000) {
+            out += static_cast<char>(0xE0 | (c >> 12));
+            out += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (c & 0x3F));
+        } else {
+            out += static_cast<char>(0xF0 | (c >> 18));
+            out += static_cast<char>(0x80 | ((c >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (c & 0x3F));
+        }
+    }
+    return out;
+}
+
+// Walks one directory tree of the image; joliet picks the UCS-2 names, otherwise the Rock Ridge ones.
+void ListImage(const std::string &image, size_t record, const std::string &prefix, bool joliet, Listing &listing)
+{
+    size_t start = Le32(image, record + 2) * SECTOR_SIZE;
+    size_t end = start + Le32(image, record + 10);
+    ASSERT_LE(end, image.size());
+    size_t pos = start;
+    int index = 0;
+    while (pos < end) {
+        size_t len = static_cast<uint8_t>(image[pos]);
+        if (len == 0) {
+            pos = (pos / SECTOR_SIZE + 1) * SECTOR_SIZE;
+            continue;
+        }
+        if (index++ < 2) {
+            pos += len;
+            continue;
+        }
+        size_t idLen = static_cast<uint8_t>(image[pos + 32]);
+        std::string id = image.substr(pos + 33, idLen);
+        size_t suStart = pos + 33 + idLen + ((idLen % 2 == 0) ? 1 : 0);
+        std::string name = joliet ? Utf16BeToUtf8(id) : RockRidgeName(image, suStart, pos + len);
+        if (static_cast<uint8_t>(image[pos + 25]) & 0x02) {
+            listing[prefix + name] = DIR_MARK;
+            ListImage(image, pos, prefix + name + "/", joliet, listing);
+        } else {
+            listing[prefix + name] = image.substr(Le32(image, pos + 2) * SECTOR_SIZE, Le32(image, pos + 10));
+        }
+        pos += len;
+    }
+}
+
+// The attributes "genisoimage -r" gives the source entries, as "isoinfo -l" prints them: mode, owner, group,
+// then the size and symlink target of everything but directories, whose size depends on the layout.
+void ListSourceAttrs(const std::string &dir, const std::string &prefix, Listing &listing)
+{
+    DIR *dp = opendir(dir.c_str());
+    ASSERT_NE(dp, nullptr);
+    struct dirent *entry = nullptr;
+    while ((entry = readdir(dp)) != nullptr) {
+        std::string name = entry->d_name;
+        if (name == "." || name == "..") {
+            continue;
+        }
+        std::string path = dir + "/" + name;
+        struct stat st {};
+        ASSERT_EQ(lstat(path.c_str(), &st), 0);
+        bool exec = S_ISDIR(st.st_mode) || (st.st_mode & (S_IXUSR | S_IXGRP | S_IXOTH)) != 0;
+        std::string perms = exec ? "r-xr-xr-x" : "r--r--r--";
+        if (S_ISDIR(st.st_mode)) {
+            listing[prefix + name] = "d" + perms + " 0 0";
+            ListSourceAttrs(path, prefix + name + "/", listing);
+        } else if (S_ISREG(st.st_mode)) {
+            listing[prefix + name] = "-" + perms + " 0 0 " + std::to_string(st.st_size);
+        } else if (S_ISLNK(st.st_mode)) {
+            char target[PATH_MAX] = { 0 };
+            ASSERT_GT(readlink(path.c_str(), target, sizeof(target) - 1), 0);
+            listing[prefix + name] = "l" + perms + " 0 0 0 -> " + target;
+        }
+    }
+    (void)closedir(dp);
+}
+
+bool RunTool(const std::vector<std::string> &cmd, std::string &out)
+{
+    ChildRunOptions options;
+    ChildRunResult result;
+    if (RunChild(cmd, options, result) != E_OK || !WIFEXITED(result.status) || WEXITSTATUS(result.status) != 0) {
+        return false;
+    }
+    out = std::move(result.out);
+    return true;
+}
+
+bool HasTool(const std::string &tool)
+{
+    ChildRunOptions options;
+    ChildRunResult result;
+    return RunChild({ tool, "-version" }, options, result) == E_OK && WIFEXITED(result.status) &&
+        WEXITSTATUS(result.status) != EXIT_NOT_FOUND;
+}
+
+// The tree isoinfo reads from imagePath, "-R" for the Rock Ridge one and "-J" for Joliet, in the form of
+// ListSourceAttrs.
+Listing IsoinfoListing(const std::string &imagePath, const std::string &tree)
+{
+    Listing listing;
+    std::string out;
+    if (!RunTool({ "isoinfo", tree, "-l", "-i", imagePath }, out)) {
+        ADD_FAILURE() << "isoinfo " << tree << " -l failed";
+        return listing;
+    }
+    const std::string header = "Directory listing of /";
+    const std::string arrow = " -> ";
+    std::istringstream lines(out);
+    std::string line;
+    std::string dir;
+    while (std::getline(lines, line)) {
+        if (line.compare(0, header.size(), header) == 0) {
+            dir = line.substr(header.size());
+            continue;
+        }
+        size_t close = line.find(']');
+        if (close == std::string::npos) {
+            continue;
+        }
+        std::istringstream fields(line);
+        std::string mode;
+        std::string links;
+        std::string uid;
+        std::string gid;
+        std::string size;
+        fields >> mode >> links >> uid >> gid >> size;
+        std::string name = line.substr(line.find_first_not_of(' ', close + 1));
+        name = name.substr(0, name.find_last_not_of(' ') + 1);
+        if (name == "." || name == "..") {
+            continue;
+        }
+        std::string value = mode + " " + uid + " " + gid;
+        if (mode[0] != 'd') {
+            value += " " + size;
+        }
+        size_t target = name.find(arrow);
+        if (target != std::string::npos) {
+            value += name.substr(target);
+            name = name.substr(0, target);
+        }
+        listing[dir + name] = value;
+    }
+    return listing;
+}
+
+int32_t BuildImage(std::string &image)
+{
+    IsoImageBuilder builder;
+    int32_t err = builder.Scan(SRC_DIR);
+    if (err != E_OK) {
+        return err;
+    }
+    err = builder.Stream([&image](const uint8_t *data, size_t len) {
+        image.append(reinterpret_cast<const char *>(data), len);
+        return E_OK;
+    });
+    if (err == E_OK && image.size() != builder.GetImageSize()) {
+        return E_ERR;
+    }
+    return err;
+}
+} // namespace
+
+class IsoImageBuilderTest : public testing::Test {
+public:
+    void SetUp() override
+    {
+        MakeTree();
+    }
+
+    void TearDown() override
+    {
+        (void)RmDirRecurse(TEST_ROOT);
+    }
+};
+
+/**
+ * @tc.name: IsoImageBuilder_Stream_001
+ * @tc.desc: Verify the streamed image has the volume descriptors and the Rock Ridge tree matches the source.
+ * @tc.type: FUNC
+ */
+HWTEST_F(IsoImageBuilderTest, IsoImageBuilder_Stream_001, TestSize.Level1)
+{
+    GTEST_LOG_(INFO) << "IsoImageBuilder_Stream_001 start";
+    std::string image;
+    ASSERT_EQ(BuildImage(image), E_OK);
+    ASSERT_EQ(image.size() % SECTOR_SIZE, 0U);
+    EXPECT_EQ(image.substr(PVD_OFFSET, 6), std::string("\x01" "CD001"));
+    EXPECT_EQ(image.substr(SVD_OFFSET, 6), std::string("\x02" "CD001"));
+    EXPECT_EQ(image.substr(TERMINATOR_OFFSET, 6), std::string("\xff" "CD001"));
+    EXPECT_EQ(Le32(image, PVD_OFFSET + 80) * SECTOR_SIZE, image.size());
+
+    Listing expected;
+    ListSource(SRC_DIR, "", expected);
+    Listing actual;
+    ListImage(image, PVD_OFFSET + ROOT_RECORD, "", false, actual);
+    EXPECT_EQ(actual.count("link"), 1U);
+    EXPECT_EQ(actual, expected);
+    GTEST_LOG_(INFO) << "IsoImageBuilder_Stream_001 end";
+}
+
+/**
+ * @tc.name: IsoImageBuilder_Joliet_001
+ * @tc.desc: Verify the Joliet tree carries the Unicode names, cut at 103 characters, over the same extents.
+ * @tc.type: FUNC
+ */
+HWTEST_F(IsoImageBuilderTest, IsoImageBuilder_Joliet_001, TestSize.Level1)
+{
+    GTEST_LOG_(INFO) << "IsoImageBuilder_Joliet_001 start";
+    std::string image;
+    ASSERT_EQ(BuildImage(image), E_OK);
+    Listing source;
+    ListSource(SRC_DIR, "", source);
+    Listing expected;
+    for (const auto &[path, content] : source) {
+        std::string name = path.size() > JOLIET_NAME_MAX && path.find('/') == std::string::npos ?
+            path.substr(0, JOLIET_NAME_MAX) : path;
+        expected[name] = content;
+    }
+    Listing actual;
+    ListImage(image, SVD_OFFSET + ROOT_RECORD, "", true, actual);
+    EXPECT_EQ(actual, expected);
+    GTEST_LOG_(INFO) << "IsoImageBuilder_Joliet_001 end";
+}
+
+/**
+ * @tc.name: IsoImageBuilder_Isoinfo_001
+ * @tc.desc: Verify isoinfo reads back the -r attributes, the symlink targets and the file contents.
+ * @tc.type: FUNC
+ */
+HWTEST_F(IsoImageBuilderTest, IsoImageBuilder_Isoinfo_001, TestSize.Level1)
+{
+    GTEST_LOG_(INFO) << "IsoImageBuilder_Isoinfo_001 start";
+    if (!HasTool("isoinfo")) {
+        GTEST_SKIP() << "isoinfo is not installed";
+    }
+    IsoImageBuilder builder;
+    ASSERT_EQ(builder.Scan(SRC_DIR), E_OK);
+    int fd = open(IMAGE_PATH.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, S_IRUSR | S_IWUSR);
+    ASSERT_GE(fd, 0);
+    EXPECT_EQ(builder.WriteTo(fd), E_OK);
+    (void)close(fd);
+
+    Listing expected;
+    ListSourceAttrs(SRC_DIR, "", expected);
+    EXPECT_EQ(expected["README.TXT"].substr(0, 10), "-r-xr-xr-x");
+    EXPECT_EQ(expected["link"], "lr-xr-xr-x 0 0 0 -> Readme.txt");
+    EXPECT_EQ(IsoinfoListing(IMAGE_PATH, "-R"), expected);
+
+    Listing contents;
+    ListSource(SRC_DIR, "", contents);
+    for (const auto &[path, content] : contents) {
+        if (content == DIR_MARK || expected[path][0] == 'l') {
+            continue;
+        }
+        std::string extracted;
+        EXPECT_TRUE(RunTool({ "isoinfo", "-R", "-i", IMAGE_PATH, "-x", "/" + path }, extracted)) << path;
+        EXPECT_EQ(extracted, content) << path;
+    }
+    GTEST_LOG_(INFO) << "IsoImageBuilder_Isoinfo_001 end";
+}
+
+/**
+ * @tc.name: IsoImageBuilder_Genisoimage_001
+ * @tc.desc: Verify the Rock Ridge and Joliet trees read the same as those of "genisoimage -J -r -D -joliet-long".
+ * @tc.type: FUNC
+ */
+HWTEST_F(IsoImageBuilderTest, IsoImageBuilder_Genisoimage_001, TestSize.Level1)
+{
+    GTEST_LOG_(INFO) << "IsoImageBuilder_Genisoimage_001 start";
+    if (!HasTool("genisoimage") || !HasTool("isoinfo")) {
+        GTEST_SKIP() << "genisoimage or isoinfo is not installed";
+    }
+    const std::string refPath = TEST_ROOT + "/reference.iso";
+    std::string out;
+    ASSERT_TRUE(RunTool({ "genisoimage", "-quiet", "-V", "ISOIMAGE", "-J", "-r", "-D", "-joliet-long",
+        "-input-charset", "utf-8", "-output-charset", "utf-8", "-o", refPath, SRC_DIR }, out));
+    IsoImageBuilder builder;
+    ASSERT_EQ(builder.Scan(SRC_DIR), E_OK);
+    int fd = open(IMAGE_PATH.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, S_IRUSR | S_IWUSR);
+    ASSERT_GE(fd, 0);
+    EXPECT_EQ(builder.WriteTo(fd), E_OK);
+    (void)close(fd);
+
+    for (const char *tree : { "-R", "-J" }) {
+        Listing reference = IsoinfoListing(refPath, tree);
+        EXPECT_FALSE(reference.empty());
+        EXPECT_EQ(IsoinfoListing(IMAGE_PATH, tree), reference) << tree;
+    }
+    GTEST_LOG_(INFO) << "IsoImageBuilder_Genisoimage_001 end";
+}
+
+/**
+ * @tc.name: IsoImageBuilder_WriteTo_001
+ * @tc.desc: Verify WriteTo produces the same bytes as Stream.
+ * @tc.type: FUNC
+ */
+HWTEST_F(IsoImageBuilderTest, IsoImageBuilder_WriteTo_001, TestSize.Level1)
+{
+    GTEST_LOG_(INFO) << "IsoImageBuilder_WriteTo_001 start";
+    IsoImageOptions options;
+    options.createTime = 1700000000;
+    std::string streamed;
+    IsoImageBuilder builder(options);
+    ASSERT_EQ(builder.Scan(SRC_DIR), E_OK);
+    ASSERT_EQ(builder.Stream([&streamed](const uint8_t *data, size_t len) {
+        streamed.append(reinterpret_cast<const char *>(data), len);
+        return E_OK;
+    }), E_OK);
+    int fd = open(IMAGE_PATH.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, S_IRUSR | S_IWUSR);
+    ASSERT_GE(fd, 0);
+    EXPECT_EQ(builder.WriteTo(fd), E_OK);
+    (void)close(fd);
+    std::ifstream file(IMAGE_PATH, std::ios::binary);
+    std::string written((std::istreambuf_iterator<char>(file)), {});
+    EXPECT_EQ(written, streamed);
+    GTEST_LOG_(INFO) << "IsoImageBuilder_WriteTo_001 end";
+}
+
+/**
+ * @tc.name: IsoImageBuilder_Error_001
+ * @tc.desc: Verify scan errors, sink errors and a file changed after the scan fail the build.
+ * @tc.type: FUNC
+ */
+HWTEST_F(IsoImageBuilderTest, IsoImageBuilder_Error_001, TestSize.Level1)
+{
+    GTEST_LOG_(INFO) << "IsoImageBuilder_Error_001 start";
+    IsoImageBuilder builder;
+    auto discard = [](const uint8_t *, size_t) { return E_OK; };
+    EXPECT_EQ(builder.Stream(discard), E_ERR);
+    EXPECT_EQ(builder.Scan(TEST_ROOT + "/missing"), E_PARAMS_INVALID);
+    EXPECT_EQ(builder.Scan(SRC_DIR + "/Readme.txt"), E_PARAMS_INVALID);
+
+    ASSERT_EQ(builder.Scan(SRC_DIR), E_OK);
+    int calls = 0;
+    EXPECT_EQ(builder.Stream([&calls](const uint8_t *, size_t) { return ++calls > 1 ? E_ERR : E_OK; }), E_ERR);
+    EXPECT_EQ(calls, 2);
+
+    WriteTestFile(SRC_DIR + "/level.0/file0", "grown after the scan");
+    EXPECT_EQ(builder.Stream(discard), E_ERR);
+    GTEST_LOG_(INFO) << "IsoImageBuilder_Error_001 end";
+}
+
+/**
+ * @tc.name: IsoImageBuilder_Perf_001
+ * @tc.desc: Stream a 128 MiB tree to a consumer and report throughput and scratch space used on the source fs.
+ * @tc.type: PERF
+ */
+HWTEST_F(IsoImageBuilderTest, IsoImageBuilder_Perf_001, TestSize.Level3)
+{
+    GTEST_LOG_(INFO) << "IsoImageBuilder_Perf_001 start";
+    std::string content(PERF_FILE_SIZE, 'p');
+    for (size_t i = 0; i < PERF_FILE_COUNT; i++) {
+        WriteTestFile(SRC_DIR + "/perf" + std::to_string(i) + ".bin", content);
+    }
+    struct statvfs before {};
+    ASSERT_EQ(statvfs(TEST_ROOT.c_str(), &before), 0);
+    uint64_t minFree = static_cast<uint64_t>(before.f_bavail) * before.f_frsize;
+
+    IsoImageBuilder builder;
+    auto start = std::chrono::steady_clock::now();
+    ASSERT_EQ(builder.Scan(SRC_DIR), E_OK);
+    uint64_t streamed = 0;
+    ASSERT_EQ(builder.Stream([&](const uint8_t *, size_t len) {
+        streamed += len;
+        struct statvfs now {};
+        if (statvfs(TEST_ROOT.c_str(), &now) == 0) {
+            minFree = std::min<uint64_t>(minFree, static_cast<uint64_t>(now.f_bavail) * now.f_frsize);
+        }
+        return E_OK;
+    }), E_OK);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    EXPECT_EQ(streamed, builder.GetImageSize());
+    EXPECT_GE(streamed, PERF_FILE_COUNT * PERF_FILE_SIZE);
+    uint64_t scratch = static_cast<uint64_t>(before.f_bavail) * before.f_frsize - minFree;
+    // An image staged on disk would take at least its own size; streaming takes none.
+    EXPECT_LT(scratch, streamed / 2);
+    GTEST_LOG_(INFO) << "image " << streamed / MB << " MiB in " << seconds << " s, "
+                     << (seconds > 0 ? streamed / MB / seconds : 0) << " MiB/s, scratch " << scratch / MB << " MiB";
+    GTEST_LOG_(INFO) << "IsoImageBuilder_Perf_001 end";
+}
+} // namespace StorageDaemon
+} // namespace OHOS
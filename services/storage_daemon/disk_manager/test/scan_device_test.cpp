@@ -13,6 +13,9 @@
  * limitations under the License.
  */
 
+#include <atomic>
+#include <cstdarg>
+#include <dlfcn.h>
 #include <fcntl.h>
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
@@ -23,6 +26,44 @@
 
 #include "disk_manager/disk/scan_device.h"
 
+namespace {
+// Sysfs I/O issued by the code under test while g_countSysfsIo is set, counted by the interposers below.
+std::atomic<bool> g_countSysfsIo { false };
+std::atomic<uint32_t> g_sysfsOpenCount { 0 };
+std::atomic<uint32_t> g_sysfsReadCount { 0 };
+
+template <typename Func>
+Func NextSymbol(const char *name)
+{
+    return reinterpret_cast<Func>(dlsym(RTLD_NEXT, name));
+}
+}
+
+extern "C" int openat(int dirFd, const char *name, int flags, ...)
+{
+    mode_t mode = 0;
+    if ((flags & O_CREAT) != 0) {
+        va_list args;
+        va_start(args, flags);
+        mode = static_cast<mode_t>(va_arg(args, int));
+        va_end(args);
+    }
+    if (g_countSysfsIo) {
+        g_sysfsOpenCount++;
+    }
+    static auto next = NextSymbol<int (*)(int, const char *, int, ...)>("openat");
+    return next(dirFd, name, flags, mode);
+}
+
+extern "C" ssize_t pread(int fd, void *buf, size_t count, off_t offset)
+{
+    if (g_countSysfsIo) {
+        g_sysfsReadCount++;
+    }
+    static auto next = NextSymbol<ssize_t (*)(int, void *, size_t, off_t)>("pread");
+    return next(fd, buf, count, offset);
+}
+
 namespace OHOS {
 namespace StorageDaemon {
 using json = nlohmann::json;
@@ -30,6 +71,8 @@ using namespace testing;
 using namespace testing::ext;
 
 constexpr int CREATE_MODE = 0755;
+// Relative to mockSysPath, which stands in for /sys/block, so the fake tree stays under it.
+const std::string USB_DEVICE_LINK = "devices/usb2/2-1/2-1:1.0/host0";
 
 class ScanDeviceTest : public testing::Test {
 public:
@@ -45,6 +88,7 @@ public:
     void LinkDeviceAsInternalSata(const std::string &deviceName);
     void LinkDeviceAsInternalNvme(const std::string &deviceName);
     void LinkDeviceAsInternalNvmeWithAbsoluteSysPath(const std::string &deviceName);
+    void CreateUsbDevice(const std::string &deviceName);
 
     std::string mockSysPath;
 };
@@ -141,6 +185,25 @@ void ScanDeviceTest::LinkDeviceAsInternalNvmeWithAbsoluteSysPath(const std::stri
     symlink(absLinkTarget.c_str(), devicePath.c_str());
 }
 
+// A USB disk: busnum on the usb bus, devnum on the usb device, the disk nested below both.
+void ScanDeviceTest::CreateUsbDevice(const std::string &deviceName)
+{
+    std::string usbDevice = mockSysPath + "/devices/usb2/2-1";
+    std::string devicePath = usbDevice + "/2-1:1.0/host0/block/" + deviceName;
+    system(("mkdir -p " + devicePath + "/device " + devicePath + "/queue").c_str());
+    CreateFileWithContent(mockSysPath + "/devices/usb2/busnum", "2\n");
+    CreateFileWithContent(usbDevice + "/devnum", "9\n");
+    CreateFileWithContent(devicePath + "/size", " 2097152 \n");
+    CreateFileWithContent(devicePath + "/removable", "1\n");
+    CreateFileWithContent(devicePath + "/device/vendor", "UsbVendor\n");
+    CreateFileWithContent(devicePath + "/device/model", "UsbModel  \n");
+    CreateFileWithContent(devicePath + "/device/rev", "1.0\nbuild 7\n");
+    CreateFileWithContent(devicePath + "/queue/rotational", "1\n");
+    CreateFileWithContent(devicePath + "/dev", "8:16\n");
+    CreateFileWithContent(devicePath + "/uevent", "MAJOR=8\nMINOR=16\nDEVNAME=" + deviceName + "\n");
+    symlink((USB_DEVICE_LINK + "/block/" + deviceName).c_str(), (mockSysPath + "/" + deviceName).c_str());
+}
+
 /**
  * @tc.name: Storage_Service_ScanDeviceTest_GetDataDisks_001
  * @tc.desc: Test scanning data disks with empty directory
@@ -1867,5 +1930,81 @@ HWTEST_F(ScanDeviceTest, Storage_Service_ScanDeviceTest_GetScsiGenericDevPath_00
     GTEST_LOG_(INFO) << "GetScsiGenericDevPath_003 end";
 }
 
+/**
+ * @tc.name: Storage_Service_ScanDeviceTest_SysfsDeviceSnapshot_001
+ * @tc.desc: Verify the snapshot parses every node of a fake USB disk and inherits devnum/busnum from its parents.
+ * @tc.type: FUNC
+ */
+HWTEST_F(ScanDeviceTest, Storage_Service_ScanDeviceTest_SysfsDeviceSnapshot_001, TestSize.Level1)
+{
+    GTEST_LOG_(INFO) << "Storage_Service_ScanDeviceTest_SysfsDeviceSnapshot_001 start";
+    CreateUsbDevice("sdmock_u");
+
+    SysfsDeviceSnapshot snapshot;
+    ASSERT_TRUE(snapshot.Load(mockSysPath, "sdmock_u"));
+    EXPECT_EQ(snapshot.LinkTarget(), USB_DEVICE_LINK + "/block/sdmock_u");
+    std::string content;
+    EXPECT_TRUE(snapshot.ReadNode("/device/vendor", content));
+    EXPECT_EQ(content, "UsbVendor");
+    EXPECT_FALSE(snapshot.ReadNode("/device/serial", content));
+    EXPECT_EQ(snapshot.ReadContent("/device/rev"), "1.0\nbuild 7");
+    EXPECT_EQ(snapshot.ReadInherited("/devnum"), "9");
+    EXPECT_EQ(snapshot.ReadInherited("/busnum"), "2");
+
+    ScanDevice scanner(mockSysPath);
+    BlockInfo blockInfo;
+    EXPECT_EQ(scanner.GetBlockInfo("sdmock_u", false, blockInfo), 0);
+    EXPECT_EQ(blockInfo.sizeBytes, 1073741824ULL);
+    EXPECT_EQ(blockInfo.vendor, "UsbVendor");
+    EXPECT_EQ(blockInfo.model, "UsbModel");
+    EXPECT_EQ(blockInfo.devnum, "9");
+    EXPECT_EQ(blockInfo.busnum, "2");
+    EXPECT_EQ(blockInfo.fwVersion, "1.0\nbuild 7");
+    EXPECT_EQ(blockInfo.diskId, "disk-8-16");
+    EXPECT_EQ(blockInfo.rotational, 1);
+
+    SysfsDeviceSnapshot missing;
+    EXPECT_FALSE(missing.Load(mockSysPath, "sdmock_none"));
+    EXPECT_FALSE(missing.ReadNode("/size", content));
+    EXPECT_EQ(missing.ReadInherited("/devnum"), "");
+    GTEST_LOG_(INFO) << "Storage_Service_ScanDeviceTest_SysfsDeviceSnapshot_001 end";
+}
+
+/**
+ * @tc.name: Storage_Service_ScanDeviceTest_SysfsDeviceSnapshot_002
+ * @tc.desc: Verify each node is read once when the snapshot loads, and the getters do no further file I/O.
+ * @tc.type: FUNC
+ */
+HWTEST_F(ScanDeviceTest, Storage_Service_ScanDeviceTest_SysfsDeviceSnapshot_002, TestSize.Level1)
+{
+    GTEST_LOG_(INFO) << "Storage_Service_ScanDeviceTest_SysfsDeviceSnapshot_002 start";
+    CreateUsbDevice("sdmock_u");
+
+    g_sysfsOpenCount = 0;
+    g_sysfsReadCount = 0;
+    g_countSysfsIo = true;
+    SysfsDeviceSnapshot snapshot;
+    ASSERT_TRUE(snapshot.Load(mockSysPath, "sdmock_u"));
+    // size, removable, vendor, model, rotational, dev, uevent and rev exist; serial does not.
+    // devnum is found on the usb device, busnum one level further up.
+    EXPECT_EQ(g_sysfsReadCount, 8U + 2U);
+    uint32_t opens = g_sysfsOpenCount;
+    GTEST_LOG_(INFO) << "snapshot load: " << opens << " openat, " << g_sysfsReadCount << " pread";
+
+    ScanDevice scanner(mockSysPath);
+    g_sysfsOpenCount = 0;
+    g_sysfsReadCount = 0;
+    EXPECT_EQ(scanner.GetDiskSize(snapshot, "sdmock_u"), 1073741824ULL);
+    EXPECT_EQ(scanner.GetVendor(snapshot), "UsbVendor");
+    EXPECT_EQ(scanner.GetModel(snapshot), "UsbModel");
+    EXPECT_EQ(scanner.GetRotational(snapshot), 1);
+    EXPECT_EQ(scanner.GetDiskId(snapshot, "sdmock_u", false), "disk-8-16");
+    EXPECT_EQ(scanner.GetFwVersion(snapshot), "1.0\nbuild 7");
+    g_countSysfsIo = false;
+    EXPECT_EQ(g_sysfsOpenCount, 0U);
+    EXPECT_EQ(g_sysfsReadCount, 0U);
+    GTEST_LOG_(INFO) << "Storage_Service_ScanDeviceTest_SysfsDeviceSnapshot_002 end";
+}
+
 } // namespace StorageDaemon
 } // namespace OHOS
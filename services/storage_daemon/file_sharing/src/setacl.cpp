@@ -13,18 +13,29 @@
  * limitations under the License.
  */
 
+#include <algorithm>
+#include <atomic>
+#include <cinttypes>
+#include <dirent.h>
+#include <fcntl.h>
 #include <grp.h>
 #include <pwd.h>
 #include <sys/stat.h>
 #include <sys/xattr.h>
 #include <string>
+#include <thread>
 #include <unistd.h>
+#include <vector>
 
 #include "file_sharing/acl.h"
+#include "file_sharing/endian.h"
 #include "securec.h"
 #include "storage_service_log.h"
 
 constexpr int BUF_SIZE = 400;
+constexpr size_t ACL_TREE_MAX_WORKERS = 8;
+// Room for the largest ACL Acl accepts (100 entries).
+constexpr size_t ACL_TREE_XATTR_BUF_SIZE = 4 + 8 * 100;
 using namespace std;
 namespace OHOS {
 namespace StorageDaemon {
@@ -206,33 +217,37 @@ AclXattrEntry AclEntryParseText(const std::string &entryTxt)
     return entry;
 }
 
-Acl AclFromMode(const std::string &file)
+void AclInsertModeEntries(Acl &acl, mode_t mode)
 {
-    Acl acl;
-    struct stat st;
-
-    if (stat(file.c_str(), &st) == -1) {
-        LOGE("[L3:FileSharing] AclFromMode: <<< EXIT FAILED <<< file=%{public}s, stat failed, errno=%{public}d",
-             file.c_str(), errno);
-        return acl;
-    }
-
     acl.InsertEntry(
         { .tag = ACL_TAG::USER_OBJ,
-          .perm = (st.st_mode & S_IRWXU) >> 6,
+          .perm = (mode & S_IRWXU) >> 6,
           .id = AclXattrHeader::ACL_UNDEFINED_ID, }
     );
     acl.InsertEntry(
         { .tag = ACL_TAG::GROUP_OBJ,
-          .perm = (st.st_mode & S_IRWXG) >> 3,
+          .perm = (mode & S_IRWXG) >> 3,
           .id = AclXattrHeader::ACL_UNDEFINED_ID, }
     );
     acl.InsertEntry(
         { .tag = ACL_TAG::OTHER,
-          .perm = (st.st_mode & S_IRWXO),
+          .perm = (mode & S_IRWXO),
           .id = AclXattrHeader::ACL_UNDEFINED_ID, }
     );
+}
+
+Acl AclFromMode(const std::string &file)
+{
+    Acl acl;
+    struct stat st;
+
+    if (stat(file.c_str(), &st) == -1) {
+        LOGE("[L3:FileSharing] AclFromMode: <<< EXIT FAILED <<< file=%{public}s, stat failed, errno=%{public}d",
+             file.c_str(), errno);
+        return acl;
+    }
 
+    AclInsertModeEntries(acl, st.st_mode);
     LOGD("[L3:FileSharing] AclFromMode: <<< EXIT SUCCESS <<< file=%{public}s", file.c_str());
     return acl;
 }
@@ -252,6 +267,225 @@ Acl AclFromFile(const std::string &file)
     return AclFromMode(file);
 }
 
+
+uint16_t AclPermBits(const ACL_PERM &perm)
+{
+    return (perm.IsReadable() ? S_IROTH : 0) | (perm.IsWritable() ? S_IWOTH : 0) |
+        (perm.IsExecutable() ? S_IXOTH : 0);
+}
+
+/*
+ * Whether a serialized ACL already holds the entry with the same permissions. A named USER/GROUP
+ * entry only counts if the MASK lets its permissions through, otherwise Acl would recompute the mask.
+ */
+bool AclXattrGrants(const char *buf, size_t len, const AclXattrEntry &entry)
+{
+    if (len < sizeof(AclXattrHeader)) {
+        return false;
+    }
+    bool needMask = entry.tag == ACL_TAG::USER || entry.tag == ACL_TAG::GROUP;
+    bool found = false;
+    bool maskCovers = !needMask;
+    uint16_t want = AclPermBits(entry.perm);
+    const AclXattrEntry *e = reinterpret_cast<const AclXattrEntry *>(buf + sizeof(AclXattrHeader));
+    for (size_t n = (len - sizeof(AclXattrHeader)) / sizeof(AclXattrEntry); n > 0; n--, e++) {
+        ACL_TAG tag = LeToCpu(e->tag);
+        if (tag == entry.tag && LeToCpu(e->id) == entry.id) {
+            found = AclPermBits(e->perm) == want;
+        } else if (needMask && tag == ACL_TAG::MASK) {
+            maskCovers = (AclPermBits(e->perm) & want) == want;
+        }
+    }
+    return found && maskCovers;
+}
+
+struct AclTreeWorker {
+    std::vector<char> buf = std::vector<char>(ACL_TREE_XATTR_BUF_SIZE);
+    AclTreeResult result;
+};
+
+/*
+ * Walks a tree with fds opened relative to the parent. Files directly under the root are handled
+ * by the caller; the root's subdirectories are handed out to up to options.workers threads, each
+ * of which walks its subtrees depth-first with its own xattr buffer.
+ */
+class AclTreeWalker {
+public:
+    AclTreeWalker(const AclXattrEntry &entry, const AclTreeOptions &options) : entry_(entry), options_(options) {}
+
+    void Run(int rootFd, AclTreeResult &result)
+    {
+        AclTreeWorker main;
+        Apply(rootFd, true, main);
+        std::vector<std::string> subDirs;
+        int listFd = dup(rootFd);
+        DIR *dir = listFd < 0 ? nullptr : fdopendir(listFd);
+        if (dir == nullptr) {
+            Fail("root", main);
+            if (listFd >= 0) {
+                (void)close(listFd);
+            }
+            result = main.result;
+            return;
+        }
+        for (struct dirent *ent = readdir(dir); ent != nullptr; ent = readdir(dir)) {
+            unsigned char type = EntryType(rootFd, ent);
+            if (type == DT_DIR) {
+                subDirs.emplace_back(ent->d_name);
+            } else if (type == DT_REG) {
+                ApplyAt(rootFd, ent->d_name, main);
+            }
+        }
+        (void)closedir(dir);
+
+        size_t workers = std::min({ std::max<size_t>(options_.workers, 1), ACL_TREE_MAX_WORKERS, subDirs.size() });
+        std::vector<AclTreeWorker> states(workers > 1 ? workers - 1 : 0);
+        std::vector<std::thread> threads;
+        for (auto &state : states) {
+            threads.emplace_back([this, rootFd, &subDirs, &state]() { Work(rootFd, subDirs, state); });
+        }
+        Work(rootFd, subDirs, main);
+        for (auto &thread : threads) {
+            thread.join();
+        }
+        result = main.result;
+        for (const auto &state : states) {
+            result.changed += state.result.changed;
+            result.skipped += state.result.skipped;
+            result.failed += state.result.failed;
+        }
+    }
+
+private:
+    void Work(int rootFd, const std::vector<std::string> &subDirs, AclTreeWorker &worker)
+    {
+        for (size_t i = next_++; i < subDirs.size(); i = next_++) {
+            int fd = openat(rootFd, subDirs[i].c_str(), O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+            if (fd < 0) {
+                Fail(subDirs[i].c_str(), worker);
+                continue;
+            }
+            WalkDir(fd, worker);
+        }
+    }
+
+    // Applies the entry to dirFd and everything below it, and closes dirFd.
+    void WalkDir(int dirFd, AclTreeWorker &worker)
+    {
+        Apply(dirFd, true, worker);
+        DIR *dir = fdopendir(dirFd);
+        if (dir == nullptr) {
+            Fail("dir", worker);
+            (void)close(dirFd);
+            return;
+        }
+        for (struct dirent *ent = readdir(dir); ent != nullptr; ent = readdir(dir)) {
+            unsigned char type = EntryType(dirFd, ent);
+            if (type == DT_DIR) {
+                int fd = openat(dirFd, ent->d_name, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+                if (fd < 0) {
+                    Fail(ent->d_name, worker);
+                    continue;
+                }
+                WalkDir(fd, worker);
+            } else if (type == DT_REG) {
+                ApplyAt(dirFd, ent->d_name, worker);
+            }
+        }
+        (void)closedir(dir);
+    }
+
+    // Directories and regular files only; dot entries, symlinks and special files are left alone.
+    static unsigned char EntryType(int dirFd, const struct dirent *ent)
+    {
+        if (strcmp(ent->d_name, ".") == 0 || strcmp(ent->d_name, "..") == 0) {
+            return DT_UNKNOWN;
+        }
+        if (ent->d_type != DT_UNKNOWN) {
+            return ent->d_type;
+        }
+        struct stat st;
+        if (fstatat(dirFd, ent->d_name, &st, AT_SYMLINK_NOFOLLOW) != 0) {
+            return DT_UNKNOWN;
+        }
+        if (S_ISDIR(st.st_mode)) {
+            return DT_DIR;
+        }
+        return S_ISREG(st.st_mode) ? DT_REG : DT_UNKNOWN;
+    }
+
+    void ApplyAt(int dirFd, const char *name, AclTreeWorker &worker)
+    {
+        // O_NONBLOCK: the file may have been swapped for a fifo since readdir.
+        int fd = openat(dirFd, name, O_RDONLY | O_NOFOLLOW | O_NONBLOCK | O_CLOEXEC);
+        if (fd < 0) {
+            Fail(name, worker);
+            return;
+        }
+        Apply(fd, false, worker);
+        (void)close(fd);
+    }
+
+    void Apply(int fd, bool isDir, AclTreeWorker &worker)
+    {
+        bool changed = false;
+        bool ok = ApplyAttr(fd, options_.accessAttr, worker, changed);
+        if (ok && isDir && options_.defaultAttr != nullptr) {
+            ok = ApplyAttr(fd, options_.defaultAttr, worker, changed);
+        }
+        if (!ok) {
+            Fail("inode", worker);
+        } else if (changed) {
+            worker.result.changed++;
+        } else {
+            worker.result.skipped++;
+        }
+    }
+
+    bool ApplyAttr(int fd, const char *attrName, AclTreeWorker &worker, bool &changed)
+    {
+        ssize_t len = fgetxattr(fd, attrName, worker.buf.data(), worker.buf.size());
+        if (len >= 0 && AclXattrGrants(worker.buf.data(), static_cast<size_t>(len), entry_)) {
+            return true;
+        }
+        Acl acl;
+        if (len >= 0) {
+            if (acl.DeSerialize(worker.buf.data(), static_cast<size_t>(len)) != 0) {
+                return false;
+            }
+        } else if (errno == ENODATA) {
+            struct stat st;
+            if (fstat(fd, &st) != 0) {
+                return false;
+            }
+            AclInsertModeEntries(acl, st.st_mode);
+        } else {
+            return false;
+        }
+        if (acl.InsertEntry(entry_) != 0) {
+            return false;
+        }
+        size_t bufSize = 0;
+        char *buf = acl.Serialize(bufSize);
+        if (buf == nullptr || fsetxattr(fd, attrName, buf, bufSize, 0) != 0) {
+            return false;
+        }
+        changed = true;
+        return true;
+    }
+
+    void Fail(const char *name, AclTreeWorker &worker)
+    {
+        if (worker.result.failed++ == 0) {
+            LOGE("[L3:FileSharing] AclSetTree: apply to %{public}s failed, errno=%{public}d", name, errno);
+        }
+    }
+
+    const AclXattrEntry entry_;
+    const AclTreeOptions &options_;
+    std::atomic<size_t> next_ { 0 };
+};
+
 } // anonymous namespace
 
 int AclSetAttribution(const std::string &targetFile, const std::string &entryTxt, const char *aclAttrName)
@@ -343,6 +577,36 @@ int AclSetAccess(const std::string &targetFile, const std::string &entryTxt)
     }
     return ret;
 }
+
+int AclSetTree(const std::string &root, const std::string &entryTxt, const AclTreeOptions &options,
+               AclTreeResult &result)
+{
+    LOGI("[L3:FileSharing] AclSetTree: >>> ENTER <<< root=%{public}s, entryTxt=%{public}s", root.c_str(),
+         entryTxt.c_str());
+    result = {};
+    AclXattrEntry entry = AclEntryParseText(entryTxt);
+    if (!entry.IsValid()) {
+        LOGE("[L3:FileSharing] AclSetTree: <<< EXIT FAILED <<< parse failed, entryTxt=%{public}s", entryTxt.c_str());
+        return -1;
+    }
+    int rootFd = open(root.c_str(), O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+    if (rootFd < 0) {
+        LOGE("[L3:FileSharing] AclSetTree: <<< EXIT FAILED <<< open root failed, root=%{public}s, errno=%{public}d",
+             root.c_str(), errno);
+        return -1;
+    }
+    AclTreeWalker walker(entry, options);
+    walker.Run(rootFd, result);
+    (void)close(rootFd);
+    if (result.failed != 0) {
+        LOGE("[L3:FileSharing] AclSetTree: <<< EXIT FAILED <<< changed=%{public}" PRIu64 ", skipped=%{public}"
+             PRIu64 ", failed=%{public}" PRIu64, result.changed, result.skipped, result.failed);
+        return -1;
+    }
+    LOGI("[L3:FileSharing] AclSetTree: <<< EXIT SUCCESS <<< changed=%{public}" PRIu64 ", skipped=%{public}" PRIu64,
+         result.changed, result.skipped);
+    return 0;
+}
 } // namespace StorageDaemon
 } // namespace OHOS
 
@@ -12,11 +12,15 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+#include <chrono>
 #include <cstdio>
 #include <cstdlib>
 #include <ctime>
 
 #include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/xattr.h>
+#include <unistd.h>
 
 #include <gtest/gtest.h>
 
@@ -30,6 +34,39 @@ using namespace OHOS::StorageDaemon;
 namespace {
 const std::string PATH_TEST = "/data/file_sharing_setacl_test";
 std::string randomId = "0";
+const std::string PATH_TREE = "/data/file_sharing_acl_tree_test";
+// user.* xattrs: the tree walk is tested without the kernel's POSIX ACL checks.
+constexpr const char *TREE_ACCESS_ATTR = "user.acl_tree_access";
+constexpr const char *TREE_DEFAULT_ATTR = "user.acl_tree_default";
+constexpr size_t TREE_XATTR_BUF_SIZE = 1024;
+
+// Whether the ACL stored in attr has an entry for tag/id with exactly the perm bits rwx.
+bool XattrHasEntry(const std::string &path, const char *attr, ACL_TAG tag, uint32_t id, const std::string &rwx)
+{
+    char buf[TREE_XATTR_BUF_SIZE] = { 0 };
+    ssize_t len = lgetxattr(path.c_str(), attr, buf, sizeof(buf));
+    if (len < static_cast<ssize_t>(sizeof(AclXattrHeader))) {
+        return false;
+    }
+    const AclXattrEntry *e = reinterpret_cast<const AclXattrEntry *>(buf + sizeof(AclXattrHeader));
+    for (size_t n = (len - sizeof(AclXattrHeader)) / sizeof(AclXattrEntry); n > 0; n--, e++) {
+        if (e->tag == tag && e->id == id) {
+            std::string perm = std::string(e->perm.IsReadable() ? "r" : "-") + (e->perm.IsWritable() ? "w" : "-") +
+                (e->perm.IsExecutable() ? "x" : "-");
+            return perm == rwx;
+        }
+    }
+    return false;
+}
+
+void MakeTreeFiles(const std::string &dir, int count)
+{
+    for (int i = 0; i < count; i++) {
+        int fd = creat((dir + "/f" + std::to_string(i)).c_str(), S_IRUSR | S_IWUSR | S_IRGRP);
+        ASSERT_GE(fd, 0);
+        close(fd);
+    }
+}
 
 class SetAclTest : public testing::Test {
 public:
@@ -334,5 +371,122 @@ HWTEST_F(SetAclTest, SetAclTest_007, TestSize.Level1)
 
     GTEST_LOG_(INFO) << "SetAclTest_007 ends";
 }
+
+/**
+ * @tc.name: SetAclTest_AclSetTree_001
+ * @tc.desc: Verify AclSetTree grants the entry on every directory and file and is idempotent.
+ * @tc.type: FUNC
+ * @tc.require: AR000I1L48
+ */
+HWTEST_F(SetAclTest, SetAclTest_AclSetTree_001, TestSize.Level1)
+{
+    GTEST_LOG_(INFO) << "SetAclTest_AclSetTree_001 starts";
+    RmDirRecurse(PATH_TREE);
+    const int topDirs = 3;
+    const int filesPerDir = 5;
+    ASSERT_TRUE(MkDirRecurse(PATH_TREE + "/outside", S_IRWXU));
+    MakeTreeFiles(PATH_TREE + "/outside", 1);
+    ASSERT_TRUE(MkDirRecurse(PATH_TREE + "/root", S_IRWXU));
+    MakeTreeFiles(PATH_TREE + "/root", 1);
+    for (int i = 0; i < topDirs; i++) {
+        std::string dir = PATH_TREE + "/root/d" + std::to_string(i);
+        ASSERT_TRUE(MkDirRecurse(dir + "/sub", S_IRWXU));
+        MakeTreeFiles(dir, filesPerDir);
+        MakeTreeFiles(dir + "/sub", 1);
+    }
+    ASSERT_EQ(symlink((PATH_TREE + "/outside/f0").c_str(), (PATH_TREE + "/root/d0/link").c_str()), 0);
+    ASSERT_EQ(mkfifo((PATH_TREE + "/root/d1/fifo").c_str(), S_IRUSR | S_IWUSR), 0);
+
+    AclTreeOptions options;
+    options.accessAttr = TREE_ACCESS_ATTR;
+    options.defaultAttr = TREE_DEFAULT_ATTR;
+    options.workers = 4;
+    AclTreeResult result;
+    EXPECT_EQ(AclSetTree(PATH_TREE + "/root", "g:1006:rwx", options, result), 0);
+    const uint64_t inodes = 1 + 1 + topDirs * (1 + filesPerDir + 1 + 1);
+    EXPECT_EQ(result.changed, inodes);
+    EXPECT_EQ(result.failed, 0U);
+
+    EXPECT_TRUE(XattrHasEntry(PATH_TREE + "/root", TREE_DEFAULT_ATTR, ACL_TAG::GROUP, 1006, "rwx"));
+    EXPECT_TRUE(XattrHasEntry(PATH_TREE + "/root/d2/sub", TREE_DEFAULT_ATTR, ACL_TAG::GROUP, 1006, "rwx"));
+    EXPECT_TRUE(XattrHasEntry(PATH_TREE + "/root/d2/sub/f0", TREE_ACCESS_ATTR, ACL_TAG::GROUP, 1006, "rwx"));
+    EXPECT_TRUE(XattrHasEntry(PATH_TREE + "/root/d1/f4", TREE_ACCESS_ATTR, ACL_TAG::MASK,
+        AclXattrHeader::ACL_UNDEFINED_ID, "rwx"));
+    EXPECT_FALSE(XattrHasEntry(PATH_TREE + "/root/d1/f4", TREE_DEFAULT_ATTR, ACL_TAG::GROUP, 1006, "rwx"));
+    EXPECT_FALSE(XattrHasEntry(PATH_TREE + "/outside/f0", TREE_ACCESS_ATTR, ACL_TAG::GROUP, 1006, "rwx"));
+
+    EXPECT_EQ(AclSetTree(PATH_TREE + "/root", "g:1006:rwx", options, result), 0);
+    EXPECT_EQ(result.changed, 0U);
+    EXPECT_EQ(result.skipped, inodes);
+
+    EXPECT_EQ(AclSetTree(PATH_TREE + "/root", "w:1006:rwx", options, result), -1);
+    EXPECT_EQ(AclSetTree(PATH_TREE + "/none", "g:1006:rwx", options, result), -1);
+    RmDirRecurse(PATH_TREE);
+    GTEST_LOG_(INFO) << "SetAclTest_AclSetTree_001 ends";
+}
+
+/**
+ * @tc.name: SetAclTest_AclSetTree_002
+ * @tc.desc: Verify AclSetTree updates a differing entry and keeps the other entries.
+ * @tc.type: FUNC
+ * @tc.require: AR000I1L48
+ */
+HWTEST_F(SetAclTest, SetAclTest_AclSetTree_002, TestSize.Level1)
+{
+    GTEST_LOG_(INFO) << "SetAclTest_AclSetTree_002 starts";
+    RmDirRecurse(PATH_TREE);
+    ASSERT_TRUE(MkDirRecurse(PATH_TREE + "/d", S_IRWXU));
+    MakeTreeFiles(PATH_TREE + "/d", 2);
+
+    AclTreeOptions options;
+    options.accessAttr = TREE_ACCESS_ATTR;
+    AclTreeResult result;
+    ASSERT_EQ(AclSetTree(PATH_TREE, "u:1000:r--", options, result), 0);
+    ASSERT_EQ(AclSetTree(PATH_TREE, "g:1006:r--", options, result), 0);
+    EXPECT_EQ(result.changed, 4U);
+    ASSERT_EQ(AclSetTree(PATH_TREE, "g:1006:rw-", options, result), 0);
+    EXPECT_EQ(result.changed, 4U);
+
+    std::string file = PATH_TREE + "/d/f1";
+    EXPECT_TRUE(XattrHasEntry(file, TREE_ACCESS_ATTR, ACL_TAG::GROUP, 1006, "rw-"));
+    EXPECT_TRUE(XattrHasEntry(file, TREE_ACCESS_ATTR, ACL_TAG::USER, 1000, "r--"));
+    EXPECT_TRUE(XattrHasEntry(file, TREE_ACCESS_ATTR, ACL_TAG::USER_OBJ, AclXattrHeader::ACL_UNDEFINED_ID, "rw-"));
+    RmDirRecurse(PATH_TREE);
+    GTEST_LOG_(INFO) << "SetAclTest_AclSetTree_002 ends";
+}
+
+/**
+ * @tc.name: SetAclTest_AclSetTree_Perf_001
+ * @tc.desc: Log AclSetTree time on 100k files, for the first pass and for an already granted tree.
+ * @tc.type: PERF
+ * @tc.require: AR000I1L48
+ */
+HWTEST_F(SetAclTest, SetAclTest_AclSetTree_Perf_001, TestSize.Level3)
+{
+    GTEST_LOG_(INFO) << "SetAclTest_AclSetTree_Perf_001 starts";
+    RmDirRecurse(PATH_TREE);
+    const int dirCount = 100;
+    const int filesPerDir = 1000;
+    for (int i = 0; i < dirCount; i++) {
+        std::string dir = PATH_TREE + "/d" + std::to_string(i);
+        ASSERT_TRUE(MkDirRecurse(dir, S_IRWXU));
+        MakeTreeFiles(dir, filesPerDir);
+    }
+    AclTreeOptions options;
+    options.accessAttr = TREE_ACCESS_ATTR;
+    options.defaultAttr = TREE_DEFAULT_ATTR;
+    options.workers = 4;
+    AclTreeResult result;
+    for (const char *pass : { "first", "repeat" }) {
+        auto start = std::chrono::steady_clock::now();
+        EXPECT_EQ(AclSetTree(PATH_TREE, "g:1006:rwx", options, result), 0);
+        auto cost = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+        GTEST_LOG_(INFO) << pass << " pass: changed " << result.changed << ", skipped " << result.skipped << " in "
+                         << cost.count() << " ms";
+    }
+    EXPECT_EQ(result.skipped, static_cast<uint64_t>(1 + dirCount * (1 + filesPerDir)));
+    RmDirRecurse(PATH_TREE);
+    GTEST_LOG_(INFO) << "SetAclTest_AclSetTree_Perf_001 ends";
+}
 }
 
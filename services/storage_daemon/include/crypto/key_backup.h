@@ -16,7 +16,10 @@
 #ifndef STORAGE_DAEMON_KEY_BACKUP_H
 #define STORAGE_DAEMON_KEY_BACKUP_H
 
+#include <functional>
+#include <mutex>
 #include <sys/stat.h>
+#include <unordered_map>
 
 #include "base_key.h"
 
@@ -28,6 +31,20 @@ struct FileAttr {
     mode_t mode {};
 };
 
+struct KeyFileStamp {
+    dev_t dev {};
+    ino_t ino {};
+    off_t size {};
+    int64_t mtimeNs {};
+    int64_t ctimeNs {};
+
+    bool operator==(const KeyFileStamp &other) const
+    {
+        return dev == other.dev && ino == other.ino && size == other.size && mtimeNs == other.mtimeNs &&
+            ctimeNs == other.ctimeNs;
+    }
+};
+
 class KeyBackup {
 public:
     static KeyBackup &GetInstance()
@@ -57,7 +74,11 @@ private:
     int32_t MkdirParentWithRetry(const std::string &pathName, mode_t mode);
     void CleanFile(const std::string &path);
     void CheckAndCopyFiles(const std::string &from, const std::string &to);
+    void RemoveStaleCopies(const std::string &dir);
     int32_t CheckAndCopyOneFile(const std::string &from, const std::string &to);
+    int32_t CopyFileIfChanged(const std::string &srcFile, const std::string &dstFile, bool &copied);
+    bool IsSyncedPair(const std::string &dstFile, const struct stat &srcSt, const struct stat &dstSt);
+    void RememberSyncedPair(const std::string &dstFile, const struct stat &srcSt, const struct stat &dstSt);
     bool GetRealPath(const std::string &path, std::string &realPath);
     int32_t CompareFile(const std::string &fileA, const std::string fileB);
     int32_t GetAttr(const std::string &path, struct FileAttr &attr);
@@ -65,7 +86,7 @@ private:
     int32_t HandleCopyDir(const std::string &from, const std::string &to);
     void CheckAndFixFiles(const std::string &from, const std::string &to);
     int32_t GetFileList(const std::string &origDir, const std::string &backDir,
-        std::vector<struct FileNode> &fileListm, uint32_t diffNum);
+        std::vector<struct FileNode> &fileListm, uint32_t &diffNum);
     void AddOrigFileToList(const std::string &fileName, const std::string &origDir,
         std::vector<struct FileNode> &fileList);
     void AddBackupFileToList(const std::string &fileName, const std::string &backDir,
@@ -77,14 +98,23 @@ private:
     uint32_t GetLoopMaxNum(uint32_t diffNum);
     int32_t CopyMixFilesToTempDir(uint32_t diffNum, uint32_t num, const std::string &tempDir,
         const std::vector<struct FileNode> &fileList);
+    int32_t PickIntactFilesToTempDir(const std::string &tempDir, std::vector<struct FileNode> &fileList);
+    bool IsKeyFileIntact(const std::string &fileName, const std::string &filePath);
+    int32_t StageFile(const std::string &from, const std::string &to);
     bool IsRegFile(const std::string &filePath);
     int32_t DoResotreKeyMix(std::shared_ptr<BaseKey> &baseKey, const UserAuth &auth, const std::string &keyDir,
         const std::string &backupDir);
+    int32_t RestoreKeyMix(const std::string &keyDir, const std::string &backupDir,
+        const std::function<bool(const std::string &)> &tryRestore);
 
 private:
     constexpr static mode_t DEFAULT_DIR_PERM = 0700;
     constexpr static mode_t DEFAULT_WRITE_FILE_PERM = 0644;
     constexpr static uint32_t MAX_FILE_NUM = 5;
+
+    // dst path -> (src, dst) stamps of a pair last seen with identical content
+    std::mutex syncedPairsMutex_;
+    std::unordered_map<std::string, std::pair<KeyFileStamp, KeyFileStamp>> syncedPairs_;
 };
 } // namespace StorageDaemon
 } // namespace OHOS
@@ -21,6 +21,8 @@
 #include "ipc/storage_daemon.h"
 #include "utils/file_utils.h"
 
+struct FscryptPolicyContext;
+
 namespace OHOS {
 namespace StorageDaemon {
 constexpr const char *USER_EL1_DIR = "/data/service/el1/public/storage_daemon/sd/el1";
@@ -192,6 +194,9 @@ private:
     int CheckNeedRestoreVersion(unsigned int user, KeyType type);
     int GenerateAppkeyWithRecover(uint32_t userId, uint32_t hashId, std::string &keyId);
     int UpdateClassEBackUpFix(uint32_t userId);
+    int LoadDirectoryElPolicy(unsigned int user, KeyType type, FscryptPolicyContext &ctx);
+    int ApplyDirectoryElPolicy(unsigned int user, KeyType type, const FscryptPolicyContext &ctx,
+                               const std::vector<FileList> &vec);
 
 #ifdef RECOVER_KEY_TEE_ENVIRONMENT
     int32_t FileBasedEncryptfsMount();
@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2026 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef STORAGE_DAEMON_CRYPTO_USER_KEY_STATE_H
+#define STORAGE_DAEMON_CRYPTO_USER_KEY_STATE_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+
+namespace OHOS {
+namespace StorageDaemon {
+constexpr int64_t KEY_STATE_SELF_CHECK_MS = 10 * 60 * 1000;
+constexpr size_t KEY_STATE_MAX_USERS = 64;
+
+enum class CeKeyState : uint32_t {
+    UNKNOWN = 0,
+    LOCKED,     // EL2 key not active: CE storage is encrypted
+    UNLOCKED,
+};
+
+struct UserKeyStatus {
+    CeKeyState ce = CeKeyState::UNKNOWN;
+    bool screenLocked = false;
+    bool fromProbe = false;     // seeded by the probe, not by a key operation
+    uint64_t generation = 0;    // bumped whenever the CE storage turns ready or not ready
+};
+
+// Probes whether the CE storage of a user is still encrypted; isEncrypted is valid on E_OK.
+using CeProbeFunc = std::function<int32_t(uint32_t userId, bool &isEncrypted)>;
+
+/*
+ * Per-user key state as set by the key operations (ActiveUserKey, InActiveUserKey, LockUserScreen,
+ * UnlockUserScreen), so a CE status query is an atomic load instead of a file write. Users without
+ * a recorded operation, e.g. after a daemon restart, are probed; a probe finding the storage
+ * decrypted seeds the table and is rechecked with a plain access() after that. States set by key
+ * operations are rechecked with the probe once per self-check interval, and the probe wins on a
+ * mismatch.
+ */
+class UserKeyStateTable {
+public:
+    static UserKeyStateTable &GetInstance();
+    // The write probe: CE storage is decrypted when a file can be created in baseDir.
+    static int32_t ProbeByWrite(const std::string &baseDir, bool &isEncrypted);
+
+    UserKeyStateTable(CeProbeFunc probe, std::function<bool(uint32_t userId)> exists,
+        int64_t selfCheckMs = KEY_STATE_SELF_CHECK_MS);
+    UserKeyStateTable(const UserKeyStateTable &) = delete;
+    UserKeyStateTable &operator=(const UserKeyStateTable &) = delete;
+
+    void OnCeActivated(uint32_t userId);
+    void OnCeInactivated(uint32_t userId);
+    void OnScreenLocked(uint32_t userId);
+    void OnScreenUnlocked(uint32_t userId);
+    // Back to UNKNOWN, e.g. when an operation failed halfway.
+    void Invalidate(uint32_t userId);
+    // Frees the slot of a user whose keys are deleted, so a later user can take it.
+    void Release(uint32_t userId);
+
+    // Lock-free; false for a user that has no entry.
+    bool Get(uint32_t userId, UserKeyStatus &status) const;
+    int32_t GetCeEncrypted(uint32_t userId, bool &isEncrypted);
+
+private:
+    struct Slot {
+        std::atomic<int64_t> userId { -1 };
+        std::atomic<uint64_t> word { 0 };
+        std::atomic<int64_t> nextCheckMs { 0 };
+    };
+
+    const Slot *Find(uint32_t userId) const;
+    // Reads the word of slot, false when the slot was released or handed to another user meanwhile.
+    static bool Load(const Slot &slot, uint32_t userId, UserKeyStatus &status);
+    Slot *FindOrAdd(uint32_t userId);
+    void Update(uint32_t userId, const std::function<void(UserKeyStatus &status)> &change);
+    void ApplyProbe(uint32_t userId, bool isEncrypted, bool selfCheck);
+
+    CeProbeFunc probe_;
+    std::function<bool(uint32_t userId)> exists_;
+    int64_t selfCheckMs_;
+    std::mutex addMutex_;
+    std::array<Slot, KEY_STATE_MAX_USERS> slots_;
+};
+} // namespace StorageDaemon
+} // namespace OHOS
+
+#endif // STORAGE_DAEMON_CRYPTO_USER_KEY_STATE_H
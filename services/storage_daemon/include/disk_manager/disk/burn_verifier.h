@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2026 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef OHOS_STORAGE_DAEMON_BURN_VERIFIER_H
+#define OHOS_STORAGE_DAEMON_BURN_VERIFIER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace OHOS {
+namespace StorageDaemon {
+
+/**
+ * @brief Per-extent digests of the image that was written to a disc.
+ *
+ * Extent i covers image bytes [i * extentBytes, (i + 1) * extentBytes) and sits on the
+ * medium at LBA startLba + i * extentSectors.
+ */
+struct BurnManifest {
+    uint32_t sectorSize = 2048;
+    uint32_t extentSectors = 512;
+    uint64_t startLba = 0;
+    uint64_t totalBytes = 0;
+    std::vector<std::string> digests;
+
+    uint64_t ExtentBytes() const { return static_cast<uint64_t>(sectorSize) * extentSectors; }
+};
+
+/**
+ * @brief Takes the extent digests of an image chunk by chunk, from an image file or from the bytes of
+ * an image built on the fly as they go to the burner.
+ */
+class BurnManifestRecorder {
+public:
+    explicit BurnManifestRecorder(uint64_t startLba);
+
+    void Update(const uint8_t *data, size_t len);
+    // Digests the partial last extent; call once, after the last Update.
+    const BurnManifest &Finish();
+
+private:
+    BurnManifest manifest_;
+    std::vector<uint8_t> pending_;
+};
+
+struct BurnVerifyResult {
+    bool matched = false;
+    uint64_t badLbaStart = 0;   // first mismatching extent, inclusive LBA range
+    uint64_t badLbaEnd = 0;
+    uint64_t bytesVerified = 0;
+    double throughputMBps = 0;
+};
+
+/**
+ * @brief Sector-level verification of a burned disc against the image it was burned from.
+ *
+ * The manifest is recorded after the burn from the image file, or from an image built in process
+ * while it is being written to the disc. Verify
+ * streams the medium sequentially with large O_DIRECT reads, reading the next extent while
+ * the current one is hashed, and publishes progress through the volume-op progress file.
+ */
+class BurnVerifier {
+public:
+    BurnVerifier() = delete;
+
+    static int32_t BuildManifest(const std::string &imagePath, uint64_t startLba, BurnManifest &manifest);
+    static int32_t SaveManifest(const BurnManifest &manifest, const std::string &manifestPath);
+    static int32_t LoadManifest(const std::string &manifestPath, BurnManifest &manifest);
+    static int32_t Verify(const std::string &devPath, const BurnManifest &manifest,
+                          const std::string &progressPath, BurnVerifyResult &result);
+
+    // Burn-time bookkeeping keyed by the device node the disc was written through.
+    static std::string GetManifestPath(const std::string &devPath);
+    // Writes one chunk of an image built on the fly to fd, feeding it to recorder on the way.
+    static int32_t FeedBurner(int fd, const uint8_t *data, size_t len, BurnManifestRecorder &recorder);
+    static int32_t RecordBurn(const std::string &devPath, const BurnManifest &manifest);
+    static int32_t RecordBurn(const std::string &devPath, const std::string &imagePath, uint64_t startLba);
+    static void DropManifest(const std::string &devPath);
+    // Where a CD session starts: LBA 0 on a blank disc, else the next writable address of "wodim -msinfo".
+    static uint64_t SessionStartLba(bool isDiskEmpty, const std::string &incBurnAddr);
+};
+} // namespace StorageDaemon
+} // namespace OHOS
+
+#endif // OHOS_STORAGE_DAEMON_BURN_VERIFIER_H
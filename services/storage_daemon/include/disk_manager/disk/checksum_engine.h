@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2026 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef OHOS_STORAGE_DAEMON_CHECKSUM_ENGINE_H
+#define OHOS_STORAGE_DAEMON_CHECKSUM_ENGINE_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace OHOS {
+namespace StorageDaemon {
+
+enum class ChecksumAlgorithm : uint8_t {
+    MD5,    // same digests as md5sum, used for the checksum files
+    XXH64,  // non-cryptographic, for in-memory source/disc comparisons
+};
+
+// Relative path (no leading '/') -> lowercase hex digest.
+using ChecksumIndex = std::unordered_map<std::string, std::string>;
+
+/**
+ * @brief In-process replacement for `find <dir> -type f -exec md5sum {} ;`
+ *
+ * Walks the tree once with openat() relative to the root, then hashes the regular
+ * files (symlinks are not followed, like find -type f) on a small worker pool with
+ * large aligned reads.
+ */
+class ChecksumEngine {
+public:
+    ChecksumEngine() = delete;
+
+    static int32_t HashTree(const std::string &dirPath, ChecksumAlgorithm algorithm, ChecksumIndex &index);
+    static int32_t HashFile(int dirFd, const std::string &relPath, ChecksumAlgorithm algorithm,
+                            std::string &digest);
+    static std::string HashBuffer(const uint8_t *data, size_t len, ChecksumAlgorithm algorithm);
+    // Regular files below rootFd as paths relative to it, in directory order.
+    static int32_t ListFiles(int rootFd, std::vector<std::string> &files);
+};
+} // namespace StorageDaemon
+} // namespace OHOS
+
+#endif // OHOS_STORAGE_DAEMON_CHECKSUM_ENGINE_H
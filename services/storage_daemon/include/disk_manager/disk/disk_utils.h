@@ -20,6 +20,8 @@
 #include <vector>
 #include <map>
 
+#include "disk_manager/disk/checksum_engine.h"
+
 namespace OHOS {
 namespace StorageDaemon {
 
@@ -91,11 +93,8 @@ public:
     static bool IsFileEntry(const std::string& line, char& entryType);
     static std::string ParseFileName(const std::string& trimmedLine);
     static int32_t GenerateChecksums(const std::string& dirPath, const std::string& checksumFilePath);
-    static std::map<std::string, std::string> ParseChecksumFile(
-        const std::string& checksumContent, const std::string& basePath);
-    static int32_t CompareChecksums(
-        const std::map<std::string, std::string>& sourceMap,
-        const std::map<std::string, std::string>& discMap);
+    static ChecksumIndex ParseChecksumFile(const std::string& checksumContent, const std::string& basePath);
+    static int32_t CompareChecksums(const ChecksumIndex& sourceMap, const ChecksumIndex& discMap);
 
 private:
     static bool IsMtpDeviceInUse(const std::string &diskPath);
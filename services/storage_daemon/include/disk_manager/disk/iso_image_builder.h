@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2026 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef OHOS_STORAGE_DAEMON_ISO_IMAGE_BUILDER_H
+#define OHOS_STORAGE_DAEMON_ISO_IMAGE_BUILDER_H
+
+#include <cstdint>
+#include <ctime>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace OHOS {
+namespace StorageDaemon {
+
+struct IsoImageOptions {
+    std::string volumeId = "ISOIMAGE";
+    time_t createTime = 0;      // 0 for the time Scan runs
+};
+
+// Receives the image front to back; a non-E_OK return aborts the stream with that error.
+using IsoImageSink = std::function<int32_t(const uint8_t *data, size_t len)>;
+
+/**
+ * @brief ISO9660 image with Rock Ridge and Joliet extensions, built in process as a byte stream.
+ *
+ * Scan walks the source tree once and lays out the whole image from metadata alone: directory
+ * records, path tables and file extents. Stream then emits the image in order, generating the
+ * metadata sectors and copying file contents straight from the source files, so the image never
+ * has to be staged on disk. The layout matches "genisoimage -J -r -D -joliet-long": level 1
+ * names in the primary tree, the full names in Rock Ridge NM entries and in the Joliet tree, and
+ * the attributes -r sets (root owned, read-only, execute bits widened to everyone). Symlinks are
+ * kept as empty files with Rock Ridge SL entries; device nodes, fifos and sockets are skipped.
+ */
+class IsoImageBuilder {
+public:
+    explicit IsoImageBuilder(const IsoImageOptions &options = IsoImageOptions());
+    ~IsoImageBuilder();
+    IsoImageBuilder(const IsoImageBuilder &) = delete;
+    IsoImageBuilder &operator=(const IsoImageBuilder &) = delete;
+
+    int32_t Scan(const std::string &rootDir);
+    uint64_t GetImageSize() const;
+    int32_t Stream(const IsoImageSink &sink);
+    int32_t WriteTo(int fd);
+
+private:
+    struct Node;
+    struct Continuation;
+
+    int32_t ScanDir(Node &dir);
+    static int32_t ReadLink(int dirFd, Node &link);
+    static void AppendNameEntries(std::vector<uint8_t> &su, const Node &node);
+    void AssignNames(Node &dir);
+    uint32_t PlaceContinuations(size_t first, uint32_t lba);
+    void Layout();
+    uint32_t PrimaryDirSize(const Node &dir);
+    uint32_t JolietDirSize(const Node &dir) const;
+    void BuildMetadata(std::vector<uint8_t> &meta) const;
+    void WriteVolumeDescriptors(std::vector<uint8_t> &meta) const;
+    void WritePathTables(std::vector<uint8_t> &meta) const;
+    void WritePrimaryDir(std::vector<uint8_t> &meta, const Node &dir) const;
+    void WriteJolietDir(std::vector<uint8_t> &meta, const Node &dir) const;
+    int32_t StreamFile(const Node &file, const IsoImageSink &sink, std::vector<uint8_t> &buf, uint64_t &written);
+
+    IsoImageOptions options_;
+    std::unique_ptr<Node> root_;
+    std::vector<Node *> dirs_;          // path table order: by depth, then parent, then name
+    std::vector<Node *> files_;         // in the order their extents are laid out
+    std::vector<Continuation> continuations_;
+    uint32_t pathTableSize_ = 0;
+    uint32_t jolietPathTableSize_ = 0;
+    uint32_t pathTableLba_ = 0;         // L, M, Joliet L, Joliet M tables follow each other
+    uint32_t pathTableSectors_ = 0;
+    uint32_t jolietPathTableSectors_ = 0;
+    uint32_t metaSectors_ = 0;
+    uint32_t totalSectors_ = 0;
+};
+} // namespace StorageDaemon
+} // namespace OHOS
+
+#endif // OHOS_STORAGE_DAEMON_ISO_IMAGE_BUILDER_H
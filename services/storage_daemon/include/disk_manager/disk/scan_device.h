@@ -17,6 +17,7 @@
 #define OHOS_STORAGE_DAEMON_SCAN_DEVICE_H
 
 #include <cstdint>
+#include <map>
 #include <string>
 #include <vector>
 #include <nlohmann/json.hpp>
@@ -28,6 +29,45 @@ using OHOS::DiskManager::BlockInfo;
 namespace OHOS {
 namespace StorageDaemon {
 
+/*
+ * The sysfs attributes ScanDevice needs for one block device, read in one go. The device
+ * directory is opened once through the sysBlockPath link, each attribute is read with openat
+ * and pread into a shared arena, and the parent chain is walked once for the attributes that
+ * live on an ancestor device (devnum, busnum).
+ */
+class SysfsDeviceSnapshot {
+public:
+    bool Load(const std::string &sysBlockPath, const std::string &deviceName);
+    // First line with surrounding spaces trimmed; false if the node is missing or empty.
+    bool ReadNode(const std::string &node, std::string &content) const;
+    // Whole node without the final newline; empty if the node is missing.
+    std::string ReadContent(const std::string &node) const;
+    // Nearest ancestor's copy of the node, the device directory included; empty if none.
+    std::string ReadInherited(const std::string &node) const;
+    bool HasLink() const
+    {
+        return hasLink_;
+    }
+    const std::string &LinkTarget() const
+    {
+        return linkTarget_;
+    }
+
+private:
+    struct Span {
+        size_t offset = 0;
+        size_t len = 0;
+    };
+    bool ReadAt(int dirFd, const std::string &name, Span &span);
+    void WalkParents(int devFd);
+
+    std::string arena_;
+    std::map<std::string, Span> nodes_;
+    std::map<std::string, Span> inherited_;
+    std::string linkTarget_;
+    bool hasLink_ = false;
+};
+
 class ScanDevice {
 public:
     explicit ScanDevice(const std::string &sysBlockPath = "/sys/block", const std::string &devBlockPath = "/dev/block");
@@ -38,33 +78,46 @@ public:
     uint64_t GetDiskSize(const std::string &deviceName);
 
 private:
+    SysfsDeviceSnapshot LoadSnapshot(const std::string &deviceName);
     int GetBlockInfo(const std::string &deviceName, const bool isNvmeDevice, BlockInfo &blockInfo);
+    int GetBlockInfo(const SysfsDeviceSnapshot &snapshot, const std::string &deviceName, const bool isNvmeDevice,
+        BlockInfo &blockInfo);
     bool ReadSysfsNode(const std::string &path, std::string &content);
     bool ReadRemovableNode(const std::string &deviceName, bool &isRemovable);
+    bool ReadRemovableNode(const SysfsDeviceSnapshot &snapshot, bool &isRemovable);
     bool IsDataDisk(const std::string &deviceName, const bool isNeedCheckUfs, const bool isRemovable);
+    bool IsDataDisk(const SysfsDeviceSnapshot &snapshot, const std::string &deviceName, const bool isNeedCheckUfs,
+        const bool isRemovable);
+    uint64_t GetDiskSize(const SysfsDeviceSnapshot &snapshot, const std::string &deviceName);
     std::string GetVendor(const std::string &deviceName);
+    std::string GetVendor(const SysfsDeviceSnapshot &snapshot);
     std::string GetModel(const std::string &deviceName);
+    std::string GetModel(const SysfsDeviceSnapshot &snapshot);
     std::string GetInterfaceType(const std::string &deviceName);
     uint32_t GetDiskRpm(const std::string &deviceName, const bool isNvmeDevice);
     int32_t GetRotational(const std::string &deviceName);
+    int32_t GetRotational(const SysfsDeviceSnapshot &snapshot);
     std::string GetSataSerialNumber(int fd);
-    std::string GetNvmeSerialNumber(const std::string &deviceName);
+    std::string GetNvmeSerialNumber(const SysfsDeviceSnapshot &snapshot, const std::string &deviceName);
     std::string GetSerialNumber(const std::string &deviceName, const bool isNvmeDevice);
-    std::string GetPciePath(const std::string &deviceName);
-    bool ReadSataDeviceNumber(const std::string &deviceName, std::string &major, std::string &minor);
-    bool ReadNvmeDeviceNumber(const std::string &deviceName, std::string &major, std::string &minor);
+    std::string GetSerialNumber(const SysfsDeviceSnapshot &snapshot, const std::string &deviceName,
+        const bool isNvmeDevice);
+    std::string GetPciePath(const SysfsDeviceSnapshot &snapshot);
+    bool ReadSataDeviceNumber(const SysfsDeviceSnapshot &snapshot, std::string &major, std::string &minor);
+    bool ReadNvmeDeviceNumber(const SysfsDeviceSnapshot &snapshot, std::string &major, std::string &minor);
     std::string GetDiskId(const std::string &deviceName, const bool isNvmeDevice);
+    std::string GetDiskId(const SysfsDeviceSnapshot &snapshot, const std::string &deviceName,
+        const bool isNvmeDevice);
     std::string GetDevicePath(const std::string &deviceName);
     std::string GetPort(const std::string &pciePath, const bool isNvmeDevice);
     bool IsValidNvmeDevice(const std::string &deviceName);
     bool ParseStringToUlongLong(const std::string &str, unsigned long long &result);
     bool GetExternalDiskSize(const std::string &path, uint64_t *size);
-    std::string ReadFileContent(const std::string &path);
     std::string GetDevnum(const std::string &deviceName);
     std::string GetBusnum(const std::string &deviceName);
     std::string GetDevNode(const std::string &deviceName);
-    std::string GetFwVersion(const std::string &deviceName);
-    std::string GetRealPath(const std::string &deviceName);
+    std::string GetFwVersion(const SysfsDeviceSnapshot &snapshot);
+    std::string GetRealPath(const SysfsDeviceSnapshot &snapshot, const std::string &deviceName);
     std::string FormatSpeedValue(double speedVal);
     std::string ExtractSpeedFromLine(const std::string &line);
     nlohmann::json ParseMediaInfoLines(const std::vector<std::string> &output);
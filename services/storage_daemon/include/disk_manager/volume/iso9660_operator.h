@@ -52,11 +52,6 @@ public:
                             const std::string& sourceDir);
 
 private:
-    int32_t PrepareIsoImage(const std::string &devPath,
-                            const BurnOptions &burnOptions,
-                            bool isDiskEmpty,
-                            const std::string &incBurnAddr);
-
     int32_t GenerateChecksums(const std::string& dirPath,
                               const std::string& checksumFilePath);
 
@@ -15,7 +15,9 @@
 #ifndef OHOS_STORAGE_DAEMON_ACL_H
 #define OHOS_STORAGE_DAEMON_ACL_H
 
+#include <cstdint>
 #include <set>
+#include <string>
 
 namespace OHOS {
 namespace StorageDaemon {
@@ -154,6 +156,27 @@ private:
 };
 
 int AclSetDefault(const std::string &targetFile, const std::string &entryTxt);
+
+struct AclTreeOptions {
+    const char *accessAttr = Acl::ACL_XATTR_ACCESS;
+    // Also add the entry to the default ACL of every directory; nullptr leaves default ACLs alone.
+    const char *defaultAttr = nullptr;
+    size_t workers = 1;
+};
+
+struct AclTreeResult {
+    uint64_t changed = 0;
+    uint64_t skipped = 0;   // already granted the entry
+    uint64_t failed = 0;
+};
+
+/*
+ * Adds one ACL entry to root and every directory and regular file below it. The entry is parsed once,
+ * each inode is read through an fd opened relative to its parent, and only ACLs that do not already
+ * grant the entry are rewritten.
+ */
+int AclSetTree(const std::string &root, const std::string &entryTxt, const AclTreeOptions &options,
+               AclTreeResult &result);
 } // STORAGE_DAEMON
 } // OHOS
 
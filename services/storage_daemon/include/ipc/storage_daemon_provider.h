@@ -122,6 +122,9 @@ public:
     virtual int32_t InactiveUserPublicDirKey(uint32_t userId) override;
     virtual int32_t QueryOccupiedSpaceForSa(std::vector<UidSaInfo> &vec, int64_t &totalSize,
         const std::map<int32_t, std::string> &bundleNameAndUid, int32_t type) override;
+    virtual int32_t QueryOccupiedSpaceForAll(std::vector<UidSaInfo> &sysSaVec, std::vector<UidSaInfo> &sysAppVec,
+        std::vector<UidSaInfo> &userAppVec, std::vector<UidSaInfo> &otherAppVec, int64_t &saTotalSize,
+        int64_t &otherTotalSize, const std::map<int32_t, std::string> &bundleNameAndUid) override;
     virtual int32_t SetDirEncryptionPolicy(uint32_t userId, const std::string &dirPath, uint32_t level) override;
     virtual int32_t CreateUserDir(const std::string &path, mode_t mode, uid_t uid, gid_t gid) override;
     virtual int32_t GetDqBlkSpacesByUids(const std::vector<int32_t> &uids,
@@ -137,6 +140,7 @@ public:
 
     // stats api
     virtual int32_t GetDataSizeByPath(const std::string &path, int64_t &size) override;
+    virtual int32_t GetDataSizeByPaths(const std::vector<std::string> &paths, std::vector<int64_t> &sizes) override;
     virtual int32_t GetRmgResourceSize(const std::string &rgmName, uint64_t &totalSize) override;
     virtual int32_t GetSystemDataSize(int64_t &otherUidSizeSum) override;
 
@@ -16,6 +16,7 @@
 #define FSCRYPT_CONTROL_H
 
 #include "key_control.h"
+#include <stdbool.h>
 #include <stdint.h>
 
 #ifdef __cplusplus
@@ -40,11 +41,26 @@ struct FscryptSdpPolicy {
 };
 #pragma pack(pop)
 
+/*
+ * Policy of one key directory, loaded once and then applied to any number of
+ * directories without touching the key files again.
+ */
+struct FscryptPolicyContext {
+    union FscryptPolicy policy;
+    bool hasSdpPolicy;
+    struct FscryptSdpPolicy sdpPolicy;
+};
+
 int FscryptSetSysparam(const char *policy);
 int SetGlobalEl1DirPolicy(const char *dir);
 int LoadAndSetPolicy(const char *keyDir, const char *dir);
 int LoadAndSetEceAndSecePolicy(const char *keyDir, const char *dir, int type);
 int InitFscryptPolicy(void);
+int LoadPolicyContext(const char *keyDir, struct FscryptPolicyContext *ctx);
+int LoadSdpPolicyContext(const char *keyDir, int type, struct FscryptPolicyContext *ctx);
+int OpenPolicyDir(const char *dir);
+int SetPolicyByFd(const struct FscryptPolicyContext *ctx, int dirFd, const char *dir);
+int SetSdpPolicyByFd(const struct FscryptPolicyContext *ctx, int dirFd);
 uint8_t GetFscryptVersionFromPolicy(void);
 
 #ifdef __cplusplus
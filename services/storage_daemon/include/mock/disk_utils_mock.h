@@ -22,6 +22,7 @@
 #include <vector>
 
 #include "disk/disk_info.h"
+#include "disk_manager/disk/checksum_engine.h"
 
 namespace OHOS {
 namespace StorageDaemon {
@@ -59,11 +60,8 @@ public:
     virtual bool IsFileEntry(const std::string &line, char &entryType) = 0;
     virtual std::string ParseFileName(const std::string &trimmedLine) = 0;
     virtual int32_t GenerateChecksums(const std::string &dirPath, const std::string &checksumFilePath) = 0;
-    virtual std::map<std::string, std::string> ParseChecksumFile(
-        const std::string &checksumContent, const std::string &basePath) = 0;
-    virtual int32_t CompareChecksums(
-        const std::map<std::string, std::string> &sourceMap,
-        const std::map<std::string, std::string> &discMap) = 0;
+    virtual ChecksumIndex ParseChecksumFile(const std::string &checksumContent, const std::string &basePath) = 0;
+    virtual int32_t CompareChecksums(const ChecksumIndex &sourceMap, const ChecksumIndex &discMap) = 0;
     virtual bool IsCDBlank(const std::string &diskPath) = 0;
     virtual int32_t GetIncBurnAddr(const std::string &devPath, std::string &incBurnAddr) = 0;
     virtual std::string GetOpticalDriveNode(const std::string &devPath) = 0;
@@ -109,11 +107,8 @@ public:
     MOCK_METHOD2(IsFileEntry, bool(const std::string &line, char &entryType));
     MOCK_METHOD1(ParseFileName, std::string(const std::string &trimmedLine));
     MOCK_METHOD2(GenerateChecksums, int32_t(const std::string &dirPath, const std::string &checksumFilePath));
-    MOCK_METHOD2(ParseChecksumFile, std::map<std::string, std::string>(
-        const std::string &checksumContent, const std::string &basePath));
-    MOCK_METHOD2(CompareChecksums, int32_t(
-        const std::map<std::string, std::string> &sourceMap,
-        const std::map<std::string, std::string> &discMap));
+    MOCK_METHOD2(ParseChecksumFile, ChecksumIndex(const std::string &checksumContent, const std::string &basePath));
+    MOCK_METHOD2(CompareChecksums, int32_t(const ChecksumIndex &sourceMap, const ChecksumIndex &discMap));
     MOCK_METHOD1(IsCDBlank, bool(const std::string &diskPath));
     MOCK_METHOD2(GetIncBurnAddr, int32_t(const std::string &devPath, std::string &incBurnAddr));
     MOCK_METHOD1(GetOpticalDriveNode, std::string(const std::string &devPath));
@@ -33,6 +33,7 @@ public:
     virtual bool PrepareDir(const std::string &path, mode_t mode, uid_t uid, gid_t gid) = 0;
     virtual bool MkDirRecurse(const std::string& path, mode_t mode) = 0;
     virtual bool RmDirRecurse(const std::string &path);
+    virtual bool RmDirRecurseDeferred(const std::string &path) = 0;
     virtual int32_t Mount(const std::string &source, const std::string &target, const char *type,
         unsigned long flags, const void *data) = 0;
     virtual int32_t UMount(const std::string &path) = 0;
@@ -42,6 +43,8 @@ public:
     virtual std::string ReadFileContent(const std::string &path) = 0;
     virtual int ForkExec(std::vector<std::string> &cmd, std::vector<std::string> *output = nullptr,
         int *exitStatus = nullptr) = 0;
+    virtual int ForkExecWithInput(std::vector<std::string> &cmd, const ChildInputWriter &writer,
+        std::vector<std::string> *output = nullptr) = 0;
     virtual bool IsTempFolder(const std::string &path, const std::string &sub) = 0;
     virtual void DeleteFile(const std::string &path) = 0;
     virtual std::vector<std::string> Split(std::string str, const std::string &pattern) = 0;
@@ -63,6 +66,7 @@ public:
     MOCK_METHOD4(PrepareDir, bool(const std::string &path, mode_t mode, uid_t uid, gid_t gid));
     MOCK_METHOD2(MkDirRecurse, bool(const std::string& path, mode_t mode));
     MOCK_METHOD1(RmDirRecurse, bool(const std::string &path));
+    MOCK_METHOD1(RmDirRecurseDeferred, bool(const std::string &path));
     MOCK_METHOD5(Mount, int32_t(const std::string &source, const std::string &target, const char *type,
         unsigned long flags, const void *data));
     MOCK_METHOD1(UMount, int32_t(const std::string &path));
@@ -71,6 +75,8 @@ public:
     MOCK_METHOD2(ReadFile, bool(const std::string &path, std::string *str));
     MOCK_METHOD1(ReadFileContent, std::string(const std::string &path));
     MOCK_METHOD3(ForkExec, int(std::vector<std::string> &cmd, std::vector<std::string> *output, int *exitStatus));
+    MOCK_METHOD3(ForkExecWithInput, int(std::vector<std::string> &cmd, const ChildInputWriter &writer,
+        std::vector<std::string> *output));
     MOCK_METHOD2(IsTempFolder, bool(const std::string &path, const std::string &sub));
     MOCK_METHOD1(DeleteFile, void(const std::string &path));
     MOCK_METHOD2(Split, std::vector<std::string>(std::string str, const std::string &pattern));
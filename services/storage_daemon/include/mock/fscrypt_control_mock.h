@@ -18,6 +18,8 @@
 #include <gmock/gmock.h>
 #include <memory>
 
+#include "fscrypt_control.h"
+
 namespace OHOS {
 namespace StorageDaemon {
 class IFscryptControlMoc {
@@ -28,6 +30,11 @@ public:
     virtual bool KeyCtrlHasFscryptSyspara(void) = 0;
     virtual int LoadAndSetPolicy(const char *keyDir, const char *dir) = 0;
     virtual int LoadAndSetEceAndSecePolicy(const char *keyDir, const char *dir, int type) = 0;
+    virtual int LoadPolicyContext(const char *keyDir, struct FscryptPolicyContext *ctx) = 0;
+    virtual int LoadSdpPolicyContext(const char *keyDir, int type, struct FscryptPolicyContext *ctx) = 0;
+    virtual int OpenPolicyDir(const char *dir) = 0;
+    virtual int SetPolicyByFd(const struct FscryptPolicyContext *ctx, int dirFd, const char *dir) = 0;
+    virtual int SetSdpPolicyByFd(const struct FscryptPolicyContext *ctx, int dirFd) = 0;
 public:
     static inline std::shared_ptr<IFscryptControlMoc> fscryptControlMoc = nullptr;
 };
@@ -38,6 +45,11 @@ public:
     MOCK_METHOD0(KeyCtrlHasFscryptSyspara, bool());
     MOCK_METHOD2(LoadAndSetPolicy, int(const char *keyDir, const char *dir));
     MOCK_METHOD3(LoadAndSetEceAndSecePolicy, int(const char *keyDir, const char *dir, int type));
+    MOCK_METHOD2(LoadPolicyContext, int(const char *keyDir, struct FscryptPolicyContext *ctx));
+    MOCK_METHOD3(LoadSdpPolicyContext, int(const char *keyDir, int type, struct FscryptPolicyContext *ctx));
+    MOCK_METHOD1(OpenPolicyDir, int(const char *dir));
+    MOCK_METHOD3(SetPolicyByFd, int(const struct FscryptPolicyContext *ctx, int dirFd, const char *dir));
+    MOCK_METHOD2(SetSdpPolicyByFd, int(const struct FscryptPolicyContext *ctx, int dirFd));
 };
 }
 }
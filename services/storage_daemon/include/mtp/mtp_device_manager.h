@@ -15,7 +15,9 @@
 #ifndef OHOS_STORAGE_DAEMON_MTP_DEVICE_MANAGER_H
 #define OHOS_STORAGE_DAEMON_MTP_DEVICE_MANAGER_H
 
+#include <mutex>
 #include <nocopyable.h>
+#include <set>
 #include <singleton.h>
 #include <string>
 #include <sys/types.h>
@@ -55,8 +57,11 @@ public:
 private:
     MtpDeviceManager();
     ~MtpDeviceManager();
+    void FinishMounting(const std::string &path);
 
-    bool isMounting_ = false;
+    std::mutex mountingMutex_;
+    // Mount points with an mtpfs start in flight; different devices mount concurrently.
+    std::set<std::string> mountingPaths_;
 };
 } // namespace StorageDaemon
 } // namespace OHOS
@@ -15,6 +15,10 @@
 #ifndef OHOS_STORAGE_DAEMON_MTP_DEVICE_MONITOR_H
 #define OHOS_STORAGE_DAEMON_MTP_DEVICE_MONITOR_H
 
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
 #include <nocopyable.h>
 #include <singleton.h>
 #include "mtp/mtp_device_manager.h"
@@ -28,6 +32,25 @@ enum class DeviceType {
     MOBILE = 2
 };
 
+// Identity of a USB device as carried by the attach event; a vendorId of 0 means it is not known.
+struct UsbAttachInfo {
+    uint32_t busLocation = 0;
+    uint8_t devNum = 0;
+    uint16_t vendorId = 0;
+    uint16_t productId = 0;
+    std::string vendor;
+    std::string product;
+};
+
+// A mount in flight; detached is set when the device goes away before the mount returns.
+struct MtpMountTask {
+    MtpDeviceInfo device;
+    bool detached = false;
+};
+
+using MtpMountFunc = std::function<int32_t(const MtpDeviceInfo &device)>;
+using MtpUmountFunc = std::function<int32_t(const MtpDeviceInfo &device, bool needNotify, bool isBadRemove)>;
+
 class MtpDeviceMonitor : public NoCopyable  {
 public:
     static MtpDeviceMonitor &GetInstance()
@@ -37,9 +60,13 @@ public:
     }
 
     void StartMonitor();
+    void StopMonitor();
     void UmountDetachedMtpDevice(uint32_t busLocation, uint8_t devNum);
     int32_t Mount(const std::string &id);
     int32_t Umount(const std::string &id);
+    // Mounts the device off the event thread, so attach events of several devices are handled side by side.
+    void OnDeviceAttached(DeviceType deviceType, const UsbAttachInfo &usbInfo);
+    void MountMtpDeviceByBroadcast(DeviceType deviceType, const UsbAttachInfo &usbInfo);
     void MountMtpDeviceByBroadcast(DeviceType deviceType, uint32_t busLocation, uint8_t devNum);
     void UmountAllMtpDevice();
     int32_t HasMTPDevice(bool &hasMtp);
@@ -57,21 +84,31 @@ private:
     MtpDeviceMonitor();
     ~MtpDeviceMonitor();
     void MonitorDevice();
+    bool WaitForStop(int32_t seconds);
     bool HasMounted(const MtpDeviceInfo &device);
     bool IsNeedDisableMtp();
     bool IsHwitDevice();
-    int32_t MountMtpDevice(const std::vector<MtpDeviceInfo> &monitorDevices);
-    int32_t GetMtpDevices(std::vector<MtpDeviceInfo> &devInfos, uint32_t busLocation, uint8_t devNum);
+    int32_t MountMtpDevice(std::vector<MtpDeviceInfo> &monitorDevices);
+    bool ReserveDeviceLocked(MtpDeviceInfo &device);
+    int32_t MountReservedDevice(const MtpDeviceInfo &device);
+    int32_t GetMtpDevices(std::vector<MtpDeviceInfo> &devInfos, const UsbAttachInfo &usbInfo);
     int32_t GetGphotoDevices(std::vector<MtpDeviceInfo> &devInfos, uint32_t busLocation, uint8_t devNum);
     bool IsCameraDevice(uint16_t vendorId, uint16_t productId);
     int32_t MountDeviceByType(DeviceType deviceType, std::vector<MtpDeviceInfo> &devInfos,
-                              const std::string &deviceTypeName, uint32_t busLocation, uint8_t devNum);
+                              const std::string &deviceTypeName, const UsbAttachInfo &usbInfo);
     void SetPtpMode(const std::vector<MtpDeviceInfo> &devInfos, bool isCamera);
 
 private:
+    // Guards the device lists only; mounts and unmounts run without it.
     std::mutex listMutex_;
     std::vector<MtpDeviceInfo> lastestMtpDevList_;
-    std::vector<MtpDeviceInfo> pendingMtpDevList_;
+    std::map<std::string, MtpMountTask> mountingDevs_;
+    MtpMountFunc mountFunc_;
+    MtpUmountFunc umountFunc_;
+
+    std::mutex stopMutex_;
+    std::condition_variable stopCv_;
+    bool stopping_ = false;
 };
 } // namespace StorageDaemon
 } // namespace OHOS
@@ -36,11 +36,11 @@ public:
     virtual ~UsbEventSubscriber() = default;
 
     void OnReceiveEvent(const OHOS::EventFwk::CommonEventData &data) override;
-    static void SubscribeCommonEvent(void);
+    static bool SubscribeCommonEvent(void);
     static bool IsPtpMode();
 
 private:
-    void GetValueFromUsbDataInfo(const std::string &jsonStr, uint8_t &devNum, uint32_t &busLocation);
+    void GetValueFromUsbDataInfo(const std::string &jsonStr, UsbAttachInfo &usbInfo);
     bool ShouldHandleMtpDevice(const std::string &usbInfo, DeviceType &deviceType);
     bool ParseMtpDeviceIds(const cJSON* usbJson, uint8_t &deviceClass, uint16_t &idVendor, uint16_t &idProduct);
     std::string ToLowerString(const char* str);
@@ -16,8 +16,10 @@
 #ifndef OHOS_STORAGE_DAEMON_NETLINK_DATA_H
 #define OHOS_STORAGE_DAEMON_NETLINK_DATA_H
 
+#include <array>
 #include <map>
 #include <string>
+#include <string_view>
 
 namespace OHOS {
 namespace StorageDaemon {
@@ -34,7 +36,7 @@ public:
         UNBIND,
         UNKNOWN,
     };
-    std::map<std::string, Actions> actionMaps = {
+    static inline const std::map<std::string, Actions, std::less<>> actionMaps = {
         {"add", Actions::ADD},
         {"remove", Actions::REMOVE},
         {"move", Actions::MOVE},
@@ -44,6 +46,7 @@ public:
         {"bind", Actions::BIND},
         {"unbind", Actions::UNBIND}
     };
+    static constexpr size_t NL_PARAMS_MAX = 128;
 
     std::string GetSyspath();
     std::string GetDevpath();
@@ -52,15 +55,18 @@ public:
     std::string GetEjectRequest();
     Actions GetAction();
     const std::string GetParam(const std::string paramName);
+    // Decoded fields are views into msg, so msg must outlive every getter call.
     void Decode(const char *msg);
+    // Cheap pre-filter over the raw uevent, no allocation and no decode.
+    static bool IsBlockDiskEvent(const char *msg);
 
 private:
-    std::string sysPath_;
-    std::string subSystem_;
-    std::string devPath_;
-    std::string ejectRequest_;
-    std::string diskName_;
-    std::vector<std::string> params_;
+    std::string_view subSystem_;
+    std::string_view devPath_;
+    std::string_view ejectRequest_;
+    std::string_view diskName_;
+    std::array<std::string_view, NL_PARAMS_MAX> params_;
+    size_t paramCount_ = 0;
     Actions action_ = Actions::UNKNOWN;
 };
 } // STORAGE_DAEMON
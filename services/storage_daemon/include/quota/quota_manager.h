@@ -17,10 +17,13 @@
 #define OHOS_STORAGE_DAEMON_QUOTA_MANAGER_H
 
 #include <fstream>
+#include <functional>
 #include <map>
+#include <mutex>
 #include <nocopyable.h>
 #include "statistic_info.h"
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include <sys/stat.h>
 #include <sys/statvfs.h>
@@ -51,6 +54,21 @@ struct KernelNextDqBlk {
     uint32_t dqbId = 0;
 };
 
+using BundleNameIndex = std::unordered_map<int32_t, std::string>;
+// Fills dq with the first quota entry whose id is >= fromId, like Q_GETNEXTQUOTA.
+using NextQuotaFunc = std::function<int32_t(int32_t fromId, KernelNextDqBlk &dq)>;
+
+// Entries of the passwd file, kept until the file changes.
+struct PasswdCache {
+    bool valid = false;
+    dev_t dev = 0;
+    ino_t ino = 0;
+    off_t size = 0;
+    int64_t mtimeNs = 0;
+    uint64_t loads = 0;
+    std::vector<UidSaInfo> entries;
+};
+
 class QuotaManager final {
 public:
     virtual ~QuotaManager() = default;
@@ -62,6 +80,9 @@ public:
     void GetUidStorageStats(const std::string &storageStatus);
     void GetUidStorageStats(std::vector<UidSaInfo> &vec, int64_t &totalSize,
         const std::map<int32_t, std::string> &bundleNameAndUid, int32_t type);
+    // All four classes from one passwd lookup and one quota sweep.
+    int32_t GetAllUidStorageStats(AllAppVec &allVec, int64_t &saTotalSize, int64_t &otherTotalSize,
+        const std::map<int32_t, std::string> &bundleNameAndUid);
     int32_t GetFileData(const std::string &path, int64_t &size);
     int32_t GetDqBlkSpacesByUids(const std::vector<int32_t> &uids, std::vector<NextDqBlk> &dqBlks);
     int32_t GetDirListSpace(std::vector<DirSpaceInfo> &dirs);
@@ -73,13 +94,14 @@ public:
     void GetAncoSizeData(std::string &extraData);
     int32_t ListUserdataDirInfo(std::vector<OHOS::StorageManager::UserdataDirInfo> &scanDirs);
 private:
-    QuotaManager() = default;
+    QuotaManager();
     DISALLOW_COPY_AND_MOVE(QuotaManager);
-    void ProcessVecList(std::vector<UidSaInfo> &vec, bool isSa, const std::map<int32_t, std::string> &bundleNameAndUid);
+    static int32_t QueryNextQuota(int32_t fromId, KernelNextDqBlk &dq);
+    void ProcessVecList(std::vector<UidSaInfo> &vec, bool isSa, const BundleNameIndex &bundleNameAndUid);
     void GetOccupiedSpaceForUidList(AllAppVec &allVec, uint64_t &iNodes);
     void SortAndCutSaInfoVec(std::vector<UidSaInfo> &vec, bool isSa);
-    void AssembleSaInfoVec(std::vector<UidSaInfo> &vec,
-        const std::map<int32_t, std::string> &bundleNameAndUid);
+    void AssembleSaInfoVec(std::vector<UidSaInfo> &vec, const BundleNameIndex &bundleNameAndUid);
+    int32_t LoadPasswdEntries(std::vector<UidSaInfo> &vec);
     bool GetUid32FromEntry(const std::string &entry, int32_t &outUid32, std::string &saName);
     bool StringToInt32(const std::string &strUid, int32_t &outUid32);
     int32_t ParseConfigFile(const std::string &path, std::vector<UidSaInfo> &vec);
@@ -120,6 +142,10 @@ private:
     OHOS::StorageManager::UserdataDirInfo ScanDirRecurse(const std::string &path,
         std::vector<OHOS::StorageManager::UserdataDirInfo> &scanDirs);
     std::atomic<bool> stopScanFlag_{false};
+    std::string passwdPath_;
+    NextQuotaFunc nextQuota_;
+    std::mutex passwdMutex_;
+    PasswdCache passwdCache_;
 };
 } // STORAGE_DAEMON
 } // OHOS
@@ -25,7 +25,6 @@ namespace StorageDaemon {
 constexpr const char *SANDBOX_ROOT_PATH = "/mnt/sandbox/";
 constexpr const char *CURRENT_USER_ID_FLAG = "<currentUserId>";
 constexpr const char *PACKAGE_NAME_FLAG = "<bundleName>";
-constexpr const char *MOUNT_POINT_INFO = "/proc/mounts";
 constexpr const char *MOUNT_POINT_TYPE_HMDFS = "hmdfs";
 constexpr const char *MOUNT_POINT_TYPE_HMFS = "hmfs";
 constexpr const char *MOUNT_POINT_TYPE_F2FS = "f2fs";
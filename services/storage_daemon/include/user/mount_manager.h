@@ -47,10 +47,7 @@ public:
     int32_t FindMountPointsToMap(std::map<std::string, std::list<std::string>> &mountMap, int32_t userId);
     void MountPointToList(std::list<std::string> &hmdfsList, std::list<std::string> &hmfsList,
         std::list<std::string> &sharefsList, std::string &line, int32_t userId);
-    bool CheckMaps(const std::string &path, std::list<std::string> &mountFailList);
-    bool CheckSymlink(const std::string &path, std::list<std::string> &mountFailList);
     bool GetProcessInfo(const std::string &filename, ProcessInfo &info);
-    bool PidUsingFlag(std::string &pidPath, std::list<std::string> &mountFailList);
     void MountSandboxPath(uint32_t userId, const std::vector<MountNodeInfo> &sandboxMountNodeInfo,
         const std::string &bundleName);
     bool CheckMountFileByUser(int32_t userId);
@@ -99,10 +96,6 @@ private:
     void ForbidOpen(int32_t userId);
     int32_t OpenProcForPath(const std::string &path, bool &isOccupy, bool isDir);
     int32_t OpenProcForMulti(const std::string &path, std::set<std::string> &occupyFiles);
-    bool FindProcForPath(const std::string &pidPath, const std::string &path, bool isDir);
-    void FindProcForMulti(const std::string &pidPath, const std::string &path, std::set<std::string> &occupyFiles);
-    bool CheckSymlinkForPath(const std::string &fdPath, const std::string &path, bool isDir);
-    void CheckSymlinkForMulti(const std::string &fdPath, const std::string &path, std::set<std::string> &occupyFiles);
     int32_t FindMountsByNetworkId(const std::string &networkId, std::list<std::string> &mounts);
     int32_t FilterNotMountedPath(std::map<std::string, std::string> &notMountPaths);
     bool MatchesDisSharePath(const std::string &dstPath);
@@ -16,6 +16,8 @@
 #ifndef OHOS_STORAGE_DAEMON_USER_MANAGER_H
 #define OHOS_STORAGE_DAEMON_USER_MANAGER_H
 
+#include <functional>
+
 #include "user/mount_manager.h"
 
 namespace OHOS {
@@ -39,6 +41,20 @@ private:
     ~UserManager() = default;
 
     int32_t CreateServiceDirs(int32_t userId, uint32_t flags);
+    int32_t GetServiceDirList(int32_t userId, uint32_t flags, std::vector<DirInfo> &dirInfoList);
+    int32_t PrepareServiceDirs(int32_t userId, const std::vector<DirInfo> &dirInfoList);
+    // Runs prepare on every dir once its parent in the list is done, on up to workers threads.
+    static int32_t PrepareDirs(const std::vector<DirInfo> &dirInfoList,
+        const std::function<int32_t(const DirInfo &)> &prepare, size_t workers);
+    static std::string GetDirsStampPath(int32_t userId, uint32_t flags);
+    // The software version and the file_contexts digest; a stamp taken on another build is never current.
+    static const std::string &GetSystemFingerprint();
+    static std::string GetDirsGeneration(uint32_t flags, const std::string &fingerprint,
+        const std::vector<DirInfo> &baseDirs, const std::vector<DirInfo> &serviceDirs);
+    static bool IsDirsStampCurrent(const std::string &stampPath, const std::string &generation,
+        const std::vector<DirInfo> &baseDirs, const std::vector<DirInfo> &serviceDirs);
+    static void SaveDirsStamp(const std::string &stampPath, const std::string &generation);
+    static void ClearDirsStamps(int32_t userId);
     int32_t CheckUserIdRange(int32_t userId);
     int32_t SetElDirFscryptPolicy(int32_t userId, const std::string &path);
 
@@ -35,7 +35,7 @@ struct DirInfo {
 
     int32_t MakeDir() const;
     int32_t MakeDir(const std::string &createPath) const;
-    int32_t RemoveDir() const;
+    int32_t RemoveDir(bool deferred = false) const;
     void UpdateDirUid(int32_t userId);
 };
 void from_json(const nlohmann::json &j, DirInfo &dirInfo);
@@ -78,16 +78,20 @@ public:
     static int32_t GetHmdfsMountNodeList(int32_t userId, std::vector<MountNodeInfo> &mountNodeList);
     static int32_t GetSandboxMountNodeList(int32_t userId, std::vector<MountNodeInfo> &mountNodeList);
     static int32_t GetAppDataMountStartupNodeList(int32_t userId, std::vector<MountNodeInfo> &mountNodeList);
+    // Parse and compile both JSON configs ahead of the first user start.
+    static void LoadConfigs();
 
 private:
     template <typename T>
     static int32_t GetTListFromJson(const nlohmann::json &j, const std::vector<std::string> &pathKeys,
         std::vector<T> &tList);
+    template <typename T>
+    static int32_t GetCompiledList(int32_t userId, const std::string &filename,
+        const std::vector<std::string> &pathKeys, std::vector<T> &tList);
     static int32_t GetMountNodeList(int32_t userId, const std::vector<std::string> &pathKeys,
         std::vector<MountNodeInfo> &mountNodeList);
-    static int32_t ReplaceUserId(int32_t userId, std::vector<DirInfo> &dirInfoList);
-    static int32_t ReplaceUserId(int32_t userId, std::vector<MountNodeInfo> &mountNodeList);
-    static int32_t GetUserPath(uint32_t flags, const std::string &userType, std::vector<DirInfo> &dirInfoList);
+    static int32_t GetUserPath(int32_t userId, uint32_t flags, const std::string &userType,
+        std::vector<DirInfo> &dirInfoList);
     static int32_t OpenJsonFile(const std::string &filename, nlohmann::json &j);
 };
 
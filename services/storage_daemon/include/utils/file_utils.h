@@ -15,6 +15,7 @@
 #ifndef STORAGE_DAEMON_UTILS_FILE_UTILS_H
 #define STORAGE_DAEMON_UTILS_FILE_UTILS_H
 
+#include <functional>
 #include <sstream>
 #include <sys/types.h>
 #include <sys/mount.h>
@@ -43,6 +44,58 @@ struct ProcessInfo {
     std::string name;
 };
 
+// What FixTreeAttrs enforces on a tree; parts that are not set are left alone.
+struct TreeFixSpec {
+    bool setMode = false;
+    mode_t dirMode = 0;
+    mode_t fileMode = 0;
+    bool setOwner = false;
+    uid_t uid = 0;
+    gid_t gid = 0;
+    // Called with the path of every entry, e.g. to restorecon it; returns E_OK on success.
+    std::function<int32_t(const std::string &path)> relabel;
+    // A directory whose pruneXattr holds pruneValue is skipped with everything below it.
+    std::string pruneXattr;
+    std::string pruneValue;
+};
+
+struct TreeFixResult {
+    uint64_t changed = 0;
+    uint64_t skipped = 0;   // already matched the spec
+    uint64_t failed = 0;
+    uint64_t pruned = 0;    // directories skipped by pruneXattr, not counting their contents
+};
+
+constexpr int32_t CHILD_TERM_GRACE_MS = 1000;
+constexpr size_t CHILD_OUTPUT_CAP = 4 * 1024 * 1024;
+
+using ChildOutputHook = std::function<void(const char *data, size_t len)>;
+// Writes the child's whole stdin to fd on a thread of its own; fd is closed once it returns.
+using ChildInputWriter = std::function<int32_t(int fd)>;
+
+struct ChildRunOptions {
+    int32_t timeoutMs = -1;                   // < 0: no deadline
+    int32_t termGraceMs = CHILD_TERM_GRACE_MS; // SIGTERM to SIGKILL delay; 0 sends SIGKILL at the deadline
+    size_t outCap = CHILD_OUTPUT_CAP;         // bytes kept from stdout, the rest is read and dropped
+    size_t errCap = CHILD_OUTPUT_CAP;
+    bool mergeErr = false;                    // stderr shares the stdout pipe, as with RedirectStdToPipe
+    bool captureErr = true;                   // false: stderr is inherited from the daemon
+    bool newGroup = false;                    // child leads a process group; signals go to the whole group
+    int stdinFd = -1;                         // dup'ed onto the child's stdin; < 0 inherits the daemon's
+    std::function<void(pid_t pid)> onSpawn;   // called in the parent right after the child starts
+    ChildOutputHook onOutput;                 // every stdout chunk as it is read, before outCap applies
+};
+
+struct ChildRunResult {
+    int status = 0;          // wait status; reads as exit 127 when the program could not be executed
+    int error = 0;           // errno of the failed step, or of the failed exec
+    bool timedOut = false;
+    std::string out;
+    std::string err;
+    size_t outDropped = 0;
+    size_t errDropped = 0;
+};
+
 int32_t ChMod(const std::string &path, mode_t mode);
 int32_t MkDir(const std::string &path, mode_t mode);
 bool IsDir(const std::string &path);
@@ -51,7 +104,15 @@ int32_t PrepareDirSimple(const std::string &path, mode_t mode, uid_t uid, gid_t
 bool PrepareDir(const std::string &path, mode_t mode, uid_t uid, gid_t gid);
 bool MkDirRecurse(const std::string& path, mode_t mode);
 bool RmDirRecurse(const std::string &path);
+// Renames path next to itself and removes it on a background thread, journaled so a restart resumes it.
+// Returns once the rename is journaled; a failed background removal is reported to radar and retried next start.
+bool RmDirRecurseDeferred(const std::string &path);
+void ResumeDeferredRemoval();
+// The journal defaults to the daemon's el0 dir; tests point it elsewhere.
+void SetDeferredRemovalJournal(const std::string &journal);
 void TravelChmod(const std::string &path, mode_t mode);
+// Fixes mode/owner/label of path and everything below it in one fd-relative pass, without following symlinks.
+int32_t FixTreeAttrs(const std::string &path, const TreeFixSpec &spec, TreeFixResult &result);
 int32_t Mount(const std::string &source, const std::string &target, const char *type,
               unsigned long flags, const void *data);
 int32_t UMount(const std::string &path);
@@ -63,10 +124,19 @@ bool StringToBool(const std::string &str, bool &result);
 bool ReadFile(const std::string &path, std::string *str);
 std::string ReadFileContent(const std::string &path);
 std::string ReadFileInParentDirs(const std::string &startPath, const std::string &fileName);
+// Spawns cmd (searched in PATH) without forking the daemon, and waits for it within options.timeoutMs.
+// Returns E_OK once the child is reaped, whatever its exit status; see result.status and result.timedOut.
+int32_t RunChild(const std::vector<std::string> &cmd, const ChildRunOptions &options, ChildRunResult &result);
+// Installs the hook ForkExec* on the calling thread hand to RunChild as onOutput; returns the previous one.
+ChildOutputHook SetThreadChildOutputHook(ChildOutputHook hook);
 int ForkExec(std::vector<std::string> &cmd, std::vector<std::string> *output = nullptr,
              int *exitStatus = nullptr);
 int ForkExecWithExit(std::vector<std::string> &cmd, int *exitStatus = nullptr,
                      std::vector<std::string> *output = nullptr);
+// ForkExec with the child's stdin fed through a pipe by writer. A child that exits before reading it all
+// fails the writes with EPIPE; the child's own failure is returned first, then the writer's.
+int ForkExecWithInput(std::vector<std::string> &cmd, const ChildInputWriter &writer,
+                      std::vector<std::string> *output = nullptr);
 #ifdef EXTERNAL_STORAGE_QOS_TRANS
 int ExtStorageMountForkExec(std::vector<std::string> &cmd, int *exitStatus = nullptr);
 #endif
@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2026 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef STORAGE_DAEMON_UTILS_MOUNT_TABLE_H
+#define STORAGE_DAEMON_UTILS_MOUNT_TABLE_H
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace OHOS {
+namespace StorageDaemon {
+
+// Fields are kept escaped exactly as the kernel prints them, like the /proc/mounts readers did.
+struct MountEntry {
+    std::string_view source;
+    std::string_view target;
+    std::string_view fsType;
+};
+
+using MountEntryVisitor = std::function<void(const MountEntry &)>;
+
+// One parse of the mount table. Entries point into the snapshot's own buffer and stay
+// valid for as long as the snapshot is held.
+class MountTableSnapshot {
+public:
+    const std::vector<MountEntry> &GetEntries() const { return entries_; }
+    bool HasTarget(std::string_view target) const;
+    // Visit entries of any of the given types in mount order.
+    void ForEachOfTypes(const std::vector<std::string_view> &fsTypes, const MountEntryVisitor &visitor) const;
+    void ForEachTargetPrefix(std::string_view prefix, const MountEntryVisitor &visitor) const;
+    void ForEachSourcePrefix(std::string_view prefix, const MountEntryVisitor &visitor) const;
+
+private:
+    friend class MountTable;
+    void BuildIndex();
+
+    std::string buffer_;
+    std::vector<MountEntry> entries_;
+    std::vector<uint32_t> byTarget_;
+    std::vector<uint32_t> bySource_;
+    std::unordered_map<std::string_view, std::vector<uint32_t>> byType_;
+};
+
+// Cached view of /proc/self/mountinfo. The file is kept open and polled for the
+// kernel's mount-change notification, so the table is only re-parsed after a mount
+// or umount happened in the daemon's namespace.
+class MountTable {
+public:
+    static MountTable &GetInstance();
+
+    std::shared_ptr<const MountTableSnapshot> GetSnapshot();
+    void Invalidate();
+
+    static std::shared_ptr<MountTableSnapshot> Parse(std::string content);
+    static bool ParseMountInfoLine(std::string_view line, MountEntry &entry);
+    static bool ParseMountsLine(std::string_view line, MountEntry &entry);
+
+private:
+    MountTable() = default;
+    ~MountTable();
+    MountTable(const MountTable &) = delete;
+    MountTable &operator=(const MountTable &) = delete;
+
+    bool HasChanged();
+    bool ReadMountInfo(std::string &content);
+
+    std::mutex mutex_;
+    int fd_ = -1;
+    std::shared_ptr<const MountTableSnapshot> snapshot_;
+};
+} // namespace StorageDaemon
+} // namespace OHOS
+
+#endif // STORAGE_DAEMON_UTILS_MOUNT_TABLE_H
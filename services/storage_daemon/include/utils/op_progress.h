@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2026 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef STORAGE_DAEMON_UTILS_OP_PROGRESS_H
+#define STORAGE_DAEMON_UTILS_OP_PROGRESS_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+#include "utils/file_utils.h"
+
+namespace OHOS {
+namespace StorageDaemon {
+
+enum class OpPhase : int32_t {
+    IDLE = 0,
+    BUILDING_IMAGE,
+    WRITING,
+    FORMATTING,
+    VERIFYING,
+    DONE,
+    FAILED,
+};
+
+struct OpProgress {
+    OpPhase phase = OpPhase::IDLE;
+    uint64_t bytesDone = 0;
+    uint64_t bytesTotal = 0;
+    int32_t percent = 0;      // of the whole operation, never goes back
+    int64_t etaSec = -1;      // of the current phase, -1 until there is enough progress to estimate
+    int32_t lastError = 0;
+};
+
+// One progress report recognised in tool output; fields the line does not carry are left unset.
+struct OpProgressSample {
+    bool hasBytes = false;
+    uint64_t bytesDone = 0;
+    uint64_t bytesTotal = 0;
+    double percent = -1;
+    int64_t etaSec = -1;
+};
+
+using OpProgressCallback = std::function<void(const std::string &opId, const OpProgress &progress)>;
+
+// Progress of running disk operations, keyed by operation ID (the volume id, i.e. the devPath basename).
+// Writers update atomics, so polling it over IPC takes no file I/O and no lock on the state.
+// The percent covers the whole operation: each phase the operation plans gets a share of it by a fixed
+// weight, and a phase it did not plan fills what is left. A finished operation is kept a few seconds
+// so pollers see its result, then forgotten.
+class OpProgressRegistry {
+public:
+    static OpProgressRegistry &GetInstance();
+    static std::string GetOpId(const std::string &devPath);
+
+    // plan lists the phases the operation runs; they are expected in OpPhase order.
+    void Begin(const std::string &opId, std::initializer_list<OpPhase> plan = {});
+    void SetPhase(const std::string &opId, OpPhase phase);
+    void Update(const std::string &opId, const OpProgressSample &sample);
+    void Finish(const std::string &opId, int32_t err);
+    bool Get(const std::string &opId, OpProgress &progress);
+
+    // The callback runs on the reporting thread, on phase changes and whenever the percent moves by 1 or more.
+    void Subscribe(const std::string &opId, OpProgressCallback callback);
+    void Unsubscribe(const std::string &opId);
+
+private:
+    struct State {
+        std::atomic<int32_t> phase { static_cast<int32_t>(OpPhase::IDLE) };
+        std::atomic<uint64_t> bytesDone { 0 };
+        std::atomic<uint64_t> bytesTotal { 0 };
+        std::atomic<int32_t> percent { 0 };
+        std::atomic<int64_t> etaSec { -1 };
+        std::atomic<int32_t> lastError { 0 };
+        std::atomic<int64_t> phaseStartMs { 0 };
+        std::atomic<int32_t> notified { -1 };
+        std::atomic<uint32_t> planMask { 0 };
+        std::atomic<int32_t> phaseFrom { 0 };   // overall percent range of the current phase
+        std::atomic<int32_t> phaseTo { 0 };
+        std::atomic<int64_t> finishMs { 0 };
+    };
+
+    OpProgressRegistry() = default;
+    ~OpProgressRegistry() = default;
+    OpProgressRegistry(const OpProgressRegistry &) = delete;
+    OpProgressRegistry &operator=(const OpProgressRegistry &) = delete;
+
+    std::shared_ptr<State> GetState(const std::string &opId, bool create);
+    static void Reset(State &state, uint32_t planMask);
+    static void RaisePercent(State &state, int32_t percent);
+    void Notify(const std::string &opId, State &state, bool force);
+
+    std::mutex mutex_;
+    std::map<std::string, std::shared_ptr<State>> states_;
+    std::map<std::string, OpProgressCallback> callbacks_;
+};
+
+// Splits tool output into lines (\n or \r, as tools redraw progress in place) and recognises the
+// progress lines of genisoimage/mkisofs, wodim, growisofs and "done/total" counters of mkfs tools.
+class OpProgressParser {
+public:
+    explicit OpProgressParser(const std::string &opId) : opId_(opId) {}
+
+    void Feed(const char *data, size_t len);
+    static bool ParseLine(std::string_view line, OpProgressSample &sample);
+
+private:
+    std::string opId_;
+    std::string pending_;
+};
+
+// Puts opId into phase for the lifetime of the scope. Tools started with ForkExec* on this thread meanwhile
+// have their output parsed into the registry, and in-process work reports through ReportBytes.
+class OpProgressScope {
+public:
+    OpProgressScope(const std::string &opId, OpPhase phase);
+    ~OpProgressScope();
+    OpProgressScope(const OpProgressScope &) = delete;
+    OpProgressScope &operator=(const OpProgressScope &) = delete;
+
+    // Reports to the innermost scope of the calling thread; a no-op without one.
+    static void ReportBytes(uint64_t done, uint64_t total);
+
+private:
+    std::string opId_;
+    OpProgressParser parser_;
+    OpProgressScope *prev_ = nullptr;
+    ChildOutputHook prevHook_;
+};
+} // namespace StorageDaemon
+} // namespace OHOS
+
+#endif // STORAGE_DAEMON_UTILS_OP_PROGRESS_H
@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2026 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef STORAGE_DAEMON_UTILS_PROC_RESOURCE_SCANNER_H
+#define STORAGE_DAEMON_UTILS_PROC_RESOURCE_SCANNER_H
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace OHOS {
+namespace StorageDaemon {
+
+enum ProcResourceKind : uint32_t {
+    PROC_RES_FD = 1U << 0,
+    PROC_RES_MAPS = 1U << 1,
+    PROC_RES_CWD = 1U << 2,
+    PROC_RES_ROOT = 1U << 3,
+    PROC_RES_EXE = 1U << 4,
+    PROC_RES_LINKS = PROC_RES_CWD | PROC_RES_ROOT | PROC_RES_EXE,
+    PROC_RES_ALL = PROC_RES_FD | PROC_RES_MAPS | PROC_RES_LINKS,
+};
+
+struct ProcResource {
+    std::string path;   // link target or mapped file name as reported by the kernel
+    int32_t pid = 0;
+    uint32_t kinds = 0; // ProcResourceKind bits under which pid references path
+};
+
+// Immutable view of which process references which path. Entries are sorted by
+// path so prefix lookups are a binary search plus a short forward scan.
+class ProcResourceSnapshot {
+public:
+    // Visit every entry whose path starts with prefix and whose kinds intersect
+    // the given mask. Returning false from the visitor stops the walk.
+    void ForEachWithPrefix(const std::string &prefix, uint32_t kinds,
+                           const std::function<bool(const ProcResource &)> &visitor) const;
+    // Process name as the second field of /proc/<pid>/stat, empty if unknown.
+    std::string GetProcessName(int32_t pid) const;
+    uint32_t GetScannedKinds() const { return scannedKinds_; }
+    size_t GetPidCount() const { return names_.size(); }
+    size_t GetEntryCount() const { return resources_.size(); }
+
+private:
+    friend class ProcResourceScanner;
+    uint32_t scannedKinds_ = 0;
+    std::vector<ProcResource> resources_;
+    std::unordered_map<int32_t, std::string> names_;
+};
+
+// Walks /proc once for all occupancy queries (umount, volume eject, IsFileOccupied)
+// and hands out the result for a short validity window. Callers that change the
+// process table (kill) must Invalidate() so the next query sees the new state.
+class ProcResourceScanner {
+public:
+    static ProcResourceScanner &GetInstance();
+
+    std::shared_ptr<const ProcResourceSnapshot> GetSnapshot(uint32_t kinds);
+    void Invalidate();
+
+    static std::shared_ptr<ProcResourceSnapshot> Scan(const std::string &procRoot, uint32_t kinds);
+
+private:
+    ProcResourceScanner() = default;
+    ~ProcResourceScanner() = default;
+    ProcResourceScanner(const ProcResourceScanner &) = delete;
+    ProcResourceScanner &operator=(const ProcResourceScanner &) = delete;
+
+    std::mutex mutex_;
+    std::shared_ptr<const ProcResourceSnapshot> snapshot_;
+    std::chrono::steady_clock::time_point stamp_;
+    uint64_t generation_ = 0; // bumped by Invalidate
+};
+} // namespace StorageDaemon
+} // namespace OHOS
+
+#endif // STORAGE_DAEMON_UTILS_PROC_RESOURCE_SCANNER_H
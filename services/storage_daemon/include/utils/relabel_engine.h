@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2026 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef STORAGE_DAEMON_UTILS_RELABEL_ENGINE_H
+#define STORAGE_DAEMON_UTILS_RELABEL_ENGINE_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "utils/file_utils.h"
+
+namespace OHOS {
+namespace StorageDaemon {
+
+constexpr const char *RELABEL_DIGEST_XATTR = "trusted.storage_daemon.relabel_digest";
+
+struct RelabelReport {
+    std::string path;
+    int32_t err = 0;
+    TreeFixResult result;
+    int64_t durationMs = 0;
+};
+
+// Labels one path, not what is below it; returns E_OK on success.
+using RelabelFunc = std::function<int32_t(const std::string &path)>;
+using RelabelDoneFunc = std::function<void(const RelabelReport &report)>;
+
+/*
+ * Relabels trees with FixTreeAttrs, i.e. fd-relative on a bounded set of workers. A tree relabeled
+ * without errors gets the digest of the labeling policy stored in RELABEL_DIGEST_XATTR on its root,
+ * and any directory carrying the current digest is skipped with its subtree, so an unchanged tree
+ * costs one xattr read until the policy changes. An empty digest disables the skipping.
+ */
+class RelabelEngine {
+public:
+    // Restorecon as labeler, digest of the file_contexts in use.
+    static RelabelEngine &GetInstance();
+    static std::string ComputePolicyDigest(const std::vector<std::string> &policyFiles);
+
+    RelabelEngine(RelabelFunc labeler, const std::string &policyDigest);
+    ~RelabelEngine();
+    RelabelEngine(const RelabelEngine &) = delete;
+    RelabelEngine &operator=(const RelabelEngine &) = delete;
+
+    int32_t Relabel(const std::string &path);
+    int32_t RelabelTree(const std::string &path, TreeFixResult &result);
+    // Queues the tree for a background thread, which runs the queue in order and calls done when a tree is finished.
+    void RelabelTreeDeferred(const std::string &path, RelabelDoneFunc done = nullptr);
+    void WaitIdle();
+    const std::string &PolicyDigest() const
+    {
+        return digest_;
+    }
+
+private:
+    struct Job {
+        std::string path;
+        RelabelDoneFunc done;
+    };
+
+    void StartWorkerLocked();
+    void Drain();
+
+    RelabelFunc labeler_;
+    std::string digest_;
+    std::mutex mutex_;
+    std::condition_variable idleCv_;
+    std::deque<Job> pending_;
+    std::thread worker_;
+    bool running_ = false;
+};
+} // namespace StorageDaemon
+} // namespace OHOS
+
+#endif // STORAGE_DAEMON_UTILS_RELABEL_ENGINE_H
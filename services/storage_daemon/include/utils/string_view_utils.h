@@ -0,0 +1,44 @@
+/*
+ * Copyright (c) 2026 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef STORAGE_DAEMON_UTILS_STRING_VIEW_UTILS_H
+#define STORAGE_DAEMON_UTILS_STRING_VIEW_UTILS_H
+
+#include <cstdint>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "utils/string_utils.h"
+
+// Non-copying counterparts of the parsers in string_utils.h, which are thin wrappers around these.
+// Kept apart from string_utils.h because that header is also built as C++11.
+namespace OHOS {
+namespace StorageDaemon {
+using KeyValueView = std::pair<std::string_view, std::string_view>;
+
+// The tokens SplitLine returns, as views into line: empty tokens between two separators are kept,
+// a trailing empty token is not.
+std::vector<std::string_view> SplitView(std::string_view line, std::string_view token);
+// The pairs ParseKeyValuePairs returns, in the order their keys first appear; a repeated key keeps
+// its last value.
+void ParseKeyValueViews(std::string_view input, char delimiter, std::vector<KeyValueView> &pairs);
+// True for a non-empty string of ASCII digits only.
+bool IsAllDigits(std::string_view content);
+// The whole string must be an optional '-' and digits of the base, with no prefix or blanks.
+bool ParseInt64(std::string_view str, int64_t &value, int32_t base = BASE_DECIMAL);
+} // namespace StorageDaemon
+} // namespace OHOS
+#endif // STORAGE_DAEMON_UTILS_STRING_VIEW_UTILS_H
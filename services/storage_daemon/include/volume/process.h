@@ -34,7 +34,6 @@ private:
     std::string Readlink(std::string path);
     bool CheckSubDir(std::string line);
 
-    bool CheckMaps(std::string pidPath);
     bool CheckSymlink(std::string path);
     bool CheckFds(std::string pidPath);
 };
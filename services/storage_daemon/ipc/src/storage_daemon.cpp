@@ -22,6 +22,8 @@
 #include "utils/storage_xcollie.h"
 #include "utils/string_utils.h"
 #include "utils/file_utils.h"
+#include "utils/relabel_engine.h"
+#include <cinttypes>
 #include <dlfcn.h>
 #include <dirent.h>
 #include <fcntl.h>
@@ -1342,52 +1344,31 @@ int32_t StorageDaemon::RestoreconElX(uint32_t userId)
 {
     LOGI("[L1:StorageDaemon] RestoreconElX: >>> ENTER <<< userId=%{public}d", userId);
 #ifdef USE_LIBRESTORECON
-    int32_t ret = RestoreconRecurse((std::string(DATA_SERVICE_EL2) + "public").c_str());
-    if (ret != E_OK) {
-        LOGE("RestoreconRecurse el2 public failed, ret=%{public}d", ret);
-        StorageRadar::ReportUserKeyResult("RestoreconElX::RestoreconRecurse", userId, ret, "EL2",
-            "path=" + std::string(DATA_SERVICE_EL2) + "public");
+    auto &engine = RelabelEngine::GetInstance();
+    const std::string el2Public = std::string(DATA_SERVICE_EL2) + "public";
+    const std::string userEl2 = std::string(DATA_SERVICE_EL2) + std::to_string(userId);
+    // Only the entry directories the unlocked user goes through are labeled before returning. The trees
+    // below them are relabeled in the background, and skipped while their stored policy digest is current.
+    const std::vector<std::string> topDirs = { el2Public, userEl2 + "/share", userEl2 + "/hmdfs/",
+        userEl2 + "/hmdfs/account/files/", userEl2 + "/hmdfs/account/files/.Recent" };
+    for (const auto &dir : topDirs) {
+        int32_t ret = engine.Relabel(dir);
+        if (ret != E_OK) {
+            LOGE("[L1:StorageDaemon] RestoreconElX: Restorecon %{public}s failed, ret=%{public}d", dir.c_str(), ret);
+            StorageRadar::ReportUserKeyResult("RestoreconElX::Restorecon", userId, ret, "EL2", "path=" + dir);
+        }
     }
-    const std::string &path = std::string(DATA_SERVICE_EL2) + std::to_string(userId);
-    LOGI("[L1:StorageDaemon] RestoreconRecurse el2 public end, userId = %{public}d", userId);
+    auto onDone = [userId](const RelabelReport &report) {
+        LOGI("[L1:StorageDaemon] RestoreconElX: tree %{public}s done in %{public}" PRId64 " ms, "
+            "ret=%{public}d, userId=%{public}d", report.path.c_str(), report.durationMs, report.err, userId);
+        if (report.err != E_OK) {
+            StorageRadar::ReportUserKeyResult("RestoreconElX::RestoreconRecurse", userId, report.err, "EL2",
+                "path=" + report.path);
+        }
+    };
+    engine.RelabelTreeDeferred(el2Public, onDone);
     UserManager::GetInstance().RestoreconSystemServiceDirs(userId);
-    LOGI("[L1:StorageDaemon] RestoreconSystemServiceDirs el2 end, userId = %{public}d", userId);
-    ret = RestoreconRecurse((std::string(DATA_SERVICE_EL2) + std::to_string(userId) + "/share").c_str());
-    if (ret != E_OK) {
-        LOGE("RestoreconRecurse el2 share failed, ret=%{public}d", ret);
-        StorageRadar::ReportUserKeyResult("RestoreconElX::RestoreconRecurse", userId, ret, "EL2",
-            "path=" + std::string(DATA_SERVICE_EL2) + std::to_string(userId) + "/share");
-    }
-    LOGI("[L1:StorageDaemon] RestoreconRecurse el2 share end, userId = %{public}d", userId);
-    const std::string &DATA_SERVICE_EL2_HMDFS = std::string(DATA_SERVICE_EL2) + std::to_string(userId) + "/hmdfs/";
-    ret = Restorecon(DATA_SERVICE_EL2_HMDFS.c_str());
-    if (ret != E_OK) {
-        LOGE("Restorecon el2 DATA_SERVICE_EL2_HMDFS failed, ret=%{public}d", ret);
-        StorageRadar::ReportUserKeyResult("RestoreconElX::Restorecon", userId, ret, "EL2",
-            "path=" + DATA_SERVICE_EL2_HMDFS);
-    }
-    LOGI("[L1:StorageDaemon] Restorecon el2 DATA_SERVICE_EL2_HMDFS end, userId = %{public}d", userId);
-    const std::string &ACCOUNT_FILES = "/hmdfs/account/files/";
-    const std::string &EL2_HMDFS_ACCOUNT_FILES = std::string(DATA_SERVICE_EL2) + std::to_string(userId) +
-        ACCOUNT_FILES;
-    ret = Restorecon(EL2_HMDFS_ACCOUNT_FILES.c_str());
-    if (ret != E_OK) {
-        LOGE("Restorecon el2 DATA_SERVICE_EL2_HMDFS_ACCOUNT_FILES failed, ret=%{public}d", ret);
-        StorageRadar::ReportUserKeyResult("RestoreconElX::Restorecon", userId, ret, "EL2",
-            "path=" + EL2_HMDFS_ACCOUNT_FILES);
-    }
-    LOGI("[L1:StorageDaemon] Restorecon el2 DATA_SERVICE_EL2_HMDFS_ACCOUNT_FILES end, userId = %{public}d", userId);
-    const std::string &FILES_RECENT = "/hmdfs/account/files/.Recent";
-    const std::string &EL2_HMDFS_ACCOUNT_FILES_RECENT = std::string(DATA_SERVICE_EL2) + std::to_string(userId) +
-        FILES_RECENT;
-    ret = Restorecon(EL2_HMDFS_ACCOUNT_FILES_RECENT.c_str());
-    if (ret != E_OK) {
-        LOGE("Restorecon el2 DATA_SERVICE_EL2_HMDFS_ACCOUNT_FILES_RECENT failed, ret=%{public}d", ret);
-        StorageRadar::ReportUserKeyResult("RestoreconElX::Restorecon", userId, ret, "EL2",
-            "path=" + EL2_HMDFS_ACCOUNT_FILES_RECENT);
-    }
-    LOGI("[L1:StorageDaemon] Restorecon el2 DATA_SERVICE_EL2_HMDFS_ACCOUNT_FILES_RECENT end, "
-        "userId = %{public}d", userId);
+    engine.RelabelTreeDeferred(userEl2 + "/share", onDone);
 #endif
     LOGI("[L1:StorageDaemon] RestoreconElX: <<< EXIT SUCCESS <<< userId=%{public}d", userId);
     return E_OK;
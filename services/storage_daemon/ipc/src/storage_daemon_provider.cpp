@@ -65,6 +65,7 @@
 #include "disk_manager/volume/volume_utils.h"
 #include "disk_manager/volume/volume_operator_factory.h"
 #include "utils/file_utils.h"
+#include "utils/op_progress.h"
 #include "utils/volume_op_diag.h"
 #endif
 
@@ -81,6 +82,7 @@ constexpr unsigned int USER100ID = 100;
 constexpr unsigned int RADAR_STATISTIC_THREAD_WAIT_SECONDS = 60;
 constexpr unsigned int MAX_URI_COUNT = 200000;
 constexpr size_t MAX_IPC_RAW_DATA_SIZE = 128 * 1024 * 1024; // 128M
+constexpr size_t MAX_DATA_SIZE_PATHS = 32;
 constexpr pid_t STORAGE_MANAGER_UID = 1090;
 constexpr pid_t DISK_MANAGER_UID = 1091;
 
@@ -2019,6 +2021,35 @@ int32_t StorageDaemonProvider::QueryOccupiedSpaceForSa(std::vector<UidSaInfo> &v
     return E_OK;
 }
 
+int32_t StorageDaemonProvider::QueryOccupiedSpaceForAll(std::vector<UidSaInfo> &sysSaVec,
+    std::vector<UidSaInfo> &sysAppVec, std::vector<UidSaInfo> &userAppVec, std::vector<UidSaInfo> &otherAppVec,
+    int64_t &saTotalSize, int64_t &otherTotalSize, const std::map<int32_t, std::string> &bundleNameAndUid)
+{
+    LOGI("[L1:StorageDaemonProvider] QueryOccupiedSpaceForAll: >>> ENTER <<< bundleNameAndUid.size=%{public}zu",
+        bundleNameAndUid.size());
+    HiAudit::GetInstance().WriteStart("QueryOccupiedSpaceForAll");
+    auto uid = IPCSkeleton::GetCallingUid();
+    if (uid != STORAGE_MANAGER_UID) {
+        LOGE("[L1:StorageDaemonProvider] QueryOccupiedSpaceForAll: <<< EXIT FAILED <<< uid=%{public}d is invalid",
+            uid);
+        return E_PERMISSION_DENIED;
+    }
+    AllAppVec allVec;
+    int32_t ret = QuotaManager::GetInstance().GetAllUidStorageStats(allVec, saTotalSize, otherTotalSize,
+        bundleNameAndUid);
+    HiAudit::GetInstance().WriteEnd("QueryOccupiedSpaceForAll", ret);
+    if (ret != E_OK) {
+        LOGE("[L1:StorageDaemonProvider] QueryOccupiedSpaceForAll: <<< EXIT FAILED <<< ret=%{public}d", ret);
+        return ret;
+    }
+    sysSaVec.swap(allVec.sysSaVec);
+    sysAppVec.swap(allVec.sysAppVec);
+    userAppVec.swap(allVec.userAppVec);
+    otherAppVec.swap(allVec.otherAppVec);
+    LOGI("[L1:StorageDaemonProvider] QueryOccupiedSpaceForAll: <<< EXIT SUCCESS <<<");
+    return E_OK;
+}
+
 int32_t StorageDaemonProvider::RegisterUeceActivationCallback(
     const sptr<StorageManager::IUeceActivationCallback> &ueceCallback)
 {
@@ -2186,6 +2217,37 @@ int32_t StorageDaemonProvider::GetDataSizeByPath(const std::string &path, int64_
     return ret;
 }
 
+int32_t StorageDaemonProvider::GetDataSizeByPaths(const std::vector<std::string> &paths,
+    std::vector<int64_t> &sizes)
+{
+    HiAudit::GetInstance().WriteStart("GetDataSizeByPaths", "count: " + std::to_string(paths.size()));
+    LOGI("[L1:StorageDaemonProvider] GetDataSizeByPaths: >>> ENTER <<< count=%{public}zu", paths.size());
+    auto uid = IPCSkeleton::GetCallingUid();
+    if (uid != STORAGE_MANAGER_UID) {
+        LOGE("[L1:StorageDaemonProvider] GetDataSizeByPaths: <<< EXIT FAILED <<< uid=%{public}d is invalid", uid);
+        return E_PERMISSION_DENIED;
+    }
+    if (paths.empty() || paths.size() > MAX_DATA_SIZE_PATHS) {
+        LOGE("[L1:StorageDaemonProvider] GetDataSizeByPaths: <<< EXIT FAILED <<< invalid count=%{public}zu",
+            paths.size());
+        return E_PARAMS_INVALID;
+    }
+    // every entry is filled so the caller can tell which path failed; the first error is returned
+    int32_t ret = E_OK;
+    sizes.assign(paths.size(), -1);
+    for (size_t i = 0; i < paths.size(); i++) {
+        int64_t size = 0;
+        int32_t err = QuotaManager::GetInstance().GetFileData(paths[i], size);
+        if (err != E_OK) {
+            ret = (ret == E_OK) ? err : ret;
+            continue;
+        }
+        sizes[i] = size;
+    }
+    HiAudit::GetInstance().WriteEnd("GetDataSizeByPaths", ret);
+    return ret;
+}
+
 int32_t StorageDaemonProvider::GetSystemDataSize(int64_t &otherUidSizeSum)
 {
     HiAudit::GetInstance().WriteStart("GetSystemDataSize");
@@ -2921,7 +2983,9 @@ int32_t StorageDaemonProvider::FormatPartition(const std::string &devPath, const
 
     LOGI("[L1:StorageDaemonProvider] FormatPartition: >>> ENTER <<< devPath=%{public}s, fsType=%{public}s"
          ", volumeName=%{public}s", verifiedPath.c_str(), fsType.c_str(), volumeName.c_str());
+    OpProgressRegistry::GetInstance().Begin(OpProgressRegistry::GetOpId(verifiedPath), { OpPhase::FORMATTING });
     ret = DiskUtils::FormatPartition(verifiedPath, fsType, volumeName, quickFormat);
+    OpProgressRegistry::GetInstance().Finish(OpProgressRegistry::GetOpId(verifiedPath), ret);
     if (ret == E_OK) {
         std::vector<std::string> output;
         std::vector<std::string> cmdArgs = cmd;
@@ -3040,7 +3104,10 @@ int32_t StorageDaemonProvider::CreateIsoImage(const std::string &devPath,
         return E_NOT_SUPPORT;
     }
 
+    OpProgressRegistry::GetInstance().Begin(OpProgressRegistry::GetOpId(verifiedDevPath),
+        { OpPhase::BUILDING_IMAGE });
     ret = op->CreateIsoImage(verifiedDevPath, filePath, verifiedMountPath);
+    OpProgressRegistry::GetInstance().Finish(OpProgressRegistry::GetOpId(verifiedDevPath), ret);
     if (ret != E_OK) {
         LOGE("[L1:StorageDaemonProvider] CreateIsoImage: <<< EXIT FAILED <<< ret=%{public}d", ret);
         return ret;
@@ -3090,7 +3157,14 @@ int32_t StorageDaemonProvider::Burn(const std::string &devPath,
         LOGE("[L1:StorageDaemonProvider] Burn: no operator for fsType=%{public}s", parsedOptions.fsType.c_str());
         return E_NOT_SUPPORT;
     }
+    if (parsedOptions.isIsoImage) {
+        OpProgressRegistry::GetInstance().Begin(OpProgressRegistry::GetOpId(verifiedPath), { OpPhase::WRITING });
+    } else {
+        OpProgressRegistry::GetInstance().Begin(OpProgressRegistry::GetOpId(verifiedPath),
+            { OpPhase::BUILDING_IMAGE, OpPhase::WRITING });
+    }
     ret = op->Burn(verifiedPath, parsedOptions);
+    OpProgressRegistry::GetInstance().Finish(OpProgressRegistry::GetOpId(verifiedPath), ret);
     if (ret != E_OK) {
         LOGE("[L1:StorageDaemonProvider] Burn: <<< EXIT FAILED <<< ret=%{public}d", ret);
         return ret;
@@ -3147,7 +3221,9 @@ int32_t StorageDaemonProvider::VerifyBurnData(const std::string &devPath, int32_
         return ret;
     }
 
+    OpProgressRegistry::GetInstance().Begin(OpProgressRegistry::GetOpId(verifiedPath), { OpPhase::VERIFYING });
     ret = DiskUtils::VerifyBurnData(verifiedPath, verifyType);
+    OpProgressRegistry::GetInstance().Finish(OpProgressRegistry::GetOpId(verifiedPath), ret);
     if (ret != E_OK) {
         LOGE("[L1:StorageDaemonProvider] VerifyBurnData: <<< EXIT FAILED <<< ret=%{public}d", ret);
         return ret;
@@ -29,11 +29,13 @@
 #include <climits>
 #include <cstdlib>
 #include <cstring>
+#include <fstream>
 #include <gtest/gtest.h>
 #include <map>
 #include <memory>
 #include <mutex>
 #include <thread>
+#include <unistd.h>
 #include <vector>
 
 namespace {
@@ -2188,6 +2190,78 @@ HWTEST_F(StorageDaemonProviderTest, StorageDaemonProvider_GetDataSizeByPath_001,
     GTEST_LOG_(INFO) << "StorageDaemonProvider_GetDataSizeByPath_001 end";
 }
 
+/**
+ * @tc.number: SUB_STORAGE_StorageDaemonProvider_GetDataSizeByPaths_001
+ * @tc.name: StorageDaemonProvider_GetDataSizeByPaths_001
+ * @tc.desc: Test function of GetDataSizeByPaths interface using mock.
+ * @tc.size: MEDIUM
+ * @tc.type: FUNC
+ * @tc.level Level 1
+ * @tc.require:
+ */
+HWTEST_F(StorageDaemonProviderTest, StorageDaemonProvider_GetDataSizeByPaths_001, TestSize.Level1)
+{
+    GTEST_LOG_(INFO) << "StorageDaemonProvider_GetDataSizeByPaths_001 start";
+    SetCallingUid(STORAGE_MANAGER_UID);
+
+    ASSERT_TRUE(storageDaemonProviderTest_ != nullptr);
+    std::vector<std::string> paths;
+    std::vector<int64_t> sizes;
+    int32_t result = storageDaemonProviderTest_->GetDataSizeByPaths(paths, sizes);
+    EXPECT_EQ(result, E_PARAMS_INVALID);
+
+    paths = {"/data/test/file.txt", "/data/test/file2.txt"};
+    result = storageDaemonProviderTest_->GetDataSizeByPaths(paths, sizes);
+    EXPECT_EQ(result, E_FILE_PATH_INVALID);
+    ASSERT_EQ(sizes.size(), paths.size());
+    EXPECT_EQ(sizes[0], -1);
+    EXPECT_EQ(sizes[1], -1);
+
+    GTEST_LOG_(INFO) << "StorageDaemonProvider_GetDataSizeByPaths_001 end";
+}
+
+/**
+ * @tc.number: SUB_STORAGE_StorageDaemonProvider_GetDataSizeByPaths_002
+ * @tc.name: StorageDaemonProvider_GetDataSizeByPaths_002
+ * @tc.desc: Verify every batched size equals the single-path GetFileData result, an empty file included.
+ * @tc.size: MEDIUM
+ * @tc.type: FUNC
+ * @tc.level Level 1
+ * @tc.require:
+ */
+HWTEST_F(StorageDaemonProviderTest, StorageDaemonProvider_GetDataSizeByPaths_002, TestSize.Level1)
+{
+    GTEST_LOG_(INFO) << "StorageDaemonProvider_GetDataSizeByPaths_002 start";
+    SetCallingUid(STORAGE_MANAGER_UID);
+    ASSERT_TRUE(storageDaemonProviderTest_ != nullptr);
+
+    std::vector<std::string> paths = {"/data/local/tmp/data_size_ut_0", "/data/local/tmp/data_size_ut_1",
+        "/data/local/tmp/data_size_ut_2"};
+    std::vector<std::string> contents = {"100\n200\n", "7\n", ""};
+    for (size_t i = 0; i < paths.size(); i++) {
+        std::ofstream out(paths[i], std::ios::trunc);
+        out << contents[i];
+    }
+
+    std::vector<int64_t> sizes;
+    int32_t result = storageDaemonProviderTest_->GetDataSizeByPaths(paths, sizes);
+    EXPECT_EQ(result, E_OK);
+    ASSERT_EQ(sizes.size(), paths.size());
+    for (size_t i = 0; i < paths.size(); i++) {
+        int64_t single = 0;
+        EXPECT_EQ(QuotaManager::GetInstance().GetFileData(paths[i], single), E_OK);
+        EXPECT_EQ(sizes[i], single);
+    }
+    EXPECT_EQ(sizes[0], 300);
+    EXPECT_EQ(sizes[1], 7);
+    EXPECT_EQ(sizes[2], 0);
+
+    for (const auto &path : paths) {
+        unlink(path.c_str());
+    }
+    GTEST_LOG_(INFO) << "StorageDaemonProvider_GetDataSizeByPaths_002 end";
+}
+
 /**
  * @tc.number: SUB_STORAGE_StorageDaemonProvider_GetRmgResourceSize_001
  * @tc.name: StorageDaemonProvider_GetRmgResourceSize_001
@@ -104,6 +104,7 @@ public:
     MOCK_METHOD1(ListUserdataDirInfo, int32_t(std::vector<UserdataDirInfo> &));
 
     MOCK_METHOD2(GetDataSizeByPath, int32_t(const std::string &, int64_t &));
+    MOCK_METHOD2(GetDataSizeByPaths, int32_t(const std::vector<std::string> &, std::vector<int64_t> &));
     MOCK_METHOD2(GetRmgResourceSize, int32_t(const std::string &, uint64_t &));
     MOCK_METHOD1(GetSystemDataSize, int32_t(int64_t &));
     MOCK_METHOD5(GetDirListSpaceByPaths, int32_t(const std::vector<std::string> &, const std::vector<int32_t> &,
@@ -127,6 +128,9 @@ public:
     MOCK_METHOD3(GetCapacity, int32_t(const std::string &, int64_t &, int64_t &));
     MOCK_METHOD2(GetDiskSize, int32_t(const std::string &, uint64_t &));
     MOCK_METHOD4(BindBlockLoopDev, int32_t(const std::string &, uint64_t, uint64_t, std::string &));
+    MOCK_METHOD7(QueryOccupiedSpaceForAll, int32_t(std::vector<UidSaInfo> &, std::vector<UidSaInfo> &,
+        std::vector<UidSaInfo> &, std::vector<UidSaInfo> &, int64_t &, int64_t &,
+        const std::map<int32_t, std::string> &));
     };
 }  // namespace StorageDaemon
 }  // namespace OHOS
@@ -27,6 +27,7 @@
 #include "init_utils.h"
 #include "key_control.h"
 #include "securec.h"
+#include "storage_radar_c.h"
 #include <sys/ioctl.h>
 
 #ifdef SUPPORT_RECOVERY_KEY_SERVICE
@@ -311,60 +312,24 @@ static int ReadKeyFile(const char *path, char *buf, size_t len)
     return 0;
 }
 
-static int SetPolicyLegacy(const char *keyDescPath,
-                           const char *toEncrypt,
-                           union FscryptPolicy *arg)
+static int LoadPolicyKey(const char *keyDir, const char *name, char *buf, size_t len)
 {
-    char keyDesc[FSCRYPT_KEY_DESCRIPTOR_SIZE] = {0};
-    int ret = ReadKeyFile(keyDescPath, keyDesc, FSCRYPT_KEY_DESCRIPTOR_SIZE);
-    if (ret != 0) {
-        return ret;
-    }
-    arg->v1.version = FSCRYPT_POLICY_V1;
-    ret = memcpy_s(arg->v1.master_key_descriptor,
-        FSCRYPT_KEY_DESCRIPTOR_SIZE, keyDesc, FSCRYPT_KEY_DESCRIPTOR_SIZE);
-    if (ret != 0) {
-        LOGE("memcpy_s copy failed");
-        return ret;
-    }
-    ret = KeyCtrlSetPolicy(toEncrypt, arg);
-    if (ret != 0) {
-        LOGE("Set Policy v1 failed");
-        return ret;
-    }
-    return 0;
-}
-
-#ifdef SUPPORT_FSCRYPT_V2
-static int SetPolicyV2(const char *keyIdPath,
-                       const char *toEncrypt,
-                       union FscryptPolicy *arg)
-{
-    char keyId[FSCRYPT_KEY_IDENTIFIER_SIZE] = {0};
-    int ret = ReadKeyFile(keyIdPath, keyId, FSCRYPT_KEY_IDENTIFIER_SIZE);
-    if (ret != 0) {
-        return ret;
-    }
-    arg->v2.version = FSCRYPT_POLICY_V2;
-    ret = memcpy_s(arg->v2.master_key_identifier,
-        FSCRYPT_KEY_IDENTIFIER_SIZE, keyId, FSCRYPT_KEY_IDENTIFIER_SIZE);
-    if (ret != 0) {
-        LOGE("memcpy_s copy failed");
-        return ret;
-    }
-    ret = KeyCtrlSetPolicy(toEncrypt, arg);
+    char *pathBuf = NULL;
+    int ret = SpliceKeyPath(keyDir, strlen(keyDir), name, strlen(name), &pathBuf);
     if (ret != 0) {
-        LOGE("Set Policy v2 failed");
+        LOGE("path splice error");
+        SAFE_FREE_PTR(pathBuf);
         return ret;
     }
-    return 0;
+    ret = ReadKeyFile(pathBuf, buf, len);
+    SAFE_FREE_PTR(pathBuf);
+    return ret;
 }
-#endif
 
-int LoadAndSetPolicy(const char *keyDir, const char *dir)
+int LoadPolicyContext(const char *keyDir, struct FscryptPolicyContext *ctx)
 {
-    if (!keyDir || !dir) {
-        LOGE("set policy parameters is null");
+    if (!keyDir || !ctx) {
+        LOGE("load policy parameters is null");
         return -EINVAL;
     }
     int ret = InitFscryptPolicy();
@@ -373,120 +338,156 @@ int LoadAndSetPolicy(const char *keyDir, const char *dir)
         return ret;
     }
 
-    union FscryptPolicy arg;
-    (void)memset_s(&arg, sizeof(arg), 0, sizeof(arg));
-    arg.v1.filenames_encryption_mode = g_fscryptPolicy.fileName;
-    arg.v1.contents_encryption_mode = g_fscryptPolicy.content;
-    arg.v1.flags = g_fscryptPolicy.flags;
+    union FscryptPolicy *arg = &ctx->policy;
+    (void)memset_s(arg, sizeof(*arg), 0, sizeof(*arg));
+    arg->v1.filenames_encryption_mode = g_fscryptPolicy.fileName;
+    arg->v1.contents_encryption_mode = g_fscryptPolicy.content;
+    arg->v1.flags = g_fscryptPolicy.flags;
 
-    char *pathBuf = NULL;
     ret = -ENOTSUP;
-
     uint8_t fscryptVer = KeyCtrlLoadVersion(keyDir);
     if (fscryptVer == FSCRYPT_V1) {
-        ret = SpliceKeyPath(keyDir, strlen(keyDir), PATH_KEYDESC,
-            strlen(PATH_KEYDESC), &pathBuf);
+        arg->v1.version = FSCRYPT_POLICY_V1;
+        ret = LoadPolicyKey(keyDir, PATH_KEYDESC, (char *)arg->v1.master_key_descriptor,
+            FSCRYPT_KEY_DESCRIPTOR_SIZE);
         if (ret != 0) {
-            LOGE("path splice error");
-            SAFE_FREE_PTR(pathBuf);
-            return ret;
-        }
-        ret = SetPolicyLegacy(pathBuf, dir, &arg);
-        if (ret != 0) {
-            LOGE("SetPolicyLegacy fail, ret: %{public}d", ret);
+            LOGE("load policy v1 key desc fail, ret: %{public}d", ret);
         }
 #ifdef SUPPORT_FSCRYPT_V2
     } else if (fscryptVer == FSCRYPT_V2) {
-        ret = SpliceKeyPath(keyDir, strlen(keyDir), PATH_KEYID,
-            strlen(PATH_KEYID), &pathBuf);
-        if (ret != 0) {
-            LOGE("path splice error");
-            SAFE_FREE_PTR(pathBuf);
-            return ret;
-        }
-        ret = SetPolicyV2(pathBuf, dir, &arg);
+        arg->v2.version = FSCRYPT_POLICY_V2;
+        ret = LoadPolicyKey(keyDir, PATH_KEYID, (char *)arg->v2.master_key_identifier,
+            FSCRYPT_KEY_IDENTIFIER_SIZE);
         if (ret != 0) {
-            LOGE("SetPolicyV2 fail, ret: %{public}d", ret);
+            LOGE("load policy v2 key id fail, ret: %{public}d", ret);
         }
 #endif
     }
-    SAFE_FREE_PTR(pathBuf);
     return ret;
 }
 
-static int ActSetFileXattrActSetFileXattr(const char *path, char *keyDesc, int storageType)
+int LoadSdpPolicyContext(const char *keyDir, int type, struct FscryptPolicyContext *ctx)
 {
-    struct FscryptSdpPolicy PolicySDP = {0, 0, 0, 0, 0, {0, 0, 0, 0, 0, 0, 0, 0}};
-    PolicySDP.version = SDP_VERSIOIN;
-    PolicySDP.sdpclass = storageType;
-    PolicySDP.contentsEncryptionMode = SDP_CONTENTS_ENCRYPTION_MODE;
-    PolicySDP.filenamesEncryptionMode = SDP_FILENAMES_ENCRYPTION_MODE;
-    PolicySDP.flags = SDP_FLAGS;
-
-    int ret = memcpy_s((char *)PolicySDP.masterKeyDescriptor, FS_KEY_DESC_SIZE, (char *)keyDesc,
-                       FSCRYPT_KEY_DESCRIPTOR_SIZE);
+    int el3Key = 3; // el3
+    int el4Key = 4; // el4
+    if (!keyDir || !ctx) {
+        LOGE("load sdp policy parameters is null");
+        return -EINVAL;
+    }
+    ctx->hasSdpPolicy = false;
+    // sdp classes only exist for v1 keys, v2 directories need nothing beyond the el policy
+    if (KeyCtrlLoadVersion(keyDir) != FSCRYPT_V1 || (type != el3Key && type != el4Key)) {
+        return 0;
+    }
+
+    struct FscryptSdpPolicy *policy = &ctx->sdpPolicy;
+    (void)memset_s(policy, sizeof(*policy), 0, sizeof(*policy));
+    policy->version = SDP_VERSIOIN;
+    policy->sdpclass = (type == el3Key) ? FSCRYPT_SDP_SECE_CLASS : FSCRYPT_SDP_ECE_CLASS;
+    policy->contentsEncryptionMode = SDP_CONTENTS_ENCRYPTION_MODE;
+    policy->filenamesEncryptionMode = SDP_FILENAMES_ENCRYPTION_MODE;
+    policy->flags = SDP_FLAGS;
+    int ret = LoadPolicyKey(keyDir, PATH_KEYDESC, (char *)policy->masterKeyDescriptor, FS_KEY_DESC_SIZE);
     if (ret != 0) {
-        LOGE("memcpy_s copy failed");
-        return -errno;
+        return ret;
     }
-    int fd = open((char *)path, O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+    ctx->hasSdpPolicy = true;
+    return 0;
+}
+
+int OpenPolicyDir(const char *dir)
+{
+    if (!dir) {
+        LOGE("policy dir is null");
+        return -EINVAL;
+    }
+    char *realPath = realpath(dir, NULL);
+    if (realPath == NULL) {
+        LOGE("realpath failed");
+        return -ENOENT;
+    }
+    int fd = open(realPath, O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+    free(realPath);
     if (fd < 0) {
-        LOGE("install File or Directory open failed: %{public}d", errno);
-        return -errno;
+        int errNo = errno;
+        RADAR_REPORT(dir, "fd open failed! ", errNo);
+        LOGE("open %{public}s failed, errno:%{public}d", dir, errNo);
+        return -errNo;
+    }
+    return fd;
+}
+
+int SetPolicyByFd(const struct FscryptPolicyContext *ctx, int dirFd, const char *dir)
+{
+    if (!ctx || dirFd < 0) {
+        LOGE("set policy parameters is invalid");
+        return -EINVAL;
     }
-    ret = ioctl(fd, F2FS_IOC_SET_SDP_ENCRYPTION_POLICY, &PolicySDP);
+    if (ioctl(dirFd, FS_IOC_SET_ENCRYPTION_POLICY, (void *)&ctx->policy) != 0) {
+        int errNo = errno;
+        RADAR_REPORT(dir ? dir : "", "set policy failed! ", errNo);
+        LOGE("set policy to %{public}s failed, errno:%{public}d", dir ? dir : "", errNo);
+        return errNo;
+    }
+    return 0;
+}
+
+int SetSdpPolicyByFd(const struct FscryptPolicyContext *ctx, int dirFd)
+{
+    if (!ctx || dirFd < 0) {
+        LOGE("set sdp policy parameters is invalid");
+        return -EINVAL;
+    }
+    if (!ctx->hasSdpPolicy) {
+        return 0;
+    }
+    int ret = ioctl(dirFd, F2FS_IOC_SET_SDP_ENCRYPTION_POLICY, (void *)&ctx->sdpPolicy);
     if (ret != 0) {
         LOGE("ioctl fbex_cmd failed, ret: 0x%{public}X, errno: %{public}d", ret, errno);
-        close(fd);
         return ret;
     }
-    close(fd);
-    return ret;
+    return 0;
 }
 
-int LoadAndSetEceAndSecePolicy(const char *keyDir, const char *dir, int type)
+int LoadAndSetPolicy(const char *keyDir, const char *dir)
 {
-    int el3Key = 3; // el3
-    int el4Key = 4; // el4
     if (!keyDir || !dir) {
         LOGE("set policy parameters is null");
         return -EINVAL;
     }
-    char *pathBuf = NULL;
-    int ret = SpliceKeyPath(keyDir, strlen(keyDir), PATH_KEYDESC, strlen(PATH_KEYDESC), &pathBuf);
+    struct FscryptPolicyContext ctx;
+    int ret = LoadPolicyContext(keyDir, &ctx);
     if (ret != 0) {
-        LOGE("path splice error");
         return ret;
     }
+    ret = KeyCtrlSetPolicy(dir, &ctx.policy);
+    if (ret != 0) {
+        LOGE("Set Policy failed, ret: %{public}d", ret);
+    }
+    return ret;
+}
 
-    uint8_t fscryptVer = KeyCtrlLoadVersion(keyDir);
-    if (fscryptVer == FSCRYPT_V1) {
-        if (type == el3Key || type == el4Key) {
-            if (type == el3Key) {
-                type = FSCRYPT_SDP_SECE_CLASS;
-            } else {
-                type = FSCRYPT_SDP_ECE_CLASS;
-            }
-            char keyDesc[FSCRYPT_KEY_DESCRIPTOR_SIZE] = {0};
-            ret = ReadKeyFile(pathBuf, keyDesc, FSCRYPT_KEY_DESCRIPTOR_SIZE);
-            if (ret != 0) {
-                SAFE_FREE_PTR(pathBuf);
-                return ret;
-            }
-            ret = ActSetFileXattrActSetFileXattr(dir, keyDesc, type);
-            if (ret != 0) {
-                SAFE_FREE_PTR(pathBuf);
-                LOGE("ActSetFileXattr failed");
-                return ret;
-            }
-        }
-#ifdef SUPPORT_FSCRYPT_V2
-    } else if (fscryptVer == FSCRYPT_V2) {
-        SAFE_FREE_PTR(pathBuf);
-        return 0;
-#endif
+int LoadAndSetEceAndSecePolicy(const char *keyDir, const char *dir, int type)
+{
+    if (!keyDir || !dir) {
+        LOGE("set policy parameters is null");
+        return -EINVAL;
     }
-    SAFE_FREE_PTR(pathBuf);
+    struct FscryptPolicyContext ctx;
+    int ret = LoadSdpPolicyContext(keyDir, type, &ctx);
+    if (ret != 0 || !ctx.hasSdpPolicy) {
+        return ret;
+    }
+    int fd = open(dir, O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+    if (fd < 0) {
+        LOGE("install File or Directory open failed: %{public}d", errno);
+        return -errno;
+    }
+    ret = SetSdpPolicyByFd(&ctx, fd);
+    if (ret != 0) {
+        LOGE("ActSetFileXattr failed");
+    }
+    close(fd);
     return ret;
 }
 
@@ -0,0 +1,207 @@
+/*
+ * Copyright (C) 2026 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstdarg>
+#include <fcntl.h>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <string>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <vector>
+
+#include "fscrypt_control.h"
+
+using namespace testing::ext;
+using namespace std;
+
+namespace {
+#ifdef __GLIBC__
+using IoctlRequest = unsigned long;
+#else
+using IoctlRequest = int;
+#endif
+
+const string TEST_ROOT = "/data/local/tmp/policy_context_test";
+const string KEY_DIR = TEST_ROOT + "/key";
+const string SDP_KEY_DIR = TEST_ROOT + "/sdp_key";
+const string POLICY_CONFIG = "2:aes-256-cts:aes-256-xts";
+constexpr int EL3_TYPE = 3;
+// Roughly the directories PrepareUserDirs hands to SetDirectoryElPolicy for one user.
+constexpr size_t DIRS_PER_EL = 12;
+constexpr size_t USER_ELS = 4;
+
+uint32_t g_readCount = 0;
+uint32_t g_setPolicyCount = 0;
+uint32_t g_setSdpPolicyCount = 0;
+
+void WriteTestFile(const string &path, const string &content)
+{
+    ofstream file(path, ios::out | ios::trunc | ios::binary);
+    file << content;
+}
+
+void ResetCounters()
+{
+    g_readCount = 0;
+    g_setPolicyCount = 0;
+    g_setSdpPolicyCount = 0;
+}
+}
+
+extern "C" ssize_t read(int fd, void *buf, size_t count)
+{
+    g_readCount++;
+    return syscall(SYS_read, fd, buf, count);
+}
+
+// Fake set-policy ioctls: count them and report success, the test tree is not on an encrypting fs.
+extern "C" int ioctl(int fd, IoctlRequest request, ...)
+{
+    va_list args;
+    va_start(args, request);
+    void *arg = va_arg(args, void *);
+    va_end(args);
+    if (static_cast<unsigned long>(request) == FS_IOC_SET_ENCRYPTION_POLICY) {
+        g_setPolicyCount++;
+        return 0;
+    }
+    if (static_cast<unsigned long>(request) == F2FS_IOC_SET_SDP_ENCRYPTION_POLICY) {
+        g_setSdpPolicyCount++;
+        return 0;
+    }
+    return static_cast<int>(syscall(SYS_ioctl, fd, request, arg));
+}
+
+namespace OHOS::StorageDaemon {
+class PolicyContextTest : public testing::Test {
+public:
+    static void SetUpTestCase(void) {};
+    static void TearDownTestCase(void) {};
+    void SetUp();
+    void TearDown();
+    vector<string> MakeUserDirs(size_t count);
+    bool policyReady_ = false;
+};
+
+void PolicyContextTest::SetUp(void)
+{
+    (void)system(("rm -rf " + TEST_ROOT).c_str());
+    ASSERT_EQ(mkdir(TEST_ROOT.c_str(), S_IRWXU), 0);
+    ASSERT_EQ(mkdir(KEY_DIR.c_str(), S_IRWXU), 0);
+    ASSERT_EQ(mkdir(SDP_KEY_DIR.c_str(), S_IRWXU), 0);
+    WriteTestFile(KEY_DIR + "/key_id", string(FSCRYPT_KEY_IDENTIFIER_SIZE, 'k'));
+    WriteTestFile(SDP_KEY_DIR + "/key_desc", string(FSCRYPT_KEY_DESCRIPTOR_SIZE, 'd'));
+    policyReady_ = (FscryptSetSysparam(POLICY_CONFIG.c_str()) == 0 && InitFscryptPolicy() == 0);
+    ResetCounters();
+}
+
+void PolicyContextTest::TearDown(void)
+{
+    (void)system(("rm -rf " + TEST_ROOT).c_str());
+}
+
+vector<string> PolicyContextTest::MakeUserDirs(size_t count)
+{
+    vector<string> dirs;
+    for (size_t i = 0; i < count; i++) {
+        string dir = TEST_ROOT + "/dir" + to_string(i);
+        EXPECT_EQ(mkdir(dir.c_str(), S_IRWXU), 0);
+        dirs.push_back(dir);
+    }
+    return dirs;
+}
+
+/**
+ * @tc.name: PolicyContext_Load_001
+ * @tc.desc: Verify the policy context reads the key identifier once and rejects bad key dirs.
+ * @tc.type: FUNC
+ */
+HWTEST_F(PolicyContextTest, PolicyContext_Load_001, TestSize.Level1)
+{
+    GTEST_LOG_(INFO) << "PolicyContext_Load_001 Start";
+    if (!policyReady_) {
+        GTEST_LOG_(INFO) << "fscrypt policy parameter unavailable, skip";
+        return;
+    }
+    FscryptPolicyContext ctx = {};
+    EXPECT_EQ(LoadPolicyContext(KEY_DIR.c_str(), &ctx), 0);
+    EXPECT_EQ(g_readCount, 1U);
+    EXPECT_EQ(ctx.policy.v2.version, FSCRYPT_POLICY_V2);
+    EXPECT_EQ(string(reinterpret_cast<char *>(ctx.policy.v2.master_key_identifier), FSCRYPT_KEY_IDENTIFIER_SIZE),
+        string(FSCRYPT_KEY_IDENTIFIER_SIZE, 'k'));
+
+    EXPECT_NE(LoadPolicyContext((TEST_ROOT + "/none").c_str(), &ctx), 0);
+    WriteTestFile(KEY_DIR + "/key_id", "short");
+    EXPECT_EQ(LoadPolicyContext(KEY_DIR.c_str(), &ctx), -EINVAL);
+    EXPECT_EQ(LoadPolicyContext(nullptr, &ctx), -EINVAL);
+    EXPECT_EQ(OpenPolicyDir((TEST_ROOT + "/none").c_str()), -ENOENT);
+
+    // v2 keys carry no ece/sece class, the sdp pass must not issue any ioctl.
+    EXPECT_EQ(LoadSdpPolicyContext(SDP_KEY_DIR.c_str(), EL3_TYPE, &ctx), 0);
+    EXPECT_FALSE(ctx.hasSdpPolicy);
+    int fd = OpenPolicyDir(TEST_ROOT.c_str());
+    ASSERT_GE(fd, 0);
+    EXPECT_EQ(SetSdpPolicyByFd(&ctx, fd), 0);
+    close(fd);
+    EXPECT_EQ(g_setSdpPolicyCount, 0U);
+    GTEST_LOG_(INFO) << "PolicyContext_Load_001 end";
+}
+
+/**
+ * @tc.name: PolicyContext_Apply_001
+ * @tc.desc: Compare key file reads and ioctls of one user creation: per-dir reload versus a shared context.
+ * @tc.type: PERF
+ */
+HWTEST_F(PolicyContextTest, PolicyContext_Apply_001, TestSize.Level1)
+{
+    GTEST_LOG_(INFO) << "PolicyContext_Apply_001 Start";
+    if (!policyReady_) {
+        GTEST_LOG_(INFO) << "fscrypt policy parameter unavailable, skip";
+        return;
+    }
+    vector<string> dirs = MakeUserDirs(DIRS_PER_EL);
+    for (size_t el = 0; el < USER_ELS; el++) {
+        for (const auto &dir : dirs) {
+            ASSERT_EQ(LoadAndSetPolicy(KEY_DIR.c_str(), dir.c_str()), 0);
+        }
+    }
+    uint32_t legacyReads = g_readCount;
+    uint32_t legacyIoctls = g_setPolicyCount;
+    EXPECT_EQ(legacyReads, DIRS_PER_EL * USER_ELS);
+
+    ResetCounters();
+    for (size_t el = 0; el < USER_ELS; el++) {
+        FscryptPolicyContext ctx = {};
+        ASSERT_EQ(LoadPolicyContext(KEY_DIR.c_str(), &ctx), 0);
+        vector<int> fds;
+        for (const auto &dir : dirs) {
+            int fd = OpenPolicyDir(dir.c_str());
+            ASSERT_GE(fd, 0);
+            fds.push_back(fd);
+        }
+        for (size_t i = 0; i < fds.size(); i++) {
+            EXPECT_EQ(SetPolicyByFd(&ctx, fds[i], dirs[i].c_str()), 0);
+            close(fds[i]);
+        }
+    }
+    GTEST_LOG_(INFO) << "per user: legacy reads " << legacyReads << ", ioctls " << legacyIoctls
+                     << "; context reads " << g_readCount << ", ioctls " << g_setPolicyCount;
+    EXPECT_EQ(g_readCount, USER_ELS);
+    EXPECT_EQ(g_setPolicyCount, legacyIoctls);
+    GTEST_LOG_(INFO) << "PolicyContext_Apply_001 end";
+}
+}
@@ -33,6 +33,8 @@
 #include "storage_service_log.h"
 #include "system_ability_definition.h"
 #include "user/user_manager.h"
+#include "user/user_path_resolver.h"
+#include "utils/file_utils.h"
 #include "utils/string_utils.h"
 #ifdef DFS_SERVICE
 #include "cloud_daemon_manager.h"
@@ -136,6 +138,8 @@ int main()
     LOGW("samgr GetSystemAbilityManager finish");
 
     (void)SetPriority();
+    StorageDaemon::UserPathResolver::LoadConfigs();
+    StorageDaemon::ResumeDeferredRemoval();
 #ifdef EXTERNAL_STORAGE_MANAGER
     if (StorageDaemon::NetlinkManager::Instance().Start() != E_OK) {
         LOGE("Unable to create or start NetlinkManager");
@@ -103,8 +103,7 @@ int32_t DiskUtils::GenerateChecksums(const std::string &dirPath, const std::stri
     return IDiskUtilMoc::diskUtilMoc->GenerateChecksums(dirPath, checksumFilePath);
 }
 
-std::map<std::string, std::string> DiskUtils::ParseChecksumFile(
-    const std::string &checksumContent, const std::string &basePath)
+ChecksumIndex DiskUtils::ParseChecksumFile(const std::string &checksumContent, const std::string &basePath)
 {
     if (IDiskUtilMoc::diskUtilMoc == nullptr) {
         return {};
@@ -112,9 +111,7 @@ std::map<std::string, std::string> DiskUtils::ParseChecksumFile(
     return IDiskUtilMoc::diskUtilMoc->ParseChecksumFile(checksumContent, basePath);
 }
 
-int32_t DiskUtils::CompareChecksums(
-    const std::map<std::string, std::string> &sourceMap,
-    const std::map<std::string, std::string> &discMap)
+int32_t DiskUtils::CompareChecksums(const ChecksumIndex &sourceMap, const ChecksumIndex &discMap)
 {
     if (IDiskUtilMoc::diskUtilMoc == nullptr) {
         return E_ERR;
@@ -69,6 +69,21 @@ bool RmDirRecurse(const std::string &path)
     return IFileUtilMoc::fileUtilMoc->RmDirRecurse(path);
 }
 
+bool RmDirRecurseDeferred(const std::string &path)
+{
+    return IFileUtilMoc::fileUtilMoc->RmDirRecurseDeferred(path);
+}
+
+void ResumeDeferredRemoval()
+{
+    return;
+}
+
+void SetDeferredRemovalJournal(const std::string &journal)
+{
+    return;
+}
+
 void TravelChmod(const std::string &path, mode_t mode)
 {
     return;
@@ -109,6 +124,12 @@ int ForkExec(std::vector<std::string> &cmd, std::vector<std::string> *output, in
     return IFileUtilMoc::fileUtilMoc->ForkExec(cmd, output, exitStatus);
 }
 
+int ForkExecWithInput(std::vector<std::string> &cmd, const ChildInputWriter &writer,
+                      std::vector<std::string> *output)
+{
+    return IFileUtilMoc::fileUtilMoc->ForkExecWithInput(cmd, writer, output);
+}
+
 void TraverseDirUevent(const std::string &path, bool flag)
 {
     return;
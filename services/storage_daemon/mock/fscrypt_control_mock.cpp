@@ -52,4 +52,43 @@ int LoadAndSetEceAndSecePolicy(const char *keyDir, const char *dir, int type)
         return OHOS::E_ERR;
     }
     return IFscryptControlMoc::fscryptControlMoc->LoadAndSetEceAndSecePolicy(keyDir, dir, type);
-}
\ No newline at end of file
+}
+int LoadPolicyContext(const char *keyDir, struct FscryptPolicyContext *ctx)
+{
+    if (IFscryptControlMoc::fscryptControlMoc == nullptr) {
+        return OHOS::E_ERR;
+    }
+    return IFscryptControlMoc::fscryptControlMoc->LoadPolicyContext(keyDir, ctx);
+}
+
+int LoadSdpPolicyContext(const char *keyDir, int type, struct FscryptPolicyContext *ctx)
+{
+    if (IFscryptControlMoc::fscryptControlMoc == nullptr) {
+        return OHOS::E_ERR;
+    }
+    return IFscryptControlMoc::fscryptControlMoc->LoadSdpPolicyContext(keyDir, type, ctx);
+}
+
+int OpenPolicyDir(const char *dir)
+{
+    if (IFscryptControlMoc::fscryptControlMoc == nullptr) {
+        return -ENOENT;
+    }
+    return IFscryptControlMoc::fscryptControlMoc->OpenPolicyDir(dir);
+}
+
+int SetPolicyByFd(const struct FscryptPolicyContext *ctx, int dirFd, const char *dir)
+{
+    if (IFscryptControlMoc::fscryptControlMoc == nullptr) {
+        return OHOS::E_ERR;
+    }
+    return IFscryptControlMoc::fscryptControlMoc->SetPolicyByFd(ctx, dirFd, dir);
+}
+
+int SetSdpPolicyByFd(const struct FscryptPolicyContext *ctx, int dirFd)
+{
+    if (IFscryptControlMoc::fscryptControlMoc == nullptr) {
+        return OHOS::E_ERR;
+    }
+    return IFscryptControlMoc::fscryptControlMoc->SetSdpPolicyByFd(ctx, dirFd);
+}
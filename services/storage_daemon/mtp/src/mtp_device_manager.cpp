@@ -37,6 +37,7 @@
 namespace OHOS {
 namespace StorageDaemon {
 constexpr int32_t DEFAULT_DEV_INDEX = 1;
+constexpr const char *MTPFS_TYPE = "mtpfs";
 constexpr uid_t FILE_MANAGER_UID = 1006;
 constexpr gid_t FILE_MANAGER_GID = 1006;
 constexpr mode_t PUBLIC_DIR_MODE = 02770;
@@ -67,18 +68,26 @@ int32_t MtpDeviceManager::PrepareMtpMountPath(const std::string &path)
     return E_OK;
 }
 
+void MtpDeviceManager::FinishMounting(const std::string &path)
+{
+    std::lock_guard<std::mutex> lock(mountingMutex_);
+    mountingPaths_.erase(path);
+}
+
 int32_t MtpDeviceManager::MountDevice(const MtpDeviceInfo &device)
 {
     LOGI("[L2:MtpDeviceManager] MountDevice: >>> ENTER <<< id=%{public}s, path=%{public}s",
         device.id.c_str(), device.path.c_str());
-    if (isMounting_) {
-        LOGI("MountDevice: mtp device is mounting, try again later.");
-        return E_MTP_IS_MOUNTING;
+    {
+        std::lock_guard<std::mutex> lock(mountingMutex_);
+        if (!mountingPaths_.insert(device.path).second) {
+            LOGI("MountDevice: mtp device is mounting, try again later.");
+            return E_MTP_IS_MOUNTING;
+        }
     }
-    isMounting_ = true;
     int32_t ret = PrepareMtpMountPath(device.path);
     if (ret != E_OK) {
-        isMounting_ = false;
+        FinishMounting(device.path);
         LOGE("[L2:MtpDeviceManager] MountDevice: <<< EXIT FAILED <<< PrepareMtpMountPath failed, err=%{public}d", ret);
         return ret;
     }
@@ -87,8 +96,15 @@ int32_t MtpDeviceManager::MountDevice(const MtpDeviceInfo &device)
         "-o", "gid=" + std::to_string(FILE_MANAGER_GID), "-o", "allow_other",
         "-o", "enable-move", "-o", "max_idle_threads=10", "-o", "max_threads=20",
         "-o", "context=u:object_r:mnt_external_file:s0",
-        "--device", std::to_string(DEFAULT_DEV_INDEX), device.path,
     };
+    if (device.type == MTPFS_TYPE && (device.busLocation != 0 || device.devNum != 0)) {
+        // mtpfs opens the device by "bus/devnum" directly instead of scanning for the first one.
+        cmdVec.push_back(std::to_string(device.busLocation) + "/" + std::to_string(device.devNum));
+    } else {
+        cmdVec.push_back("--device");
+        cmdVec.push_back(std::to_string(DEFAULT_DEV_INDEX));
+    }
+    cmdVec.push_back(device.path);
     std::vector<std::string> result;
     int32_t err = ForkExec(cmdVec, &result);
     for (auto str : result) {
@@ -97,11 +113,11 @@ int32_t MtpDeviceManager::MountDevice(const MtpDeviceInfo &device)
     if ((err != 0) || (result.size() != 0)) {
         LOGE("[L2:MtpDeviceManager] MountDevice: <<< EXIT FAILED <<< mtpfs cmd failed, err=%{public}d", err);
         rmdir(device.path.c_str());
-        isMounting_ = false;
+        FinishMounting(device.path);
         return err != 0 ? err : E_MTP_MOUNT_FAILED;
     }
     LOGI("[L2:MtpDeviceManager] MountDevice: <<< EXIT SUCCESS <<< id=%{public}s", device.id.c_str());
-    isMounting_ = false;
+    FinishMounting(device.path);
 #ifdef DISK_MANAGER
     OHOS::DiskManager::DiskManagerClient::GetInstance().NotifyMtpMounted(
         device.id, device.path, device.vendor, device.uuid, device.type);
@@ -15,9 +15,11 @@
 
 #include "mtp/mtp_device_monitor.h"
 
+#include <algorithm>
 #include <cstdio>
 #include <dirent.h>
 #include <filesystem>
+#include <fstream>
 #ifdef SUPPORT_OPEN_SOURCE_GPHOTO2_DEVICE
 #include <gphoto2/gphoto2-camera.h>
 #include <gphoto2/gphoto2-context.h>
@@ -44,6 +46,7 @@ using namespace std;
 namespace OHOS {
 namespace StorageDaemon {
 constexpr int32_t SLEEP_TIME = 1;
+constexpr int32_t MAX_SUBSCRIBE_RETRY_TIME = 64;
 constexpr int32_t MTP_VAL_LEN = 6;
 constexpr int32_t MTP_TRUE_LEN = 5;
 constexpr int32_t DETECT_CNT = 10;
@@ -52,6 +55,7 @@ constexpr int UPLOAD_RECORD_TRUE_LEN = 4;
 constexpr int USB_CLASS_IMAGE = 6;
 
 constexpr const char *MTP_ROOT_PATH = "/mnt/data/external/";
+constexpr const char *UUID_PATH = "/proc/sys/kernel/random/uuid";
 constexpr const char *SYS_PARAM_SERVICE_PERSIST_ENABLE = "persist.edm.mtp_client_disable";
 constexpr const char *SYS_PARAM_SERVICE_ENTERPRISE_ENABLE = "const.edm.is_enterprise_device";
 constexpr const char *KEY_CUST = "const.cust.custPath";
@@ -66,9 +70,12 @@ constexpr int32_t ERROR_CODE_GET_DEVICE_LIST_FAILED = -3;
 constexpr int MIN_VALUE = 0;
 constexpr int MAX_VALUE = 255;
 #endif
-bool g_keepMonitoring = true;
 
 MtpDeviceMonitor::MtpDeviceMonitor()
+    : mountFunc_([](const MtpDeviceInfo &device) { return MtpDeviceManager::GetInstance().MountDevice(device); }),
+      umountFunc_([](const MtpDeviceInfo &device, bool needNotify, bool isBadRemove) {
+          return MtpDeviceManager::GetInstance().UmountDevice(device, needNotify, isBadRemove);
+      })
 {
     LOGI("[L2:MtpDeviceMonitor] MtpDeviceMonitor: >>> ENTER <<<");
 }
@@ -90,6 +97,22 @@ void MtpDeviceMonitor::StartMonitor()
     LOGI("[L2:MtpDeviceMonitor] StartMonitor: <<< EXIT SUCCESS <<<");
 }
 
+void MtpDeviceMonitor::StopMonitor()
+{
+    LOGI("[L2:MtpDeviceMonitor] StopMonitor: >>> ENTER <<<");
+    {
+        std::lock_guard<std::mutex> lock(stopMutex_);
+        stopping_ = true;
+    }
+    stopCv_.notify_all();
+}
+
+bool MtpDeviceMonitor::WaitForStop(int32_t seconds)
+{
+    std::unique_lock<std::mutex> lock(stopMutex_);
+    return stopCv_.wait_for(lock, std::chrono::seconds(seconds), [this]() { return stopping_; });
+}
+
 bool MtpDeviceMonitor::IsNeedDisableMtp()
 {
     LOGD("[L2:MtpDeviceMonitor] IsNeedDisableMtp: >>> ENTER <<<");
@@ -128,33 +151,61 @@ DeviceType MtpDeviceMonitor::GetDeviceType(uint8_t deviceClass, uint16_t vendorI
     return DeviceType::UNKNOWN;
 }
 
-static void FillMtpDeviceInfo(MtpDeviceInfo &devInfo, LIBMTP_raw_device_t *rawDevice)
+static std::string NewDeviceUuid()
 {
-    std::vector<std::string> cmd = {
-        "cat",
-        "/proc/sys/kernel/random/uuid",
-    };
-    std::vector<std::string> uuids;
-    ForkExec(cmd, &uuids);
-
-    if (!uuids.empty()) {
-        devInfo.uuid = uuids.front();
+    std::ifstream file(UUID_PATH);
+    std::string uuid;
+    if (!file.is_open() || !std::getline(file, uuid)) {
+        LOGE("[L2:MtpDeviceMonitor] NewDeviceUuid: read uuid failed, errno=%{public}d", errno);
     }
+    return uuid;
+}
+
+static void FillMtpDeviceIdentity(MtpDeviceInfo &devInfo)
+{
+    devInfo.uuid = NewDeviceUuid();
+    devInfo.id = "mtp-" + std::to_string(devInfo.vendorId) + "-" + std::to_string(devInfo.productId);
+    devInfo.path = std::string(MTP_ROOT_PATH) + devInfo.id;
+    devInfo.type = "mtpfs";
+}
+
+static void FillMtpDeviceInfo(MtpDeviceInfo &devInfo, LIBMTP_raw_device_t *rawDevice)
+{
     devInfo.devNum = rawDevice->devnum;
     devInfo.busLocation = rawDevice->bus_location;
-    devInfo.vendor = rawDevice->device_entry.vendor;
-    devInfo.product = rawDevice->device_entry.product;
+    devInfo.vendor = rawDevice->device_entry.vendor != nullptr ? rawDevice->device_entry.vendor : "";
+    devInfo.product = rawDevice->device_entry.product != nullptr ? rawDevice->device_entry.product : "";
     devInfo.vendorId = rawDevice->device_entry.vendor_id;
     devInfo.productId = rawDevice->device_entry.product_id;
-    devInfo.id = "mtp-" + std::to_string(devInfo.vendorId) + "-" + std::to_string(devInfo.productId);
-    devInfo.path = std::string(MTP_ROOT_PATH) + devInfo.id;
-    devInfo.type = "mtpfs";
+    FillMtpDeviceIdentity(devInfo);
 }
 
-int32_t MtpDeviceMonitor::GetMtpDevices(std::vector<MtpDeviceInfo> &devInfos, uint32_t busLocation, uint8_t devNum)
+static void FillMtpDeviceInfo(MtpDeviceInfo &devInfo, const UsbAttachInfo &usbInfo)
 {
+    devInfo.devNum = usbInfo.devNum;
+    devInfo.busLocation = usbInfo.busLocation;
+    devInfo.vendor = usbInfo.vendor;
+    devInfo.product = usbInfo.product;
+    devInfo.vendorId = usbInfo.vendorId;
+    devInfo.productId = usbInfo.productId;
+    FillMtpDeviceIdentity(devInfo);
+}
+
+int32_t MtpDeviceMonitor::GetMtpDevices(std::vector<MtpDeviceInfo> &devInfos, const UsbAttachInfo &usbInfo)
+{
+    uint32_t busLocation = usbInfo.busLocation;
+    uint8_t devNum = usbInfo.devNum;
     LOGI("[L2:MtpDeviceMonitor] GetMtpDevices: >>> ENTER <<< expected busLocation=%{public}u, devNum=%{public}u",
          busLocation, devNum);
+    if (usbInfo.vendorId != 0 && (busLocation != 0 || devNum != 0)) {
+        // The attach event names the device; mtpfs opens it by bus and devnum, so the bus is not probed here.
+        MtpDeviceInfo devInfo;
+        FillMtpDeviceInfo(devInfo, usbInfo);
+        devInfos.push_back(devInfo);
+        LOGI("[L2:MtpDeviceMonitor] GetMtpDevices: <<< EXIT SUCCESS <<< from attach event, id=%{public}s",
+            devInfo.id.c_str());
+        return E_OK;
+    }
     int rawDevSize = 0;
     LIBMTP_raw_device_t *rawDevices = nullptr;
     LIBMTP_error_number_t err = LIBMTP_Detect_Raw_Devices(&rawDevices, &rawDevSize);
@@ -202,18 +253,18 @@ int32_t MtpDeviceMonitor::GetMtpDevices(std::vector<MtpDeviceInfo> &devInfos, ui
 }
 
 int32_t MtpDeviceMonitor::MountDeviceByType(DeviceType deviceType, std::vector<MtpDeviceInfo> &devInfos,
-                                            const std::string &deviceTypeName, uint32_t busLocation, uint8_t devNum)
+                                            const std::string &deviceTypeName, const UsbAttachInfo &usbInfo)
 {
     int32_t ret = E_MTP_MOUNT_FAILED;
     if (deviceType == DeviceType::CAMERA) {
 #ifdef SUPPORT_OPEN_SOURCE_GPHOTO2_DEVICE
-        ret = GetGphotoDevices(devInfos, busLocation, devNum);
+        ret = GetGphotoDevices(devInfos, usbInfo.busLocation, usbInfo.devNum);
 #else
         LOGE("[L2:MtpDeviceMonitor] MountDeviceByType: Camera device type not supported");
         return E_MTP_MOUNT_FAILED;
 #endif
     } else {
-        ret = GetMtpDevices(devInfos, busLocation, devNum);
+        ret = GetMtpDevices(devInfos, usbInfo);
     }
 
     if (ret == E_OK && !devInfos.empty()) {
@@ -245,37 +296,54 @@ void MtpDeviceMonitor::SetPtpMode(const std::vector<MtpDeviceInfo> &devInfos, bo
     }
 }
 
+void MtpDeviceMonitor::OnDeviceAttached(DeviceType deviceType, const UsbAttachInfo &usbInfo)
+{
+    LOGI("[L2:MtpDeviceMonitor] OnDeviceAttached: bus=%{public}u, dev=%{public}u", usbInfo.busLocation,
+        usbInfo.devNum);
+    std::thread([this, deviceType, usbInfo]() { MountMtpDeviceByBroadcast(deviceType, usbInfo); }).detach();
+}
+
 void MtpDeviceMonitor::MountMtpDeviceByBroadcast(DeviceType deviceType, uint32_t busLocation, uint8_t devNum)
+{
+    UsbAttachInfo usbInfo;
+    usbInfo.busLocation = busLocation;
+    usbInfo.devNum = devNum;
+    MountMtpDeviceByBroadcast(deviceType, usbInfo);
+}
+
+void MtpDeviceMonitor::MountMtpDeviceByBroadcast(DeviceType deviceType, const UsbAttachInfo &usbInfo)
 {
     std::vector<MtpDeviceInfo> devInfos;
+    uint32_t busLocation = usbInfo.busLocation;
+    uint8_t devNum = usbInfo.devNum;
 
     if (deviceType == DeviceType::CAMERA) {
-        int32_t ret = MountDeviceByType(DeviceType::CAMERA, devInfos, "camera", busLocation, devNum);
+        int32_t ret = MountDeviceByType(DeviceType::CAMERA, devInfos, "camera", usbInfo);
         if (ret == E_OK) {
             return;
         }
         LOGI("[L2:MtpDeviceMonitor] MountMtpDeviceByBroadcast: camera failed, fallback to mobile, "
             "bus=%{public}u, dev=%{public}u", busLocation, devNum);
         devInfos.clear();
-        MountDeviceByType(DeviceType::MOBILE, devInfos, "mobile", busLocation, devNum);
+        MountDeviceByType(DeviceType::MOBILE, devInfos, "mobile", usbInfo);
         return;
     } else if (deviceType == DeviceType::MOBILE) {
-        int32_t ret = MountDeviceByType(DeviceType::MOBILE, devInfos, "mobile", busLocation, devNum);
+        int32_t ret = MountDeviceByType(DeviceType::MOBILE, devInfos, "mobile", usbInfo);
         if (ret == E_OK) {
             return;
         }
         LOGI("[L2:MtpDeviceMonitor] MountMtpDeviceByBroadcast: mobile failed, fallback to camera, "
             "bus=%{public}u, dev=%{public}u", busLocation, devNum);
         devInfos.clear();
-        MountDeviceByType(DeviceType::CAMERA, devInfos, "camera", busLocation, devNum);
+        MountDeviceByType(DeviceType::CAMERA, devInfos, "camera", usbInfo);
         return;
     } else if (deviceType == DeviceType::UNKNOWN) {
-        int32_t ret = MountDeviceByType(DeviceType::MOBILE, devInfos, "mobile", busLocation, devNum);
+        int32_t ret = MountDeviceByType(DeviceType::MOBILE, devInfos, "mobile", usbInfo);
         if (ret == E_OK) {
             return;
         }
         devInfos.clear();
-        MountDeviceByType(DeviceType::CAMERA, devInfos, "camera", busLocation, devNum);
+        MountDeviceByType(DeviceType::CAMERA, devInfos, "camera", usbInfo);
         return;
     }
 
@@ -292,8 +360,8 @@ void MtpDeviceMonitor::MonitorDevice()
         int32_t ret = HasMTPDevice(hasMtp);
         if (ret != E_OK) {
             cnt--;
-            if (cnt > 0) {
-                sleep(SLEEP_TIME);
+            if (cnt > 0 && WaitForStop(SLEEP_TIME)) {
+                return;
             }
             continue;
         }
@@ -303,72 +371,132 @@ void MtpDeviceMonitor::MonitorDevice()
         break;
     }
     RegisterMTPParamListener();
-    while (g_keepMonitoring) {
-        UsbEventSubscriber::SubscribeCommonEvent();
-        sleep(SLEEP_TIME);
+    // Attach and detach events arrive on the event thread; this thread only retries a failed subscription.
+    int32_t retryTime = SLEEP_TIME;
+    while (!UsbEventSubscriber::SubscribeCommonEvent()) {
+        if (WaitForStop(retryTime)) {
+            break;
+        }
+        retryTime = std::min(retryTime * 2, MAX_SUBSCRIBE_RETRY_TIME);
+    }
+    {
+        std::unique_lock<std::mutex> lock(stopMutex_);
+        stopCv_.wait(lock, [this]() { return stopping_; });
     }
     RemoveMTPParamListener();
     LOGI("[L2:MtpDeviceMonitor] MonitorDevice: <<< EXIT SUCCESS <<< monitor thread ended");
 }
 
-int32_t MtpDeviceMonitor::MountMtpDevice(const std::vector<MtpDeviceInfo> &monitorDevices)
+int32_t MtpDeviceMonitor::MountMtpDevice(std::vector<MtpDeviceInfo> &monitorDevices)
 {
     LOGI("[L2:MtpDeviceMonitor] MountMtpDevice: >>> ENTER <<< deviceCount=%{public}zu", monitorDevices.size());
     if (IsNeedDisableMtp()) {
         LOGE("[L2:MtpDeviceMonitor] MountMtpDevice: <<< EXIT FAILED <<< MTP not supported on this device");
         return E_NOT_SUPPORT;
     }
-    std::lock_guard<std::mutex> lock(listMutex_);
-    for (auto device : monitorDevices) {
-        bool isMounted = false;
-        for (const auto& dev : lastestMtpDevList_) {
-            if (dev.id == device.id) {
-                isMounted = true;
-                break;
+    std::vector<MtpDeviceInfo> toMount;
+    {
+        std::lock_guard<std::mutex> lock(listMutex_);
+        // A reserved device may be renamed, so the caller sees the mount point actually used.
+        for (auto &device : monitorDevices) {
+            if (ReserveDeviceLocked(device)) {
+                toMount.push_back(device);
             }
         }
-        if (isMounted) {
-            LOGI("[L2:MtpDeviceMonitor] MountMtpDevice: device has mounted, id=%{public}s", device.id.c_str());
-            continue;
+    }
+    // Every device gets its own mtpfs instance and mount point, so the mounts run side by side.
+    std::vector<int32_t> results(toMount.size(), E_OK);
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < toMount.size(); i++) {
+        workers.emplace_back([this, &toMount, &results, i]() { results[i] = MountReservedDevice(toMount[i]); });
+    }
+    if (!toMount.empty()) {
+        results[0] = MountReservedDevice(toMount[0]);
+    }
+    for (auto &worker : workers) {
+        worker.join();
+    }
+    for (int32_t ret : results) {
+        if (ret != E_OK) {
+            LOGE("[L2:MtpDeviceMonitor] MountMtpDevice: <<< EXIT FAILED <<< ret=%{public}d", ret);
+            return ret;
         }
+    }
+    LOGI("[L2:MtpDeviceMonitor] MountMtpDevice: <<< EXIT SUCCESS <<< mounted=%{public}zu", toMount.size());
+    return E_OK;
+}
 
-        bool isInPendingList = false;
-        for (const auto& pendingDev : pendingMtpDevList_) {
-            if (pendingDev.id == device.id) {
-                isInPendingList = true;
-                break;
+bool MtpDeviceMonitor::ReserveDeviceLocked(MtpDeviceInfo &device)
+{
+    auto sameUsb = [&device](const MtpDeviceInfo &dev) {
+        return dev.busLocation == device.busLocation && dev.devNum == device.devNum;
+    };
+    bool idTaken = mountingDevs_.count(device.id) > 0;
+    for (const auto &dev : lastestMtpDevList_) {
+        if (dev.id == device.id) {
+            if (sameUsb(dev)) {
+                LOGI("[L2:MtpDeviceMonitor] ReserveDeviceLocked: device has mounted, id=%{public}s", device.id.c_str());
+                return false;
             }
+            idTaken = true;
         }
-        if (isInPendingList) {
-            LOGI("[L2:MtpDeviceMonitor] MountMtpDevice:Device already in pending list, skipping: id=%{public}s",
-                device.id.c_str());
-            continue;
+    }
+    auto mounting = mountingDevs_.find(device.id);
+    if (mounting != mountingDevs_.end() && sameUsb(mounting->second.device)) {
+        LOGI("[L2:MtpDeviceMonitor] ReserveDeviceLocked: device is mounting, id=%{public}s", device.id.c_str());
+        return false;
+    }
+    if (idTaken) {
+        // A second device of the same model gets its own mount point.
+        device.id += "-" + std::to_string(device.busLocation) + "-" + std::to_string(device.devNum);
+        device.path = std::string(MTP_ROOT_PATH) + device.id;
+        if (mountingDevs_.count(device.id) > 0 || std::any_of(lastestMtpDevList_.begin(), lastestMtpDevList_.end(),
+            [&device](const MtpDeviceInfo &dev) { return dev.id == device.id; })) {
+            LOGI("[L2:MtpDeviceMonitor] ReserveDeviceLocked: device is known, id=%{public}s", device.id.c_str());
+            return false;
         }
+    }
+    MtpMountTask task;
+    task.device = device;
+    mountingDevs_[device.id] = task;
+    return true;
+}
 
-        if (lastestMtpDevList_.size() > 0) {
-            LOGW("[L2:MtpDeviceMonitor] MountMtpDevice:"
-                "Multiple devices detected. Only one device is supported. Adding to pending list: id=%{public}s",
-                device.id.c_str());
-            StorageService::StorageRadar::ReportMtpResult("MountMtpDevice", E_NOT_SUPPORT, "NA");
-            pendingMtpDevList_.push_back(device);
-            continue;
+int32_t MtpDeviceMonitor::MountReservedDevice(const MtpDeviceInfo &device)
+{
+    LOGI("[L2:MtpDeviceMonitor] MountReservedDevice: >>> ENTER <<< id=%{public}s", device.id.c_str());
+    int32_t ret = mountFunc_(device);
+    if (ret == E_MTP_IS_MOUNTING) {
+        LOGI("[L2:MtpDeviceMonitor] MountReservedDevice: mount point is mounting, id=%{public}s", device.id.c_str());
+        ret = E_OK;
+    }
+    bool detached = false;
+    {
+        std::lock_guard<std::mutex> lock(listMutex_);
+        auto task = mountingDevs_.find(device.id);
+        if (task != mountingDevs_.end()) {
+            detached = task->second.detached;
+            mountingDevs_.erase(task);
         }
-        
-        lastestMtpDevList_.push_back(device);
-        int32_t ret = MtpDeviceManager::GetInstance().MountDevice(device);
-        if (ret == E_OK) {
-            LOGI("Device mounted successfully, id=%{public}s", device.id.c_str());
-        } else if (ret == E_MTP_IS_MOUNTING) {
-            LOGI("[L2:MtpDeviceMonitor] MountMtpDevice: <<< EXIT SUCCESS <<< device is mounting");
-            return E_OK;
-        } else {
-            lastestMtpDevList_.pop_back();
-            LOGE("[L2:MtpDeviceMonitor] MountMtpDevice: Mount device failed, removing from list. ret=%{public}d,"
-                "id=%{public}s", ret, device.id.c_str());
-            return ret;
+        if (ret == E_OK && !detached) {
+            lastestMtpDevList_.push_back(device);
+        }
+    }
+    if (ret != E_OK) {
+        LOGE("[L2:MtpDeviceMonitor] MountReservedDevice: <<< EXIT FAILED <<< id=%{public}s, ret=%{public}d",
+            device.id.c_str(), ret);
+        return ret;
+    }
+    if (detached) {
+        LOGI("[L2:MtpDeviceMonitor] MountReservedDevice: device detached while mounting, id=%{public}s",
+            device.id.c_str());
+        int32_t err = umountFunc_(device, true, true);
+        if (err != E_OK) {
+            StorageService::StorageRadar::ReportMtpResult("MountReservedDevice::UmountDevice", err, "NA");
         }
+        return E_OK;
     }
-    LOGI("[L2:MtpDeviceMonitor] MountMtpDevice: <<< EXIT SUCCESS <<<");
+    LOGI("[L2:MtpDeviceMonitor] MountReservedDevice: <<< EXIT SUCCESS <<< id=%{public}s", device.id.c_str());
     return E_OK;
 }
 
@@ -389,15 +517,21 @@ bool MtpDeviceMonitor::HasMounted(const MtpDeviceInfo &device)
 void MtpDeviceMonitor::UmountAllMtpDevice()
 {
     LOGI("[L2:MtpDeviceMonitor] UmountAllMtpDevice: >>> ENTER <<<");
-    std::lock_guard<std::mutex> lock(listMutex_);
-    for (auto iter = lastestMtpDevList_.begin(); iter != lastestMtpDevList_.end(); iter++) {
-        int32_t ret = MtpDeviceManager::GetInstance().UmountDevice(*iter, true, false);
+    std::vector<MtpDeviceInfo> devices;
+    {
+        std::lock_guard<std::mutex> lock(listMutex_);
+        devices.swap(lastestMtpDevList_);
+        for (auto &task : mountingDevs_) {
+            task.second.detached = true;
+        }
+    }
+    for (const auto &device : devices) {
+        int32_t ret = umountFunc_(device, true, false);
         if (ret != E_OK) {
             LOGE("[L2:MtpDeviceMonitor] UmountAllMtpDevice: umount failed, path=%{public}s, err=%{public}d",
-                iter->path.c_str(), ret);
+                device.path.c_str(), ret);
         }
     }
-    lastestMtpDevList_.clear();
     LOGI("[L2:MtpDeviceMonitor] UmountAllMtpDevice: <<< EXIT SUCCESS <<<");
 }
 
@@ -417,20 +551,17 @@ void MtpDeviceMonitor::UmountDetachedMtpDevice(uint32_t busLocation, uint8_t dev
             });
         lastestMtpDevList_.erase(newEnd, lastestMtpDevList_.end());
 
-        auto newPendingEnd = std::remove_if(pendingMtpDevList_.begin(), pendingMtpDevList_.end(),
-            [busLocation, devNum](const MtpDeviceInfo& device) {
-                if (device.busLocation == busLocation && device.devNum == devNum) {
-                    LOGI("[L2:MtpDeviceMonitor] UmountDetachedMtpDevice:Removing pending device, id=%{public}s",
-                        device.id.c_str());
-                    return true;
-                }
-                return false;
-            });
-        pendingMtpDevList_.erase(newPendingEnd, pendingMtpDevList_.end());
+        for (auto &task : mountingDevs_) {
+            if (task.second.device.busLocation == busLocation && task.second.device.devNum == devNum) {
+                LOGI("[L2:MtpDeviceMonitor] UmountDetachedMtpDevice: device is mounting, id=%{public}s",
+                    task.first.c_str());
+                task.second.detached = true;
+            }
+        }
     }
 
     for (const auto& device : devicesToUnmount) {
-        int32_t ret = MtpDeviceManager::GetInstance().UmountDevice(device, true, true);
+        int32_t ret = umountFunc_(device, true, true);
         if (ret == E_OK) {
             LOGI("[L2:MtpDeviceMonitor] UmountDetachedMtpDevice:Successfully unmounted device");
         } else {
@@ -443,45 +574,50 @@ void MtpDeviceMonitor::UmountDetachedMtpDevice(uint32_t busLocation, uint8_t dev
 int32_t MtpDeviceMonitor::Mount(const std::string &id)
 {
     LOGI("[L2:MtpDeviceMonitor] Mount: >>> ENTER <<< id=%{public}s", id.c_str());
-    std::lock_guard<std::mutex> lock(listMutex_);
-    for (auto iter = lastestMtpDevList_.begin(); iter != lastestMtpDevList_.end(); iter++) {
-        if (iter->id != id) {
-            continue;
-        }
-        int32_t ret = MtpDeviceManager::GetInstance().MountDevice(*iter);
-        if (ret != E_OK) {
-            LOGE("[L2:MtpDeviceMonitor] Mount: <<< EXIT FAILED <<< id=%{public}s, err=%{public}d", id.c_str(), ret);
-        } else {
-            LOGI("[L2:MtpDeviceMonitor] Mount: <<< EXIT SUCCESS <<< id=%{public}s", id.c_str());
+    MtpDeviceInfo device;
+    {
+        std::lock_guard<std::mutex> lock(listMutex_);
+        auto iter = std::find_if(lastestMtpDevList_.begin(), lastestMtpDevList_.end(),
+            [&id](const MtpDeviceInfo &dev) { return dev.id == id; });
+        if (iter == lastestMtpDevList_.end()) {
+            LOGE("[L2:MtpDeviceMonitor] Mount: <<< EXIT FAILED <<< id=%{public}s does not exist", id.c_str());
+            return E_NON_EXIST;
         }
-        return ret;
+        device = *iter;
+    }
+    int32_t ret = mountFunc_(device);
+    if (ret != E_OK) {
+        LOGE("[L2:MtpDeviceMonitor] Mount: <<< EXIT FAILED <<< id=%{public}s, err=%{public}d", id.c_str(), ret);
+    } else {
+        LOGI("[L2:MtpDeviceMonitor] Mount: <<< EXIT SUCCESS <<< id=%{public}s", id.c_str());
     }
-    LOGE("[L2:MtpDeviceMonitor] Mount: <<< EXIT FAILED <<< id=%{public}s does not exist", id.c_str());
-    return E_NON_EXIST;
+    return ret;
 }
 
 int32_t MtpDeviceMonitor::Umount(const std::string &id)
 {
     LOGI("[L2:MtpDeviceMonitor] Umount: >>> ENTER <<< id=%{public}s", id.c_str());
-    std::lock_guard<std::mutex> lock(listMutex_);
-
-    for (auto iter = lastestMtpDevList_.begin(); iter != lastestMtpDevList_.end();) {
-        if (iter->id != id) {
-            ++iter;
-            continue;
-        }
-
-        int32_t ret = MtpDeviceManager::GetInstance().UmountDevice(*iter, true, false);
-        if (ret == E_OK) {
-            iter = lastestMtpDevList_.erase(iter);
-        } else {
-            LOGE("[L2:MtpDeviceMonitor] Umount: <<< EXIT FAILED <<< id=%{public}s, err=%{public}d", id.c_str(), ret);
+    MtpDeviceInfo device;
+    {
+        // Taken off the list while unmounting, so a second Umount of the same id does not race this one.
+        std::lock_guard<std::mutex> lock(listMutex_);
+        auto iter = std::find_if(lastestMtpDevList_.begin(), lastestMtpDevList_.end(),
+            [&id](const MtpDeviceInfo &dev) { return dev.id == id; });
+        if (iter == lastestMtpDevList_.end()) {
+            LOGE("[L2:MtpDeviceMonitor] Umount: <<< EXIT FAILED <<< id=%{public}s does not exist", id.c_str());
+            return E_NON_EXIST;
         }
-        return ret;
+        device = *iter;
+        lastestMtpDevList_.erase(iter);
     }
 
-    LOGE("[L2:MtpDeviceMonitor] Umount: <<< EXIT FAILED <<< id=%{public}s does not exist", id.c_str());
-    return E_NON_EXIST;
+    int32_t ret = umountFunc_(device, true, false);
+    if (ret != E_OK) {
+        LOGE("[L2:MtpDeviceMonitor] Umount: <<< EXIT FAILED <<< id=%{public}s, err=%{public}d", id.c_str(), ret);
+        std::lock_guard<std::mutex> lock(listMutex_);
+        lastestMtpDevList_.push_back(device);
+    }
+    return ret;
 }
 
 bool MtpDeviceMonitor::IsHwitDevice()
@@ -742,13 +878,6 @@ static void CleanupGphotoResources(GPContext *context, CameraList* list, Camera
 static void GenerateGphotoDeviceInfo(MtpDeviceInfo& devInfo, const char* portPath,
                                      Camera* camera, GPContext* context)
 {
-    std::vector<std::string> cmd = {
-        "cat",
-        "/proc/sys/kernel/random/uuid",
-    };
-    std::vector<std::string> uuids;
-    ForkExec(cmd, &uuids);
-
     int bus = 0;
     int dev = 0;
     if (!ParsePortPath(portPath, bus, dev)) {
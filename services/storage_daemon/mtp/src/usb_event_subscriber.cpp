@@ -27,6 +27,8 @@ constexpr const char *DEV_ADDRESS_KEY = "devAddress";
 constexpr const char *DEV_VENDOR_ID_KEY = "vendorId";
 constexpr const char *DEV_PRODUCT_ID_KEY = "productId";
 constexpr const char *DEV_CLASS_KEY = "clazz";
+constexpr const char *DEV_MANUFACTURER_KEY = "manufacturerName";
+constexpr const char *DEV_PRODUCT_NAME_KEY = "productName";
 constexpr int USB_CLASS_IMAGE = 6;
 constexpr int USB_CLASS_VENDOR_SPEC = 255;
 constexpr int USB_CLASS_PRINTER = 0x07;
@@ -39,7 +41,7 @@ UsbEventSubscriber::UsbEventSubscriber(const EventFwk::CommonEventSubscribeInfo
 }
 
 std::shared_ptr<UsbEventSubscriber> usbEventSubscriber_ = nullptr;
-void UsbEventSubscriber::SubscribeCommonEvent(void)
+bool UsbEventSubscriber::SubscribeCommonEvent(void)
 {
     LOGI("[L2:UsbEventSubscriber] SubscribeCommonEvent: >>> ENTER <<<");
     if (usbEventSubscriber_ == nullptr) {
@@ -53,9 +55,11 @@ void UsbEventSubscriber::SubscribeCommonEvent(void)
         if (!EventFwk::CommonEventManager::SubscribeCommonEvent(usbEventSubscriber_)) {
             usbEventSubscriber_ = nullptr;
             LOGE("[L2:UsbEventSubscriber] SubscribeCommonEvent: <<< EXIT FAILED <<< subscribe failed");
+            return false;
         }
     }
     LOGI("[L2:UsbEventSubscriber] SubscribeCommonEvent: <<< EXIT SUCCESS <<<");
+    return true;
 }
 
 void UsbEventSubscriber::OnReceiveEvent(const OHOS::EventFwk::CommonEventData &data)
@@ -68,11 +72,10 @@ void UsbEventSubscriber::OnReceiveEvent(const OHOS::EventFwk::CommonEventData &d
         LOGI("[L2:UsbEventSubscriber] OnReceiveEvent: COMMON_EVENT_USB_DEVICE_ATTACHED, data=%{public}s",
             usbInfo.c_str());
         DeviceType deviceType = DeviceType::UNKNOWN;
-        uint32_t busLocation = 0;
-        uint8_t devNum = 0;
         if (ShouldHandleMtpDevice(usbInfo, deviceType)) {
-            GetValueFromUsbDataInfo(data.GetData(), devNum, busLocation);
-            MtpDeviceMonitor::GetInstance().MountMtpDeviceByBroadcast(deviceType, busLocation, devNum);
+            UsbAttachInfo attachInfo;
+            GetValueFromUsbDataInfo(usbInfo, attachInfo);
+            MtpDeviceMonitor::GetInstance().OnDeviceAttached(deviceType, attachInfo);
         }
     }
     if (action == EventFwk::CommonEventSupport::COMMON_EVENT_USB_DEVICE_DETACHED) {
@@ -80,11 +83,10 @@ void UsbEventSubscriber::OnReceiveEvent(const OHOS::EventFwk::CommonEventData &d
         LOGI("[L2:UsbEventSubscriber] OnReceiveEvent: COMMON_EVENT_USB_DEVICE_DETACHED, data=%{public}s",
             data.GetData().c_str());
         DeviceType deviceType = DeviceType::UNKNOWN;
-        uint32_t busLocation = 0;
-        uint8_t devNum = 0;
         if (ShouldHandleMtpDevice(usbInfo, deviceType)) {
-            GetValueFromUsbDataInfo(data.GetData(), devNum, busLocation);
-            MtpDeviceMonitor::GetInstance().UmountDetachedMtpDevice(busLocation, devNum);
+            UsbAttachInfo detachInfo;
+            GetValueFromUsbDataInfo(usbInfo, detachInfo);
+            MtpDeviceMonitor::GetInstance().UmountDetachedMtpDevice(detachInfo.busLocation, detachInfo.devNum);
         }
     }
     if (action == EventFwk::CommonEventSupport::COMMON_EVENT_ENTER_HIBERNATE) {
@@ -103,7 +105,7 @@ void UsbEventSubscriber::OnReceiveEvent(const OHOS::EventFwk::CommonEventData &d
     LOGI("[L2:UsbEventSubscriber] OnReceiveEvent: <<< EXIT SUCCESS <<<");
 }
 
-void UsbEventSubscriber::GetValueFromUsbDataInfo(const std::string &jsonStr, uint8_t &devNum, uint32_t &busLocation)
+void UsbEventSubscriber::GetValueFromUsbDataInfo(const std::string &jsonStr, UsbAttachInfo &usbInfo)
 {
     LOGD("[L2:UsbEventSubscriber] GetValueFromUsbDataInfo: >>> ENTER <<<");
     if (jsonStr.empty()) {
@@ -117,17 +119,34 @@ void UsbEventSubscriber::GetValueFromUsbDataInfo(const std::string &jsonStr, uin
         return;
     }
 
-    cJSON *busLocObj = cJSON_GetObjectItemCaseSensitive(usbJson, DEV_ADDRESS_KEY);
+    cJSON *devNumObj = cJSON_GetObjectItemCaseSensitive(usbJson, DEV_ADDRESS_KEY);
+    if (devNumObj != nullptr && cJSON_IsNumber(devNumObj)) {
+        usbInfo.devNum = static_cast<uint8_t>(devNumObj->valueint);
+    }
+    cJSON *busLocObj = cJSON_GetObjectItemCaseSensitive(usbJson, BUS_NUM_KEY);
     if (busLocObj != nullptr && cJSON_IsNumber(busLocObj)) {
-        devNum = static_cast<uint8_t>(busLocObj->valueint);
+        usbInfo.busLocation = static_cast<uint32_t>(busLocObj->valueint);
     }
-    cJSON *devNumObj = cJSON_GetObjectItemCaseSensitive(usbJson, BUS_NUM_KEY);
-    if (devNumObj != nullptr && cJSON_IsNumber(devNumObj)) {
-        busLocation = static_cast<uint32_t>(devNumObj->valueint);
+    cJSON *vendorObj = cJSON_GetObjectItemCaseSensitive(usbJson, DEV_VENDOR_ID_KEY);
+    if (vendorObj != nullptr && cJSON_IsNumber(vendorObj)) {
+        usbInfo.vendorId = static_cast<uint16_t>(vendorObj->valueint);
+    }
+    cJSON *productObj = cJSON_GetObjectItemCaseSensitive(usbJson, DEV_PRODUCT_ID_KEY);
+    if (productObj != nullptr && cJSON_IsNumber(productObj)) {
+        usbInfo.productId = static_cast<uint16_t>(productObj->valueint);
+    }
+    cJSON *vendorName = cJSON_GetObjectItemCaseSensitive(usbJson, DEV_MANUFACTURER_KEY);
+    if (vendorName != nullptr && cJSON_IsString(vendorName) && vendorName->valuestring != nullptr) {
+        usbInfo.vendor = vendorName->valuestring;
+    }
+    cJSON *productName = cJSON_GetObjectItemCaseSensitive(usbJson, DEV_PRODUCT_NAME_KEY);
+    if (productName != nullptr && cJSON_IsString(productName) && productName->valuestring != nullptr) {
+        usbInfo.product = productName->valuestring;
     }
     cJSON_Delete(usbJson);
     LOGD("[L2:UsbEventSubscriber] GetValueFromUsbDataInfo: <<< EXIT SUCCESS <<< devNum=%{public}u,"
-         "busLocation=%{public}u", devNum, busLocation);
+         "busLocation=%{public}u, vendorId=%{public}u, productId=%{public}u", usbInfo.devNum, usbInfo.busLocation,
+         usbInfo.vendorId, usbInfo.productId);
 }
 
 std::string UsbEventSubscriber::ToLowerString(const char* str)
@@ -271,7 +290,7 @@ bool UsbEventSubscriber::ShouldHandleMtpDevice(const std::string &usbInfo, Devic
     }
 
     bool shouldHandle = false;
-    cJSON* productName = cJSON_GetObjectItemCaseSensitive(usbJson, "productName");
+    cJSON* productName = cJSON_GetObjectItemCaseSensitive(usbJson, DEV_PRODUCT_NAME_KEY);
     if (productName && cJSON_IsString(productName) && productName->valuestring) {
         std::string lowerName = ToLowerString(productName->valuestring);
         if (lowerName.find("mtp") != std::string::npos || lowerName.find("ptp") != std::string::npos) {
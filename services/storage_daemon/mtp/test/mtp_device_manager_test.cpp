@@ -14,6 +14,7 @@
  */
 
 #include "gtest/gtest.h"
+#include <algorithm>
 #include <cstdint>
 #include "mtp/mtp_device_manager.h"
 #include "storage_service_errno.h"
@@ -64,7 +65,7 @@ public:
 
     void TearDown()
     {
-        MtpDeviceManager::GetInstance().isMounting_ = false;
+        MtpDeviceManager::GetInstance().mountingPaths_.clear();
     }
 protected:
     MtpDeviceInfo deviceInfo;
@@ -97,7 +98,7 @@ HWTEST_F(MtpDeviceManagerTest, MountDeviceTest_001, TestSize.Level1)
     GTEST_LOG_(INFO) << "MountDeviceTest_001 start";
 
     MtpDeviceManager& manager = MtpDeviceManager::GetInstance();
-    manager.isMounting_ = true;
+    manager.mountingPaths_.insert(deviceInfo.path);
     int32_t result = manager.MountDevice(deviceInfo);
     EXPECT_EQ(result, E_MTP_IS_MOUNTING);
 
@@ -114,7 +115,6 @@ HWTEST_F(MtpDeviceManagerTest, MountDeviceTest_002, TestSize.Level1)
     GTEST_LOG_(INFO) << "MountDeviceTest_002 start";
 
     auto &manager = MtpDeviceManager::GetInstance();
-    manager.isMounting_ = false;
     EXPECT_CALL(*fileUtilMoc_, IsDir(_)).WillOnce(Return(true));
     std::vector<std::string> output = {"mock error"};
     EXPECT_CALL(*fileUtilMoc_, ForkExec(_, _, _))
@@ -123,7 +123,7 @@ HWTEST_F(MtpDeviceManagerTest, MountDeviceTest_002, TestSize.Level1)
             Return(0)
         ));
     EXPECT_NE(manager.MountDevice(deviceInfo), E_OK);
-    EXPECT_FALSE(manager.isMounting_);
+    EXPECT_TRUE(manager.mountingPaths_.empty());
 
     GTEST_LOG_(INFO) << "MountDeviceTest_002 end";
 }
@@ -138,11 +138,10 @@ HWTEST_F(MtpDeviceManagerTest, MountDeviceTest_003, TestSize.Level1)
     GTEST_LOG_(INFO) << "MountDeviceTest_003 start";
 
     auto &manager = MtpDeviceManager::GetInstance();
-    manager.isMounting_ = false;
     EXPECT_CALL(*fileUtilMoc_, IsDir(_)).WillOnce(Return(false));
     EXPECT_CALL(*fileUtilMoc_, PrepareDir(_, _, _, _)).WillOnce(Return(false));
     EXPECT_EQ(manager.MountDevice(deviceInfo), E_MTP_PREPARE_DIR_ERR);
-    EXPECT_FALSE(manager.isMounting_);
+    EXPECT_TRUE(manager.mountingPaths_.empty());
 
     GTEST_LOG_(INFO) << "MountDeviceTest_003 end";
 }
@@ -157,7 +156,6 @@ HWTEST_F(MtpDeviceManagerTest, MountDeviceTest_004, TestSize.Level1)
     GTEST_LOG_(INFO) << "MountDeviceTest_004 start";
 
     auto &manager = MtpDeviceManager::GetInstance();
-    manager.isMounting_ = false;
     EXPECT_CALL(*fileUtilMoc_, IsDir(_)).WillOnce(Return(true));
     std::vector<std::string> output = {"mock error"};
     EXPECT_CALL(*fileUtilMoc_, ForkExec(_, _, _))
@@ -168,11 +166,41 @@ HWTEST_F(MtpDeviceManagerTest, MountDeviceTest_004, TestSize.Level1)
     EXPECT_CALL(*libraryFuncMock_, umount(_)).WillOnce(Return(0));
     EXPECT_CALL(*libraryFuncMock_, rmdir(_)).WillOnce(Return(0));
     EXPECT_NE(manager.MountDevice(deviceInfo), E_OK);
-    EXPECT_FALSE(manager.isMounting_);
+    EXPECT_TRUE(manager.mountingPaths_.empty());
 
     GTEST_LOG_(INFO) << "MountDeviceTest_004 end";
 }
 
+/**
+ * @tc.name  : MountDeviceTest_005
+ * @tc.number: MountDeviceTest_005
+ * @tc.desc  : Another mount point mounts while one is mounting, and mtpfs gets the device as "bus/devnum"
+ */
+HWTEST_F(MtpDeviceManagerTest, MountDeviceTest_005, TestSize.Level1)
+{
+    GTEST_LOG_(INFO) << "MountDeviceTest_005 start";
+
+    auto &manager = MtpDeviceManager::GetInstance();
+    manager.mountingPaths_.insert("/test/other_path");
+    deviceInfo.busLocation = 3;
+    deviceInfo.devNum = 7;
+    std::vector<std::string> cmd;
+    EXPECT_CALL(*fileUtilMoc_, IsDir(_)).WillOnce(Return(true));
+    EXPECT_CALL(*fileUtilMoc_, ForkExec(_, _, _))
+        .WillOnce(DoAll(
+            WithArg<0>([&cmd](std::vector<std::string> &in) { cmd = in; }),
+            Return(0)
+        ));
+    EXPECT_EQ(manager.MountDevice(deviceInfo), E_OK);
+    ASSERT_GE(cmd.size(), 2U);
+    EXPECT_EQ(cmd[cmd.size() - 2], "3/7");
+    EXPECT_EQ(cmd.back(), deviceInfo.path);
+    EXPECT_EQ(std::find(cmd.begin(), cmd.end(), "--device"), cmd.end());
+    EXPECT_EQ(manager.mountingPaths_.size(), 1U);
+
+    GTEST_LOG_(INFO) << "MountDeviceTest_005 end";
+}
+
 /**
  * @tc.name  : UmountDeviceTest_001
  * @tc.number: UmountDeviceTest_001
@@ -301,7 +329,6 @@ HWTEST_F(MtpDeviceManagerTest, DeviceTypeTest_003, TestSize.Level1)
     GTEST_LOG_(INFO) << "DeviceTypeTest_003 start";
 
     auto &manager = MtpDeviceManager::GetInstance();
-    manager.isMounting_ = false;
     MtpDeviceInfo device;
     device.type = "";
     device.path = "/test/path_empty_type";
@@ -311,7 +338,7 @@ HWTEST_F(MtpDeviceManagerTest, DeviceTypeTest_003, TestSize.Level1)
     EXPECT_CALL(*libraryFuncMock_, umount(_)).WillOnce(Return(0));
     EXPECT_CALL(*libraryFuncMock_, rmdir(_)).WillOnce(Return(0));
     EXPECT_NE(manager.MountDevice(device), E_OK);
-    EXPECT_FALSE(manager.isMounting_);
+    EXPECT_TRUE(manager.mountingPaths_.empty());
 
     GTEST_LOG_(INFO) << "DeviceTypeTest_003 end";
 }
@@ -13,6 +13,12 @@
  * limitations under the License.
  */
 
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <set>
+#include <thread>
+
 #include "gtest/gtest.h"
 #include "mtp/mtp_device_manager.h"
 #include "mtp/mtp_device_monitor.h"
@@ -48,15 +54,113 @@ extern "C" int GetParameter(const char *key, const char *def, char *value, uint3
     return g_getParameter;
 }
 
+constexpr auto FAKE_MOUNT_COST = std::chrono::milliseconds(50);
+constexpr uint16_t FAKE_VENDOR_ID = 0x12d1;
+constexpr uint16_t FAKE_PRODUCT_ID = 0x107e;
+
+// Stands in for mtpfs: counts mounts and unmounts and the mounts running at the same time, and can hold
+// every mount until released to simulate a slow device.
+class FakeMtpBackend {
+public:
+    void Install(MtpDeviceMonitor &monitor)
+    {
+        monitor.mountFunc_ = [this](const MtpDeviceInfo &device) { return Mount(device); };
+        monitor.umountFunc_ = [this](const MtpDeviceInfo &device, bool needNotify, bool isBadRemove) {
+            (void)needNotify;
+            std::lock_guard<std::mutex> lock(mutex_);
+            umounts_.push_back(device.id);
+            if (isBadRemove) {
+                badRemoves_++;
+            }
+            return E_OK;
+        };
+    }
+
+    void Hold()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        held_ = true;
+    }
+
+    void Release()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            held_ = false;
+        }
+        cv_.notify_all();
+    }
+
+    // Waits until count mounts have started.
+    bool WaitStarted(int32_t count)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        return cv_.wait_for(lock, std::chrono::seconds(5), [this, count]() { return started_ >= count; });
+    }
+
+    int32_t Mount(const MtpDeviceInfo &device)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        started_++;
+        running_++;
+        maxRunning_ = std::max(maxRunning_, running_);
+        cv_.notify_all();
+        cv_.wait(lock, [this]() { return !held_; });
+        lock.unlock();
+        std::this_thread::sleep_for(FAKE_MOUNT_COST);
+        lock.lock();
+        running_--;
+        mounted_.insert(device.path);
+        return E_OK;
+    }
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool held_ = false;
+    int32_t started_ = 0;
+    int32_t running_ = 0;
+    int32_t maxRunning_ = 0;
+    int32_t badRemoves_ = 0;
+    std::set<std::string> mounted_;
+    std::vector<std::string> umounts_;
+};
+
+UsbAttachInfo FakeAttachInfo(uint32_t busLocation, uint8_t devNum)
+{
+    UsbAttachInfo info;
+    info.busLocation = busLocation;
+    info.devNum = devNum;
+    info.vendorId = FAKE_VENDOR_ID;
+    info.productId = FAKE_PRODUCT_ID;
+    info.vendor = "FakeVendor";
+    info.product = "FakePhone";
+    return info;
+}
+
 class MtpDeviceMonitorTest : public testing::Test {
 public:
     static void SetUpTestCase(void) {};
     static void TearDownTestCase(void) {};
     void SetUp()
     {
-        MtpDeviceMonitor::GetInstance().lastestMtpDevList_.clear();
+        MtpDeviceMonitor &monitor = MtpDeviceMonitor::GetInstance();
+        monitor.lastestMtpDevList_.clear();
+        monitor.mountingDevs_.clear();
+        mountFunc_ = monitor.mountFunc_;
+        umountFunc_ = monitor.umountFunc_;
     };
-    void TearDown(){};
+    void TearDown()
+    {
+        MtpDeviceMonitor &monitor = MtpDeviceMonitor::GetInstance();
+        monitor.mountFunc_ = mountFunc_;
+        monitor.umountFunc_ = umountFunc_;
+        monitor.lastestMtpDevList_.clear();
+        monitor.mountingDevs_.clear();
+    };
+
+protected:
+    MtpMountFunc mountFunc_;
+    MtpUmountFunc umountFunc_;
 };
 
 /**
@@ -426,6 +530,113 @@ HWTEST_F(MtpDeviceMonitorTest, UmountDetachedMtpDeviceTest_001, TestSize.Level1)
 
     GTEST_LOG_(INFO) << "UmountDetachedMtpDeviceTest_001 end";
 }
+/**
+ * @tc.name: MountMtpDeviceByBroadcastTest_001
+ * @tc.desc: Verify devices attached together mount side by side, each at its own mount point, and a device
+ *           attached again while mounted is not mounted twice.
+ * @tc.type: FUNC
+ */
+HWTEST_F(MtpDeviceMonitorTest, MountMtpDeviceByBroadcastTest_001, TestSize.Level1)
+{
+    GTEST_LOG_(INFO) << "MountMtpDeviceByBroadcastTest_001 start";
+
+    MtpDeviceMonitor &monitor = MtpDeviceMonitor::GetInstance();
+    FakeMtpBackend backend;
+    backend.Install(monitor);
+    const uint8_t deviceCount = 4;
+    std::vector<std::thread> events;
+    for (uint8_t dev = 1; dev <= deviceCount; dev++) {
+        events.emplace_back([&monitor, dev]() {
+            monitor.MountMtpDeviceByBroadcast(DeviceType::MOBILE, FakeAttachInfo(1, dev));
+        });
+    }
+    for (auto &event : events) {
+        event.join();
+    }
+    ASSERT_EQ(monitor.lastestMtpDevList_.size(), deviceCount);
+    std::set<std::string> ids;
+    for (const auto &device : monitor.lastestMtpDevList_) {
+        ids.insert(device.id);
+    }
+    EXPECT_EQ(ids.size(), deviceCount);
+    EXPECT_EQ(backend.mounted_.size(), deviceCount);
+    EXPECT_GT(backend.maxRunning_, 1);
+    EXPECT_TRUE(monitor.mountingDevs_.empty());
+
+    monitor.MountMtpDeviceByBroadcast(DeviceType::MOBILE, FakeAttachInfo(1, 2));
+    EXPECT_EQ(backend.started_, deviceCount);
+    EXPECT_EQ(monitor.lastestMtpDevList_.size(), deviceCount);
+
+    GTEST_LOG_(INFO) << "MountMtpDeviceByBroadcastTest_001 end";
+}
+
+/**
+ * @tc.name: MountMtpDeviceByBroadcastTest_002
+ * @tc.desc: Verify an attach/detach storm: a repeated attach during the mount is dropped, a device detached
+ *           while mounting is unmounted as a bad remove once the mount returns, and the others stay mounted.
+ * @tc.type: FUNC
+ */
+HWTEST_F(MtpDeviceMonitorTest, MountMtpDeviceByBroadcastTest_002, TestSize.Level1)
+{
+    GTEST_LOG_(INFO) << "MountMtpDeviceByBroadcastTest_002 start";
+
+    MtpDeviceMonitor &monitor = MtpDeviceMonitor::GetInstance();
+    FakeMtpBackend backend;
+    backend.Install(monitor);
+    backend.Hold();
+    std::vector<std::thread> events;
+    for (uint8_t dev = 1; dev <= 3; dev++) {
+        events.emplace_back([&monitor, dev]() {
+            monitor.MountMtpDeviceByBroadcast(DeviceType::MOBILE, FakeAttachInfo(2, dev));
+        });
+    }
+    ASSERT_TRUE(backend.WaitStarted(3));
+    // All three are mounting: a repeated attach is dropped, and two devices go away.
+    monitor.MountMtpDeviceByBroadcast(DeviceType::MOBILE, FakeAttachInfo(2, 1));
+    monitor.UmountDetachedMtpDevice(2, 1);
+    monitor.UmountDetachedMtpDevice(2, 3);
+    EXPECT_TRUE(backend.umounts_.empty());
+    backend.Release();
+    for (auto &event : events) {
+        event.join();
+    }
+    EXPECT_EQ(backend.started_, 3);
+    ASSERT_EQ(monitor.lastestMtpDevList_.size(), 1U);
+    EXPECT_EQ(monitor.lastestMtpDevList_[0].devNum, 2);
+    EXPECT_EQ(backend.umounts_.size(), 2U);
+    EXPECT_EQ(backend.badRemoves_, 2);
+    EXPECT_TRUE(monitor.mountingDevs_.empty());
+
+    monitor.UmountDetachedMtpDevice(2, 2);
+    EXPECT_TRUE(monitor.lastestMtpDevList_.empty());
+    EXPECT_EQ(backend.badRemoves_, 3);
+
+    GTEST_LOG_(INFO) << "MountMtpDeviceByBroadcastTest_002 end";
+}
+
+/**
+ * @tc.name: StopMonitorTest_001
+ * @tc.desc: Verify the monitor thread waits on the stop signal instead of sleeping, and wakes up at once.
+ * @tc.type: FUNC
+ */
+HWTEST_F(MtpDeviceMonitorTest, StopMonitorTest_001, TestSize.Level1)
+{
+    GTEST_LOG_(INFO) << "StopMonitorTest_001 start";
+
+    MtpDeviceMonitor &monitor = MtpDeviceMonitor::GetInstance();
+    auto start = std::chrono::steady_clock::now();
+    std::thread waiter([&monitor]() { EXPECT_TRUE(monitor.WaitForStop(10)); });
+    monitor.StopMonitor();
+    waiter.join();
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(5));
+    {
+        std::lock_guard<std::mutex> lock(monitor.stopMutex_);
+        monitor.stopping_ = false;
+    }
+    EXPECT_FALSE(monitor.WaitForStop(0));
+
+    GTEST_LOG_(INFO) << "StopMonitorTest_001 end";
+}
 /**
  * @tc.name: IsHwitDeviceTest_001
  * @tc.desc: Verify returns true when KEY_CUST contains 'hwit'.
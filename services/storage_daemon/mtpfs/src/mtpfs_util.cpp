@@ -262,6 +262,17 @@ LIBMTP_raw_device_t *smtpfs_raw_device_new_priv(libusb_device *usb_device)
     device->device_entry.product = nullptr;
     device->device_entry.product_id = desc.idProduct;
     device->device_entry.device_flags = 0;
+    // Opened by bus and devnum without a libmtp probe, so take the quirk flags from the libmtp device table.
+    LIBMTP_device_entry_t *entries = nullptr;
+    int numEntries = 0;
+    if (LIBMTP_Get_Supported_Devices_List(&entries, &numEntries) == 0 && entries != nullptr) {
+        for (int i = 0; i < numEntries; ++i) {
+            if (entries[i].vendor_id == desc.idVendor && entries[i].product_id == desc.idProduct) {
+                device->device_entry.device_flags = entries[i].device_flags;
+                break;
+            }
+        }
+    }
 
     device->bus_location = static_cast<uint32_t>(libusb_get_bus_number(usb_device));
     device->devnum = libusb_get_device_address(usb_device);
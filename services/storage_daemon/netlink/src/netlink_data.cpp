@@ -17,65 +17,96 @@
 
 namespace OHOS {
 namespace StorageDaemon {
-constexpr int ACTION_PRE_LEN = 7;
-constexpr int DEVPATH_PRE_LEN = 8;
-constexpr int SUBSYSTEM_PRE_LEN = 10;
-constexpr int DEVNAME_PRE_LEN = 8;
-constexpr int DISK_EJECT_REQUEST_LEN = 19;
-constexpr int NL_PARAMS_MAX = 128;
-constexpr const char *EMPTY_STRING = "";
+constexpr std::string_view ACTION_PREFIX = "ACTION=";
+constexpr std::string_view DEVPATH_PREFIX = "DEVPATH=";
+constexpr std::string_view SUBSYSTEM_PREFIX = "SUBSYSTEM=";
+constexpr std::string_view DEVNAME_PREFIX = "DEVNAME=";
+constexpr std::string_view DISK_EJECT_REQUEST_PREFIX = "DISK_EJECT_REQUEST=";
+constexpr std::string_view SUBSYSTEM_BLOCK = "SUBSYSTEM=block";
+constexpr std::string_view DEVTYPE_DISK = "DEVTYPE=disk";
+constexpr std::string_view SYS_PREFIX = "/sys";
+
+static bool ConsumePrefix(std::string_view &field, std::string_view prefix)
+{
+    if (field.compare(0, prefix.size(), prefix) != 0) {
+        return false;
+    }
+    field.remove_prefix(prefix.size());
+    return true;
+}
 
 void NetlinkData::Decode(const char *msg)
 {
     LOGD("[L4:NetlinkData] Decode: >>> ENTER <<<");
 
-    int32_t paramIdx = 0;
+    subSystem_ = {};
+    devPath_ = {};
+    ejectRequest_ = {};
+    diskName_ = {};
+    paramCount_ = 0;
+    action_ = Actions::UNKNOWN;
 
     while (*msg) {
-        if (!strncmp(msg, "ACTION=", ACTION_PRE_LEN)) {
-            msg += ACTION_PRE_LEN;
-            auto iter = actionMaps.find(msg);
+        std::string_view field(msg);
+        msg += field.size() + 1;
+        if (ConsumePrefix(field, ACTION_PREFIX)) {
+            auto iter = actionMaps.find(field);
             if (iter != actionMaps.end()) {
                 action_ = iter->second;
             }
-        } else if (!strncmp(msg, "DEVPATH=", DEVPATH_PRE_LEN)) {
-            msg += DEVPATH_PRE_LEN;
-            devPath_ = std::string(msg);
-            sysPath_ = "/sys" + devPath_;
-        } else if (!strncmp(msg, "SUBSYSTEM=", SUBSYSTEM_PRE_LEN)) {
-            msg += SUBSYSTEM_PRE_LEN;
-            subSystem_ = std::string(msg);
-        } else if (!strncmp(msg, "DEVNAME=", DEVNAME_PRE_LEN)) {
-            msg += DEVNAME_PRE_LEN;
-            diskName_ = std::string(msg);
-        } else if (!strncmp(msg, "DISK_EJECT_REQUEST=", DISK_EJECT_REQUEST_LEN)) {
-            msg += DISK_EJECT_REQUEST_LEN;
-            ejectRequest_ = std::string(msg);
-        } else if (paramIdx < NL_PARAMS_MAX) {
-            params_.push_back(std::string(msg));
-            ++paramIdx;
+        } else if (ConsumePrefix(field, DEVPATH_PREFIX)) {
+            devPath_ = field;
+        } else if (ConsumePrefix(field, SUBSYSTEM_PREFIX)) {
+            subSystem_ = field;
+        } else if (ConsumePrefix(field, DEVNAME_PREFIX)) {
+            diskName_ = field;
+        } else if (ConsumePrefix(field, DISK_EJECT_REQUEST_PREFIX)) {
+            ejectRequest_ = field;
+        } else if (paramCount_ < NL_PARAMS_MAX) {
+            params_[paramCount_++] = field;
         }
-        while (*msg++);
     }
 
-    LOGD("[L4:NetlinkData] Decode: <<< EXIT SUCCESS <<< action=%{public}d, subsystem=%{public}s, devPath=%{public}s",
-         static_cast<int>(action_), subSystem_.c_str(), devPath_.c_str());
+    LOGD("[L4:NetlinkData] Decode: <<< EXIT SUCCESS <<< action=%{public}d, params=%{public}zu",
+         static_cast<int>(action_), paramCount_);
     return;
 }
 
+bool NetlinkData::IsBlockDiskEvent(const char *msg)
+{
+    if (msg == nullptr) {
+        return false;
+    }
+    bool isBlock = false;
+    bool isDisk = false;
+    while (*msg && !(isBlock && isDisk)) {
+        std::string_view field(msg);
+        msg += field.size() + 1;
+        isBlock = isBlock || field == SUBSYSTEM_BLOCK;
+        isDisk = isDisk || field == DEVTYPE_DISK;
+    }
+    return isBlock && isDisk;
+}
+
 std::string NetlinkData::GetSyspath()
 {
-    return sysPath_.empty() ? EMPTY_STRING : sysPath_;
+    if (devPath_.empty()) {
+        return "";
+    }
+    std::string sysPath;
+    sysPath.reserve(SYS_PREFIX.size() + devPath_.size());
+    sysPath.append(SYS_PREFIX).append(devPath_);
+    return sysPath;
 }
 
 std::string NetlinkData::GetDevpath()
 {
-    return devPath_.empty() ? EMPTY_STRING : devPath_;
+    return std::string(devPath_);
 }
 
 std::string NetlinkData::GetSubsystem()
 {
-    return subSystem_.empty() ? EMPTY_STRING : subSystem_;
+    return std::string(subSystem_);
 }
 
 NetlinkData::Actions NetlinkData::GetAction()
@@ -85,28 +116,25 @@ NetlinkData::Actions NetlinkData::GetAction()
 
 std::string NetlinkData::GetEjectRequest()
 {
-    return ejectRequest_;
+    return std::string(ejectRequest_);
 }
 
 std::string NetlinkData::GetDiskName()
 {
-    return diskName_;
+    return std::string(diskName_);
 }
 
 const std::string NetlinkData::GetParam(const std::string paramName)
 {
     size_t len = paramName.size();
-
-    std::vector<std::string>::iterator iter;
-    for (iter = params_.begin(); iter != params_.end(); ++iter) {
-        const char *ptr = iter->c_str() + len;
-        if (strncmp(iter->c_str(), paramName.c_str(), len) == 0 && *ptr == '=') {
-            return ++ptr;
+    for (size_t i = 0; i < paramCount_; ++i) {
+        std::string_view param = params_[i];
+        if (param.size() > len && param[len] == '=' && param.compare(0, len, paramName) == 0) {
+            return std::string(param.substr(len + 1));
         }
     }
 
-    return EMPTY_STRING;
+    return "";
 }
 } // namespace StorageDaemon
 } // namespace OHOS
-
@@ -58,24 +58,24 @@ void NetlinkHandler::OnEvent(char *msg)
         LOGE("NetlinkHandler::OnEvent msg is nullptr");
         return;
     }
+    if (!NetlinkData::IsBlockDiskEvent(msg)) {
+        return;
+    }
+    NetlinkData nlData;
+    nlData.Decode(msg);
+    auto matchedDisk = DiskManager::Instance().MatchConfig(&nlData);
+    if (matchedDisk == nullptr) {
+        LOGI("devPath=%{public}s not in whitelist, skip", nlData.GetDevpath().c_str());
+        return;
+    }
+#ifdef DISK_MANAGER
     std::string convertedMsg;
     for (char *p = msg; *p; p += strlen(p) + 1) {
         if (!convertedMsg.empty()) convertedMsg += '\n';
         convertedMsg += p;
     }
-    auto nlData = std::make_unique<NetlinkData>();
-    nlData->Decode(msg);
-
-    if (strcmp(nlData->GetSubsystem().c_str(), "block") == 0 && nlData.get()->GetParam("DEVTYPE") == "disk") {
-        auto matchedDisk = DiskManager::Instance().MatchConfig(nlData.get());
-        if (matchedDisk == nullptr) {
-            LOGI("devPath=%{public}s not in whitelist, skip", nlData->GetDevpath().c_str());
-            return;
-        }
-#ifdef DISK_MANAGER
-        OHOS::DiskManager::DiskManagerClient::GetInstance().OnBlockDiskUevent(convertedMsg);
+    OHOS::DiskManager::DiskManagerClient::GetInstance().OnBlockDiskUevent(convertedMsg);
 #endif
-    }
 }
 } // StorageDaemon
 } // OHOS
@@ -25,52 +25,60 @@
 
 constexpr int POLL_IDLE_TIME = 1000;
 constexpr int UEVENT_MSG_LEN = 1024;
+constexpr int UEVENT_BATCH_SIZE = 8;
 
 namespace OHOS {
 namespace StorageDaemon {
-ssize_t UeventKernelMulticastRecv(int32_t socket, char *buffer, size_t length)
-{
-    struct iovec iov = { buffer, length };
-    struct sockaddr_nl addr;
+struct UeventSlot {
+    char buffer[UEVENT_MSG_LEN + 1];
     char control[CMSG_SPACE(sizeof(struct ucred))];
-    struct msghdr hdr = {
-        .msg_name = &addr,
-        .msg_namelen = sizeof(addr),
-        .msg_iov = &iov,
-        .msg_iovlen = 1,
-        .msg_control = control,
-        .msg_controllen = sizeof(control),
-        .msg_flags = 0,
-    };
-    struct cmsghdr *cmsg;
-
-    ssize_t n = recvmsg(socket, &hdr, 0);
-    if (n <= 0) {
-        LOGE("[L3:NetlinkListener] UeventKernelMulticastRecv: <<< EXIT FAILED <<< recvmsg failed, errno=%{public}d",
-             errno);
-        return n;
-    }
+    struct sockaddr_nl addr;
+    struct iovec iov;
+};
 
+static bool IsKernelUevent(const struct msghdr &hdr, const struct sockaddr_nl &addr)
+{
     if (addr.nl_groups == 0 || addr.nl_pid != 0) {
-        LOGE("[L3:NetlinkListener] UeventKernelMulticastRecv: <<< EXIT FAILED <<< invalid addr, nl_groups=%{public}u,"
-             "nl_pid=%{public}u",
+        LOGE("[L3:NetlinkListener] IsKernelUevent: invalid addr, nl_groups=%{public}u, nl_pid=%{public}u",
              addr.nl_groups, addr.nl_pid);
-        return E_ERR;
+        return false;
     }
 
-    cmsg = CMSG_FIRSTHDR(&hdr);
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&hdr);
     if (cmsg == nullptr || cmsg->cmsg_type != SCM_CREDENTIALS) {
-        LOGE("[L3:NetlinkListener] UeventKernelMulticastRecv: <<< EXIT FAILED <<< SCM_CREDENTIALS check failed");
-        return E_ERR;
+        LOGE("[L3:NetlinkListener] IsKernelUevent: SCM_CREDENTIALS check failed");
+        return false;
     }
 
     struct ucred cred;
     if (memcpy_s(&cred, sizeof(cred), CMSG_DATA(cmsg), sizeof(struct ucred)) != EOK || cred.uid != 0) {
-        LOGE("[L3:NetlinkListener] UeventKernelMulticastRecv: <<< EXIT FAILED <<< uid check failed, uid=%{public}u",
-             cred.uid);
-        return E_ERR;
+        LOGE("[L3:NetlinkListener] IsKernelUevent: uid check failed, uid=%{public}u", cred.uid);
+        return false;
     }
+    return true;
+}
 
+/*
+ * Drains up to UEVENT_BATCH_SIZE pending uevents with a single recvmmsg call. The socket is read
+ * non-blocking so that an empty queue returns to the poll loop instead of parking the thread.
+ */
+static int32_t UeventKernelMulticastRecvBatch(int32_t socket, UeventSlot *slots, struct mmsghdr *msgs)
+{
+    for (int32_t i = 0; i < UEVENT_BATCH_SIZE; i++) {
+        slots[i].iov = { slots[i].buffer, UEVENT_MSG_LEN };
+        (void)memset_s(&msgs[i], sizeof(msgs[i]), 0, sizeof(msgs[i]));
+        msgs[i].msg_hdr.msg_name = &slots[i].addr;
+        msgs[i].msg_hdr.msg_namelen = sizeof(slots[i].addr);
+        msgs[i].msg_hdr.msg_iov = &slots[i].iov;
+        msgs[i].msg_hdr.msg_iovlen = 1;
+        msgs[i].msg_hdr.msg_control = slots[i].control;
+        msgs[i].msg_hdr.msg_controllen = sizeof(slots[i].control);
+    }
+
+    int32_t n = recvmmsg(socket, msgs, UEVENT_BATCH_SIZE, MSG_DONTWAIT, nullptr);
+    if (n <= 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+        LOGE("[L3:NetlinkListener] UeventKernelMulticastRecvBatch: recvmmsg failed, errno=%{public}d", errno);
+    }
     return n;
 }
 
@@ -78,21 +86,29 @@ void NetlinkListener::RecvUeventMsg()
 {
     LOGD("[L3:NetlinkListener] RecvUeventMsg: >>> ENTER <<<");
 
-    auto msg = std::make_unique<char[]>(UEVENT_MSG_LEN + 1);
+    auto slots = std::make_unique<UeventSlot[]>(UEVENT_BATCH_SIZE);
+    struct mmsghdr msgs[UEVENT_BATCH_SIZE];
 
     while (1) {
-        auto count = UeventKernelMulticastRecv(socketFd_, msg.get(), UEVENT_MSG_LEN);
-        if (count <= 0) {
-            (void)memset_s(msg.get(), UEVENT_MSG_LEN + 1, 0, UEVENT_MSG_LEN + 1);
+        int32_t received = UeventKernelMulticastRecvBatch(socketFd_, slots.get(), msgs);
+        if (received <= 0) {
             break;
         }
-        if (count >= UEVENT_MSG_LEN) {
-            LOGD("[L3:NetlinkListener] RecvUeventMsg: message too long, count=%{public}zd, skip", count);
-            continue;
+        for (int32_t i = 0; i < received; i++) {
+            size_t count = msgs[i].msg_len;
+            if (count == 0 || !IsKernelUevent(msgs[i].msg_hdr, slots[i].addr)) {
+                continue;
+            }
+            if (count >= UEVENT_MSG_LEN || (msgs[i].msg_hdr.msg_flags & MSG_TRUNC) != 0) {
+                LOGD("[L3:NetlinkListener] RecvUeventMsg: message too long, count=%{public}zu, skip", count);
+                continue;
+            }
+            slots[i].buffer[count] = '\0';
+            OnEvent(slots[i].buffer);
+        }
+        if (received < UEVENT_BATCH_SIZE) {
+            break;
         }
-
-        msg.get()[count] = '\0';
-        OnEvent(msg.get());
     }
 
     LOGD("[L3:NetlinkListener] RecvUeventMsg: <<< EXIT SUCCESS <<<");
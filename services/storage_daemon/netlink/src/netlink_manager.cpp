@@ -27,6 +27,7 @@
 
 namespace OHOS {
 namespace StorageDaemon {
+constexpr uint32_t UEVENT_KERNEL_GROUP = 1;
 
 NetlinkManager &NetlinkManager::Instance()
 {
@@ -45,7 +46,8 @@ int32_t NetlinkManager::Start()
     (void)memset_s(&addr, sizeof(addr), 0, sizeof(addr));
     addr.nl_family = AF_NETLINK;
     addr.nl_pid = static_cast<uint32_t>(getprocpid());
-    addr.nl_groups = 0xffffffff;
+    // only the kernel multicast group carries uevents we accept, so udev rebroadcasts never reach userspace
+    addr.nl_groups = UEVENT_KERNEL_GROUP;
 
     socketFd_ = socket(PF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC, NETLINK_KOBJECT_UEVENT);
     if (socketFd_ < 0) {
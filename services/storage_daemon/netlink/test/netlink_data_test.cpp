@@ -171,5 +171,49 @@ HWTEST_F(NetlinkDataTest, NetlinkDataTest_Decode_DiskName_0000, TestSize.Level1)
 
     GTEST_LOG_(INFO) << "NetlinkDataTest_Decode_DiskName_0000 end";
 }
+
+/**
+ * @tc.name: NetlinkDataTest_IsBlockDiskEvent_001
+ * @tc.desc: Verify the IsBlockDiskEvent pre-filter only accepts block disk uevents.
+ * @tc.type: FUNC
+ */
+HWTEST_F(NetlinkDataTest, NetlinkDataTest_IsBlockDiskEvent_001, TestSize.Level1)
+{
+    GTEST_LOG_(INFO) << "NetlinkDataTest_IsBlockDiskEvent_001 start";
+
+    EXPECT_FALSE(NetlinkData::IsBlockDiskEvent(nullptr));
+    EXPECT_FALSE(NetlinkData::IsBlockDiskEvent(""));
+    EXPECT_FALSE(NetlinkData::IsBlockDiskEvent("ACTION=add\0SUBSYSTEM=usb\0DEVTYPE=usb_device\0"));
+    EXPECT_FALSE(NetlinkData::IsBlockDiskEvent("ACTION=add\0SUBSYSTEM=block\0DEVTYPE=partition\0"));
+    EXPECT_FALSE(NetlinkData::IsBlockDiskEvent("ACTION=add\0SUBSYSTEM=blocks\0DEVTYPE=disk\0"));
+    EXPECT_TRUE(NetlinkData::IsBlockDiskEvent("ACTION=add\0DEVTYPE=disk\0SUBSYSTEM=block\0"));
+    EXPECT_TRUE(NetlinkData::IsBlockDiskEvent("ACTION=add\0SUBSYSTEM=block\0MAJOR=8\0DEVTYPE=disk\0"));
+
+    GTEST_LOG_(INFO) << "NetlinkDataTest_IsBlockDiskEvent_001 end";
+}
+
+/**
+ * @tc.name: NetlinkDataTest_Decode_Reuse_001
+ * @tc.desc: Verify that decoding a second message does not keep fields of the first one.
+ * @tc.type: FUNC
+ */
+HWTEST_F(NetlinkDataTest, NetlinkDataTest_Decode_Reuse_001, TestSize.Level1)
+{
+    GTEST_LOG_(INFO) << "NetlinkDataTest_Decode_Reuse_001 start";
+
+    const char* first = "ACTION=add\0SUBSYSTEM=block\0DEVTYPE=disk\0MAJOR=8\0";
+    const char* second = "ACTION=remove\0DEVPATH=/dev/test\0";
+    NetlinkData netlinkData;
+    netlinkData.Decode(first);
+    EXPECT_EQ(netlinkData.GetParam("MAJOR"), "8");
+    EXPECT_EQ(netlinkData.GetParam("MAJ"), "");
+    netlinkData.Decode(second);
+    EXPECT_EQ(netlinkData.GetAction(), NetlinkData::Actions::REMOVE);
+    EXPECT_EQ(netlinkData.GetSubsystem(), "");
+    EXPECT_EQ(netlinkData.GetParam("DEVTYPE"), "");
+    EXPECT_EQ(netlinkData.GetSyspath(), "/sys/dev/test");
+
+    GTEST_LOG_(INFO) << "NetlinkDataTest_Decode_Reuse_001 end";
+}
 } // STORAGE_DAEMON
 } // OHOS
@@ -13,6 +13,7 @@
  * limitations under the License.
  */
 
+#include <chrono>
 #include <fcntl.h>
 #include <memory>
 #include <sys/socket.h>
@@ -208,6 +209,35 @@ HWTEST_F(NetlinkHandlerTest, NetlinkHandlerTest_OnEvent_EmptyMsg_001, TestSize.L
     GTEST_LOG_(INFO) << "NetlinkHandlerTest_OnEvent_EmptyMsg_001 end";
 }
 
+/**
+ * @tc.name: NetlinkHandlerTest_OnEvent_Storm_001
+ * @tc.desc: Replay a storm of non-block uevents, as seen during USB hub enumeration, through OnEvent.
+ * @tc.type: FUNC
+ * @tc.require: SR000GGUOT
+ */
+HWTEST_F(NetlinkHandlerTest, NetlinkHandlerTest_OnEvent_Storm_001, TestSize.Level1)
+{
+    GTEST_LOG_(INFO) << "NetlinkHandlerTest_OnEvent_Storm_001 start";
+    int32_t socket = -1;
+    std::shared_ptr<NetlinkHandler> handler = std::make_shared<NetlinkHandler>(socket);
+    char usbMsg[] = "add@/devices/usb1/1-1\0ACTION=add\0DEVPATH=/devices/usb1/1-1\0SUBSYSTEM=usb\0"
+        "DEVTYPE=usb_device\0MAJOR=189\0MINOR=1\0SEQNUM=100\0";
+    char inputMsg[] = "add@/devices/usb1/1-1/1-1:1.0/input/input9\0ACTION=add\0"
+        "DEVPATH=/devices/usb1/1-1/1-1:1.0/input/input9\0SUBSYSTEM=input\0SEQNUM=101\0";
+    char partMsg[] = "add@/devices/usb1/block/sda/sda1\0ACTION=add\0DEVPATH=/devices/usb1/block/sda/sda1\0"
+        "SUBSYSTEM=block\0DEVTYPE=partition\0MAJOR=8\0MINOR=1\0SEQNUM=102\0";
+    constexpr int32_t stormCount = 10000;
+    auto begin = std::chrono::steady_clock::now();
+    for (int32_t i = 0; i < stormCount; i++) {
+        handler->OnEvent(usbMsg);
+        handler->OnEvent(inputMsg);
+        handler->OnEvent(partMsg);
+    }
+    auto cost = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - begin);
+    GTEST_LOG_(INFO) << "replayed " << stormCount * 3 << " uevents in " << cost.count() << " us";
+    GTEST_LOG_(INFO) << "NetlinkHandlerTest_OnEvent_Storm_001 end";
+}
+
 } // STORAGE_DAEMON
 } // OHOS
 
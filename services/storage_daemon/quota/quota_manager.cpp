@@ -33,6 +33,7 @@
 #include "storage_service_log.h"
 #include "storage_service_constant.h"
 #include "utils/file_utils.h"
+#include "utils/mount_table.h"
 #include "utils/storage_radar.h"
 #include "utils/string_utils.h"
 #include "utils/hi_audit.h"
@@ -41,7 +42,6 @@ namespace OHOS {
 namespace StorageDaemon {
 using OHOS::StorageManager::UserdataDirInfo;
 constexpr const char *QUOTA_DEVICE_DATA_PATH = "/data";
-constexpr const char *PROC_MOUNTS_PATH = "/proc/mounts";
 constexpr const char *DEV_BLOCK_PATH = "/dev/block/";
 constexpr const char *CONFIG_FILE_PATH = "/etc/passwd";
 constexpr const char *DATA_DEV_PATH = "/dev/block/by-name/userdata";
@@ -65,6 +65,7 @@ constexpr int32_t MAX_WHITE_UID_COUNT = 3;
 constexpr int32_t TOP_LARGE_COUNT = 50;
 constexpr uint64_t LARGE_FILE_SIZE_THRESHOLD = 5 * 1024 * 1024;
 constexpr int64_t LARGE_DIR_SIZE_THRESHOLD = 5 * 1024 * 1024;
+constexpr int64_t NS_PER_SEC = 1000 * 1000 * 1000;
 static std::map<std::string, std::string> mQuotaReverseMounts;
 static std::vector<int32_t> SYS_UIDS = {0, 1000, 5523};
 
@@ -78,32 +79,35 @@ QuotaManager &QuotaManager::GetInstance()
     return instance_;
 }
 
+QuotaManager::QuotaManager() : passwdPath_(CONFIG_FILE_PATH), nextQuota_(QueryNextQuota)
+{
+}
+
+int32_t QuotaManager::QueryNextQuota(int32_t fromId, KernelNextDqBlk &dq)
+{
+    if (quotactl(QCMD(Q_GETNEXTQUOTA_LOCAL, USRQUOTA), DATA_DEV_PATH, fromId, reinterpret_cast<char*>(&dq)) != 0) {
+        return E_QUOTA_CTL_KERNEL_ERR;
+    }
+    return E_OK;
+}
+
 static bool InitialiseQuotaMounts()
 {
     LOGD("[L2:QuotaManager] InitialiseQuotaMounts: >>> ENTER <<<");
     std::lock_guard<std::recursive_mutex> lock(mMountsLock);
     mQuotaReverseMounts.clear();
-    std::ifstream in(PROC_MOUNTS_PATH);
-
-    if (!in.is_open()) {
-        LOGE("[L2:QuotaManager] InitialiseQuotaMounts: <<< EXIT FAILED <<< open mounts file failed");
+    auto mountTable = MountTable::GetInstance().GetSnapshot();
+    if (mountTable == nullptr) {
+        LOGE("[L2:QuotaManager] InitialiseQuotaMounts: <<< EXIT FAILED <<< read mount table failed");
         return false;
     }
-    std::string source;
-    std::string target;
-    std::string ignored;
-
-    while (in.peek() != EOF) {
-        std::getline(in, source, ' ');
-        std::getline(in, target, ' ');
-        std::getline(in, ignored);
-        if (source.compare(0, strlen(DEV_BLOCK_PATH), DEV_BLOCK_PATH) == 0) {
-            struct dqblk dq;
-            if (quotactl(QCMD(Q_GETQUOTA, USRQUOTA), source.c_str(), 0, reinterpret_cast<char*>(&dq)) == 0) {
-                mQuotaReverseMounts[target] = source;
-            }
+    mountTable->ForEachSourcePrefix(DEV_BLOCK_PATH, [](const MountEntry &entry) {
+        std::string source(entry.source);
+        struct dqblk dq;
+        if (quotactl(QCMD(Q_GETQUOTA, USRQUOTA), source.c_str(), 0, reinterpret_cast<char*>(&dq)) == 0) {
+            mQuotaReverseMounts[std::string(entry.target)] = source;
         }
-    }
+    });
     LOGD("[L2:QuotaManager] InitialiseQuotaMounts: <<< EXIT SUCCESS <<<");
     return true;
 }
@@ -157,32 +161,31 @@ static int64_t GetOccupiedSpaceForUid(int32_t uid, int64_t &size)
 void QuotaManager::GetUidStorageStats(std::vector<UidSaInfo> &vec, int64_t &totalSize,
     const std::map<int32_t, std::string> &bundleNameAndUid, int32_t type)
 {
-    LOGI("[L2:QuotaManager] GetUidStorageStats: >>> ENTER <<<");
+    LOGI("[L2:QuotaManager] GetUidStorageStats: >>> ENTER <<< type=%{public}d", type);
+    if (type < SYS_SA || type > OTHER_APP) {
+        LOGE("[L2:QuotaManager] GetUidStorageStats: <<< EXIT FAILED <<< invalid type");
+        return;
+    }
     AllAppVec allVec;
-    auto ret = ParseConfigFile(CONFIG_FILE_PATH, allVec.sysSaVec);
-    if (ret != E_OK) {
-        LOGE("[L2:QuotaManager] GetUidStorageStats: <<< EXIT FAILED <<< parse passwd file failed");
+    int64_t saTotalSize = 0;
+    int64_t otherTotalSize = 0;
+    if (GetAllUidStorageStats(allVec, saTotalSize, otherTotalSize, bundleNameAndUid) != E_OK) {
+        LOGE("[L2:QuotaManager] GetUidStorageStats: <<< EXIT FAILED <<<");
         return;
     }
-    uint64_t iNodes = 0;
-    GetOccupiedSpaceForUidList(allVec, iNodes);
     switch (type) {
         case SYS_SA :
-            totalSize = GetSaOrOtherTotal(allVec.sysSaVec);
-            ProcessVecList(allVec.sysSaVec, true, bundleNameAndUid);
+            totalSize = saTotalSize;
             vec.swap(allVec.sysSaVec);
             break;
         case SYS_APP :
-            ProcessVecList(allVec.sysAppVec, false, bundleNameAndUid);
             vec.swap(allVec.sysAppVec);
             break;
         case USER_APP :
-            ProcessVecList(allVec.userAppVec, false, bundleNameAndUid);
             vec.swap(allVec.userAppVec);
             break;
         case OTHER_APP :
-            totalSize = GetSaOrOtherTotal(allVec.otherAppVec);
-            ProcessVecList(allVec.otherAppVec, false, bundleNameAndUid);
+            totalSize = otherTotalSize;
             vec.swap(allVec.otherAppVec);
             break;
         default:
@@ -191,6 +194,32 @@ void QuotaManager::GetUidStorageStats(std::vector<UidSaInfo> &vec, int64_t &tota
     LOGI("[L2:QuotaManager] GetUidStorageStats: <<< EXIT SUCCESS <<<");
 }
 
+int32_t QuotaManager::GetAllUidStorageStats(AllAppVec &allVec, int64_t &saTotalSize, int64_t &otherTotalSize,
+    const std::map<int32_t, std::string> &bundleNameAndUid)
+{
+    LOGI("[L2:QuotaManager] GetAllUidStorageStats: >>> ENTER <<< bundleNameAndUid.size=%{public}zu",
+        bundleNameAndUid.size());
+    allVec = AllAppVec();
+    auto ret = LoadPasswdEntries(allVec.sysSaVec);
+    if (ret != E_OK) {
+        LOGE("[L2:QuotaManager] GetAllUidStorageStats: <<< EXIT FAILED <<< parse passwd file failed");
+        return ret;
+    }
+    uint64_t iNodes = 0;
+    GetOccupiedSpaceForUidList(allVec, iNodes);
+    saTotalSize = GetSaOrOtherTotal(allVec.sysSaVec);
+    otherTotalSize = GetSaOrOtherTotal(allVec.otherAppVec);
+    BundleNameIndex bundleIndex(bundleNameAndUid.begin(), bundleNameAndUid.end());
+    ProcessVecList(allVec.sysSaVec, true, bundleIndex);
+    ProcessVecList(allVec.sysAppVec, false, bundleIndex);
+    ProcessVecList(allVec.userAppVec, false, bundleIndex);
+    ProcessVecList(allVec.otherAppVec, false, bundleIndex);
+    LOGI("[L2:QuotaManager] GetAllUidStorageStats: <<< EXIT SUCCESS <<< sa=%{public}zu, sysApp=%{public}zu,"
+        " userApp=%{public}zu, other=%{public}zu", allVec.sysSaVec.size(), allVec.sysAppVec.size(),
+        allVec.userAppVec.size(), allVec.otherAppVec.size());
+    return E_OK;
+}
+
 int64_t QuotaManager::GetSaOrOtherTotal(const std::vector<UidSaInfo> &vec)
 {
     int64_t totalSize = 0;
@@ -391,8 +420,38 @@ int32_t QuotaManager::ParseConfigFile(const std::string &path, std::vector<UidSa
     return E_OK;
 }
 
-void QuotaManager::ProcessVecList(std::vector<UidSaInfo> &vec, bool isSa,
-    const std::map<int32_t, std::string> &bundleNameAndUid)
+int32_t QuotaManager::LoadPasswdEntries(std::vector<UidSaInfo> &vec)
+{
+    std::lock_guard<std::mutex> lock(passwdMutex_);
+    struct stat st = {};
+    if (stat(passwdPath_.c_str(), &st) != 0) {
+        passwdCache_.valid = false;
+        return ParseConfigFile(passwdPath_, vec);
+    }
+    int64_t mtimeNs = static_cast<int64_t>(st.st_mtim.tv_sec) * NS_PER_SEC + st.st_mtim.tv_nsec;
+    if (passwdCache_.valid && passwdCache_.dev == st.st_dev && passwdCache_.ino == st.st_ino &&
+        passwdCache_.size == st.st_size && passwdCache_.mtimeNs == mtimeNs) {
+        vec.insert(vec.end(), passwdCache_.entries.begin(), passwdCache_.entries.end());
+        return E_OK;
+    }
+    std::vector<UidSaInfo> entries;
+    int32_t ret = ParseConfigFile(passwdPath_, entries);
+    if (ret != E_OK) {
+        passwdCache_.valid = false;
+        return ret;
+    }
+    passwdCache_.valid = true;
+    passwdCache_.dev = st.st_dev;
+    passwdCache_.ino = st.st_ino;
+    passwdCache_.size = st.st_size;
+    passwdCache_.mtimeNs = mtimeNs;
+    passwdCache_.loads++;
+    passwdCache_.entries = entries;
+    vec.insert(vec.end(), entries.begin(), entries.end());
+    return E_OK;
+}
+
+void QuotaManager::ProcessVecList(std::vector<UidSaInfo> &vec, bool isSa, const BundleNameIndex &bundleNameAndUid)
 {
     if (isSa) {
         SortAndCutSaInfoVec(vec, isSa);
@@ -402,8 +461,7 @@ void QuotaManager::ProcessVecList(std::vector<UidSaInfo> &vec, bool isSa,
     AssembleSaInfoVec(vec, bundleNameAndUid);
 }
 
-void QuotaManager::AssembleSaInfoVec(std::vector<UidSaInfo> &vec,
-    const std::map<int32_t, std::string> &bundleNameAndUid)
+void QuotaManager::AssembleSaInfoVec(std::vector<UidSaInfo> &vec, const BundleNameIndex &bundleNameAndUid)
 {
     if (bundleNameAndUid.empty()) {
         return;
@@ -450,23 +508,25 @@ void QuotaManager::GetOccupiedSpaceForUidList(AllAppVec &allVec, uint64_t &iNode
     int32_t curUid = 0;
     int32_t count = 0;
     std::map<int32_t, int64_t> userAppSizeMap;
+    std::unordered_map<int32_t, size_t> saIndex;
+    saIndex.reserve(allVec.sysSaVec.size());
+    for (size_t i = 0; i < allVec.sysSaVec.size(); i++) {
+        saIndex.emplace(allVec.sysSaVec[i].uid, i);
+    }
     while (count < MAX_UID_COUNT) {
         KernelNextDqBlk dq;
-        if (quotactl(QCMD(Q_GETNEXTQUOTA_LOCAL, USRQUOTA), DATA_DEV_PATH, curUid, reinterpret_cast<char*>(&dq)) != 0) {
+        if (nextQuota_(curUid, dq) != E_OK) {
             LOGE("[L2:QuotaManager] GetOccupiedSpaceForUidList: <<< EXIT FAILED <<< uid=%{public}d, errno=%{public}d",
                 curUid, errno);
             break;
         }
         int32_t dqUid = static_cast<int32_t>(dq.dqbId);
-        bool isSaUid = false;
         iNodes += dq.dqbCurInodes;
-        for (UidSaInfo &info : allVec.sysSaVec) {
-            if (info.uid == dqUid) {
-                isSaUid = true;
-                info.size = static_cast<int64_t>(dq.dqbCurSpace);
-                info.iNodes = dq.dqbCurInodes;
-                break;
-            }
+        auto sa = saIndex.find(dqUid);
+        bool isSaUid = sa != saIndex.end();
+        if (isSaUid) {
+            allVec.sysSaVec[sa->second].size = static_cast<int64_t>(dq.dqbCurSpace);
+            allVec.sysSaVec[sa->second].iNodes = dq.dqbCurInodes;
         }
         if (dqUid >= StorageService::APP_UID) {
             int32_t userId = dqUid / StorageService::USER_ID_BASE;
@@ -476,7 +476,7 @@ HWTEST_F(QuotaManagerTest, QuotaManagerTest_AssembleSaInfoVec_001, TestSize.Leve
     UidSaInfo info2 = {2002, "default", 2048};
     vec.emplace_back(info1);
     vec.emplace_back(info2);
-    std::map<int32_t, std::string> bundleMap;
+    BundleNameIndex bundleMap;
     bundleMap[1001] = "SystemApp";
     bundleMap[2002] = "UserApp";
     QuotaManager::GetInstance().AssembleSaInfoVec(vec, bundleMap);
@@ -486,7 +486,7 @@ HWTEST_F(QuotaManagerTest, QuotaManagerTest_AssembleSaInfoVec_001, TestSize.Leve
     std::vector<UidSaInfo> vec1;
     UidSaInfo info3 = {3003, "original", 4096};
     vec1.emplace_back(info3);
-    std::map<int32_t, std::string> bundleMap1;
+    BundleNameIndex bundleMap1;
     bundleMap1[4004] = "NonExistingApp"; // 不包含 UID 3003
     QuotaManager::GetInstance().AssembleSaInfoVec(vec1, bundleMap1);
     EXPECT_EQ(vec1[0].saName, "original"); // 未修改
@@ -494,7 +494,7 @@ HWTEST_F(QuotaManagerTest, QuotaManagerTest_AssembleSaInfoVec_001, TestSize.Leve
     std::vector<UidSaInfo> vec2;
     UidSaInfo info4 = {5005, "initial", 8192};
     vec2.emplace_back(info4);
-    std::map<int32_t, std::string> bundleMap2; // 空 map
+    BundleNameIndex bundleMap2; // 空 map
     QuotaManager::GetInstance().AssembleSaInfoVec(vec2, bundleMap2);
     EXPECT_EQ(vec2[0].saName, "initial"); // 未修改
 
@@ -514,7 +514,7 @@ HWTEST_F(QuotaManagerTest, QuotaManagerTest_ProcessVecList_001, TestSize.Level1)
     std::vector<UidSaInfo> userAppVec = {{2002, "userDefault", 2048}};
     std::vector<UidSaInfo> vec = {{3003, "vecDefault", 4096 * BYTES_PRE_MB}};
     std::vector<UidSaInfo> otherAppVec = {{4004, "vecDefault", 4096}};
-    std::map<int32_t, std::string> bundleMap = {{1001, "SystemApp"}, {2002, "UserApp"}, {3003, "VecApp"}};
+    BundleNameIndex bundleMap = {{1001, "SystemApp"}, {2002, "UserApp"}, {3003, "VecApp"}};
     AllAppVec allVec;
     allVec.otherAppVec = otherAppVec;
     allVec.sysAppVec = sysAppVec;
@@ -532,7 +532,7 @@ HWTEST_F(QuotaManagerTest, QuotaManagerTest_ProcessVecList_001, TestSize.Level1)
     std::vector<UidSaInfo> sysAppVec1 = {{1001, "original", 1024}};
     std::vector<UidSaInfo> userAppVec1 = {{2002, "original", 2048}};
     std::vector<UidSaInfo> vec1 = {{3003, "original", 4096 * BYTES_PRE_MB}};
-    std::map<int32_t, std::string> bundleMap1;
+    BundleNameIndex bundleMap1;
     allVec.sysAppVec = sysAppVec1;
     allVec.userAppVec = userAppVec1;
     allVec.sysSaVec = vec1;
@@ -560,14 +560,14 @@ HWTEST_F(QuotaManagerTest, QuotaManagerTest_ProcessVecList_002, TestSize.Level1)
         {1001, "saDefault", 1024 * BYTES_PRE_MB},
         {2002, "saDefault2", 2048 * BYTES_PRE_MB}
     };
-    std::map<int32_t, std::string> bundleMap = {{1001, "SA1"}, {2002, "SA2"}};
+    BundleNameIndex bundleMap = {{1001, "SA1"}, {2002, "SA2"}};
 
     QuotaManager::GetInstance().ProcessVecList(vec, true, bundleMap);
     EXPECT_FALSE(vec.empty());
     EXPECT_EQ(vec[0].saName, "saDefault2");
 
     std::vector<UidSaInfo> vec2 = {{3003, "appDefault", 4096}, {4004, "appDefault2", 8192}};
-    std::map<int32_t, std::string> bundleMap2 = {{3003, "App1"}, {4004, "App2"}};
+    BundleNameIndex bundleMap2 = {{3003, "App1"}, {4004, "App2"}};
 
     QuotaManager::GetInstance().ProcessVecList(vec2, false, bundleMap2);
     EXPECT_FALSE(vec2.empty());
@@ -753,7 +753,7 @@ HWTEST_F(QuotaManagerTest, QuotaManagerTest_ProcessVecList_003, TestSize.Level1)
     GTEST_LOG_(INFO) << "QuotaManagerTest_ProcessVecList_003 start";
 
     std::vector<UidSaInfo> emptyVec;
-    std::map<int32_t, std::string> bundleMap;
+    BundleNameIndex bundleMap;
 
     QuotaManager::GetInstance().ProcessVecList(emptyVec, true, bundleMap);
     EXPECT_TRUE(emptyVec.empty());
@@ -775,7 +775,7 @@ HWTEST_F(QuotaManagerTest, QuotaManagerTest_ProcessVecList_004, TestSize.Level1)
     GTEST_LOG_(INFO) << "QuotaManagerTest_ProcessVecList_004 start";
 
     std::vector<UidSaInfo> vec = {{1001, "single", 1024}};
-    std::map<int32_t, std::string> bundleMap = {{1001, "SingleApp"}};
+    BundleNameIndex bundleMap = {{1001, "SingleApp"}};
 
     QuotaManager::GetInstance().ProcessVecList(vec, false, bundleMap);
 
@@ -1702,5 +1702,141 @@ HWTEST_F(QuotaManagerTest, QuotaManagerTest_ScanDirectoryEntries_001, TestSize.L
     int32_t result = QuotaManager::GetInstance().ScanDirectoryEntries(path, blks, uids, largeFiles, dirSizeMap);
     EXPECT_TRUE(result == E_OK || result == E_STATISTIC_OPEN_DIR_FAILED);
 }
+
+namespace {
+const std::string FAKE_PASSWD = "/data/local/tmp/quota_manager_test_passwd";
+
+struct FakeQuotaEntry {
+    uint32_t id;
+    uint64_t space;
+};
+
+class FakeQuotaBackend {
+public:
+    explicit FakeQuotaBackend(std::vector<FakeQuotaEntry> entries) : entries_(std::move(entries)) {}
+
+    NextQuotaFunc Func()
+    {
+        return [this](int32_t fromId, KernelNextDqBlk &dq) {
+            if (fromId == 0) {
+                sweeps_++;
+            }
+            for (const auto &entry : entries_) {
+                if (entry.id >= static_cast<uint32_t>(fromId)) {
+                    dq = KernelNextDqBlk();
+                    dq.dqbId = entry.id;
+                    dq.dqbCurSpace = entry.space;
+                    dq.dqbCurInodes = 1;
+                    return E_OK;
+                }
+            }
+            return E_QUOTA_CTL_KERNEL_ERR;
+        };
+    }
+
+    int32_t sweeps_ = 0;
+
+private:
+    std::vector<FakeQuotaEntry> entries_;
+};
+
+void WritePasswd(const std::string &content)
+{
+    std::ofstream file(FAKE_PASSWD, std::ios::out | std::ios::trunc);
+    file << content;
+}
+} // namespace
+
+/**
+ * @tc.name: QuotaManagerTest_GetAllUidStorageStats_001
+ * @tc.desc: Verify one report parses the passwd file at most once and sweeps the quota entries once,
+ *           and fills all four classes and both totals.
+ * @tc.type: FUNC
+ */
+HWTEST_F(QuotaManagerTest, QuotaManagerTest_GetAllUidStorageStats_001, TestSize.Level1)
+{
+    GTEST_LOG_(INFO) << "QuotaManagerTest_GetAllUidStorageStats_001 start";
+    QuotaManager &manager = QuotaManager::GetInstance();
+    std::string oldPath = manager.passwdPath_;
+    NextQuotaFunc oldNextQuota = manager.nextQuota_;
+    PasswdCache oldCache = manager.passwdCache_;
+
+    WritePasswd("root:x:0:0:::\nfoundation:x:1234:1234:::\n");
+    FakeQuotaBackend backend({ { 0, 100 }, { 1234, 300 }, { 4321, 500 }, { 20010, 700 }, { 20010010, 900 } });
+    manager.passwdPath_ = FAKE_PASSWD;
+    manager.nextQuota_ = backend.Func();
+    manager.passwdCache_ = PasswdCache();
+
+    std::map<int32_t, std::string> bundleNameAndUid = { { 20010, "com.ohos.sysapp" }, { 20010010, "com.ohos.app" } };
+    AllAppVec allVec;
+    int64_t saTotal = 0;
+    int64_t otherTotal = 0;
+    EXPECT_EQ(manager.GetAllUidStorageStats(allVec, saTotal, otherTotal, bundleNameAndUid), E_OK);
+    EXPECT_EQ(backend.sweeps_, 1);
+    EXPECT_EQ(manager.passwdCache_.loads, 1U);
+    ASSERT_EQ(allVec.sysAppVec.size(), 1U);
+    EXPECT_EQ(allVec.sysAppVec[0].saName, "com.ohos.sysapp");
+    ASSERT_EQ(allVec.userAppVec.size(), 1U);
+    EXPECT_EQ(allVec.userAppVec[0].saName, "com.ohos.app");
+    ASSERT_EQ(allVec.otherAppVec.size(), 1U);
+    EXPECT_EQ(allVec.otherAppVec[0].uid, 4321);
+    EXPECT_EQ(otherTotal, 500);
+    // root, foundation, and the per-user sums of user 0 and user 100
+    EXPECT_EQ(allVec.sysSaVec.size(), 4U);
+    EXPECT_EQ(saTotal, 100 + 300 + 700 + 900);
+
+    EXPECT_EQ(manager.GetAllUidStorageStats(allVec, saTotal, otherTotal, bundleNameAndUid), E_OK);
+    EXPECT_EQ(backend.sweeps_, 2);
+    EXPECT_EQ(manager.passwdCache_.loads, 1U);
+
+    WritePasswd("root:x:0:0:::\nfoundation:x:1234:1234:::\nmedia:x:4321:4321:::\n");
+    EXPECT_EQ(manager.GetAllUidStorageStats(allVec, saTotal, otherTotal, bundleNameAndUid), E_OK);
+    EXPECT_EQ(manager.passwdCache_.loads, 2U);
+    EXPECT_TRUE(allVec.otherAppVec.empty());
+    EXPECT_EQ(otherTotal, 0);
+
+    manager.passwdPath_ = oldPath;
+    manager.nextQuota_ = oldNextQuota;
+    manager.passwdCache_ = oldCache;
+    (void)remove(FAKE_PASSWD.c_str());
+    GTEST_LOG_(INFO) << "QuotaManagerTest_GetAllUidStorageStats_001 end";
+}
+
+/**
+ * @tc.name: QuotaManagerTest_GetUidStorageStats_Type_001
+ * @tc.desc: Verify the per-class query returns the class of the single pass and rejects unknown types.
+ * @tc.type: FUNC
+ */
+HWTEST_F(QuotaManagerTest, QuotaManagerTest_GetUidStorageStats_Type_001, TestSize.Level1)
+{
+    GTEST_LOG_(INFO) << "QuotaManagerTest_GetUidStorageStats_Type_001 start";
+    QuotaManager &manager = QuotaManager::GetInstance();
+    std::string oldPath = manager.passwdPath_;
+    NextQuotaFunc oldNextQuota = manager.nextQuota_;
+    PasswdCache oldCache = manager.passwdCache_;
+
+    WritePasswd("root:x:0:0:::\n");
+    FakeQuotaBackend backend({ { 0, 100 }, { 4321, 500 } });
+    manager.passwdPath_ = FAKE_PASSWD;
+    manager.nextQuota_ = backend.Func();
+    manager.passwdCache_ = PasswdCache();
+
+    std::vector<UidSaInfo> vec;
+    int64_t totalSize = 0;
+    manager.GetUidStorageStats(vec, totalSize, {}, OTHER_APP);
+    ASSERT_EQ(vec.size(), 1U);
+    EXPECT_EQ(totalSize, 500);
+    vec.clear();
+    totalSize = 0;
+    manager.GetUidStorageStats(vec, totalSize, {}, OTHER_APP + 1);
+    EXPECT_TRUE(vec.empty());
+    EXPECT_EQ(backend.sweeps_, 1);
+
+    manager.passwdPath_ = oldPath;
+    manager.nextQuota_ = oldNextQuota;
+    manager.passwdCache_ = oldCache;
+    (void)remove(FAKE_PASSWD.c_str());
+    GTEST_LOG_(INFO) << "QuotaManagerTest_GetUidStorageStats_Type_001 end";
+}
 } // STORAGE_DAEMON
 } // OHOS
\ No newline at end of file
@@ -27,6 +27,8 @@
 #include "storage_service_log.h"
 #include "user/mount_constant.h"
 #include "utils/mount_argument_utils.h"
+#include "utils/mount_table.h"
+#include "utils/proc_resource_scanner.h"
 #include "utils/string_utils.h"
 #include "user/user_path_resolver.h"
 #include "user/system_mount_manager.h"
@@ -37,10 +39,40 @@ using namespace std;
 #define HMDFS_IOC 0xf2
 #define HMDFS_IOC_FORBID_OPEN _IO(HMDFS_IOC, 12)
 using namespace OHOS::StorageService;
-constexpr int32_t PATH_MAX_FOR_LINK = 4096;
 constexpr int32_t DEFAULT_USERID = 100;
 constexpr int32_t ERROR_FILE_NOT_FOUND = 22;
 const std::string CONSTRAINT = "constraint.distributed.transmission.outgoing";
+// Visit fd/cwd/exe/root targets under path. A target carrying the "(unreachable)" marker is
+// reported stripped, with a trailing separator when appendSep is set.
+static void ForEachLinkUnder(const ProcResourceSnapshot &snapshot, const std::string &path, bool appendSep,
+    const std::function<bool(const std::string &)> &visitor)
+{
+    constexpr uint32_t kinds = PROC_RES_FD | PROC_RES_LINKS;
+    bool stopped = false;
+    snapshot.ForEachWithPrefix(path, kinds, [&visitor, &stopped](const ProcResource &res) {
+        stopped = !visitor(res.path);
+        return !stopped;
+    });
+    if (stopped) {
+        return;
+    }
+    std::string unreachable = std::string(UN_REACHABLE) + path;
+    if (appendSep && !path.empty() && path.back() == FILE_SEPARATOR_CHAR) {
+        unreachable.pop_back();
+    }
+    const size_t markLen = strlen(UN_REACHABLE);
+    snapshot.ForEachWithPrefix(unreachable, kinds, [&](const ProcResource &res) {
+        std::string realPath = res.path.substr(markLen);
+        if (appendSep) {
+            realPath += FILE_SEPARATOR_CHAR;
+        }
+        if (realPath.compare(0, path.size(), path) != 0) {
+            return true;
+        }
+        return visitor(realPath);
+    });
+}
+
 MountManager &MountManager::GetInstance()
 {
     static MountManager instance_;
@@ -51,35 +83,26 @@ int32_t MountManager::FindProcess(std::list<std::string> &unMountFailList, std::
     std::list<std::string> &excludeProcess)
 {
     LOGI("[L2:MountManager] FindProcess: >>> ENTER <<< unMountFailList.size()=%{public}zu", unMountFailList.size());
-    auto procDir = std::unique_ptr<DIR, int (*)(DIR*)>(opendir("/proc"), closedir);
-    if (!procDir) {
-        LOGE("[L2:MountManager] FindProcess: <<< EXIT FAILED <<< failed to open dir proc, err=%{public}d", errno);
+    auto snapshot = ProcResourceScanner::GetInstance().GetSnapshot(PROC_RES_ALL);
+    if (snapshot == nullptr) {
+        LOGE("[L2:MountManager] FindProcess: <<< EXIT FAILED <<< failed to scan proc");
         return E_UMOUNT_PROC_OPEN;
     }
-    struct dirent *entry;
-    while ((entry = readdir(procDir.get())) != nullptr) {
-        if (entry->d_type != DT_DIR) {
-            continue;
-        }
-        std::string name = entry->d_name;
-        if (!StringIsNumber(name)) {
-            continue;
-        }
-        ProcessInfo info;
-        std::string filename = "/proc/" + name + "/stat";
-        if (!GetProcessInfo(filename, info)) {
-            LOGE("[L2:MountManager] FindProcess: failed to get process info, pid is %{public}s.", name.c_str());
-            continue;
-        }
+    std::set<int32_t> pids;
+    for (const auto &item : unMountFailList) {
+        snapshot->ForEachWithPrefix(item, PROC_RES_ALL, [&pids](const ProcResource &res) {
+            pids.insert(res.pid);
+            return true;
+        });
+    }
+    for (int32_t pid : pids) {
+        ProcessInfo info = { pid, snapshot->GetProcessName(pid) };
         if (IsStringExist(excludeProcess, info.name)) {
             continue;
         }
-        std::string pidPath = "/proc/" + name;
-        LOGD("[L2:MountManager] FindProcess: check pid using start, pid is %{public}d, processName is %{public}s.",
+        LOGD("[L2:MountManager] FindProcess: pid is using, pid is %{public}d, processName is %{public}s.",
             info.pid, info.name.c_str());
-        if (PidUsingFlag(pidPath, unMountFailList)) {
-            proInfos.push_back(info);
-        }
+        proInfos.push_back(info);
     }
     std::string info = ProcessToString(proInfos);
     int count = static_cast<int>(proInfos.size());
@@ -88,38 +111,6 @@ int32_t MountManager::FindProcess(std::list<std::string> &unMountFailList, std::
     return E_OK;
 }
 
-bool MountManager::PidUsingFlag(std::string &pidPath, std::list<std::string> &mountFailList)
-{
-    std::string fdPath = pidPath + "/fd";
-    auto fdDir = std::unique_ptr<DIR, int (*)(DIR*)>(opendir(fdPath.c_str()), closedir);
-    if (!fdDir) {
-        LOGE("unable to open %{public}s, err %{public}d", fdPath.c_str(), errno);
-    } else {
-        struct dirent* fdDirent;
-        while ((fdDirent = readdir(fdDir.get())) != nullptr) {
-            if (fdDirent->d_type != DT_LNK) {
-                continue;
-            }
-            if (CheckSymlink(fdPath + "/" +fdDirent->d_name, mountFailList)) {
-                return true;
-            }
-        }
-    }
-    if (CheckMaps(pidPath + "/maps", mountFailList)) {
-        return true;
-    }
-    if (CheckSymlink(pidPath + "/cwd", mountFailList)) {
-        return true;
-    }
-    if (CheckSymlink(pidPath + "/root", mountFailList)) {
-        return true;
-    }
-    if (CheckSymlink(pidPath + "/exe", mountFailList)) {
-        return true;
-    }
-    return false;
-}
-
 bool MountManager::GetProcessInfo(const std::string &filename, ProcessInfo &info)
 {
     LOGI("[L2:MountManager] GetProcessInfo: >>> ENTER <<< filename=%{public}s", filename.c_str());
@@ -156,58 +147,6 @@ bool MountManager::GetProcessInfo(const std::string &filename, ProcessInfo &info
     return true;
 }
 
-bool MountManager::CheckMaps(const std::string &path, std::list<std::string> &mountFailList)
-{
-    if (path.empty()) {
-        return false;
-    }
-    std::ifstream inputStream(path.c_str(), std::ios::in);
-    if (!inputStream.is_open()) {
-        LOGE("unable to open %{public}s, err %{public}d", path.c_str(), errno);
-        return false;
-    }
-    std::string tmpLine;
-    while (std::getline(inputStream, tmpLine)) {
-        std::string::size_type pos = tmpLine.find('/');
-        if (pos == std::string::npos) {
-            continue;
-        }
-        tmpLine = tmpLine.substr(pos);
-        for (const auto &item: mountFailList) {
-            if (tmpLine.find(item) == 0) {
-                LOGE("find a fd from maps, %{public}s", tmpLine.c_str());
-                inputStream.close();
-                return true;
-            }
-        }
-    }
-    inputStream.close();
-    return false;
-}
-
-bool MountManager::CheckSymlink(const std::string &path, std::list<std::string> &mountFailList)
-{
-    if (path.empty()) {
-        return false;
-    }
-    char realPath[PATH_MAX_FOR_LINK];
-    int res = readlink(path.c_str(), realPath, sizeof(realPath) - 1);
-    if (res < 0) {
-        LOGE("readlink failed for path, errno is %{public}d.", errno);
-        return false;
-    }
-    realPath[res] = '\0';
-    std::string realPathStr(realPath);
-    for (const auto &item: mountFailList) {
-        if (realPathStr.find(item) == 0) {
-            LOGE("find a fd from link, %{public}s", realPathStr.c_str());
-            return true;
-        }
-    }
-    return false;
-}
-
-
 bool MountManager::CheckPathValid(const std::string &bundleNameStr, uint32_t userId)
 {
     LOGI("[L2:MountManager] CheckPathValid: >>> ENTER <<< bundleName=%{public}s, userId=%{public}u",
@@ -251,77 +190,89 @@ void MountManager::MountSandboxPath(uint32_t userId, const std::vector<MountNode
         userId, bundleName.c_str());
 }
 
-void MountManager::MountPointToList(std::list<std::string> &hmdfsList, std::list<std::string> &hmfsList,
-    std::list<std::string> &sharefsList, std::string &line, int32_t userId)
+struct UserMountPrefixes {
+    explicit UserMountPrefixes(int32_t userId)
+    {
+        Utils::MountArgument hmdfsMntArgs(Utils::MountArgumentDescriptors::Alpha(userId, ""));
+        hmdfs = hmdfsMntArgs.GetMountPointPrefix();
+        hmfs = hmdfsMntArgs.GetSandboxPath();
+        mntUser = hmdfsMntArgs.GetMntUserPath();
+        sharefs = hmdfsMntArgs.GetShareSrc();
+        cloud = hmdfsMntArgs.GetFullCloud();
+    }
+    std::string hmdfs;
+    std::string hmfs;
+    std::string mntUser;
+    std::string sharefs;
+    std::string cloud;
+};
+
+static bool StartsWith(std::string_view str, const std::string &prefix)
 {
-    if (line.empty()) {
-        return;
-    }
-    Utils::MountArgument hmdfsMntArgs(Utils::MountArgumentDescriptors::Alpha(userId, ""));
-    const string &hmdfsPrefix = hmdfsMntArgs.GetMountPointPrefix();
-    const string &hmfsPrefix = hmdfsMntArgs.GetSandboxPath();
-    const string &mntUserPrefix = hmdfsMntArgs.GetMntUserPath();
-    const string &sharefsPrefix = hmdfsMntArgs.GetShareSrc();
-    const string &cloudPrefix = hmdfsMntArgs.GetFullCloud();
-    std::stringstream ss(line);
-    std::string src;
-    ss >> src;
-    std::string dst;
-    ss >> dst;
-    std::string type;
-    ss >> type;
-    if (type == MOUNT_POINT_TYPE_HMDFS) {
-        if (src.length() >= hmdfsPrefix.length() && src.substr(0, hmdfsPrefix.length()) == hmdfsPrefix) {
-            hmdfsList.push_front(dst);
+    return str.compare(0, prefix.size(), prefix) == 0;
+}
+
+static void ClassifyMountPoint(const MountEntry &entry, const UserMountPrefixes &prefixes,
+    std::list<std::string> &hmdfsList, std::list<std::string> &hmfsList, std::list<std::string> &sharefsList)
+{
+    if (entry.fsType == MOUNT_POINT_TYPE_HMDFS) {
+        if (StartsWith(entry.source, prefixes.hmdfs)) {
+            hmdfsList.emplace_front(entry.target);
         }
-        if (src.length() >= cloudPrefix.length() && src.substr(0, cloudPrefix.length()) == cloudPrefix) {
-            hmdfsList.push_front(dst);
+        if (StartsWith(entry.source, prefixes.cloud)) {
+            hmdfsList.emplace_front(entry.target);
         }
         return;
     }
-    if (type == MOUNT_POINT_TYPE_HMFS || type == MOUNT_POINT_TYPE_F2FS) {
-        if (dst.length() >= hmfsPrefix.length() && dst.substr(0, hmfsPrefix.length()) == hmfsPrefix) {
-            hmfsList.push_front(dst);
+    if (entry.fsType == MOUNT_POINT_TYPE_HMFS || entry.fsType == MOUNT_POINT_TYPE_F2FS) {
+        if (StartsWith(entry.target, prefixes.hmfs)) {
+            hmfsList.emplace_front(entry.target);
         }
-        if (dst.length() >= mntUserPrefix.length() && dst.substr(0, mntUserPrefix.length()) == mntUserPrefix) {
-            hmfsList.push_front(dst);
+        if (StartsWith(entry.target, prefixes.mntUser)) {
+            hmfsList.emplace_front(entry.target);
         }
         return;
     }
-    if (type == MOUNT_POINT_TYPE_SHAREFS) {
-        if (src.length() >= sharefsPrefix.length() && src.substr(0, sharefsPrefix.length()) == sharefsPrefix) {
-            sharefsList.push_front(dst);
+    if (entry.fsType == MOUNT_POINT_TYPE_SHAREFS) {
+        if (StartsWith(entry.source, prefixes.sharefs)) {
+            sharefsList.emplace_front(entry.target);
         }
-        if (src.length() >= mntUserPrefix.length() && src.substr(0, mntUserPrefix.length()) == mntUserPrefix) {
-            sharefsList.push_front(dst);
+        if (StartsWith(entry.source, prefixes.mntUser)) {
+            sharefsList.emplace_front(entry.target);
         }
         return;
     }
 }
 
+void MountManager::MountPointToList(std::list<std::string> &hmdfsList, std::list<std::string> &hmfsList,
+    std::list<std::string> &sharefsList, std::string &line, int32_t userId)
+{
+    MountEntry entry;
+    if (line.empty() || !MountTable::ParseMountsLine(line, entry)) {
+        return;
+    }
+    ClassifyMountPoint(entry, UserMountPrefixes(userId), hmdfsList, hmfsList, sharefsList);
+}
+
 int32_t MountManager::FindMountPointsToMap(std::map<std::string, std::list<std::string>> &mountMap, int32_t userId)
 {
     LOGI("[L2:MountManager] FindMountPointsToMap: >>> ENTER <<< userId=%{public}d", userId);
-    std::ifstream inputStream(MOUNT_POINT_INFO, std::ios::in);
-    if (!inputStream.is_open()) {
-        LOGE("[L2:MountManager] FindMountPointsToMap: <<< EXIT FAILED <<< unable to open /proc/mounts,"
-            "errno=%{public}d", errno);
+    auto mountTable = MountTable::GetInstance().GetSnapshot();
+    if (mountTable == nullptr) {
+        LOGE("[L2:MountManager] FindMountPointsToMap: <<< EXIT FAILED <<< unable to read mount table");
         return E_UMOUNT_PROC_MOUNTS_OPEN;
     }
     std::list<std::string> hmdfsList;
     std::list<std::string> hmfsList;
     std::list<std::string> sharefsList;
-    std::string tmpLine;
-    while (std::getline(inputStream, tmpLine)) {
-        MountPointToList(hmdfsList, hmfsList, sharefsList, tmpLine, userId);
-    }
-    inputStream.close();
-    mountMap[MOUNT_POINT_TYPE_HMDFS] = hmdfsList;
-    mountMap[MOUNT_POINT_TYPE_HMFS] = hmfsList;
-    mountMap[MOUNT_POINT_TYPE_SHAREFS] = sharefsList;
-    hmdfsList.clear();
-    hmfsList.clear();
-    sharefsList.clear();
+    UserMountPrefixes prefixes(userId);
+    mountTable->ForEachOfTypes({ MOUNT_POINT_TYPE_HMDFS, MOUNT_POINT_TYPE_HMFS, MOUNT_POINT_TYPE_F2FS,
+        MOUNT_POINT_TYPE_SHAREFS }, [&](const MountEntry &entry) {
+        ClassifyMountPoint(entry, prefixes, hmdfsList, hmfsList, sharefsList);
+    });
+    mountMap[MOUNT_POINT_TYPE_HMDFS] = std::move(hmdfsList);
+    mountMap[MOUNT_POINT_TYPE_HMFS] = std::move(hmfsList);
+    mountMap[MOUNT_POINT_TYPE_SHAREFS] = std::move(sharefsList);
     LOGI("[L2:MountManager] FindMountPointsToMap: <<< EXIT SUCCESS <<< userId=%{public}d", userId);
     return E_OK;
 }
@@ -808,6 +759,7 @@ int32_t MountManager::FindAndKillProcess(int32_t userId, std::list<std::string>
 
     std::vector<ProcessInfo> killFailList;
     KillProcess(processInfos, killFailList);
+    ProcResourceScanner::GetInstance().Invalidate();
     if (!killFailList.empty()) {
         std::string info = ProcessToString(killFailList);
         LOGE("[L2:MountManager] FindAndKillProcess: <<< EXIT FAILED <<< kill process failed");
@@ -1256,23 +1208,22 @@ int32_t MountManager::IsFileOccupied(const std::string &path, const std::vector<
 int32_t MountManager::OpenProcForMulti(const std::string &path, std::set<std::string> &occupyFiles)
 {
     LOGI("[L2:MountManager] OpenProcForMulti: >>> ENTER <<< path=%{public}s", path.c_str());
-    auto procDir = std::unique_ptr<DIR, int (*)(DIR*)>(opendir(PID_PROC), closedir);
-    if (!procDir) {
-        LOGE("[L2:MountManager] OpenProcForMulti: <<< EXIT FAILED <<< failed to open dir proc, err=%{public}d", errno);
+    auto snapshot = ProcResourceScanner::GetInstance().GetSnapshot(PROC_RES_FD | PROC_RES_LINKS);
+    if (snapshot == nullptr) {
+        LOGE("[L2:MountManager] OpenProcForMulti: <<< EXIT FAILED <<< failed to scan proc");
         return E_UMOUNT_PROC_OPEN;
     }
-    struct dirent *entry;
-    while ((entry = readdir(procDir.get())) != nullptr) {
-        if (entry->d_type != DT_DIR) {
-            continue;
+    ForEachLinkUnder(*snapshot, path, true, [&path, &occupyFiles](const std::string &realPath) {
+        std::string remain = realPath.substr(path.size());
+        if (remain.empty()) {
+            return true;
         }
-        std::string name = entry->d_name;
-        if (!StringIsNumber(name)) {
-            continue;
+        if (path != FILE_MGR_ROOT_PATH) {
+            remain = remain.substr(0, remain.find(FILE_SEPARATOR_CHAR));
         }
-        std::string pidPath = std::string(PID_PROC) + FILE_SEPARATOR_CHAR + name;
-        FindProcForMulti(pidPath, path, occupyFiles);
-    }
+        occupyFiles.insert(remain);
+        return true;
+    });
     LOGI("[L2:MountManager] OpenProcForMulti: <<< EXIT SUCCESS <<< occupyFiles.size()=%{public}zu", occupyFiles.size());
     return E_OK;
 }
@@ -1280,110 +1231,23 @@ int32_t MountManager::OpenProcForMulti(const std::string &path, std::set<std::st
 int32_t MountManager::OpenProcForPath(const std::string &path, bool &isOccupy, bool isDir)
 {
     LOGI("[L2:MountManager] OpenProcForPath: >>> ENTER <<< path=%{public}s, isDir=%{public}d", path.c_str(), isDir);
-    auto procDir = std::unique_ptr<DIR, int (*)(DIR*)>(opendir(PID_PROC), closedir);
-    if (!procDir) {
-        LOGE("[L2:MountManager] OpenProcForPath: <<< EXIT FAILED <<< failed to open dir proc, err=%{public}d", errno);
+    auto snapshot = ProcResourceScanner::GetInstance().GetSnapshot(PROC_RES_FD | PROC_RES_LINKS);
+    if (snapshot == nullptr) {
+        LOGE("[L2:MountManager] OpenProcForPath: <<< EXIT FAILED <<< failed to scan proc");
         return E_UMOUNT_PROC_OPEN;
     }
-    struct dirent *entry;
-    while ((entry = readdir(procDir.get())) != nullptr) {
-        if (entry->d_type != DT_DIR) {
-            continue;
-        }
-        std::string name = entry->d_name;
-        if (!StringIsNumber(name)) {
-            continue;
-        }
-        std::string pidPath = std::string(PID_PROC) + FILE_SEPARATOR_CHAR + name;
-        if (FindProcForPath(pidPath, path, isDir)) {
+    ForEachLinkUnder(*snapshot, path, isDir, [&path, &isOccupy, isDir](const std::string &realPath) {
+        if (isDir || realPath == path) {
+            LOGE("find a fd from link, %{public}s", realPath.c_str());
             isOccupy = true;
-            break;
+            return false;
         }
-    }
+        return true;
+    });
     LOGI("[L2:MountManager] OpenProcForPath: <<< EXIT SUCCESS <<< isOccupy=%{public}d", isOccupy);
     return E_OK;
 }
 
-bool MountManager::FindProcForPath(const std::string &pidPath, const std::string &path, bool isDir)
-{
-    if (CheckSymlinkForPath(pidPath + FILE_SEPARATOR_CHAR + PID_CWD, path, isDir)) {
-        return true;
-    }
-    if (CheckSymlinkForPath(pidPath + FILE_SEPARATOR_CHAR + PID_EXE, path, isDir)) {
-        return true;
-    }
-    if (CheckSymlinkForPath(pidPath + FILE_SEPARATOR_CHAR + PID_ROOT, path, isDir)) {
-        return true;
-    }
-    std::string fdPath = pidPath + FILE_SEPARATOR_CHAR + PID_FD;
-    auto fdDir = std::unique_ptr<DIR, int (*)(DIR*)>(opendir(fdPath.c_str()), closedir);
-    if (!fdDir) {
-        LOGE("unable to open %{public}s, err %{public}d", fdPath.c_str(), errno);
-        return false;
-    }
-    struct dirent* fdDirent;
-    while ((fdDirent = readdir(fdDir.get())) != nullptr) {
-        if (fdDirent->d_type != DT_LNK) {
-            continue;
-        }
-        if (CheckSymlinkForPath(fdPath + FILE_SEPARATOR_CHAR + fdDirent->d_name, path, isDir)) {
-            return true;
-        }
-    }
-    return false;
-}
-
-bool MountManager::CheckSymlinkForPath(const std::string &fdPath, const std::string &path, bool isDir)
-{
-    char realPath[PATH_MAX_FOR_LINK];
-    int res = readlink(fdPath.c_str(), realPath, sizeof(realPath) - 1);
-    if (res < 0) {
-        LOGE("readlink failed for path, errno is %{public}d.", errno);
-        return false;
-    }
-    realPath[res] = '\0';
-    std::string realPathStr(realPath);
-    if (isDir) {
-        if (realPathStr.find(UN_REACHABLE) == 0) {
-            realPathStr = realPathStr.substr(strlen(UN_REACHABLE)) + FILE_SEPARATOR_CHAR;
-        }
-        if (realPathStr.find(path) == 0) {
-            LOGE("find a fd from link for dir, %{public}s", realPathStr.c_str());
-            return true;
-        }
-    } else {
-        if (realPathStr.find(UN_REACHABLE) == 0) {
-            realPathStr = realPathStr.substr(strlen(UN_REACHABLE));
-        }
-        if (realPathStr == path) {
-            LOGE("find a fd from link for file, %{public}s", realPathStr.c_str());
-            return true;
-        }
-    }
-    return false;
-}
-
-void MountManager::FindProcForMulti(const std::string &pidPath, const std::string &path,
-    std::set<std::string> &occupyFiles)
-{
-    CheckSymlinkForMulti(pidPath + FILE_SEPARATOR_CHAR + PID_CWD, path, occupyFiles);
-    CheckSymlinkForMulti(pidPath + FILE_SEPARATOR_CHAR + PID_EXE, path, occupyFiles);
-    CheckSymlinkForMulti(pidPath + FILE_SEPARATOR_CHAR + PID_ROOT, path, occupyFiles);
-    std::string fdPath = pidPath + FILE_SEPARATOR_CHAR + PID_FD;
-    auto fdDir = std::unique_ptr<DIR, int (*)(DIR*)>(opendir(fdPath.c_str()), closedir);
-    if (!fdDir) {
-        LOGE("unable to open %{public}s, err %{public}d", fdPath.c_str(), errno);
-        return;
-    }
-    struct dirent* fdDirent;
-    while ((fdDirent = readdir(fdDir.get())) != nullptr) {
-        if (fdDirent->d_type != DT_LNK) {
-            continue;
-        }
-        CheckSymlinkForMulti(fdPath + FILE_SEPARATOR_CHAR + fdDirent->d_name, path, occupyFiles);
-    }
-}
-
 int32_t MountManager::InitSecondMountBundleName(uint32_t userId)
 {
     LOGI("[L2:MountManager] InitSecondMountBundleName: >>> ENTER <<< userId=%{public}u", userId);
@@ -25,7 +25,9 @@
 #include "parameter.h"
 #include "user/mount_constant.h"
 #include "utils/mount_argument_utils.h"
+#include "utils/mount_table.h"
 #include "utils/storage_radar.h"
+#include "utils/string_view_utils.h"
 #include "utils/hi_audit.h"
 #include "storage_service_constant.h"
 #include "storage_service_errno.h"
@@ -36,50 +38,10 @@ namespace OHOS {
 namespace StorageDaemon {
 using namespace std;
 using namespace OHOS::StorageService;
-const string PROC_MOUNTS = "/proc/mounts";
 const string REMOTE_SHARE_PATH_DIR = "/.remote_share";
 static constexpr int SHARE_FILE_0771 = 0771;
-constexpr int32_t PATH_MAX_FOR_LINK = 4096;
 constexpr uint32_t MAX_PROC_MOUNTS_LOOP_COUNT = 50000;
 
-void MountManager::CheckSymlinkForMulti(const std::string &fdPath, const std::string &path,
-    std::set<std::string> &occupyFiles)
-{
-    LOGI("[L2:MountManager] CheckSymlinkForMulti: >>> ENTER <<< fdPath=%{public}s, path=%{public}s",
-        fdPath.c_str(), path.c_str());
-    char realPath[PATH_MAX_FOR_LINK];
-    int res = readlink(fdPath.c_str(), realPath, sizeof(realPath) - 1);
-    if (res < 0) {
-        LOGE("[L2:MountManager] CheckSymlinkForMulti: <<< EXIT FAILED <<< readlink failed, errno=%{public}d", errno);
-        return;
-    }
-    realPath[res] = '\0';
-    std::string realPathStr(realPath);
-    if (realPathStr.find(UN_REACHABLE) == 0) {
-        realPathStr = realPathStr.substr(strlen(UN_REACHABLE)) + FILE_SEPARATOR_CHAR;
-    }
-    if (realPathStr.find(path) == 0) {
-        LOGE("[L2:MountManager] CheckSymlinkForMulti: find a fd from link, %{public}s", realPathStr.c_str());
-        realPathStr = realPathStr.substr(path.size());
-        if (realPathStr.empty()) {
-            LOGI("[L2:MountManager] CheckSymlinkForMulti: <<< EXIT SUCCESS <<< realPathStr is empty");
-            return;
-        }
-        if (path == FILE_MGR_ROOT_PATH) {
-            occupyFiles.insert(realPathStr);
-            LOGI("[L2:MountManager] CheckSymlinkForMulti: <<< EXIT SUCCESS <<< inserted to occupyFiles");
-            return;
-        }
-        std::string::size_type point = realPathStr.find(FILE_SEPARATOR_CHAR);
-        if (point != std::string::npos) {
-            realPathStr = realPathStr.substr(0, point);
-        }
-        occupyFiles.insert(realPathStr);
-    }
-    LOGI("[L2:MountManager] CheckSymlinkForMulti: <<< EXIT SUCCESS <<< occupyFiles.size()=%{public}zu",
-         occupyFiles.size());
-}
-
 int32_t MountManager::MountDisShareFile(int32_t userId, const std::map<std::string, std::string> &shareFiles)
 {
     LOGI("[L2:MountManager] MountDisShareFile: >>> ENTER <<< userId=%{public}d, shareFiles.size()=%{public}zu",
@@ -192,28 +154,17 @@ int32_t MountManager::UMountDisShareFile(const std::vector<std::string> &distrib
 int32_t MountManager::FindMountsByNetworkId(const std::string &networkId, std::list<std::string> &mounts)
 {
     LOGI("[L2:MountManager] FindMountsByNetworkId: >>> ENTER <<< networkId=%{private}s", networkId.c_str());
-    std::ifstream inputStream(PROC_MOUNTS.c_str(), std::ios::in);
-    if (!inputStream.is_open()) {
-        LOGE("[L2:MountManager] FindMountsByNetworkId: <<< EXIT FAILED <<< unable to open /proc/mounts,"
-            "errno=%{public}d", errno);
+    auto mountTable = MountTable::GetInstance().GetSnapshot();
+    if (mountTable == nullptr) {
+        LOGE("[L2:MountManager] FindMountsByNetworkId: <<< EXIT FAILED <<< unable to read mount table");
         return E_UMOUNT_PROC_MOUNTS_OPEN;
     }
-    std::string tmpLine;
     uint32_t loopCount = 0;
     HiAudit::GetInstance().WriteStart("MountManager::FindMountsByNetworkId while");
-    while (std::getline(inputStream, tmpLine)) {
+    for (const auto &entry : mountTable->GetEntries()) {
         CheckAndReportOverLoop("MountManager::FindMountsByNetworkId", loopCount, MAX_PROC_MOUNTS_LOOP_COUNT);
-        if (tmpLine.empty()) {
-            continue;
-        }
-        std::stringstream ss(tmpLine);
-        std::string dst;
-        ss >> dst >> dst;
-        if (dst.empty()) {
-            continue;
-        }
-        if (dst.find(networkId) != std::string::npos) {
-            mounts.push_front(dst);
+        if (entry.target.find(networkId) != std::string_view::npos) {
+            mounts.emplace_front(entry.target);
         }
     }
     HiAudit::GetInstance().WriteEnd("MountManager::FindMountsByNetworkId", E_OK);
@@ -225,28 +176,17 @@ int32_t MountManager::FilterNotMountedPath(std::map<std::string, std::string> &n
 {
     LOGI("[L2:MountManager] FilterNotMountedPath: >>> ENTER <<< notMountPaths.size()=%{public}zu",
         notMountPaths.size());
-    std::ifstream inputStream(PROC_MOUNTS.c_str(), std::ios::in);
-    if (!inputStream.is_open()) {
-        LOGE("[L2:MountManager] FilterNotMountedPath: <<< EXIT FAILED <<< unable to open /proc/mounts,"
-            "errno=%{public}d", errno);
+    auto mountTable = MountTable::GetInstance().GetSnapshot();
+    if (mountTable == nullptr) {
+        LOGE("[L2:MountManager] FilterNotMountedPath: <<< EXIT FAILED <<< unable to read mount table");
         return E_UMOUNT_PROC_MOUNTS_OPEN;
     }
-    std::string tmpLine;
-    uint32_t loopCount = 0;
     HiAudit::GetInstance().WriteStart("MountManager::FilterNotMountedPath while");
-    while (std::getline(inputStream, tmpLine)) {
-        CheckAndReportOverLoop("MountManager::FilterNotMountedPath", loopCount, MAX_PROC_MOUNTS_LOOP_COUNT);
-        if (tmpLine.empty()) {
-            continue;
-        }
-        std::stringstream ss(tmpLine);
-        std::string dst;
-        ss >> dst >> dst;
-        if (dst.empty()) {
-            continue;
-        }
-        if (notMountPaths.find(dst) != notMountPaths.end()) {
-            notMountPaths.erase(dst);
+    for (auto it = notMountPaths.begin(); it != notMountPaths.end();) {
+        if (mountTable->HasTarget(it->first)) {
+            it = notMountPaths.erase(it);
+        } else {
+            ++it;
         }
     }
     HiAudit::GetInstance().WriteEnd("MountManager::FilterNotMountedPath", E_OK);
@@ -282,8 +222,7 @@ bool MountManager::RemoveDisSharePath(const std::string &dstPath, const std::str
         return false;
     }
     std::string separator = "/";
-    std::string dstPathTmp = dstPath;
-    std::vector<std::string> parts = SplitLine(dstPathTmp, separator);
+    std::vector<std::string_view> parts = SplitView(dstPath, separator);
     auto count = static_cast<int32_t>(parts.size());
     for (int32_t i = count - 1; i >= 0; --i) {
         if (parts[i].empty()) {
@@ -294,7 +233,7 @@ bool MountManager::RemoveDisSharePath(const std::string &dstPath, const std::str
             if (parts[j].empty()) {
                 continue;
             }
-            currentPath += separator + parts[j];
+            currentPath.append(separator).append(parts[j]);
         }
         std::error_code errCode;
         if (!std::filesystem::exists(currentPath, errCode)) {
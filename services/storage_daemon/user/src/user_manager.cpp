@@ -15,8 +15,19 @@
 
 #include "user/user_manager.h"
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <dirent.h>
 #include <fcntl.h>
+#include <file_ex.h>
+#include <functional>
+#include <map>
 #include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
 
 #ifdef USER_CRYPTO_MANAGER
 #include "crypto/key_manager.h"
@@ -29,8 +40,11 @@
 #include "utils/storage_radar.h"
 #include "utils/string_utils.h"
 #include "ipc/storage_manager_client.h"
+#include "parameters.h"
 
 #include "user/user_path_resolver.h"
+#include "utils/file_utils.h"
+#include "utils/relabel_engine.h"
 #include "quota/quota_manager.h"
 #ifdef USE_LIBRESTORECON
 #include "policycoreutils.h"
@@ -40,6 +54,109 @@ using namespace std;
 using namespace OHOS::StorageService;
 namespace OHOS {
 namespace StorageDaemon {
+namespace {
+constexpr size_t DIR_GRAPH_MAX_WORKERS = 4;
+constexpr const char *USER_DIRS_STAMP_DIR = "/data/service/el1/public/storage_daemon/user_dirs";
+constexpr const char *SOFTWARE_VERSION_PARAM = "const.product.software.version";
+constexpr uint64_t FNV_OFFSET_BASIS = 14695981039346656037ULL;
+constexpr uint64_t FNV_PRIME = 1099511628211ULL;
+
+void HashBytes(uint64_t &hash, const std::string &value)
+{
+    for (unsigned char c : value) {
+        hash = (hash ^ c) * FNV_PRIME;
+    }
+    hash = (hash ^ '\0') * FNV_PRIME;
+}
+
+/*
+ * Orders a dir list by path: each dir depends on its nearest ancestor (or an earlier entry with the
+ * same path) in the list, so a parent is fully prepared, fscrypt policy included, before any of its
+ * children is created. Independent subtrees run on up to DIR_GRAPH_MAX_WORKERS threads.
+ */
+class DirGraph final {
+public:
+    explicit DirGraph(const std::vector<DirInfo> &dirs) : dirs_(dirs), children_(dirs.size())
+    {
+        std::unordered_map<std::string, size_t> lastSeen;
+        std::vector<bool> hasParent(dirs.size(), false);
+        for (size_t i = 0; i < dirs.size(); i++) {
+            auto it = lastSeen.find(dirs[i].path);
+            if (it != lastSeen.end()) {
+                children_[it->second].push_back(i);
+                hasParent[i] = true;
+            }
+            lastSeen[dirs[i].path] = i;
+        }
+        for (size_t i = 0; i < dirs.size(); i++) {
+            if (hasParent[i]) {
+                continue;
+            }
+            std::string parent = dirs[i].path;
+            for (auto pos = parent.rfind('/'); pos != std::string::npos && pos > 0; pos = parent.rfind('/')) {
+                parent.resize(pos);
+                auto it = lastSeen.find(parent);
+                if (it != lastSeen.end()) {
+                    children_[it->second].push_back(i);
+                    hasParent[i] = true;
+                    break;
+                }
+            }
+            if (!hasParent[i]) {
+                ready_.push_back(i);
+            }
+        }
+    }
+
+    // Stops handing out dirs at the first non-zero return of prepare and returns it.
+    int32_t Run(const std::function<int32_t(const DirInfo &)> &prepare, size_t workers)
+    {
+        workers = std::min({ std::max<size_t>(workers, 1), DIR_GRAPH_MAX_WORKERS, dirs_.size() });
+        std::vector<std::thread> threads;
+        for (size_t i = 1; i < workers; i++) {
+            threads.emplace_back([this, &prepare]() { Work(prepare); });
+        }
+        Work(prepare);
+        for (auto &thread : threads) {
+            thread.join();
+        }
+        return err_;
+    }
+
+private:
+    void Work(const std::function<int32_t(const DirInfo &)> &prepare)
+    {
+        std::unique_lock<std::mutex> lock(lock_);
+        while (true) {
+            cv_.wait(lock, [this]() { return err_ != E_OK || !ready_.empty() || running_ == 0; });
+            if (err_ != E_OK || ready_.empty()) {
+                return;
+            }
+            size_t index = ready_.front();
+            ready_.pop_front();
+            running_++;
+            lock.unlock();
+            int32_t ret = prepare(dirs_[index]);
+            lock.lock();
+            running_--;
+            if (ret != E_OK) {
+                err_ = (err_ == E_OK) ? ret : err_;
+            } else {
+                ready_.insert(ready_.end(), children_[index].begin(), children_[index].end());
+            }
+            cv_.notify_all();
+        }
+    }
+
+    const std::vector<DirInfo> &dirs_;
+    std::vector<std::vector<size_t>> children_;
+    std::deque<size_t> ready_;
+    size_t running_ = 0;
+    int32_t err_ = E_OK;
+    std::mutex lock_;
+    std::condition_variable cv_;
+};
+} // namespace
 
 UserManager &UserManager::GetInstance()
 {
@@ -134,20 +251,42 @@ int32_t UserManager::PrepareUserDirs(int32_t userId, uint32_t flags)
         LOGE("[L2:UserManager] PrepareUserDirs: <<< EXIT FAILED <<< GetUserBasePath failed, ret=%{public}d", ret);
         return ret;
     }
-    for (const auto &dirInfo : dirInfoList.data) {
-        ret = dirInfo.MakeDir();
-        if (ret != E_OK && dirInfo.path.find(EL1) == std::string::npos) {
+    InfoList<DirInfo> serviceDirList;
+    ret = GetServiceDirList(userId, flags, serviceDirList.data);
+    if (ret != E_OK) {
+        LOGE("[L2:UserManager] PrepareUserDirs: <<< EXIT FAILED <<< GetServiceDirList failed, ret=%{public}d", ret);
+        return ret;
+    }
+    std::string stampPath = GetDirsStampPath(userId, flags);
+    std::string generation = GetDirsGeneration(flags, GetSystemFingerprint(), dirInfoList.data, serviceDirList.data);
+    if (IsDirsStampCurrent(stampPath, generation, dirInfoList.data, serviceDirList.data)) {
+        LOGI("[L2:UserManager] PrepareUserDirs: <<< EXIT SUCCESS <<< dirs unchanged, userId=%{public}d", userId);
+        return E_OK;
+    }
+
+    ret = PrepareDirs(dirInfoList.data, [this, userId](const DirInfo &dirInfo) {
+        int32_t err = dirInfo.MakeDir();
+        if (err != E_OK && dirInfo.path.find(EL1) == std::string::npos) {
             std::string extraData = "dirPath=" + dirInfo.path + ",kernelCode=" + to_string(errno);
             StorageRadar::ReportUserManager("PrepareUserDirs", userId, E_PREPARE_DIR, extraData);
-            LOGE("[L2:UserManager] PrepareUserDirs: <<< EXIT FAILED <<< MakeDir failed, ret=%{public}d", ret);
-            return ret;
+            LOGE("[L2:UserManager] PrepareUserDirs: MakeDir failed, ret=%{public}d", err);
+            return err;
         }
         if (SetElDirFscryptPolicy(userId, dirInfo.path)) {
-            LOGE("[L2:UserManager] PrepareUserDirs: <<< EXIT FAILED <<< SetElDirFscryptPolicy failed");
-            return E_SET_POLICY;
+            LOGE("[L2:UserManager] PrepareUserDirs: SetElDirFscryptPolicy failed");
+            return static_cast<int32_t>(E_SET_POLICY);
         }
+        return static_cast<int32_t>(E_OK);
+    }, DIR_GRAPH_MAX_WORKERS);
+    if (ret != E_OK) {
+        LOGE("[L2:UserManager] PrepareUserDirs: <<< EXIT FAILED <<< ret=%{public}d", ret);
+        return ret;
     }
-    return CreateServiceDirs(userId, flags);
+    ret = PrepareServiceDirs(userId, serviceDirList.data);
+    if (ret == E_OK) {
+        SaveDirsStamp(stampPath, generation);
+    }
+    return ret;
 }
 
 int32_t UserManager::PrepareAllUserEl1Dirs()
@@ -171,31 +310,141 @@ int32_t UserManager::CreateServiceDirs(int32_t userId, uint32_t flags)
 {
     LOGI("[L2:UserManager] CreateServiceDirs: >>> ENTER <<< userId=%{public}d, flags=%{public}u", userId, flags);
     InfoList<DirInfo> dirInfoList;
-    auto ret = UserPathResolver::GetUserServicePath(userId, flags, dirInfoList.data);
+    auto ret = GetServiceDirList(userId, flags, dirInfoList.data);
+    if (ret != E_OK) {
+        LOGE("[L2:UserManager] CreateServiceDirs: <<< EXIT FAILED <<< GetServiceDirList failed, ret=%{public}d", ret);
+        return ret;
+    }
+    ret = PrepareServiceDirs(userId, dirInfoList.data);
+    LOGI("[L2:UserManager] CreateServiceDirs: <<< EXIT SUCCESS <<< userId=%{public}d, ret=%{public}d", userId, ret);
+    return ret;
+}
+
+int32_t UserManager::GetServiceDirList(int32_t userId, uint32_t flags, std::vector<DirInfo> &dirInfoList)
+{
+    auto ret = UserPathResolver::GetUserServicePath(userId, flags, dirInfoList);
     if (ret != E_OK) {
-        LOGE("[L2:UserManager] CreateServiceDirs: <<< EXIT FAILED <<< GetUserServicePath failed, ret=%{public}d", ret);
         return ret;
     }
-    for (auto &dirInfo : dirInfoList.data) {
+    for (auto &dirInfo : dirInfoList) {
         dirInfo.UpdateDirUid(userId);
+    }
+    return E_OK;
+}
+
+int32_t UserManager::PrepareServiceDirs(int32_t userId, const std::vector<DirInfo> &dirInfoList)
+{
+    // A failed service dir is reported and remembered, the rest of the list is still created.
+    std::atomic<int32_t> ret { E_OK };
+    (void)PrepareDirs(dirInfoList, [userId, &ret](const DirInfo &dirInfo) {
         auto err = dirInfo.MakeDir();
         if (err != E_OK) {
             std::string extraData = "dirPath=" + dirInfo.path + ",kernelCode=" + to_string(errno);
             StorageRadar::ReportUserManager("CreateServiceDirs", userId, E_PREPARE_DIR, extraData);
             ret = err;
         }
-        
+
         auto it = dirInfo.options.find("set_prjId");
         if (it != dirInfo.options.end()) {
             int64_t prjId = 0;
             ConvertStringToInt(it->second, prjId);
             QuotaManager::GetInstance().SetQuotaPrjId(dirInfo.path, static_cast<int32_t>(prjId), true);
         }
-    }
-    LOGI("[L2:UserManager] CreateServiceDirs: <<< EXIT SUCCESS <<< userId=%{public}d, ret=%{public}d", userId, ret);
+        return static_cast<int32_t>(E_OK);
+    }, DIR_GRAPH_MAX_WORKERS);
     return ret;
 }
 
+int32_t UserManager::PrepareDirs(const std::vector<DirInfo> &dirInfoList,
+    const std::function<int32_t(const DirInfo &)> &prepare, size_t workers)
+{
+    if (dirInfoList.empty()) {
+        return E_OK;
+    }
+    DirGraph graph(dirInfoList);
+    return graph.Run(prepare, workers);
+}
+
+std::string UserManager::GetDirsStampPath(int32_t userId, uint32_t flags)
+{
+    return std::string(USER_DIRS_STAMP_DIR) + "/" + std::to_string(userId) + "_" + std::to_string(flags);
+}
+
+const std::string &UserManager::GetSystemFingerprint()
+{
+    // An OTA can change the labels, the policies or the quota ids of the same dir list, so the stamp of the
+    // previous build must not skip restorecon, the fscrypt policy or SetQuotaPrjId.
+    static const std::string fingerprint = system::GetParameter(SOFTWARE_VERSION_PARAM, "") + "/" +
+        RelabelEngine::GetInstance().PolicyDigest();
+    return fingerprint;
+}
+
+std::string UserManager::GetDirsGeneration(uint32_t flags, const std::string &fingerprint,
+    const std::vector<DirInfo> &baseDirs, const std::vector<DirInfo> &serviceDirs)
+{
+    uint64_t hash = FNV_OFFSET_BASIS;
+    HashBytes(hash, std::to_string(flags));
+    HashBytes(hash, fingerprint);
+    for (const auto *dirs : { &baseDirs, &serviceDirs }) {
+        for (const auto &dirInfo : *dirs) {
+            HashBytes(hash, dirInfo.path);
+            HashBytes(hash, std::to_string(dirInfo.mode) + ":" + std::to_string(dirInfo.uid) + ":" +
+                std::to_string(dirInfo.gid));
+            std::map<std::string, std::string> options(dirInfo.options.begin(), dirInfo.options.end());
+            for (const auto &option : options) {
+                HashBytes(hash, option.first + "=" + option.second);
+            }
+        }
+        HashBytes(hash, "");
+    }
+    return std::to_string(hash);
+}
+
+bool UserManager::IsDirsStampCurrent(const std::string &stampPath, const std::string &generation,
+    const std::vector<DirInfo> &baseDirs, const std::vector<DirInfo> &serviceDirs)
+{
+    if (ReadFileContent(stampPath) != generation) {
+        return false;
+    }
+    // The stamp says nothing about dirs removed behind our back, so every dir must still be there.
+    for (const auto *dirs : { &baseDirs, &serviceDirs }) {
+        for (const auto &dirInfo : *dirs) {
+            struct stat st;
+            if (lstat(dirInfo.path.c_str(), &st) != 0 || !S_ISDIR(st.st_mode)) {
+                LOGW("[L2:UserManager] IsDirsStampCurrent: %{public}s is missing", dirInfo.path.c_str());
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void UserManager::SaveDirsStamp(const std::string &stampPath, const std::string &generation)
+{
+    std::string dir = stampPath.substr(0, stampPath.rfind('/'));
+    std::string tmpPath = stampPath + ".tmp";
+    if (!MkDirRecurse(dir, S_IRWXU) || !SaveStringToFile(tmpPath, generation) ||
+        rename(tmpPath.c_str(), stampPath.c_str()) != 0) {
+        LOGE("[L2:UserManager] SaveDirsStamp: save %{public}s failed, errno=%{public}d", stampPath.c_str(), errno);
+        (void)unlink(tmpPath.c_str());
+    }
+}
+
+void UserManager::ClearDirsStamps(int32_t userId)
+{
+    DIR *dir = opendir(USER_DIRS_STAMP_DIR);
+    if (dir == nullptr) {
+        return;
+    }
+    std::string prefix = std::to_string(userId) + "_";
+    for (struct dirent *ent = readdir(dir); ent != nullptr; ent = readdir(dir)) {
+        if (strncmp(ent->d_name, prefix.c_str(), prefix.size()) == 0) {
+            (void)unlinkat(dirfd(dir), ent->d_name, 0);
+        }
+    }
+    (void)closedir(dir);
+}
+
 int32_t UserManager::DestroyUserDirs(int32_t userId, uint32_t flags)
 {
     LOGI("[L2:UserManager] DestroyUserDirs: >>> ENTER <<< userId=%{public}d, flags=%{public}u", userId, flags);
@@ -205,6 +454,7 @@ int32_t UserManager::DestroyUserDirs(int32_t userId, uint32_t flags)
         LOGE("[L2:UserManager] DestroyUserDirs: <<< EXIT FAILED <<< userId %{public}d out of range", userId);
         return ret;
     }
+    ClearDirsStamps(userId);
 
     InfoList<DirInfo> dirInfoList;
     ret = UserPathResolver::GetUserServicePath(userId, flags, dirInfoList.data);
@@ -213,7 +463,7 @@ int32_t UserManager::DestroyUserDirs(int32_t userId, uint32_t flags)
         return ret;
     }
     for (auto dirInfo = dirInfoList.data.rbegin(); dirInfo != dirInfoList.data.rend(); ++dirInfo) {
-        auto err = dirInfo->RemoveDir();
+        auto err = dirInfo->RemoveDir(true);
         ret = (err != E_OK) ? err : ret;
     }
   
@@ -224,7 +474,7 @@ int32_t UserManager::DestroyUserDirs(int32_t userId, uint32_t flags)
         return ret2;
     }
     for (auto dirInfo = dirInfoList.data.rbegin(); dirInfo != dirInfoList.data.rend(); ++dirInfo) {
-        auto err = dirInfo->RemoveDir();
+        auto err = dirInfo->RemoveDir(true);
         ret = (err != E_OK) ? err : ret;
     }
     LOGI("[L2:UserManager] DestroyUserDirs: <<< EXIT SUCCESS <<< userId=%{public}d, ret=%{public}d", userId, ret);
@@ -370,11 +620,14 @@ int32_t UserManager::RestoreconSystemServiceDirs(int32_t userId)
         if (it == dirInfo.options.end()) {
             continue;
         }
-        auto startTime = StorageService::StorageRadar::RecordCurrentTime();
-        RestoreconRecurse(dirInfo.path.c_str());
-        auto delay = StorageService::StorageRadar::ReportDuration("RestoreconRecurse", startTime,
-            StorageService::DEFAULT_DELAY_TIME_THRESH, StorageService::DEFAULT_USER_ID);
-        LOGI("delay = %{public}s, path = %{public}s ", delay.c_str(), dirInfo.path.c_str());
+        // Queued behind the EL2 trees; a tree whose policy digest is current costs one xattr read.
+        RelabelEngine::GetInstance().RelabelTreeDeferred(dirInfo.path, [](const RelabelReport &report) {
+            auto startTime = StorageService::StorageRadar::RecordCurrentTime() - report.durationMs;
+            auto delay = StorageService::StorageRadar::ReportDuration("RestoreconRecurse", startTime,
+                StorageService::DEFAULT_DELAY_TIME_THRESH, StorageService::DEFAULT_USER_ID);
+            LOGI("[L2:UserManager] RestoreconSystemServiceDirs: delay = %{public}s, path = %{public}s, "
+                "ret=%{public}d", delay.c_str(), report.path.c_str(), report.err);
+        });
     }
 #endif
     LOGI("[L2:UserManager] RestoreconSystemServiceDirs: <<< EXIT SUCCESS <<< userId=%{public}d", userId);
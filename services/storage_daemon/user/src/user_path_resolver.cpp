@@ -17,8 +17,14 @@
 
 #include <iostream>
 #include <fstream>
+#include <iterator>
+#include <map>
+#include <mutex>
 #include <cstdlib>
+#include <cstring>
 #include <sstream>
+#include <string_view>
+#include <sys/stat.h>
 
 #include "storage_service_errno.h"
 #include "storage_service_log.h"
@@ -182,10 +188,12 @@ int32_t DirInfo::MakeDir(const std::string &createPath) const
     return E_OK;
 }
 
-int32_t DirInfo::RemoveDir() const
+int32_t DirInfo::RemoveDir(bool deferred) const
 {
-    LOGI("[L2:UserPathResolver] DirInfo::RemoveDir: >>> ENTER <<< path=%{public}s", path.c_str());
-    if (!RmDirRecurse(path)) {
+    LOGI("[L2:UserPathResolver] DirInfo::RemoveDir: >>> ENTER <<< path=%{public}s, deferred=%{public}d",
+         path.c_str(), deferred);
+    bool ret = deferred ? RmDirRecurseDeferred(path) : RmDirRecurse(path);
+    if (!ret) {
         LOGE("[L2:UserPathResolver] DirInfo::RemoveDir: <<< EXIT FAILED <<< RmDirRecurse failed, path=%{public}s,"
              "errno=%{public}d", path.c_str(), errno);
         return E_DESTROY_DIR;
@@ -256,62 +264,178 @@ bool MountNodeInfo::HasNoReturnOption() const
     return options.find(OPTIONS_NO_RETURN) != options.end();
 }
 
+namespace {
+// Identity of a config file on disk; a replaced or rewritten file changes at least one field.
+struct FileStamp {
+    dev_t dev = 0;
+    ino_t ino = 0;
+    off_t size = 0;
+    struct timespec mtime = {};
+
+    bool operator==(const FileStamp &other) const
+    {
+        return dev == other.dev && ino == other.ino && size == other.size &&
+            mtime.tv_sec == other.mtime.tv_sec && mtime.tv_nsec == other.mtime.tv_nsec;
+    }
+};
+
+bool GetFileStamp(const std::string &path, FileStamp &stamp)
+{
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) {
+        return false;
+    }
+    stamp.dev = st.st_dev;
+    stamp.ino = st.st_ino;
+    stamp.size = st.st_size;
+    stamp.mtime = st.st_mtim;
+    return true;
+}
+
+// A config string split around every <userId> slot, so instantiating it is a plain concatenation.
+class UserIdTemplate {
+public:
+    explicit UserIdTemplate(const std::string &raw)
+    {
+        std::string_view rest = raw;
+        size_t pos;
+        while ((pos = rest.find(USER_ID)) != std::string_view::npos) {
+            pieces_.emplace_back(rest.substr(0, pos));
+            rest.remove_prefix(pos + strlen(USER_ID));
+        }
+        pieces_.emplace_back(rest);
+    }
+
+    bool HasSlot() const { return pieces_.size() > 1; }
+
+    std::string Format(const std::string &userId) const
+    {
+        std::string out = pieces_[0];
+        for (size_t i = 1; i < pieces_.size(); i++) {
+            out.append(userId).append(pieces_[i]);
+        }
+        return out;
+    }
+
+private:
+    std::vector<std::string> pieces_;
+};
+
+template <typename T>
+struct TemplatedFields;
+
+template <>
+struct TemplatedFields<DirInfo> {
+    static constexpr std::string DirInfo::*FIELDS[] = { &DirInfo::path };
+};
+
+template <>
+struct TemplatedFields<MountNodeInfo> {
+    static constexpr std::string MountNodeInfo::*FIELDS[] = {
+        &MountNodeInfo::srcPath, &MountNodeInfo::dstPath, &MountNodeInfo::data
+    };
+};
+
+template <typename T>
+struct CompiledEntry {
+    explicit CompiledEntry(T &&item) : info(std::move(item))
+    {
+        for (auto field : TemplatedFields<T>::FIELDS) {
+            UserIdTemplate slot(info.*field);
+            if (slot.HasSlot()) {
+                slots.emplace_back(field, std::move(slot));
+            }
+        }
+    }
+
+    T Instantiate(const std::string &userId) const
+    {
+        T item = info;
+        for (const auto &[field, slot] : slots) {
+            item.*field = slot.Format(userId);
+        }
+        return item;
+    }
+
+    T info;
+    std::vector<std::pair<std::string T::*, UserIdTemplate>> slots;
+};
+
+template <typename T>
+struct CompiledList {
+    int32_t ret = E_OK;
+    std::vector<CompiledEntry<T>> entries;
+};
+
+struct ConfigCache {
+    bool loaded = false;
+    FileStamp stamp;
+    nlohmann::json json;
+    std::map<std::vector<std::string>, CompiledList<DirInfo>> dirLists;
+    std::map<std::vector<std::string>, CompiledList<MountNodeInfo>> mountLists;
+};
+
+template <typename T>
+std::map<std::vector<std::string>, CompiledList<T>> &CompiledListsOf(ConfigCache &cache);
+
+template <>
+std::map<std::vector<std::string>, CompiledList<DirInfo>> &CompiledListsOf<DirInfo>(ConfigCache &cache)
+{
+    return cache.dirLists;
+}
+
+template <>
+std::map<std::vector<std::string>, CompiledList<MountNodeInfo>> &CompiledListsOf<MountNodeInfo>(ConfigCache &cache)
+{
+    return cache.mountLists;
+}
+
+std::mutex g_configCacheMutex;
+std::unordered_map<std::string, ConfigCache> g_configCaches;
+} // namespace
+
 int32_t UserPathResolver::GetUserBasePath(int32_t userId, uint32_t flags, std::vector<DirInfo> &dirInfoList)
 {
     LOGI("[L2:UserPathResolver] GetUserBasePath: >>> ENTER <<< userId=%{public}d, flags=%{public}u", userId, flags);
-    auto ret = GetUserPath(flags, JSON_KEY_USER_BASE, dirInfoList);
+    auto ret = GetUserPath(userId, flags, JSON_KEY_USER_BASE, dirInfoList);
     if (ret != E_OK) {
         LOGE("[L2:UserPathResolver] GetUserBasePath: <<< EXIT FAILED <<< GetUserPath failed, ret=%{public}d", ret);
         return ret;
     }
-    return ReplaceUserId(userId, dirInfoList);
+    return E_OK;
 }
 
 int32_t UserPathResolver::GetUserServicePath(int32_t userId, uint32_t flags, std::vector<DirInfo> &dirInfoList)
 {
     LOGI("[L2:UserPathResolver] GetUserServicePath: >>> ENTER <<< userId=%{public}d, flags=%{public}u", userId, flags);
-    auto ret = GetUserPath(flags, JSON_KEY_USER_SERVICE, dirInfoList);
+    auto ret = GetUserPath(userId, flags, JSON_KEY_USER_SERVICE, dirInfoList);
     if (ret != E_OK) {
         LOGE("[L2:UserPathResolver] GetUserServicePath: <<< EXIT FAILED <<< GetUserPath failed, ret=%{public}d", ret);
         return ret;
     }
-    return ReplaceUserId(userId, dirInfoList);
+    return E_OK;
 }
 
 int32_t UserPathResolver::GetAppdataPath(int32_t userId, std::vector<DirInfo> &dirInfoList)
 {
     LOGI("[L2:UserPathResolver] GetAppdataPath: >>> ENTER <<< userId=%{public}d", userId);
-    nlohmann::json j;
-    auto ret = OpenJsonFile(STORAGE_USER_PATH, j);
-    if (ret != E_OK) {
-        LOGE("[L2:UserPathResolver] GetAppdataPath: <<< EXIT FAILED <<< OpenJsonFile failed, ret=%{public}d", ret);
-        return ret;
-    }
-
-    ret = GetTListFromJson<DirInfo>(j, {JSON_KEY_APPDATA}, dirInfoList);
+    auto ret = GetCompiledList<DirInfo>(userId, STORAGE_USER_PATH, {JSON_KEY_APPDATA}, dirInfoList);
     if (ret != E_OK) {
-        LOGE("[L2:UserPathResolver] GetAppdataPath: <<< EXIT FAILED <<< GetTListFromJson failed, ret=%{public}d", ret);
+        LOGE("[L2:UserPathResolver] GetAppdataPath: <<< EXIT FAILED <<< GetCompiledList failed, ret=%{public}d", ret);
         return ret;
     }
-    return ReplaceUserId(userId, dirInfoList);
+    return E_OK;
 }
 
 int32_t UserPathResolver::GetVirtualPath(int32_t userId, std::vector<DirInfo> &dirInfoList)
 {
     LOGI("[L2:UserPathResolver] GetVirtualPath: >>> ENTER <<< userId=%{public}d", userId);
-    nlohmann::json j;
-    auto ret = OpenJsonFile(STORAGE_USER_PATH, j);
-    if (ret != E_OK) {
-        LOGE("[L2:UserPathResolver] GetVirtualPath: <<< EXIT FAILED <<< OpenJsonFile failed, ret=%{public}d", ret);
-        return ret;
-    }
-
-    ret = GetTListFromJson<DirInfo>(j, {JSON_KEY_VIRTUAL}, dirInfoList);
+    auto ret = GetCompiledList<DirInfo>(userId, STORAGE_USER_PATH, {JSON_KEY_VIRTUAL}, dirInfoList);
     if (ret != E_OK) {
-        LOGE("[L2:UserPathResolver] GetVirtualPath: <<< EXIT FAILED <<< GetTListFromJson failed, ret=%{public}d", ret);
+        LOGE("[L2:UserPathResolver] GetVirtualPath: <<< EXIT FAILED <<< GetCompiledList failed, ret=%{public}d", ret);
         return ret;
     }
-    return ReplaceUserId(userId, dirInfoList);
+    return E_OK;
 }
 
 int32_t UserPathResolver::GetAppDataMountNodeList(int32_t userId, std::vector<MountNodeInfo> &mountNodeList)
@@ -334,32 +458,47 @@ int32_t UserPathResolver::GetSandboxMountNodeList(int32_t userId, std::vector<Mo
     return GetMountNodeList(userId, {JSON_KEY_SANDBOX_MOUNT}, mountNodeList);
 }
 
+void UserPathResolver::LoadConfigs()
+{
+    LOGI("[L2:UserPathResolver] LoadConfigs: >>> ENTER <<<");
+    auto startTime = StorageService::StorageRadar::RecordCurrentTime();
+    uint32_t allFlags = CRYPTO_FLAG_EL1 | CRYPTO_FLAG_EL2 | CRYPTO_FLAG_EL3 | CRYPTO_FLAG_EL4 | CRYPTO_FLAG_EL5;
+    std::vector<DirInfo> dirInfoList;
+    std::vector<MountNodeInfo> mountNodeList;
+    (void)GetUserBasePath(StorageService::DEFAULT_USERID, allFlags, dirInfoList);
+    (void)GetUserServicePath(StorageService::DEFAULT_USERID, allFlags, dirInfoList);
+    (void)GetAppdataPath(StorageService::DEFAULT_USERID, dirInfoList);
+    (void)GetVirtualPath(StorageService::DEFAULT_USERID, dirInfoList);
+    (void)GetAppDataMountNodeList(StorageService::DEFAULT_USERID, mountNodeList);
+    (void)GetAppDataMountStartupNodeList(StorageService::DEFAULT_USERID, mountNodeList);
+    (void)GetHmdfsMountNodeList(StorageService::DEFAULT_USERID, mountNodeList);
+    (void)GetSandboxMountNodeList(StorageService::DEFAULT_USERID, mountNodeList);
+    auto delay = StorageService::StorageRadar::ReportDuration("LoadConfigs",
+        startTime, StorageService::DEFAULT_DELAY_TIME_THRESH, StorageService::DEFAULT_USERID);
+    LOGI("[L2:UserPathResolver] LoadConfigs: <<< EXIT SUCCESS <<< dirs=%{public}zu, mountNodes=%{public}zu, "
+        "delayTime=%{public}s", dirInfoList.size(), mountNodeList.size(), delay.c_str());
+}
+
 int32_t UserPathResolver::GetMountNodeList(int32_t userId, const std::vector<std::string> &pathKeys,
     std::vector<MountNodeInfo> &mountNodeList)
 {
     LOGI("[L2:UserPathResolver] GetMountNodeList: >>> ENTER <<< userId=%{public}d, pathKeys.size()=%{public}zu",
         userId, pathKeys.size());
-    nlohmann::json j;
-    auto ret = OpenJsonFile(STORAGE_MOUNT_INFO, j);
+    auto ret = GetCompiledList<MountNodeInfo>(userId, STORAGE_MOUNT_INFO, pathKeys, mountNodeList);
     if (ret != E_OK) {
-        LOGE("[L2:UserPathResolver] GetMountNodeList: <<< EXIT FAILED <<< OpenJsonFile failed, ret=%{public}d", ret);
-        return ret;
-    }
-
-    ret = GetTListFromJson<MountNodeInfo>(j, pathKeys, mountNodeList);
-    if (ret != E_OK) {
-        LOGE("[L2:UserPathResolver] GetMountNodeList: <<< EXIT FAILED <<< GetTListFromJson failed, ret=%{public}d",
+        LOGE("[L2:UserPathResolver] GetMountNodeList: <<< EXIT FAILED <<< GetCompiledList failed, ret=%{public}d",
             ret);
         return ret;
     }
-    return ReplaceUserId(userId, mountNodeList);
+    return E_OK;
 }
 
-int32_t UserPathResolver::GetUserPath(uint32_t flags, const std::string &userType, std::vector<DirInfo> &dirInfoList)
+int32_t UserPathResolver::GetUserPath(int32_t userId, uint32_t flags, const std::string &userType,
+    std::vector<DirInfo> &dirInfoList)
 {
     LOGI("[L2:UserPathResolver] GetUserPath: >>> ENTER <<< flags=%{public}u, userType=%{public}s",
         flags, userType.c_str());
-    std::map<IStorageDaemonEnum, std::string> expectFlags {
+    static const std::map<IStorageDaemonEnum, std::string> expectFlags {
         {CRYPTO_FLAG_EL1, EL1},
         {CRYPTO_FLAG_EL2, EL2},
         {CRYPTO_FLAG_EL3, EL3},
@@ -367,20 +506,13 @@ int32_t UserPathResolver::GetUserPath(uint32_t flags, const std::string &userTyp
         {CRYPTO_FLAG_EL5, EL5},
     };
 
-    nlohmann::json j;
-    auto ret = OpenJsonFile(STORAGE_USER_PATH, j);
-    if (ret != E_OK) {
-        LOGE("[L2:UserPathResolver] GetUserPath: <<< EXIT FAILED <<< OpenJsonFile failed, ret=%{public}d", ret);
-        return ret;
-    }
-
     for (auto &expectFlag : expectFlags) {
-        int32_t ret = E_OK;
-        if (flags & expectFlag.first) {
-            ret = GetTListFromJson<DirInfo>(j, {userType, expectFlag.second}, dirInfoList);
+        if ((flags & expectFlag.first) == 0) {
+            continue;
         }
+        auto ret = GetCompiledList<DirInfo>(userId, STORAGE_USER_PATH, {userType, expectFlag.second}, dirInfoList);
         if (ret != E_OK) {
-            LOGE("[L2:UserPathResolver] GetUserPath: <<< EXIT FAILED <<< GetTListFromJson failed, ret=%{public}d", ret);
+            LOGE("[L2:UserPathResolver] GetUserPath: <<< EXIT FAILED <<< GetCompiledList failed, ret=%{public}d", ret);
             return ret;
         }
     }
@@ -406,16 +538,14 @@ int32_t UserPathResolver::OpenJsonFile(const std::string &filename, nlohmann::js
             "error=%{public}d", filename.c_str(), errno);
         return E_OPEN_JSON_FILE_ERROR;
     }
-    
-    std::stringstream buffer;
-    buffer << file.rdbuf();
-    std::string content = buffer.str();
-    if (content.empty() || !nlohmann::json::accept(content)) {
+
+    std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    // A non-throwing parse reports invalid input as discarded, so no separate accept() pass is needed.
+    j = nlohmann::json::parse(content, nullptr, false);
+    if (content.empty() || j.is_discarded()) {
         LOGE("[L2:UserPathResolver] OpenJsonFile: <<< EXIT FAILED <<< jsonStr is empty or invalid");
         return E_JSON_PARSE_ERROR;
     }
-
-    j = nlohmann::json::parse(content, nullptr, false);
     LOGI("[L2:UserPathResolver] OpenJsonFile: <<< EXIT SUCCESS <<< filename=%{public}s", filename.c_str());
     return E_OK;
 }
@@ -465,28 +595,54 @@ template int32_t UserPathResolver::GetTListFromJson<DirInfo>(const nlohmann::jso
 template int32_t UserPathResolver::GetTListFromJson<MountNodeInfo>(const nlohmann::json&,
     const std::vector<std::string>&, std::vector<MountNodeInfo>&);
 
-int32_t UserPathResolver::ReplaceUserId(int32_t userId, std::vector<DirInfo> &dirInfoList)
+template <typename T>
+int32_t UserPathResolver::GetCompiledList(int32_t userId, const std::string &filename,
+    const std::vector<std::string> &pathKeys, std::vector<T> &tList)
 {
-    LOGI("[L2:UserPathResolver] ReplaceUserId(DirInfo): >>> ENTER <<< userId=%{public}d,"
-        "dirInfoList.size()=%{public}zu", userId, dirInfoList.size());
-    for (auto &dirInfo : dirInfoList) {
-        ReplaceAndCount(dirInfo.path, USER_ID, std::to_string(userId));
+    std::lock_guard<std::mutex> lock(g_configCacheMutex);
+    ConfigCache &cache = g_configCaches[filename];
+    FileStamp stamp;
+    if (!GetFileStamp(STORAGE_ETC_PATH + filename, stamp) || !cache.loaded || !(stamp == cache.stamp)) {
+        cache = ConfigCache();
+        auto ret = OpenJsonFile(filename, cache.json);
+        if (ret != E_OK) {
+            cache = ConfigCache();
+            return ret;
+        }
+        cache.stamp = stamp;
+        cache.loaded = true;
+    }
+
+    auto &lists = CompiledListsOf<T>(cache);
+    auto it = lists.find(pathKeys);
+    if (it == lists.end()) {
+        std::vector<T> items;
+        CompiledList<T> compiled;
+        compiled.ret = GetTListFromJson<T>(cache.json, pathKeys, items);
+        if (compiled.ret == E_OK) {
+            compiled.entries.reserve(items.size());
+            for (auto &item : items) {
+                compiled.entries.emplace_back(std::move(item));
+            }
+        }
+        it = lists.emplace(pathKeys, std::move(compiled)).first;
+    }
+    if (it->second.ret != E_OK) {
+        return it->second.ret;
     }
-    LOGI("[L2:UserPathResolver] ReplaceUserId(DirInfo): <<< EXIT SUCCESS <<< userId=%{public}d", userId);
-    return E_OK;
-}
 
-int32_t UserPathResolver::ReplaceUserId(int32_t userId, std::vector<MountNodeInfo> &mountNodeList)
-{
-    LOGI("[L2:UserPathResolver] ReplaceUserId(MountNodeInfo): >>> ENTER <<< userId=%{public}d,"
-        "mountNodeList.size()=%{public}zu", userId, mountNodeList.size());
-    for (auto &mountNode : mountNodeList) {
-        ReplaceAndCount(mountNode.srcPath, USER_ID, std::to_string(userId));
-        ReplaceAndCount(mountNode.dstPath, USER_ID, std::to_string(userId));
-        ReplaceAndCount(mountNode.data, USER_ID, std::to_string(userId));
-    }
-    LOGI("[L2:UserPathResolver] ReplaceUserId(MountNodeInfo): <<< EXIT SUCCESS <<< userId=%{public}d", userId);
+    std::string userIdStr = std::to_string(userId);
+    tList.reserve(tList.size() + it->second.entries.size());
+    for (const auto &entry : it->second.entries) {
+        tList.emplace_back(entry.Instantiate(userIdStr));
+    }
     return E_OK;
 }
+
+template int32_t UserPathResolver::GetCompiledList<DirInfo>(int32_t, const std::string&,
+    const std::vector<std::string>&, std::vector<DirInfo>&);
+
+template int32_t UserPathResolver::GetCompiledList<MountNodeInfo>(int32_t, const std::string&,
+    const std::vector<std::string>&, std::vector<MountNodeInfo>&);
 } // namespace StorageDaemon
 } // namespace OHOS
@@ -228,26 +228,6 @@ HWTEST_F(MountManagerTest, Storage_Daemon_MountManagerTest_MountSharefs_001, Tes
     EXPECT_EQ(MountManager::GetInstance().MountSharefs(userId), E_OK);
 }
 
-/**
- * @tc.name: Storage_Daemon_MountManagerTest_CheckSymlink_001
- * @tc.desc: Verify the CheckSymlink function.
- * @tc.type: FUNC
- * @tc.require: IB49AM
- */
-HWTEST_F(MountManagerTest, Storage_Daemon_MountManagerTest_CheckSymlink_001, TestSize.Level1)
-{
-    GTEST_LOG_(INFO) << "Storage_Daemon_MountManagerTest_CheckSymlink_001 start";
-    std::string path;
-    std::list<std::string> unMountFailList;
-    auto ret = MountManager::GetInstance().CheckSymlink(path, unMountFailList);
-    EXPECT_EQ(ret, false);
-
-    path = "/data/test/tdd/test.txt";
-    ret = MountManager::GetInstance().CheckSymlink(path, unMountFailList);
-    EXPECT_EQ(ret, false);
-    GTEST_LOG_(INFO) << "Storage_Daemon_MountManagerTest_CheckSymlink_001 end";
-}
-
 /**
  * @tc.name: Storage_Daemon_MountManagerTest_PrepareAppdataDirByUserId_001
  * @tc.desc: Verify the PrepareAppdataDirByUserId function.
@@ -355,41 +335,6 @@ HWTEST_F(MountManagerTest, Storage_Daemon_MountManagerTest_CheckPathValid_001, T
     GTEST_LOG_(INFO) << "Storage_Daemon_MountManagerTest_CheckPathValid_001 end";
 }
 
-/**
- * @tc.name: Storage_Daemon_MountManagerTest_CheckMaps_001
- * @tc.desc: Verify the CheckMaps function.
- * @tc.type: FUNC
- * @tc.require: IB49AM
- */
-HWTEST_F(MountManagerTest, Storage_Daemon_MountManagerTest_CheckMaps_001, TestSize.Level1)
-{
-    GTEST_LOG_(INFO) << "Storage_Daemon_MountManagerTest_CheckMaps_001 start";
-    std::string path;
-    std::list<std::string> mountFailList;
-    auto ret = MountManager::GetInstance().CheckMaps("", mountFailList);
-    EXPECT_FALSE(ret);
-
-    string baseDir = "/data/test/tdd";
-    ForceCreateDirectory(baseDir);
-    path = baseDir + "test.txt";
-    ret = MountManager::GetInstance().CheckMaps(path, mountFailList);
-    EXPECT_FALSE(ret);
-
-    auto fd = open(path.c_str(), O_RDWR | O_CREAT);
-    ASSERT_GT(fd, 0);
-
-    std::string content = "this is a test\n/data/test/tdd";
-    (void)write(fd, content.c_str(), content.size());
-    close(fd);
-    ret = MountManager::GetInstance().CheckMaps(path, mountFailList);
-    EXPECT_FALSE(ret);
-
-    mountFailList.push_back(baseDir);
-    ret = MountManager::GetInstance().CheckMaps(path, mountFailList);
-    EXPECT_TRUE(ret);
-    GTEST_LOG_(INFO) << "Storage_Daemon_MountManagerTest_CheckMaps_001 end";
-}
-
 /**
  * @tc.name: Storage_Daemon_MountManagerTest_MountSandboxPath_001
  * @tc.desc: Verify the MountSandboxPath function.
@@ -632,40 +577,6 @@ HWTEST_F(MountManagerTest, Storage_Daemon_MountManagerTest_OpenProcForMulti_001,
     GTEST_LOG_(INFO) << "Storage_Daemon_MountManagerTest_OpenProcForMulti_001 end";
 }
 
-/**
- * @tc.name: Storage_Daemon_MountManagerTest_FindProcForPath_001
- * @tc.desc: Verify the FindProcForPath function.
- * @tc.type: FUNC
- * @tc.require: IB49AM
- */
-HWTEST_F(MountManagerTest, Storage_Daemon_MountManagerTest_FindProcForPath_001, TestSize.Level1)
-{
-    GTEST_LOG_(INFO) << "Storage_Daemon_MountManagerTest_FindProcForPath_001 start";
-    std::string pidPath = "/test/111";
-    std::string path = "/data/test/tdd/";
-    bool isDir = false;
-    bool ret = MountManager::GetInstance().FindProcForPath(pidPath, path, isDir);
-    EXPECT_EQ(ret, false);
-    GTEST_LOG_(INFO) << "Storage_Daemon_MountManagerTest_FindProcForPath_001 end";
-}
-
-/**
- * @tc.name: Storage_Daemon_MountManagerTest_FindProcForMulti_001
- * @tc.desc: Verify the FindProcForMulti function.
- * @tc.type: FUNC
- * @tc.require: IB49AM
- */
-HWTEST_F(MountManagerTest, Storage_Daemon_MountManagerTest_FindProcForMulti_001, TestSize.Level1)
-{
-    GTEST_LOG_(INFO) << "Storage_Daemon_MountManagerTest_FindProcForMulti_001 start";
-    std::string pidPath = "/test/111";
-    std::string path = "/data/test/tdd/";
-    std::set<std::string> occupyFiles;
-    MountManager::GetInstance().FindProcForMulti(pidPath, path, occupyFiles);
-    ASSERT_TRUE(occupyFiles.empty());
-    GTEST_LOG_(INFO) << "Storage_Daemon_MountManagerTest_FindProcForMulti_001 end";
-}
-
 /**
  * @tc.name: Storage_Manager_MountManagerTest_MountDfsDocs_001
  * @tc.desc: Verify the MountDfsDocs function.
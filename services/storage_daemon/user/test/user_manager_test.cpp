@@ -13,7 +13,11 @@
  * limitations under the License.
  */
 
+#include <atomic>
+#include <chrono>
 #include <gtest/gtest.h>
+#include <sys/mount.h>
+#include <unistd.h>
 
 #include "directory_ex.h"
 #include "istorage_daemon.h"
@@ -33,6 +37,8 @@ namespace StorageDaemon {
 using namespace testing;
 using namespace testing::ext;
 
+const std::string DIR_GRAPH_TEST_ROOT = "/data/local/tmp/user_dir_graph_test";
+
 class UserManagerTest : public testing::Test {
 public:
     static void SetUpTestCase(void);
@@ -454,26 +460,6 @@ HWTEST_F(UserManagerTest, Storage_Manager_MountManagerTest_FindAndKillProcess_00
     GTEST_LOG_(INFO) << "Storage_Manager_MountManagerTest_FindAndKillProcess_000 end";
 }
 
-/**
- * @tc.name: Storage_Manager_MountManagerTest_CheckMaps_001
- * @tc.desc: Verify the CheckMaps function.
- * @tc.type: FUNC
- */
-HWTEST_F(UserManagerTest, Storage_Manager_MountManagerTest_CheckMaps_000, TestSize.Level1)
-{
-    GTEST_LOG_(INFO) << "Storage_Manager_MountManagerTest_CheckMaps_000 start";
-
-    std::string path = "";
-    std::list<std::string> unMountFailList;
-    unMountFailList.push_back("test1");
-    MountManager::GetInstance().CheckMaps(path, unMountFailList);
-    MountManager::GetInstance().CheckSymlink(path, unMountFailList);
-
-    path = "/data/file";
-    MountManager::GetInstance().CheckMaps(path, unMountFailList);
-    MountManager::GetInstance().CheckSymlink(path, unMountFailList);
-    GTEST_LOG_(INFO) << "Storage_Manager_MountManagerTest_CheckMaps_000 end";
-}
 #ifdef STORAGE_SERVICE_MEDIA_FUSE
 /**
  * @tc.name: Storage_Manager_MountManagerTest_MountMediaFuse_001
@@ -634,5 +620,144 @@ HWTEST_F(UserManagerTest, Storage_Manager_UserManagerTest_PrepareUserDirsForUpda
     EXPECT_FALSE(ret == E_OK);
     GTEST_LOG_(INFO) << "Storage_Manager_UserManagerTest_PrepareUserDirsForUpdate_004 end";
 }
+
+/**
+ * @tc.name: Storage_Manager_UserManagerTest_PrepareDirs_001
+ * @tc.desc: Verify PrepareDirs creates every parent before its children and stops on the first error.
+ * @tc.type: FUNC
+ * @tc.require: AR000GK4HB
+ */
+HWTEST_F(UserManagerTest, Storage_Manager_UserManagerTest_PrepareDirs_001, TestSize.Level1)
+{
+    GTEST_LOG_(INFO) << "Storage_Manager_UserManagerTest_PrepareDirs_001 start";
+    RmDirRecurse(DIR_GRAPH_TEST_ROOT);
+    ASSERT_TRUE(MkDirRecurse(DIR_GRAPH_TEST_ROOT, S_IRWXU));
+    std::vector<std::string> relPaths = { "/a/b/c", "/a/b", "/a", "/x", "/x/y", "/a", "/a/b/d", "/z/deep" };
+    std::vector<DirInfo> dirs;
+    for (const auto &relPath : relPaths) {
+        dirs.push_back({ .path = DIR_GRAPH_TEST_ROOT + relPath, .mode = S_IRWXU });
+    }
+    dirs.push_back({ .path = DIR_GRAPH_TEST_ROOT + "/z", .mode = S_IRWXU });
+
+    std::atomic<int> orphans { 0 };
+    std::atomic<int> calls { 0 };
+    auto ret = UserManager::PrepareDirs(dirs, [&orphans, &calls](const DirInfo &dirInfo) {
+        calls++;
+        std::string parent = dirInfo.path.substr(0, dirInfo.path.rfind('/'));
+        if (access(parent.c_str(), F_OK) != 0) {
+            orphans++;
+        }
+        return dirInfo.MakeDir();
+    }, 4);
+    EXPECT_EQ(ret, E_OK);
+    EXPECT_EQ(orphans, 0);
+    EXPECT_EQ(calls, static_cast<int>(dirs.size()));
+    for (const auto &dirInfo : dirs) {
+        EXPECT_TRUE(StorageTest::StorageTestUtils::CheckDir(dirInfo.path)) << dirInfo.path;
+    }
+
+    RmDirRecurse(DIR_GRAPH_TEST_ROOT);
+    ASSERT_TRUE(MkDirRecurse(DIR_GRAPH_TEST_ROOT, S_IRWXU));
+    ret = UserManager::PrepareDirs(dirs, [](const DirInfo &dirInfo) {
+        if (dirInfo.path == DIR_GRAPH_TEST_ROOT + "/a") {
+            return static_cast<int32_t>(E_SET_POLICY);
+        }
+        return dirInfo.MakeDir();
+    }, 4);
+    EXPECT_EQ(ret, E_SET_POLICY);
+    EXPECT_FALSE(StorageTest::StorageTestUtils::CheckDir(DIR_GRAPH_TEST_ROOT + "/a/b"));
+    RmDirRecurse(DIR_GRAPH_TEST_ROOT);
+    GTEST_LOG_(INFO) << "Storage_Manager_UserManagerTest_PrepareDirs_001 end";
+}
+
+/**
+ * @tc.name: Storage_Manager_UserManagerTest_DirsStamp_001
+ * @tc.desc: Verify the prepared generation stamp follows the dir specs, the build and the dirs on disk.
+ * @tc.type: FUNC
+ * @tc.require: AR000GK4HB
+ */
+HWTEST_F(UserManagerTest, Storage_Manager_UserManagerTest_DirsStamp_001, TestSize.Level1)
+{
+    GTEST_LOG_(INFO) << "Storage_Manager_UserManagerTest_DirsStamp_001 start";
+    RmDirRecurse(DIR_GRAPH_TEST_ROOT);
+    std::vector<DirInfo> baseDirs = { { .path = DIR_GRAPH_TEST_ROOT + "/base", .mode = S_IRWXU } };
+    std::vector<DirInfo> serviceDirs = { { .path = DIR_GRAPH_TEST_ROOT + "/base/service", .mode = S_IRWXU } };
+    const std::string fingerprint = "5.0.0.1/0123456789abcdef";
+    std::string generation = UserManager::GetDirsGeneration(1, fingerprint, baseDirs, serviceDirs);
+    EXPECT_EQ(generation, UserManager::GetDirsGeneration(1, fingerprint, baseDirs, serviceDirs));
+    EXPECT_NE(generation, UserManager::GetDirsGeneration(2, fingerprint, baseDirs, serviceDirs));
+    EXPECT_NE(generation, UserManager::GetDirsGeneration(1, "5.0.0.2/0123456789abcdef", baseDirs, serviceDirs));
+    EXPECT_EQ(&UserManager::GetSystemFingerprint(), &UserManager::GetSystemFingerprint());
+    serviceDirs[0].options["set_prjId"] = "1";
+    EXPECT_NE(generation, UserManager::GetDirsGeneration(1, fingerprint, baseDirs, serviceDirs));
+    generation = UserManager::GetDirsGeneration(1, fingerprint, baseDirs, serviceDirs);
+
+    std::string stampPath = UserManager::GetDirsStampPath(StorageTest::USER_ID5, 1);
+    UserManager::ClearDirsStamps(StorageTest::USER_ID5);
+    EXPECT_FALSE(UserManager::IsDirsStampCurrent(stampPath, generation, baseDirs, serviceDirs));
+    ASSERT_TRUE(MkDirRecurse(serviceDirs[0].path, S_IRWXU));
+    UserManager::SaveDirsStamp(stampPath, generation);
+    EXPECT_TRUE(UserManager::IsDirsStampCurrent(stampPath, generation, baseDirs, serviceDirs));
+    EXPECT_FALSE(UserManager::IsDirsStampCurrent(stampPath, generation + "0", baseDirs, serviceDirs));
+
+    RmDirRecurse(serviceDirs[0].path);
+    EXPECT_FALSE(UserManager::IsDirsStampCurrent(stampPath, generation, baseDirs, serviceDirs));
+    RmDirRecurse(baseDirs[0].path);
+    EXPECT_FALSE(UserManager::IsDirsStampCurrent(stampPath, generation, baseDirs, serviceDirs));
+    ASSERT_TRUE(MkDirRecurse(serviceDirs[0].path, S_IRWXU));
+    UserManager::ClearDirsStamps(StorageTest::USER_ID5);
+    EXPECT_FALSE(UserManager::IsDirsStampCurrent(stampPath, generation, baseDirs, serviceDirs));
+    RmDirRecurse(DIR_GRAPH_TEST_ROOT);
+    GTEST_LOG_(INFO) << "Storage_Manager_UserManagerTest_DirsStamp_001 end";
+}
+
+/**
+ * @tc.name: Storage_Manager_UserManagerTest_PrepareDirs_Perf_001
+ * @tc.desc: Log PrepareDirs wall time with one worker and with the full pool on a tmpfs tree.
+ * @tc.type: PERF
+ * @tc.require: AR000GK4HB
+ */
+HWTEST_F(UserManagerTest, Storage_Manager_UserManagerTest_PrepareDirs_Perf_001, TestSize.Level3)
+{
+    GTEST_LOG_(INFO) << "Storage_Manager_UserManagerTest_PrepareDirs_Perf_001 start";
+    RmDirRecurse(DIR_GRAPH_TEST_ROOT);
+    ASSERT_TRUE(MkDirRecurse(DIR_GRAPH_TEST_ROOT, S_IRWXU));
+    bool onTmpfs = mount("tmpfs", DIR_GRAPH_TEST_ROOT.c_str(), "tmpfs", 0, nullptr) == 0;
+    const int topDirs = 16;
+    const int subDirs = 64;
+    std::vector<DirInfo> dirs;
+    for (int i = 0; i < topDirs; i++) {
+        std::string top = "/d" + std::to_string(i);
+        dirs.push_back({ .path = top, .mode = S_IRWXU | S_IRWXG, .uid = getuid(), .gid = getgid() });
+        for (int j = 0; j < subDirs; j++) {
+            dirs.push_back({ .path = top + "/s" + std::to_string(j), .mode = S_IRWXU, .uid = getuid(),
+                .gid = getgid() });
+        }
+    }
+    for (size_t workers : { 1, 4 }) {
+        std::string root = DIR_GRAPH_TEST_ROOT + "/w" + std::to_string(workers);
+        ASSERT_TRUE(MkDirRecurse(root, S_IRWXU));
+        std::vector<DirInfo> rooted = dirs;
+        for (auto &dirInfo : rooted) {
+            dirInfo.path = root + dirInfo.path;
+        }
+        auto start = std::chrono::steady_clock::now();
+        EXPECT_EQ(UserManager::PrepareDirs(rooted, [](const DirInfo &dirInfo) { return dirInfo.MakeDir(); },
+            workers), E_OK);
+        auto cost = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+        GTEST_LOG_(INFO) << (onTmpfs ? "tmpfs" : "data") << ", workers " << workers << ": " << rooted.size()
+                         << " dirs in " << cost.count() << " us";
+        struct stat st;
+        ASSERT_EQ(lstat(rooted.back().path.c_str(), &st), 0);
+        EXPECT_EQ(st.st_mode & ALLPERMS, S_IRWXU);
+        ASSERT_EQ(lstat(rooted.front().path.c_str(), &st), 0);
+        EXPECT_EQ(st.st_mode & ALLPERMS, S_IRWXU | S_IRWXG);
+    }
+    if (onTmpfs) {
+        (void)umount2(DIR_GRAPH_TEST_ROOT.c_str(), MNT_DETACH);
+    }
+    RmDirRecurse(DIR_GRAPH_TEST_ROOT);
+    GTEST_LOG_(INFO) << "Storage_Manager_UserManagerTest_PrepareDirs_Perf_001 end";
+}
 } // STORAGE_DAEMON
 } // OHOS
@@ -15,6 +15,7 @@
 
 #include "user/user_path_resolver.h"
 
+#include <chrono>
 #include <filesystem>
 #include <fstream>
 #include <memory>
@@ -207,6 +208,10 @@ HWTEST_F(UserPathResolverTest, UserPathResolverTest_RemoveDir_001, TestSize.Leve
     EXPECT_CALL(*fileUtilMock_, RmDirRecurse(_)).WillOnce(Return(true)).WillOnce(Return(false));
     EXPECT_EQ(dirInfo.RemoveDir(), E_OK);
     EXPECT_EQ(dirInfo.RemoveDir(), E_DESTROY_DIR);
+
+    EXPECT_CALL(*fileUtilMock_, RmDirRecurseDeferred(_)).WillOnce(Return(true)).WillOnce(Return(false));
+    EXPECT_EQ(dirInfo.RemoveDir(true), E_OK);
+    EXPECT_EQ(dirInfo.RemoveDir(true), E_DESTROY_DIR);
 }
 
 /**
@@ -498,6 +503,48 @@ HWTEST_F(UserPathResolverTest, UserPathResolverTest_GetAppDataMountStartupNodeLi
     EXPECT_EQ(UserPathResolver::GetAppDataMountStartupNodeList(userId_, mountNodeList), E_OK);
 }
 
+/**
+ * @tc.name: UserPathResolverTest_CompiledConfig_001
+ * @tc.desc: Verify that the cached config gives the same lists as a cold load and reloads after the file changes.
+ * @tc.type: FUNC
+ * @tc.require: AR000H09L6
+ */
+HWTEST_F(UserPathResolverTest, UserPathResolverTest_CompiledConfig_001, TestSize.Level1)
+{
+    uint32_t flags = IStorageDaemonEnum::CRYPTO_FLAG_EL1 | IStorageDaemonEnum::CRYPTO_FLAG_EL2;
+    std::vector<DirInfo> coldList;
+    auto start = std::chrono::steady_clock::now();
+    ASSERT_EQ(UserPathResolver::GetUserBasePath(userId_, flags, coldList), E_OK);
+    auto coldCost = std::chrono::steady_clock::now() - start;
+
+    std::vector<DirInfo> warmList;
+    start = std::chrono::steady_clock::now();
+    ASSERT_EQ(UserPathResolver::GetUserBasePath(userId_, flags, warmList), E_OK);
+    auto warmCost = std::chrono::steady_clock::now() - start;
+    GTEST_LOG_(INFO) << "cold cost " << std::chrono::duration_cast<std::chrono::microseconds>(coldCost).count()
+                     << " us, warm cost " << std::chrono::duration_cast<std::chrono::microseconds>(warmCost).count()
+                     << " us";
+
+    ASSERT_EQ(coldList.size(), warmList.size());
+    for (size_t i = 0; i < coldList.size(); i++) {
+        EXPECT_EQ(coldList[i].path, warmList[i].path);
+        EXPECT_EQ(warmList[i].path.find("<userId>"), std::string::npos);
+    }
+
+    std::vector<DirInfo> otherUserList;
+    ASSERT_EQ(UserPathResolver::GetUserBasePath(userId_ + 1, flags, otherUserList), E_OK);
+    ASSERT_EQ(otherUserList.size(), warmList.size());
+    for (size_t i = 0; i < otherUserList.size(); i++) {
+        EXPECT_NE(otherUserList[i].path.find(std::to_string(userId_ + 1)), std::string::npos);
+    }
+
+    std::vector<DirInfo> dirInfoList;
+    CreateFile(string(STORAGE_ETC_PATH) + STORAGE_USER_PATH, "{[]}");
+    EXPECT_EQ(UserPathResolver::GetUserBasePath(userId_, flags, dirInfoList), E_JSON_PARSE_ERROR);
+    DeleteFile(string(STORAGE_ETC_PATH) + STORAGE_USER_PATH);
+    EXPECT_EQ(UserPathResolver::GetUserBasePath(userId_, flags, dirInfoList), E_OK);
+}
+
 } // Test
 } // STORAGE_DAEMON
 } // OHOS
\ No newline at end of file
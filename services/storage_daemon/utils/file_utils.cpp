@@ -16,13 +16,26 @@
 #include "utils/file_utils.h"
 #include "utils/volume_op_diag.h"
 
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <condition_variable>
+#include <csignal>
 #include <cstdint>
+#include <deque>
 #include <dirent.h>
 #include <fcntl.h>
 #include <fstream>
+#include <mutex>
+#include <poll.h>
+#include <pthread.h>
 #include <regex>
+#include <spawn.h>
+#include <thread>
 #include <sys/stat.h>
+#include <sys/syscall.h>
 #include <sys/wait.h>
+#include <sys/xattr.h>
 #include <unistd.h>
 #include "file_ex.h"
 #include "parameters.h"
@@ -32,6 +45,7 @@
 #include "string_ex.h"
 #include "utils/storage_radar.h"
 #include "utils/hi_audit.h"
+#include "utils/mount_table.h"
 #ifdef USE_LIBRESTORECON
 #include "policycoreutils.h"
 #endif
@@ -49,13 +63,23 @@ constexpr int SET_SCHED_LOAD_TRANS_TYPE = 10001;
 #endif
 constexpr int BUF_LEN = 20480;
 constexpr int PIPE_FD_LEN = 2;
+constexpr size_t CHILD_STREAM_COUNT = 2;
+constexpr size_t CHILD_DRAIN_READS = 16;
+constexpr int CHILD_POLL_TICK_MS = 50;
+constexpr int CHILD_EXEC_FAILED_EXIT = 127;
 constexpr int UUID_LENGTH = 36;
 constexpr int UUID_PREFIX_LENGTH = 4;
 constexpr int UUID_PREFIX_SUFFIX_LENGTH = 8;
 constexpr uint8_t KILL_RETRY_TIME = 5;
 constexpr uint32_t KILL_RETRY_INTERVAL_MS = 100 * 1000;
 constexpr int32_t MAX_STATISTICS_FILES_NUMBER = 5120000;
-constexpr const char *MOUNT_POINT_INFO = "/proc/mounts";
+constexpr size_t RM_MAX_WORKERS = 4;
+constexpr size_t RM_TASKS_PER_WORKER = 4;
+constexpr uint32_t RM_MAX_SPLIT_DEPTH = 3;
+constexpr const char *RM_TRASH_PREFIX = ".sd_trash.";
+constexpr size_t TREE_FIX_MAX_WORKERS = 4;
+constexpr size_t TREE_FIX_MAX_QUEUED_DIRS = 256;
+constexpr const char *RM_TRASH_JOURNAL = "/data/service/el0/storage_daemon/rm_trash_journal";
 #define RGM_MANAGER_PATH_DEF  "/data/service/el1/public/rgm_manager/data"
 #define RGM_STATE_PRE_DEF "virt_service.rgm_state."
 const std::string CONTAINER_HMOS = "rgm_hmos";
@@ -344,49 +368,642 @@ bool PrepareDir(const std::string &path, mode_t mode, uid_t uid, gid_t gid)
     return RestoreconDir(path);
 }
 
+namespace {
+struct RmDirTask {
+    int parentFd;
+    std::string name;
+};
+
+struct RmSplitDir {
+    int parentFd;
+    std::string name;
+    int fd;
+};
+
+bool IsDotEntry(const char *name)
+{
+    return strcmp(name, ".") == 0 || strcmp(name, "..") == 0;
+}
+
+int OpenDirAt(int parentFd, const char *name)
+{
+    return openat(parentFd, name, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+}
+
+unsigned char EntryTypeAt(int parentFd, const char *name, unsigned char type)
+{
+    if (type != DT_UNKNOWN) {
+        return type;
+    }
+    struct stat st;
+    if (fstatat(parentFd, name, &st, AT_SYMLINK_NOFOLLOW) != 0) {
+        return DT_UNKNOWN;
+    }
+    if (S_ISDIR(st.st_mode)) {
+        return DT_DIR;
+    }
+    return S_ISREG(st.st_mode) ? DT_REG : DT_LNK;
+}
+
+bool RemoveDirAt(int parentFd, const char *name, bool lenient);
+
+// lenient is DeleteFile's contract: only regular files and directories go, failures are skipped.
+bool RemoveEntryAt(int parentFd, const char *name, unsigned char type, bool lenient)
+{
+    type = EntryTypeAt(parentFd, name, type);
+    if (type == DT_DIR) {
+        return RemoveDirAt(parentFd, name, lenient);
+    }
+    if (lenient && type != DT_REG) {
+        return true;
+    }
+    return unlinkat(parentFd, name, 0) == 0 || errno == ENOENT;
+}
+
+// Removes everything below dirFd and closes it.
+bool ClearDirFd(int dirFd, bool lenient)
+{
+    DIR *dir = fdopendir(dirFd);
+    if (dir == nullptr) {
+        int err = errno;
+        (void)close(dirFd);
+        errno = err;
+        return false;
+    }
+    bool ret = true;
+    for (struct dirent *ent = readdir(dir); ent != nullptr; ent = readdir(dir)) {
+        if (IsDotEntry(ent->d_name)) {
+            continue;
+        }
+        if (!RemoveEntryAt(dirfd(dir), ent->d_name, ent->d_type, lenient) && !lenient) {
+            LOGE("[L8:FileUtils] RmDirRecurse: remove %{public}s failed, errno=%{public}d", ent->d_name, errno);
+            ret = false;
+            break;
+        }
+    }
+    int err = errno;
+    (void)closedir(dir);
+    errno = err;
+    return ret;
+}
+
+bool RemoveDirAt(int parentFd, const char *name, bool lenient)
+{
+    int fd = OpenDirAt(parentFd, name);
+    if (fd < 0) {
+        return errno == ENOENT;
+    }
+    if (!ClearDirFd(fd, lenient)) {
+        return false;
+    }
+    return unlinkat(parentFd, name, AT_REMOVEDIR) == 0 || errno == ENOENT;
+}
+
+bool SplitParentPath(const std::string &path, std::string &parent, std::string &name)
+{
+    std::string trimmed = path;
+    while (trimmed.size() > 1 && trimmed.back() == '/') {
+        trimmed.pop_back();
+    }
+    size_t pos = trimmed.rfind('/');
+    if (pos == std::string::npos) {
+        parent = ".";
+        name = trimmed;
+    } else {
+        parent = (pos == 0) ? "/" : trimmed.substr(0, pos);
+        name = trimmed.substr(pos + 1);
+    }
+    return !name.empty() && name != "/" && !IsDotEntry(name.c_str());
+}
+
+/*
+ * Removes a tree with fd-relative calls. The top of the tree is split breadth-first into
+ * independent subtrees which a bounded set of workers remove concurrently; the split
+ * directories themselves are removed afterwards, deepest first.
+ */
+class ParallelRemover {
+public:
+    bool Run(int parentFd, const std::string &name)
+    {
+        if (!Split(parentFd, name)) {
+            Finish(false);
+            return false;
+        }
+        size_t workers = std::min<size_t>(tasks_.size(), RM_MAX_WORKERS);
+        std::vector<std::thread> threads;
+        for (size_t i = 1; i < workers; i++) {
+            threads.emplace_back([this]() { Work(); });
+        }
+        Work();
+        for (auto &thread : threads) {
+            thread.join();
+        }
+        return Finish(!failed_.load());
+    }
+
+private:
+    bool Split(int parentFd, const std::string &name)
+    {
+        tasks_.push_back({parentFd, name});
+        for (uint32_t depth = 0; depth < RM_MAX_SPLIT_DEPTH && !tasks_.empty() &&
+            tasks_.size() < RM_MAX_WORKERS * RM_TASKS_PER_WORKER; depth++) {
+            std::vector<RmDirTask> level;
+            level.swap(tasks_);
+            for (const auto &task : level) {
+                if (!ExpandDir(task)) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    bool ExpandDir(const RmDirTask &task)
+    {
+        int fd = OpenDirAt(task.parentFd, task.name.c_str());
+        if (fd < 0) {
+            return errno == ENOENT;
+        }
+        DIR *dir = fdopendir(fd);
+        if (dir == nullptr) {
+            (void)close(fd);
+            return false;
+        }
+        int keepFd = dup(fd);
+        bool ret = keepFd >= 0;
+        for (struct dirent *ent = ret ? readdir(dir) : nullptr; ent != nullptr; ent = readdir(dir)) {
+            if (IsDotEntry(ent->d_name)) {
+                continue;
+            }
+            unsigned char type = EntryTypeAt(keepFd, ent->d_name, ent->d_type);
+            if (type == DT_DIR) {
+                tasks_.push_back({keepFd, ent->d_name});
+            } else if (unlinkat(keepFd, ent->d_name, 0) != 0 && errno != ENOENT) {
+                ret = false;
+                break;
+            }
+        }
+        int err = errno;
+        (void)closedir(dir);
+        if (keepFd >= 0) {
+            split_.push_back({task.parentFd, task.name, keepFd});
+        }
+        errno = err;
+        return ret;
+    }
+
+    void Work()
+    {
+        for (size_t i = next_++; i < tasks_.size() && !failed_.load(); i = next_++) {
+            if (!RemoveDirAt(tasks_[i].parentFd, tasks_[i].name.c_str(), false)) {
+                int expected = 0;
+                (void)firstErrno_.compare_exchange_strong(expected, errno);
+                failed_.store(true);
+            }
+        }
+    }
+
+    bool Finish(bool ret)
+    {
+        for (auto it = split_.rbegin(); it != split_.rend(); ++it) {
+            (void)close(it->fd);
+            if (ret && unlinkat(it->parentFd, it->name.c_str(), AT_REMOVEDIR) != 0 && errno != ENOENT) {
+                firstErrno_.store(errno);
+                ret = false;
+            }
+        }
+        if (!ret && firstErrno_.load() != 0) {
+            errno = firstErrno_.load();
+        }
+        return ret;
+    }
+
+    std::vector<RmDirTask> tasks_;
+    std::vector<RmSplitDir> split_;
+    std::atomic<size_t> next_ { 0 };
+    std::atomic<bool> failed_ { false };
+    std::atomic<int> firstErrno_ { 0 };
+};
+
+class DeferredRemover {
+public:
+    static DeferredRemover &GetInstance()
+    {
+        static DeferredRemover instance;
+        return instance;
+    }
+
+    bool Remove(const std::string &path)
+    {
+        std::string parent;
+        std::string name;
+        if (!SplitParentPath(path, parent, name)) {
+            return RmDirRecurse(path);
+        }
+        struct stat st;
+        if (lstat(path.c_str(), &st) != 0 && errno == ENOENT) {
+            return true;
+        }
+        auto now = std::chrono::steady_clock::now().time_since_epoch();
+        std::string trash = (parent == "/" ? "" : parent) + "/" + RM_TRASH_PREFIX + name + "." +
+            std::to_string(std::chrono::duration_cast<std::chrono::nanoseconds>(now).count());
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            // The journal entry must be durable before the rename, so a crash leaves nothing unaccounted for.
+            if (AppendJournal(trash) && rename(path.c_str(), trash.c_str()) == 0) {
+                pending_.push_back(trash);
+                StartWorkerLocked();
+                return true;
+            }
+        }
+        LOGW("[L8:FileUtils] RmDirRecurseDeferred: move %{public}s to trash failed, errno=%{public}d,"
+            "removing in place", path.c_str(), errno);
+        return RmDirRecurse(path);
+    }
+
+    void Resume()
+    {
+        std::string content;
+        if (!ReadFile(journal_, &content) || content.empty()) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::istringstream stream(content);
+        for (std::string line; std::getline(stream, line);) {
+            // Only ever remove what Remove renamed; a damaged journal must not name anything else.
+            std::string parent;
+            std::string name;
+            if (!SplitParentPath(line, parent, name) ||
+                name.compare(0, strlen(RM_TRASH_PREFIX), RM_TRASH_PREFIX) != 0) {
+                LOGE("[L8:FileUtils] ResumeDeferredRemoval: skip bad journal entry %{public}s", line.c_str());
+                continue;
+            }
+            pending_.push_back(line);
+        }
+        LOGI("[L8:FileUtils] ResumeDeferredRemoval: %{public}zu trash dirs left by the last run", pending_.size());
+        if (pending_.empty()) {
+            (void)unlink(journal_.c_str());
+        }
+        StartWorkerLocked();
+    }
+
+    void SetJournal(const std::string &journal)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        journal_ = journal;
+    }
+
+private:
+    bool AppendJournal(const std::string &trash)
+    {
+        int fd = open(journal_.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, S_IRUSR | S_IWUSR);
+        if (fd < 0) {
+            return false;
+        }
+        std::string line = trash + "\n";
+        bool ret = write(fd, line.c_str(), line.size()) == static_cast<ssize_t>(line.size()) && fsync(fd) == 0;
+        int err = errno;
+        (void)close(fd);
+        errno = err;
+        return ret;
+    }
+
+    void StartWorkerLocked()
+    {
+        if (running_ || pending_.empty()) {
+            return;
+        }
+        running_ = true;
+        std::thread worker([this]() { Drain(); });
+        worker.detach();
+    }
+
+    void Drain()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!pending_.empty()) {
+            std::string trash = pending_.front();
+            pending_.pop_front();
+            lock.unlock();
+            bool ret = RmDirRecurse(trash);
+            int err = errno;
+            lock.lock();
+            if (!ret) {
+                // The caller returned long ago; the journal keeps the entry for the next start and radar reports it.
+                LOGE("[L8:FileUtils] RmDirRecurseDeferred: remove %{public}s failed, errno=%{public}d",
+                    trash.c_str(), err);
+                std::string extraData = "path=" + trash + ",errno=" + to_string(err);
+                StorageRadar::ReportUserManager("RmDirRecurseDeferred", DEFAULT_USERID, E_DESTROY_DIR, extraData);
+                failed_.push_back(trash);
+            }
+        }
+        // Everything queued is gone; only failures stay in the journal for the next start.
+        std::string remain;
+        for (const auto &trash : failed_) {
+            remain += trash + "\n";
+        }
+        failed_.clear();
+        if (remain.empty()) {
+            (void)unlink(journal_.c_str());
+        } else if (!SaveStringToFile(journal_, remain, true)) {
+            LOGE("[L8:FileUtils] RmDirRecurseDeferred: rewrite trash journal failed, errno=%{public}d", errno);
+        }
+        running_ = false;
+    }
+
+    std::mutex mutex_;
+    std::string journal_ = RM_TRASH_JOURNAL;
+    std::deque<std::string> pending_;
+    std::vector<std::string> failed_;
+    bool running_ = false;
+};
+} // namespace
+
 bool RmDirRecurse(const std::string &path)
 {
     LOGD("[L8:FileUtils] RmDirRecurse: >>> ENTER <<< path=%{public}s", path.c_str());
-    DIR *dir = opendir(path.c_str());
-    if (!dir) {
+    std::string parent;
+    std::string name;
+    if (!SplitParentPath(path, parent, name)) {
+        LOGE("[L8:FileUtils] RmDirRecurse: <<< EXIT FAILED <<< invalid path %{public}s", path.c_str());
+        errno = EINVAL;
+        return false;
+    }
+    int parentFd = open(parent.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (parentFd < 0) {
         if (errno == ENOENT) {
             LOGD("[L8:FileUtils] RmDirRecurse: <<< EXIT SUCCESS <<< path not exist");
             return true;
         }
         LOGE("[L8:FileUtils] RmDirRecurse: <<< EXIT FAILED <<< open dir %{public}s failed, errno=%{public}d",
-            path.c_str(), errno);
+            parent.c_str(), errno);
         return false;
     }
+    ParallelRemover remover;
+    bool ret = remover.Run(parentFd, name);
+    int err = errno;
+    (void)close(parentFd);
+    if (!ret) {
+        LOGE("[L8:FileUtils] RmDirRecurse: <<< EXIT FAILED <<< remove %{public}s failed, errno=%{public}d",
+            path.c_str(), err);
+    }
+    errno = err;
+    return ret;
+}
 
-    for (struct dirent *ent = readdir(dir); ent != nullptr; ent = readdir(dir)) {
-        if (ent->d_type == DT_DIR) {
-            if (strcmp(ent->d_name, ".") == 0 || strcmp(ent->d_name, "..") == 0) {
-                continue;
+bool RmDirRecurseDeferred(const std::string &path)
+{
+    return DeferredRemover::GetInstance().Remove(path);
+}
+
+void ResumeDeferredRemoval()
+{
+    DeferredRemover::GetInstance().Resume();
+}
+
+void SetDeferredRemovalJournal(const std::string &journal)
+{
+    DeferredRemover::GetInstance().SetJournal(journal);
+}
+
+namespace {
+struct TreeFixDir {
+    int fd;
+    std::string path;
+};
+
+/*
+ * Applies a TreeFixSpec below an open root. Directories are fixed through their own fd,
+ * everything else with fstatat/fchownat/fchmodat relative to the parent, and nothing is
+ * written when the attributes already match. Subdirectories go to a shared queue that a
+ * bounded set of workers drains; once the queue is full a worker descends inline, which
+ * keeps the number of open fds bounded by the queue limit plus the tree depth.
+ */
+class TreeFixer {
+public:
+    explicit TreeFixer(const TreeFixSpec &spec) : spec_(spec) {}
+
+    void Run(int rootFd, const std::string &rootPath, TreeFixResult &result)
+    {
+        ProcessDir({rootFd, rootPath}, result);
+        size_t workers = 0;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            workers = queue_.empty() ? 0 : TREE_FIX_MAX_WORKERS;
+        }
+        std::vector<TreeFixResult> partial(workers);
+        std::vector<std::thread> threads;
+        for (size_t i = 1; i < workers; i++) {
+            threads.emplace_back([this, &partial, i]() { Work(partial[i]); });
+        }
+        if (workers > 0) {
+            Work(partial[0]);
+        }
+        for (auto &thread : threads) {
+            thread.join();
+        }
+        for (const auto &part : partial) {
+            result.changed += part.changed;
+            result.skipped += part.skipped;
+            result.failed += part.failed;
+            result.pruned += part.pruned;
+        }
+    }
+
+    int FirstErrno() const
+    {
+        return firstErrno_.load();
+    }
+
+private:
+    void Work(TreeFixResult &result)
+    {
+        TreeFixDir dir;
+        while (Pop(dir)) {
+            ProcessDir(dir, result);
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (--active_ == 0 && queue_.empty()) {
+                cv_.notify_all();
             }
+        }
+    }
 
-            if (!RmDirRecurse(path + "/" + ent->d_name)) {
-                LOGE("[L8:FileUtils] RmDirRecurse: <<< EXIT FAILED <<< RmDirRecurse %{public}s failed,"
-                    "errno=%{public}d", path.c_str(), errno);
-                (void)closedir(dir);
-                return false;
+    bool Pop(TreeFixDir &dir)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this]() { return !queue_.empty() || active_ == 0; });
+        if (queue_.empty()) {
+            return false;
+        }
+        dir = std::move(queue_.front());
+        queue_.pop_front();
+        active_++;
+        return true;
+    }
+
+    void PushOrDescend(TreeFixDir dir, TreeFixResult &result)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (queue_.size() < TREE_FIX_MAX_QUEUED_DIRS) {
+                queue_.push_back(std::move(dir));
+                cv_.notify_one();
+                return;
             }
+        }
+        ProcessDir(dir, result);
+    }
+
+    bool IsPruned(int fd) const
+    {
+        if (spec_.pruneXattr.empty()) {
+            return false;
+        }
+        std::string value(spec_.pruneValue.size() + 1, '\0');
+        ssize_t len = fgetxattr(fd, spec_.pruneXattr.c_str(), value.data(), value.size());
+        return len == static_cast<ssize_t>(spec_.pruneValue.size()) &&
+            value.compare(0, len, spec_.pruneValue) == 0;
+    }
+
+    // Takes ownership of dir.fd.
+    void ProcessDir(const TreeFixDir &dir, TreeFixResult &result)
+    {
+        if (IsPruned(dir.fd)) {
+            result.pruned++;
+            (void)close(dir.fd);
+            return;
+        }
+        struct stat st;
+        if (fstat(dir.fd, &st) != 0) {
+            Fail(dir.path, result);
         } else {
-            if (unlink((path + "/" + ent->d_name).c_str())) {
-                LOGE("[L8:FileUtils] RmDirRecurse: <<< EXIT FAILED <<< unlink file %{public}s failed, errno=%{public}d",
-                    ent->d_name, errno);
-                (void)closedir(dir);
-                return false;
+            FixAttrs(st, dir.path, result,
+                [&dir](uid_t uid, gid_t gid) { return fchown(dir.fd, uid, gid); },
+                [&dir](mode_t mode) { return fchmod(dir.fd, mode); });
+        }
+        DIR *d = fdopendir(dir.fd);
+        if (d == nullptr) {
+            Fail(dir.path, result);
+            (void)close(dir.fd);
+            return;
+        }
+        int fd = dirfd(d);
+        for (struct dirent *ent = readdir(d); ent != nullptr; ent = readdir(d)) {
+            if (IsDotEntry(ent->d_name)) {
+                continue;
+            }
+            std::string path = dir.path + "/" + ent->d_name;
+            if (EntryTypeAt(fd, ent->d_name, ent->d_type) == DT_DIR) {
+                int subFd = OpenDirAt(fd, ent->d_name);
+                if (subFd >= 0) {
+                    PushOrDescend({subFd, std::move(path)}, result);
+                } else if (errno != ENOENT) {
+                    Fail(path, result);
+                }
+                continue;
             }
+            FixEntryAt(fd, ent->d_name, path, result);
         }
+        (void)closedir(d);
     }
 
-    (void)closedir(dir);
-    if (rmdir(path.c_str())) {
-        LOGE("[L8:FileUtils] RmDirRecurse: <<< EXIT FAILED <<< rmdir dir %{public}s failed, errno=%{public}d",
+    void FixEntryAt(int dirFd, const char *name, const std::string &path, TreeFixResult &result)
+    {
+        struct stat st;
+        if (fstatat(dirFd, name, &st, AT_SYMLINK_NOFOLLOW) != 0) {
+            if (errno != ENOENT) {
+                Fail(path, result);
+            }
+            return;
+        }
+        FixAttrs(st, path, result,
+            [dirFd, name](uid_t uid, gid_t gid) { return fchownat(dirFd, name, uid, gid, AT_SYMLINK_NOFOLLOW); },
+            [dirFd, name](mode_t mode) {
+                int ret = fchmodat(dirFd, name, mode, AT_SYMLINK_NOFOLLOW);
+                // Without in-libc emulation the flag is unsupported; the entry is known not to be a symlink.
+                if (ret != 0 && (errno == ENOTSUP || errno == EOPNOTSUPP)) {
+                    ret = fchmodat(dirFd, name, mode, 0);
+                }
+                return ret;
+            });
+    }
+
+    template <typename ChownFunc, typename ChmodFunc>
+    void FixAttrs(struct stat &st, const std::string &path, TreeFixResult &result, ChownFunc chown, ChmodFunc chmod)
+    {
+        bool changed = false;
+        bool ok = true;
+        if (spec_.setOwner && (st.st_uid != spec_.uid || st.st_gid != spec_.gid)) {
+            if (chown(spec_.uid, spec_.gid) == 0) {
+                changed = true;
+                // chown drops set-id bits on non-directories, so compare the mode against that.
+                if (!S_ISDIR(st.st_mode)) {
+                    st.st_mode &= ~(S_ISUID | S_ISGID);
+                }
+            } else {
+                ok = false;
+            }
+        }
+        if (spec_.setMode && !S_ISLNK(st.st_mode)) {
+            mode_t mode = S_ISDIR(st.st_mode) ? spec_.dirMode : spec_.fileMode;
+            if ((st.st_mode & ALL_PERMS) != mode) {
+                if (chmod(mode) == 0) {
+                    changed = true;
+                } else {
+                    ok = false;
+                }
+            }
+        }
+        if (spec_.relabel && spec_.relabel(path) != E_OK) {
+            ok = false;
+        }
+        if (!ok) {
+            Fail(path, result);
+        } else if (changed) {
+            result.changed++;
+        } else {
+            result.skipped++;
+        }
+    }
+
+    void Fail(const std::string &path, TreeFixResult &result)
+    {
+        int expected = 0;
+        if (firstErrno_.compare_exchange_strong(expected, errno == 0 ? EIO : errno)) {
+            LOGE("[L8:FileUtils] FixTreeAttrs: fix %{public}s failed, errno=%{public}d", path.c_str(), errno);
+        }
+        result.failed++;
+    }
+
+    const TreeFixSpec &spec_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<TreeFixDir> queue_;
+    size_t active_ = 0;
+    std::atomic<int> firstErrno_ { 0 };
+};
+} // namespace
+
+int32_t FixTreeAttrs(const std::string &path, const TreeFixSpec &spec, TreeFixResult &result)
+{
+    LOGD("[L8:FileUtils] FixTreeAttrs: >>> ENTER <<< path=%{public}s", path.c_str());
+    result = {};
+    int rootFd = open(path.c_str(), O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+    if (rootFd < 0) {
+        LOGE("[L8:FileUtils] FixTreeAttrs: <<< EXIT FAILED <<< invalid path %{public}s, errno=%{public}d",
             path.c_str(), errno);
-        return false;
+        return E_ERR;
     }
-    return true;
+    TreeFixer fixer(spec);
+    fixer.Run(rootFd, path, result);
+    LOGI("[L8:FileUtils] FixTreeAttrs: path=%{public}s, changed=%{public}" PRIu64 ", skipped=%{public}" PRIu64
+        ", failed=%{public}" PRIu64 ", pruned=%{public}" PRIu64, path.c_str(), result.changed, result.skipped,
+        result.failed, result.pruned);
+    if (result.failed != 0) {
+        errno = fixer.FirstErrno();
+        return E_ERR;
+    }
+    return E_OK;
 }
 
 void TravelChmod(const std::string &path, mode_t mode)
@@ -669,20 +1286,6 @@ std::string ReadFileInParentDirs(const std::string &startPath, const std::string
     return "";
 }
 
-static std::vector<char*> FormatCmd(std::vector<std::string> &cmd)
-{
-    std::vector<char*>res;
-    res.reserve(cmd.size() + 1);
-
-    for (auto& line : cmd) {
-        LOGE("[L8:FileUtils] FromatCmd: cmd=%{public}s", line.c_str());
-        res.emplace_back(const_cast<char*>(line.c_str()));
-    }
-    res.emplace_back(nullptr);
-
-    return res;
-}
-
 static void ClosePipe(int pipedes[PIPE_FD_LEN], size_t len)
 {
     if (pipedes == nullptr || len < PIPE_FD_LEN) {
@@ -700,62 +1303,291 @@ void GetExitStatus(int *exitStatus, int inputExitStatus)
     }
 }
 
-static void ReadPipeOutputForExec(int pipeFdRead, std::vector<std::string> *output, const std::string &cmdName)
+static void CloseFd(int &fd)
 {
-    if (!output) {
-        return;
+    if (fd >= 0) {
+        (void)close(fd);
+        fd = -1;
     }
-    char buf[BUF_LEN] = { 0 };
-    output->clear();
-    ssize_t bytesRead = 0;
-    while ((bytesRead = read(pipeFdRead, buf, BUF_LEN - 1)) > 0) {
-        buf[bytesRead] = '\0';
-        LOGE("[L8:FileUtils] ReadPipeOutputForExec: cmd=%{public}s", cmdName.c_str());
-        output->emplace_back(buf, bytesRead);
-        (void)memset_s(buf, sizeof(buf), 0, sizeof(buf));
+}
+
+// The read end stays in the daemon and never blocks; the write end only reaches the child through dup2.
+static int32_t OpenChildPipe(int pipeFd[PIPE_FD_LEN])
+{
+    if (pipe2(pipeFd, O_CLOEXEC) != 0) {
+        return E_CREATE_PIPE;
+    }
+    int flags = fcntl(pipeFd[0], F_GETFL);
+    if (flags < 0 || fcntl(pipeFd[0], F_SETFL, flags | O_NONBLOCK) < 0) {
+        int err = errno;
+        ClosePipe(pipeFd, PIPE_FD_LEN);
+        pipeFd[0] = -1;
+        pipeFd[1] = -1;
+        errno = err;
+        return E_CREATE_PIPE;
+    }
+    return E_OK;
+}
+
+static int PidfdOpen(pid_t pid)
+{
+#ifdef SYS_pidfd_open
+    return static_cast<int>(syscall(SYS_pidfd_open, pid, 0));
+#else
+    errno = ENOSYS;
+    return -1;
+#endif
+}
+
+// posix_spawn clones with CLONE_VM|CLONE_VFORK, so the daemon's page tables are not copied and nothing
+// but the exec runs in the child. Returns 0 or the errno of the failed spawn/exec.
+static int SpawnChild(const std::vector<std::string> &cmd, const ChildRunOptions &options, int outFd, int errFd,
+                      pid_t &pid)
+{
+    std::vector<char *> args;
+    args.reserve(cmd.size() + 1);
+    for (const auto &arg : cmd) {
+        args.push_back(const_cast<char *>(arg.c_str()));
+    }
+    args.push_back(nullptr);
+
+    posix_spawn_file_actions_t actions;
+    posix_spawnattr_t attr;
+    if (posix_spawn_file_actions_init(&actions) != 0) {
+        return ENOMEM;
+    }
+    if (posix_spawnattr_init(&attr) != 0) {
+        (void)posix_spawn_file_actions_destroy(&actions);
+        return ENOMEM;
+    }
+    if (options.stdinFd >= 0) {
+        (void)posix_spawn_file_actions_adddup2(&actions, options.stdinFd, STDIN_FILENO);
+    }
+    (void)posix_spawn_file_actions_adddup2(&actions, outFd, STDOUT_FILENO);
+    if (options.mergeErr) {
+        (void)posix_spawn_file_actions_adddup2(&actions, outFd, STDERR_FILENO);
+    } else if (errFd >= 0) {
+        (void)posix_spawn_file_actions_adddup2(&actions, errFd, STDERR_FILENO);
+    }
+    sigset_t mask;
+    (void)sigemptyset(&mask);
+    (void)posix_spawnattr_setsigmask(&attr, &mask);
+    short flags = POSIX_SPAWN_SETSIGMASK;
+    if (options.newGroup) {
+        flags |= POSIX_SPAWN_SETPGROUP;
+        (void)posix_spawnattr_setpgroup(&attr, 0);
+    }
+    (void)posix_spawnattr_setflags(&attr, flags);
+    int ret = posix_spawnp(&pid, args[0], &actions, &attr, args.data(), environ);
+    (void)posix_spawnattr_destroy(&attr);
+    (void)posix_spawn_file_actions_destroy(&actions);
+    return ret;
+}
+
+struct ChildStream {
+    int fd = -1;
+    size_t cap = 0;
+    std::string *text = nullptr;
+    size_t *dropped = nullptr;
+    const ChildOutputHook *hook = nullptr;
+};
+
+static thread_local ChildOutputHook g_threadOutputHook;
+
+ChildOutputHook SetThreadChildOutputHook(ChildOutputHook hook)
+{
+    std::swap(g_threadOutputHook, hook);
+    return hook;
+}
+
+// One read of whatever is ready; bytes past the cap are dropped so the child never blocks on a full pipe.
+static bool ReadChildStream(ChildStream &stream, std::vector<char> &buf)
+{
+    if (stream.fd < 0) {
+        return false;
+    }
+    ssize_t n = TEMP_FAILURE_RETRY(read(stream.fd, buf.data(), buf.size()));
+    if (n > 0) {
+        if (stream.hook != nullptr && *stream.hook) {
+            (*stream.hook)(buf.data(), static_cast<size_t>(n));
+        }
+        size_t room = stream.cap > stream.text->size() ? stream.cap - stream.text->size() : 0;
+        size_t keep = std::min(room, static_cast<size_t>(n));
+        stream.text->append(buf.data(), keep);
+        *stream.dropped += static_cast<size_t>(n) - keep;
+        return true;
+    }
+    if (n == 0 || errno != EAGAIN) {
+        CloseFd(stream.fd);
+    }
+    return false;
+}
+
+static int32_t ReapChild(pid_t pid, int options, bool &exited, ChildRunResult &result)
+{
+    pid_t ret = TEMP_FAILURE_RETRY(waitpid(pid, &result.status, options));
+    if (ret == pid) {
+        exited = true;
+        return E_OK;
+    }
+    if (ret == 0) {
+        return E_OK;
+    }
+    result.error = errno;
+    exited = true;
+    return errno == ECHILD ? E_NO_CHILD : E_SYS_KERNEL_ERR;
+}
+
+static int PollTimeoutMs(bool armed, std::chrono::steady_clock::time_point deadline, bool hasPidfd)
+{
+    int waitMs = -1;
+    if (armed) {
+        auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+        waitMs = static_cast<int>(std::max<int64_t>(left.count(), 0));
+    }
+    // Without a pidfd the exit can only be seen by polling waitpid.
+    if (!hasPidfd) {
+        waitMs = waitMs < 0 ? CHILD_POLL_TICK_MS : std::min(waitMs, CHILD_POLL_TICK_MS);
+    }
+    return waitMs;
+}
+
+/*
+ * Polls the output pipes and a pidfd for the child until it is reaped. At the deadline the child (or its
+ * group) gets SIGTERM, and SIGKILL once termGraceMs has passed; the exit is not waited for through EOF,
+ * so a grandchild holding the pipes open cannot stall the daemon.
+ */
+static int32_t WaitChild(pid_t pid, const ChildRunOptions &options, ChildStream (&streams)[CHILD_STREAM_COUNT],
+                         ChildRunResult &result)
+{
+    int pidFd = PidfdOpen(pid);
+    bool armed = options.timeoutMs >= 0;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(std::max(options.timeoutMs, 0));
+    pid_t target = options.newGroup ? -pid : pid;
+    std::vector<char> buf(BUF_LEN);
+    bool exited = false;
+    int32_t ret = E_OK;
+    while (!exited) {
+        pollfd fds[CHILD_STREAM_COUNT + 1] = {};
+        for (size_t i = 0; i < CHILD_STREAM_COUNT; i++) {
+            fds[i].fd = streams[i].fd;
+            fds[i].events = POLLIN;
+        }
+        fds[CHILD_STREAM_COUNT].fd = pidFd;
+        fds[CHILD_STREAM_COUNT].events = POLLIN;
+        if (poll(fds, CHILD_STREAM_COUNT + 1, PollTimeoutMs(armed, deadline, pidFd >= 0)) < 0 && errno != EINTR) {
+            LOGE("[L8:FileUtils] RunChild: poll failed, errno=%{public}d, kill pid=%{public}d", errno, pid);
+            (void)kill(target, SIGKILL);
+            break;
+        }
+        for (size_t i = 0; i < CHILD_STREAM_COUNT; i++) {
+            if (fds[i].revents != 0) {
+                (void)ReadChildStream(streams[i], buf);
+            }
+        }
+        if (pidFd < 0 || fds[CHILD_STREAM_COUNT].revents != 0) {
+            ret = ReapChild(pid, WNOHANG, exited, result);
+        }
+        if (exited || !armed || std::chrono::steady_clock::now() < deadline) {
+            continue;
+        }
+        bool term = !result.timedOut && options.termGraceMs > 0;
+        LOGE("[L8:FileUtils] RunChild: pid=%{public}d over deadline, send %{public}s", pid,
+             term ? "SIGTERM" : "SIGKILL");
+        (void)kill(target, term ? SIGTERM : SIGKILL);
+        result.timedOut = true;
+        armed = term;
+        deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(options.termGraceMs);
+    }
+    if (!exited) {
+        ret = ReapChild(pid, 0, exited, result);
+    }
+    CloseFd(pidFd);
+    for (auto &stream : streams) {
+        for (size_t i = 0; i < CHILD_DRAIN_READS && ReadChildStream(stream, buf); i++) {
+        }
     }
+    return ret;
 }
 
-static int CheckChildProcessExitStatus(pid_t pid, int &status, int *exitStatus)
+int32_t RunChild(const std::vector<std::string> &cmd, const ChildRunOptions &options, ChildRunResult &result)
 {
-    status = 0;
-    pid_t waitRet = waitpid(pid, &status, 0);
-    if (waitRet == -1) {
-        if (errno == ECHILD) {
-            LOGE("[L8:FileUtils] CheckChildProcessExitStatus: ECHILD");
-            return E_NO_CHILD;
+    result = ChildRunResult();
+    if (cmd.empty()) {
+        LOGE("[L8:FileUtils] RunChild: <<< EXIT FAILED <<< cmd is empty");
+        return E_PARAMS_INVALID;
+    }
+    int outPipe[PIPE_FD_LEN] = { -1, -1 };
+    int errPipe[PIPE_FD_LEN] = { -1, -1 };
+    bool splitErr = options.captureErr && !options.mergeErr;
+    if (OpenChildPipe(outPipe) != E_OK || (splitErr && OpenChildPipe(errPipe) != E_OK)) {
+        result.error = errno;
+        LOGE("[L8:FileUtils] RunChild: <<< EXIT FAILED <<< create pipe failed, errno=%{public}d, cmd=%{public}s",
+             result.error, cmd[0].c_str());
+        CloseFd(outPipe[0]);
+        CloseFd(outPipe[1]);
+        return E_CREATE_PIPE;
+    }
+    pid_t pid = -1;
+    int spawnErr = SpawnChild(cmd, options, outPipe[1], errPipe[1], pid);
+    CloseFd(outPipe[1]);
+    CloseFd(errPipe[1]);
+    if (spawnErr != 0) {
+        CloseFd(outPipe[0]);
+        CloseFd(errPipe[0]);
+        result.error = spawnErr;
+        LOGE("[L8:FileUtils] RunChild: <<< EXIT FAILED <<< spawn failed, errno=%{public}d, cmd=%{public}s",
+             spawnErr, cmd[0].c_str());
+        if (spawnErr == ENOMEM || spawnErr == EAGAIN) {
+            return E_FORK;
         }
-        LOGE("[L8:FileUtils] CheckChildProcessExitStatus: waitpid failed, errno=%{public}d", errno);
-        return E_SYS_KERNEL_ERR;
+        result.status = W_EXITCODE(CHILD_EXEC_FAILED_EXIT, 0);
+        return E_OK;
     }
+    if (options.onSpawn) {
+        options.onSpawn(pid);
+    }
+    ChildStream streams[CHILD_STREAM_COUNT] = {
+        { outPipe[0], options.outCap, &result.out, &result.outDropped, &options.onOutput },
+        { errPipe[0], options.errCap, &result.err, &result.errDropped, nullptr },
+    };
+    int32_t ret = WaitChild(pid, options, streams, result);
+    for (auto &stream : streams) {
+        CloseFd(stream.fd);
+    }
+    LOGI("[L8:FileUtils] RunChild: cmd=%{public}s, ret=%{public}d, status=%{public}d, timedOut=%{public}d, "
+         "out=%{public}zu, err=%{public}zu", cmd[0].c_str(), ret, result.status, result.timedOut,
+         result.out.size(), result.err.size());
+    return ret;
+}
+
+static int32_t CheckChildExitStatus(const char *caller, int status, int *exitStatus)
+{
     if (!WIFEXITED(status)) {
-        LOGE("[L8:FileUtils] CheckChildProcessExitStatus: Process exits abnormally, status=%{public}d", status);
+        LOGE("[L8:FileUtils] %{public}s: <<< EXIT FAILED <<< Process exits abnormally, status=%{public}d",
+             caller, status);
         return E_WIFEXITED;
     }
     int tempExitStatus = WEXITSTATUS(status);
     GetExitStatus(exitStatus, tempExitStatus);
     if (tempExitStatus != 0) {
-        LOGE("[L8:FileUtils] CheckChildProcessExitStatus: Process exited with error, status=%{public}d", status);
+        LOGE("[L8:FileUtils] %{public}s: <<< EXIT FAILED <<< Process exited with error, status=%{public}d",
+             caller, status);
         return E_WEXITSTATUS;
     }
     return E_OK;
 }
 
-static int32_t ResolveForkExecExitCode(int32_t ret, int status, int *exitStatus)
+// Hands the captured output back in the chunk sizes the old pipe read loop produced.
+static void SplitOutputForExec(const std::string &text, std::vector<std::string> *output)
 {
-    if (ret == E_NO_CHILD) {
-        return errno;
-    }
-    if (ret == E_WIFEXITED) {
-        return -1;
-    }
-    if (exitStatus != nullptr) {
-        return *exitStatus;
+    if (output == nullptr) {
+        return;
     }
-    if (WIFEXITED(status)) {
-        return WEXITSTATUS(status);
+    output->clear();
+    for (size_t pos = 0; pos < text.size(); pos += BUF_LEN - 1) {
+        output->emplace_back(text, pos, BUF_LEN - 1);
     }
-    return -1;
 }
 
 static void ReportForkExecDiagIfNeeded(const std::vector<std::string> &cmd, int32_t ret, int32_t exitCode,
@@ -764,119 +1596,127 @@ static void ReportForkExecDiagIfNeeded(const std::vector<std::string> &cmd, int3
     VolumeOpDiagReportToolFailure(cmd, ret, exitCode, output);
 }
 
-static void RedirectChildStd(int pipeFd[PIPE_FD_LEN], bool captureAll)
+int ForkExec(std::vector<std::string> &cmd, std::vector<std::string> *output, int *exitStatus)
 {
-    if (captureAll) {
-        if (RedirectStdToPipe(pipeFd, PIPE_FD_LEN) != E_OK) {
-            _exit(1);
-        }
-        return;
+    if (cmd.empty()) {
+        LOGE("[L8:FileUtils] ForkExec: <<< EXIT FAILED <<< cmd is empty");
+        return E_PARAMS_INVALID;
+    }
+    ChildRunOptions options;
+    options.mergeErr = true;
+    options.onOutput = g_threadOutputHook;
+    if (output == nullptr) {
+        options.outCap = 0;
+    }
+    ChildRunResult result;
+    int32_t ret = RunChild(cmd, options, result);
+    SplitOutputForExec(result.out, output);
+    if (ret != E_OK) {
+        LOGE("[L8:FileUtils] ForkExec: <<< EXIT FAILED <<< run failed, ret=%{public}d, cmd=%{public}s",
+             ret, cmd[0].c_str());
+        ReportForkExecDiagIfNeeded(cmd, ret, result.error, output);
+        return ret;
     }
-    (void)close(pipeFd[0]);
-    if (dup2(pipeFd[1], STDOUT_FILENO) == -1) {
-        LOGE("[L8:FileUtils] RedirectChildStd: <<< EXIT FAILED <<< dup2 failed");
-        _exit(1);
+    ret = CheckChildExitStatus("ForkExec", result.status, exitStatus);
+    if (ret != E_OK) {
+        ReportForkExecDiagIfNeeded(cmd, ret, ret == E_WIFEXITED ? -1 : WEXITSTATUS(result.status), output);
+        return ret;
     }
-    (void)close(pipeFd[1]);
+    return E_OK;
 }
 
-int ForkExec(std::vector<std::string> &cmd, std::vector<std::string> *output, int *exitStatus)
+// SIGPIPE from a write is sent to the writing thread, so blocking it here leaves the write failing with EPIPE;
+// a signal still pending when the thread ends is discarded with it.
+static int32_t FeedChildInput(const ChildInputWriter &writer, int fd)
 {
-    if (cmd.empty()) {
-        LOGE("[L8:FileUtils] ForkExec: <<< EXIT FAILED <<< cmd is empty");
+    sigset_t mask;
+    (void)sigemptyset(&mask);
+    (void)sigaddset(&mask, SIGPIPE);
+    (void)pthread_sigmask(SIG_BLOCK, &mask, nullptr);
+    int32_t ret = writer(fd);
+    CloseFd(fd);
+    return ret;
+}
+
+int ForkExecWithInput(std::vector<std::string> &cmd, const ChildInputWriter &writer,
+                      std::vector<std::string> *output)
+{
+    if (cmd.empty() || !writer) {
+        LOGE("[L8:FileUtils] ForkExecWithInput: <<< EXIT FAILED <<< cmd or writer is empty");
         return E_PARAMS_INVALID;
     }
-    int pipeFd[PIPE_FD_LEN];
-    pid_t pid;
-    int status = 0;
-    auto args = FormatCmd(cmd);
-    if (pipe(pipeFd) < 0) {
-        LOGE("[L8:FileUtils] ForkExec: <<< EXIT FAILED <<< create pipe failed,"
-            "errno=%{public}d, cmd=%{public}s", errno, cmd.empty() ? "" : cmd[0].c_str());
-        ClosePipe(pipeFd, PIPE_FD_LEN);
-        ReportForkExecDiagIfNeeded(cmd, E_CREATE_PIPE, errno, output);
+    // Unlike the output pipes both ends block: the writer thread simply waits for the child to catch up.
+    int inPipe[PIPE_FD_LEN] = { -1, -1 };
+    if (pipe2(inPipe, O_CLOEXEC) != 0) {
+        LOGE("[L8:FileUtils] ForkExecWithInput: <<< EXIT FAILED <<< create pipe failed, errno=%{public}d", errno);
         return E_CREATE_PIPE;
     }
-    pid = fork();
-    if (pid == -1) {
-        LOGE("[L8:FileUtils] ForkExec: <<< EXIT FAILED <<< fork failed, errno=%{public}d", errno);
-        ClosePipe(pipeFd, PIPE_FD_LEN);
-        ReportForkExecDiagIfNeeded(cmd, E_FORK, errno, output);
-        return E_FORK;
-    } else if (pid == 0) {
-        if (RedirectStdToPipe(pipeFd, PIPE_FD_LEN)) {
-            _exit(1);
-        }
-        execvp(args[0], const_cast<char **>(args.data()));
-        LOGE("[L8:FileUtils] ForkExec: <<< EXIT FAILED <<< execvp failed, errno=%{public}d,"
-            "cmd=%{public}s", errno, cmd.empty() ? "" : cmd[0].c_str());
-        _exit(1);
-    } else {
-        (void)close(pipeFd[1]);
-        ReadPipeOutputForExec(pipeFd[0], output, cmd.empty() ? "" : cmd[0]);
-        (void)close(pipeFd[0]);
-        int ret = CheckChildProcessExitStatus(pid, status, exitStatus);
-        if (ret != E_OK) {
-            ReportForkExecDiagIfNeeded(cmd, ret, ResolveForkExecExitCode(ret, status, exitStatus), output);
-            return ret;
-        }
+    ChildRunOptions options;
+    options.mergeErr = true;
+    options.onOutput = g_threadOutputHook;
+    options.stdinFd = inPipe[0];
+    if (output == nullptr) {
+        options.outCap = 0;
+    }
+    int32_t writeRet = E_OK;
+    std::thread feeder;
+    // The writer only starts once the child holds the read end, so a failed spawn never leaves it blocked.
+    options.onSpawn = [&inPipe, &feeder, &writer, &writeRet](pid_t) {
+        CloseFd(inPipe[0]);
+        int writeFd = inPipe[1];
+        inPipe[1] = -1;
+        feeder = std::thread([&writer, &writeRet, writeFd] { writeRet = FeedChildInput(writer, writeFd); });
+    };
+    ChildRunResult result;
+    int32_t ret = RunChild(cmd, options, result);
+    if (feeder.joinable()) {
+        feeder.join();
+    }
+    CloseFd(inPipe[0]);
+    CloseFd(inPipe[1]);
+    SplitOutputForExec(result.out, output);
+    if (ret != E_OK) {
+        LOGE("[L8:FileUtils] ForkExecWithInput: <<< EXIT FAILED <<< run failed, ret=%{public}d, cmd=%{public}s",
+             ret, cmd[0].c_str());
+        ReportForkExecDiagIfNeeded(cmd, ret, result.error, output);
+        return ret;
+    }
+    ret = CheckChildExitStatus("ForkExecWithInput", result.status, nullptr);
+    if (ret != E_OK) {
+        ReportForkExecDiagIfNeeded(cmd, ret, ret == E_WIFEXITED ? -1 : WEXITSTATUS(result.status), output);
+        return ret;
+    }
+    if (writeRet != E_OK) {
+        LOGE("[L8:FileUtils] ForkExecWithInput: <<< EXIT FAILED <<< feeding input failed, ret=%{public}d, "
+             "cmd=%{public}s", writeRet, cmd[0].c_str());
+        return writeRet;
     }
     return E_OK;
 }
 
 int ForkExecWithExit(std::vector<std::string> &cmd, int *exitStatus, std::vector<std::string> *output)
 {
-    int pipe_fd[PIPE_FD_LEN];
     LOGD("[L8:FileUtils] ForkExecWithExit: >>> ENTER <<< cmd=%{public}s", cmd.empty() ? "" : cmd[0].c_str());
-    pid_t pid;
-    int status = 0;
-    auto args = FormatCmd(cmd);
-
-    if (pipe(pipe_fd) < 0) {
-        LOGE("[L8:FileUtils] ForkExecWithExit: <<< EXIT FAILED <<< create pipe failed");
-        ReportForkExecDiagIfNeeded(cmd, E_CREATE_PIPE, errno, output);
-        return E_CREATE_PIPE;
-    }
-
-    pid = fork();
-    if (pid == -1) {
-        LOGE("[L8:FileUtils] ForkExecWithExit: <<< EXIT FAILED <<< fork failed");
-        ClosePipe(pipe_fd, PIPE_FD_LEN);
-        ReportForkExecDiagIfNeeded(cmd, E_FORK, errno, output);
-        return E_FORK;
-    } else if (pid == 0) {
-        RedirectChildStd(pipe_fd, output != nullptr);
-        execvp(args[0], const_cast<char **>(args.data()));
-        LOGE("[L8:FileUtils] ForkExecWithExit: <<< EXIT FAILED <<< execvp failed, errno=%{public}d", errno);
-        _exit(1);
-    } else {
-        (void)close(pipe_fd[1]);
-        if (output != nullptr) {
-            ReadPipeOutputForExec(pipe_fd[0], output, cmd.empty() ? "" : cmd[0]);
-        }
-        (void)close(pipe_fd[0]);
-
-        pid_t waitRet = waitpid(pid, &status, 0);
-        if (waitRet == -1) {
-            if (errno == ECHILD) {
-                LOGE("[L8:FileUtils] ForkExecWithExit: <<< EXIT FAILED <<< ECHILD");
-                return E_NO_CHILD;
-            }
-            LOGE("[L8:FileUtils] ForkExecWithExit: <<< EXIT FAILED <<< waitpid failed, errno=%{public}d", errno);
-            return E_SYS_KERNEL_ERR;
-        }
-        if (!WIFEXITED(status)) {
-            LOGE("[L8:FileUtils] ForkExecWithExit: <<< EXIT FAILED <<< Process exits abnormally, status=%{public}d",
-                status);
-            return E_WIFEXITED;
-        }
-        int tempExitStatus = WEXITSTATUS(status);
-        GetExitStatus(exitStatus, tempExitStatus);
-        if (tempExitStatus != 0) {
-            LOGE("[L8:FileUtils] ForkExecWithExit: <<< EXIT FAILED <<< Process exited with error, status=%{public}d",
-                status);
-            return E_WEXITSTATUS;
+    ChildRunOptions options;
+    options.mergeErr = output != nullptr;
+    options.captureErr = output != nullptr;
+    options.onOutput = g_threadOutputHook;
+    if (output == nullptr) {
+        options.outCap = 0;
+    }
+    ChildRunResult result;
+    int32_t ret = RunChild(cmd, options, result);
+    if (ret != E_OK) {
+        LOGE("[L8:FileUtils] ForkExecWithExit: <<< EXIT FAILED <<< run failed, ret=%{public}d", ret);
+        if (ret == E_CREATE_PIPE || ret == E_FORK) {
+            ReportForkExecDiagIfNeeded(cmd, ret, result.error, output);
         }
+        return ret;
+    }
+    SplitOutputForExec(result.out, output);
+    ret = CheckChildExitStatus("ForkExecWithExit", result.status, exitStatus);
+    if (ret != E_OK) {
+        return ret;
     }
     LOGD("[L8:FileUtils] ForkExecWithExit: <<< EXIT SUCCESS <<<");
     return E_OK;
@@ -894,53 +1734,15 @@ static void ReportExecutorPidEvent(std::vector<std::string> &cmd, int32_t pid)
     }
 }
 
-static void WritePidToPipe(int pipe_fd[PIPE_FD_LEN], size_t len)
+static void SplitLinesForExec(const std::string &text, std::vector<std::string> &lines)
 {
-    if (pipe_fd == nullptr || len < PIPE_FD_LEN) {
-        LOGE("[L8:FileUtils] WritePidToPipe: pipe param is invalid.");
-        return;
-    }
-    (void)close(pipe_fd[0]);
-    int send_pid = (int)getpid();
-    if (write(pipe_fd[1], &send_pid, sizeof(int)) == -1) {
-        LOGE("[L8:FileUtils] WritePidToPipe: <<< EXIT FAILED <<< write pipe failed, errno=%{public}d", errno);
-        _exit(1);
-    }
-    (void)close(pipe_fd[1]);
-}
-
-static void ReadPidFromPipe(std::vector<std::string> &cmd, int pipe_fd[2])
-{
-    (void)close(pipe_fd[1]);
-    int recv_pid = 0;
-    while (read(pipe_fd[0], &recv_pid, sizeof(int)) > 0) {
-        LOGI("[L8:FileUtils] ReadPidFromPipe: read child pid=%{public}d", recv_pid);
-    }
-    (void)close(pipe_fd[0]);
-    ReportExecutorPidEvent(cmd, recv_pid);
-}
-
-static void ReadLogFromPipe(int logpipe[PIPE_FD_LEN], size_t len, std::vector<std::string> *output)
-{
-    if (logpipe == nullptr || len < PIPE_FD_LEN) {
-        LOGE("[L8:FileUtils] ReadLogFromPipe: <<< EXIT FAILED <<< param is invalid");
-        return;
+    size_t start = 0;
+    while (start < text.size()) {
+        size_t end = text.find('\n', start);
+        end = end == std::string::npos ? text.size() : end + 1;
+        lines.emplace_back(text, start, end - start);
+        start = end;
     }
-    (void)close(logpipe[1]);
-    FILE* fp = fdopen(logpipe[0], "r");
-    if (fp) {
-        char line[BUF_LEN];
-        while (fgets(line, sizeof(line), fp)) {
-            LOGE("[L8:FileUtils] ReadLogFromPipe: exec mount log lerrno=%{public}d", errno);
-            if (output != nullptr) {
-                output->emplace_back(line);
-            }
-        }
-        fclose(fp);
-        return;
-    }
-    LOGE("[L8:FileUtils] ReadLogFromPipe: <<< EXIT FAILED <<< open pipe file failed, errno=%{public}d", errno);
-    (void)close(logpipe[0]);
 }
 
 int ExtStorageMountForkExec(std::vector<std::string> &cmd, int *exitStatus)
@@ -949,71 +1751,31 @@ int ExtStorageMountForkExec(std::vector<std::string> &cmd, int *exitStatus)
         LOGE("[L8:FileUtils] ExtStorageMountForkExec: <<< EXIT FAILED <<< cmd is empty");
         return E_PARAMS_INVALID;
     }
-    int pipe_fd[PIPE_FD_LEN];
-    int pipe_log_fd[PIPE_FD_LEN]; /* for mount.exfat log*/
-    pid_t pid;
-    int status = 0;
-    auto args = FormatCmd(cmd);
-
-    if (pipe(pipe_fd) < 0) {
-        LOGE("[L8:FileUtils] ExtStorageMountForkExec: <<< EXIT FAILED <<< create pipe failed, errno=%{public}d", errno);
-        ReportForkExecDiagIfNeeded(cmd, E_ERR, errno, nullptr);
-        return E_ERR;
+    ChildRunOptions options;
+    options.mergeErr = true;
+    options.onSpawn = [&cmd](pid_t pid) { ReportExecutorPidEvent(cmd, pid); };
+    ChildRunResult result;
+    int32_t ret = RunChild(cmd, options, result);
+    std::vector<std::string> mountLog;
+    SplitLinesForExec(result.out, mountLog);
+    if (ret == E_NO_CHILD || ret == E_SYS_KERNEL_ERR) {
+        LOGE("[L8:FileUtils] ExtStorageMountForkExec: <<< EXIT FAILED <<< wait failed, errno=%{public}d",
+             result.error);
+        if (ret == E_NO_CHILD) {
+            ReportForkExecDiagIfNeeded(cmd, E_NO_CHILD, result.error, &mountLog);
+        }
+        return ret;
     }
-
-    if (pipe(pipe_log_fd) < 0) {
-        LOGE("[L8:FileUtils] ExtStorageMountForkExec: <<< EXIT FAILED <<< create pipe for log failed,"
-            "errno=%{public}d", errno);
-        ClosePipe(pipe_fd, PIPE_FD_LEN);
-        ReportForkExecDiagIfNeeded(cmd, E_ERR, errno, nullptr);
+    if (ret != E_OK) {
+        LOGE("[L8:FileUtils] ExtStorageMountForkExec: <<< EXIT FAILED <<< run failed, errno=%{public}d",
+             result.error);
+        ReportForkExecDiagIfNeeded(cmd, E_ERR, result.error, nullptr);
         return E_ERR;
     }
-
-    pid = fork();
-    if (pid == -1) {
-        LOGE("[L8:FileUtils] ExtStorageMountForkExec: <<< EXIT FAILED <<< fork failed, errno=%{public}d", errno);
-        ClosePipe(pipe_fd, PIPE_FD_LEN);
-        ClosePipe(pipe_log_fd, PIPE_FD_LEN);
-        ReportForkExecDiagIfNeeded(cmd, E_ERR, errno, nullptr);
+    ret = CheckChildExitStatus("ExtStorageMountForkExec", result.status, exitStatus);
+    if (ret != E_OK) {
+        ReportForkExecDiagIfNeeded(cmd, E_ERR, ret == E_WIFEXITED ? -1 : WEXITSTATUS(result.status), &mountLog);
         return E_ERR;
-    } else if (pid == 0) {
-        WritePidToPipe(pipe_fd, PIPE_FD_LEN);
-        if (RedirectStdToPipe(pipe_log_fd, PIPE_FD_LEN)) {
-            _exit(1);
-        }
-        execvp(args[0], const_cast<char **>(args.data()));
-        LOGE("[L8:FileUtils] ExtStorageMountForkExec: <<< EXIT FAILED <<< execvp failed, errno=%{public}d", errno);
-        _exit(1);
-    } else {
-        ReadPidFromPipe(cmd, pipe_fd);
-        std::vector<std::string> mountLog;
-        ReadLogFromPipe(pipe_log_fd, PIPE_FD_LEN, &mountLog);
-
-        pid_t waitRet = waitpid(pid, &status, 0);
-        if (waitRet == -1) {
-            if (errno == ECHILD) {
-                LOGE("[L8:FileUtils] ExtStorageMountForkExec: <<< EXIT FAILED <<< ECHILD");
-                ReportForkExecDiagIfNeeded(cmd, E_NO_CHILD, errno, &mountLog);
-                return E_NO_CHILD;
-            }
-            LOGE("[L8:FileUtils] ExtStorageMountForkExec: <<< EXIT FAILED <<< "
-                "waitpid failed, errno=%{public}d", errno);
-            return E_SYS_KERNEL_ERR;
-        }
-        if (!WIFEXITED(status)) {
-            LOGE("[L8:FileUtils] ExtStorageMountForkExec: <<< EXIT FAILED <<< "
-                "Process exits abnormally, status=%{public}d", status);
-            ReportForkExecDiagIfNeeded(cmd, E_ERR, -1, &mountLog);
-            return E_ERR;
-        }
-        int tempExitStatus = WEXITSTATUS(status);
-        GetExitStatus(exitStatus, tempExitStatus);
-        if (tempExitStatus != 0) {
-            LOGE("[L8:FileUtils] ExtStorageMountForkExec: <<< EXIT FAILED <<< "
-                "Process exited with error, status=%{public}d", status);
-            ReportForkExecDiagIfNeeded(cmd, E_ERR, tempExitStatus, &mountLog);
-            return E_ERR;
-        }
     }
     return E_OK;
 }
@@ -1057,24 +1819,15 @@ bool IsPathMounted(std::string &path)
     if (path.back() == '/') {
         path.pop_back();
     }
-    std::ifstream inputStream(MOUNT_POINT_INFO, std::ios::in);
-    if (!inputStream.is_open()) {
-        LOGE("[L8:FileUtils] IsPathMounted: <<< EXIT FAILED <<< open /proc/mounts failed, errno=%{public}d", errno);
+    auto mountTable = MountTable::GetInstance().GetSnapshot();
+    if (mountTable == nullptr) {
+        LOGE("[L8:FileUtils] IsPathMounted: <<< EXIT FAILED <<< read mount table failed");
         return true;
     }
-    std::string tmpLine;
-    while (std::getline(inputStream, tmpLine)) {
-        std::stringstream ss(tmpLine);
-        std::string dst;
-        ss >> dst;
-        ss >> dst;
-        if (path == dst) {
-            inputStream.close();
-            LOGD("[L8:FileUtils] IsPathMounted: <<< EXIT SUCCESS <<< path is mounted");
-            return true;
-        }
+    if (mountTable->HasTarget(path)) {
+        LOGD("[L8:FileUtils] IsPathMounted: <<< EXIT SUCCESS <<< path is mounted");
+        return true;
     }
-    inputStream.close();
     return false;
 }
 
@@ -1096,8 +1849,6 @@ std::vector<std::string> Split(std::string str, const std::string &pattern)
 
 void DeleteFile(const std::string &path)
 {
-    DIR *dir = nullptr;
-    struct dirent *dirinfo = nullptr;
     struct stat statbuf;
     if (lstat(path.c_str(), &statbuf) != 0) {
         LOGE("[L8:FileUtils] DeleteFile: <<< EXIT FAILED <<< lstat failed, errno=%{public}d", errno);
@@ -1107,20 +1858,12 @@ void DeleteFile(const std::string &path)
     if (S_ISREG(statbuf.st_mode)) {
         remove(path.c_str());
     } else if (S_ISDIR(statbuf.st_mode)) {
-        if ((dir = opendir(path.c_str())) == nullptr) {
+        int fd = open(path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (fd < 0) {
             LOGE("[L8:FileUtils] DeleteFile: opendir failed, errno:%{public}d", errno);
             return;
         }
-        while ((dirinfo = readdir(dir)) != nullptr) {
-            std::string filepath;
-            filepath.append(path).append("/").append(dirinfo->d_name);
-            if (strcmp(dirinfo->d_name, ".") == 0 || strcmp(dirinfo->d_name, "..") == 0) {
-                continue;
-            }
-            DeleteFile(filepath);
-            rmdir(filepath.c_str());
-        }
-        closedir(dir);
+        (void)ClearDirFd(fd, true);
     }
     return;
 }
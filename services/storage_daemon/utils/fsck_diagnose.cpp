@@ -15,12 +15,11 @@
 
 #include "utils/fsck_diagnose.h"
 
-#include <chrono>
+#include <algorithm>
+#include <climits>
 #include <csignal>
-#include <poll.h>
 #include <sstream>
 #include <sys/wait.h>
-#include <unistd.h>
 #include <vector>
 
 #include "file_utils.h"
@@ -31,10 +30,9 @@ namespace OHOS {
 namespace StorageDaemon {
 namespace {
 constexpr size_t MAX_OUTPUT_LEN = 1024;
-constexpr int32_t PIPE_FD_LEN = 2;
 constexpr int32_t SIGNAL_EXIT_BASE = 128;
 constexpr int32_t SIGKILL_EXIT = SIGNAL_EXIT_BASE + SIGKILL;
-constexpr int32_t PIPE_BUF_LEN = 1024;
+constexpr int32_t MS_PER_SECOND = 1000;
 
 std::string JoinCmd(const std::vector<std::string> &cmd)
 {
@@ -73,15 +71,6 @@ bool BuildFsckCmd(const std::string &devPath, const std::string &fsType, std::ve
     return false;
 }
 
-std::string JoinOutput(const std::vector<std::string> &chunks)
-{
-    std::string text;
-    for (const auto &chunk : chunks) {
-        text += chunk;
-    }
-    return text.size() > MAX_OUTPUT_LEN ? text.substr(0, MAX_OUTPUT_LEN) : text;
-}
-
 int32_t GetExitCode(int status)
 {
     if (WIFEXITED(status)) {
@@ -93,48 +82,6 @@ int32_t GetExitCode(int status)
     return SIGKILL_EXIT;
 }
 
-void ReadPipe(int fd, std::vector<std::string> &output)
-{
-    char buf[PIPE_BUF_LEN] = {0};
-    ssize_t n = 0;
-    while ((n = read(fd, buf, sizeof(buf))) > 0) {
-        output.emplace_back(buf, static_cast<size_t>(n));
-    }
-}
-
-bool WaitFsck(pid_t pid, int pipeRead, int32_t timeoutSec, int &status,
-              std::vector<std::string> &output)
-{
-    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(timeoutSec);
-    while (std::chrono::steady_clock::now() < deadline) {
-        if (waitpid(pid, &status, WNOHANG) == pid) {
-            ReadPipe(pipeRead, output);
-            return false;
-        }
-        int ms = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(
-            deadline - std::chrono::steady_clock::now()).count());
-        pollfd pfd {};
-        pfd.fd = pipeRead;
-        pfd.events = POLLIN;
-        if (poll(&pfd, 1, ms < 0 ? 0 : ms) <= 0) {
-            continue;
-        }
-        char buf[PIPE_BUF_LEN] = {0};
-        ssize_t n = read(pipeRead, buf, sizeof(buf));
-        if (n > 0) {
-            output.emplace_back(buf, static_cast<size_t>(n));
-            continue;
-        }
-        (void)waitpid(pid, &status, 0);
-        return false;
-    }
-    if (waitpid(pid, &status, WNOHANG) == pid) {
-        ReadPipe(pipeRead, output);
-        return false;
-    }
-    return true;
-}
-
 void FillTimeoutOutput(FsckResult &result, int32_t timeoutSec)
 {
     const std::string mark = "fsck diagnose timeout after " + std::to_string(timeoutSec) + "s";
@@ -147,21 +94,6 @@ void FillTimeoutOutput(FsckResult &result, int32_t timeoutSec)
     }
 }
 
-void ExecFsckChild(std::vector<std::string> &cmd, int pipeFd[PIPE_FD_LEN])
-{
-    (void)setpgid(0, 0);
-    if (RedirectStdToPipe(pipeFd, PIPE_FD_LEN) != E_OK) {
-        _exit(1);
-    }
-    std::vector<char *> args;
-    for (auto &item : cmd) {
-        args.push_back(const_cast<char *>(item.c_str()));
-    }
-    args.push_back(nullptr);
-    execvp(args[0], args.data());
-    _exit(1);
-}
-
 FsckResult RunFsck(const std::string &devPath, const std::string &fsType, int32_t timeoutSec)
 {
     FsckResult result;
@@ -171,37 +103,23 @@ FsckResult RunFsck(const std::string &devPath, const std::string &fsType, int32_
         return result;
     }
     result.cmd = JoinCmd(cmd);
-    int pipeFd[PIPE_FD_LEN] = {-1, -1};
-    if (pipe(pipeFd) < 0) {
-        result.ret = E_CREATE_PIPE;
-        return result;
-    }
-    pid_t pid = fork();
-    if (pid < 0) {
-        (void)close(pipeFd[0]);
-        (void)close(pipeFd[1]);
-        result.ret = E_FORK;
+    // fsck runs read-only here, so it is killed outright at the deadline together with its children.
+    int32_t waitSec = timeoutSec < 0 ? 0 : timeoutSec;
+    ChildRunOptions options;
+    options.timeoutMs = std::min(waitSec, INT32_MAX / MS_PER_SECOND) * MS_PER_SECOND;
+    options.termGraceMs = 0;
+    options.outCap = MAX_OUTPUT_LEN;
+    options.mergeErr = true;
+    options.newGroup = true;
+    ChildRunResult child;
+    result.ret = RunChild(cmd, options, child);
+    if (result.ret != E_OK) {
         return result;
     }
-    if (pid == 0) {
-        ExecFsckChild(cmd, pipeFd);
-    }
-    (void)setpgid(pid, pid);
-    (void)close(pipeFd[1]);
-    int status = 0;
-    std::vector<std::string> output;
-    int32_t waitSec = timeoutSec < 0 ? 0 : timeoutSec;
-    bool timedOut = WaitFsck(pid, pipeFd[0], waitSec, status, output);
-    if (timedOut) {
-        (void)killpg(pid, SIGKILL);
-        (void)waitpid(pid, &status, 0);
-        ReadPipe(pipeFd[0], output);
+    result.exitCode = GetExitCode(child.status);
+    result.output = child.out;
+    if (child.timedOut) {
         LOGE("FsckDiagnose: timeout fsType=%{public}s timeout=%{public}d", fsType.c_str(), waitSec);
-    }
-    (void)close(pipeFd[0]);
-    result.exitCode = GetExitCode(status);
-    result.output = JoinOutput(output);
-    if (timedOut) {
         FillTimeoutOutput(result, waitSec);
     }
     return result;
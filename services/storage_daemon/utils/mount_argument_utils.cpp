@@ -15,7 +15,8 @@
 
 #include "utils/mount_argument_utils.h"
 
-#include <sstream>
+#include <initializer_list>
+#include <string_view>
 #include <sys/mount.h>
 #include <sys/stat.h>
 
@@ -48,130 +49,107 @@ namespace {
     constexpr const char *CUR_FILEMGR_PATH = "/currentUser/filemgr";
     constexpr const char *CUR_FILEMGR_APPDATA_PATH = "/currentUser/filemgr/appdata";
     constexpr const char *NOSHAREFS_APPDATA_PATH = "/nosharefs/appdata";
+
+    // Joins the parts into a string sized up front, so building a path costs one allocation.
+    string Concat(std::initializer_list<std::string_view> parts)
+    {
+        size_t len = 0;
+        for (auto part : parts) {
+            len += part.size();
+        }
+        string result;
+        result.reserve(len);
+        for (auto part : parts) {
+            result.append(part.data(), part.size());
+        }
+        return result;
+    }
 } // namespace
 
 string MountArgument::GetFullSrc() const
 {
     LOGD("[L8:MountArgumentUtils] GetFullSrc: >>> ENTER <<< userId=%{public}d", userId_);
-    stringstream ss;
-    ss << DATA_POINT << userId_ << "/hmdfs/" << relativePath_;
-
-    return ss.str();
+    return Concat({ DATA_POINT, to_string(userId_), "/hmdfs/", relativePath_ });
 }
 
 string MountArgument::GetFullDst() const
 {
     LOGD("[L8:MountArgumentUtils] GetFullDst: >>> ENTER <<< userId=%{public}d", userId_);
-    stringstream ss;
-    ss << BASE_MOUNT_POINT << userId_ << "/" << relativePath_;
-
-    return ss.str();
+    return Concat({ BASE_MOUNT_POINT, to_string(userId_), "/", relativePath_ });
 }
 
 string MountArgument::GetFullMediaCloud() const
 {
     LOGD("[L8:MountArgumentUtils] GetFullMediaCloud: >>> ENTER <<< userId=%{public}d", userId_);
-    stringstream ss;
-    ss << TMPFS_MNT_DATA << userId_ << "/" << "cloud";
-
-    return ss.str();
+    return Concat({ TMPFS_MNT_DATA, to_string(userId_), "/cloud" });
 }
 
 string MountArgument::GetFullCloud() const
 {
     LOGD("[L8:MountArgumentUtils] GetFullCloud: >>> ENTER <<< userId=%{public}d", userId_);
-    stringstream ss;
-    ss << TMPFS_MNT_DATA << userId_ << "/" << "cloud_fuse";
-
-    return ss.str();
+    return Concat({ TMPFS_MNT_DATA, to_string(userId_), "/cloud_fuse" });
 }
 
 string MountArgument::GetShareSrc() const
 {
     LOGD("[L8:MountArgumentUtils] GetShareSrc: >>> ENTER <<< userId=%{public}d", userId_);
-    stringstream ss;
-    ss << SHAREFS_DATA_POINT << userId_ << "/share";
-
-    return ss.str();
+    return Concat({ SHAREFS_DATA_POINT, to_string(userId_), "/share" });
 }
 
 string MountArgument::GetUserIdPara() const
 {
     LOGD("[L8:MountArgumentUtils] GetUserIdPara: >>> ENTER <<< userId=%{public}d", userId_);
-    stringstream ss;
-    ss << "user_id=" << userId_;
-
-    return ss.str();
+    return Concat({ "user_id=", to_string(userId_) });
 }
 
 string MountArgument::GetHmUserIdPara() const
 {
     LOGD("[L8:MountArgumentUtils] GetHmUserIdPara: >>> ENTER <<< userId=%{public}d", userId_);
-    stringstream ss;
-    ss << "override_support_delete,user_id=" << userId_;
-    return ss.str();
+    return Concat({ "override_support_delete,user_id=", to_string(userId_) });
 }
 
 string MountArgument::GetShareDst() const
 {
     LOGD("[L8:MountArgumentUtils] GetShareDst: >>> ENTER <<< userId=%{public}d", userId_);
-    stringstream ss;
-    ss << SHAREFS_BASE_MOUNT_POINT << userId_;
-
-    return ss.str();
+    return Concat({ SHAREFS_BASE_MOUNT_POINT, to_string(userId_) });
 }
 
 string MountArgument::GetCommFullPath() const
 {
     LOGD("[L8:MountArgumentUtils] GetCommFullPath: >>> ENTER <<< userId=%{public}d", userId_);
-    stringstream ss;
-    ss << COMM_DATA_POINT << userId_ << "/";
-
-    return ss.str();
+    return Concat({ COMM_DATA_POINT, to_string(userId_), "/" });
 }
 
 string MountArgument::GetCloudFullPath() const
 {
     LOGD("[L8:MountArgumentUtils] GetCloudFullPath: >>> ENTER <<< userId=%{public}d", userId_);
-    stringstream ss;
-    ss << COMM_CLOUD_POINT << userId_ << "/";
-
-    return ss.str();
+    return Concat({ COMM_CLOUD_POINT, to_string(userId_), "/" });
 }
 
 string MountArgument::GetCloudDocsPath() const
 {
     LOGD("[L8:MountArgumentUtils] GetCloudDocsPath: >>> ENTER <<< userId=%{public}d", userId_);
-    stringstream ss;
-    ss << COMM_CLOUD_POINT << userId_ << RELATIVE_DOCS_PATH;
-
-    return ss.str();
+    return Concat({ COMM_CLOUD_POINT, to_string(userId_), RELATIVE_DOCS_PATH });
 }
 
 string MountArgument::GetLocalDocsPath() const
 {
     LOGD("[L8:MountArgumentUtils] GetLocalDocsPath: >>> ENTER <<< userId=%{public}d", userId_);
-    stringstream ss;
-    ss << BASE_MOUNT_POINT << userId_ << "/" << relativePath_ << HMDFS_DEVICE_VIEW_LOCAL_DOCS_PATH;
-
-    return ss.str();
+    return Concat({ BASE_MOUNT_POINT, to_string(userId_), "/", relativePath_, HMDFS_DEVICE_VIEW_LOCAL_DOCS_PATH });
 }
 
 string MountArgument::GetCachePath() const
 {
     LOGD("[L8:MountArgumentUtils] GetCachePath: >>> ENTER <<< userId=%{public}d", userId_);
-    stringstream ss;
     if (enableCloudDisk_) {
-        ss << DATA_POINT << userId_ << "/hmdfs/cloud/";
-    } else {
-        ss << DATA_POINT << userId_ << "/hmdfs/cache/" << relativePath_ << "_cache/";
+        return Concat({ DATA_POINT, to_string(userId_), "/hmdfs/cloud/" });
     }
-    return ss.str();
+    return Concat({ DATA_POINT, to_string(userId_), "/hmdfs/cache/", relativePath_, "_cache/" });
 }
 
 static uint64_t MocklispHash(const string &str)
 {
-    struct stat statBuf;
+    struct stat statBuf = {};
     auto err = stat(str.c_str(), &statBuf);
     if (err != 0) {
         LOGE("[L8:MountArgumentUtils] MocklispHash: stat failed, err=%{public}d", err);
@@ -187,143 +165,99 @@ string MountArgument::GetCtrlPath() const
     auto dst = GetFullDst();
     auto res = MocklispHash(dst);
 
-    stringstream ss;
-    ss << SYSFS_HMDFS_PATH << res << "/cmd";
-    return ss.str();
+    return Concat({ SYSFS_HMDFS_PATH, to_string(res), "/cmd" });
 }
 
 string MountArgument::GetMountPointPrefix() const
 {
     LOGD("[L8:MountArgumentUtils] GetMountPointPrefix: >>> ENTER <<< userId=%{public}d", userId_);
-    stringstream ss;
-    ss << DATA_POINT << userId_ << "/hmdfs";
-    return ss.str();
+    return Concat({ DATA_POINT, to_string(userId_), "/hmdfs" });
 }
 
 std::string MountArgument::GetSandboxPath() const
 {
     LOGD("[L8:MountArgumentUtils] GetSandboxPath: >>> ENTER <<< userId=%{public}d", userId_);
-    stringstream ss;
-    ss << SANDBOX_PATH << userId_;
-    return ss.str();
+    return Concat({ SANDBOX_PATH, to_string(userId_) });
 }
 
 string MountArgument::OptionsToString() const
 {
     LOGD("[L8:MountArgumentUtils] OptionsToString: >>> ENTER <<< userId=%{public}d", userId_);
-    stringstream ss;
-    ss << "local_dst=" << GetFullDst() << ",user_id=" << userId_;
-    ss << ",ra_pages=512";
-    if (useCache_) {
-        ss << ",cache_dir=" << GetCachePath();
-    }
-    if (useCloudDir_) {
-        ss << ",cloud_dir=" << GetFullMediaCloud();
-    }
-    if (caseSensitive_) {
-        ss << ",sensitive";
-    }
-    if (enableMergeView_) {
-        ss << ",merge";
-    }
-    if (enableCloudDisk_) {
-        ss << ",cloud_disk";
-    }
-    if (!enableOfflineStash_) {
-        ss << ",no_offline_stash";
-    }
-    if (isSecurityMode_) {
-        ss << ",security_mode";
-    }
-    return ss.str();
+    // The temporaries live until the end of the statement, so the views Concat gets stay valid.
+    return Concat({ "local_dst=", GetFullDst(), ",user_id=", to_string(userId_), ",ra_pages=512",
+        useCache_ ? ",cache_dir=" : "", useCache_ ? GetCachePath() : string(),
+        useCloudDir_ ? ",cloud_dir=" : "", useCloudDir_ ? GetFullMediaCloud() : string(),
+        caseSensitive_ ? ",sensitive" : "",
+        enableMergeView_ ? ",merge" : "",
+        enableCloudDisk_ ? ",cloud_disk" : "",
+        enableOfflineStash_ ? "" : ",no_offline_stash",
+        isSecurityMode_ ? ",security_mode" : "" });
 }
 
 string MountArgument::GetMediaDocsPath() const
 {
     LOGD("[L8:MountArgumentUtils] GetMediaDocsPath: >>> ENTER <<< userId=%{public}d", userId_);
-    stringstream ss;
-    ss << COMM_DATA_POINT << userId_ << LOCAL_FILE_DOCS_PATH;
-    return ss.str();
+    return Concat({ COMM_DATA_POINT, to_string(userId_), LOCAL_FILE_DOCS_PATH });
 }
 
 string MountArgument::GetNoSharefsAppdataPath() const
 {
     LOGD("[L8:MountArgumentUtils] GetNoSharefsAppdataPath: >>> ENTER <<< userId=%{public}d", userId_);
-    stringstream ss;
-    ss << MNT_USER_PATH << userId_ << NOSHAREFS_APPDATA_PATH;
-    return ss.str();
+    return Concat({ MNT_USER_PATH, to_string(userId_), NOSHAREFS_APPDATA_PATH });
 }
 
 string MountArgument::GetNoSharefsDocPath() const
 {
     LOGD("[L8:MountArgumentUtils] GetNoSharefsDocPath: >>> ENTER <<< userId=%{public}d", userId_);
-    stringstream ss;
-    ss << MNT_USER_PATH << userId_ << NOSHAREFS_DOC_PATH;
-    return ss.str();
+    return Concat({ MNT_USER_PATH, to_string(userId_), NOSHAREFS_DOC_PATH });
 }
 
 string MountArgument::GetNoSharefsDocCurPath() const
 {
     LOGD("[L8:MountArgumentUtils] GetNoSharefsDocCurPath: >>> ENTER <<< userId=%{public}d", userId_);
-    stringstream ss;
-    ss << MNT_USER_PATH << userId_ << NOSHAREFS_DOC_CUR_PATH;
-    return ss.str();
+    return Concat({ MNT_USER_PATH, to_string(userId_), NOSHAREFS_DOC_CUR_PATH });
 }
 
 string MountArgument::GetSharefsDocPath() const
 {
     LOGD("[L8:MountArgumentUtils] GetSharefsDocPath: >>> ENTER <<< userId=%{public}d", userId_);
-    stringstream ss;
-    ss << MNT_USER_PATH << userId_ << SHAREFS_DOC_PATH;
-    return ss.str();
+    return Concat({ MNT_USER_PATH, to_string(userId_), SHAREFS_DOC_PATH });
 }
 
 string MountArgument::GetSharefsDocCurPath() const
 {
     LOGD("[L8:MountArgumentUtils] GetSharefsDocCurPath: >>> ENTER <<< userId=%{public}d", userId_);
-    stringstream ss;
-    ss << MNT_USER_PATH << userId_ << SHAREFS_DOC_CUR_PATH;
-    return ss.str();
+    return Concat({ MNT_USER_PATH, to_string(userId_), SHAREFS_DOC_CUR_PATH });
 }
 
 string MountArgument::GetCurOtherAppdataPath() const
 {
     LOGD("[L8:MountArgumentUtils] GetCurOtherAppdataPath: >>> ENTER <<< userId=%{public}d", userId_);
-    stringstream ss;
-    ss << MNT_USER_PATH << userId_ << CUR_OTHER_APPDATA_PATH;
-    return ss.str();
+    return Concat({ MNT_USER_PATH, to_string(userId_), CUR_OTHER_APPDATA_PATH });
 }
 
 string MountArgument::GetMntUserPath() const
 {
     LOGD("[L8:MountArgumentUtils] GetMntUserPath: >>> ENTER <<< userId=%{public}d", userId_);
-    stringstream ss;
-    ss << MNT_USER_PATH << userId_;
-    return ss.str();
+    return Concat({ MNT_USER_PATH, to_string(userId_) });
 }
 
 string MountArgument::GetCurOtherPath() const
 {
     LOGD("[L8:MountArgumentUtils] GetCurOtherPath: >>> ENTER <<< userId=%{public}d", userId_);
-    stringstream ss;
-    ss << MNT_USER_PATH << userId_ << CUR_OTHER_PATH;
-    return ss.str();
+    return Concat({ MNT_USER_PATH, to_string(userId_), CUR_OTHER_PATH });
 }
 
 string MountArgument::GetCurFileMgrPath() const
 {
     LOGD("[L8:MountArgumentUtils] GetCurFileMgrPath: >>> ENTER <<< userId=%{public}d", userId_);
-    stringstream ss;
-    ss << MNT_USER_PATH << userId_ << CUR_FILEMGR_PATH;
-    return ss.str();
+    return Concat({ MNT_USER_PATH, to_string(userId_), CUR_FILEMGR_PATH });
 }
 
 string MountArgument::GetCurFileMgrAppdataPath() const
 {
     LOGD("[L8:MountArgumentUtils] GetCurFileMgrAppdataPath: >>> ENTER <<< userId=%{public}d", userId_);
-    stringstream ss;
-    ss << MNT_USER_PATH << userId_ << CUR_FILEMGR_APPDATA_PATH;
-    return ss.str();
+    return Concat({ MNT_USER_PATH, to_string(userId_), CUR_FILEMGR_APPDATA_PATH });
 }
 
 unsigned long MountArgument::GetFlags() const
@@ -336,9 +270,7 @@ unsigned long MountArgument::GetFlags() const
 string MountArgument::GetFullMediaFuse() const
 {
     LOGD("[L8:MountArgumentUtils] GetFullMediaFuse: >>> ENTER <<< userId=%{public}d", userId_);
-    stringstream ss;
-    ss << TMPFS_MNT_DATA << userId_ << "/" << "media_fuse/Photo";
-    return ss.str();
+    return Concat({ TMPFS_MNT_DATA, to_string(userId_), "/media_fuse/Photo" });
 }
 #endif
 
@@ -0,0 +1,237 @@
+/*
+ * Copyright (c) 2026 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "utils/mount_table.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <fcntl.h>
+#include <numeric>
+#include <poll.h>
+#include <unistd.h>
+
+#include "storage_service_log.h"
+
+namespace OHOS {
+namespace StorageDaemon {
+namespace {
+constexpr const char *MOUNT_INFO_PATH = "/proc/self/mountinfo";
+constexpr const char *FIELD_DELIMITERS = " \t";
+constexpr std::string_view OPTIONAL_FIELDS_END = "-";
+constexpr size_t MOUNT_INFO_TARGET_INDEX = 4;
+constexpr size_t READ_CHUNK_SIZE = 16 * 1024;
+
+std::string_view NextField(std::string_view &rest)
+{
+    size_t start = rest.find_first_not_of(FIELD_DELIMITERS);
+    if (start == std::string_view::npos) {
+        rest = {};
+        return {};
+    }
+    rest.remove_prefix(start);
+    size_t end = rest.find_first_of(FIELD_DELIMITERS);
+    std::string_view field = rest.substr(0, end);
+    rest.remove_prefix(field.size());
+    return field;
+}
+
+bool HasPrefix(std::string_view str, std::string_view prefix)
+{
+    return str.compare(0, prefix.size(), prefix) == 0;
+}
+} // namespace
+
+bool MountTableSnapshot::HasTarget(std::string_view target) const
+{
+    auto it = std::lower_bound(byTarget_.begin(), byTarget_.end(), target,
+        [this](uint32_t idx, std::string_view key) { return entries_[idx].target < key; });
+    return it != byTarget_.end() && entries_[*it].target == target;
+}
+
+void MountTableSnapshot::ForEachOfTypes(const std::vector<std::string_view> &fsTypes,
+    const MountEntryVisitor &visitor) const
+{
+    std::vector<uint32_t> indexes;
+    for (const auto &fsType : fsTypes) {
+        auto it = byType_.find(fsType);
+        if (it != byType_.end()) {
+            indexes.insert(indexes.end(), it->second.begin(), it->second.end());
+        }
+    }
+    if (fsTypes.size() > 1) {
+        std::sort(indexes.begin(), indexes.end());
+    }
+    for (uint32_t idx : indexes) {
+        visitor(entries_[idx]);
+    }
+}
+
+void MountTableSnapshot::ForEachTargetPrefix(std::string_view prefix, const MountEntryVisitor &visitor) const
+{
+    auto it = std::lower_bound(byTarget_.begin(), byTarget_.end(), prefix,
+        [this](uint32_t idx, std::string_view key) { return entries_[idx].target < key; });
+    for (; it != byTarget_.end() && HasPrefix(entries_[*it].target, prefix); ++it) {
+        visitor(entries_[*it]);
+    }
+}
+
+void MountTableSnapshot::ForEachSourcePrefix(std::string_view prefix, const MountEntryVisitor &visitor) const
+{
+    auto it = std::lower_bound(bySource_.begin(), bySource_.end(), prefix,
+        [this](uint32_t idx, std::string_view key) { return entries_[idx].source < key; });
+    for (; it != bySource_.end() && HasPrefix(entries_[*it].source, prefix); ++it) {
+        visitor(entries_[*it]);
+    }
+}
+
+void MountTableSnapshot::BuildIndex()
+{
+    byTarget_.resize(entries_.size());
+    std::iota(byTarget_.begin(), byTarget_.end(), 0);
+    bySource_ = byTarget_;
+    std::stable_sort(byTarget_.begin(), byTarget_.end(),
+        [this](uint32_t a, uint32_t b) { return entries_[a].target < entries_[b].target; });
+    std::stable_sort(bySource_.begin(), bySource_.end(),
+        [this](uint32_t a, uint32_t b) { return entries_[a].source < entries_[b].source; });
+    for (uint32_t idx = 0; idx < entries_.size(); idx++) {
+        byType_[entries_[idx].fsType].push_back(idx);
+    }
+}
+
+MountTable &MountTable::GetInstance()
+{
+    static MountTable instance;
+    return instance;
+}
+
+MountTable::~MountTable()
+{
+    if (fd_ >= 0) {
+        (void)close(fd_);
+    }
+}
+
+std::shared_ptr<const MountTableSnapshot> MountTable::GetSnapshot()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (snapshot_ != nullptr && !HasChanged()) {
+        return snapshot_;
+    }
+    std::string content;
+    if (!ReadMountInfo(content)) {
+        return nullptr;
+    }
+    snapshot_ = Parse(std::move(content));
+    return snapshot_;
+}
+
+void MountTable::Invalidate()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    snapshot_ = nullptr;
+}
+
+bool MountTable::HasChanged()
+{
+    if (fd_ < 0) {
+        return true;
+    }
+    // mountinfo reports POLLPRI | POLLERR once per namespace change and rearms on the poll itself.
+    struct pollfd pfd = { fd_, POLLPRI, 0 };
+    int ret = poll(&pfd, 1, 0);
+    if (ret < 0) {
+        LOGE("[L8:MountTable] HasChanged: poll failed, errno=%{public}d", errno);
+        return true;
+    }
+    return ret > 0 && (pfd.revents & (POLLPRI | POLLERR)) != 0;
+}
+
+bool MountTable::ReadMountInfo(std::string &content)
+{
+    if (fd_ >= 0 && lseek(fd_, 0, SEEK_SET) < 0) {
+        (void)close(fd_);
+        fd_ = -1;
+    }
+    if (fd_ < 0) {
+        fd_ = open(MOUNT_INFO_PATH, O_RDONLY | O_CLOEXEC);
+        if (fd_ < 0) {
+            LOGE("[L8:MountTable] ReadMountInfo: <<< EXIT FAILED <<< open mountinfo failed, errno=%{public}d", errno);
+            return false;
+        }
+    }
+    char buf[READ_CHUNK_SIZE];
+    ssize_t len;
+    while ((len = TEMP_FAILURE_RETRY(read(fd_, buf, sizeof(buf)))) > 0) {
+        content.append(buf, static_cast<size_t>(len));
+    }
+    if (len < 0) {
+        LOGE("[L8:MountTable] ReadMountInfo: <<< EXIT FAILED <<< read mountinfo failed, errno=%{public}d", errno);
+        (void)close(fd_);
+        fd_ = -1;
+        return false;
+    }
+    return true;
+}
+
+std::shared_ptr<MountTableSnapshot> MountTable::Parse(std::string content)
+{
+    auto snapshot = std::make_shared<MountTableSnapshot>();
+    snapshot->buffer_ = std::move(content);
+    std::string_view rest = snapshot->buffer_;
+    while (!rest.empty()) {
+        size_t end = rest.find('\n');
+        std::string_view line = rest.substr(0, end);
+        rest.remove_prefix(end == std::string_view::npos ? rest.size() : end + 1);
+        MountEntry entry;
+        if (ParseMountInfoLine(line, entry)) {
+            snapshot->entries_.push_back(entry);
+        }
+    }
+    snapshot->BuildIndex();
+    LOGD("[L8:MountTable] Parse: entries=%{public}zu", snapshot->entries_.size());
+    return snapshot;
+}
+
+// id parent major:minor root target options [optional fields...] - fstype source superoptions
+bool MountTable::ParseMountInfoLine(std::string_view line, MountEntry &entry)
+{
+    for (size_t i = 0; i < MOUNT_INFO_TARGET_INDEX; i++) {
+        if (NextField(line).empty()) {
+            return false;
+        }
+    }
+    entry.target = NextField(line);
+    std::string_view field;
+    do {
+        field = NextField(line);
+    } while (!field.empty() && field != OPTIONAL_FIELDS_END);
+    if (field.empty()) {
+        return false;
+    }
+    entry.fsType = NextField(line);
+    entry.source = NextField(line);
+    return !entry.target.empty() && !entry.fsType.empty();
+}
+
+// source target fstype options dump pass, as in /proc/mounts
+bool MountTable::ParseMountsLine(std::string_view line, MountEntry &entry)
+{
+    entry.source = NextField(line);
+    entry.target = NextField(line);
+    entry.fsType = NextField(line);
+    return !entry.fsType.empty();
+}
+} // namespace StorageDaemon
+} // namespace OHOS
@@ -0,0 +1,405 @@
+/*
+ * Copyright (c) 2026 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "utils/op_progress.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+
+#include "storage_service_errno.h"
+#include "storage_service_log.h"
+
+namespace OHOS {
+namespace StorageDaemon {
+namespace {
+constexpr int32_t PERCENT_FULL = 100;
+constexpr uint64_t WODIM_MB = 1024 * 1024;
+constexpr size_t MAX_PENDING_LINE = 4096;
+constexpr int64_t SECONDS_PER_MINUTE = 60;
+constexpr int64_t MS_PER_SECOND = 1000;
+constexpr int64_t OP_RESULT_KEEP_MS = 5000;
+// Share of the operation a planned phase gets; only the ratio between the planned phases matters.
+constexpr int32_t WEIGHT_BUILDING_IMAGE = 10;
+constexpr int32_t WEIGHT_WRITING = 60;
+constexpr int32_t WEIGHT_FORMATTING = 100;
+constexpr int32_t WEIGHT_VERIFYING = 40;
+
+thread_local OpProgressScope *g_currentScope = nullptr;
+
+int64_t NowMs()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int32_t PhaseWeight(OpPhase phase)
+{
+    switch (phase) {
+        case OpPhase::BUILDING_IMAGE:
+            return WEIGHT_BUILDING_IMAGE;
+        case OpPhase::WRITING:
+            return WEIGHT_WRITING;
+        case OpPhase::FORMATTING:
+            return WEIGHT_FORMATTING;
+        case OpPhase::VERIFYING:
+            return WEIGHT_VERIFYING;
+        default:
+            return 0;
+    }
+}
+
+uint32_t PhaseBit(OpPhase phase)
+{
+    return 1U << static_cast<uint32_t>(phase);
+}
+
+bool IsFinished(int32_t phase)
+{
+    return phase == static_cast<int32_t>(OpPhase::DONE) || phase == static_cast<int32_t>(OpPhase::FAILED);
+}
+
+// growisofs: "  1736704/9256960 ( 18.8%) @3.1x, remaining 0:33 RBU 100.0% UBU  12.8%"
+bool ParseGrowisofs(const std::string &line, OpProgressSample &sample)
+{
+    uint64_t done = 0;
+    uint64_t total = 0;
+    double percent = 0;
+    if (sscanf(line.c_str(), " %" SCNu64 "/%" SCNu64 " (%lf%%)", &done, &total, &percent) != 3) {
+        return false;
+    }
+    sample.hasBytes = true;
+    sample.bytesDone = done;
+    sample.bytesTotal = total;
+    sample.percent = percent;
+    size_t pos = line.find("remaining ");
+    int minutes = 0;
+    int seconds = 0;
+    if (pos != std::string::npos && sscanf(line.c_str() + pos, "remaining %d:%d", &minutes, &seconds) == 2) {
+        sample.etaSec = minutes * SECONDS_PER_MINUTE + seconds;
+    }
+    return true;
+}
+
+// wodim: "Track 01:   12 of  300 MB written (fifo 100%) [buf  99%]   4.1x."
+bool ParseWodim(const std::string &line, OpProgressSample &sample)
+{
+    size_t colon = line.find(':');
+    if (line.find(" MB written") == std::string::npos || colon == std::string::npos) {
+        return false;
+    }
+    uint64_t done = 0;
+    uint64_t total = 0;
+    if (sscanf(line.c_str() + colon + 1, " %" SCNu64 " of %" SCNu64 " MB", &done, &total) != 2) {
+        return false;
+    }
+    sample.hasBytes = true;
+    sample.bytesDone = done * WODIM_MB;
+    sample.bytesTotal = total * WODIM_MB;
+    return true;
+}
+
+// genisoimage/mkisofs: " 18.79% done, estimate finish Tue Oct 19 12:00:00 2026"
+bool ParseIsoDone(const std::string &line, OpProgressSample &sample)
+{
+    double percent = 0;
+    if (line.find("% done") == std::string::npos || sscanf(line.c_str(), " %lf%% done", &percent) != 1) {
+        return false;
+    }
+    sample.percent = percent;
+    return true;
+}
+
+// mke2fs and friends: "Writing inode tables:  3/64", redrawn in place, so the last pair counts.
+bool ParseCounter(const std::string &line, OpProgressSample &sample)
+{
+    size_t colon = line.rfind(':');
+    if (colon == std::string::npos) {
+        return false;
+    }
+    const char *pos = line.c_str() + colon + 1;
+    uint64_t done = 0;
+    uint64_t total = 0;
+    bool found = false;
+    int used = 0;
+    while (sscanf(pos, " %" SCNu64 "/%" SCNu64 "%n", &done, &total, &used) == 2 && total > 0) {
+        sample.percent = static_cast<double>(std::min(done, total)) * PERCENT_FULL / total;
+        found = true;
+        pos += used;
+    }
+    return found;
+}
+} // namespace
+
+OpProgressRegistry &OpProgressRegistry::GetInstance()
+{
+    static OpProgressRegistry instance;
+    return instance;
+}
+
+std::string OpProgressRegistry::GetOpId(const std::string &devPath)
+{
+    size_t pos = devPath.find_last_of('/');
+    return pos == std::string::npos ? devPath : devPath.substr(pos + 1);
+}
+
+std::shared_ptr<OpProgressRegistry::State> OpProgressRegistry::GetState(const std::string &opId, bool create)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = states_.find(opId);
+    if (it != states_.end() && IsFinished(it->second->phase) &&
+        NowMs() - it->second->finishMs >= OP_RESULT_KEEP_MS) {
+        states_.erase(it);
+        it = states_.end();
+    }
+    if (it != states_.end()) {
+        return it->second;
+    }
+    if (!create) {
+        return nullptr;
+    }
+    auto state = std::make_shared<State>();
+    states_.emplace(opId, state);
+    return state;
+}
+
+void OpProgressRegistry::Reset(State &state, uint32_t planMask)
+{
+    state.phase = static_cast<int32_t>(OpPhase::IDLE);
+    state.bytesDone = 0;
+    state.bytesTotal = 0;
+    state.percent = 0;
+    state.etaSec = -1;
+    state.lastError = 0;
+    state.phaseStartMs = NowMs();
+    state.notified = -1;
+    state.planMask = planMask;
+    state.phaseFrom = 0;
+    state.phaseTo = 0;
+    state.finishMs = 0;
+}
+
+void OpProgressRegistry::RaisePercent(State &state, int32_t percent)
+{
+    int32_t current = state.percent;
+    while (percent > current && !state.percent.compare_exchange_weak(current, percent)) {
+    }
+}
+
+void OpProgressRegistry::Begin(const std::string &opId, std::initializer_list<OpPhase> plan)
+{
+    uint32_t planMask = 0;
+    for (OpPhase phase : plan) {
+        planMask |= PhaseBit(phase);
+    }
+    auto state = GetState(opId, true);
+    Reset(*state, planMask);
+    LOGI("[L3:OpProgress] Begin: opId=%{public}s, plan=0x%{public}x", opId.c_str(), planMask);
+}
+
+void OpProgressRegistry::SetPhase(const std::string &opId, OpPhase phase)
+{
+    auto state = GetState(opId, true);
+    if (IsFinished(state->phase)) {
+        // A scope with no Begin of its own after an operation that just finished: start over.
+        Reset(*state, 0);
+    }
+    int32_t from = state->percent;
+    int32_t to = PERCENT_FULL;
+    uint32_t planMask = state->planMask;
+    if ((planMask & PhaseBit(phase)) != 0) {
+        int32_t total = 0;
+        int32_t before = 0;
+        for (int32_t i = static_cast<int32_t>(OpPhase::BUILDING_IMAGE); i < static_cast<int32_t>(OpPhase::DONE); i++) {
+            OpPhase planned = static_cast<OpPhase>(i);
+            if ((planMask & PhaseBit(planned)) != 0) {
+                total += PhaseWeight(planned);
+                before += i < static_cast<int32_t>(phase) ? PhaseWeight(planned) : 0;
+            }
+        }
+        from = std::max(from, before * PERCENT_FULL / total);
+        to = std::max(from, (before + PhaseWeight(phase)) * PERCENT_FULL / total);
+    }
+    state->phaseFrom = from;
+    state->phaseTo = to;
+    state->bytesDone = 0;
+    state->bytesTotal = 0;
+    state->etaSec = -1;
+    state->phaseStartMs = NowMs();
+    state->phase = static_cast<int32_t>(phase);
+    RaisePercent(*state, from);
+    LOGI("[L3:OpProgress] SetPhase: opId=%{public}s, phase=%{public}d, range=%{public}d-%{public}d",
+        opId.c_str(), static_cast<int32_t>(phase), from, to);
+    Notify(opId, *state, true);
+}
+
+void OpProgressRegistry::Update(const std::string &opId, const OpProgressSample &sample)
+{
+    auto state = GetState(opId, false);
+    if (state == nullptr || IsFinished(state->phase)) {
+        return;
+    }
+    int64_t percent = -1;
+    if (sample.hasBytes) {
+        state->bytesDone = sample.bytesDone;
+        state->bytesTotal = sample.bytesTotal;
+        if (sample.bytesTotal > 0) {
+            percent = static_cast<int64_t>(std::min(sample.bytesDone, sample.bytesTotal) * PERCENT_FULL /
+                sample.bytesTotal);
+        }
+    }
+    if (sample.percent >= 0) {
+        percent = static_cast<int64_t>(sample.percent);
+    }
+    if (percent < 0) {
+        return;
+    }
+    percent = std::min<int64_t>(percent, PERCENT_FULL);
+    int64_t eta = sample.etaSec;
+    if (eta < 0 && percent > 0) {
+        int64_t elapsedMs = NowMs() - state->phaseStartMs;
+        eta = elapsedMs * (PERCENT_FULL - percent) / percent / MS_PER_SECOND;
+    }
+    state->etaSec = eta;
+    int32_t from = state->phaseFrom;
+    RaisePercent(*state, static_cast<int32_t>(from + (state->phaseTo - from) * percent / PERCENT_FULL));
+    Notify(opId, *state, false);
+}
+
+void OpProgressRegistry::Finish(const std::string &opId, int32_t err)
+{
+    auto state = GetState(opId, true);
+    state->lastError = err;
+    if (err == E_OK) {
+        state->percent = PERCENT_FULL;
+        state->etaSec = 0;
+    }
+    state->finishMs = NowMs();
+    state->phase = static_cast<int32_t>(err == E_OK ? OpPhase::DONE : OpPhase::FAILED);
+    LOGI("[L3:OpProgress] Finish: opId=%{public}s, err=%{public}d", opId.c_str(), err);
+    Notify(opId, *state, true);
+}
+
+bool OpProgressRegistry::Get(const std::string &opId, OpProgress &progress)
+{
+    auto state = GetState(opId, false);
+    if (state == nullptr) {
+        return false;
+    }
+    progress.phase = static_cast<OpPhase>(state->phase.load());
+    progress.bytesDone = state->bytesDone;
+    progress.bytesTotal = state->bytesTotal;
+    progress.percent = state->percent;
+    progress.etaSec = state->etaSec;
+    progress.lastError = state->lastError;
+    return true;
+}
+
+void OpProgressRegistry::Subscribe(const std::string &opId, OpProgressCallback callback)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    callbacks_[opId] = std::move(callback);
+}
+
+void OpProgressRegistry::Unsubscribe(const std::string &opId)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    callbacks_.erase(opId);
+}
+
+void OpProgressRegistry::Notify(const std::string &opId, State &state, bool force)
+{
+    int32_t percent = state.percent;
+    if (state.notified.exchange(percent) == percent && !force) {
+        return;
+    }
+    OpProgressCallback callback;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = callbacks_.find(opId);
+        if (it == callbacks_.end()) {
+            return;
+        }
+        callback = it->second;
+    }
+    OpProgress progress;
+    if (Get(opId, progress)) {
+        callback(opId, progress);
+    }
+}
+
+bool OpProgressParser::ParseLine(std::string_view line, OpProgressSample &sample)
+{
+    std::string text(line);
+    return ParseGrowisofs(text, sample) || ParseWodim(text, sample) || ParseIsoDone(text, sample) ||
+        ParseCounter(text, sample);
+}
+
+void OpProgressParser::Feed(const char *data, size_t len)
+{
+    auto apply = [this]() {
+        OpProgressSample sample;
+        if (!pending_.empty() && ParseLine(pending_, sample)) {
+            OpProgressRegistry::GetInstance().Update(opId_, sample);
+        }
+    };
+    for (size_t i = 0; i < len; i++) {
+        char c = data[i];
+        if (c == '\n' || c == '\r') {
+            apply();
+            pending_.clear();
+        } else if (c == '\b') {
+            // A counter redrawn with backspaces: the value just printed is complete.
+            if (!pending_.empty() && pending_.back() != ' ') {
+                apply();
+            }
+            pending_.push_back(' ');
+        } else {
+            pending_.push_back(c);
+        }
+        if (pending_.size() >= MAX_PENDING_LINE) {
+            pending_.clear();
+        }
+    }
+}
+
+OpProgressScope::OpProgressScope(const std::string &opId, OpPhase phase)
+    : opId_(opId), parser_(opId), prev_(g_currentScope)
+{
+    OpProgressRegistry::GetInstance().SetPhase(opId_, phase);
+    g_currentScope = this;
+    prevHook_ = SetThreadChildOutputHook([this](const char *data, size_t len) { parser_.Feed(data, len); });
+}
+
+OpProgressScope::~OpProgressScope()
+{
+    (void)SetThreadChildOutputHook(std::move(prevHook_));
+    g_currentScope = prev_;
+}
+
+void OpProgressScope::ReportBytes(uint64_t done, uint64_t total)
+{
+    if (g_currentScope == nullptr) {
+        return;
+    }
+    OpProgressSample sample;
+    sample.hasBytes = true;
+    sample.bytesDone = done;
+    sample.bytesTotal = total;
+    OpProgressRegistry::GetInstance().Update(g_currentScope->opId_, sample);
+}
+} // namespace StorageDaemon
+} // namespace OHOS
@@ -0,0 +1,323 @@
+/*
+ * Copyright (c) 2026 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "utils/proc_resource_scanner.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <iterator>
+#include <sstream>
+#include <thread>
+#include <unistd.h>
+
+#include "storage_service_log.h"
+#include "utils/string_utils.h"
+
+namespace OHOS {
+namespace StorageDaemon {
+namespace {
+constexpr int64_t SNAPSHOT_VALID_MS = 500;
+constexpr size_t MAX_SCAN_THREADS = 4;
+constexpr size_t MIN_PIDS_PER_THREAD = 64;
+constexpr size_t LINK_BUF_SIZE = 4096;
+constexpr size_t STAT_BUF_SIZE = 512;
+
+struct PartialScan {
+    std::vector<ProcResource> resources;
+    std::unordered_map<int32_t, std::string> names;
+};
+
+bool ReadLinkAt(int dirFd, const char *name, std::string &target)
+{
+    char buf[LINK_BUF_SIZE];
+    ssize_t len = readlinkat(dirFd, name, buf, sizeof(buf) - 1);
+    if (len <= 0) {
+        return false;
+    }
+    target.assign(buf, static_cast<size_t>(len));
+    return true;
+}
+
+// Same tokenisation as MountManager::GetProcessInfo so exclude lists keep matching.
+bool ReadProcessName(int pidFd, std::string &name)
+{
+    int fd = openat(pidFd, "stat", O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    char buf[STAT_BUF_SIZE];
+    ssize_t len = read(fd, buf, sizeof(buf) - 1);
+    (void)close(fd);
+    if (len <= 0) {
+        return false;
+    }
+    std::istringstream ss(std::string(buf, static_cast<size_t>(len)));
+    std::string pidStr;
+    ss >> pidStr >> name;
+    return !name.empty();
+}
+
+void CollectLinks(int pidFd, int32_t pid, uint32_t kinds, std::vector<ProcResource> &out)
+{
+    static const std::pair<const char *, ProcResourceKind> links[] = {
+        { "cwd", PROC_RES_CWD },
+        { "root", PROC_RES_ROOT },
+        { "exe", PROC_RES_EXE },
+    };
+    std::string target;
+    for (const auto &[name, kind] : links) {
+        if ((kinds & kind) != 0 && ReadLinkAt(pidFd, name, target)) {
+            out.push_back({ target, pid, kind });
+        }
+    }
+}
+
+void CollectFds(int pidFd, int32_t pid, std::vector<ProcResource> &out)
+{
+    int fd = openat(pidFd, "fd", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) {
+        return;
+    }
+    DIR *dir = fdopendir(fd);
+    if (dir == nullptr) {
+        (void)close(fd);
+        return;
+    }
+    std::string target;
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != nullptr) {
+        if (entry->d_type != DT_LNK) {
+            continue;
+        }
+        if (ReadLinkAt(dirfd(dir), entry->d_name, target)) {
+            out.push_back({ target, pid, PROC_RES_FD });
+        }
+    }
+    (void)closedir(dir);
+}
+
+void CollectMaps(int pidFd, int32_t pid, std::vector<ProcResource> &out)
+{
+    int fd = openat(pidFd, "maps", O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return;
+    }
+    FILE *file = fdopen(fd, "r");
+    if (file == nullptr) {
+        (void)close(fd);
+        return;
+    }
+    char *buf = nullptr;
+    size_t bufLen = 0;
+    ssize_t lineLen;
+    std::string last;
+    while ((lineLen = getline(&buf, &bufLen, file)) > 0) {
+        char *slash = static_cast<char *>(memchr(buf, '/', static_cast<size_t>(lineLen)));
+        if (slash == nullptr) {
+            continue;
+        }
+        size_t len = static_cast<size_t>(buf + lineLen - slash);
+        if (len > 0 && slash[len - 1] == '\n') {
+            len--;
+        }
+        // Segments of one mapped file are adjacent, skip them without a lookup.
+        if (last.size() == len && last.compare(0, len, slash, len) == 0) {
+            continue;
+        }
+        last.assign(slash, len);
+        out.push_back({ last, pid, PROC_RES_MAPS });
+    }
+    free(buf);
+    (void)fclose(file);
+}
+
+void CollectPid(int procFd, const std::string &pidName, uint32_t kinds, PartialScan &partial)
+{
+    int32_t pid = 0;
+    if (!ConvertStringToInt32(pidName, pid)) {
+        return;
+    }
+    int pidFd = openat(procFd, pidName.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (pidFd < 0) {
+        return;
+    }
+    std::string name;
+    if (!ReadProcessName(pidFd, name)) {
+        (void)close(pidFd);
+        return;
+    }
+    std::vector<ProcResource> local;
+    CollectLinks(pidFd, pid, kinds, local);
+    if ((kinds & PROC_RES_FD) != 0) {
+        CollectFds(pidFd, pid, local);
+    }
+    if ((kinds & PROC_RES_MAPS) != 0) {
+        CollectMaps(pidFd, pid, local);
+    }
+    (void)close(pidFd);
+
+    // One entry per (pid, path), so a process holding 100 fds on one file costs one slot.
+    std::sort(local.begin(), local.end(), [](const ProcResource &a, const ProcResource &b) {
+        return a.path < b.path;
+    });
+    for (auto &res : local) {
+        auto &out = partial.resources;
+        if (!out.empty() && out.back().pid == pid && out.back().path == res.path) {
+            out.back().kinds |= res.kinds;
+            continue;
+        }
+        out.push_back(std::move(res));
+    }
+    partial.names.emplace(pid, std::move(name));
+}
+} // namespace
+
+void ProcResourceSnapshot::ForEachWithPrefix(const std::string &prefix, uint32_t kinds,
+    const std::function<bool(const ProcResource &)> &visitor) const
+{
+    auto it = std::lower_bound(resources_.begin(), resources_.end(), prefix,
+        [](const ProcResource &res, const std::string &key) { return res.path < key; });
+    for (; it != resources_.end(); ++it) {
+        if (it->path.compare(0, prefix.size(), prefix) != 0) {
+            break;
+        }
+        if ((it->kinds & kinds) != 0 && !visitor(*it)) {
+            break;
+        }
+    }
+}
+
+std::string ProcResourceSnapshot::GetProcessName(int32_t pid) const
+{
+    auto it = names_.find(pid);
+    return it == names_.end() ? std::string() : it->second;
+}
+
+ProcResourceScanner &ProcResourceScanner::GetInstance()
+{
+    static ProcResourceScanner instance;
+    return instance;
+}
+
+std::shared_ptr<const ProcResourceSnapshot> ProcResourceScanner::GetSnapshot(uint32_t kinds)
+{
+    uint64_t generation = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto now = std::chrono::steady_clock::now();
+        if (snapshot_ != nullptr && (snapshot_->GetScannedKinds() & kinds) == kinds &&
+            std::chrono::duration_cast<std::chrono::milliseconds>(now - stamp_).count() < SNAPSHOT_VALID_MS) {
+            return snapshot_;
+        }
+        generation = generation_;
+    }
+    // The walk takes long on a busy device; doing it unlocked keeps other callers from queuing behind it.
+    auto start = std::chrono::steady_clock::now();
+    std::shared_ptr<const ProcResourceSnapshot> fresh = Scan("/proc", kinds);
+    if (fresh == nullptr) {
+        return nullptr;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    // A walk that overlapped an Invalidate may still list killed processes, so only this caller gets it.
+    if (generation == generation_ && (snapshot_ == nullptr || start >= stamp_)) {
+        snapshot_ = fresh;
+        stamp_ = start;
+    }
+    return fresh;
+}
+
+void ProcResourceScanner::Invalidate()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    snapshot_ = nullptr;
+    generation_++;
+}
+
+std::shared_ptr<ProcResourceSnapshot> ProcResourceScanner::Scan(const std::string &procRoot, uint32_t kinds)
+{
+    auto start = std::chrono::steady_clock::now();
+    int procFd = open(procRoot.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (procFd < 0) {
+        LOGE("[L8:ProcResourceScanner] Scan: <<< EXIT FAILED <<< open %{public}s failed, errno=%{public}d",
+            procRoot.c_str(), errno);
+        return nullptr;
+    }
+    std::vector<std::string> pids;
+    int listFd = dup(procFd);
+    DIR *dir = listFd < 0 ? nullptr : fdopendir(listFd);
+    if (dir == nullptr) {
+        LOGE("[L8:ProcResourceScanner] Scan: <<< EXIT FAILED <<< opendir failed, errno=%{public}d", errno);
+        if (listFd >= 0) {
+            (void)close(listFd);
+        }
+        (void)close(procFd);
+        return nullptr;
+    }
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != nullptr) {
+        if (entry->d_type == DT_DIR && StringIsNumber(entry->d_name)) {
+            pids.emplace_back(entry->d_name);
+        }
+    }
+    (void)closedir(dir);
+
+    size_t workers = std::min<size_t>(pids.size() / MIN_PIDS_PER_THREAD,
+        std::min<size_t>(MAX_SCAN_THREADS, std::max(1U, std::thread::hardware_concurrency())));
+    workers = std::max<size_t>(workers, 1);
+    std::vector<PartialScan> partials(workers);
+    auto work = [&pids, &partials, procFd, kinds, workers](size_t slot) {
+        for (size_t i = slot; i < pids.size(); i += workers) {
+            CollectPid(procFd, pids[i], kinds, partials[slot]);
+        }
+    };
+    std::vector<std::thread> threads;
+    for (size_t slot = 1; slot < workers; slot++) {
+        threads.emplace_back(work, slot);
+    }
+    work(0);
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    (void)close(procFd);
+
+    auto snapshot = std::make_shared<ProcResourceSnapshot>();
+    snapshot->scannedKinds_ = kinds;
+    size_t total = 0;
+    for (const auto &partial : partials) {
+        total += partial.resources.size();
+    }
+    snapshot->resources_.reserve(total);
+    for (auto &partial : partials) {
+        std::move(partial.resources.begin(), partial.resources.end(), std::back_inserter(snapshot->resources_));
+        snapshot->names_.merge(partial.names);
+    }
+    std::sort(snapshot->resources_.begin(), snapshot->resources_.end(),
+        [](const ProcResource &a, const ProcResource &b) {
+            int cmp = a.path.compare(b.path);
+            return cmp != 0 ? cmp < 0 : a.pid < b.pid;
+        });
+    auto cost = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    LOGI("[L8:ProcResourceScanner] Scan: pids=%{public}zu, entries=%{public}zu, threads=%{public}zu, "
+        "cost=%{public}lld ms", snapshot->names_.size(), snapshot->resources_.size(), workers,
+        static_cast<long long>(cost.count()));
+    return snapshot;
+}
+} // namespace StorageDaemon
+} // namespace OHOS
@@ -0,0 +1,197 @@
+/*
+ * Copyright (c) 2026 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "utils/relabel_engine.h"
+
+#include <cerrno>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <fstream>
+#include <pthread.h>
+#include <sys/xattr.h>
+
+#include "storage_service_errno.h"
+#include "storage_service_log.h"
+#ifdef USE_LIBRESTORECON
+#include "policycoreutils.h"
+#endif
+
+namespace OHOS {
+namespace StorageDaemon {
+namespace {
+constexpr const char *FILE_CONTEXTS = "/system/etc/selinux/targeted/contexts/file_contexts";
+constexpr uint64_t FNV_OFFSET_BASIS = 14695981039346656037ULL;
+constexpr uint64_t FNV_PRIME = 1099511628211ULL;
+constexpr size_t DIGEST_BUF_SIZE = 64 * 1024;
+
+int32_t RestoreconPath(const std::string &path)
+{
+#ifdef USE_LIBRESTORECON
+    return Restorecon(path.c_str()) == 0 ? E_OK : E_ERR;
+#else
+    (void)path;
+    return E_OK;
+#endif
+}
+
+int64_t NowMs()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+} // namespace
+
+RelabelEngine &RelabelEngine::GetInstance()
+{
+#ifdef USE_LIBRESTORECON
+    static RelabelEngine instance(RestoreconPath, ComputePolicyDigest({ FILE_CONTEXTS }));
+#else
+    static RelabelEngine instance(RestoreconPath, "");
+#endif
+    return instance;
+}
+
+// FNV-1a over the policy files; empty when none of them can be read, which turns the skipping off.
+std::string RelabelEngine::ComputePolicyDigest(const std::vector<std::string> &policyFiles)
+{
+    uint64_t hash = FNV_OFFSET_BASIS;
+    bool found = false;
+    std::vector<char> buf(DIGEST_BUF_SIZE);
+    for (const auto &file : policyFiles) {
+        std::ifstream in(file, std::ios::binary);
+        if (!in.is_open()) {
+            continue;
+        }
+        found = true;
+        while (in.read(buf.data(), buf.size()) || in.gcount() > 0) {
+            for (std::streamsize i = 0; i < in.gcount(); i++) {
+                hash = (hash ^ static_cast<uint8_t>(buf[i])) * FNV_PRIME;
+            }
+        }
+    }
+    if (!found) {
+        return "";
+    }
+    char digest[sizeof(uint64_t) * 2 + 1] = { 0 };
+    (void)snprintf(digest, sizeof(digest), "%016" PRIx64, hash);
+    return digest;
+}
+
+RelabelEngine::RelabelEngine(RelabelFunc labeler, const std::string &policyDigest)
+    : labeler_(std::move(labeler)), digest_(policyDigest)
+{
+}
+
+RelabelEngine::~RelabelEngine()
+{
+    // Trees not started yet are dropped; they are relabeled on the next request as their digest is not stored.
+    std::thread worker;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_.clear();
+        worker.swap(worker_);
+    }
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+int32_t RelabelEngine::Relabel(const std::string &path)
+{
+    int32_t ret = labeler_(path);
+    if (ret != E_OK) {
+        LOGE("[L8:RelabelEngine] Relabel: %{public}s failed, ret=%{public}d", path.c_str(), ret);
+    }
+    return ret;
+}
+
+int32_t RelabelEngine::RelabelTree(const std::string &path, TreeFixResult &result)
+{
+    LOGI("[L8:RelabelEngine] RelabelTree: >>> ENTER <<< path=%{public}s", path.c_str());
+    TreeFixSpec spec;
+    spec.relabel = labeler_;
+    if (!digest_.empty()) {
+        spec.pruneXattr = RELABEL_DIGEST_XATTR;
+        spec.pruneValue = digest_;
+    }
+    int32_t ret = FixTreeAttrs(path, spec, result);
+    if (ret != E_OK) {
+        LOGE("[L8:RelabelEngine] RelabelTree: <<< EXIT FAILED <<< path=%{public}s, failed=%{public}" PRIu64,
+            path.c_str(), result.failed);
+        return ret;
+    }
+    // Only the root gets the digest; a root skipped as current has it already.
+    bool rootPruned = result.pruned > 0 && result.changed + result.skipped == 0;
+    if (!digest_.empty() && !rootPruned &&
+        lsetxattr(path.c_str(), RELABEL_DIGEST_XATTR, digest_.c_str(), digest_.size(), 0) != 0) {
+        LOGE("[L8:RelabelEngine] RelabelTree: store digest failed, errno=%{public}d", errno);
+    }
+    LOGI("[L8:RelabelEngine] RelabelTree: <<< EXIT SUCCESS <<< path=%{public}s, labeled=%{public}" PRIu64
+        ", pruned=%{public}" PRIu64, path.c_str(), result.changed + result.skipped, result.pruned);
+    return E_OK;
+}
+
+void RelabelEngine::RelabelTreeDeferred(const std::string &path, RelabelDoneFunc done)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    pending_.push_back({ path, std::move(done) });
+    LOGI("[L8:RelabelEngine] RelabelTreeDeferred: queued %{public}s, pending=%{public}zu", path.c_str(),
+        pending_.size());
+    StartWorkerLocked();
+}
+
+void RelabelEngine::WaitIdle()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    idleCv_.wait(lock, [this]() { return !running_; });
+}
+
+void RelabelEngine::StartWorkerLocked()
+{
+    if (running_) {
+        return;
+    }
+    // The last worker has left Drain by the time running_ is false, so this join does not block for long.
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+    running_ = true;
+    worker_ = std::thread([this]() { Drain(); });
+}
+
+void RelabelEngine::Drain()
+{
+    pthread_setname_np(pthread_self(), "relabel_engine");
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!pending_.empty()) {
+        Job job = std::move(pending_.front());
+        pending_.pop_front();
+        lock.unlock();
+        RelabelReport report;
+        report.path = job.path;
+        int64_t start = NowMs();
+        report.err = RelabelTree(job.path, report.result);
+        report.durationMs = NowMs() - start;
+        if (job.done) {
+            job.done(report);
+        }
+        lock.lock();
+    }
+    running_ = false;
+    idleCv_.notify_all();
+}
+} // namespace StorageDaemon
+} // namespace OHOS
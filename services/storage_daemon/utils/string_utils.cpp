@@ -14,14 +14,19 @@
  */
 
 #include "utils/string_utils.h"
+#include "utils/string_view_utils.h"
 #include "utils/file_utils.h"
 #include "utils/hi_audit.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdarg>
+#include <charconv>
+#include <cstring>
 #include <dirent.h>
 #include <fcntl.h>
 #include <regex>
 #include <unistd.h>
 #include <memory>
-#include <sstream>
 #include <cinttypes>
 
 #include "res_type.h"
@@ -44,6 +49,11 @@ static constexpr int32_t FOUR_CHARACTER = 4;
 static constexpr int32_t FIVE_CHARACTER = 5;
 constexpr size_t LOCAL_ID_LIST_LEN = 100;
 constexpr size_t INPUT_LIST_LEN = 50000;
+constexpr size_t MAX_INT32_DIGITS = 10;
+constexpr int32_t MIN_NUMBER_BASE = 2;
+constexpr int32_t MAX_NUMBER_BASE = 36;
+constexpr int32_t BASE_HEX = 16;
+constexpr size_t HEX_PREFIX_LEN = 2;
 std::string StringPrintf(const char *format, ...)
 {
     va_list ap;
@@ -78,24 +88,55 @@ std::string StringPrintf(const char *format, ...)
     return result;
 }
 
-std::vector<std::string> SplitLine(std::string &line, std::string &token)
+// memchr is vectorized by libc, so the scan for the first byte of the token runs a word at a time.
+static size_t FindToken(std::string_view line, std::string_view token, size_t start)
 {
-    std::vector<std::string> result;
-    std::string::size_type start;
-    std::string::size_type end;
+    const char *begin = line.data();
+    const char *end = begin + line.size();
+    const char *pos = begin + start;
+    while (static_cast<size_t>(end - pos) >= token.size()) {
+        pos = static_cast<const char *>(memchr(pos, token[0], end - pos - token.size() + 1));
+        if (pos == nullptr) {
+            return std::string_view::npos;
+        }
+        if (memcmp(pos + 1, token.data() + 1, token.size() - 1) == 0) {
+            return pos - begin;
+        }
+        pos++;
+    }
+    return std::string_view::npos;
+}
 
-    start = 0;
-    end = line.find(token);
-    while (std::string::npos != end) {
+std::vector<std::string_view> SplitView(std::string_view line, std::string_view token)
+{
+    std::vector<std::string_view> result;
+    if (token.empty()) {
+        if (!line.empty()) {
+            result.push_back(line);
+        }
+        return result;
+    }
+    size_t start = 0;
+    size_t end = FindToken(line, token, start);
+    while (end != std::string_view::npos) {
         result.push_back(line.substr(start, end - start));
         start = end + token.size();
-        end = line.find(token, start);
+        end = FindToken(line, token, start);
     }
-
-    if (start != line.length()) {
+    if (start != line.size()) {
         result.push_back(line.substr(start));
     }
+    return result;
+}
 
+std::vector<std::string> SplitLine(std::string &line, std::string &token)
+{
+    auto views = SplitView(line, token);
+    std::vector<std::string> result;
+    result.reserve(views.size());
+    for (auto view : views) {
+        result.emplace_back(view);
+    }
     return result;
 }
 
@@ -160,19 +201,22 @@ bool SaveStringToFileSync(const std::string &path, const std::string &data, std:
     return ret;
 }
 
-bool StringIsNumber(const std::string &content)
+bool IsAllDigits(std::string_view content)
 {
     if (content.empty()) {
         return false;
     }
-    bool isNum = true;
     for (char c : content) {
-        if (!isdigit(c)) {
-            isNum = false;
-            break;
+        if (c < '0' || c > '9') {
+            return false;
         }
     }
-    return isNum;
+    return true;
+}
+
+bool StringIsNumber(const std::string &content)
+{
+    return IsAllDigits(content);
 }
 
 bool IsStringExist(const std::list<std::string> &strList, const std::string &content)
@@ -201,23 +245,17 @@ void GetAllUserIds(std::vector<int32_t> &userIds)
         LOGE("[L8:StringUtils] GetAllUserIds: <<< EXIT FAILED <<< open dir failed, errno=%{public}d", errno);
         return;
     }
-    std::regex pattern("^[1-9]\\d*$");
     struct dirent *entry;
     while ((entry = readdir(procDir.get())) != nullptr) {
         if (entry->d_type != DT_DIR) {
             continue;
         }
-        std::string name = entry->d_name;
-        if (!std::regex_match(name, pattern)) {
-            continue;
-        }
-        char *endptr = nullptr;
-        errno = 0;
-        int64_t tollRes = strtoll(name.c_str(), &endptr, BASE_DECIMAL);
-        if (errno != 0 || endptr != name.c_str() + name.size()) {
+        std::string_view name = entry->d_name;
+        if (!IsAllDigits(name) || name[0] == '0') {
             continue;
         }
-        if (tollRes < INT32_MIN || tollRes > INT32_MAX) {
+        int64_t tollRes = 0;
+        if (!ParseInt64(name, tollRes) || tollRes > INT32_MAX) {
             continue;
         }
         int32_t userId = static_cast<int32_t>(tollRes);
@@ -229,53 +267,115 @@ void GetAllUserIds(std::vector<int32_t> &userIds)
     LOGD("[L8:StringUtils] GetAllUserIds: <<< EXIT SUCCESS <<< userIdCount=%{public}zu", userIds.size());
 }
 
-bool ConvertStringToInt(const std::string &str, int64_t &value, int32_t base)
+bool ParseInt64(std::string_view str, int64_t &value, int32_t base)
 {
-    if (str.empty()) {
+    if (str.empty() || base < MIN_NUMBER_BASE || base > MAX_NUMBER_BASE) {
+        return false;
+    }
+    int64_t result = 0;
+    const char *end = str.data() + str.size();
+    auto [ptr, ec] = std::from_chars(str.data(), end, result, base);
+    if (ec != std::errc() || ptr != end) {
         return false;
     }
+    value = result;
+    return true;
+}
 
-    errno = 0;
-    char* endptr = nullptr;
+static bool IsDigitOfBase(char c, int32_t base)
+{
+    int32_t digit = MAX_NUMBER_BASE;
+    if (c >= '0' && c <= '9') {
+        digit = c - '0';
+    } else if (c >= 'a' && c <= 'z') {
+        digit = c - 'a' + BASE_DECIMAL;
+    } else if (c >= 'A' && c <= 'Z') {
+        digit = c - 'A' + BASE_DECIMAL;
+    }
+    return digit < base;
+}
 
-    int64_t result = std::strtoll(str.c_str(), &endptr, base);
-    
-    if (endptr == str.c_str()) {
-        return false;
+bool ConvertStringToInt(const std::string &str, int64_t &value, int32_t base)
+{
+    // Accept what strtoll accepted before: leading blanks, a '+' sign, a 0x prefix in base 16 and
+    // the prefix based base 0. ParseInt64 takes the rest.
+    std::string_view digits = str;
+    size_t pos = 0;
+    while (pos < digits.size() && isspace(static_cast<unsigned char>(digits[pos]))) {
+        pos++;
     }
-    if (errno == ERANGE && (result == LLONG_MAX || result == LLONG_MIN)) {
-        return false;
+    digits.remove_prefix(pos);
+    bool negative = false;
+    if (!digits.empty() && (digits[0] == '+' || digits[0] == '-')) {
+        negative = digits[0] == '-';
+        digits.remove_prefix(1);
+    }
+    bool hexPrefix = digits.size() > HEX_PREFIX_LEN && digits[0] == '0' && (digits[1] == 'x' || digits[1] == 'X') &&
+        IsDigitOfBase(digits[HEX_PREFIX_LEN], BASE_HEX);
+    if (base == 0) {
+        base = hexPrefix ? BASE_HEX : (!digits.empty() && digits[0] == '0' ? BASE_OCTAL : BASE_DECIMAL);
     }
-    if (*endptr != '\0') {
+    if (hexPrefix && base == BASE_HEX) {
+        digits.remove_prefix(HEX_PREFIX_LEN);
+    }
+    if (digits.empty() || digits[0] == '+' || digits[0] == '-') {
         return false;
     }
+    int64_t result = 0;
+    if (!negative) {
+        if (!ParseInt64(digits, result, base)) {
+            return false;
+        }
+    } else {
+        // Parsed with its sign, so that INT64_MIN does not overflow.
+        std::string withSign = "-";
+        withSign.append(digits);
+        if (!ParseInt64(withSign, result, base)) {
+            return false;
+        }
+    }
     value = result;
     LOGD("[L8:StringUtils] ConvertStringToInt: <<< EXIT SUCCESS <<< value=%{public}" PRId64, value);
     return true;
 }
 
-std::unordered_map<std::string, std::string> ParseKeyValuePairs(const std::string &input, char delimiter)
+void ParseKeyValueViews(std::string_view input, char delimiter, std::vector<KeyValueView> &pairs)
 {
-    std::unordered_map<std::string, std::string> result;
-    std::istringstream ss(input);
-    std::string token;
-    
-    while (std::getline(ss, token, delimiter)) {
+    pairs.clear();
+    size_t start = 0;
+    while (start < input.size()) {
+        size_t end = input.find(delimiter, start);
+        if (end == std::string_view::npos) {
+            end = input.size();
+        }
+        std::string_view token = input.substr(start, end - start);
+        start = end + 1;
         size_t equalPos = token.find('=');
-        if (equalPos != std::string::npos) {
-            std::string key = token.substr(0, equalPos);
-            std::string value = token.substr(equalPos + 1);
-            if (!key.empty()) {
-                result[key] = value;
-            }
+        std::string_view key = token.substr(0, equalPos);
+        std::string_view value = equalPos == std::string_view::npos ? std::string_view() : token.substr(equalPos + 1);
+        if (key.empty()) {
+            continue;
+        }
+        auto it = std::find_if(pairs.begin(), pairs.end(), [key](const KeyValueView &pair) {
+            return pair.first == key;
+        });
+        if (it != pairs.end()) {
+            it->second = value;
         } else {
-            std::string key = token;
-            if (!key.empty()) {
-                result[key] = "";
-            }
+            pairs.emplace_back(key, value);
         }
     }
-    
+}
+
+std::unordered_map<std::string, std::string> ParseKeyValuePairs(const std::string &input, char delimiter)
+{
+    std::vector<KeyValueView> pairs;
+    ParseKeyValueViews(input, delimiter, pairs);
+    std::unordered_map<std::string, std::string> result;
+    result.reserve(pairs.size());
+    for (const auto &pair : pairs) {
+        result.emplace(pair.first, pair.second);
+    }
     return result;
 }
 
@@ -284,31 +384,48 @@ int32_t ReplaceAndCount(std::string &str, const std::string &target, const std::
     if (str.empty() || target.empty()) {
         return 0;
     }
-    
+    size_t pos = FindToken(str, target, 0);
+    if (pos == std::string::npos) {
+        return 0;
+    }
+    // One pass instead of replace() per match, which moved the whole tail every time. A replacement no
+    // longer than the target is compacted in place, as the write position never passes the read position.
     int32_t count = 0;
-    size_t pos = 0;
-    while ((pos = str.find(target, pos)) != std::string::npos) {
-        str.replace(pos, target.length(), replacement);
-        pos += replacement.length();
+    size_t start = 0;
+    if (replacement.size() <= target.size()) {
+        size_t out = 0;
+        while (pos != std::string::npos) {
+            std::copy(str.begin() + start, str.begin() + pos, str.begin() + out);
+            out += pos - start;
+            std::copy(replacement.begin(), replacement.end(), str.begin() + out);
+            out += replacement.size();
+            start = pos + target.size();
+            count++;
+            pos = FindToken(str, target, start);
+        }
+        str.erase(out, start - out);
+        return count;
+    }
+    std::string result;
+    result.reserve(str.size() + replacement.size());
+    while (pos != std::string::npos) {
+        result.append(str, start, pos - start).append(replacement);
+        start = pos + target.size();
         count++;
+        pos = FindToken(str, target, start);
     }
-    
+    result.append(str, start, std::string::npos);
+    str.swap(result);
     return count;
 }
 
 bool ConvertStringToInt32(const std::string &context, int32_t &value)
 {
-    if (context.empty()) {
-        return false;
-    }
-    std::regex pattern(R"(^([1-9]\d{0,9})$)");
-    if (!std::regex_match(context, pattern)) {
+    if (context.size() > MAX_INT32_DIGITS || !IsAllDigits(context) || context[0] == '0') {
         return false;
     }
-    char *endptr;
-    errno = 0;
-    int64_t tollRes = strtoll(context.c_str(), &endptr, BASE_DECIMAL);
-    if (errno != 0 || endptr != context.c_str() + context.size()) {
+    int64_t tollRes = 0;
+    if (!ParseInt64(context, tollRes)) {
         return false;
     }
     if (tollRes <= 0 || tollRes >= INT32_MAX) {
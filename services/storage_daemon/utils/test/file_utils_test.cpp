@@ -13,15 +13,22 @@
  * limitations under the License.
  */
 
+#include <atomic>
+#include <chrono>
+#include <dlfcn.h>
+#include <csignal>
 #include <fcntl.h>
 #include <sys/mount.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <sys/wait.h>
 #include <fstream>
 #include <filesystem>
 #include <fstream>
+#include <thread>
 
 #include "directory_ex.h"
+#include "file_ex.h"
 #include "gtest/gtest.h"
 #include "common/help_utils.h"
 #include "storage_service_errno.h"
@@ -30,6 +37,45 @@
 #include "utils/storage_radar.h"
 #include "parameter.h"
 
+namespace {
+// Attribute writes issued by the code under test, counted by the interposers below.
+std::atomic<uint32_t> g_attrWriteCount { 0 };
+
+template <typename Func>
+Func NextSymbol(const char *name)
+{
+    return reinterpret_cast<Func>(dlsym(RTLD_NEXT, name));
+}
+}
+
+extern "C" int fchmod(int fd, mode_t mode)
+{
+    g_attrWriteCount++;
+    static auto next = NextSymbol<int (*)(int, mode_t)>("fchmod");
+    return next(fd, mode);
+}
+
+extern "C" int fchmodat(int dirFd, const char *name, mode_t mode, int flags)
+{
+    g_attrWriteCount++;
+    static auto next = NextSymbol<int (*)(int, const char *, mode_t, int)>("fchmodat");
+    return next(dirFd, name, mode, flags);
+}
+
+extern "C" int fchown(int fd, uid_t uid, gid_t gid)
+{
+    g_attrWriteCount++;
+    static auto next = NextSymbol<int (*)(int, uid_t, gid_t)>("fchown");
+    return next(fd, uid, gid);
+}
+
+extern "C" int fchownat(int dirFd, const char *name, uid_t uid, gid_t gid, int flags)
+{
+    g_attrWriteCount++;
+    static auto next = NextSymbol<int (*)(int, const char *, uid_t, gid_t, int)>("fchownat");
+    return next(dirFd, name, uid, gid, flags);
+}
+
 namespace OHOS {
 namespace StorageDaemon {
 using namespace testing::ext;
@@ -37,6 +83,12 @@ using namespace testing::ext;
 constexpr int NOT_EXIST_FD_1 = 45678;
 constexpr int NOT_EXIST_FD_2 = 45679;
 constexpr const char *READ_FILE_TEST_PATH = "/data/service/read_file_test.txt";
+constexpr size_t RUN_CHILD_CAP = 4096;
+constexpr size_t RUN_CHILD_SPAM = 1024 * 1024;
+constexpr int32_t RUN_CHILD_TIMEOUT_MS = 200;
+constexpr int64_t RUN_CHILD_MAX_WAIT_MS = 3000;
+constexpr size_t RUN_CHILD_PERF_RSS = 512 * 1024 * 1024;
+constexpr int RUN_CHILD_PERF_ROUNDS = 100;
 namespace {
     const uint32_t ALL_PERMS = (S_ISUID | S_ISGID | S_ISVTX | S_IRWXU | S_IRWXG | S_IRWXO);
     const std::string PATH_CHMOD = "/data/storage_daemon_chmod_test_dir";
@@ -44,6 +96,7 @@ namespace {
     const std::string PATH_RMDIR = "/data/storage_daemon_rmdir_test_dir";
     const std::string PATH_MKDIR = "/data/storage_daemon_mkdir_test_dir";
     const std::string PATH_MOUNT = "/data/storage_daemon_mount_test_dir";
+    const std::string PATH_RM_JOURNAL = "/data/storage_daemon_rm_trash_journal";
 }
 
 int32_t ChMod(const std::string &path, mode_t mode);
@@ -53,7 +106,10 @@ std::string MaskSensitiveInfo(const std::string &input);
 
 class FileUtilsTest : public testing::Test {
 public:
-    static void SetUpTestCase(void) {};
+    static void SetUpTestCase(void)
+    {
+        SetDeferredRemovalJournal(PATH_RM_JOURNAL);
+    };
     static void TearDownTestCase(void) {};
     void SetUp();
     void TearDown();
@@ -577,6 +633,143 @@ HWTEST_F(FileUtilsTest, FileUtilsTest_ForkExec_003, TestSize.Level1)
     GTEST_LOG_(INFO) << "FileUtilsTest_ForkExec_003 end";
 }
 
+/**
+ * @tc.name: FileUtilsTest_RunChild_001
+ * @tc.desc: Verify RunChild keeps stdout and stderr apart, caps them and reports abnormal exits.
+ * @tc.type: FUNC
+ */
+HWTEST_F(FileUtilsTest, FileUtilsTest_RunChild_001, TestSize.Level1)
+{
+    GTEST_LOG_(INFO) << "FileUtilsTest_RunChild_001 start";
+    ChildRunOptions options;
+    ChildRunResult result;
+    ASSERT_EQ(RunChild({"sh", "-c", "printf out; printf err >&2; exit 3"}, options, result), E_OK);
+    EXPECT_TRUE(WIFEXITED(result.status));
+    EXPECT_EQ(WEXITSTATUS(result.status), 3);
+    EXPECT_EQ(result.out, "out");
+    EXPECT_EQ(result.err, "err");
+    EXPECT_FALSE(result.timedOut);
+
+    options.outCap = RUN_CHILD_CAP;
+    options.errCap = 0;
+    ASSERT_EQ(RunChild({"sh", "-c", "head -c 1048576 /dev/zero; head -c 1048576 /dev/zero >&2"}, options, result),
+              E_OK);
+    EXPECT_EQ(WEXITSTATUS(result.status), 0);
+    EXPECT_EQ(result.out.size(), RUN_CHILD_CAP);
+    EXPECT_EQ(result.outDropped, RUN_CHILD_SPAM - RUN_CHILD_CAP);
+    EXPECT_TRUE(result.err.empty());
+    EXPECT_EQ(result.errDropped, RUN_CHILD_SPAM);
+
+    ASSERT_EQ(RunChild({"sh", "-c", "printf partial; kill -SEGV $$"}, options, result), E_OK);
+    EXPECT_TRUE(WIFSIGNALED(result.status));
+    EXPECT_EQ(WTERMSIG(result.status), SIGSEGV);
+    EXPECT_EQ(result.out, "partial");
+
+    ASSERT_EQ(RunChild({"storage_daemon_no_such_tool"}, options, result), E_OK);
+    EXPECT_EQ(WEXITSTATUS(result.status), 127);
+    EXPECT_EQ(result.error, ENOENT);
+    EXPECT_EQ(RunChild({}, options, result), E_PARAMS_INVALID);
+
+    std::vector<std::string> cmd = {"sh", "-c", "kill -SEGV $$"};
+    EXPECT_EQ(ForkExec(cmd), E_WIFEXITED);
+    cmd = {"storage_daemon_no_such_tool"};
+    int exitStatus = 0;
+    EXPECT_EQ(ForkExecWithExit(cmd, &exitStatus), E_WEXITSTATUS);
+    EXPECT_EQ(exitStatus, 127);
+    GTEST_LOG_(INFO) << "FileUtilsTest_RunChild_001 end";
+}
+
+/**
+ * @tc.name: FileUtilsTest_RunChild_002
+ * @tc.desc: Verify a hung child is stopped with SIGTERM, or SIGKILL when it ignores SIGTERM.
+ * @tc.type: FUNC
+ */
+HWTEST_F(FileUtilsTest, FileUtilsTest_RunChild_002, TestSize.Level1)
+{
+    GTEST_LOG_(INFO) << "FileUtilsTest_RunChild_002 start";
+    ChildRunOptions options;
+    options.timeoutMs = RUN_CHILD_TIMEOUT_MS;
+    options.termGraceMs = RUN_CHILD_TIMEOUT_MS;
+    options.newGroup = true;
+    ChildRunResult result;
+    auto start = std::chrono::steady_clock::now();
+    ASSERT_EQ(RunChild({"sh", "-c", "printf started; sleep 10"}, options, result), E_OK);
+    EXPECT_TRUE(result.timedOut);
+    EXPECT_TRUE(WIFSIGNALED(result.status));
+    EXPECT_EQ(WTERMSIG(result.status), SIGTERM);
+    EXPECT_EQ(result.out, "started");
+
+    ASSERT_EQ(RunChild({"sh", "-c", "trap '' TERM; sleep 10"}, options, result), E_OK);
+    EXPECT_TRUE(result.timedOut);
+    EXPECT_EQ(WTERMSIG(result.status), SIGKILL);
+    auto cost = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    EXPECT_LT(cost.count(), RUN_CHILD_MAX_WAIT_MS);
+
+    options.timeoutMs = 0;
+    options.termGraceMs = 0;
+    ASSERT_EQ(RunChild({"sh", "-c", "sleep 10"}, options, result), E_OK);
+    EXPECT_EQ(WTERMSIG(result.status), SIGKILL);
+    GTEST_LOG_(INFO) << "FileUtilsTest_RunChild_002 end";
+}
+
+/**
+ * @tc.name: FileUtilsTest_RunChild_003
+ * @tc.desc: Verify RunChild returns at the child's exit even if a grandchild keeps the output pipe open.
+ * @tc.type: FUNC
+ */
+HWTEST_F(FileUtilsTest, FileUtilsTest_RunChild_003, TestSize.Level1)
+{
+    GTEST_LOG_(INFO) << "FileUtilsTest_RunChild_003 start";
+    ChildRunOptions options;
+    options.newGroup = true;
+    pid_t child = -1;
+    options.onSpawn = [&child](pid_t pid) { child = pid; };
+    ChildRunResult result;
+    auto start = std::chrono::steady_clock::now();
+    ASSERT_EQ(RunChild({"sh", "-c", "sleep 10 & echo done"}, options, result), E_OK);
+    auto cost = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    ASSERT_GT(child, 0);
+    (void)kill(-child, SIGKILL);
+    EXPECT_EQ(WEXITSTATUS(result.status), 0);
+    EXPECT_EQ(result.out, "done\n");
+    EXPECT_LT(cost.count(), RUN_CHILD_MAX_WAIT_MS);
+    GTEST_LOG_(INFO) << "FileUtilsTest_RunChild_003 end";
+}
+
+/**
+ * @tc.name: FileUtilsTest_RunChild_Perf_001
+ * @tc.desc: Log spawn latency of RunChild against fork+exec while the parent holds a large resident set.
+ * @tc.type: PERF
+ */
+HWTEST_F(FileUtilsTest, FileUtilsTest_RunChild_Perf_001, TestSize.Level3)
+{
+    GTEST_LOG_(INFO) << "FileUtilsTest_RunChild_Perf_001 start";
+    std::vector<char> ballast(RUN_CHILD_PERF_RSS, 1);
+    ChildRunOptions options;
+    ChildRunResult result;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < RUN_CHILD_PERF_ROUNDS; i++) {
+        ASSERT_EQ(RunChild({"true"}, options, result), E_OK);
+    }
+    auto spawnCost = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < RUN_CHILD_PERF_ROUNDS; i++) {
+        pid_t pid = fork();
+        ASSERT_GE(pid, 0);
+        if (pid == 0) {
+            execlp("true", "true", nullptr);
+            _exit(1);
+        }
+        int status = 0;
+        ASSERT_EQ(waitpid(pid, &status, 0), pid);
+    }
+    auto forkCost = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    GTEST_LOG_(INFO) << "rss " << (RUN_CHILD_PERF_RSS >> 20) << " MiB, per child: RunChild "
+                     << spawnCost.count() / RUN_CHILD_PERF_ROUNDS << " us, fork+exec "
+                     << forkCost.count() / RUN_CHILD_PERF_ROUNDS << " us";
+    GTEST_LOG_(INFO) << "FileUtilsTest_RunChild_Perf_001 end";
+}
+
 /**
  * @tc.name: FileUtilsTest_RedirectStdToPipe_001
  * @tc.desc: Verify the RedirectStdToPipe function.
@@ -1472,5 +1665,259 @@ HWTEST_F(FileUtilsTest, FileUtilsTest_ExtStorageMountForkExec_EmptyCmd, TestSize
     EXPECT_EQ(ExtStorageMountForkExec(cmd, &exitStatus), E_PARAMS_INVALID);
 }
 #endif
+/**
+ * @tc.name: FileUtilsTest_RmDirRecurse_001
+ * @tc.desc: Verify RmDirRecurse removes a wide nested tree but never follows symlinks out of it.
+ * @tc.type: FUNC
+ * @tc.require: AR000GK4HB
+ */
+HWTEST_F(FileUtilsTest, FileUtilsTest_RmDirRecurse_001, TestSize.Level1)
+{
+    GTEST_LOG_(INFO) << "FileUtilsTest_RmDirRecurse_001 start";
+    std::string outside = PATH_MKDIR + "/outside";
+    ASSERT_TRUE(MkDirRecurse(outside, S_IRWXU));
+    ASSERT_TRUE(SaveStringToFile(outside + "/keep", "keep"));
+
+    const int dirCount = 40;
+    for (int i = 0; i < dirCount; i++) {
+        std::string sub = PATH_RMDIR + "/d" + std::to_string(i) + "/a/b";
+        ASSERT_TRUE(MkDirRecurse(sub, S_IRWXU));
+        ASSERT_TRUE(SaveStringToFile(sub + "/f", "x"));
+        ASSERT_TRUE(SaveStringToFile(PATH_RMDIR + "/f" + std::to_string(i), "x"));
+    }
+    ASSERT_EQ(symlink(outside.c_str(), (PATH_RMDIR + "/d0/a/link").c_str()), 0);
+    ASSERT_EQ(mkfifo((PATH_RMDIR + "/fifo").c_str(), S_IRWXU), 0);
+
+    EXPECT_TRUE(RmDirRecurse(PATH_RMDIR + "/"));
+    EXPECT_FALSE(IsDir(PATH_RMDIR));
+    EXPECT_TRUE(IsFile(outside + "/keep"));
+    EXPECT_TRUE(RmDirRecurse(PATH_RMDIR));
+
+    EXPECT_FALSE(RmDirRecurse(outside + "/keep"));
+    EXPECT_FALSE(RmDirRecurse("/"));
+    GTEST_LOG_(INFO) << "FileUtilsTest_RmDirRecurse_001 end";
+}
+
+/**
+ * @tc.name: FileUtilsTest_RmDirRecurseDeferred_001
+ * @tc.desc: Verify a deferred removal frees the path at once and the tree is gone afterwards.
+ * @tc.type: FUNC
+ * @tc.require: AR000GK4HB
+ */
+HWTEST_F(FileUtilsTest, FileUtilsTest_RmDirRecurseDeferred_001, TestSize.Level1)
+{
+    GTEST_LOG_(INFO) << "FileUtilsTest_RmDirRecurseDeferred_001 start";
+    ASSERT_TRUE(MkDirRecurse(PATH_RMDIR + "/user/base/app", S_IRWXU));
+    ASSERT_TRUE(SaveStringToFile(PATH_RMDIR + "/user/base/app/f", "x"));
+
+    EXPECT_TRUE(RmDirRecurseDeferred(PATH_RMDIR + "/user"));
+    EXPECT_FALSE(IsDir(PATH_RMDIR + "/user"));
+    ASSERT_TRUE(MkDirRecurse(PATH_RMDIR + "/user", S_IRWXU));
+
+    std::vector<std::string> left;
+    for (int waitRounds = 0; waitRounds < 100; waitRounds++) {
+        left.clear();
+        GetSubDirs(PATH_RMDIR, left);
+        if (left.size() == 1 && access(PATH_RM_JOURNAL.c_str(), F_OK) != 0) {
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    ASSERT_EQ(left.size(), 1U);
+    EXPECT_EQ(left[0], "user");
+    EXPECT_NE(access(PATH_RM_JOURNAL.c_str(), F_OK), 0);
+    EXPECT_TRUE(RmDirRecurseDeferred(PATH_RMDIR + "/none"));
+    GTEST_LOG_(INFO) << "FileUtilsTest_RmDirRecurseDeferred_001 end";
+}
+
+/**
+ * @tc.name: FileUtilsTest_ResumeDeferredRemoval_001
+ * @tc.desc: Verify trash dirs left in the journal are removed on resume and entries that are not trash are kept.
+ * @tc.type: FUNC
+ * @tc.require: AR000GK4HB
+ */
+HWTEST_F(FileUtilsTest, FileUtilsTest_ResumeDeferredRemoval_001, TestSize.Level1)
+{
+    GTEST_LOG_(INFO) << "FileUtilsTest_ResumeDeferredRemoval_001 start";
+    std::string trash = PATH_RMDIR + "/.sd_trash.user.1";
+    std::string keep = PATH_RMDIR + "/user";
+    ASSERT_TRUE(MkDirRecurse(trash + "/base/app", S_IRWXU));
+    ASSERT_TRUE(SaveStringToFile(trash + "/base/app/f", "x"));
+    ASSERT_TRUE(MkDirRecurse(keep, S_IRWXU));
+    std::string journal = trash + "\n" + keep + "\n" + PATH_RMDIR + "/.sd_trash.gone.2\n";
+    ASSERT_TRUE(SaveStringToFile(PATH_RM_JOURNAL, journal, true));
+
+    ResumeDeferredRemoval();
+    for (int waitRounds = 0; waitRounds < 100; waitRounds++) {
+        if (!IsDir(trash) && access(PATH_RM_JOURNAL.c_str(), F_OK) != 0) {
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    EXPECT_FALSE(IsDir(trash));
+    EXPECT_TRUE(IsDir(keep));
+    EXPECT_NE(access(PATH_RM_JOURNAL.c_str(), F_OK), 0);
+
+    ResumeDeferredRemoval();
+    EXPECT_TRUE(IsDir(keep));
+    GTEST_LOG_(INFO) << "FileUtilsTest_ResumeDeferredRemoval_001 end";
+}
+
+/**
+ * @tc.name: FileUtilsTest_DeleteFile_004
+ * @tc.desc: Verify DeleteFile keeps the directory itself and entries other than files and directories.
+ * @tc.type: FUNC
+ * @tc.require: IBDKKD
+ */
+HWTEST_F(FileUtilsTest, FileUtilsTest_DeleteFile_004, TestSize.Level1)
+{
+    GTEST_LOG_(INFO) << "FileUtilsTest_DeleteFile_004 start";
+    ASSERT_TRUE(MkDirRecurse(PATH_RMDIR + "/keep_link", S_IRWXU));
+    ASSERT_TRUE(MkDirRecurse(PATH_RMDIR + "/plain/sub", S_IRWXU));
+    ASSERT_TRUE(SaveStringToFile(PATH_RMDIR + "/plain/sub/f", "x"));
+    ASSERT_EQ(symlink("/data", (PATH_RMDIR + "/keep_link/link").c_str()), 0);
+
+    DeleteFile(PATH_RMDIR);
+    EXPECT_TRUE(IsDir(PATH_RMDIR));
+    EXPECT_FALSE(IsDir(PATH_RMDIR + "/plain"));
+    EXPECT_TRUE(IsDir(PATH_RMDIR + "/keep_link"));
+    struct stat st;
+    EXPECT_EQ(lstat((PATH_RMDIR + "/keep_link/link").c_str(), &st), 0);
+    GTEST_LOG_(INFO) << "FileUtilsTest_DeleteFile_004 end";
+}
+
+/**
+ * @tc.name: FileUtilsTest_RmDirRecurse_Perf_001
+ * @tc.desc: Log how long RmDirRecurse takes on a synthetic tree of about ten thousand entries.
+ * @tc.type: PERF
+ * @tc.require: AR000GK4HB
+ */
+HWTEST_F(FileUtilsTest, FileUtilsTest_RmDirRecurse_Perf_001, TestSize.Level3)
+{
+    GTEST_LOG_(INFO) << "FileUtilsTest_RmDirRecurse_Perf_001 start";
+    // 25 "apps" x 4 dirs x 100 files, a scaled-down shape of a user's el2 app data.
+    const int appCount = 25;
+    const int dirsPerApp = 4;
+    const int filesPerDir = 100;
+    for (int app = 0; app < appCount; app++) {
+        for (int d = 0; d < dirsPerApp; d++) {
+            std::string dir = PATH_RMDIR + "/app" + std::to_string(app) + "/d" + std::to_string(d);
+            ASSERT_TRUE(MkDirRecurse(dir, S_IRWXU));
+            for (int f = 0; f < filesPerDir; f++) {
+                int fd = open((dir + "/" + std::to_string(f)).c_str(), O_CREAT | O_WRONLY | O_CLOEXEC, S_IRUSR);
+                ASSERT_GE(fd, 0);
+                close(fd);
+            }
+        }
+    }
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_TRUE(RmDirRecurse(PATH_RMDIR));
+    auto cost = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    EXPECT_FALSE(IsDir(PATH_RMDIR));
+    GTEST_LOG_(INFO) << "removed " << appCount * dirsPerApp * (filesPerDir + 1) << " entries in " << cost.count()
+                     << " ms";
+    GTEST_LOG_(INFO) << "FileUtilsTest_RmDirRecurse_Perf_001 end";
+}
+
+/**
+ * @tc.name: FileUtilsTest_FixTreeAttrs_001
+ * @tc.desc: Verify FixTreeAttrs sets mode and owner on a whole tree and leaves symlink targets alone.
+ * @tc.type: FUNC
+ * @tc.require: IBDKKD
+ */
+HWTEST_F(FileUtilsTest, FileUtilsTest_FixTreeAttrs_001, TestSize.Level1)
+{
+    GTEST_LOG_(INFO) << "FileUtilsTest_FixTreeAttrs_001 start";
+    const uid_t testUid = 1000;
+    const int dirCount = 20;
+    const int filesPerDir = 10;
+    ASSERT_TRUE(MkDirRecurse(PATH_MKDIR, S_IRWXU));
+    ASSERT_TRUE(SaveStringToFile(PATH_MKDIR + "/outside", "x"));
+    ASSERT_EQ(chmod((PATH_MKDIR + "/outside").c_str(), S_IRUSR), 0);
+    for (int i = 0; i < dirCount; i++) {
+        std::string dir = PATH_CHMOD + "/d" + std::to_string(i) + "/sub";
+        ASSERT_TRUE(MkDirRecurse(dir, S_IRWXU));
+        for (int j = 0; j < filesPerDir; j++) {
+            ASSERT_TRUE(SaveStringToFile(dir + "/f" + std::to_string(j), "x"));
+        }
+    }
+    ASSERT_EQ(symlink((PATH_MKDIR + "/outside").c_str(), (PATH_CHMOD + "/d0/link").c_str()), 0);
+
+    TreeFixSpec spec;
+    spec.setMode = true;
+    spec.dirMode = S_IRWXU | S_IRGRP | S_IXGRP;
+    spec.fileMode = S_IRUSR | S_IWUSR | S_IRGRP;
+    spec.setOwner = true;
+    spec.uid = testUid;
+    spec.gid = testUid;
+    std::atomic<uint32_t> labeled { 0 };
+    spec.relabel = [&labeled](const std::string &path) {
+        labeled++;
+        return E_OK;
+    };
+    TreeFixResult result;
+    EXPECT_EQ(FixTreeAttrs(PATH_CHMOD, spec, result), E_OK);
+    const uint64_t entries = 1 + dirCount * (2 + filesPerDir) + 1;
+    EXPECT_EQ(result.changed + result.skipped, entries);
+    EXPECT_EQ(result.failed, 0U);
+    EXPECT_EQ(labeled.load(), entries);
+
+    struct stat st;
+    ASSERT_EQ(stat((PATH_CHMOD + "/d7/sub").c_str(), &st), 0);
+    EXPECT_EQ(st.st_mode & ALLPERMS, spec.dirMode);
+    EXPECT_EQ(st.st_uid, testUid);
+    ASSERT_EQ(stat((PATH_CHMOD + "/d7/sub/f3").c_str(), &st), 0);
+    EXPECT_EQ(st.st_mode & ALLPERMS, spec.fileMode);
+    EXPECT_EQ(st.st_gid, testUid);
+    ASSERT_EQ(lstat((PATH_CHMOD + "/d0/link").c_str(), &st), 0);
+    EXPECT_EQ(st.st_uid, testUid);
+    ASSERT_EQ(stat((PATH_MKDIR + "/outside").c_str(), &st), 0);
+    EXPECT_EQ(st.st_mode & ALLPERMS, static_cast<mode_t>(S_IRUSR));
+    EXPECT_NE(st.st_uid, testUid);
+
+    EXPECT_EQ(FixTreeAttrs(PATH_MKDIR + "/outside", spec, result), E_ERR);
+    EXPECT_EQ(FixTreeAttrs(PATH_CHMOD + "/none", spec, result), E_ERR);
+    GTEST_LOG_(INFO) << "FileUtilsTest_FixTreeAttrs_001 end";
+}
+
+/**
+ * @tc.name: FileUtilsTest_FixTreeAttrs_002
+ * @tc.desc: Verify FixTreeAttrs issues no attribute writes on a tree that already matches.
+ * @tc.type: FUNC
+ * @tc.require: IBDKKD
+ */
+HWTEST_F(FileUtilsTest, FileUtilsTest_FixTreeAttrs_002, TestSize.Level1)
+{
+    GTEST_LOG_(INFO) << "FileUtilsTest_FixTreeAttrs_002 start";
+    const int dirCount = 50;
+    const int filesPerDir = 40;
+    for (int i = 0; i < dirCount; i++) {
+        std::string dir = PATH_CHMOD + "/d" + std::to_string(i);
+        ASSERT_TRUE(MkDirRecurse(dir, S_IRWXU));
+        for (int j = 0; j < filesPerDir; j++) {
+            ASSERT_TRUE(SaveStringToFile(dir + "/f" + std::to_string(j), "x"));
+        }
+    }
+    TreeFixSpec spec;
+    spec.setMode = true;
+    spec.dirMode = S_IRWXU | S_IRWXG;
+    spec.fileMode = S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP;
+    spec.setOwner = true;
+    spec.uid = getuid();
+    spec.gid = getgid();
+    TreeFixResult result;
+    g_attrWriteCount = 0;
+    ASSERT_EQ(FixTreeAttrs(PATH_CHMOD, spec, result), E_OK);
+    const uint64_t entries = 1 + dirCount * (1 + filesPerDir);
+    EXPECT_EQ(result.changed, entries);
+    EXPECT_EQ(g_attrWriteCount.load(), entries);
+
+    g_attrWriteCount = 0;
+    ASSERT_EQ(FixTreeAttrs(PATH_CHMOD, spec, result), E_OK);
+    EXPECT_EQ(result.changed, 0U);
+    EXPECT_EQ(result.skipped, entries);
+    EXPECT_EQ(g_attrWriteCount.load(), 0U);
+    GTEST_LOG_(INFO) << "FileUtilsTest_FixTreeAttrs_002 end";
+}
 } // namespace StorageDaemon
 } // namespace OHOS
@@ -30,6 +30,7 @@ using namespace testing::ext;
 namespace {
 constexpr const char *TOOL_DIR = "/data/storage_daemon_fsck_diag_ut";
 constexpr int32_t SIGKILL_EXIT = 128 + SIGKILL;
+constexpr int32_t EXEC_FAILED_EXIT = 127;
 constexpr int32_t SHORT_TIMEOUT_S = 1;
 constexpr int32_t WAIT_EXIT_TIMEOUT_S = 5;
 constexpr size_t MAX_OUTPUT_LEN = 1024;
@@ -183,7 +184,7 @@ HWTEST_F(FsckDiagnoseTest, FsckDiagnose_MissingBinary_001, TestSize.Level0)
     (void)setenv("PATH", TOOL_DIR, 1);
     FsckResult result = FsckDiagnose("/dev/block/vol-1", "exfat");
     EXPECT_FALSE(result.cmd.empty());
-    EXPECT_EQ(result.exitCode, 1);
+    EXPECT_EQ(result.exitCode, EXEC_FAILED_EXIT);
 }
 
 HWTEST_F(FsckDiagnoseTest, FsckDiagnoseWithTimeout_Kill_001, TestSize.Level0)
@@ -0,0 +1,168 @@
+/*
+ * Copyright (c) 2026 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "utils/mount_argument_utils.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <gtest/gtest.h>
+#include <new>
+#include <sys/mount.h>
+
+namespace {
+std::atomic<uint64_t> g_allocCount { 0 };
+}
+
+void *operator new(size_t size)
+{
+    g_allocCount.fetch_add(1, std::memory_order_relaxed);
+    void *ptr = std::malloc(size == 0 ? 1 : size);
+    if (ptr == nullptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void operator delete(void *ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept
+{
+    std::free(ptr);
+}
+
+namespace OHOS {
+namespace StorageDaemon {
+namespace Test {
+using namespace testing;
+using namespace testing::ext;
+using Utils::MountArgument;
+using Utils::MountArgumentDescriptors;
+
+constexpr int TEST_USER_ID = 100;
+constexpr int MOUNT_PERF_ROUNDS = 10000;
+
+class MountArgumentUtilsTest : public testing::Test {
+public:
+    static void SetUpTestCase(void) {};
+    static void TearDownTestCase(void) {};
+    void SetUp() {};
+    void TearDown() {};
+};
+
+/**
+ * @tc.name: MountArgumentUtilsTest_Paths_001
+ * @tc.desc: Verify the derived paths of an account argument byte for byte.
+ * @tc.type: FUNC
+ */
+HWTEST_F(MountArgumentUtilsTest, MountArgumentUtilsTest_Paths_001, TestSize.Level1)
+{
+    GTEST_LOG_(INFO) << "MountArgumentUtilsTest_Paths_001 start";
+    MountArgument arg = MountArgumentDescriptors::Alpha(TEST_USER_ID, "account");
+    EXPECT_EQ(arg.GetFullSrc(), "/data/service/el2/100/hmdfs/account");
+    EXPECT_EQ(arg.GetFullDst(), "/mnt/hmdfs/100/account");
+    EXPECT_EQ(arg.GetShareSrc(), "/data/service/el2/100/share");
+    EXPECT_EQ(arg.GetShareDst(), "/mnt/share/100");
+    EXPECT_EQ(arg.GetUserIdPara(), "user_id=100");
+    EXPECT_EQ(arg.GetHmUserIdPara(), "override_support_delete,user_id=100");
+    EXPECT_EQ(arg.GetCommFullPath(), "/storage/media/100/");
+    EXPECT_EQ(arg.GetCloudFullPath(), "/storage/cloud/100/");
+    EXPECT_EQ(arg.GetCachePath(), "/data/service/el2/100/hmdfs/cache/account_cache/");
+    EXPECT_EQ(arg.GetFullCloud(), "/mnt/data/100/cloud_fuse");
+    EXPECT_EQ(arg.GetFullMediaCloud(), "/mnt/data/100/cloud");
+    EXPECT_EQ(arg.GetCloudDocsPath(), "/storage/cloud/100/files/Docs");
+    EXPECT_EQ(arg.GetLocalDocsPath(), "/mnt/hmdfs/100/account/device_view/local/files/Docs");
+    EXPECT_EQ(arg.GetMountPointPrefix(), "/data/service/el2/100/hmdfs");
+    EXPECT_EQ(arg.GetSandboxPath(), "/mnt/sandbox/100");
+    EXPECT_EQ(arg.GetMntUserPath(), "/mnt/user/100");
+    EXPECT_EQ(arg.GetMediaDocsPath(), "/storage/media/100/local/files/Docs");
+    EXPECT_EQ(arg.GetNoSharefsDocPath(), "/mnt/user/100/nosharefs/docs");
+    EXPECT_EQ(arg.GetNoSharefsDocCurPath(), "/mnt/user/100/nosharefs/docs/currentUser");
+    EXPECT_EQ(arg.GetSharefsDocPath(), "/mnt/user/100/sharefs/docs");
+    EXPECT_EQ(arg.GetSharefsDocCurPath(), "/mnt/user/100/sharefs/docs/currentUser");
+    EXPECT_EQ(arg.GetCurOtherPath(), "/mnt/user/100/currentUser/other");
+    EXPECT_EQ(arg.GetCurOtherAppdataPath(), "/mnt/user/100/currentUser/other/appdata");
+    EXPECT_EQ(arg.GetCurFileMgrPath(), "/mnt/user/100/currentUser/filemgr");
+    EXPECT_EQ(arg.GetCurFileMgrAppdataPath(), "/mnt/user/100/currentUser/filemgr/appdata");
+    EXPECT_EQ(arg.GetNoSharefsAppdataPath(), "/mnt/user/100/nosharefs/appdata");
+    EXPECT_EQ(arg.GetFlags(), static_cast<unsigned long>(MS_NODEV));
+
+    arg.enableCloudDisk_ = true;
+    EXPECT_EQ(arg.GetCachePath(), "/data/service/el2/100/hmdfs/cloud/");
+    MountArgument empty = MountArgumentDescriptors::Alpha(0, "");
+    EXPECT_EQ(empty.GetFullDst(), "/mnt/hmdfs/0/");
+    EXPECT_EQ(empty.GetCachePath(), "/data/service/el2/0/hmdfs/cache/_cache/");
+    GTEST_LOG_(INFO) << "MountArgumentUtilsTest_Paths_001 end";
+}
+
+/**
+ * @tc.name: MountArgumentUtilsTest_OptionsToString_001
+ * @tc.desc: Verify the hmdfs options string for the default and for every flag set.
+ * @tc.type: FUNC
+ */
+HWTEST_F(MountArgumentUtilsTest, MountArgumentUtilsTest_OptionsToString_001, TestSize.Level1)
+{
+    GTEST_LOG_(INFO) << "MountArgumentUtilsTest_OptionsToString_001 start";
+    MountArgument arg = MountArgumentDescriptors::Alpha(TEST_USER_ID, "account");
+    EXPECT_EQ(arg.OptionsToString(), "local_dst=/mnt/hmdfs/100/account,user_id=100,ra_pages=512,"
+        "cache_dir=/data/service/el2/100/hmdfs/cache/account_cache/,cloud_dir=/mnt/data/100/cloud,merge");
+
+    arg.caseSensitive_ = true;
+    arg.enableCloudDisk_ = true;
+    arg.enableOfflineStash_ = false;
+    arg.isSecurityMode_ = true;
+    EXPECT_EQ(arg.OptionsToString(), "local_dst=/mnt/hmdfs/100/account,user_id=100,ra_pages=512,"
+        "cache_dir=/data/service/el2/100/hmdfs/cloud/,cloud_dir=/mnt/data/100/cloud,sensitive,merge,cloud_disk,"
+        "no_offline_stash,security_mode");
+
+    MountArgument plain;
+    plain.userId_ = TEST_USER_ID;
+    EXPECT_EQ(plain.OptionsToString(), "local_dst=/mnt/hmdfs/100/,user_id=100,ra_pages=512");
+    GTEST_LOG_(INFO) << "MountArgumentUtilsTest_OptionsToString_001 end";
+}
+
+/**
+ * @tc.name: MountArgumentUtilsTest_Perf_001
+ * @tc.desc: Log the allocations and time of the paths built for one user mount; each path is one allocation and
+ *           the options string adds one more for each of the three paths it takes from the getters.
+ * @tc.type: PERF
+ */
+HWTEST_F(MountArgumentUtilsTest, MountArgumentUtilsTest_Perf_001, TestSize.Level3)
+{
+    GTEST_LOG_(INFO) << "MountArgumentUtilsTest_Perf_001 start";
+    constexpr uint64_t allocsPerRound = 10 + 3;
+    MountArgument arg = MountArgumentDescriptors::Alpha(TEST_USER_ID, "account");
+    size_t totalLen = 0;
+    uint64_t before = g_allocCount.load();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < MOUNT_PERF_ROUNDS; i++) {
+        totalLen += arg.GetFullSrc().size() + arg.GetFullDst().size() + arg.OptionsToString().size() +
+            arg.GetMountPointPrefix().size() + arg.GetSandboxPath().size() + arg.GetMntUserPath().size() +
+            arg.GetShareSrc().size() + arg.GetShareDst().size() + arg.GetFullCloud().size() +
+            arg.GetSharefsDocCurPath().size();
+    }
+    auto cost = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    uint64_t allocs = g_allocCount.load() - before;
+    GTEST_LOG_(INFO) << "allocations per round: " << allocs / MOUNT_PERF_ROUNDS << ", us per round: "
+        << static_cast<double>(cost.count()) / MOUNT_PERF_ROUNDS;
+    EXPECT_GT(totalLen, 0u);
+    EXPECT_LE(allocs, allocsPerRound * MOUNT_PERF_ROUNDS);
+    GTEST_LOG_(INFO) << "MountArgumentUtilsTest_Perf_001 end";
+}
+} // namespace Test
+} // namespace StorageDaemon
+} // namespace OHOS
@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2026 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "utils/mount_table.h"
+
+#include <gtest/gtest.h>
+
+namespace OHOS {
+namespace StorageDaemon {
+namespace Test {
+using namespace testing;
+using namespace testing::ext;
+class MountTableTest : public testing::Test {
+public:
+    static void SetUpTestCase(void) {};
+    static void TearDownTestCase(void) {};
+    void SetUp() {};
+    void TearDown() {};
+};
+
+namespace {
+const std::string MOUNT_INFO_SAMPLE =
+    "20 1 259:1 / / ro,relatime shared:1 - ext4 /dev/block/dm-0 ro,seclabel\n"
+    "21 20 0:5 / /dev rw,nosuid master:2 - tmpfs tmpfs rw,seclabel\n"
+    "30 20 259:40 / /data rw,nosuid,nodev - f2fs /dev/block/dm-40 rw,seclabel\n"
+    "31 30 0:60 / /mnt/hmdfs/100/account rw shared:7 master:3 - hmdfs /data/service/el2/100/hmdfs/account rw\n"
+    "32 30 0:61 / /mnt/share/100 rw - sharefs /data/service/el2/100/share rw\n"
+    "33 30 259:40 /app /mnt/sandbox/100/app rw - f2fs /dev/block/dm-40 rw\n"
+    "broken line without separator\n";
+}
+
+/**
+ * @tc.name: MountTableTest_Parse_001
+ * @tc.desc: Verify that mountinfo lines are tokenized and indexed by target, source and type.
+ * @tc.type: FUNC
+ */
+HWTEST_F(MountTableTest, MountTableTest_Parse_001, TestSize.Level1)
+{
+    GTEST_LOG_(INFO) << "MountTableTest_Parse_001 start";
+    auto table = MountTable::Parse(MOUNT_INFO_SAMPLE);
+    ASSERT_NE(table, nullptr);
+    ASSERT_EQ(table->GetEntries().size(), 6u);
+    EXPECT_EQ(table->GetEntries()[3].target, "/mnt/hmdfs/100/account");
+    EXPECT_EQ(table->GetEntries()[3].source, "/data/service/el2/100/hmdfs/account");
+    EXPECT_EQ(table->GetEntries()[3].fsType, "hmdfs");
+
+    EXPECT_TRUE(table->HasTarget("/data"));
+    EXPECT_TRUE(table->HasTarget("/mnt/share/100"));
+    EXPECT_FALSE(table->HasTarget("/mnt/share"));
+
+    std::vector<std::string> targets;
+    table->ForEachOfTypes({ "f2fs", "sharefs" }, [&targets](const MountEntry &entry) {
+        targets.emplace_back(entry.target);
+    });
+    std::vector<std::string> expected = { "/data", "/mnt/share/100", "/mnt/sandbox/100/app" };
+    EXPECT_EQ(targets, expected);
+
+    size_t blockCount = 0;
+    table->ForEachSourcePrefix("/dev/block/", [&blockCount](const MountEntry &) { blockCount++; });
+    EXPECT_EQ(blockCount, 3u);
+
+    size_t mntCount = 0;
+    table->ForEachTargetPrefix("/mnt/", [&mntCount](const MountEntry &) { mntCount++; });
+    EXPECT_EQ(mntCount, 3u);
+    GTEST_LOG_(INFO) << "MountTableTest_Parse_001 end";
+}
+
+/**
+ * @tc.name: MountTableTest_ParseMountsLine_001
+ * @tc.desc: Verify the /proc/mounts line tokenizer.
+ * @tc.type: FUNC
+ */
+HWTEST_F(MountTableTest, MountTableTest_ParseMountsLine_001, TestSize.Level1)
+{
+    GTEST_LOG_(INFO) << "MountTableTest_ParseMountsLine_001 start";
+    MountEntry entry;
+    EXPECT_TRUE(MountTable::ParseMountsLine("/dev/block/dm-40 /data f2fs rw 0 0", entry));
+    EXPECT_EQ(entry.source, "/dev/block/dm-40");
+    EXPECT_EQ(entry.target, "/data");
+    EXPECT_EQ(entry.fsType, "f2fs");
+    EXPECT_FALSE(MountTable::ParseMountsLine("source destination", entry));
+    EXPECT_FALSE(MountTable::ParseMountsLine("", entry));
+    GTEST_LOG_(INFO) << "MountTableTest_ParseMountsLine_001 end";
+}
+
+/**
+ * @tc.name: MountTableTest_GetSnapshot_001
+ * @tc.desc: Verify that the cached table is reused while the mount namespace does not change.
+ * @tc.type: FUNC
+ */
+HWTEST_F(MountTableTest, MountTableTest_GetSnapshot_001, TestSize.Level1)
+{
+    GTEST_LOG_(INFO) << "MountTableTest_GetSnapshot_001 start";
+    auto &mountTable = MountTable::GetInstance();
+    auto first = mountTable.GetSnapshot();
+    ASSERT_NE(first, nullptr);
+    EXPECT_TRUE(first->HasTarget("/"));
+    EXPECT_EQ(mountTable.GetSnapshot(), first);
+
+    mountTable.Invalidate();
+    auto fresh = mountTable.GetSnapshot();
+    ASSERT_NE(fresh, nullptr);
+    EXPECT_NE(fresh, first);
+    EXPECT_EQ(fresh->GetEntries().size(), first->GetEntries().size());
+    GTEST_LOG_(INFO) << "MountTableTest_GetSnapshot_001 end";
+}
+} // namespace Test
+} // namespace StorageDaemon
+} // namespace OHOS
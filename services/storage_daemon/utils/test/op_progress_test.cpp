@@ -0,0 +1,321 @@
+/*
+ * Copyright (c) 2026 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstdlib>
+#include <fstream>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <gtest/hwext/gtest-ext.h>
+#include "storage_service_errno.h"
+#include "utils/file_utils.h"
+#include "utils/op_progress.h"
+
+namespace OHOS {
+namespace StorageDaemon {
+using namespace testing::ext;
+
+namespace {
+constexpr const char *TOOL_DIR = "/data/storage_daemon_op_progress_ut";
+constexpr uint64_t MB = 1024 * 1024;
+
+void WriteFakeTool(const std::string &name, const std::string &body)
+{
+    std::string path = std::string(TOOL_DIR) + "/" + name;
+    std::ofstream ofs(path);
+    ofs << "#!/system/bin/sh\n" << body << "\n";
+    ofs.close();
+    (void)chmod(path.c_str(), S_IRWXU | S_IRGRP | S_IXGRP | S_IROTH | S_IXOTH);
+}
+
+void RemoveFakeTool(const std::string &name)
+{
+    (void)unlink((std::string(TOOL_DIR) + "/" + name).c_str());
+}
+} // namespace
+
+class OpProgressTest : public testing::Test {
+public:
+    void SetUp() override
+    {
+        (void)mkdir(TOOL_DIR, S_IRWXU | S_IRGRP | S_IXGRP | S_IROTH | S_IXOTH);
+        const char *path = getenv("PATH");
+        oldPath_ = path == nullptr ? "" : path;
+        (void)setenv("PATH", (std::string(TOOL_DIR) + ":" + oldPath_).c_str(), 1);
+        WriteFakeTool("growisofs", "printf '  4718592/9437184 ( 50.0%%) @3.1x, remaining 0:33\\n' >&2; "
+            "printf '  7077888/9437184 ( 75.0%%) @3.1x, remaining 0:11\\r' >&2; exit 0");
+        WriteFakeTool("wodim", "printf 'Track 01:   30 of  300 MB written (fifo 100%%)\\r'; "
+            "printf 'Track 01:   90 of  300 MB written (fifo 100%%)\\r'; exit 0");
+        WriteFakeTool("mkfs.fake", "printf 'Writing inode tables:  1/8\\b\\b\\b 4/8\\b\\b\\b'; "
+            "printf ' 6/8\\b\\b\\bdone\\n'; exit 0");
+    }
+
+    void TearDown() override
+    {
+        (void)setenv("PATH", oldPath_.c_str(), 1);
+        RemoveFakeTool("growisofs");
+        RemoveFakeTool("wodim");
+        RemoveFakeTool("mkfs.fake");
+        (void)rmdir(TOOL_DIR);
+    }
+
+private:
+    std::string oldPath_;
+};
+
+/**
+ * @tc.name: OpProgress_GetOpId_001
+ * @tc.desc: Verify the operation ID of a device path is its basename.
+ * @tc.type: FUNC
+ */
+HWTEST_F(OpProgressTest, OpProgress_GetOpId_001, TestSize.Level1)
+{
+    GTEST_LOG_(INFO) << "OpProgress_GetOpId_001 start";
+    EXPECT_EQ(OpProgressRegistry::GetOpId("/dev/block/vol-11-0"), "vol-11-0");
+    EXPECT_EQ(OpProgressRegistry::GetOpId("vol-11-0"), "vol-11-0");
+    GTEST_LOG_(INFO) << "OpProgress_GetOpId_001 end";
+}
+
+/**
+ * @tc.name: OpProgress_ParseLine_001
+ * @tc.desc: Verify ParseLine recognises the progress lines of each burn and format tool.
+ * @tc.type: FUNC
+ */
+HWTEST_F(OpProgressTest, OpProgress_ParseLine_001, TestSize.Level1)
+{
+    GTEST_LOG_(INFO) << "OpProgress_ParseLine_001 start";
+    OpProgressSample growisofs;
+    ASSERT_TRUE(OpProgressParser::ParseLine("  1736704/9256960 ( 18.8%) @3.1x, remaining 1:33 RBU 100.0%",
+        growisofs));
+    EXPECT_TRUE(growisofs.hasBytes);
+    EXPECT_EQ(growisofs.bytesDone, 1736704U);
+    EXPECT_EQ(growisofs.bytesTotal, 9256960U);
+    EXPECT_EQ(static_cast<int32_t>(growisofs.percent), 18);
+    EXPECT_EQ(growisofs.etaSec, 93);
+
+    OpProgressSample wodim;
+    ASSERT_TRUE(OpProgressParser::ParseLine("Track 01:   12 of  300 MB written (fifo 100%) [buf  99%]", wodim));
+    EXPECT_EQ(wodim.bytesDone, 12 * MB);
+    EXPECT_EQ(wodim.bytesTotal, 300 * MB);
+
+    OpProgressSample iso;
+    ASSERT_TRUE(OpProgressParser::ParseLine(" 42.50% done, estimate finish Mon Oct 19 12:00:00 2026", iso));
+    EXPECT_FALSE(iso.hasBytes);
+    EXPECT_EQ(static_cast<int32_t>(iso.percent), 42);
+
+    OpProgressSample counter;
+    ASSERT_TRUE(OpProgressParser::ParseLine("Allocating group tables:  1/8    2/8", counter));
+    EXPECT_EQ(static_cast<int32_t>(counter.percent), 25);
+
+    OpProgressSample none;
+    EXPECT_FALSE(OpProgressParser::ParseLine("Total translation table size: 2048", none));
+    EXPECT_FALSE(OpProgressParser::ParseLine("", none));
+    GTEST_LOG_(INFO) << "OpProgress_ParseLine_001 end";
+}
+
+/**
+ * @tc.name: OpProgress_Scope_001
+ * @tc.desc: Verify tool output of ForkExec under a scope lands in the registry, per phase.
+ * @tc.type: FUNC
+ */
+HWTEST_F(OpProgressTest, OpProgress_Scope_001, TestSize.Level1)
+{
+    GTEST_LOG_(INFO) << "OpProgress_Scope_001 start";
+    const std::string opId = "vol-ut-scope";
+    auto &registry = OpProgressRegistry::GetInstance();
+    registry.Begin(opId, { OpPhase::WRITING, OpPhase::VERIFYING });
+    OpProgress progress;
+    {
+        OpProgressScope scope(opId, OpPhase::WRITING);
+        std::vector<std::string> cmd = { "growisofs" };
+        std::vector<std::string> output;
+        ASSERT_EQ(ForkExec(cmd, &output), E_OK);
+        ASSERT_TRUE(registry.Get(opId, progress));
+        EXPECT_EQ(progress.phase, OpPhase::WRITING);
+        EXPECT_EQ(progress.percent, 45);
+        EXPECT_EQ(progress.bytesDone, 7077888U);
+        EXPECT_EQ(progress.etaSec, 11);
+    }
+    {
+        OpProgressScope scope(opId, OpPhase::VERIFYING);
+        ASSERT_TRUE(registry.Get(opId, progress));
+        EXPECT_EQ(progress.percent, 60);
+        OpProgressScope::ReportBytes(MB, 4 * MB);
+        ASSERT_TRUE(registry.Get(opId, progress));
+        EXPECT_EQ(progress.phase, OpPhase::VERIFYING);
+        EXPECT_EQ(progress.percent, 70);
+    }
+    std::vector<std::string> cmd = { "wodim" };
+    std::vector<std::string> output;
+    ASSERT_EQ(ForkExec(cmd, &output), E_OK);
+    ASSERT_TRUE(registry.Get(opId, progress));
+    EXPECT_EQ(progress.percent, 70);
+    registry.Finish(opId, E_OK);
+    ASSERT_TRUE(registry.Get(opId, progress));
+    EXPECT_EQ(progress.phase, OpPhase::DONE);
+    EXPECT_EQ(progress.percent, 100);
+    EXPECT_FALSE(registry.Get("vol-ut-unknown", progress));
+    GTEST_LOG_(INFO) << "OpProgress_Scope_001 end";
+}
+
+/**
+ * @tc.name: OpProgress_Concurrent_001
+ * @tc.desc: Verify two operations running on two threads report to their own entries.
+ * @tc.type: FUNC
+ */
+HWTEST_F(OpProgressTest, OpProgress_Concurrent_001, TestSize.Level1)
+{
+    GTEST_LOG_(INFO) << "OpProgress_Concurrent_001 start";
+    auto &registry = OpProgressRegistry::GetInstance();
+    auto run = [](const std::string &opId, OpPhase phase, const std::string &tool) {
+        OpProgressRegistry::GetInstance().Begin(opId);
+        OpProgressScope scope(opId, phase);
+        std::vector<std::string> cmd = { tool };
+        std::vector<std::string> output;
+        EXPECT_EQ(ForkExec(cmd, &output), E_OK);
+    };
+    std::thread burn(run, "vol-ut-a", OpPhase::WRITING, "wodim");
+    std::thread format(run, "vol-ut-b", OpPhase::FORMATTING, "mkfs.fake");
+    burn.join();
+    format.join();
+    OpProgress progress;
+    ASSERT_TRUE(registry.Get("vol-ut-a", progress));
+    EXPECT_EQ(progress.phase, OpPhase::WRITING);
+    EXPECT_EQ(progress.percent, 30);
+    EXPECT_EQ(progress.bytesTotal, 300 * MB);
+    ASSERT_TRUE(registry.Get("vol-ut-b", progress));
+    EXPECT_EQ(progress.phase, OpPhase::FORMATTING);
+    EXPECT_EQ(progress.percent, 75);
+    EXPECT_EQ(progress.bytesTotal, 0U);
+    GTEST_LOG_(INFO) << "OpProgress_Concurrent_001 end";
+}
+
+/**
+ * @tc.name: OpProgress_Subscribe_001
+ * @tc.desc: Verify subscribers are called on phase changes and on each percent step, not on every report.
+ * @tc.type: FUNC
+ */
+HWTEST_F(OpProgressTest, OpProgress_Subscribe_001, TestSize.Level1)
+{
+    GTEST_LOG_(INFO) << "OpProgress_Subscribe_001 start";
+    const std::string opId = "vol-ut-sub";
+    auto &registry = OpProgressRegistry::GetInstance();
+    std::vector<int32_t> seen;
+    registry.Begin(opId);
+    registry.Subscribe(opId, [&seen](const std::string &, const OpProgress &progress) {
+        seen.push_back(progress.percent);
+    });
+    {
+        OpProgressScope scope(opId, OpPhase::VERIFYING);
+        const uint64_t total = 1000 * MB;
+        for (uint64_t done = 0; done <= total; done += MB) {
+            OpProgressScope::ReportBytes(done, total);
+        }
+    }
+    registry.Finish(opId, E_ERR);
+    registry.Unsubscribe(opId);
+    OpProgressScope::ReportBytes(1, 1);
+    ASSERT_EQ(seen.size(), 102U);
+    EXPECT_EQ(seen.front(), 0);
+    EXPECT_EQ(seen[50], 50);
+    EXPECT_EQ(seen.back(), 100);
+    OpProgress progress;
+    ASSERT_TRUE(registry.Get(opId, progress));
+    EXPECT_EQ(progress.phase, OpPhase::FAILED);
+    EXPECT_EQ(progress.lastError, E_ERR);
+    GTEST_LOG_(INFO) << "OpProgress_Subscribe_001 end";
+}
+
+/**
+ * @tc.name: OpProgress_Percent_001
+ * @tc.desc: Verify the percent spans the planned phases by weight, never goes back, and a phase
+ *           that was not planned fills what is left.
+ * @tc.type: FUNC
+ */
+HWTEST_F(OpProgressTest, OpProgress_Percent_001, TestSize.Level1)
+{
+    GTEST_LOG_(INFO) << "OpProgress_Percent_001 start";
+    const std::string opId = "vol-ut-percent";
+    auto &registry = OpProgressRegistry::GetInstance();
+    registry.Begin(opId, { OpPhase::BUILDING_IMAGE, OpPhase::WRITING });
+    OpProgress progress;
+    {
+        OpProgressScope scope(opId, OpPhase::BUILDING_IMAGE);
+        OpProgressScope::ReportBytes(MB, 2 * MB);
+        ASSERT_TRUE(registry.Get(opId, progress));
+        EXPECT_EQ(progress.percent, 7);
+    }
+    {
+        OpProgressScope scope(opId, OpPhase::WRITING);
+        ASSERT_TRUE(registry.Get(opId, progress));
+        EXPECT_EQ(progress.percent, 14);
+        OpProgressScope::ReportBytes(MB, 2 * MB);
+        ASSERT_TRUE(registry.Get(opId, progress));
+        EXPECT_EQ(progress.percent, 57);
+        OpProgressScope::ReportBytes(MB, 4 * MB);
+        ASSERT_TRUE(registry.Get(opId, progress));
+        EXPECT_EQ(progress.percent, 57);
+    }
+    {
+        OpProgressScope scope(opId, OpPhase::VERIFYING);
+        ASSERT_TRUE(registry.Get(opId, progress));
+        EXPECT_EQ(progress.percent, 57);
+        OpProgressScope::ReportBytes(MB, 2 * MB);
+        ASSERT_TRUE(registry.Get(opId, progress));
+        EXPECT_EQ(progress.percent, 78);
+    }
+    registry.Finish(opId, E_OK);
+    GTEST_LOG_(INFO) << "OpProgress_Percent_001 end";
+}
+
+/**
+ * @tc.name: OpProgress_Expire_001
+ * @tc.desc: Verify a finished operation ignores late reports, is forgotten once its result expired,
+ *           and a scope started right after it starts over.
+ * @tc.type: FUNC
+ */
+HWTEST_F(OpProgressTest, OpProgress_Expire_001, TestSize.Level1)
+{
+    GTEST_LOG_(INFO) << "OpProgress_Expire_001 start";
+    const std::string opId = "vol-ut-expire";
+    auto &registry = OpProgressRegistry::GetInstance();
+    OpProgress progress;
+    registry.Begin(opId);
+    registry.Finish(opId, E_ERR);
+    OpProgressSample late;
+    late.percent = 100;
+    registry.Update(opId, late);
+    ASSERT_TRUE(registry.Get(opId, progress));
+    EXPECT_EQ(progress.phase, OpPhase::FAILED);
+    EXPECT_EQ(progress.percent, 0);
+    {
+        OpProgressScope scope(opId, OpPhase::FORMATTING);
+        ASSERT_TRUE(registry.Get(opId, progress));
+        EXPECT_EQ(progress.phase, OpPhase::FORMATTING);
+        EXPECT_EQ(progress.lastError, 0);
+    }
+    registry.Finish(opId, E_OK);
+    ASSERT_TRUE(registry.Get(opId, progress));
+    EXPECT_EQ(progress.percent, 100);
+    const int64_t keepMs = 5000;
+    registry.GetState(opId, false)->finishMs -= keepMs;
+    EXPECT_FALSE(registry.Get(opId, progress));
+    GTEST_LOG_(INFO) << "OpProgress_Expire_001 end";
+}
+} // namespace StorageDaemon
+} // namespace OHOS
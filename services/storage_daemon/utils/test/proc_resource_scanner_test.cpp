@@ -0,0 +1,200 @@
+/*
+ * Copyright (c) 2026 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "utils/proc_resource_scanner.h"
+
+#include <chrono>
+#include <fcntl.h>
+#include <gtest/gtest.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "file_ex.h"
+
+namespace OHOS {
+namespace StorageDaemon {
+namespace Test {
+using namespace testing;
+using namespace testing::ext;
+class ProcResourceScannerTest : public testing::Test {
+public:
+    static void SetUpTestCase(void) {};
+    static void TearDownTestCase(void) {};
+    void SetUp() {};
+    void TearDown() {};
+};
+
+namespace {
+const std::string SCANNER_TEST_PATH = "/data/service/proc_resource_scanner_test.txt";
+const std::string FAKE_PROC = "/data/test/tdd/fake_proc";
+const std::string FAKE_TARGET = "/data/test/tdd/target";
+
+void RemoveFakeProc()
+{
+    for (const char *link : { "/111/cwd", "/111/root", "/111/exe", "/111/fd/3", "/111/fd/4", "/111/stat", "/111/maps",
+        "/222/maps" }) {
+        unlink((FAKE_PROC + link).c_str());
+    }
+    for (const char *dir : { "/111/fd", "/111", "/222", "/abc", "" }) {
+        rmdir((FAKE_PROC + dir).c_str());
+    }
+}
+}
+
+/**
+ * @tc.name: ProcResourceScannerTest_Scan_001
+ * @tc.desc: Verify that Scan indexes the fds of the current process by path.
+ * @tc.type: FUNC
+ */
+HWTEST_F(ProcResourceScannerTest, ProcResourceScannerTest_Scan_001, TestSize.Level1)
+{
+    GTEST_LOG_(INFO) << "ProcResourceScannerTest_Scan_001 start";
+    int fd = open(SCANNER_TEST_PATH.c_str(), O_CREAT | O_RDWR | O_CLOEXEC, 0600);
+    ASSERT_GE(fd, 0);
+
+    auto start = std::chrono::steady_clock::now();
+    auto snapshot = ProcResourceScanner::Scan("/proc", PROC_RES_ALL);
+    auto cost = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    ASSERT_NE(snapshot, nullptr);
+    GTEST_LOG_(INFO) << "scan pids=" << snapshot->GetPidCount() << " entries=" << snapshot->GetEntryCount()
+                     << " cost=" << cost.count() << "ms";
+
+    bool found = false;
+    snapshot->ForEachWithPrefix(SCANNER_TEST_PATH, PROC_RES_FD, [&found](const ProcResource &res) {
+        if (res.pid == getpid()) {
+            found = true;
+        }
+        return true;
+    });
+    EXPECT_TRUE(found);
+    EXPECT_FALSE(snapshot->GetProcessName(getpid()).empty());
+
+    bool mapped = false;
+    snapshot->ForEachWithPrefix(SCANNER_TEST_PATH, PROC_RES_MAPS, [&mapped](const ProcResource &) {
+        mapped = true;
+        return true;
+    });
+    EXPECT_FALSE(mapped);
+
+    close(fd);
+    unlink(SCANNER_TEST_PATH.c_str());
+    GTEST_LOG_(INFO) << "ProcResourceScannerTest_Scan_001 end";
+}
+
+/**
+ * @tc.name: ProcResourceScannerTest_Scan_002
+ * @tc.desc: Verify that Scan fails on an invalid proc root and stops when the visitor asks to.
+ * @tc.type: FUNC
+ */
+HWTEST_F(ProcResourceScannerTest, ProcResourceScannerTest_Scan_002, TestSize.Level1)
+{
+    GTEST_LOG_(INFO) << "ProcResourceScannerTest_Scan_002 start";
+    EXPECT_EQ(ProcResourceScanner::Scan("/data/service/not_exist_proc", PROC_RES_ALL), nullptr);
+
+    auto snapshot = ProcResourceScanner::Scan("/proc", PROC_RES_LINKS);
+    ASSERT_NE(snapshot, nullptr);
+    int visited = 0;
+    snapshot->ForEachWithPrefix("/", PROC_RES_LINKS, [&visited](const ProcResource &) {
+        visited++;
+        return false;
+    });
+    EXPECT_EQ(visited, 1);
+    GTEST_LOG_(INFO) << "ProcResourceScannerTest_Scan_002 end";
+}
+
+/**
+ * @tc.name: ProcResourceScannerTest_Scan_003
+ * @tc.desc: Verify that Scan reads the links, fds and maps of every pid dir under the root and skips the rest.
+ * @tc.type: FUNC
+ */
+HWTEST_F(ProcResourceScannerTest, ProcResourceScannerTest_Scan_003, TestSize.Level1)
+{
+    GTEST_LOG_(INFO) << "ProcResourceScannerTest_Scan_003 start";
+    RemoveFakeProc();
+    ASSERT_EQ(mkdir(FAKE_PROC.c_str(), 0700), 0);
+    ASSERT_EQ(mkdir((FAKE_PROC + "/111").c_str(), 0700), 0);
+    ASSERT_EQ(mkdir((FAKE_PROC + "/111/fd").c_str(), 0700), 0);
+    ASSERT_EQ(mkdir((FAKE_PROC + "/222").c_str(), 0700), 0);
+    ASSERT_EQ(mkdir((FAKE_PROC + "/abc").c_str(), 0700), 0);
+    ASSERT_TRUE(SaveStringToFile(FAKE_PROC + "/111/stat", "111 (fake) S 1"));
+    ASSERT_EQ(symlink((FAKE_TARGET + "/cwd").c_str(), (FAKE_PROC + "/111/cwd").c_str()), 0);
+    ASSERT_EQ(symlink("/", (FAKE_PROC + "/111/root").c_str()), 0);
+    ASSERT_EQ(symlink("/system/bin/fake", (FAKE_PROC + "/111/exe").c_str()), 0);
+    ASSERT_EQ(symlink((FAKE_TARGET + "/open.txt").c_str(), (FAKE_PROC + "/111/fd/3").c_str()), 0);
+    ASSERT_EQ(symlink((FAKE_TARGET + "/open.txt").c_str(), (FAKE_PROC + "/111/fd/4").c_str()), 0);
+    std::string maps = "7f00-7f01 r--p 00000000 00:00 0 " + FAKE_TARGET + "/lib.so\n"
+        "7f01-7f02 r-xp 00001000 00:00 0 " + FAKE_TARGET + "/lib.so\n"
+        "7f02-7f03 rw-p 00000000 00:00 0 [heap]\n";
+    ASSERT_TRUE(SaveStringToFile(FAKE_PROC + "/111/maps", maps));
+    // No stat: the pid is gone or unreadable, so nothing of it is listed.
+    ASSERT_TRUE(SaveStringToFile(FAKE_PROC + "/222/maps", maps));
+
+    auto snapshot = ProcResourceScanner::Scan(FAKE_PROC, PROC_RES_ALL);
+    ASSERT_NE(snapshot, nullptr);
+    EXPECT_EQ(snapshot->GetPidCount(), 1U);
+    EXPECT_EQ(snapshot->GetProcessName(111), "(fake)");
+    EXPECT_EQ(snapshot->GetProcessName(222), "");
+
+    std::vector<std::pair<std::string, uint32_t>> found;
+    snapshot->ForEachWithPrefix(FAKE_TARGET, PROC_RES_ALL, [&found](const ProcResource &res) {
+        EXPECT_EQ(res.pid, 111);
+        found.emplace_back(res.path, res.kinds);
+        return true;
+    });
+    ASSERT_EQ(found.size(), 3U);
+    EXPECT_EQ(found[0], std::make_pair(FAKE_TARGET + "/cwd", static_cast<uint32_t>(PROC_RES_CWD)));
+    EXPECT_EQ(found[1], std::make_pair(FAKE_TARGET + "/lib.so", static_cast<uint32_t>(PROC_RES_MAPS)));
+    EXPECT_EQ(found[2], std::make_pair(FAKE_TARGET + "/open.txt", static_cast<uint32_t>(PROC_RES_FD)));
+
+    int visited = 0;
+    snapshot->ForEachWithPrefix(FAKE_TARGET, PROC_RES_EXE | PROC_RES_ROOT, [&visited](const ProcResource &) {
+        visited++;
+        return true;
+    });
+    EXPECT_EQ(visited, 0);
+
+    auto linksOnly = ProcResourceScanner::Scan(FAKE_PROC, PROC_RES_LINKS);
+    ASSERT_NE(linksOnly, nullptr);
+    EXPECT_EQ(linksOnly->GetEntryCount(), 3U);
+    RemoveFakeProc();
+    GTEST_LOG_(INFO) << "ProcResourceScannerTest_Scan_003 end";
+}
+
+/**
+ * @tc.name: ProcResourceScannerTest_GetSnapshot_001
+ * @tc.desc: Verify that snapshots are shared within the validity window and refreshed after Invalidate.
+ * @tc.type: FUNC
+ */
+HWTEST_F(ProcResourceScannerTest, ProcResourceScannerTest_GetSnapshot_001, TestSize.Level1)
+{
+    GTEST_LOG_(INFO) << "ProcResourceScannerTest_GetSnapshot_001 start";
+    auto &scanner = ProcResourceScanner::GetInstance();
+    scanner.Invalidate();
+    auto first = scanner.GetSnapshot(PROC_RES_FD | PROC_RES_LINKS);
+    ASSERT_NE(first, nullptr);
+    EXPECT_EQ(scanner.GetSnapshot(PROC_RES_FD), first);
+
+    auto wider = scanner.GetSnapshot(PROC_RES_ALL);
+    ASSERT_NE(wider, nullptr);
+    EXPECT_NE(wider, first);
+    EXPECT_EQ(wider->GetScannedKinds(), static_cast<uint32_t>(PROC_RES_ALL));
+
+    scanner.Invalidate();
+    auto fresh = scanner.GetSnapshot(PROC_RES_FD);
+    EXPECT_NE(fresh, wider);
+    GTEST_LOG_(INFO) << "ProcResourceScannerTest_GetSnapshot_001 end";
+}
+} // namespace Test
+} // namespace StorageDaemon
+} // namespace OHOS
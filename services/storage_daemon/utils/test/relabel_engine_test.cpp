@@ -0,0 +1,267 @@
+/*
+ * Copyright (c) 2026 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <mutex>
+#include <set>
+#include <sys/stat.h>
+#include <sys/xattr.h>
+#include <thread>
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+#include "storage_service_errno.h"
+#include "utils/file_utils.h"
+#include "utils/relabel_engine.h"
+
+namespace OHOS {
+namespace StorageDaemon {
+using namespace testing::ext;
+
+namespace {
+const std::string TEST_ROOT = "/data/local/tmp/relabel_engine_test";
+const std::string TREE = TEST_ROOT + "/tree";
+const std::string POLICY = TEST_ROOT + "/file_contexts";
+constexpr int TREE_DIRS = 8;
+constexpr int FILES_PER_DIR = 16;
+constexpr uint64_t TREE_ENTRIES = 1 + TREE_DIRS * 2 + TREE_DIRS * FILES_PER_DIR * 2;
+constexpr int PERF_DIRS = 32;
+constexpr int PERF_FILES_PER_DIR = 64;
+constexpr auto PERF_LABEL_COST = std::chrono::microseconds(20);
+
+void WriteTestFile(const std::string &path, const std::string &content)
+{
+    std::ofstream file(path, std::ios::out | std::ios::trunc);
+    file << content;
+}
+
+// TREE_ENTRIES entries: the root, dirs each holding a subdir, and files in both.
+void MakeTree(const std::string &root, int dirs, int files)
+{
+    ASSERT_EQ(mkdir(root.c_str(), S_IRWXU), 0);
+    for (int i = 0; i < dirs; i++) {
+        std::string dir = root + "/d" + std::to_string(i);
+        ASSERT_EQ(mkdir(dir.c_str(), S_IRWXU), 0);
+        ASSERT_EQ(mkdir((dir + "/sub").c_str(), S_IRWXU), 0);
+        for (int j = 0; j < files; j++) {
+            WriteTestFile(dir + "/f" + std::to_string(j), "x");
+            WriteTestFile(dir + "/sub/f" + std::to_string(j), "y");
+        }
+    }
+}
+
+class CountingLabeler {
+public:
+    RelabelFunc Func(std::chrono::microseconds cost = std::chrono::microseconds(0))
+    {
+        return [this, cost](const std::string &path) {
+            if (cost.count() > 0) {
+                std::this_thread::sleep_for(cost);
+            }
+            std::lock_guard<std::mutex> lock(mutex_);
+            calls_++;
+            return failPath_.empty() || path != failPath_ ? E_OK : E_ERR;
+        };
+    }
+
+    uint64_t Calls()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return calls_;
+    }
+
+    void Reset(const std::string &failPath = "")
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        calls_ = 0;
+        failPath_ = failPath;
+    }
+
+private:
+    std::mutex mutex_;
+    uint64_t calls_ = 0;
+    std::string failPath_;
+};
+} // namespace
+
+class RelabelEngineTest : public testing::Test {
+public:
+    void SetUp() override
+    {
+        (void)RmDirRecurse(TEST_ROOT);
+        ASSERT_EQ(mkdir(TEST_ROOT.c_str(), S_IRWXU), 0);
+        MakeTree(TREE, TREE_DIRS, FILES_PER_DIR);
+        WriteTestFile(POLICY, "/data(/.*)? u:object_r:data_file:s0\n");
+        if (setxattr(TEST_ROOT.c_str(), RELABEL_DIGEST_XATTR, "0", 1, 0) != 0) {
+            xattrSupported_ = false;
+        }
+    }
+
+    void TearDown() override
+    {
+        (void)RmDirRecurse(TEST_ROOT);
+    }
+
+protected:
+    bool xattrSupported_ = true;
+};
+
+/**
+ * @tc.name: RelabelEngine_Digest_001
+ * @tc.desc: Verify the policy digest follows the policy content and is empty without a policy.
+ * @tc.type: FUNC
+ */
+HWTEST_F(RelabelEngineTest, RelabelEngine_Digest_001, TestSize.Level1)
+{
+    GTEST_LOG_(INFO) << "RelabelEngine_Digest_001 start";
+    std::string digest = RelabelEngine::ComputePolicyDigest({ POLICY });
+    EXPECT_EQ(digest.size(), 16U);
+    EXPECT_EQ(RelabelEngine::ComputePolicyDigest({ POLICY, TEST_ROOT + "/none" }), digest);
+    WriteTestFile(POLICY, "/data(/.*)? u:object_r:data_file:s0\n/data/app(/.*)? u:object_r:app_file:s0\n");
+    EXPECT_NE(RelabelEngine::ComputePolicyDigest({ POLICY }), digest);
+    EXPECT_EQ(RelabelEngine::ComputePolicyDigest({ TEST_ROOT + "/none" }), "");
+    GTEST_LOG_(INFO) << "RelabelEngine_Digest_001 end";
+}
+
+/**
+ * @tc.name: RelabelEngine_Unchanged_001
+ * @tc.desc: Verify an unchanged tree is not labeled again, and is once the policy or a label fails.
+ * @tc.type: FUNC
+ */
+HWTEST_F(RelabelEngineTest, RelabelEngine_Unchanged_001, TestSize.Level1)
+{
+    GTEST_LOG_(INFO) << "RelabelEngine_Unchanged_001 start";
+    if (!xattrSupported_) {
+        GTEST_SKIP() << "no trusted xattrs on " << TEST_ROOT;
+    }
+    CountingLabeler labeler;
+    TreeFixResult result;
+    {
+        RelabelEngine engine(labeler.Func(), "digest-a");
+        ASSERT_EQ(engine.RelabelTree(TREE, result), E_OK);
+        EXPECT_EQ(labeler.Calls(), TREE_ENTRIES);
+        EXPECT_EQ(result.pruned, 0U);
+
+        labeler.Reset();
+        ASSERT_EQ(engine.RelabelTree(TREE, result), E_OK);
+        EXPECT_EQ(labeler.Calls(), 0U);
+        EXPECT_EQ(result.pruned, 1U);
+    }
+    {
+        // A sibling tree labeled separately is skipped when walked as part of its parent.
+        RelabelEngine engine(labeler.Func(), "digest-b");
+        labeler.Reset();
+        ASSERT_EQ(engine.RelabelTree(TREE + "/d0", result), E_OK);
+        EXPECT_EQ(labeler.Calls(), 2U + FILES_PER_DIR * 2);
+        labeler.Reset();
+        ASSERT_EQ(engine.RelabelTree(TREE, result), E_OK);
+        EXPECT_EQ(labeler.Calls(), TREE_ENTRIES - 2 - FILES_PER_DIR * 2);
+        EXPECT_EQ(result.pruned, 1U);
+    }
+    {
+        RelabelEngine engine(labeler.Func(), "digest-c");
+        labeler.Reset(TREE + "/d3/f7");
+        EXPECT_EQ(engine.RelabelTree(TREE, result), E_ERR);
+        EXPECT_EQ(result.failed, 1U);
+        labeler.Reset();
+        ASSERT_EQ(engine.RelabelTree(TREE, result), E_OK);
+        EXPECT_EQ(labeler.Calls(), TREE_ENTRIES);
+    }
+    {
+        // Without a digest every run labels everything.
+        RelabelEngine engine(labeler.Func(), "");
+        labeler.Reset();
+        ASSERT_EQ(engine.RelabelTree(TREE, result), E_OK);
+        EXPECT_EQ(labeler.Calls(), TREE_ENTRIES);
+    }
+    GTEST_LOG_(INFO) << "RelabelEngine_Unchanged_001 end";
+}
+
+/**
+ * @tc.name: RelabelEngine_Deferred_001
+ * @tc.desc: Verify deferred trees are relabeled in order off the calling thread and reported when done.
+ * @tc.type: FUNC
+ */
+HWTEST_F(RelabelEngineTest, RelabelEngine_Deferred_001, TestSize.Level1)
+{
+    GTEST_LOG_(INFO) << "RelabelEngine_Deferred_001 start";
+    CountingLabeler labeler;
+    RelabelEngine engine(labeler.Func(), "");
+    std::mutex mutex;
+    std::vector<RelabelReport> reports;
+    auto done = [&mutex, &reports](const RelabelReport &report) {
+        std::lock_guard<std::mutex> lock(mutex);
+        reports.push_back(report);
+    };
+    engine.RelabelTreeDeferred(TREE + "/d1", done);
+    engine.RelabelTreeDeferred(TEST_ROOT + "/none", done);
+    engine.RelabelTreeDeferred(TREE + "/d2", done);
+    engine.WaitIdle();
+    ASSERT_EQ(reports.size(), 3U);
+    EXPECT_EQ(reports[0].path, TREE + "/d1");
+    EXPECT_EQ(reports[0].err, E_OK);
+    EXPECT_EQ(reports[0].result.changed + reports[0].result.skipped, 2U + FILES_PER_DIR * 2);
+    EXPECT_EQ(reports[1].err, E_ERR);
+    EXPECT_EQ(reports[2].err, E_OK);
+    EXPECT_EQ(labeler.Calls(), 2 * (2U + FILES_PER_DIR * 2));
+
+    // The queue restarts after going idle.
+    engine.RelabelTreeDeferred(TREE, nullptr);
+    engine.WaitIdle();
+    EXPECT_EQ(labeler.Calls(), 2 * (2U + FILES_PER_DIR * 2) + TREE_ENTRIES);
+    GTEST_LOG_(INFO) << "RelabelEngine_Deferred_001 end";
+}
+
+/**
+ * @tc.name: RelabelEngine_Perf_001
+ * @tc.desc: Compare the unlock critical path of labeling whole trees inline with labeling the top
+ *           directory inline and deferring the tree, and the cost of a repeated run on an unchanged tree.
+ * @tc.type: PERF
+ */
+HWTEST_F(RelabelEngineTest, RelabelEngine_Perf_001, TestSize.Level3)
+{
+    GTEST_LOG_(INFO) << "RelabelEngine_Perf_001 start";
+    const std::string perfTree = TEST_ROOT + "/perf";
+    MakeTree(perfTree, PERF_DIRS, PERF_FILES_PER_DIR);
+    CountingLabeler labeler;
+    RelabelEngine engine(labeler.Func(PERF_LABEL_COST), xattrSupported_ ? "digest-perf" : "");
+    using Clock = std::chrono::steady_clock;
+
+    auto start = Clock::now();
+    TreeFixResult result;
+    ASSERT_EQ(engine.RelabelTree(perfTree, result), E_OK);
+    double inlineMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    uint64_t fullCalls = labeler.Calls();
+
+    labeler.Reset();
+    start = Clock::now();
+    ASSERT_EQ(engine.Relabel(perfTree), E_OK);
+    engine.RelabelTreeDeferred(perfTree);
+    double deferredMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    engine.WaitIdle();
+    uint64_t repeatCalls = labeler.Calls() - 1;
+
+    GTEST_LOG_(INFO) << "entries " << fullCalls << ": inline tree " << inlineMs << " ms, top dir + deferred "
+                     << deferredMs << " ms on the critical path, repeat run labeled " << repeatCalls;
+    EXPECT_LT(deferredMs, inlineMs);
+    if (xattrSupported_) {
+        EXPECT_EQ(repeatCalls, 0U);
+    }
+    GTEST_LOG_(INFO) << "RelabelEngine_Perf_001 end";
+}
+} // namespace StorageDaemon
+} // namespace OHOS
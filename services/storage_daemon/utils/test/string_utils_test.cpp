@@ -13,12 +13,17 @@
  * limitations under the License.
  */
 #include "string_utils.h"
+#include "utils/string_view_utils.h"
 
 #include <gtest/gtest.h>
 #include <tuple>
+#include <chrono>
 #include <climits>
 #include <cstdio>
 #include <fstream>
+#include <random>
+#include <regex>
+#include <sstream>
 
 #include "storage_service_constant.h"
 #include "storage_service_constants.h"
@@ -39,6 +44,112 @@ public:
 namespace {
 const std::string WRITE_FILE_SYNC_TEST_PATH = "/data/service/string_utils_write_test.txt";
 const std::string WRITE_FILE_SYNC_INVALID_PATH = "/data/service/not_exist_dir/string_utils_write_test.txt";
+constexpr int PROPERTY_ROUNDS = 20000;
+constexpr int PERF_ROUNDS = 100000;
+constexpr uint32_t RANDOM_SEED = 20260101;
+constexpr size_t RANDOM_MAX_LEN = 24;
+constexpr size_t RANDOM_TOKEN_LEN = 3;
+
+// The implementations before the string_view rewrite, kept as the reference for the property tests.
+std::vector<std::string> RefSplitLine(const std::string &line, const std::string &token)
+{
+    std::vector<std::string> result;
+    std::string::size_type start = 0;
+    std::string::size_type end = line.find(token);
+    while (std::string::npos != end) {
+        result.push_back(line.substr(start, end - start));
+        start = end + token.size();
+        end = line.find(token, start);
+    }
+    if (start != line.length()) {
+        result.push_back(line.substr(start));
+    }
+    return result;
+}
+
+std::unordered_map<std::string, std::string> RefParseKeyValuePairs(const std::string &input, char delimiter)
+{
+    std::unordered_map<std::string, std::string> result;
+    std::istringstream ss(input);
+    std::string token;
+    while (std::getline(ss, token, delimiter)) {
+        size_t equalPos = token.find('=');
+        std::string key = token.substr(0, equalPos);
+        if (!key.empty()) {
+            result[key] = equalPos == std::string::npos ? "" : token.substr(equalPos + 1);
+        }
+    }
+    return result;
+}
+
+int32_t RefReplaceAndCount(std::string &str, const std::string &target, const std::string &replacement)
+{
+    if (str.empty() || target.empty()) {
+        return 0;
+    }
+    int32_t count = 0;
+    size_t pos = 0;
+    while ((pos = str.find(target, pos)) != std::string::npos) {
+        str.replace(pos, target.length(), replacement);
+        pos += replacement.length();
+        count++;
+    }
+    return count;
+}
+
+bool RefConvertStringToInt(const std::string &str, int64_t &value, int32_t base)
+{
+    if (str.empty()) {
+        return false;
+    }
+    errno = 0;
+    char *endptr = nullptr;
+    int64_t result = std::strtoll(str.c_str(), &endptr, base);
+    if (endptr == str.c_str() || (errno == ERANGE && (result == LLONG_MAX || result == LLONG_MIN)) ||
+        *endptr != '\0') {
+        return false;
+    }
+    value = result;
+    return true;
+}
+
+bool RefConvertStringToInt32(const std::string &context, int32_t &value)
+{
+    std::regex pattern(R"(^([1-9]\d{0,9})$)");
+    if (context.empty() || !std::regex_match(context, pattern)) {
+        return false;
+    }
+    char *endptr = nullptr;
+    errno = 0;
+    int64_t tollRes = strtoll(context.c_str(), &endptr, BASE_DECIMAL);
+    if (errno != 0 || endptr != context.c_str() + context.size() || tollRes <= 0 || tollRes >= INT32_MAX) {
+        return false;
+    }
+    value = static_cast<int32_t>(tollRes);
+    return true;
+}
+
+std::string RandomString(std::mt19937 &gen, const std::string &alphabet, size_t maxLen)
+{
+    std::uniform_int_distribution<size_t> lenDist(0, maxLen);
+    std::uniform_int_distribution<size_t> charDist(0, alphabet.size() - 1);
+    std::string result(lenDist(gen), ' ');
+    for (auto &c : result) {
+        c = alphabet[charDist(gen)];
+    }
+    return result;
+}
+
+template<typename Func>
+double NsPerCall(Func func)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < PERF_ROUNDS; i++) {
+        func();
+    }
+    auto cost = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+    return static_cast<double>(cost.count()) / PERF_ROUNDS;
+}
 }
 
 /**
@@ -283,7 +394,171 @@ HWTEST_F(StringUtilsTest, StringUtilsTest_CheckIdRange_001, TestSize.Level1)
     EXPECT_FALSE(CheckIdRange(longId));
     GTEST_LOG_(INFO) << "StringUtilsTest_CheckIdRange_001 end";
 }
+
+/**
+ * @tc.name: StringUtilsTest_SplitView_001
+ * @tc.desc: Verify SplitView and SplitLine against the previous SplitLine on random input.
+ * @tc.type: FUNC
+ */
+HWTEST_F(StringUtilsTest, StringUtilsTest_SplitView_001, TestSize.Level1)
+{
+    GTEST_LOG_(INFO) << "StringUtilsTest_SplitView_001 start";
+    std::mt19937 gen(RANDOM_SEED);
+    for (int i = 0; i < PROPERTY_ROUNDS; i++) {
+        std::string line = RandomString(gen, "ab /", RANDOM_MAX_LEN);
+        std::string token = RandomString(gen, "ab /", RANDOM_TOKEN_LEN);
+        if (token.empty()) {
+            token = "/";
+        }
+        auto expected = RefSplitLine(line, token);
+        EXPECT_EQ(SplitLine(line, token), expected) << "line: " << line << ", token: " << token;
+        auto views = SplitView(line, token);
+        ASSERT_EQ(views.size(), expected.size());
+        for (size_t j = 0; j < views.size(); j++) {
+            EXPECT_EQ(views[j], expected[j]);
+            EXPECT_TRUE(views[j].data() >= line.data() && views[j].data() <= line.data() + line.size());
+        }
+    }
+    EXPECT_TRUE(SplitView("", " ").empty());
+    EXPECT_EQ(SplitView("abc", "").size(), 1u);
+    GTEST_LOG_(INFO) << "StringUtilsTest_SplitView_001 end";
+}
+
+/**
+ * @tc.name: StringUtilsTest_ParseKeyValueViews_001
+ * @tc.desc: Verify ParseKeyValueViews and ParseKeyValuePairs against the previous parser on random input.
+ * @tc.type: FUNC
+ */
+HWTEST_F(StringUtilsTest, StringUtilsTest_ParseKeyValueViews_001, TestSize.Level1)
+{
+    GTEST_LOG_(INFO) << "StringUtilsTest_ParseKeyValueViews_001 start";
+    std::mt19937 gen(RANDOM_SEED);
+    std::vector<KeyValueView> pairs;
+    for (int i = 0; i < PROPERTY_ROUNDS; i++) {
+        std::string input = RandomString(gen, "ab=,", RANDOM_MAX_LEN);
+        auto expected = RefParseKeyValuePairs(input, ',');
+        EXPECT_EQ(ParseKeyValuePairs(input, ','), expected) << "input: " << input;
+        ParseKeyValueViews(input, ',', pairs);
+        ASSERT_EQ(pairs.size(), expected.size());
+        for (const auto &pair : pairs) {
+            auto it = expected.find(std::string(pair.first));
+            ASSERT_NE(it, expected.end());
+            EXPECT_EQ(pair.second, it->second);
+        }
+    }
+    ParseKeyValueViews("b=1,a,b=2", ',', pairs);
+    ASSERT_EQ(pairs.size(), 2u);
+    EXPECT_EQ(pairs[0], KeyValueView("b", "2"));
+    EXPECT_EQ(pairs[1], KeyValueView("a", ""));
+    GTEST_LOG_(INFO) << "StringUtilsTest_ParseKeyValueViews_001 end";
+}
+
+/**
+ * @tc.name: StringUtilsTest_ReplaceAndCount_002
+ * @tc.desc: Verify ReplaceAndCount against the previous in place replacement on random input.
+ * @tc.type: FUNC
+ */
+HWTEST_F(StringUtilsTest, StringUtilsTest_ReplaceAndCount_002, TestSize.Level1)
+{
+    GTEST_LOG_(INFO) << "StringUtilsTest_ReplaceAndCount_002 start";
+    std::mt19937 gen(RANDOM_SEED);
+    for (int i = 0; i < PROPERTY_ROUNDS; i++) {
+        std::string str = RandomString(gen, "ab{}", RANDOM_MAX_LEN);
+        std::string target = RandomString(gen, "ab{}", RANDOM_TOKEN_LEN);
+        std::string replacement = RandomString(gen, "ab{}", RANDOM_TOKEN_LEN + 1);
+        std::string expected = str;
+        int32_t expectedCount = RefReplaceAndCount(expected, target, replacement);
+        std::string actual = str;
+        EXPECT_EQ(ReplaceAndCount(actual, target, replacement), expectedCount) << "str: " << str;
+        EXPECT_EQ(actual, expected) << "str: " << str << ", target: " << target << ", with: " << replacement;
+    }
+    GTEST_LOG_(INFO) << "StringUtilsTest_ReplaceAndCount_002 end";
+}
+
+/**
+ * @tc.name: StringUtilsTest_ConvertStringToInt_002
+ * @tc.desc: Verify ConvertStringToInt, ConvertStringToInt32 and StringIsNumber against the previous
+ *           strtoll and regex based versions on random input.
+ * @tc.type: FUNC
+ */
+HWTEST_F(StringUtilsTest, StringUtilsTest_ConvertStringToInt_002, TestSize.Level1)
+{
+    GTEST_LOG_(INFO) << "StringUtilsTest_ConvertStringToInt_002 start";
+    std::mt19937 gen(RANDOM_SEED);
+    const std::vector<int32_t> bases = { 0, 2, BASE_OCTAL, BASE_DECIMAL, 16, 36 };
+    const std::vector<std::string> edges = { "9223372036854775807", "-9223372036854775808", "9223372036854775808",
+        "-9223372036854775809", "0x7fffffffffffffff", "-0x8000000000000000", "0x", "0x+1", "+-1", "-+1", " \t+12",
+        "2147483647", "2147483646", "02147483646", "0", "00", "-0", "+", "-", "0X1F", "0x1g", "08" };
+    int edgeCount = static_cast<int>(edges.size());
+    for (int i = 0; i < PROPERTY_ROUNDS + edgeCount; i++) {
+        std::string str = i < edgeCount ? edges[i] : RandomString(gen, "0123456789aAfFxXzZ +-\t", RANDOM_MAX_LEN);
+        for (int32_t base : bases) {
+            int64_t expected = -1;
+            int64_t actual = -1;
+            bool expectedRet = RefConvertStringToInt(str, expected, base);
+            EXPECT_EQ(ConvertStringToInt(str, actual, base), expectedRet) << "str: " << str << ", base: " << base;
+            EXPECT_EQ(actual, expected) << "str: " << str << ", base: " << base;
+        }
+        int32_t expected32 = -1;
+        int32_t actual32 = -1;
+        EXPECT_EQ(ConvertStringToInt32(str, actual32), RefConvertStringToInt32(str, expected32)) << "str: " << str;
+        EXPECT_EQ(actual32, expected32);
+        bool isNumber = !str.empty() && str.find_first_not_of("0123456789") == std::string::npos;
+        EXPECT_EQ(StringIsNumber(str), isNumber);
+    }
+    int64_t value = 0;
+    EXPECT_TRUE(ParseInt64("-42", value));
+    EXPECT_EQ(value, -42);
+    EXPECT_FALSE(ParseInt64(" 42", value));
+    EXPECT_FALSE(ParseInt64("+42", value));
+    EXPECT_FALSE(ParseInt64("42", value, 1));
+    GTEST_LOG_(INFO) << "StringUtilsTest_ConvertStringToInt_002 end";
+}
+
+/**
+ * @tc.name: StringUtilsTest_Perf_001
+ * @tc.desc: Log the cost per call of each parser against its previous version.
+ * @tc.type: PERF
+ */
+HWTEST_F(StringUtilsTest, StringUtilsTest_Perf_001, TestSize.Level3)
+{
+    GTEST_LOG_(INFO) << "StringUtilsTest_Perf_001 start";
+    std::string mountLine = "31 30 0:60 / /mnt/hmdfs/100/account rw shared:7 master:3 - hmdfs "
+        "/data/service/el2/100/hmdfs/account rw,user_id=100";
+    std::string space = " ";
+    std::string options = "local_dst=/mnt/hmdfs/100/account,user_id=100,ra_pages=512,merge,cloud_disk";
+    std::string path = "/mnt/user/<currentUserId>/nosharefs/docs/<currentUserId>/appdata";
+    size_t sink = 0;
+    GTEST_LOG_(INFO) << "SplitLine ns: " << NsPerCall([&]() { sink += RefSplitLine(mountLine, space).size(); })
+        << " -> " << NsPerCall([&]() { sink += SplitLine(mountLine, space).size(); })
+        << ", SplitView ns: " << NsPerCall([&]() { sink += SplitView(mountLine, space).size(); });
+    std::vector<KeyValueView> pairs;
+    GTEST_LOG_(INFO) << "ParseKeyValuePairs ns: "
+        << NsPerCall([&]() { sink += RefParseKeyValuePairs(options, ',').size(); })
+        << " -> " << NsPerCall([&]() { sink += ParseKeyValuePairs(options, ',').size(); })
+        << ", ParseKeyValueViews ns: " << NsPerCall([&]() {
+            ParseKeyValueViews(options, ',', pairs);
+            sink += pairs.size();
+        });
+    GTEST_LOG_(INFO) << "ReplaceAndCount ns: " << NsPerCall([&]() {
+            std::string str = path;
+            sink += static_cast<size_t>(RefReplaceAndCount(str, "<currentUserId>", "100"));
+        }) << " -> " << NsPerCall([&]() {
+            std::string str = path;
+            sink += static_cast<size_t>(ReplaceAndCount(str, "<currentUserId>", "100"));
+        });
+    int64_t value = 0;
+    int32_t value32 = 0;
+    std::string number = "1234567";
+    GTEST_LOG_(INFO) << "ConvertStringToInt ns: "
+        << NsPerCall([&]() { sink += RefConvertStringToInt(number, value, BASE_DECIMAL); })
+        << " -> " << NsPerCall([&]() { sink += ConvertStringToInt(number, value, BASE_DECIMAL); })
+        << ", ConvertStringToInt32 ns: " << NsPerCall([&]() { sink += RefConvertStringToInt32(number, value32); })
+        << " -> " << NsPerCall([&]() { sink += ConvertStringToInt32(number, value32); })
+        << ", StringIsNumber ns: " << NsPerCall([&]() { sink += StringIsNumber(number); });
+    EXPECT_GT(sink, 0u);
+    GTEST_LOG_(INFO) << "StringUtilsTest_Perf_001 end";
+}
 } // Test
 } // STORAGE_DAEMON
 } // OHOS
-
@@ -17,10 +17,12 @@
 
 #include <csignal>
 #include <dirent.h>
+#include <set>
 #include <unistd.h>
 
 #include "storage_service_errno.h"
 #include "storage_service_log.h"
+#include "utils/proc_resource_scanner.h"
 #include "utils/string_utils.h"
 
 using namespace std;
@@ -82,39 +84,6 @@ bool Process::CheckSubDir(std::string subdir)
     return false;
 }
 
-bool Process::CheckMaps(std::string pidPath)
-{
-    char *buf = nullptr;
-    size_t lineLen = 0;
-    std::string line;
-    auto path = StringPrintf("%s/maps", pidPath.c_str());
-    FILE *file = fopen(path.c_str(), "r");
-    if (file == nullptr) {
-        LOGE("[L4:Process] CheckMaps: open failed, path=%{public}s, errno=%{public}d", path.c_str(), errno);
-        return false;
-    }
-
-    while (getline(&buf, &lineLen, file) > 0) {
-        line = buf;
-        std::string::size_type pos = line.find('/');
-        if (pos != line.npos) {
-            line = line.substr(pos);
-            if (CheckSubDir(line)) {
-                LOGI("[L4:Process] CheckMaps: found map in pidPath=%{public}s", pidPath.c_str());
-                (void)fclose(file);
-                free(buf);
-                buf = nullptr;
-                return true;
-            }
-        }
-    }
-
-    (void)fclose(file);
-    free(buf);
-    buf = nullptr;
-    return false;
-}
-
 bool Process::CheckSymlink(std::string path)
 {
     std::string link = Readlink(path);
@@ -153,29 +122,29 @@ int32_t Process::UpdatePidAndKill(int signal)
         return E_OK;
     }
 
-    struct dirent *dirEntry;
-    DIR *dir = opendir("/proc");
-    if (dir == nullptr) {
-        LOGE("[L4:Process] UpdatePidByPath: <<< EXIT FAILED <<< opendir /proc failed, errno=%{public}d", errno);
+    auto &scanner = ProcResourceScanner::GetInstance();
+    auto snapshot = scanner.GetSnapshot(PROC_RES_MAPS | PROC_RES_LINKS);
+    if (snapshot == nullptr) {
+        LOGE("[L4:Process] UpdatePidByPath: <<< EXIT FAILED <<< scan /proc failed");
         return E_ERR;
     }
 
-    while ((dirEntry = readdir(dir)) != nullptr) {
-        if (dirEntry->d_type != DT_DIR) continue;
-        pid_t pid = atoi(dirEntry->d_name);
-        if (pid > 0 && pid != getprocpid()) {
-            std::string pidPath = StringPrintf("/proc/%d", pid);
-            if (CheckMaps(pidPath)
-                || CheckSymlink(pidPath + "/cwd")
-                || CheckSymlink(pidPath + "/root")
-                || CheckSymlink(pidPath + "/exe")) {
-                LOGI("KILL PID %{public}d immediately", pid);
-                kill(pid, signal);
-            }
+    std::set<pid_t> pids;
+    pid_t self = getprocpid();
+    snapshot->ForEachWithPrefix(path_, PROC_RES_MAPS | PROC_RES_LINKS, [this, self, &pids](const ProcResource &res) {
+        if (res.pid != self && CheckSubDir(res.path)) {
+            pids.insert(res.pid);
         }
+        return true;
+    });
+    for (pid_t pid : pids) {
+        LOGI("KILL PID %{public}d immediately", pid);
+        kill(pid, signal);
+    }
+    if (!pids.empty()) {
+        scanner.Invalidate();
     }
 
-    (void)closedir(dir);
     LOGD("[L4:Process] UpdatePidByPath: <<< EXIT SUCCESS <<< ");
     return E_OK;
 }
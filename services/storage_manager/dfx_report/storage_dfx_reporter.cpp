@@ -16,6 +16,7 @@
 #include "dfx_report/storage_dfx_reporter.h"
 
 #include <chrono>
+#include <cinttypes>
 #include <ctime>
 #include <iomanip>
 #include <sstream>
@@ -123,15 +124,13 @@ void StorageDfxReporter::ExecuteHapAndSaStatistics(int32_t userId)
         return;
     }
     CollectMetadataAndAnco(extraData);
-    ret = CollectBundleStatistics(userId, extraData);
+    // A clone request that comes in while this report is running is left for the next one.
+    bool isClone = isCloneStorageRuning_.exchange(false);
+    ret = CollectBundleStatistics(userId, extraData, isClone);
     CollectSubUserStorageStats(extraData);
 
     PrintOverLongLog(extraData.str());
-    std::string orgPkgName = "RoutineStorageStatus";
-    if (isCloneStorageRuning_.load() == true) {
-        orgPkgName = "CloneStorageStatus";
-        isCloneStorageRuning_.store(false);
-    }
+    std::string orgPkgName = isClone ? "CloneStorageStatus" : "RoutineStorageStatus";
     StorageService::StorageRadar::ReportStorageStatusRadar(orgPkgName, extraData.str());
     LOGI("StorageDfxReporter StartReportHapAndSaStorageStatus end.");
     LOGI("Hap and Sa statistics thread completed.");
@@ -237,7 +236,7 @@ void StorageDfxReporter::CollectMetadataAndAnco(std::ostringstream &extraData)
     GetAncoDataSize(extraData);
 }
 
-int32_t StorageDfxReporter::CollectBundleStatistics(int32_t userId, std::ostringstream &extraData)
+int32_t StorageDfxReporter::CollectBundleStatistics(int32_t userId, std::ostringstream &extraData, bool fullReport)
 {
     auto& sdCommunication = StorageDaemonCommunication::GetInstance();
     int64_t usedInodes = 0;
@@ -257,14 +256,7 @@ int32_t StorageDfxReporter::CollectBundleStatistics(int32_t userId, std::ostring
     AllAppVec allVec;
     int64_t saTotalSize = 0;
     int64_t othersTotalSize = 0;
-    if (sdCommunication.QueryOccupiedSpaceForSa(allVec.sysSaVec, saTotalSize,
-        bundleNameAndUid, StorageDaemon::AppType::SYS_SA) != E_OK ||
-        sdCommunication.QueryOccupiedSpaceForSa(allVec.sysAppVec, othersTotalSize,
-        bundleNameAndUid, StorageDaemon::AppType::SYS_APP) != E_OK ||
-        sdCommunication.QueryOccupiedSpaceForSa(allVec.userAppVec, othersTotalSize,
-        bundleNameAndUid, StorageDaemon::AppType::USER_APP) != E_OK ||
-        sdCommunication.QueryOccupiedSpaceForSa(allVec.otherAppVec, othersTotalSize,
-        bundleNameAndUid, StorageDaemon::AppType::OTHER_APP) != E_OK) {
+    if (sdCommunication.QueryOccupiedSpaceForAll(allVec, saTotalSize, othersTotalSize, bundleNameAndUid) != E_OK) {
         extraData << "{bundleCount:" << bundleNameAndUid.size() << "}" << std::endl;
         return E_OK;
     }
@@ -272,7 +264,7 @@ int32_t StorageDfxReporter::CollectBundleStatistics(int32_t userId, std::ostring
     extraData << "{other totalSize is:" << ConvertBytesToMB(othersTotalSize, ACCURACY_NUM) << "MB}" << std::endl;
 
     CorrectSaFromWhiteList(allVec.sysSaVec);
-    WriteUidInfoListToExtraData(allVec, extraData);
+    WriteUidInfoListToExtraData(allVec, extraData, fullReport);
     extraData << "{bundleCount:" << bundleNameAndUid.size() << "}" << std::endl;
     return E_OK;
 }
@@ -296,29 +288,72 @@ void StorageDfxReporter::CorrectSaFromWhiteList(std::vector<UidSaInfo> &vec)
     }
 }
 
-void StorageDfxReporter::WriteExtraData(const std::vector<UidSaInfo> &vec, std::ostringstream &extraData)
+void StorageDfxReporter::SetReportDeltaThreshold(int64_t bytes)
+{
+    deltaThreshold_.store(bytes < 0 ? 0 : bytes);
+}
+
+void StorageDfxReporter::WriteExtraData(SnapshotDelta &delta, SnapshotKind kind, const std::vector<UidSaInfo> &vec,
+    ReportArena &arena)
 {
     for (const auto& info : vec) {
-        extraData << "{uid:" << info.uid
-            << ",saName:" << info.saName
-            << ",size:" << ConvertBytesToMB(info.size, ACCURACY_NUM)
-            << "MB, iNodes:" << info.iNodes << "}" << std::endl;
+        int64_t change = 0;
+        uint64_t key = StorageReportSnapshot::MakeKey(kind, static_cast<uint32_t>(info.uid));
+        if (!delta.Visit(key, info.size, change)) {
+            continue;
+        }
+        if (arena.Append("{uid:%d,saName:%s,size:%.2fMB, iNodes:%" PRId64 ",delta:%+.2fMB}\n", info.uid,
+            info.saName.c_str(), ConvertBytesToMB(info.size, ACCURACY_NUM), static_cast<int64_t>(info.iNodes),
+            static_cast<double>(change) / DIVISOR)) {
+            delta.Commit(key, info.size);
+        }
     }
 }
 
-void StorageDfxReporter::WriteUidInfoListToExtraData(AllAppVec &allVec, std::ostringstream &extraData)
+void StorageDfxReporter::WriteUidInfoListToExtraData(AllAppVec &allVec, std::ostringstream &extraData,
+    bool fullReport)
 {
-    extraData << "{Sa data is:}" << std::endl;
-    WriteExtraData(allVec.sysSaVec, extraData);
-    extraData << "{SysApp data is:}" << std::endl;
-    WriteExtraData(allVec.sysAppVec, extraData);
-    extraData << "{UserApp data is:}" << std::endl;
-    WriteExtraData(allVec.userAppVec, extraData);
+    // Only uids that are new, gone, or moved by more than the threshold since their last report are written.
+    // A full report is taken against an empty baseline, so it lists every uid and leaves uidSnapshot_ alone.
+    StorageReportSnapshot emptySnapshot;
+    ReportArena arena;
+    SnapshotDelta delta(fullReport ? emptySnapshot : uidSnapshot_, deltaThreshold_.load());
+    arena.Append("{Sa data is:}\n");
+    WriteExtraData(delta, SnapshotKind::SA, allVec.sysSaVec, arena);
+    arena.Append("{SysApp data is:}\n");
+    WriteExtraData(delta, SnapshotKind::SYS_APP, allVec.sysAppVec, arena);
+    arena.Append("{UserApp data is:}\n");
+    WriteExtraData(delta, SnapshotKind::USER_APP, allVec.userAppVec, arena);
     if (!allVec.otherAppVec.empty()) {
-        extraData << "{otherAppVec data is:}" << std::endl;
-        WriteExtraData(allVec.otherAppVec, extraData);
+        arena.Append("{otherAppVec data is:}\n");
+        WriteExtraData(delta, SnapshotKind::OTHER_APP, allVec.otherAppVec, arena);
     } else {
-        extraData << "{otherAppVec data is null}" << std::endl;
+        arena.Append("{otherAppVec data is null}\n");
+    }
+    if (fullReport) {
+        AppendArena(arena, extraData);
+        LOGI("uid full report written, bytes=%{public}zu", arena.Size());
+        return;
+    }
+    uint32_t removed = 0;
+    uidSnapshot_ = delta.Finish([&arena, &removed](const SnapshotEntry &entry) {
+        if (!arena.Append("{uid:%" PRIu64 ",removed}\n", StorageReportSnapshot::IdOf(entry.key))) {
+            return false;
+        }
+        removed++;
+        return true;
+    });
+    AppendArena(arena, extraData);
+    LOGI("uid delta written, bytes=%{public}zu, removed=%{public}u, tracked=%{public}zu", arena.Size(), removed,
+        uidSnapshot_.Count());
+}
+
+void StorageDfxReporter::AppendArena(const ReportArena &arena, std::ostringstream &extraData)
+{
+    extraData.write(arena.Data(), arena.Size());
+    if (arena.Dropped() > 0) {
+        LOGE("report arena full, dropped %{public}u entries", arena.Dropped());
+        extraData << "{dropped entries:" << arena.Dropped() << "}" << std::endl;
     }
 }
 
@@ -357,23 +392,22 @@ void StorageDfxReporter::GetMetaDataSize(std::ostringstream &extraData)
 {
     LOGI("begin get MetaData info.");
 
-    std::string blkPath = std::string(HMFS_PATH) + std::string(MAIN_BLKADDR);
-    std::string chunkPath = std::string(HMFS_PATH) + std::string(OVP_CHUNKS);
-
-    int64_t blkSize = -1;
+    std::vector<std::string> paths = { std::string(HMFS_PATH) + std::string(MAIN_BLKADDR),
+        std::string(HMFS_PATH) + std::string(OVP_CHUNKS) };
+    std::vector<int64_t> sizes;
     auto& sdCommunication = StorageDaemonCommunication::GetInstance();
+    auto ret = sdCommunication.GetDataSizeByPaths(paths, sizes);
+    int64_t blkSize = sizes.size() == paths.size() ? sizes[0] : -1;
+    int64_t chunkSize = sizes.size() == paths.size() ? sizes[1] : -1;
 
-    auto ret = sdCommunication.GetDataSizeByPath(blkPath, blkSize);
-    if (ret == E_OK && blkSize != -1) {
+    if (blkSize != -1) {
         extraData << "{main_blkaddr data is:" << ConvertBytesToMB(blkSize * FOUR_K, ACCURACY_NUM)
         << "MB}" << std::endl;
     } else {
         extraData << "{get main_blkaddr wrong, ret:" << ret << ",blkSize is:" << blkSize << "}" << std::endl;
     }
 
-    int64_t chunkSize = -1;
-    ret = sdCommunication.GetDataSizeByPath(chunkPath, chunkSize);
-    if (ret == E_OK && chunkSize != -1) {
+    if (chunkSize != -1) {
         extraData << "{ovp_chunks data is:" << ConvertBytesToMB(chunkSize * FOUR_K * BLOCK_COUNT, ACCURACY_NUM)
         << "MB}" << std::endl;
     } else {
@@ -519,17 +553,27 @@ int32_t StorageDfxReporter::UpdateScanState(int64_t totalSize)
 void StorageDfxReporter::AppendDirInfo(const std::vector<DirSpaceInfo> &dirs,
     std::ostringstream &extraData)
 {
+    ReportArena arena;
+    SnapshotDelta delta(dirSnapshot_, deltaThreshold_.load());
     int32_t count = 0;
     for (const auto& info : dirs) {
         if (count >= TOP_COUNT) {
             break;
         }
-        extraData << "  {path:" << info.path
-                  << ",uid:" << info.uid
-                  << ",size:" << ConvertBytesToMB(info.size, ACCURACY_NUM)
-                  << "MB}" << std::endl;
         count++;
+        int64_t change = 0;
+        uint64_t key = StorageReportSnapshot::PathKey(info.path);
+        if (!delta.Visit(key, info.size, change)) {
+            continue;
+        }
+        if (arena.Append("  {path:%s,uid:%u,size:%.2fMB,delta:%+.2fMB}\n", info.path.c_str(), info.uid,
+            ConvertBytesToMB(info.size, ACCURACY_NUM), static_cast<double>(change) / DIVISOR)) {
+            delta.Commit(key, info.size);
+        }
     }
+    // The lists are reported one by one, so dirs not in this one keep their last reported size.
+    dirSnapshot_ = delta.Finish(nullptr);
+    AppendArena(arena, extraData);
 }
 
 std::vector<DirSpaceInfo> StorageDfxReporter::GetRootDirList()
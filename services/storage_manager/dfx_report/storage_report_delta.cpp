@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) 2026 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "dfx_report/storage_report_delta.h"
+
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
+
+namespace OHOS {
+namespace StorageManager {
+constexpr uint32_t KIND_SHIFT = 56;
+constexpr uint64_t ID_MASK = (1ULL << KIND_SHIFT) - 1;
+constexpr uint64_t FNV_OFFSET_BASIS = 14695981039346656037ULL;
+constexpr uint64_t FNV_PRIME = 1099511628211ULL;
+
+ReportArena::ReportArena(size_t capacity) : buf_(new char[capacity + 1]), capacity_(capacity)
+{
+    buf_[0] = '\0';
+}
+
+bool ReportArena::Append(const char *format, ...)
+{
+    size_t remaining = capacity_ - used_;
+    va_list args;
+    va_start(args, format);
+    int len = vsnprintf(buf_.get() + used_, remaining + 1, format, args);
+    va_end(args);
+    if (len < 0 || static_cast<size_t>(len) > remaining) {
+        buf_[used_] = '\0';
+        dropped_++;
+        return false;
+    }
+    used_ += static_cast<size_t>(len);
+    return true;
+}
+
+uint64_t StorageReportSnapshot::MakeKey(SnapshotKind kind, uint64_t id)
+{
+    return (static_cast<uint64_t>(kind) << KIND_SHIFT) | (id & ID_MASK);
+}
+
+uint64_t StorageReportSnapshot::PathKey(const std::string &path)
+{
+    uint64_t hash = FNV_OFFSET_BASIS;
+    for (char c : path) {
+        hash = (hash ^ static_cast<uint8_t>(c)) * FNV_PRIME;
+    }
+    return MakeKey(SnapshotKind::DIR, hash);
+}
+
+SnapshotKind StorageReportSnapshot::KindOf(uint64_t key)
+{
+    return static_cast<SnapshotKind>(key >> KIND_SHIFT);
+}
+
+uint64_t StorageReportSnapshot::IdOf(uint64_t key)
+{
+    return key & ID_MASK;
+}
+
+const SnapshotEntry *StorageReportSnapshot::Find(uint64_t key) const
+{
+    auto it = std::lower_bound(entries_.begin(), entries_.end(), key,
+        [](const SnapshotEntry &entry, uint64_t value) { return entry.key < value; });
+    if (it == entries_.end() || it->key != key) {
+        return nullptr;
+    }
+    return &*it;
+}
+
+SnapshotDelta::SnapshotDelta(const StorageReportSnapshot &prev, int64_t threshold)
+    : prev_(prev), threshold_(threshold), visited_(prev.Count(), false)
+{
+    next_.reserve(prev.Count());
+}
+
+bool SnapshotDelta::Visit(uint64_t key, int64_t size, int64_t &delta)
+{
+    const SnapshotEntry *old = prev_.Find(key);
+    if (old == nullptr) {
+        delta = size;
+        return true;
+    }
+    visited_[old - prev_.entries_.data()] = true;
+    delta = size - old->size;
+    // The old size stays until Commit replaces it.
+    next_.push_back(*old);
+    return delta > threshold_ || delta < -threshold_;
+}
+
+void SnapshotDelta::Commit(uint64_t key, int64_t size)
+{
+    if (!next_.empty() && next_.back().key == key) {
+        next_.back().size = size;
+        return;
+    }
+    next_.push_back({ key, size });
+}
+
+StorageReportSnapshot SnapshotDelta::Finish(const std::function<bool(const SnapshotEntry &entry)> &removed)
+{
+    for (size_t i = 0; i < visited_.size(); i++) {
+        if (visited_[i]) {
+            continue;
+        }
+        if (!removed || !removed(prev_.entries_[i])) {
+            next_.push_back(prev_.entries_[i]);
+        }
+    }
+    std::stable_sort(next_.begin(), next_.end(),
+        [](const SnapshotEntry &a, const SnapshotEntry &b) { return a.key < b.key; });
+    next_.erase(std::unique(next_.begin(), next_.end(),
+        [](const SnapshotEntry &a, const SnapshotEntry &b) { return a.key == b.key; }), next_.end());
+    StorageReportSnapshot snapshot;
+    snapshot.entries_.swap(next_);
+    return snapshot;
+}
+} // namespace StorageManager
+} // namespace OHOS
@@ -60,6 +60,9 @@ public:
 void StorageDfxReporterTest::SetUp()
 {
     StorageDfxReporter::GetInstance().lastTotalSize_ = 0;
+    StorageDfxReporter::GetInstance().uidSnapshot_.Clear();
+    StorageDfxReporter::GetInstance().dirSnapshot_.Clear();
+    StorageDfxReporter::GetInstance().SetReportDeltaThreshold(REPORT_DELTA_THRESHOLD);
     // Ensure no background threads are running
     StorageDfxReporter::GetInstance().isHapAndSaRunning_.store(false);
     StorageDfxReporter::GetInstance().isScanRunning_.store(false);
@@ -121,7 +124,7 @@ HWTEST_F(StorageDfxReporterTest, Storage_Service_StorageDfxReporterTest_StartRep
     EXPECT_CALL(*sdc, GetDataSizeByPath(_, _)).WillRepeatedly(DoAll(SetArgReferee<1>(100), Return(0)));
     EXPECT_CALL(*sdc, GetRmgResourceSize(_, _)).WillRepeatedly(DoAll(SetArgReferee<1>(50), Return(0)));
     EXPECT_CALL(*sss, GetBundleNameAndUid(_, _)).WillRepeatedly(Return(0));
-    EXPECT_CALL(*sdc, QueryOccupiedSpaceForSa(_, _, _, _)).WillRepeatedly(Return(0));
+    EXPECT_CALL(*sdc, QueryOccupiedSpaceForAll(_, _, _, _)).WillRepeatedly(Return(0));
 
     StorageDfxReporter::GetInstance().isHapAndSaRunning_.store(false);
     StorageDfxReporter::GetInstance().StartReportHapAndSaStorageStatus();
@@ -157,7 +160,7 @@ HWTEST_F(StorageDfxReporterTest, Storage_Service_StorageDfxReporterTest_ExecuteH
     EXPECT_CALL(*sdc, GetDataSizeByPath(_, _)).WillRepeatedly(DoAll(SetArgReferee<1>(100), Return(0)));
     EXPECT_CALL(*sdc, GetRmgResourceSize(_, _)).WillRepeatedly(DoAll(SetArgReferee<1>(50), Return(0)));
     EXPECT_CALL(*sss, GetBundleNameAndUid(_, _)).WillRepeatedly(Return(0));
-    EXPECT_CALL(*sdc, QueryOccupiedSpaceForSa(_, _, _, _)).WillRepeatedly(Return(0));
+    EXPECT_CALL(*sdc, QueryOccupiedSpaceForAll(_, _, _, _)).WillRepeatedly(Return(0));
     StorageDfxReporter::GetInstance().ExecuteHapAndSaStatistics(userId);
 
     GTEST_LOG_(INFO) << "Storage_Service_StorageDfxReporterTest_ExecuteHapAndSaStatistics_001 end";
@@ -197,12 +200,12 @@ HWTEST_F(StorageDfxReporterTest, Storage_Service_StorageDfxReporterTest_CollectB
     std::ostringstream extraData;
     int32_t userId = 100;
     EXPECT_CALL(*sss, GetBundleNameAndUid(_, _)).WillOnce(Return(0));
-    EXPECT_CALL(*sdc, QueryOccupiedSpaceForSa(_, _, _, _)).WillRepeatedly(Return(0));
+    EXPECT_CALL(*sdc, QueryOccupiedSpaceForAll(_, _, _, _)).WillRepeatedly(Return(0));
     int32_t ret = StorageDfxReporter::GetInstance().CollectBundleStatistics(userId, extraData);
     EXPECT_EQ(ret, 0);
 
     EXPECT_CALL(*sss, GetBundleNameAndUid(_, _)).WillOnce(Return(-1));
-    EXPECT_CALL(*sdc, QueryOccupiedSpaceForSa(_, _, _, _)).WillRepeatedly(Return(-1));
+    EXPECT_CALL(*sdc, QueryOccupiedSpaceForAll(_, _, _, _)).WillRepeatedly(Return(-1));
     ret = StorageDfxReporter::GetInstance().CollectBundleStatistics(userId, extraData);
     EXPECT_EQ(ret, 0);
     GTEST_LOG_(INFO) << "Storage_Service_StorageDfxReporterTest_CollectBundleStatistics_001 end";
@@ -592,10 +595,10 @@ HWTEST_F(StorageDfxReporterTest, Storage_Service_StorageDfxReporterTest_CollectB
     std::ostringstream extraData;
     int32_t userId = 100;
 
-    // Test case 1: All QueryOccupiedSpaceForSa calls succeed
+    // Test case 1: QueryOccupiedSpaceForAll succeeds
     EXPECT_CALL(*stss, GetUsedInodes(_)).WillOnce(DoAll(SetArgReferee<0>(1000), Return(0)));
     EXPECT_CALL(*sss, GetBundleNameAndUid(_, _)).WillOnce(Return(0));
-    EXPECT_CALL(*sdc, QueryOccupiedSpaceForSa(_, _, _, _)).WillRepeatedly(Return(0));
+    EXPECT_CALL(*sdc, QueryOccupiedSpaceForAll(_, _, _, _)).WillRepeatedly(Return(0));
     int32_t ret = StorageDfxReporter::GetInstance().CollectBundleStatistics(userId, extraData);
     EXPECT_EQ(ret, 0);
     std::string output = extraData.str();
@@ -623,39 +626,30 @@ HWTEST_F(StorageDfxReporterTest, Storage_Service_StorageDfxReporterTest_CollectB
     std::ostringstream extraData;
     int32_t userId = 100;
 
-    // Test case: Some QueryOccupiedSpaceForSa calls fail
+    // Test case: the single query fails, only the bundle count is reported
     EXPECT_CALL(*stss, GetUsedInodes(_)).WillOnce(DoAll(SetArgReferee<0>(1000), Return(0)));
     EXPECT_CALL(*sss, GetBundleNameAndUid(_, _)).WillOnce(Return(0));
-    EXPECT_CALL(*sdc, QueryOccupiedSpaceForSa(_, _, _, _))
-        .WillOnce(Return(0))
-        .WillOnce(Return(0))
-        .WillOnce(Return(0))
-        .WillOnce(Return(-1));
+    EXPECT_CALL(*sdc, QueryOccupiedSpaceForAll(_, _, _, _)).WillOnce(Return(-1));
     int32_t ret = StorageDfxReporter::GetInstance().CollectBundleStatistics(userId, extraData);
     EXPECT_EQ(ret, 0);
-
-    EXPECT_CALL(*stss, GetUsedInodes(_)).WillOnce(DoAll(SetArgReferee<0>(1000), Return(0)));
-    EXPECT_CALL(*sss, GetBundleNameAndUid(_, _)).WillOnce(Return(0));
-    EXPECT_CALL(*sdc, QueryOccupiedSpaceForSa(_, _, _, _))
-        .WillOnce(Return(0))
-        .WillOnce(Return(0))
-        .WillOnce(Return(-1));
-    ret = StorageDfxReporter::GetInstance().CollectBundleStatistics(userId, extraData);
-    EXPECT_EQ(ret, 0);
-
-    EXPECT_CALL(*stss, GetUsedInodes(_)).WillOnce(DoAll(SetArgReferee<0>(1000), Return(0)));
-    EXPECT_CALL(*sss, GetBundleNameAndUid(_, _)).WillOnce(Return(0));
-    EXPECT_CALL(*sdc, QueryOccupiedSpaceForSa(_, _, _, _))
-        .WillOnce(Return(0))
-        .WillOnce(Return(-1));
-    ret = StorageDfxReporter::GetInstance().CollectBundleStatistics(userId, extraData);
-    EXPECT_EQ(ret, 0);
-
+    EXPECT_EQ(extraData.str().find("Sa data is"), std::string::npos);
+
+    // Test case: all four classes and both totals come from one query
+    AllAppVec reply;
+    reply.sysSaVec = {{1234, "foundation", 3 * 1000 * 1000}};
+    reply.sysAppVec = {{10010, "com.ohos.sysapp", 1000}};
+    reply.userAppVec = {{20010010, "com.ohos.userapp", 2000}};
+    reply.otherAppVec = {{4321, "", 5 * 1000 * 1000}};
     EXPECT_CALL(*stss, GetUsedInodes(_)).WillOnce(DoAll(SetArgReferee<0>(1000), Return(0)));
     EXPECT_CALL(*sss, GetBundleNameAndUid(_, _)).WillOnce(Return(0));
-    EXPECT_CALL(*sdc, QueryOccupiedSpaceForSa(_, _, _, _)).WillOnce(Return(-1));
+    EXPECT_CALL(*sdc, QueryOccupiedSpaceForAll(_, _, _, _)).Times(1)
+        .WillOnce(DoAll(SetArgReferee<0>(reply), SetArgReferee<1>(3 * 1000 * 1000),
+            SetArgReferee<2>(5 * 1000 * 1000), Return(0)));
     ret = StorageDfxReporter::GetInstance().CollectBundleStatistics(userId, extraData);
     EXPECT_EQ(ret, 0);
+    EXPECT_NE(extraData.str().find("{sa totalSize is:"), std::string::npos);
+    EXPECT_NE(extraData.str().find("{other totalSize is:"), std::string::npos);
+    EXPECT_NE(extraData.str().find("com.ohos.userapp"), std::string::npos);
 
     std::string output = extraData.str();
     EXPECT_FALSE(output.empty());
@@ -678,7 +672,7 @@ HWTEST_F(StorageDfxReporterTest, Storage_Service_StorageDfxReporterTest_CollectB
     // Test case: GetBundleNameAndUid returns empty map
     EXPECT_CALL(*stss, GetUsedInodes(_)).WillOnce(DoAll(SetArgReferee<0>(1000), Return(0)));
     EXPECT_CALL(*sss, GetBundleNameAndUid(_, _)).WillOnce(Return(0));
-    EXPECT_CALL(*sdc, QueryOccupiedSpaceForSa(_, _, _, _)).WillRepeatedly(Return(0));
+    EXPECT_CALL(*sdc, QueryOccupiedSpaceForAll(_, _, _, _)).WillRepeatedly(Return(0));
     int32_t ret = StorageDfxReporter::GetInstance().CollectBundleStatistics(userId, extraData);
     EXPECT_EQ(ret, 0);
     std::string output = extraData.str();
@@ -708,7 +702,7 @@ HWTEST_F(StorageDfxReporterTest, Storage_Service_StorageDfxReporterTest_ExecuteH
     EXPECT_CALL(*sdc, GetDataSizeByPath(_, _)).WillRepeatedly(DoAll(SetArgReferee<1>(100), Return(0)));
     EXPECT_CALL(*sdc, GetRmgResourceSize(_, _)).WillRepeatedly(DoAll(SetArgReferee<1>(50), Return(0)));
     EXPECT_CALL(*sss, GetBundleNameAndUid(_, _)).WillRepeatedly(Return(0));
-    EXPECT_CALL(*sdc, QueryOccupiedSpaceForSa(_, _, _, _)).WillRepeatedly(Return(0));
+    EXPECT_CALL(*sdc, QueryOccupiedSpaceForAll(_, _, _, _)).WillRepeatedly(Return(0));
 
     StorageDfxReporter::GetInstance().ExecuteHapAndSaStatistics(userId);
 
@@ -736,7 +730,7 @@ HWTEST_F(StorageDfxReporterTest, Storage_Service_StorageDfxReporterTest_ExecuteH
     EXPECT_CALL(*sdc, GetDataSizeByPath(_, _)).WillRepeatedly(DoAll(SetArgReferee<1>(100), Return(0)));
     EXPECT_CALL(*sdc, GetRmgResourceSize(_, _)).WillRepeatedly(DoAll(SetArgReferee<1>(50), Return(0)));
     EXPECT_CALL(*sss, GetBundleNameAndUid(_, _)).WillRepeatedly(Return(0));
-    EXPECT_CALL(*sdc, QueryOccupiedSpaceForSa(_, _, _, _)).WillRepeatedly(Return(0));
+    EXPECT_CALL(*sdc, QueryOccupiedSpaceForAll(_, _, _, _)).WillRepeatedly(Return(0));
     // Sub-user calls (different userId) will fail
     EXPECT_CALL(*sss, GetUserStorageStats(Ne(userId), _, _)).WillRepeatedly(Return(-1));
 
@@ -805,11 +799,12 @@ HWTEST_F(StorageDfxReporterTest, Storage_Service_StorageDfxReporterTest_CollectS
 HWTEST_F(StorageDfxReporterTest, Storage_Service_StorageDfxReporterTest_WriteExtraData_001, TestSize.Level1)
 {
     GTEST_LOG_(INFO) << "Storage_Service_StorageDfxReporterTest_WriteExtraData_001 start";
-    std::ostringstream extraData;
+    StorageReportSnapshot prev;
+    SnapshotDelta delta(prev, REPORT_DELTA_THRESHOLD);
+    ReportArena arena;
     std::vector<UidSaInfo> emptyVec;
-    StorageDfxReporter::GetInstance().WriteExtraData(emptyVec, extraData);
-    std::string output = extraData.str();
-    EXPECT_TRUE(output.empty());
+    StorageDfxReporter::GetInstance().WriteExtraData(delta, SnapshotKind::SA, emptyVec, arena);
+    EXPECT_EQ(arena.Size(), 0U);
     GTEST_LOG_(INFO) << "Storage_Service_StorageDfxReporterTest_WriteExtraData_001 end";
 }
 
@@ -822,12 +817,14 @@ HWTEST_F(StorageDfxReporterTest, Storage_Service_StorageDfxReporterTest_WriteExt
 HWTEST_F(StorageDfxReporterTest, Storage_Service_StorageDfxReporterTest_WriteExtraData_002, TestSize.Level1)
 {
     GTEST_LOG_(INFO) << "Storage_Service_StorageDfxReporterTest_WriteExtraData_002 start";
-    std::ostringstream extraData;
+    StorageReportSnapshot prev;
+    SnapshotDelta delta(prev, REPORT_DELTA_THRESHOLD);
+    ReportArena arena;
     std::vector<UidSaInfo> vec;
     UidSaInfo info(1001, "TestService", 1024, 500);
     vec.push_back(info);
-    StorageDfxReporter::GetInstance().WriteExtraData(vec, extraData);
-    std::string output = extraData.str();
+    StorageDfxReporter::GetInstance().WriteExtraData(delta, SnapshotKind::SA, vec, arena);
+    std::string output(arena.Data(), arena.Size());
     EXPECT_FALSE(output.empty());
     EXPECT_NE(output.find("uid:1001"), std::string::npos);
     EXPECT_NE(output.find("saName:TestService"), std::string::npos);
@@ -845,13 +842,15 @@ HWTEST_F(StorageDfxReporterTest, Storage_Service_StorageDfxReporterTest_WriteExt
 HWTEST_F(StorageDfxReporterTest, Storage_Service_StorageDfxReporterTest_WriteExtraData_003, TestSize.Level1)
 {
     GTEST_LOG_(INFO) << "Storage_Service_StorageDfxReporterTest_WriteExtraData_003 start";
-    std::ostringstream extraData;
+    StorageReportSnapshot prev;
+    SnapshotDelta delta(prev, REPORT_DELTA_THRESHOLD);
+    ReportArena arena;
     std::vector<UidSaInfo> vec;
     vec.push_back(UidSaInfo(1001, "ServiceA", 1024, 100));
     vec.push_back(UidSaInfo(2002, "ServiceB", 2048, 200));
     vec.push_back(UidSaInfo(3003, "ServiceC", 4096, 300));
-    StorageDfxReporter::GetInstance().WriteExtraData(vec, extraData);
-    std::string output = extraData.str();
+    StorageDfxReporter::GetInstance().WriteExtraData(delta, SnapshotKind::SA, vec, arena);
+    std::string output(arena.Data(), arena.Size());
     EXPECT_FALSE(output.empty());
     EXPECT_NE(output.find("uid:1001"), std::string::npos);
     EXPECT_NE(output.find("uid:2002"), std::string::npos);
@@ -891,6 +890,87 @@ HWTEST_F(StorageDfxReporterTest, Storage_Service_StorageDfxReporterTest_WriteUid
     GTEST_LOG_(INFO) << "Storage_Service_StorageDfxReporterTest_WriteUidInfoListToExtraData_001 end";
 }
 
+/**
+ * @tc.name: Storage_Service_StorageDfxReporterTest_WriteUidInfoListToExtraData_002
+ * @tc.desc: Verify a second report only carries the uids that are new, gone, or moved by more than the threshold.
+ * @tc.type: FUNC
+ * @tc.require: AR000XXXX
+ */
+HWTEST_F(StorageDfxReporterTest, Storage_Service_StorageDfxReporterTest_WriteUidInfoListToExtraData_002,
+    TestSize.Level1)
+{
+    GTEST_LOG_(INFO) << "Storage_Service_StorageDfxReporterTest_WriteUidInfoListToExtraData_002 start";
+    auto &reporter = StorageDfxReporter::GetInstance();
+    const int64_t mb = 1000 * 1000;
+    reporter.SetReportDeltaThreshold(10 * mb);
+    AllAppVec allVec;
+    allVec.sysSaVec.push_back(UidSaInfo(1001, "SysSa", 100 * mb, 100));
+    allVec.sysAppVec.push_back(UidSaInfo(2002, "SysApp", 100 * mb, 200));
+    allVec.userAppVec.push_back(UidSaInfo(3003, "UserApp", 100 * mb, 300));
+    allVec.userAppVec.push_back(UidSaInfo(3004, "GoneApp", 100 * mb, 300));
+    std::ostringstream first;
+    reporter.WriteUidInfoListToExtraData(allVec, first);
+    EXPECT_NE(first.str().find("saName:GoneApp"), std::string::npos);
+
+    allVec.sysSaVec[0].size += 5 * mb;
+    allVec.sysAppVec[0].size += 20 * mb;
+    allVec.userAppVec.pop_back();
+    allVec.otherAppVec.push_back(UidSaInfo(4004, "NewApp", mb, 400));
+    std::ostringstream second;
+    reporter.WriteUidInfoListToExtraData(allVec, second);
+    std::string output = second.str();
+    EXPECT_EQ(output.find("saName:SysSa"), std::string::npos);
+    EXPECT_NE(output.find("{uid:2002,saName:SysApp,size:120.00MB, iNodes:200,delta:+20.00MB}"), std::string::npos);
+    EXPECT_EQ(output.find("saName:UserApp"), std::string::npos);
+    EXPECT_NE(output.find("{uid:3004,removed}"), std::string::npos);
+    EXPECT_NE(output.find("saName:NewApp"), std::string::npos);
+
+    // Changes below the threshold add up until they are reported.
+    allVec.sysSaVec[0].size += 6 * mb;
+    std::ostringstream third;
+    reporter.WriteUidInfoListToExtraData(allVec, third);
+    EXPECT_NE(third.str().find("{uid:1001,saName:SysSa,size:111.00MB, iNodes:100,delta:+11.00MB}"),
+        std::string::npos);
+    EXPECT_EQ(third.str().find("saName:SysApp"), std::string::npos);
+    EXPECT_EQ(reporter.uidSnapshot_.Count(), 4U);
+    GTEST_LOG_(INFO) << "Storage_Service_StorageDfxReporterTest_WriteUidInfoListToExtraData_002 end";
+}
+
+/**
+ * @tc.name: Storage_Service_StorageDfxReporterTest_WriteUidInfoListToExtraData_003
+ * @tc.desc: Verify a full report lists every uid and leaves the baseline of the routine report alone.
+ * @tc.type: FUNC
+ * @tc.require: AR000XXXX
+ */
+HWTEST_F(StorageDfxReporterTest, Storage_Service_StorageDfxReporterTest_WriteUidInfoListToExtraData_003,
+    TestSize.Level1)
+{
+    GTEST_LOG_(INFO) << "Storage_Service_StorageDfxReporterTest_WriteUidInfoListToExtraData_003 start";
+    auto &reporter = StorageDfxReporter::GetInstance();
+    const int64_t mb = 1000 * 1000;
+    AllAppVec allVec;
+    allVec.sysSaVec.push_back(UidSaInfo(1001, "SysSa", 100 * mb, 100));
+    allVec.userAppVec.push_back(UidSaInfo(3003, "UserApp", 100 * mb, 300));
+    std::ostringstream routine;
+    reporter.WriteUidInfoListToExtraData(allVec, routine);
+    ASSERT_EQ(reporter.uidSnapshot_.Count(), 2U);
+
+    allVec.sysSaVec[0].size += 20 * mb;
+    std::ostringstream full;
+    reporter.WriteUidInfoListToExtraData(allVec, full, true);
+    EXPECT_NE(full.str().find("saName:SysSa"), std::string::npos);
+    EXPECT_NE(full.str().find("saName:UserApp"), std::string::npos);
+    uint64_t key = StorageReportSnapshot::MakeKey(SnapshotKind::SA, 1001);
+    ASSERT_NE(reporter.uidSnapshot_.Find(key), nullptr);
+    EXPECT_EQ(reporter.uidSnapshot_.Find(key)->size, 100 * mb);
+
+    std::ostringstream next;
+    reporter.WriteUidInfoListToExtraData(allVec, next);
+    EXPECT_NE(next.str().find("{uid:1001,saName:SysSa,size:120.00MB, iNodes:100,delta:+20.00MB}"), std::string::npos);
+    EXPECT_EQ(next.str().find("saName:UserApp"), std::string::npos);
+    GTEST_LOG_(INFO) << "Storage_Service_StorageDfxReporterTest_WriteUidInfoListToExtraData_003 end";
+}
+
 /**
  * @tc.name: Storage_Service_StorageDfxReporterTest_CorrectSaFromWhiteList_001
  * @tc.desc: Verify the CorrectSaFromWhiteList function with empty vector.
@@ -1042,7 +1122,7 @@ HWTEST_F(StorageDfxReporterTest, Storage_Service_StorageDfxReporterTest_CloneEve
     EXPECT_CALL(*sdc, GetDataSizeByPath(_, _)).WillRepeatedly(DoAll(SetArgReferee<1>(100), Return(0)));
     EXPECT_CALL(*sdc, GetRmgResourceSize(_, _)).WillRepeatedly(DoAll(SetArgReferee<1>(50), Return(0)));
     EXPECT_CALL(*sss, GetBundleNameAndUid(_, _)).WillRepeatedly(Return(0));
-    EXPECT_CALL(*sdc, QueryOccupiedSpaceForSa(_, _, _, _)).WillRepeatedly(Return(0));
+    EXPECT_CALL(*sdc, QueryOccupiedSpaceForAll(_, _, _, _)).WillRepeatedly(Return(0));
     StorageDfxReporter::GetInstance().CloneEventReportStorageStatus();
     EXPECT_EQ(StorageDfxReporter::GetInstance().eventReportTimes_.load(), 1);
     std::this_thread::sleep_for(std::chrono::milliseconds(200));
@@ -1072,7 +1152,7 @@ HWTEST_F(StorageDfxReporterTest, Storage_Service_StorageDfxReporterTest_CloneEve
     EXPECT_CALL(*sdc, GetDataSizeByPath(_, _)).WillRepeatedly(DoAll(SetArgReferee<1>(100), Return(0)));
     EXPECT_CALL(*sdc, GetRmgResourceSize(_, _)).WillRepeatedly(DoAll(SetArgReferee<1>(50), Return(0)));
     EXPECT_CALL(*sss, GetBundleNameAndUid(_, _)).WillRepeatedly(Return(0));
-    EXPECT_CALL(*sdc, QueryOccupiedSpaceForSa(_, _, _, _)).WillRepeatedly(Return(0));
+    EXPECT_CALL(*sdc, QueryOccupiedSpaceForAll(_, _, _, _)).WillRepeatedly(Return(0));
     StorageDfxReporter::GetInstance().CloneEventReportStorageStatus();
     EXPECT_EQ(StorageDfxReporter::GetInstance().eventReportTimes_.load(), 2);
     std::this_thread::sleep_for(std::chrono::milliseconds(200));
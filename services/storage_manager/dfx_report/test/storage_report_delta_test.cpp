@@ -0,0 +1,240 @@
+/*
+ * Copyright (c) 2026 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+#include "dfx_report/storage_report_delta.h"
+
+namespace OHOS {
+namespace StorageManager {
+using namespace testing::ext;
+
+constexpr int64_t TEST_THRESHOLD = 100;
+
+class StorageReportDeltaTest : public testing::Test {
+public:
+    static void SetUpTestCase() {};
+    static void TearDownTestCase() {};
+    void SetUp() {};
+    void TearDown() {};
+};
+
+static StorageReportSnapshot BuildSnapshot(const std::vector<SnapshotEntry> &entries)
+{
+    StorageReportSnapshot empty;
+    SnapshotDelta delta(empty, TEST_THRESHOLD);
+    int64_t change = 0;
+    for (const auto &entry : entries) {
+        if (delta.Visit(entry.key, entry.size, change)) {
+            delta.Commit(entry.key, entry.size);
+        }
+    }
+    return delta.Finish(nullptr);
+}
+
+/**
+ * @tc.name: StorageReportDeltaTest_Visit_001
+ * @tc.desc: Verify only new, removed and changed entries are reported against the previous snapshot.
+ * @tc.type: FUNC
+ * @tc.require: AR000XXXX
+ */
+HWTEST_F(StorageReportDeltaTest, StorageReportDeltaTest_Visit_001, TestSize.Level1)
+{
+    GTEST_LOG_(INFO) << "StorageReportDeltaTest_Visit_001 start";
+    uint64_t same = StorageReportSnapshot::MakeKey(SnapshotKind::SA, 1001);
+    uint64_t grown = StorageReportSnapshot::MakeKey(SnapshotKind::SYS_APP, 1001);
+    uint64_t gone = StorageReportSnapshot::MakeKey(SnapshotKind::USER_APP, 20010001);
+    uint64_t added = StorageReportSnapshot::MakeKey(SnapshotKind::USER_APP, 20010002);
+    StorageReportSnapshot prev = BuildSnapshot({ { gone, 500 }, { grown, 1000 }, { same, 1000 } });
+    ASSERT_EQ(prev.Count(), 3U);
+
+    SnapshotDelta delta(prev, TEST_THRESHOLD);
+    int64_t change = 0;
+    EXPECT_FALSE(delta.Visit(same, 1000 + TEST_THRESHOLD, change));
+    EXPECT_EQ(change, TEST_THRESHOLD);
+    EXPECT_TRUE(delta.Visit(grown, 2000, change));
+    EXPECT_EQ(change, 1000);
+    delta.Commit(grown, 2000);
+    EXPECT_TRUE(delta.Visit(added, 10, change));
+    EXPECT_EQ(change, 10);
+    delta.Commit(added, 10);
+    std::vector<uint64_t> removed;
+    StorageReportSnapshot next = delta.Finish([&removed](const SnapshotEntry &entry) {
+        removed.push_back(entry.key);
+        return true;
+    });
+    ASSERT_EQ(removed.size(), 1U);
+    EXPECT_EQ(removed[0], gone);
+    EXPECT_EQ(StorageReportSnapshot::KindOf(gone), SnapshotKind::USER_APP);
+    EXPECT_EQ(StorageReportSnapshot::IdOf(gone), 20010001U);
+
+    ASSERT_EQ(next.Count(), 3U);
+    ASSERT_NE(next.Find(same), nullptr);
+    EXPECT_EQ(next.Find(same)->size, 1000);
+    ASSERT_NE(next.Find(grown), nullptr);
+    EXPECT_EQ(next.Find(grown)->size, 2000);
+    EXPECT_EQ(next.Find(gone), nullptr);
+    EXPECT_NE(next.Find(added), nullptr);
+    GTEST_LOG_(INFO) << "StorageReportDeltaTest_Visit_001 end";
+}
+
+/**
+ * @tc.name: StorageReportDeltaTest_Visit_002
+ * @tc.desc: Verify changes below the threshold add up until the entry is reported.
+ * @tc.type: FUNC
+ * @tc.require: AR000XXXX
+ */
+HWTEST_F(StorageReportDeltaTest, StorageReportDeltaTest_Visit_002, TestSize.Level1)
+{
+    GTEST_LOG_(INFO) << "StorageReportDeltaTest_Visit_002 start";
+    uint64_t key = StorageReportSnapshot::PathKey("/data/app/el2/100/base");
+    StorageReportSnapshot snapshot = BuildSnapshot({ { key, 1000 } });
+    int64_t size = 1000;
+    int64_t change = 0;
+    int32_t reported = 0;
+    const int32_t rounds = 5;
+    for (int32_t i = 0; i < rounds; i++) {
+        size -= TEST_THRESHOLD / 2 + 1;
+        SnapshotDelta delta(snapshot, TEST_THRESHOLD);
+        if (delta.Visit(key, size, change)) {
+            reported++;
+            EXPECT_LT(change, -TEST_THRESHOLD);
+            delta.Commit(key, size);
+        }
+        snapshot = delta.Finish(nullptr);
+    }
+    EXPECT_EQ(reported, 2);
+    EXPECT_NE(StorageReportSnapshot::PathKey("/data/app/el2/100/base"),
+        StorageReportSnapshot::PathKey("/data/app/el2/101/base"));
+    EXPECT_EQ(StorageReportSnapshot::KindOf(key), SnapshotKind::DIR);
+    GTEST_LOG_(INFO) << "StorageReportDeltaTest_Visit_002 end";
+}
+
+/**
+ * @tc.name: StorageReportDeltaTest_Finish_001
+ * @tc.desc: Verify a null callback keeps the unvisited entries and a repeated key is kept once.
+ * @tc.type: FUNC
+ * @tc.require: AR000XXXX
+ */
+HWTEST_F(StorageReportDeltaTest, StorageReportDeltaTest_Finish_001, TestSize.Level1)
+{
+    GTEST_LOG_(INFO) << "StorageReportDeltaTest_Finish_001 start";
+    uint64_t keyA = StorageReportSnapshot::MakeKey(SnapshotKind::SA, 1);
+    uint64_t keyB = StorageReportSnapshot::MakeKey(SnapshotKind::SA, 2);
+    StorageReportSnapshot prev = BuildSnapshot({ { keyA, 1 }, { keyB, 2 } });
+    SnapshotDelta delta(prev, TEST_THRESHOLD);
+    int64_t change = 0;
+    EXPECT_TRUE(delta.Visit(keyA, 1000, change));
+    delta.Commit(keyA, 1000);
+    EXPECT_TRUE(delta.Visit(keyA, 2000, change));
+    delta.Commit(keyA, 2000);
+    StorageReportSnapshot next = delta.Finish(nullptr);
+    ASSERT_EQ(next.Count(), 2U);
+    EXPECT_EQ(next.Entries()[0].key, keyA);
+    EXPECT_EQ(next.Entries()[0].size, 1000);
+    EXPECT_EQ(next.Entries()[1].key, keyB);
+    EXPECT_EQ(next.Entries()[1].size, 2);
+    GTEST_LOG_(INFO) << "StorageReportDeltaTest_Finish_001 end";
+}
+
+/**
+ * @tc.name: StorageReportDeltaTest_Commit_001
+ * @tc.desc: Verify an entry that was not written keeps its last reported size and a removal that was not
+ *           written keeps the entry, so both are reported again next time.
+ * @tc.type: FUNC
+ * @tc.require: AR000XXXX
+ */
+HWTEST_F(StorageReportDeltaTest, StorageReportDeltaTest_Commit_001, TestSize.Level1)
+{
+    GTEST_LOG_(INFO) << "StorageReportDeltaTest_Commit_001 start";
+    uint64_t grown = StorageReportSnapshot::MakeKey(SnapshotKind::SA, 1);
+    uint64_t added = StorageReportSnapshot::MakeKey(SnapshotKind::SA, 2);
+    uint64_t gone = StorageReportSnapshot::MakeKey(SnapshotKind::SA, 3);
+    StorageReportSnapshot prev = BuildSnapshot({ { grown, 1000 }, { gone, 1000 } });
+    SnapshotDelta delta(prev, TEST_THRESHOLD);
+    int64_t change = 0;
+    EXPECT_TRUE(delta.Visit(grown, 2000, change));
+    EXPECT_TRUE(delta.Visit(added, 10, change));
+    StorageReportSnapshot next = delta.Finish([](const SnapshotEntry &) { return false; });
+    ASSERT_EQ(next.Count(), 2U);
+    ASSERT_NE(next.Find(grown), nullptr);
+    EXPECT_EQ(next.Find(grown)->size, 1000);
+    EXPECT_EQ(next.Find(added), nullptr);
+    EXPECT_NE(next.Find(gone), nullptr);
+
+    SnapshotDelta retry(next, TEST_THRESHOLD);
+    EXPECT_TRUE(retry.Visit(grown, 2000, change));
+    EXPECT_EQ(change, 1000);
+    EXPECT_TRUE(retry.Visit(added, 10, change));
+    EXPECT_EQ(change, 10);
+    GTEST_LOG_(INFO) << "StorageReportDeltaTest_Commit_001 end";
+}
+
+/**
+ * @tc.name: StorageReportDeltaTest_Arena_001
+ * @tc.desc: Verify the arena never grows past its capacity and counts the entries it drops.
+ * @tc.type: FUNC
+ * @tc.require: AR000XXXX
+ */
+HWTEST_F(StorageReportDeltaTest, StorageReportDeltaTest_Arena_001, TestSize.Level1)
+{
+    GTEST_LOG_(INFO) << "StorageReportDeltaTest_Arena_001 start";
+    const size_t capacity = 64;
+    ReportArena arena(capacity);
+    EXPECT_EQ(arena.Capacity(), capacity);
+    EXPECT_EQ(std::string(arena.Data()), "");
+    const int32_t appends = 20;
+    for (int32_t i = 0; i < appends; i++) {
+        arena.Append("{uid:%d,size:%.2fMB}\n", 20010000 + i, 1.5);
+    }
+    std::string text(arena.Data(), arena.Size());
+    EXPECT_LE(arena.Size(), capacity);
+    EXPECT_GT(arena.Dropped(), 0U);
+    EXPECT_EQ(text.size(), arena.Size());
+    EXPECT_EQ(text.back(), '\n');
+    EXPECT_EQ(text.find("{uid:20010000,size:1.50MB}\n"), 0U);
+    EXPECT_EQ(text.find("20010019"), std::string::npos);
+    EXPECT_TRUE(arena.Append("%s", ""));
+    GTEST_LOG_(INFO) << "StorageReportDeltaTest_Arena_001 end";
+}
+
+/**
+ * @tc.name: StorageReportDeltaTest_MemoryBytes_001
+ * @tc.desc: Verify a snapshot holds 16 bytes per tracked entry.
+ * @tc.type: FUNC
+ * @tc.require: AR000XXXX
+ */
+HWTEST_F(StorageReportDeltaTest, StorageReportDeltaTest_MemoryBytes_001, TestSize.Level1)
+{
+    GTEST_LOG_(INFO) << "StorageReportDeltaTest_MemoryBytes_001 start";
+    const uint64_t count = 1000;
+    std::vector<SnapshotEntry> entries;
+    for (uint64_t i = 0; i < count; i++) {
+        entries.push_back({ StorageReportSnapshot::MakeKey(SnapshotKind::USER_APP, i), 1 });
+    }
+    StorageReportSnapshot snapshot = BuildSnapshot(entries);
+    EXPECT_EQ(sizeof(SnapshotEntry), 16U);
+    EXPECT_EQ(snapshot.Count(), count);
+    EXPECT_GE(snapshot.MemoryBytes(), count * sizeof(SnapshotEntry));
+    EXPECT_LE(snapshot.MemoryBytes(), 2 * count * sizeof(SnapshotEntry));
+    snapshot.Clear();
+    EXPECT_EQ(snapshot.Count(), 0U);
+    EXPECT_EQ(snapshot.MemoryBytes(), 0U);
+    GTEST_LOG_(INFO) << "StorageReportDeltaTest_MemoryBytes_001 end";
+}
+} // namespace StorageManager
+} // namespace OHOS
@@ -23,6 +23,7 @@
 #include <map>
 #include <thread>
 #include <atomic>
+#include "dfx_report/storage_report_delta.h"
 #include "storage_stats.h"
 #include "statistic_info.h"
 
@@ -42,6 +43,8 @@ public:
     void CloneEventReportStorageStatus();
 
     int32_t StartReportDirStatus();
+    // Entries whose size moved by at most this many bytes since they were last reported are left out.
+    void SetReportDeltaThreshold(int64_t bytes);
     // Scan control methods
     void StartScan();
     void StopScan();
@@ -56,9 +59,11 @@ private:
     void ExecuteHapAndSaStatistics(int32_t userId);
     int32_t CollectStorageStats(int32_t userId, std::ostringstream &extraData);
     void CollectMetadataAndAnco(std::ostringstream &extraData);
-    int32_t CollectBundleStatistics(int32_t userId, std::ostringstream &extraData);
-    void WriteExtraData(const std::vector<UidSaInfo> &vec, std::ostringstream &extraData);
-    void WriteUidInfoListToExtraData(AllAppVec &allVec, std::ostringstream &extraData);
+    int32_t CollectBundleStatistics(int32_t userId, std::ostringstream &extraData, bool fullReport = false);
+    void WriteExtraData(SnapshotDelta &delta, SnapshotKind kind, const std::vector<UidSaInfo> &vec,
+                        ReportArena &arena);
+    void WriteUidInfoListToExtraData(AllAppVec &allVec, std::ostringstream &extraData, bool fullReport = false);
+    void AppendArena(const ReportArena &arena, std::ostringstream &extraData);
     double ConvertBytesToMB(int64_t bytes, int32_t decimalPlaces);
 
     int32_t GetStorageStatsInfo(int32_t userId, StorageStats &storageStats);
@@ -68,6 +73,13 @@ private:
     std::atomic<bool> isHapAndSaRunning_{false};
     std::atomic<int32_t> eventReportTimes_ = 0;
     std::atomic<bool> isCloneStorageRuning_{false};
+    std::atomic<int64_t> deltaThreshold_{REPORT_DELTA_THRESHOLD};
+    // Sizes as last reported; the uid one is used by the routine statistics report only, the dir one by the
+    // scan task. They live in memory, so the first report after the service starts lists every entry.
+    // Entries are written as {uid:..,saName:..,size:%.2fMB, iNodes:..,delta:%+.2fMB} and
+    // {path:..,uid:..,size:%.2fMB,delta:%+.2fMB}; a uid gone since the last report is {uid:..,removed}.
+    StorageReportSnapshot uidSnapshot_;
+    StorageReportSnapshot dirSnapshot_;
 
     int32_t CheckSystemUidSize(const std::vector<NextDqBlk> &dqBlks, int64_t &totalSize,
                                int64_t &rootSize, int64_t &systemSize, int64_t &foundationSize);
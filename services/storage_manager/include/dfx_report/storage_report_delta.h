@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2026 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef OHOS_STORAGE_MANAGER_STORAGE_REPORT_DELTA_H
+#define OHOS_STORAGE_MANAGER_STORAGE_REPORT_DELTA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace OHOS {
+namespace StorageManager {
+constexpr size_t REPORT_ARENA_SIZE = 32 * 1024;
+constexpr int64_t REPORT_DELTA_THRESHOLD = 10LL * 1000 * 1000;
+
+enum class SnapshotKind : uint8_t {
+    SA = 1,
+    SYS_APP,
+    USER_APP,
+    OTHER_APP,
+    DIR,
+};
+
+// One sized entry of a report; the kind sits in the top byte of the key.
+struct SnapshotEntry {
+    uint64_t key;
+    int64_t size;
+};
+
+/*
+ * Text buffer of a fixed capacity, allocated once. An append that does not fit is dropped whole and
+ * counted, so a report never grows past the capacity however many entries it has.
+ */
+class ReportArena {
+public:
+    explicit ReportArena(size_t capacity = REPORT_ARENA_SIZE);
+    ReportArena(const ReportArena &) = delete;
+    ReportArena &operator=(const ReportArena &) = delete;
+
+    bool Append(const char *format, ...) __attribute__((format(printf, 2, 3)));
+    const char *Data() const
+    {
+        return buf_.get();
+    }
+    size_t Size() const
+    {
+        return used_;
+    }
+    size_t Capacity() const
+    {
+        return capacity_;
+    }
+    uint32_t Dropped() const
+    {
+        return dropped_;
+    }
+
+private:
+    std::unique_ptr<char[]> buf_;
+    size_t capacity_;
+    size_t used_ = 0;
+    uint32_t dropped_ = 0;
+};
+
+// The sizes of the last report, sorted by key: 16 bytes per entry and no names.
+class StorageReportSnapshot {
+public:
+    static uint64_t MakeKey(SnapshotKind kind, uint64_t id);
+    static uint64_t PathKey(const std::string &path);
+    static SnapshotKind KindOf(uint64_t key);
+    static uint64_t IdOf(uint64_t key);
+
+    const SnapshotEntry *Find(uint64_t key) const;
+    const std::vector<SnapshotEntry> &Entries() const
+    {
+        return entries_;
+    }
+    size_t Count() const
+    {
+        return entries_.size();
+    }
+    size_t MemoryBytes() const
+    {
+        return entries_.capacity() * sizeof(SnapshotEntry);
+    }
+    void Clear()
+    {
+        std::vector<SnapshotEntry>().swap(entries_);
+    }
+
+private:
+    friend class SnapshotDelta;
+    std::vector<SnapshotEntry> entries_;
+};
+
+/*
+ * Compares the entries of a new report with the previous snapshot. An entry is reported when it is
+ * new or has moved by more than the threshold since it was last reported; the snapshot keeps the
+ * reported size, so small changes add up until they are reported. Only what the caller has actually
+ * written moves the snapshot: an entry it failed to write is compared with the old size again next time.
+ */
+class SnapshotDelta {
+public:
+    SnapshotDelta(const StorageReportSnapshot &prev, int64_t threshold);
+
+    // True when the entry is to be reported; delta is the change since it was last reported.
+    bool Visit(uint64_t key, int64_t size, int64_t &delta);
+    // Records the size of the entry just visited once it has been written.
+    void Commit(uint64_t key, int64_t size);
+    // Entries of the previous snapshot that were not visited are passed to removed, and dropped when it
+    // returns true; they are kept as they are when it returns false or is null. Returns the snapshot
+    // for the next report.
+    StorageReportSnapshot Finish(const std::function<bool(const SnapshotEntry &entry)> &removed);
+
+private:
+    const StorageReportSnapshot &prev_;
+    int64_t threshold_;
+    std::vector<bool> visited_;
+    std::vector<SnapshotEntry> next_;
+};
+} // namespace StorageManager
+} // namespace OHOS
+
+#endif // OHOS_STORAGE_MANAGER_STORAGE_REPORT_DELTA_H
@@ -114,6 +114,7 @@ public:
     virtual int32_t GetAncoSizeData(std::string &outExtraData) override;
 
     virtual int32_t GetDataSizeByPath(const std::string &path, int64_t &size) override;
+    virtual int32_t GetDataSizeByPaths(const std::vector<std::string> &paths, std::vector<int64_t> &sizes) override;
     virtual int32_t GetRmgResourceSize(const std::string &rgmName, uint64_t &totalSize) override;
     virtual int32_t GetSystemDataSize(int64_t &otherUidSizeSum) override;
     virtual int32_t GetDirListSpaceByPaths(const std::vector<std::string> &paths,
@@ -171,6 +172,9 @@ public:
     virtual int32_t GetDiskSize(const std::string &devName, uint64_t &size) override;
     virtual int32_t BindBlockLoopDev(const std::string &sysPath, uint64_t offset, uint64_t sizeLimit,
                                      std::string &loopPath) override;
+    virtual int32_t QueryOccupiedSpaceForAll(std::vector<UidSaInfo> &sysSaVec, std::vector<UidSaInfo> &sysAppVec,
+        std::vector<UidSaInfo> &userAppVec, std::vector<UidSaInfo> &otherAppVec, int64_t &saTotalSize,
+        int64_t &otherTotalSize, const std::map<int32_t, std::string> &bundleNameAndUid) override;
 private:
     static inline BrokerDelegator<StorageDaemonProxy> delegator_;
     int32_t SendRequest(uint32_t code, MessageParcel &data, MessageParcel &reply, MessageOption &option);
@@ -16,6 +16,8 @@
 #ifndef OHOS_STORAGE_MANAGER_STORAGE_DAEMON_COMMUNICATION_H
 #define OHOS_STORAGE_MANAGER_STORAGE_DAEMON_COMMUNICATION_H
 
+#include <memory>
+#include <mutex>
 #include <nocopyable.h>
 #include "istorage_daemon.h"
 #include "iuece_activation_callback.h"
@@ -107,6 +109,8 @@ public:
     int32_t InactiveUserPublicDirKey(uint32_t userId);
     int32_t QueryOccupiedSpaceForSa(std::vector<UidSaInfo> &vec, int64_t &totalSize,
         const std::map<int32_t, std::string> &bundleNameAndUid, int32_t type);
+    int32_t QueryOccupiedSpaceForAll(AllAppVec &allVec, int64_t &saTotalSize, int64_t &otherTotalSize,
+        const std::map<int32_t, std::string> &bundleNameAndUid);
 
     // el5 filekey manager
     int32_t RegisterUeceActivationCallback(const sptr<IUeceActivationCallback> &ueceCallback);
@@ -126,6 +130,8 @@ public:
 
     // stats api
     int32_t GetDataSizeByPath(const std::string &path, int64_t &size);
+    // sizes[i] is -1 when paths[i] could not be read
+    int32_t GetDataSizeByPaths(const std::vector<std::string> &paths, std::vector<int64_t> &sizes);
     int32_t GetRmgResourceSize(const std::string &rgmName, uint64_t &totalSize);
     int32_t GetSystemDataSize(int64_t &otherUidSizeSum);
 
@@ -135,7 +141,9 @@ private:
     StorageDaemonCommunication();
     ~StorageDaemonCommunication();
     sptr<OHOS::StorageDaemon::IStorageDaemon> GetStorageDaemon();
-    sptr<OHOS::StorageDaemon::IStorageDaemon> storageDaemon_;
+    // published with atomic_store so the steady-state Connect/GetStorageDaemon path takes no lock;
+    // mutex_ only serializes the slow reconnect and the reset from the death recipient
+    std::shared_ptr<const sptr<OHOS::StorageDaemon::IStorageDaemon>> cachedProxy_;
     sptr<IRemoteObject::DeathRecipient> deathRecipient_ = nullptr;
     std::mutex mutex_;
 };
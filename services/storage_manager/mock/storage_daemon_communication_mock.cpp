@@ -14,6 +14,7 @@
  */
 
 #include "mock/storage_daemon_communication_mock.h"
+#include "storage_service_errno.h"
 
 namespace OHOS {
 namespace StorageManager {
@@ -51,6 +52,23 @@ int32_t StorageDaemonCommunication::GetDataSizeByPath(const std::string &path, i
     return StorageDaemonCommunicationMock::storageDaemonCommunication->GetDataSizeByPath(path, size);
 }
 
+int32_t StorageDaemonCommunication::GetDataSizeByPaths(const std::vector<std::string> &paths,
+    std::vector<int64_t> &sizes)
+{
+    int32_t ret = E_OK;
+    sizes.assign(paths.size(), -1);
+    for (size_t i = 0; i < paths.size(); i++) {
+        int64_t size = 0;
+        int32_t err = StorageDaemonCommunicationMock::storageDaemonCommunication->GetDataSizeByPath(paths[i], size);
+        if (err != E_OK) {
+            ret = (ret == E_OK) ? err : ret;
+            continue;
+        }
+        sizes[i] = size;
+    }
+    return ret;
+}
+
 int32_t StorageDaemonCommunication::GetRmgResourceSize(const std::string &rgmName, uint64_t &totalSize)
 {
     return StorageDaemonCommunicationMock::storageDaemonCommunication->GetRmgResourceSize(rgmName, totalSize);
@@ -63,6 +81,13 @@ int32_t StorageDaemonCommunication::QueryOccupiedSpaceForSa(std::vector<UidSaInf
         bundleNameAndUid, type);
 }
 
+int32_t StorageDaemonCommunication::QueryOccupiedSpaceForAll(AllAppVec &allVec, int64_t &saTotalSize,
+    int64_t &otherTotalSize, const std::map<int32_t, std::string> &bundleNameAndUid)
+{
+    return StorageDaemonCommunicationMock::storageDaemonCommunication->QueryOccupiedSpaceForAll(allVec,
+        saTotalSize, otherTotalSize, bundleNameAndUid);
+}
+
 int32_t StorageDaemonCommunication::GetSystemDataSize(int64_t &otherUidSizeSum)
 {
     return StorageDaemonCommunicationMock::storageDaemonCommunication->GetSystemDataSize(otherUidSizeSum);
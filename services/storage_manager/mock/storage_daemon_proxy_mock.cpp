@@ -320,6 +320,12 @@ int32_t StorageDaemonProxy::GetDataSizeByPath(const std::string &path, int64_t &
     return E_OK;
 }
 
+int32_t StorageDaemonProxy::GetDataSizeByPaths(const std::vector<std::string> &paths, std::vector<int64_t> &sizes)
+{
+    sizes.assign(paths.size(), 0);
+    return E_OK;
+}
+
 int32_t StorageDaemonProxy::GetRmgResourceSize(const std::string &rgmName, uint64_t &totalSize)
 {
     return E_OK;
@@ -502,5 +508,12 @@ int32_t StorageDaemonProxy::BindBlockLoopDev(const std::string &sysPath, uint64_
 {
     return E_OK;
 }
+
+int32_t StorageDaemonProxy::QueryOccupiedSpaceForAll(std::vector<UidSaInfo> &sysSaVec,
+    std::vector<UidSaInfo> &sysAppVec, std::vector<UidSaInfo> &userAppVec, std::vector<UidSaInfo> &otherAppVec,
+    int64_t &saTotalSize, int64_t &otherTotalSize, const std::map<int32_t, std::string> &bundleNameAndUid)
+{
+    return E_OK;
+}
 } // StorageDaemon
 } // namespace OHOS
@@ -622,19 +622,20 @@ int32_t StorageStatusManager::GetMetaDataSize(int64_t &metaDataSize)
 {
     metaDataSize = 0;
     auto& sdCommunication = StorageDaemonCommunication::GetInstance();
-    std::string blkPath = std::string(HMFS_PATH) + std::string(MAIN_BLKADDR);
-    int64_t blkSize = -1;
-    int32_t ret = sdCommunication.GetDataSizeByPath(blkPath, blkSize);
-    if (ret != E_OK || blkSize < 0) {
-        LOGE("StorageStatusManager::GetMetaDataSize: GetDataSizeByPath blkPath failed, ret=%{public}d", ret);
-        return ret;
-    }
-
-    std::string chunkPath = std::string(HMFS_PATH) + std::string(OVP_CHUNKS);
-    int64_t chunkSize = -1;
-    ret = sdCommunication.GetDataSizeByPath(chunkPath, chunkSize);
-    if (ret != E_OK || chunkSize < 0) {
-        LOGE("StorageStatusManager::GetMetaDataSize: GetDataSizeByPath chunkPath failed, ret=%{public}d", ret);
+    std::vector<std::string> paths = { std::string(HMFS_PATH) + std::string(MAIN_BLKADDR),
+        std::string(HMFS_PATH) + std::string(OVP_CHUNKS) };
+    std::vector<int64_t> sizes;
+    int32_t ret = sdCommunication.GetDataSizeByPaths(paths, sizes);
+    if (sizes.size() != paths.size()) {
+        LOGE("StorageStatusManager::GetMetaDataSize: GetDataSizeByPaths failed, ret=%{public}d", ret);
+        return ret != E_OK ? ret : E_ERR;
+    }
+    int64_t blkSize = sizes[0];
+    int64_t chunkSize = sizes[1];
+    if (ret != E_OK || blkSize < 0 || chunkSize < 0) {
+        LOGE("StorageStatusManager::GetMetaDataSize: GetDataSizeByPaths failed, ret=%{public}d, "
+            "blkSize=%{public}lld, chunkSize=%{public}lld", ret, static_cast<long long>(blkSize),
+            static_cast<long long>(chunkSize));
         return ret;
     }
 
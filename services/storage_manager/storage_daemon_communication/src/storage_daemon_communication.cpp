@@ -33,7 +33,6 @@ namespace StorageManager {
 StorageDaemonCommunication::StorageDaemonCommunication()
 {
     LOGI("DEBUG StorageDaemonCommunication constructer");
-    storageDaemon_ = nullptr;
 }
 
 StorageDaemonCommunication::~StorageDaemonCommunication()
@@ -44,8 +43,11 @@ StorageDaemonCommunication::~StorageDaemonCommunication()
 int32_t StorageDaemonCommunication::Connect()
 {
     LOGD("StorageDaemonCommunication::Connect start");
+    if (std::atomic_load_explicit(&cachedProxy_, std::memory_order_acquire) != nullptr) {
+        return E_OK;
+    }
     std::lock_guard<std::mutex> lock(mutex_);
-    if (storageDaemon_ == nullptr) {
+    if (std::atomic_load_explicit(&cachedProxy_, std::memory_order_acquire) == nullptr) {
         auto sam = SystemAbilityManagerClient::GetInstance().GetSystemAbilityManager();
         if (sam == nullptr) {
             LOGE("StorageDaemonCommunication::Connect samgr nullptr");
@@ -56,8 +58,8 @@ int32_t StorageDaemonCommunication::Connect()
             LOGE("StorageDaemonCommunication::Connect object nullptr");
             return E_REMOTE_IS_NULLPTR;
         }
-        storageDaemon_ = iface_cast<OHOS::StorageDaemon::IStorageDaemon>(object);
-        if (storageDaemon_ == nullptr) {
+        auto storageDaemon = iface_cast<OHOS::StorageDaemon::IStorageDaemon>(object);
+        if (storageDaemon == nullptr) {
             LOGE("StorageDaemonCommunication::Connect service nullptr");
             return E_SERVICE_IS_NULLPTR;
         }
@@ -67,7 +69,9 @@ int32_t StorageDaemonCommunication::Connect()
             return E_DEATH_RECIPIENT_IS_NULLPTR;
         }
 
-        storageDaemon_->AsObject()->AddDeathRecipient(deathRecipient_);
+        storageDaemon->AsObject()->AddDeathRecipient(deathRecipient_);
+        auto cachedProxy = std::make_shared<const sptr<OHOS::StorageDaemon::IStorageDaemon>>(storageDaemon);
+        std::atomic_store_explicit(&cachedProxy_, cachedProxy, std::memory_order_release);
     }
     LOGD("StorageDaemonCommunication::Connect end");
     return E_OK;
@@ -75,8 +79,11 @@ int32_t StorageDaemonCommunication::Connect()
 
 sptr<OHOS::StorageDaemon::IStorageDaemon> StorageDaemonCommunication::GetStorageDaemon()
 {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return storageDaemon_;
+    auto cachedProxy = std::atomic_load_explicit(&cachedProxy_, std::memory_order_acquire);
+    if (cachedProxy == nullptr) {
+        return nullptr;
+    }
+    return *cachedProxy;
 }
 
 int32_t StorageDaemonCommunication::PrepareAddUser(int32_t userId, uint32_t flags)
@@ -380,10 +387,12 @@ int32_t StorageDaemonCommunication::ResetSdProxy()
 {
     LOGI("enter");
     std::lock_guard<std::mutex> lock(mutex_);
-    if ((storageDaemon_ != nullptr) && (storageDaemon_->AsObject() != nullptr)) {
-        storageDaemon_->AsObject()->RemoveDeathRecipient(deathRecipient_);
+    auto cachedProxy = std::atomic_load_explicit(&cachedProxy_, std::memory_order_acquire);
+    if ((cachedProxy != nullptr) && (*cachedProxy != nullptr) && ((*cachedProxy)->AsObject() != nullptr)) {
+        (*cachedProxy)->AsObject()->RemoveDeathRecipient(deathRecipient_);
     }
-    storageDaemon_ = nullptr;
+    std::atomic_store_explicit(&cachedProxy_,
+        std::shared_ptr<const sptr<OHOS::StorageDaemon::IStorageDaemon>>(), std::memory_order_release);
 
     return E_OK;
 }
@@ -832,6 +841,23 @@ int32_t StorageDaemonCommunication::QueryOccupiedSpaceForSa(std::vector<UidSaInf
     return proxy->QueryOccupiedSpaceForSa(vec, totalSize, bundleNameAndUid, type);
 }
 
+int32_t StorageDaemonCommunication::QueryOccupiedSpaceForAll(AllAppVec &allVec, int64_t &saTotalSize,
+    int64_t &otherTotalSize, const std::map<int32_t, std::string> &bundleNameAndUid)
+{
+    int32_t err = Connect();
+    if (err != E_OK) {
+        LOGE("Connect failed");
+        return err;
+    }
+    auto proxy = GetStorageDaemon();
+    if (proxy == nullptr) {
+        LOGE("StorageDaemonCommunication::Connect service nullptr");
+        return E_SERVICE_IS_NULLPTR;
+    }
+    return proxy->QueryOccupiedSpaceForAll(allVec.sysSaVec, allVec.sysAppVec, allVec.userAppVec,
+        allVec.otherAppVec, saTotalSize, otherTotalSize, bundleNameAndUid);
+}
+
 int32_t StorageDaemonCommunication::RegisterUeceActivationCallback(
     const sptr<StorageManager::IUeceActivationCallback> &ueceCallback)
 {
@@ -988,6 +1014,22 @@ int32_t StorageDaemonCommunication::GetDataSizeByPath(const std::string &path, i
     return proxy->GetDataSizeByPath(path, size);
 }
 
+int32_t StorageDaemonCommunication::GetDataSizeByPaths(const std::vector<std::string> &paths,
+    std::vector<int64_t> &sizes)
+{
+    int32_t err = Connect();
+    if (err != E_OK) {
+        LOGE("Connect failed");
+        return err;
+    }
+    auto proxy = GetStorageDaemon();
+    if (proxy == nullptr) {
+        LOGE("StorageDaemonCommunication::GetDataSizeByPaths service nullptr");
+        return E_SERVICE_IS_NULLPTR;
+    }
+    return proxy->GetDataSizeByPaths(paths, sizes);
+}
+
 int32_t StorageDaemonCommunication::GetRmgResourceSize(const std::string &rgmName, uint64_t &totalSize)
 {
     int32_t err = Connect();
@@ -945,6 +945,53 @@ HWTEST_F(StorageDaemonCommunicationTest, Daemon_communication_GetDataSizeByPath_
     GTEST_LOG_(INFO) << "StorageDaemonCommunicationTest-end Daemon_communication_GetDataSizeByPath_0000";
 }
 
+/**
+ * @tc.number: SUB_STORAGE_Daemon_communication_GetDataSizeByPaths_0000
+ * @tc.name: Daemon_communication_GetDataSizeByPaths_0000
+ * @tc.desc: Test function of GetDataSizeByPaths interface for SUCCESS.
+ * @tc.size: MEDIUM
+ * @tc.type: FUNC
+ * @tc.level Level 1
+ * @tc.require:
+ */
+HWTEST_F(StorageDaemonCommunicationTest, Daemon_communication_GetDataSizeByPaths_0000, testing::ext::TestSize.Level1)
+{
+    GTEST_LOG_(INFO) << "StorageDaemonCommunicationTest-begin Daemon_communication_GetDataSizeByPaths_0000";
+    auto& sdCommunication = StorageDaemonCommunication::GetInstance();
+
+    std::vector<std::string> paths = {"/data/test/file.txt", "/data/storage_service"};
+    std::vector<int64_t> sizes;
+    int32_t result = sdCommunication.GetDataSizeByPaths(paths, sizes);
+    EXPECT_EQ(result, E_OK);
+    EXPECT_EQ(sizes.size(), paths.size());
+
+    GTEST_LOG_(INFO) << "StorageDaemonCommunicationTest-end Daemon_communication_GetDataSizeByPaths_0000";
+}
+
+/**
+ * @tc.number: SUB_STORAGE_Daemon_communication_ResetSdProxy_002
+ * @tc.name: Daemon_communication_ResetSdProxy_002
+ * @tc.desc: Test that Connect republishes the cached proxy after ResetSdProxy.
+ * @tc.size: MEDIUM
+ * @tc.type: FUNC
+ * @tc.level Level 1
+ * @tc.require:
+ */
+HWTEST_F(StorageDaemonCommunicationTest, Daemon_communication_ResetSdProxy_002, testing::ext::TestSize.Level1)
+{
+    GTEST_LOG_(INFO) << "StorageDaemonCommunicationTest-begin Daemon_communication_ResetSdProxy_002";
+    auto& sdCommunication = StorageDaemonCommunication::GetInstance();
+
+    EXPECT_EQ(sdCommunication.Connect(), E_OK);
+    EXPECT_EQ(sdCommunication.ResetSdProxy(), E_OK);
+    EXPECT_EQ(sdCommunication.Connect(), E_OK);
+    EXPECT_EQ(sdCommunication.Connect(), E_OK);
+    int64_t size = 0;
+    EXPECT_EQ(sdCommunication.GetDataSizeByPath("/data/storage_service", size), E_OK);
+
+    GTEST_LOG_(INFO) << "StorageDaemonCommunicationTest-end Daemon_communication_ResetSdProxy_002";
+}
+
 /**
  * @tc.number: SUB_STORAGE_Daemon_communication_ListUserdataDirInfo_001
  * @tc.name: Daemon_communication_ListUserdataDirInfo_001
@@ -1125,6 +1172,30 @@ HWTEST_F(StorageDaemonCommunicationTest, Daemon_communication_QueryOccupiedSpace
     GTEST_LOG_(INFO) << "StorageDaemonCommunicationTest-end Daemon_communication_QueryOccupiedSpaceForSa_001 SUCCESS";
 }
 
+/**
+ * @tc.number: SUB_STORAGE_Daemon_communication_QueryOccupiedSpaceForAll_001
+ * @tc.name: Daemon_communication_QueryOccupiedSpaceForAll_001
+ * @tc.desc: Test function of QueryOccupiedSpaceForAll interface for SUCCESS.
+ * @tc.size: MEDIUM
+ * @tc.type: FUNC
+ * @tc.level Level 1
+ * @tc.require: issueI9G5A0
+ */
+HWTEST_F(StorageDaemonCommunicationTest, Daemon_communication_QueryOccupiedSpaceForAll_001,
+    testing::ext::TestSize.Level1)
+{
+    GTEST_LOG_(INFO) << "StorageDaemonCommunicationTest-begin Daemon_communication_QueryOccupiedSpaceForAll_001 SUCCESS";
+    auto& sdCommunication = StorageDaemonCommunication::GetInstance();
+    AllAppVec allVec;
+    int64_t saTotalSize = 0;
+    int64_t otherTotalSize = 0;
+    std::map<int32_t, std::string> bundleNameAndUid;
+    int32_t result = sdCommunication.QueryOccupiedSpaceForAll(allVec, saTotalSize, otherTotalSize, bundleNameAndUid);
+    EXPECT_EQ(result, E_OK);
+
+    GTEST_LOG_(INFO) << "StorageDaemonCommunicationTest-end Daemon_communication_QueryOccupiedSpaceForAll_001 SUCCESS";
+}
+
 /**
  * @tc.number: SUB_STORAGE_Daemon_communication_RegisterUeceActivationCallback_001
  * @tc.name: Daemon_communication_RegisterUeceActivationCallback_001